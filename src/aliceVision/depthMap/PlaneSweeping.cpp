@@ -0,0 +1,356 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PlaneSweeping.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsData/OrientedPoint.hpp>
+#include <aliceVision/mvsData/geometry.hpp>
+#include <aliceVision/mvsData/structures.hpp>
+#include <aliceVision/mvsUtils/common.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace depthMap {
+
+PlaneSweeping::PlaneSweeping(mvsUtils::ImagesCache& ic, mvsUtils::MultiViewParams* _mp, int scales)
+    : _scales( scales )
+    , mp( _mp )
+    , _verbose( _mp->verbose )
+    , _ic( ic )
+{}
+
+void PlaneSweeping::getMinMaxdepths(int rc, const StaticVector<int>& tcams, float& minDepth, float& midDepth,
+                                    float& maxDepth)
+{
+  const bool minMaxDepthDontUseSeeds = mp->userParams.get<bool>("prematching.minMaxDepthDontUseSeeds", false);
+  const float maxDepthScale = static_cast<float>(mp->userParams.get<double>("prematching.maxDepthScale", 1.5f));
+
+  if(minMaxDepthDontUseSeeds)
+  {
+    const float minCamDist = static_cast<float>(mp->userParams.get<double>("prematching.minCamDist", 0.0f));
+    const float maxCamDist = static_cast<float>(mp->userParams.get<double>("prematching.maxCamDist", 15.0f));
+
+    minDepth = 0.0f;
+    maxDepth = 0.0f;
+    for(int c = 0; c < tcams.size(); c++)
+    {
+        int tc = tcams[c];
+        minDepth += (mp->CArr[rc] - mp->CArr[tc]).size() * minCamDist;
+        maxDepth += (mp->CArr[rc] - mp->CArr[tc]).size() * maxCamDist;
+    }
+    minDepth /= static_cast<float>(tcams.size());
+    maxDepth /= static_cast<float>(tcams.size());
+    midDepth = (minDepth + maxDepth) / 2.0f;
+  }
+  else
+  {
+    std::size_t nbDepths;
+    mp->getMinMaxMidNbDepth(rc, minDepth, maxDepth, midDepth, nbDepths);
+    maxDepth = maxDepth * maxDepthScale;
+  }
+}
+
+StaticVector<float>* PlaneSweeping::getDepthsByPixelSize(int rc, float minDepth, float midDepth, float maxDepth,
+                                                           int scale, int step, int maxDepthsHalf)
+{
+    float d = (float)step;
+
+    OrientedPoint rcplane;
+    rcplane.p = mp->CArr[rc];
+    rcplane.n = mp->iRArr[rc] * Point3d(0.0, 0.0, 1.0);
+    rcplane.n = rcplane.n.normalize();
+
+    int ndepthsMidMax = 0;
+    float maxdepth = midDepth;
+    while((maxdepth < maxDepth) && (ndepthsMidMax < maxDepthsHalf))
+    {
+        Point3d p = rcplane.p + rcplane.n * maxdepth;
+        float pixSize = mp->getCamPixelSize(p, rc, (float)scale * d);
+        maxdepth += pixSize;
+        ndepthsMidMax++;
+    }
+
+    int ndepthsMidMin = 0;
+    float mindepth = midDepth;
+    while((mindepth > minDepth) && (ndepthsMidMin < maxDepthsHalf * 2 - ndepthsMidMax))
+    {
+        Point3d p = rcplane.p + rcplane.n * mindepth;
+        float pixSize = mp->getCamPixelSize(p, rc, (float)scale * d);
+        mindepth -= pixSize;
+        ndepthsMidMin++;
+    }
+
+    // getNumberOfDepths
+    float depth = mindepth;
+    int ndepths = 0;
+    float pixSize = 1.0f;
+    while((depth < maxdepth) && (pixSize > 0.0f) && (ndepths < 2 * maxDepthsHalf))
+    {
+        Point3d p = rcplane.p + rcplane.n * depth;
+        pixSize = mp->getCamPixelSize(p, rc, (float)scale * d);
+        depth += pixSize;
+        ndepths++;
+    }
+
+    StaticVector<float>* out = new StaticVector<float>();
+    out->reserve(ndepths);
+
+    // fill
+    depth = mindepth;
+    pixSize = 1.0f;
+    ndepths = 0;
+    while((depth < maxdepth) && (pixSize > 0.0f) && (ndepths < 2 * maxDepthsHalf))
+    {
+        out->push_back(depth);
+        Point3d p = rcplane.p + rcplane.n * depth;
+        pixSize = mp->getCamPixelSize(p, rc, (float)scale * d);
+        depth += pixSize;
+        ndepths++;
+    }
+
+    // check if it is asc
+    for(int i = 0; i < out->size() - 1; i++)
+    {
+        if((*out)[i] >= (*out)[i + 1])
+        {
+
+            for(int j = 0; j <= i + 1; j++)
+            {
+                ALICEVISION_LOG_TRACE("getDepthsByPixelSize: check if it is asc: " << (*out)[j]);
+            }
+            throw std::runtime_error("getDepthsByPixelSize not asc.");
+        }
+    }
+
+    return out;
+}
+
+StaticVector<float>* PlaneSweeping::getDepthsRcTc(int rc, int tc, int scale, float midDepth,
+                                                    int maxDepthsHalf)
+{
+    OrientedPoint rcplane;
+    rcplane.p = mp->CArr[rc];
+    rcplane.n = mp->iRArr[rc] * Point3d(0.0, 0.0, 1.0);
+    rcplane.n = rcplane.n.normalize();
+
+    Point2d rmid = Point2d((float)mp->getWidth(rc) / 2.0f, (float)mp->getHeight(rc) / 2.0f);
+    Point2d pFromTar, pToTar; // segment of epipolar line of the principal point of the rc camera to the tc camera
+    getTarEpipolarDirectedLine(&pFromTar, &pToTar, rmid, rc, tc, mp);
+
+    int allDepths = static_cast<int>((pToTar - pFromTar).size());
+    if(_verbose == true)
+    {
+        ALICEVISION_LOG_DEBUG("allDepths: " << allDepths);
+    }
+
+    Point2d pixelVect = ((pToTar - pFromTar).normalize()) * std::max(1.0f, (float)scale);
+    // printf("%f %f %i %i\n",pixelVect.size(),((float)(scale*step)/3.0f),scale,step);
+
+    Point2d cg = Point2d(0.0f, 0.0f);
+    Point3d cg3 = Point3d(0.0f, 0.0f, 0.0f);
+    int ncg = 0;
+    // navigate through all pixels of the epilolar segment
+    // Compute the middle of the valid pixels of the epipolar segment (in rc camera) of the principal point (of the rc camera)
+    for(int i = 0; i < allDepths; i++)
+    {
+        Point2d tpix = pFromTar + pixelVect * (float)i;
+        Point3d p;
+        if(triangulateMatch(p, rmid, tpix, rc, tc, mp)) // triangulate principal point from rc with tpix
+        {
+            float depth = orientedPointPlaneDistance(p, rcplane.p, rcplane.n); // todo: can compute the distance to the camera (as it's the principal point it's the same)
+            if( mp->isPixelInImage(tpix, tc)
+                && (depth > 0.0f)
+                && checkPair(p, rc, tc, mp, mp->getMinViewAngle(), mp->getMaxViewAngle()) )
+            {
+                cg = cg + tpix;
+                cg3 = cg3 + p;
+                ncg++;
+            }
+        }
+    }
+    if(ncg == 0)
+    {
+        return new StaticVector<float>();
+    }
+    cg = cg / (float)ncg;
+    cg3 = cg3 / (float)ncg;
+    allDepths = ncg;
+
+    if(_verbose == true)
+    {
+        ALICEVISION_LOG_DEBUG("All correct depths: " << allDepths);
+    }
+
+    Point2d midpoint = cg;
+    if(midDepth > 0.0f)
+    {
+        Point3d midPt = rcplane.p + rcplane.n * midDepth;
+        mp->getPixelFor3DPoint(&midpoint, midPt, tc);
+    }
+
+    // compute the direction
+    float direction = 1.0f;
+    {
+        Point3d p;
+        if(!triangulateMatch(p, rmid, midpoint, rc, tc, mp))
+        {
+            StaticVector<float>* out = new StaticVector<float>();
+            return out;
+        }
+
+        float depth = orientedPointPlaneDistance(p, rcplane.p, rcplane.n);
+
+        if(!triangulateMatch(p, rmid, midpoint + pixelVect, rc, tc, mp))
+        {
+            StaticVector<float>* out = new StaticVector<float>();
+            return out;
+        }
+
+        float depthP1 = orientedPointPlaneDistance(p, rcplane.p, rcplane.n);
+        if(depth > depthP1)
+        {
+            direction = -1.0f;
+        }
+    }
+
+    StaticVector<float>* out1 = new StaticVector<float>();
+    out1->reserve(2 * maxDepthsHalf);
+
+    Point2d tpix = midpoint;
+    float depthOld = -1.0f;
+    int istep = 0;
+    bool ok = true;
+
+    // compute depths for all pixels from the middle point to on one side of the epipolar line
+    while((out1->size() < maxDepthsHalf) && (mp->isPixelInImage(tpix, tc) == true) && (ok == true))
+    {
+        tpix = tpix + pixelVect * direction;
+
+        Point3d refvect = mp->iCamArr[rc] * rmid;
+        Point3d tarvect = mp->iCamArr[tc] * tpix;
+        float rptpang = angleBetwV1andV2(refvect, tarvect);
+
+        Point3d p;
+        ok = triangulateMatch(p, rmid, tpix, rc, tc, mp);
+
+        float depth = orientedPointPlaneDistance(p, rcplane.p, rcplane.n);
+        if (mp->isPixelInImage(tpix, tc)
+            && (depth > 0.0f) && (depth > depthOld)
+            && checkPair(p, rc, tc, mp, mp->getMinViewAngle(), mp->getMaxViewAngle())
+            && (rptpang > mp->getMinViewAngle())  // WARNING if vects are near parallel thaen this results to strange angles ...
+            && (rptpang < mp->getMaxViewAngle())) // this is the propper angle ... beacause is does not depend on the triangluated p
+        {
+            out1->push_back(depth);
+            // if ((tpix.x!=tpixold.x)||(tpix.y!=tpixold.y)||(depthOld>=depth))
+            //{
+            // printf("after %f %f %f %f %i %f %f\n",tpix.x,tpix.y,depth,depthOld,istep,ang,kk);
+            //};
+        }
+        else
+        {
+            ok = false;
+        }
+        depthOld = depth;
+        istep++;
+    }
+
+    StaticVector<float>* out2 = new StaticVector<float>();
+    out2->reserve(2 * maxDepthsHalf);
+    tpix = midpoint;
+    istep = 0;
+    ok = true;
+
+    // compute depths for all pixels from the middle point to the other side of the epipolar line
+    while((out2->size() < maxDepthsHalf) && (mp->isPixelInImage(tpix, tc) == true) && (ok == true))
+    {
+        Point3d refvect = mp->iCamArr[rc] * rmid;
+        Point3d tarvect = mp->iCamArr[tc] * tpix;
+        float rptpang = angleBetwV1andV2(refvect, tarvect);
+
+        Point3d p;
+        ok = triangulateMatch(p, rmid, tpix, rc, tc, mp);
+
+        float depth = orientedPointPlaneDistance(p, rcplane.p, rcplane.n);
+        if(mp->isPixelInImage(tpix, tc)
+            && (depth > 0.0f) && (depth < depthOld) 
+            && checkPair(p, rc, tc, mp, mp->getMinViewAngle(), mp->getMaxViewAngle())
+            && (rptpang > mp->getMinViewAngle())  // WARNING if vects are near parallel thaen this results to strange angles ...
+            && (rptpang < mp->getMaxViewAngle())) // this is the propper angle ... beacause is does not depend on the triangluated p
+        {
+            out2->push_back(depth);
+            // printf("%f %f\n",tpix.x,tpix.y);
+        }
+        else
+        {
+            ok = false;
+        }
+
+        depthOld = depth;
+        tpix = tpix - pixelVect * direction;
+    }
+
+    // printf("out2\n");
+    StaticVector<float>* out = new StaticVector<float>();
+    out->reserve(2 * maxDepthsHalf);
+    for(int i = out2->size() - 1; i >= 0; i--)
+    {
+        out->push_back((*out2)[i]);
+        // printf("%f\n",(*out2)[i]);
+    }
+    // printf("out1\n");
+    for(int i = 0; i < out1->size(); i++)
+    {
+        out->push_back((*out1)[i]);
+        // printf("%f\n",(*out1)[i]);
+    }
+
+    delete out2;
+    delete out1;
+
+    // we want to have it in ascending order
+    if(out->size() > 0 && (*out)[0] > (*out)[out->size() - 1])
+    {
+        StaticVector<float>* outTmp = new StaticVector<float>();
+        outTmp->reserve(out->size());
+        for(int i = out->size() - 1; i >= 0; i--)
+        {
+            outTmp->push_back((*out)[i]);
+        }
+        delete out;
+        out = outTmp;
+    }
+
+    // check if it is asc
+    for(int i = 0; i < out->size() - 1; i++)
+    {
+        if((*out)[i] > (*out)[i + 1])
+        {
+
+            for(int j = 0; j <= i + 1; j++)
+            {
+                ALICEVISION_LOG_TRACE("getDepthsRcTc: check if it is asc: " << (*out)[j]);
+            }
+            ALICEVISION_LOG_WARNING("getDepthsRcTc: not asc");
+
+            if(out->size() > 1)
+            {
+                qsort(&(*out)[0], out->size(), sizeof(float), qSortCompareFloatAsc);
+            }
+        }
+    }
+
+    if(_verbose == true)
+    {
+        ALICEVISION_LOG_DEBUG("used depths: " << out->size());
+    }
+
+    return out;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
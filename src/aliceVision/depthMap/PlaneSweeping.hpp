@@ -0,0 +1,76 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/Rgb.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsData/Voxel.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/depthMap/DepthSimMap.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Plane sweeping backend used by the Semi Global Matching and the Refine steps.
+ *
+ * Holds the host-side depth sampling shared by all the backends and declares the
+ * image-based computations that each backend (CUDA, CPU) has to provide.
+ */
+class PlaneSweeping
+{
+public:
+    const int _scales;
+    mvsUtils::MultiViewParams* mp;
+    const bool _verbose;
+    mvsUtils::ImagesCache& _ic;
+
+    PlaneSweeping(mvsUtils::ImagesCache& ic, mvsUtils::MultiViewParams* _mp, int scales);
+    virtual ~PlaneSweeping() = default;
+
+    void getMinMaxdepths(int rc, const StaticVector<int>& tcams, float& minDepth, float& midDepth, float& maxDepth);
+    StaticVector<float>* getDepthsByPixelSize(int rc, float minDepth, float midDepth, float maxDepth, int scale,
+                                              int step, int maxDepthsHalf = 1024);
+    StaticVector<float>* getDepthsRcTc(int rc, int tc, int scale, float midDepth, int maxDepthsHalf = 1024);
+
+    virtual bool refineRcTcDepthMap(bool useTcOrRcPixSize, int nStepsToRefine, StaticVector<float>* simMap,
+                                    StaticVector<float>* rcDepthMap, int rc, int tc, int scale, int wsh, float gammaC,
+                                    float gammaP, float epipShift, int xFrom, int wPart) = 0;
+
+    /**
+     * @return the size in MB of the similarity volume in the backend memory
+     */
+    virtual float sweepPixelsToVolume(int nDepthsToSearch, StaticVector<unsigned char>* volume, int volDimX,
+                                      int volDimY, int volDimZ, int volStepXY, int volLUX, int volLUY, int volLUZ,
+                                      const std::vector<float>* depths, int rc, int wsh, float gammaC, float gammaP,
+                                      StaticVector<Voxel>* pixels, int scale, int step, StaticVector<int>* tcams,
+                                      float epipShift) = 0;
+    virtual bool SGMoptimizeSimVolume(int rc, StaticVector<unsigned char>* volume, int volDimX, int volDimY,
+                                      int volDimZ, int volStepXY, int volLUX, int volLUY, int scale,
+                                      unsigned char P1, unsigned char P2) = 0;
+
+    /**
+     * @return (available, total, used) memory of the backend in MB
+     */
+    virtual Point3d getDeviceMemoryInfo() = 0;
+
+    virtual bool fuseDepthSimMapsGaussianKernelVoting(int w, int h, StaticVector<DepthSim>* oDepthSimMap,
+                                                      const StaticVector<StaticVector<DepthSim>*>* dataMaps,
+                                                      int nSamplesHalf, int nDepthsToRefine, float sigma) = 0;
+    virtual bool optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>* oDepthSimMap,
+                                                    StaticVector<StaticVector<DepthSim>*>* dataMaps, int rc,
+                                                    int nSamplesHalf, int nDepthsToRefine, float sigma, int nIters,
+                                                    int yFrom, int hPart) = 0;
+    virtual bool getSilhoueteMap(StaticVectorBool* oMap, int scale, int step, const rgb maskColor, int rc) = 0;
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,342 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/config.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#endif
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthMap
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+const int width = 160;
+const int height = 120;
+const double focal = 150.0;
+/// the textured plane is fronto-parallel to the reference camera at this depth
+const double planeDepth = 4.0;
+/// the target camera is translated along X, the disparity of the plane is about 11 pixels
+const double baseline = 0.3;
+
+/// depths of the sweep, the plane depth is the 20th one
+const float firstDepth = 2.0f;
+const float depthStep = 0.1f;
+const int nbDepths = 41;
+const int planeDepthIndex = 20;
+
+/// margin of the pixels checked by the tests, the patches must be inside both images
+const int margin = 24;
+
+const int wsh = 4;
+const float gammaC = 5.5f;
+const float gammaP = 8.0f;
+/// the refinement uses a larger color tolerance, as in RefineParams
+const float refineGammaC = 15.5f;
+
+/// size of a pixel of the reference image on the plane
+const float planePixelSize = float(planeDepth / focal);
+
+/**
+ * @brief Smooth non periodic texture of the plane: values of a random grid, bilinearly interpolated.
+ */
+class PlaneTexture
+{
+public:
+    explicit PlaneTexture(double cellSize)
+        : _cellSize(cellSize)
+    {
+        std::mt19937 randomNumberGenerator(42);
+        std::uniform_real_distribution<float> distribution(0.1f, 0.9f);
+        for(float& value : _values)
+            value = distribution(randomNumberGenerator);
+    }
+
+    float operator()(double x, double y) const
+    {
+        const double u = x / _cellSize + _gridSize / 2;
+        const double v = y / _cellSize + _gridSize / 2;
+        const int u0 = std::min(std::max(int(std::floor(u)), 0), _gridSize - 2);
+        const int v0 = std::min(std::max(int(std::floor(v)), 0), _gridSize - 2);
+        const float a = float(std::min(std::max(u - u0, 0.0), 1.0));
+        const float b = float(std::min(std::max(v - v0, 0.0), 1.0));
+        return (1.0f - a) * (1.0f - b) * value(u0, v0) + a * (1.0f - b) * value(u0 + 1, v0) +
+               (1.0f - a) * b * value(u0, v0 + 1) + a * b * value(u0 + 1, v0 + 1);
+    }
+
+private:
+    static const int _gridSize = 256;
+    const double _cellSize;
+    std::array<float, _gridSize * _gridSize> _values;
+
+    float value(int u, int v) const { return _values[v * _gridSize + u]; }
+};
+
+/**
+ * @brief Two cameras looking at a textured plane, the images are written in a temporary folder.
+ */
+class SyntheticScene
+{
+public:
+    SyntheticScene()
+        : _folder(bfs::temp_directory_path() / bfs::unique_path())
+    {
+        bfs::create_directories(_folder);
+
+        // cells of about 4 pixels in the reference image
+        const PlaneTexture texture(4.0 * planePixelSize);
+
+        _sfmData.intrinsics.emplace(0, std::make_shared<camera::Pinhole>(width, height, focal, focal,
+                                                                           width / 2.0, height / 2.0));
+
+        for(IndexT viewId = 0; viewId < 2; ++viewId)
+        {
+            const Vec3 center(viewId * baseline, 0.0, 0.0);
+            const std::string imagePath = (_folder / (std::to_string(viewId) + ".exr")).string();
+
+            // render the plane Z = planeDepth, both cameras look along Z
+            std::vector<Color> image(width * height);
+            for(int y = 0; y < height; ++y)
+            {
+                for(int x = 0; x < width; ++x)
+                {
+                    const double planeX = center.x() + (x - width / 2.0) * planeDepth / focal;
+                    const double planeY = center.y() + (y - height / 2.0) * planeDepth / focal;
+                    const float value = texture(planeX, planeY);
+                    image[y * width + x] = Color(value, 0.8f * value + 0.1f, 0.5f);
+                }
+            }
+            imageIO::OutputFileColorSpace colorspace(imageIO::EImageColorSpace::NO_CONVERSION);
+            imageIO::writeImage(imagePath, width, height, image, imageIO::EImageQuality::LOSSLESS, colorspace);
+
+            _sfmData.views.emplace(viewId, std::make_shared<sfmData::View>(imagePath, viewId, 0, viewId, width, height));
+            _sfmData.setPose(*_sfmData.views.at(viewId), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), center)));
+        }
+
+        _mp.reset(new mvsUtils::MultiViewParams(_sfmData));
+        _ic.reset(new mvsUtils::ImagesCache(_mp.get(), imageIO::EImageColorSpace::LINEAR));
+    }
+
+    ~SyntheticScene()
+    {
+        _ic.reset();
+        bfs::remove_all(_folder);
+    }
+
+    mvsUtils::MultiViewParams& mp() { return *_mp; }
+    mvsUtils::ImagesCache& ic() { return *_ic; }
+
+private:
+    const bfs::path _folder;
+    sfmData::SfMData _sfmData;
+    std::unique_ptr<mvsUtils::MultiViewParams> _mp;
+    std::unique_ptr<mvsUtils::ImagesCache> _ic;
+};
+
+/**
+ * @brief Similarity volume of the pixels of the reference image, one voxel per pixel and depth.
+ */
+struct SimilarityVolume
+{
+    StaticVector<unsigned char> volume;
+    std::vector<float> depths;
+
+    bool isChecked(int x, int y) const
+    {
+        return x >= margin && x < width - margin && y >= margin && y < height - margin;
+    }
+
+    /// index of the depth of best similarity of a pixel
+    int bestDepthIndex(int x, int y) const
+    {
+        int bestIndex = 0;
+        for(int z = 1; z < nbDepths; ++z)
+        {
+            if(volume[(z * height + y) * width + x] < volume[(bestIndex * height + y) * width + x])
+                bestIndex = z;
+        }
+        return bestIndex;
+    }
+
+    /// ratio of the checked pixels whose best depth is the plane depth, up to one depth step
+    double inlierRatio() const
+    {
+        int nbPixels = 0;
+        int nbInliers = 0;
+        for(int y = 0; y < height; ++y)
+        {
+            for(int x = 0; x < width; ++x)
+            {
+                if(!isChecked(x, y))
+                    continue;
+                ++nbPixels;
+                if(std::abs(bestDepthIndex(x, y) - planeDepthIndex) <= 1)
+                    ++nbInliers;
+            }
+        }
+        return double(nbInliers) / nbPixels;
+    }
+};
+
+SimilarityVolume sweepVolume(PlaneSweeping& ps)
+{
+    SimilarityVolume sim;
+    for(int i = 0; i < nbDepths; ++i)
+        sim.depths.push_back(firstDepth + i * depthStep);
+
+    StaticVector<Voxel> pixels;
+    pixels.reserve(width * height);
+    for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+            pixels.push_back(Voxel(x, y, 0));
+
+    StaticVector<int> tcams;
+    tcams.push_back(1);
+
+    sim.volume.resize(width * height * nbDepths);
+    ps.sweepPixelsToVolume(nbDepths, &sim.volume, width, height, nbDepths, 1, 0, 0, 0, &sim.depths, 0, wsh, gammaC,
+                           gammaP, &pixels, 1, 1, &tcams, 0.0f);
+    return sim;
+}
+
+/// distance to the reference camera center of the plane point seen by a pixel
+float planeRayDepth(int x, int y)
+{
+    const double dx = (x - width / 2.0) / focal;
+    const double dy = (y - height / 2.0) / focal;
+    return float(planeDepth * std::sqrt(1.0 + dx * dx + dy * dy));
+}
+
+/**
+ * @brief Refine a depth map initialized 3 pixels away from the plane.
+ * @return the ratio of the checked pixels refined to the plane depth within 2 pixels
+ */
+double refineDepthMap(PlaneSweeping& ps, StaticVector<float>& depthMap)
+{
+    depthMap.resize(width * height);
+    for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+            depthMap[y * width + x] = planeRayDepth(x, y) + ((x + y) % 2 == 0 ? 3.0f : -3.0f) * planePixelSize;
+
+    StaticVector<float> simMap;
+    simMap.resize(width * height);
+    ps.refineRcTcDepthMap(false, 31, &simMap, &depthMap, 0, 1, 1, wsh, refineGammaC, gammaP, 0.0f, 0,
+                          width);
+
+    int nbPixels = 0;
+    int nbInliers = 0;
+    for(int y = margin; y < height - margin; ++y)
+    {
+        for(int x = margin; x < width - margin; ++x)
+        {
+            ++nbPixels;
+            if(std::abs(depthMap[y * width + x] - planeRayDepth(x, y)) < 2.0f * planePixelSize)
+                ++nbInliers;
+        }
+    }
+    return double(nbInliers) / nbPixels;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(depthMap_planeSweepingCpu)
+{
+    SyntheticScene scene;
+    PlaneSweepingCpu ps(scene.ic(), &scene.mp(), 1);
+
+    SimilarityVolume sim = sweepVolume(ps);
+    BOOST_CHECK_GE(sim.inlierRatio(), 0.95);
+
+    // add a wrong best depth to one pixel out of ten, the aggregation must remove them
+    for(int y = 0; y < height; ++y)
+        for(int x = 0; x < width; ++x)
+            if((7 * x + 13 * y) % 10 == 0)
+                sim.volume[(((x + 3 * y) % nbDepths) * height + y) * width + x] = 0;
+    BOOST_CHECK_LT(sim.inlierRatio(), 0.95);
+
+    ps.SGMoptimizeSimVolume(0, &sim.volume, width, height, nbDepths, 1, 0, 0, 1, 10, 100);
+    BOOST_CHECK_GE(sim.inlierRatio(), 0.98);
+
+    StaticVector<float> depthMap;
+    BOOST_CHECK_GE(refineDepthMap(ps, depthMap), 0.95);
+}
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+BOOST_AUTO_TEST_CASE(depthMap_planeSweepingCpuVsCuda)
+{
+    if(listCUDADevices(false) < 1)
+    {
+        BOOST_TEST_MESSAGE("No CUDA device, skip the comparison of the CPU and the CUDA plane sweeping.");
+        return;
+    }
+
+    SyntheticScene scene;
+    PlaneSweepingCpu psCpu(scene.ic(), &scene.mp(), 1);
+    PlaneSweepingCuda psCuda(0, scene.ic(), &scene.mp(), 1);
+
+    SimilarityVolume simCpu = sweepVolume(psCpu);
+    SimilarityVolume simCuda = sweepVolume(psCuda);
+
+    // the similarities are quantized on 8 bits, they may differ by a few levels
+    // as the floating point computations are not done in the same order
+    double sumDiff = 0.0;
+    int nbVoxels = 0;
+    int nbSameDepths = 0;
+    int nbPixels = 0;
+    for(int y = margin; y < height - margin; ++y)
+    {
+        for(int x = margin; x < width - margin; ++x)
+        {
+            for(int z = 0; z < nbDepths; ++z)
+            {
+                const int i = (z * height + y) * width + x;
+                sumDiff += std::abs(int(simCpu.volume[i]) - int(simCuda.volume[i]));
+                ++nbVoxels;
+            }
+            ++nbPixels;
+            if(std::abs(simCpu.bestDepthIndex(x, y) - simCuda.bestDepthIndex(x, y)) <= 1)
+                ++nbSameDepths;
+        }
+    }
+    BOOST_CHECK_LE(sumDiff / nbVoxels, 2.0);
+    BOOST_CHECK_GE(double(nbSameDepths) / nbPixels, 0.98);
+
+    StaticVector<float> depthMapCpu;
+    StaticVector<float> depthMapCuda;
+    refineDepthMap(psCpu, depthMapCpu);
+    refineDepthMap(psCuda, depthMapCuda);
+
+    int nbCloseDepths = 0;
+    for(int y = margin; y < height - margin; ++y)
+        for(int x = margin; x < width - margin; ++x)
+            if(std::abs(depthMapCpu[y * width + x] - depthMapCuda[y * width + x]) < planePixelSize)
+                ++nbCloseDepths;
+    BOOST_CHECK_GE(double(nbCloseDepths) / nbPixels, 0.95);
+}
+#endif
@@ -8,7 +8,7 @@
 
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/depthMap/DepthSimMap.hpp>
-#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#include <aliceVision/depthMap/PlaneSweeping.hpp>
 
 namespace aliceVision {
 namespace depthMap {
@@ -17,10 +17,10 @@ class RcTc
 {
 public:
     mvsUtils::MultiViewParams* mp;
-    PlaneSweepingCuda&         cps;
+    PlaneSweeping&         cps;
     bool                       verbose;
 
-    RcTc(mvsUtils::MultiViewParams* _mp, PlaneSweepingCuda& _cps);
+    RcTc(mvsUtils::MultiViewParams* _mp, PlaneSweeping& _cps);
 
     void refineRcTcDepthSimMap(bool useTcOrRcPixSize, DepthSimMap* depthSimMap, int rc, int tc, int ndepthsToRefine,
                                int wsh, float gammaC, float gammaP, float epipShift);
@@ -5,8 +5,13 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "RefineRc.hpp"
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/gpu/gpu.hpp>
+#include <aliceVision/depthMap/cpu/PlaneSweepingCpu.hpp>
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/cuda/PlaneSweepingCuda.hpp>
+#endif
 
 #include <aliceVision/mvsData/Point2d.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
@@ -17,6 +22,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <stdexcept>
+
 namespace aliceVision {
 namespace depthMap {
 
@@ -44,8 +51,14 @@ RefineRc::~RefineRc()
 
 void RefineRc::preloadSgmTcams_async()
 {
-  for(int tc : _sgmTCams.getData())
-    _sp->cps._ic.refreshData_async(tc);
+  // the images of this R camera must not be evicted by the prefetch of the next one
+  std::vector<int> currentCams = _sgmTCams.getData();
+  currentCams.insert(currentCams.end(), _refineTCams.getData().begin(), _refineTCams.getData().end());
+  currentCams.push_back(_rc);
+  _sp->cps._ic.setCurrentCams(currentCams);
+
+  _sp->cps._ic.prefetch(_rc);
+  _sp->cps._ic.prefetch(_sgmTCams.getData());
 }
 
 DepthSimMap* RefineRc::getDepthPixSizeMapFromSGM()
@@ -287,8 +300,82 @@ void RefineRc::writeDepthMap()
     _depthSimMapOpt->save(_rc, _refineTCams);
 }
 
+namespace {
+
+/**
+ * @brief Get the plane sweeping scale and step from the user parameters,
+ *        or compute them so that the highest scale has a minimum resolution of 700x550.
+ */
+void getSgmScaleStep(mvsUtils::MultiViewParams* mp, int& sgmScale, int& sgmStep)
+{
+  const int fileScale = 1; // input images scale (should be one)
+  sgmScale = mp->userParams.get<int>("semiGlobalMatching.scale", -1);
+  sgmStep = mp->userParams.get<int>("semiGlobalMatching.step", -1);
+
+  if(sgmScale == -1)
+  {
+      // compute the number of scales that will be used in the plane sweeping.
+      // the highest scale should have a minimum resolution of 700x550.
+      const int width = mp->getMaxImageWidth();
+      const int height = mp->getMaxImageHeight();
+      const int scaleTmp = computeStep(mp, fileScale, (width > height ? 700 : 550), (width > height ? 550 : 700));
+
+      sgmScale = std::min(2, scaleTmp);
+      sgmStep = computeStep(mp, fileScale * sgmScale, (width > height ? 700 : 550), (width > height ? 550 : 700));
+
+      ALICEVISION_LOG_INFO("Plane sweeping parameters:\n"
+                           "\t- scale: " << sgmScale << "\n"
+                           "\t- step: " << sgmStep);
+  }
+}
+
+void estimateAndRefineDepthMaps(PlaneSweeping& cps, int sgmScale, int sgmStep, mvsUtils::MultiViewParams* mp,
+                                const std::vector<int>& cams)
+{
+  // init plane sweeping parameters
+  SemiGlobalMatchingParams sp(mp, cps);
+
+  const int nbSgmTCams = mp->userParams.get<int>("semiGlobalMatching.maxTCams", 10);
+
+  for(std::size_t i = 0; i < cams.size(); ++i)
+  {
+      const int rc = cams[i];
+      RefineRc sgmRefineRc(rc, sgmScale, sgmStep, &sp);
+
+      sgmRefineRc.preloadSgmTcams_async();
+
+      // load the images of the next R camera in the background while this one is processed
+      if(i + 1 < cams.size())
+      {
+          const int nextRc = cams[i + 1];
+          cps._ic.prefetch(nextRc);
+          cps._ic.prefetch(mp->findNearestCamsFromLandmarks(nextRc, nbSgmTCams).getData());
+      }
+
+      ALICEVISION_LOG_INFO("Estimate depth map, view id: " << mp->getViewId(rc));
+      sgmRefineRc.sgmrc();
+
+      ALICEVISION_LOG_INFO("Refine depth map, view id: " << mp->getViewId(rc));
+      sgmRefineRc.refinerc();
+
+      // write results
+      sgmRefineRc.writeDepthMap();
+  }
+
+  cps._ic.logStats();
+}
+
+} // namespace
+
 void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs)
 {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  if(mp->userParams.get<bool>("depthMap.useCpu", false))
+  {
+      estimateAndRefineDepthMapsCpu(mp, cams);
+      return;
+  }
+
   const int numGpus = listCUDADevices(true);
   const int numCpuThreads = omp_get_num_procs();
   int numThreads = std::min(numGpus, numCpuThreads);
@@ -329,59 +416,49 @@ void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector
           estimateAndRefineDepthMaps(cpuThreadId, mp, subcams);
       }
   }
+#else
+  ALICEVISION_LOG_INFO("AliceVision is built without CUDA, use the CPU implementation.");
+  estimateAndRefineDepthMapsCpu(mp, cams);
+#endif
 }
 
 void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams)
 {
-  const int fileScale = 1; // input images scale (should be one)
-  int sgmScale = mp->userParams.get<int>("semiGlobalMatching.scale", -1);
-  int sgmStep = mp->userParams.get<int>("semiGlobalMatching.step", -1);
-
-  if(sgmScale == -1)
-  {
-      // compute the number of scales that will be used in the plane sweeping.
-      // the highest scale should have a minimum resolution of 700x550.
-      const int width = mp->getMaxImageWidth();
-      const int height = mp->getMaxImageHeight();
-      const int scaleTmp = computeStep(mp, fileScale, (width > height ? 700 : 550), (width > height ? 550 : 700));
-
-      sgmScale = std::min(2, scaleTmp);
-      sgmStep = computeStep(mp, fileScale * sgmScale, (width > height ? 700 : 550), (width > height ? 550 : 700));
-
-      ALICEVISION_LOG_INFO("Plane sweeping parameters:\n"
-                           "\t- scale: " << sgmScale << "\n"
-                           "\t- step: " << sgmStep);
-  }
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+  int sgmScale;
+  int sgmStep;
+  getSgmScaleStep(mp, sgmScale, sgmStep);
 
   // load images from files into RAM
   mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
   // load stuff on GPU memory and creates multi-level images and computes gradients
   PlaneSweepingCuda cps(cudaDeviceNo, ic, mp, sgmScale);
-  // init plane sweeping parameters
-  SemiGlobalMatchingParams sp(mp, cps);
 
-  for(const int rc : cams)
-  {
-      RefineRc sgmRefineRc(rc, sgmScale, sgmStep, &sp);
+  estimateAndRefineDepthMaps(cps, sgmScale, sgmStep, mp, cams);
+#else
+  throw std::runtime_error("Cannot estimate depth maps on a CUDA device, AliceVision is built without CUDA.");
+#endif
+}
 
-      sgmRefineRc.preloadSgmTcams_async();
+void estimateAndRefineDepthMapsCpu(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams)
+{
+  int sgmScale;
+  int sgmStep;
+  getSgmScaleStep(mp, sgmScale, sgmStep);
 
-      ALICEVISION_LOG_INFO("Estimate depth map, view id: " << mp->getViewId(rc));
-      sgmRefineRc.sgmrc();
+  ALICEVISION_LOG_INFO("Estimate depth maps on the CPU, # threads: " << omp_get_max_threads());
 
-      ALICEVISION_LOG_INFO("Refine depth map, view id: " << mp->getViewId(rc));
-      sgmRefineRc.refinerc();
+  // load images from files into RAM
+  mvsUtils::ImagesCache ic(mp, imageIO::EImageColorSpace::LINEAR);
+  // creates multi-level images and computes gradients in RAM
+  PlaneSweepingCpu cps(ic, mp, sgmScale);
 
-      // write results
-      sgmRefineRc.writeDepthMap();
-  }
+  estimateAndRefineDepthMaps(cps, sgmScale, sgmStep, mp, cams);
 }
 
-
-
-
 void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams)
 {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
   const float igammaC = 1.0f;
   const float igammaP = 1.0f;
   const int wsh = 3;
@@ -410,10 +487,14 @@ void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const St
       writeImage(normalMapFilepath, mp->getWidth(rc), mp->getHeight(rc), normalMap.getDataWritable(), EImageQuality::LOSSLESS, colorspace);
     }
   }
+#else
+  throw std::runtime_error("Cannot compute normal maps, AliceVision is built without CUDA.");
+#endif
 }
 
 void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams)
 {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
   const int nbGPUs = listCUDADevices(true);
   const int nbCPUThreads = omp_get_num_procs();
 
@@ -462,6 +543,9 @@ void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& c
       computeNormalMaps(CUDADeviceNo, mp, subcams);
     }
   }
+#else
+  throw std::runtime_error("Cannot compute normal maps, AliceVision is built without CUDA.");
+#endif
 }
 
 
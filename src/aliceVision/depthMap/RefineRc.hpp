@@ -45,6 +45,11 @@ private:
 void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs);
 void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams);
 
+/**
+ * @brief Estimate and refine the depth maps with the multi-threaded CPU implementation.
+ */
+void estimateAndRefineDepthMapsCpu(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams);
+
 void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
 void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
 
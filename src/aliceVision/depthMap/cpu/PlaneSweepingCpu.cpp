@@ -0,0 +1,1147 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PlaneSweepingCpu.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/mvsData/Matrix3x3.hpp>
+#include <aliceVision/mvsData/Matrix3x4.hpp>
+#include <aliceVision/mvsUtils/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+namespace aliceVision {
+namespace depthMap {
+
+using namespace cpu;
+
+namespace {
+
+/*********************************************************************************
+ * color conversion, see device_color.cu
+ *********************************************************************************/
+
+inline unsigned char saturateUChar(float v)
+{
+    // float to unsigned char conversion of the GPU: round toward zero and saturate
+    return static_cast<unsigned char>(std::min(std::max(v, 0.0f), 255.0f));
+}
+
+// linear RGB (0..1) to XYZ (0..1) using sRGB primaries
+inline Vec3 rgb2xyz(const Vec3& c)
+{
+    return Vec3(0.4124564f * c.x + 0.3575761f * c.y + 0.1804375f * c.z,
+                0.2126729f * c.x + 0.7151522f * c.y + 0.0721750f * c.z,
+                0.0193339f * c.x + 0.1191920f * c.y + 0.9503041f * c.z);
+}
+
+// XYZ (0..1) to CIELAB (0..255) assuming D65 whitepoint
+inline Vec3 xyz2lab(const Vec3& c)
+{
+    const Vec3 r(c.x / 0.95047f, c.y, c.z / 1.08883f);
+    const auto f = [](float v) {
+        return v > 216.0f / 24389.0f ? std::cbrt(v) : (24389.0f / 27.0f * v + 16.0f) / 116.0f;
+    };
+    const Vec3 fr(f(r.x), f(r.y), f(r.z));
+
+    return Vec3(116.0f * fr.y - 16.0f, 500.0f * (fr.x - fr.y), 200.0f * (fr.y - fr.z)) * 2.55f;
+}
+
+inline Rgba rgb2lab(float r, float g, float b)
+{
+    const Vec3 flab = xyz2lab(rgb2xyz(Vec3(r, g, b)));
+    Rgba lab;
+    lab.x = saturateUChar(flab.x);
+    lab.y = saturateUChar(flab.y);
+    lab.z = saturateUChar(flab.z);
+    return lab;
+}
+
+/**
+ * @brief Store the gradient magnitude of the L channel in the w channel.
+ */
+void computeGradientOfL(ImageLevel& level)
+{
+    const ImageLevel src = level;
+
+    #pragma omp parallel for
+    for(int y = 0; y < level.height; ++y)
+    {
+        for(int x = 0; x < level.width; ++x)
+        {
+            const float gx = float(src.at(x - 1, y).x) - float(src.at(x + 1, y).x);
+            const float gy = float(src.at(x, y - 1).x) - float(src.at(x, y + 1).x);
+            level.data[y * level.width + x].w = saturateUChar(std::sqrt(gx * gx + gy * gy));
+        }
+    }
+}
+
+/**
+ * @brief Gaussian downscale of the full resolution Lab image, see downscale_gauss_smooth_lab_kernel.
+ */
+void downscaleGaussSmoothLab(ImageLevel& out, const ImageLevel& in, int scale, int radius)
+{
+    std::vector<float> gaussian(2 * radius + 1);
+    for(int i = -radius; i <= radius; ++i)
+        gaussian[i + radius] = std::exp(-float(i * i) / 2.0f);
+
+    out.width = in.width / scale;
+    out.height = in.height / scale;
+    out.data.resize(out.width * out.height);
+
+    #pragma omp parallel for
+    for(int y = 0; y < out.height; ++y)
+    {
+        for(int x = 0; x < out.width; ++x)
+        {
+            Vec4 t;
+            float sum = 0.0f;
+            for(int i = -radius; i <= radius; ++i)
+            {
+                for(int j = -radius; j <= radius; ++j)
+                {
+                    const Vec4 curPix = in.sample(float(x * scale + j) + float(scale) / 2.0f,
+                                                  float(y * scale + i) + float(scale) / 2.0f);
+                    const float factor = gaussian[i + radius] * gaussian[j + radius];
+                    t = t + curPix * factor;
+                    sum += factor;
+                }
+            }
+            Rgba& o = out.data[y * out.width + x];
+            o.x = static_cast<unsigned char>(t.x / sum);
+            o.y = static_cast<unsigned char>(t.y / sum);
+            o.z = static_cast<unsigned char>(t.z / sum);
+            o.w = static_cast<unsigned char>(t.w / sum);
+        }
+    }
+}
+
+/*********************************************************************************
+ * geometry, see device_patch_es.cu and device_code.cu
+ *********************************************************************************/
+
+/**
+ * @brief Reference / target cameras and images used by the per-pixel functions.
+ */
+struct CamPair
+{
+    const CameraParams* r = nullptr;
+    const CameraParams* t = nullptr;
+    const ImageLevel* rImg = nullptr;
+    const ImageLevel* tImg = nullptr;
+};
+
+inline Vec3 get3DPointForPixelAndFrontoParellePlaneRC(const CameraParams& rc, const Vec2& pix, float fpPlaneDepth)
+{
+    const Vec3 planep = rc.C + rc.ZVect * fpPlaneDepth;
+    Vec3 v = M3x3mulV2(rc.iP, pix);
+    normalize(v);
+    return linePlaneIntersect(rc.C, v, planep, rc.ZVect);
+}
+
+inline Vec3 get3DPointForPixelAndDepthFromRC(const CameraParams& rc, const Vec2& pix, float depth)
+{
+    Vec3 rpv = M3x3mulV2(rc.iP, pix);
+    normalize(rpv);
+    return rc.C + rpv * depth;
+}
+
+inline Vec2 getPixelFor3DPoint(const CameraParams& cam, const Vec3& X)
+{
+    const Vec3 p = M3x4mulV3(cam.P, X);
+    if(p.z < 0.0f)
+        return Vec2(-1.0f, -1.0f);
+    return Vec2(p.x / p.z, p.y / p.z);
+}
+
+inline float computePixSize(const CameraParams& rc, const Vec3& p)
+{
+    const Vec2 rp1 = project3DPoint(rc.P, p) + Vec2(1.0f, 0.0f);
+    Vec3 refvect = M3x3mulV2(rc.iP, rp1);
+    normalize(refvect);
+    return pointLineDistance3D(p, rc.C, refvect);
+}
+
+inline void computeRotCSEpip(const CamPair& cp, Patch& ptch, const Vec3& p)
+{
+    ptch.p = p;
+
+    Vec3 v1 = cp.r->C - p;
+    Vec3 v2 = cp.t->C - p;
+    normalize(v1);
+    normalize(v2);
+
+    // y has to be orthogonal to the epipolar plane, n and x on the epipolar plane
+    ptch.y = cross(v1, v2);
+    normalize(ptch.y);
+
+    ptch.n = (v1 + v2) / 2.0f;
+    normalize(ptch.n);
+
+    ptch.x = cross(ptch.y, ptch.n);
+    normalize(ptch.x);
+}
+
+inline Vec3 triangulateMatchRef(const CamPair& cp, const Vec2& refpix, const Vec2& tarpix)
+{
+    Vec3 refvect = M3x3mulV2(cp.r->iP, refpix);
+    normalize(refvect);
+    Vec3 tarvect = M3x3mulV2(cp.t->iP, tarpix);
+    normalize(tarvect);
+
+    float k;
+    lineLineIntersect(k, cp.r->C, refvect + cp.r->C, cp.t->C, tarvect + cp.t->C);
+
+    return cp.r->C + refvect * k;
+}
+
+inline void move3DPointByTcOrRcPixStep(const CamPair& cp, Vec3& p, float pixStep, bool moveByTcOrRc)
+{
+    if(moveByTcOrRc)
+    {
+        const Vec3 prp1 = p + (cp.r->C - p) / 2.0f;
+        const Vec2 rp = getPixelFor3DPoint(*cp.r, p);
+        const Vec2 tpo = getPixelFor3DPoint(*cp.t, p);
+        Vec2 tpv = getPixelFor3DPoint(*cp.t, prp1) - tpo;
+        normalize(tpv);
+
+        p = triangulateMatchRef(cp, rp, tpo + tpv * pixStep);
+    }
+    else
+    {
+        Vec3 rpv = p - cp.r->C;
+        normalize(rpv);
+        p = p + rpv * (pixStep * computePixSize(*cp.r, p));
+    }
+}
+
+/**
+ * @brief Lab colors of the samples of a patch in the reference and the target images,
+ *        stored by channel so that the weights and the statistics are computed in a vectorized loop.
+ */
+struct PatchSamples
+{
+    int wsh = -1;
+    int nSamples = 0;
+    /// distance of each sample to the patch center
+    std::vector<float> deltaP;
+    std::vector<float> rL, ra, rb;
+    std::vector<float> tL, ta, tb;
+
+    explicit PatchSamples(int _wsh)
+    {
+        wsh = _wsh;
+        nSamples = (2 * wsh + 1) * (2 * wsh + 1);
+        deltaP.resize(nSamples);
+        for(auto* channel : {&rL, &ra, &rb, &tL, &ta, &tb})
+            channel->resize(nSamples);
+
+        int i = 0;
+        for(int yp = -wsh; yp <= wsh; ++yp)
+            for(int xp = -wsh; xp <= wsh; ++xp)
+                deltaP[i++] = std::sqrt(float(xp * xp + yp * yp));
+    }
+};
+
+/**
+ * @brief Weighted NCC of the patch between the reference and the target images.
+ *
+ * The patch samples are projected incrementally in homogeneous coordinates and gathered
+ * from the images, then the Yoon & Kweon weights and the NCC statistics of all the samples
+ * are computed in a single SIMD loop.
+ * @return similarity value in range (-1, 0) or 1 if invalid
+ */
+float compNCCby3DptsYK(const CamPair& cp, const Patch& ptch, PatchSamples& samples, int width, int height,
+                       float gammaC, float gammaP, float epipShift)
+{
+    const int wsh = samples.wsh;
+    const Vec2 rp = project3DPoint(cp.r->P, ptch.p);
+    Vec2 tp = project3DPoint(cp.t->P, ptch.p);
+
+    // assuming that ptch.y is orthogonal to epipolar plane
+    Vec2 tvUp = project3DPoint(cp.t->P, ptch.p + ptch.y * (ptch.d * 10.0f)) - tp;
+    normalize(tvUp);
+    const Vec2 vEpipShift = tvUp * epipShift;
+    tp = tp + vEpipShift;
+
+    const float dd = wsh + 2.0f;
+    if((rp.x < dd) || (rp.x > float(width - 1) - dd) || (rp.y < dd) || (rp.y > float(height - 1) - dd) ||
+       (tp.x < dd) || (tp.x > float(width - 1) - dd) || (tp.y < dd) || (tp.y > float(height - 1) - dd))
+    {
+        return 1.0f;
+    }
+
+    const Vec4 gcr = cp.rImg->sample(rp.x + 0.5f, rp.y + 0.5f);
+    const Vec4 gct = cp.tImg->sample(tp.x + 0.5f, tp.y + 0.5f);
+
+    // homogeneous projections of the patch center and of its x and y steps
+    const Vec3 rh0 = M3x4mulV3(cp.r->P, ptch.p);
+    const Vec3 rhx = M3x3mulV3(cp.r->P, ptch.x * ptch.d);
+    const Vec3 rhy = M3x3mulV3(cp.r->P, ptch.y * ptch.d);
+    const Vec3 th0 = M3x4mulV3(cp.t->P, ptch.p);
+    const Vec3 thx = M3x3mulV3(cp.t->P, ptch.x * ptch.d);
+    const Vec3 thy = M3x3mulV3(cp.t->P, ptch.y * ptch.d);
+
+    int i = 0;
+    for(int yp = -wsh; yp <= wsh; ++yp)
+    {
+        for(int xp = -wsh; xp <= wsh; ++xp, ++i)
+        {
+            const Vec3 rh = rh0 + rhx * float(xp) + rhy * float(yp);
+            const Vec3 th = th0 + thx * float(xp) + thy * float(yp);
+
+            const Vec4 gcr1 = cp.rImg->sample(rh.x / rh.z + 0.5f, rh.y / rh.z + 0.5f);
+            const Vec4 gct1 = cp.tImg->sample(th.x / th.z + vEpipShift.x + 0.5f, th.y / th.z + vEpipShift.y + 0.5f);
+
+            samples.rL[i] = gcr1.x;
+            samples.ra[i] = gcr1.y;
+            samples.rb[i] = gcr1.z;
+            samples.tL[i] = gct1.x;
+            samples.ta[i] = gct1.y;
+            samples.tb[i] = gct1.z;
+        }
+    }
+
+    const float* deltaP = samples.deltaP.data();
+    const float* rL = samples.rL.data();
+    const float* ra = samples.ra.data();
+    const float* rb = samples.rb.data();
+    const float* tL = samples.tL.data();
+    const float* ta = samples.ta.data();
+    const float* tb = samples.tb.data();
+
+    float wsum = 0.0f;
+    float xsum = 0.0f;
+    float ysum = 0.0f;
+    float xxsum = 0.0f;
+    float yysum = 0.0f;
+    float xysum = 0.0f;
+
+    #pragma omp simd reduction(+:wsum, xsum, ysum, xxsum, yysum, xysum)
+    for(int j = 0; j < samples.nSamples; ++j)
+    {
+        // Yoon & Kweon adaptive support weights from the Lab color and the distance to the patch center
+        const float deltaCr = std::sqrt((gcr.x - rL[j]) * (gcr.x - rL[j]) + (gcr.y - ra[j]) * (gcr.y - ra[j]) +
+                                        (gcr.z - rb[j]) * (gcr.z - rb[j]));
+        const float deltaCt = std::sqrt((gct.x - tL[j]) * (gct.x - tL[j]) + (gct.y - ta[j]) * (gct.y - ta[j]) +
+                                        (gct.z - tb[j]) * (gct.z - tb[j]));
+        // product of the reference and the target weights
+        const float w = std::exp(-((deltaCr + deltaCt) / gammaC + 2.0f * deltaP[j] / gammaP));
+
+        wsum += w;
+        xsum += w * rL[j];
+        ysum += w * tL[j];
+        xxsum += w * rL[j] * rL[j];
+        yysum += w * tL[j] * tL[j];
+        xysum += w * rL[j] * tL[j];
+    }
+
+    SimStat sst;
+    sst.wsum = wsum;
+    sst.xsum = xsum;
+    sst.ysum = ysum;
+    sst.xxsum = xxsum;
+    sst.yysum = yysum;
+    sst.xysum = xysum;
+    sst.computeWSim();
+    return sst.sim;
+}
+
+inline float computeSimForDepthFromRC(const CamPair& cp, const Vec2& pix, float depth, float step, bool moveByTcOrRc,
+                                      PatchSamples& samples, int imWidth, int imHeight, float gammaC,
+                                      float gammaP, float epipShift, float* odpt)
+{
+    Vec3 p = get3DPointForPixelAndDepthFromRC(*cp.r, pix, depth);
+    move3DPointByTcOrRcPixStep(cp, p, step, moveByTcOrRc);
+    if(odpt != nullptr)
+        *odpt = size(p - cp.r->C);
+
+    Patch ptch;
+    ptch.d = computePixSize(*cp.r, p);
+    computeRotCSEpip(cp, ptch, p);
+    return compNCCby3DptsYK(cp, ptch, samples, imWidth, imHeight, gammaC, gammaP, epipShift);
+}
+
+/**
+ * @brief Quadratic interpolation of the depth from three neighbouring similarities.
+ * @return the refined depth or -1 if the middle similarity is not a local minimum
+ */
+inline float refineDepthSubPixel(const Vec3& depths, const Vec3& sims)
+{
+    const float simM1 = (sims.x + 1.0f) / 2.0f;
+    const float sim1 = (sims.y + 1.0f) / 2.0f;
+    const float simP1 = (sims.z + 1.0f) / 2.0f;
+
+    if((simM1 > sim1) && (simP1 > sim1))
+    {
+        const float dispStep = -((simP1 - simM1) / (2.0f * (simP1 + simM1 - 2.0f * sim1)));
+        const float b = (depths.z + depths.x) / 2.0f;
+        const float a = b - depths.x;
+        return a * dispStep + b;
+    }
+    return -1.0f;
+}
+
+} // namespace
+
+PlaneSweepingCpu::PlaneSweepingCpu(mvsUtils::ImagesCache& ic, mvsUtils::MultiViewParams* _mp, int scales)
+    : PlaneSweeping(ic, _mp, scales)
+{
+    const int maxImageWidth = mp->getMaxImageWidth();
+    const int maxImageHeight = mp->getMaxImageHeight();
+
+    float oneimagemb = 4.0f * (((float)(maxImageWidth * maxImageHeight) / 1024.0f) / 1024.0f);
+    for(int scale = 2; scale <= _scales; ++scale)
+    {
+        oneimagemb += 4.0 * (((float)((maxImageWidth / scale) * (maxImageHeight / scale)) / 1024.0) / 1024.0);
+    }
+    const float maxmbCPU = mp->userParams.get<float>("depthMap.cpuImagesCacheMB", 500.0f);
+    _nImgsInMemAtTime = (int)(maxmbCPU / oneimagemb);
+    _nImgsInMemAtTime = std::max(2, std::min(mp->ncams, _nImgsInMemAtTime));
+
+    varianceWSH = mp->userParams.get<int>("global.varianceWSH", 4);
+
+    ALICEVISION_LOG_INFO("PlaneSweepingCpu:" << std::endl
+                         << "\t- _nImgsInMemAtTime: " << _nImgsInMemAtTime << std::endl
+                         << "\t- scales: " << _scales << std::endl
+                         << "\t- varianceWSH: " << varianceWSH << std::endl
+                         << "\t- threads: " << omp_get_max_threads());
+
+    _cams.resize(_nImgsInMemAtTime);
+}
+
+PlaneSweepingCpu::~PlaneSweepingCpu(void)
+{
+    mp = nullptr;
+}
+
+void PlaneSweepingCpu::fillCamera(CameraParams& cam, int c, int scale) const
+{
+    Matrix3x3 scaleM;
+    scaleM.m11 = 1.0 / (float)scale;
+    scaleM.m12 = 0.0;
+    scaleM.m13 = 0.0;
+    scaleM.m21 = 0.0;
+    scaleM.m22 = 1.0 / (float)scale;
+    scaleM.m23 = 0.0;
+    scaleM.m31 = 0.0;
+    scaleM.m32 = 0.0;
+    scaleM.m33 = 1.0;
+    const Matrix3x3 K = scaleM * mp->KArr[c];
+
+    const Matrix3x3 iK = K.inverse();
+    const Matrix3x4 P = K * (mp->RArr[c] | (Point3d(0.0, 0.0, 0.0) - mp->RArr[c] * mp->CArr[c]));
+    const Matrix3x3 iP = mp->iRArr[c] * iK;
+
+    const auto fill3x3 = [](float* o, const Matrix3x3& m) {
+        o[0] = m.m11; o[1] = m.m21; o[2] = m.m31;
+        o[3] = m.m12; o[4] = m.m22; o[5] = m.m32;
+        o[6] = m.m13; o[7] = m.m23; o[8] = m.m33;
+    };
+
+    cam.P[0] = P.m11; cam.P[1] = P.m21; cam.P[2] = P.m31;
+    cam.P[3] = P.m12; cam.P[4] = P.m22; cam.P[5] = P.m32;
+    cam.P[6] = P.m13; cam.P[7] = P.m23; cam.P[8] = P.m33;
+    cam.P[9] = P.m14; cam.P[10] = P.m24; cam.P[11] = P.m34;
+    fill3x3(cam.iP, iP);
+    fill3x3(cam.R, mp->RArr[c]);
+    fill3x3(cam.iR, mp->iRArr[c]);
+    fill3x3(cam.K, K);
+    fill3x3(cam.iK, iK);
+
+    cam.C = Vec3(mp->CArr[c].x, mp->CArr[c].y, mp->CArr[c].z);
+
+    cam.XVect = M3x3mulV3(cam.iR, Vec3(1.0f, 0.0f, 0.0f));
+    normalize(cam.XVect);
+    cam.YVect = M3x3mulV3(cam.iR, Vec3(0.0f, 1.0f, 0.0f));
+    normalize(cam.YVect);
+    cam.ZVect = M3x3mulV3(cam.iR, Vec3(0.0f, 0.0f, 1.0f));
+    normalize(cam.ZVect);
+}
+
+void PlaneSweepingCpu::fillCameraData(CachedCamera& cam, int c)
+{
+    mvsUtils::ImagesCache::ImgSharedPtr img = _ic.getImg_sync(c);
+
+    cam.levels.resize(_scales);
+
+    ImageLevel& level0 = cam.levels[0];
+    level0.width = mp->getWidth(c);
+    level0.height = mp->getHeight(c);
+    level0.data.resize(level0.width * level0.height);
+
+    #pragma omp parallel for
+    for(int y = 0; y < level0.height; ++y)
+    {
+        for(int x = 0; x < level0.width; ++x)
+        {
+            // same 8 bits quantization as the images uploaded to the GPU
+            const Color floatRGB = img->at(x, y) * 255.0f;
+            level0.data[y * level0.width + x] = rgb2lab(float(saturateUChar(floatRGB.r)) / 255.0f,
+                                                        float(saturateUChar(floatRGB.g)) / 255.0f,
+                                                        float(saturateUChar(floatRGB.b)) / 255.0f);
+        }
+    }
+
+    if(varianceWSH > 0)
+        computeGradientOfL(level0);
+
+    for(int scale = 1; scale < _scales; ++scale)
+    {
+        ImageLevel& level = cam.levels[scale];
+        downscaleGaussSmoothLab(level, level0, scale + 1, scale + 1);
+
+        if(varianceWSH > 0)
+            computeGradientOfL(level);
+    }
+}
+
+int PlaneSweepingCpu::addCam(int rc, int scale)
+{
+    int id = -1;
+    for(int i = 0; i < _cams.size(); ++i)
+    {
+        if(_cams[i].rc == rc)
+        {
+            id = i;
+            break;
+        }
+    }
+
+    if(id == -1)
+    {
+        // replace the least recently used image
+        id = 0;
+        for(int i = 1; i < _cams.size(); ++i)
+        {
+            if(_cams[i].time < _cams[id].time)
+                id = i;
+        }
+
+        long t1 = clock();
+
+        fillCameraData(_cams[id], rc);
+        _cams[id].rc = rc;
+
+        if(_verbose)
+            mvsUtils::printfElapsedTime(t1, "copy image from disk to memory ");
+    }
+
+    _cams[id].time = ++_camsClock;
+    return id;
+}
+
+bool PlaneSweepingCpu::refineRcTcDepthMap(bool useTcOrRcPixSize, int nStepsToRefine, StaticVector<float>* simMap,
+                                            StaticVector<float>* rcDepthMap, int rc, int tc, int scale, int wsh,
+                                            float gammaC, float gammaP, float epipShift, int xFrom, int wPart)
+{
+    const int w = wPart;
+    const int h = mp->getHeight(rc) / scale;
+    const int imWidth = mp->getWidth(rc) / scale;
+    const int imHeight = mp->getHeight(rc) / scale;
+
+    long t1 = clock();
+
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("\t- rc: " << rc << std::endl << "\t- tcams: " << tc);
+
+    CameraParams rcam;
+    CameraParams tcam;
+    fillCamera(rcam, rc, scale);
+    fillCamera(tcam, tc, scale);
+
+    CamPair cp;
+    cp.r = &rcam;
+    cp.t = &tcam;
+    cp.rImg = &_cams[addCam(rc, scale)].levels[scale - 1];
+    cp.tImg = &_cams[addCam(tc, scale)].levels[scale - 1];
+
+    #pragma omp parallel
+    {
+        // per-thread buffer of the patch samples
+        PatchSamples samples(wsh);
+
+        #pragma omp for schedule(dynamic)
+        for(int y = 0; y < h; ++y)
+        {
+            for(int x = 0; x < w; ++x)
+            {
+                const Vec2 pix(float(x + xFrom), float(y));
+                float& depth = (*rcDepthMap)[y * w + x];
+
+                // sweep over the steps along the reference (or target) ray and keep the best similarity
+                float bestSim = 1.0f;
+                float bestDpt = depth;
+                for(int i = 0; i < nStepsToRefine; ++i)
+                {
+                    float odpt = depth;
+                    float osim = 1.0f;
+                    if(depth > 0.0f)
+                    {
+                        osim = computeSimForDepthFromRC(cp, pix, depth, (float)(i - (nStepsToRefine - 1) / 2),
+                                                        useTcOrRcPixSize, samples, imWidth, imHeight, gammaC, gammaP,
+                                                        epipShift, &odpt);
+                    }
+                    if(i == 0 || osim < bestSim)
+                    {
+                        bestSim = osim;
+                        bestDpt = odpt;
+                    }
+                }
+
+                // similarities one step before and after the best depth for the sub-pixel refinement
+                Vec3 sims(1.1f, bestSim, 1.1f);
+                if(bestDpt > 0.0f)
+                {
+                    sims.x = computeSimForDepthFromRC(cp, pix, bestDpt, -1.0f, useTcOrRcPixSize, samples, imWidth,
+                                                      imHeight, gammaC, gammaP, epipShift, nullptr);
+                    sims.z = computeSimForDepthFromRC(cp, pix, bestDpt, +1.0f, useTcOrRcPixSize, samples, imWidth,
+                                                      imHeight, gammaC, gammaP, epipShift, nullptr);
+                }
+
+                float outDepth = bestDpt;
+                if(outDepth > 0.0f)
+                {
+                    const Vec3 pMid = get3DPointForPixelAndDepthFromRC(rcam, pix, bestDpt);
+                    Vec3 pm1 = pMid;
+                    Vec3 pp1 = pMid;
+                    move3DPointByTcOrRcPixStep(cp, pm1, -1.0f, useTcOrRcPixSize);
+                    move3DPointByTcOrRcPixStep(cp, pp1, +1.0f, useTcOrRcPixSize);
+
+                    const float refinedDepth =
+                        refineDepthSubPixel(Vec3(size(pm1 - rcam.C), bestDpt, size(pp1 - rcam.C)), sims);
+                    if(refinedDepth > 0.0f)
+                        outDepth = refinedDepth;
+                }
+
+                (*simMap)[y * w + x] = sims.y;
+                depth = outDepth;
+            }
+        }
+    }
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+float PlaneSweepingCpu::sweepPixelsToVolume(int nDepthsToSearch, StaticVector<unsigned char>* volume, int volDimX,
+                                              int volDimY, int volDimZ, int volStepXY, int volLUX, int volLUY,
+                                              int volLUZ, const std::vector<float>* depths, int rc, int wsh,
+                                              float gammaC, float gammaP, StaticVector<Voxel>* pixels, int scale,
+                                              int step, StaticVector<int>* tcams, float epipShift)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("sweepPixelsVolume:" << std::endl
+                              << "\t- scale: " << scale << std::endl
+                              << "\t- step: " << step << std::endl
+                              << "\t- npixels: " << pixels->size() << std::endl
+                              << "\t- volStepXY: " << volStepXY << std::endl
+                              << "\t- volDimX: " << volDimX << std::endl
+                              << "\t- volDimY: " << volDimY << std::endl
+                              << "\t- volDimZ: " << volDimZ);
+
+    const int w = mp->getWidth(rc) / scale;
+    const int h = mp->getHeight(rc) / scale;
+
+    long t1 = clock();
+
+    if((tcams->size() == 0) || (pixels->size() == 0))
+        return -1.0f;
+
+    // as the CUDA implementation, only the first target camera is used
+    const int tc = (*tcams)[0];
+
+    CameraParams rcam;
+    CameraParams tcam;
+    fillCamera(rcam, rc, scale);
+    fillCamera(tcam, tc, scale);
+
+    CamPair cp;
+    cp.r = &rcam;
+    cp.t = &tcam;
+    cp.rImg = &_cams[addCam(rc, scale)].levels[scale - 1];
+    cp.tImg = &_cams[addCam(tc, scale)].levels[scale - 1];
+
+    unsigned char* vol = volume->getDataWritable().data();
+    std::fill_n(vol, (size_t)volDimX * volDimY * volDimZ, 255);
+
+    const int ndepths = depths->size();
+    const int npixs = pixels->size();
+    const int slicesAtTime = std::min(npixs, 4096);
+
+    // the similarities of a batch of pixels are computed in parallel,
+    // then merged in the volume as several pixels can fall in the same voxel
+    std::vector<unsigned char> slice((size_t)slicesAtTime * nDepthsToSearch);
+
+    for(int pixFrom = 0; pixFrom < npixs; pixFrom += slicesAtTime)
+    {
+        const int nSlicePixs = std::min(slicesAtTime, npixs - pixFrom);
+
+        #pragma omp parallel
+        {
+            PatchSamples samples(wsh);
+
+            #pragma omp for schedule(dynamic)
+            for(int pixid = 0; pixid < nSlicePixs; ++pixid)
+            {
+                const Voxel& volPix = (*pixels)[pixFrom + pixid];
+                const Vec2 pix(float(volPix.x), float(volPix.y));
+                unsigned char* pixSlice = &slice[(size_t)pixid * nDepthsToSearch];
+
+                for(int sdptid = 0; sdptid < nDepthsToSearch; ++sdptid)
+                {
+                    const int depthid = sdptid + volPix.z;
+                    if(depthid >= ndepths)
+                        break;
+
+                    Patch ptch;
+                    const Vec3 p = get3DPointForPixelAndFrontoParellePlaneRC(rcam, pix, (*depths)[depthid]);
+                    ptch.d = computePixSize(rcam, p);
+                    computeRotCSEpip(cp, ptch, p);
+
+                    float fsim = compNCCby3DptsYK(cp, ptch, samples, w, h, gammaC, gammaP, epipShift);
+                    // map [-1, 1] to [0, 255]
+                    fsim = std::min(1.0f, std::max(0.0f, (fsim + 1.0f) / 2.0f));
+                    pixSlice[sdptid] = static_cast<unsigned char>(fsim * 255.0f);
+                }
+            }
+        }
+
+        for(int pixid = 0; pixid < nSlicePixs; ++pixid)
+        {
+            const Voxel& volPix = (*pixels)[pixFrom + pixid];
+            const int vx = (volPix.x - volLUX) / volStepXY;
+            const int vy = (volPix.y - volLUY) / volStepXY;
+            if((vx < 0) || (vx >= volDimX) || (vy < 0) || (vy >= volDimY))
+                continue;
+
+            const unsigned char* pixSlice = &slice[(size_t)pixid * nDepthsToSearch];
+            for(int sdptid = 0; sdptid < nDepthsToSearch; ++sdptid)
+            {
+                const int depthid = sdptid + volPix.z;
+                if(depthid >= ndepths)
+                    break;
+                const int vz = depthid - volLUZ;
+                if((vz < 0) || (vz >= volDimZ))
+                    continue;
+
+                unsigned char& volsim = vol[((size_t)vz * volDimY + vy) * volDimX + vx];
+                volsim = std::min(pixSlice[sdptid], volsim);
+            }
+        }
+    }
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return (float)((size_t)volDimX * volDimY * volDimZ) / (1024.0f * 1024.0f);
+}
+
+/**
+ * @param[inout] volume input similarity volume (after Z reduction)
+ */
+bool PlaneSweepingCpu::SGMoptimizeSimVolume(int rc, StaticVector<unsigned char>* volume, int volDimX, int volDimY,
+                                              int volDimZ, int volStepXY, int volLUX, int volLUY, int scale,
+                                              unsigned char P1, unsigned char P2)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("SGM optimizing volume:" << std::endl
+                              << "\t- volDimX: " << volDimX << std::endl
+                              << "\t- volDimY: " << volDimY << std::endl
+                              << "\t- volDimZ: " << volDimZ);
+
+    long t1 = clock();
+
+    const ImageLevel& rImg = _cams[addCam(rc, scale)].levels[scale - 1];
+
+    unsigned char* vol = volume->getDataWritable().data();
+    const int volDims[3] = {volDimX, volDimY, volDimZ};
+    const size_t volSize = (size_t)volDimX * volDimY * volDimZ;
+
+    std::vector<unsigned char> volAgr(volSize, 0);
+    std::vector<unsigned char> volT(volSize);
+
+    int npaths = 0;
+
+    const auto updateAggrVolume = [&](int dimTrnX, int dimTrnY, int dimTrnZ, bool invZ) {
+        const int dimsTrn[3] = {dimTrnX, dimTrnY, dimTrnZ};
+        const int dimT[3] = {volDims[dimTrnX], volDims[dimTrnY], volDims[dimTrnZ]};
+        // each column X is stored contiguously, with the depths (Y) as the innermost dimension
+        const auto indexT = [&](int vx, int vy, int vz) {
+            return ((size_t)vx * dimT[2] + vz) * dimT[1] + vy;
+        };
+        const auto toT = [&](int x, int y, int z) {
+            const int v[3] = {x, y, z};
+            // z slices are mirrored for the backward paths
+            const int vzT = invZ ? dimT[2] - 1 - v[dimsTrn[2]] : v[dimsTrn[2]];
+            return indexT(v[dimsTrn[0]], v[dimsTrn[1]], vzT);
+        };
+
+        // transpose the volume so that the path goes along Z
+        #pragma omp parallel for
+        for(int z = 0; z < volDimZ; ++z)
+            for(int y = 0; y < volDimY; ++y)
+                for(int x = 0; x < volDimX; ++x)
+                    volT[toT(x, y, z)] = vol[((size_t)z * volDimY + y) * volDimX + x];
+
+        // aggregate the costs along Z, each column X is independent
+        #pragma omp parallel for schedule(dynamic)
+        for(int vx = 0; vx < dimT[0]; ++vx)
+        {
+            const int nDepths = dimT[1];
+            std::vector<unsigned int> sliceForZ(nDepths);
+            std::vector<unsigned int> sliceForZM1(nDepths);
+
+            unsigned int bestCostInCol = 255;
+            unsigned char* volSimT = &volT[indexT(vx, 0, 0)];
+            for(int vy = 0; vy < nDepths; ++vy)
+            {
+                sliceForZ[vy] = volSimT[vy];
+                bestCostInCol = std::min(bestCostInCol, sliceForZ[vy]);
+                volSimT[vy] = 255;
+            }
+
+            for(int vz = 1; vz < dimT[2]; ++vz)
+            {
+                std::swap(sliceForZ, sliceForZM1);
+                const unsigned int bestCostInColM1 = bestCostInCol;
+
+                // the penalty of a depth jump only depends on the color change between the two pixels
+                const int z = invZ ? dimT[2] - vz : vz;
+                const int z1 = invZ ? z + 1 : z - 1;
+                const int imX0 = volLUX + ((dimTrnX == 0) ? vx : z);
+                const int imY0 = volLUY + ((dimTrnX == 0) ? z : vx);
+                const int imX1 = volLUX + ((dimTrnX == 0) ? vx : z1);
+                const int imY1 = volLUY + ((dimTrnX == 0) ? z1 : vx);
+                const Vec4 gcr0 = rImg.sample(float(imX0) + 0.5f, float(imY0) + 0.5f);
+                const Vec4 gcr1 = rImg.sample(float(imX1) + 0.5f, float(imY1) + 0.5f);
+                const float deltaC = euclidean3(gcr0, gcr1);
+                const unsigned int P2dyn = (unsigned int)sigmoid(15.0f, 255.0f, 80.0f, 20.0f, deltaC);
+                const unsigned int bestCostP2 = bestCostInColM1 + P2dyn;
+
+                volSimT = &volT[indexT(vx, 0, vz)];
+                const unsigned int* costM1 = sliceForZM1.data();
+                unsigned int* cost = sliceForZ.data();
+
+                // the first and the last depths are not aggregated
+                bestCostInCol = 255;
+                cost[0] = 255;
+                cost[nDepths - 1] = 255;
+                volSimT[0] = 255;
+                volSimT[nDepths - 1] = 255;
+
+                // all the depths of the slice at once
+                #pragma omp simd reduction(min:bestCostInCol)
+                for(int vy = 1; vy < nDepths - 1; ++vy)
+                {
+                    const unsigned int minCost = std::min(std::min(costM1[vy], costM1[vy - 1] + P1),
+                                                          std::min(costM1[vy + 1] + P1, bestCostP2));
+                    const unsigned int pathCost = volSimT[vy] + minCost - bestCostInColM1;
+
+                    volSimT[vy] = (unsigned char)std::min(255u, pathCost);
+                    cost[vy] = pathCost;
+                    bestCostInCol = std::min(bestCostInCol, pathCost);
+                }
+            }
+        }
+
+        // running average of the paths
+        #pragma omp parallel for
+        for(int z = 0; z < volDimZ; ++z)
+        {
+            for(int y = 0; y < volDimY; ++y)
+            {
+                for(int x = 0; x < volDimX; ++x)
+                {
+                    unsigned char& agr = volAgr[((size_t)z * volDimY + y) * volDimX + x];
+                    const float val = ((float)agr * (float)npaths + (float)volT[toT(x, y, z)]) / (float)(npaths + 1);
+                    agr = (unsigned char)std::min(255.0f, val);
+                }
+            }
+        }
+        ++npaths;
+    };
+
+    // XYZ -> XZY
+    updateAggrVolume(0, 2, 1, false);
+    // XYZ -> XZ'Y
+    updateAggrVolume(0, 2, 1, true);
+    // XYZ -> YZX
+    updateAggrVolume(1, 2, 0, false);
+    // XYZ -> YZ'X
+    updateAggrVolume(1, 2, 0, true);
+
+    std::copy(volAgr.begin(), volAgr.end(), vol);
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+// (avail, total, used) of the system memory in MB
+Point3d PlaneSweepingCpu::getDeviceMemoryInfo()
+{
+    const system::MemoryInfo memInfo = system::getMemoryInfo();
+    const double toMB = 1.0 / (1024.0 * 1024.0);
+    const double avail = memInfo.availableRam * toMB;
+    const double total = memInfo.totalRam * toMB;
+    return Point3d(avail, total, total - avail);
+}
+
+bool PlaneSweepingCpu::fuseDepthSimMapsGaussianKernelVoting(int w, int h, StaticVector<DepthSim>* oDepthSimMap,
+                                                              const StaticVector<StaticVector<DepthSim>*>* dataMaps,
+                                                              int nSamplesHalf, int nDepthsToRefine, float sigma)
+{
+    long t1 = clock();
+
+    const float samplesPerPixSize = (float)(nSamplesHalf / ((nDepthsToRefine - 1) / 2));
+    const float twoTimesSigmaPowerTwo = 2.0f * sigma * sigma;
+    const int ndepthSimMaps = dataMaps->size();
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int y = 0; y < h; ++y)
+    {
+        for(int x = 0; x < w; ++x)
+        {
+            const int i = y * w + x;
+            const DepthSim& midDepthPixSize = (*(*dataMaps)[0])[i];
+            DepthSim& oDepthSim = (*oDepthSimMap)[i];
+
+            if(midDepthPixSize.depth <= 0.0f)
+            {
+                oDepthSim.depth = -1.0f;
+                oDepthSim.sim = 1.0f;
+                continue;
+            }
+
+            const float depthStep = midDepthPixSize.sim / samplesPerPixSize;
+
+            // vote of each Tc depth for each sample around the middle depth
+            float bestGsvSample = 0.0f;
+            float bestS = 0.0f;
+            for(int s = -nSamplesHalf; s <= nSamplesHalf; ++s)
+            {
+                float gsvSample = 0.0f;
+                for(int c = 1; c < ndepthSimMaps; ++c)
+                {
+                    const DepthSim& depthSim = (*(*dataMaps)[c])[i];
+                    if(depthSim.depth > 0.0f)
+                    {
+                        const float id = (midDepthPixSize.depth - depthSim.depth) / depthStep;
+                        const float sim = -sigmoid(0.0f, 1.0f, 0.7f, -0.7f, depthSim.sim);
+                        gsvSample += sim * std::exp(-((id - s) * (id - s)) / twoTimesSigmaPowerTwo);
+                    }
+                }
+                if(s == -nSamplesHalf || gsvSample < bestGsvSample)
+                {
+                    bestGsvSample = gsvSample;
+                    bestS = (float)s;
+                }
+            }
+
+            oDepthSim.depth = midDepthPixSize.depth - bestS * depthStep;
+            oDepthSim.sim = bestGsvSample;
+        }
+    }
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>* oDepthSimMap,
+                                                            StaticVector<StaticVector<DepthSim>*>* dataMaps, int rc,
+                                                            int nSamplesHalf, int nDepthsToRefine, float sigma,
+                                                            int nIters, int yFrom, int hPart)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("optimizeDepthSimMapGradientDescent.");
+
+    const int scale = 1;
+    const int w = mp->getWidth(rc);
+    const int h = hPart;
+
+    long t1 = clock();
+
+    CameraParams rcam;
+    fillCamera(rcam, rc, scale);
+    const ImageLevel& rImg = _cams[addCam(rc, scale)].levels[scale - 1];
+
+    const StaticVector<DepthSim>& midDepthPixSizeMap = *(*dataMaps)[0];
+    const StaticVector<DepthSim>& fusedDepthSimMap = *(*dataMaps)[1];
+
+    std::vector<DepthSim> optDepthSimMap(w * h);
+    std::vector<float> optDepthMap(w * h);
+
+    for(int i = 0; i < w * h; ++i)
+        optDepthSimMap[i] = midDepthPixSizeMap[yFrom * w + i];
+
+    // depth of the previous iteration, clamped to the part borders like a CUDA texture
+    const auto depthAt = [&](int x, int y) {
+        x = std::min(std::max(x, 0), w - 1);
+        y = std::min(std::max(y, 0), h - 1);
+        return optDepthMap[y * w + x];
+    };
+
+    // (smoothStep, energy), see getCellSmoothStepEnergy
+    const auto getCellSmoothStepEnergy = [&](int x, int y) {
+        Vec2 out(0.0f, 180.0f);
+
+        const float d0 = depthAt(x, y);
+        if(d0 <= 0.0f)
+            return out;
+
+        const float dL = depthAt(x, y - 1);
+        const float dR = depthAt(x, y + 1);
+        const float dU = depthAt(x - 1, y);
+        const float dB = depthAt(x + 1, y);
+
+        const float py = float(y + yFrom);
+        const Vec3 p0 = get3DPointForPixelAndDepthFromRC(rcam, Vec2(float(x), py), d0);
+        const Vec3 pL = get3DPointForPixelAndDepthFromRC(rcam, Vec2(float(x), py - 1.0f), dL);
+        const Vec3 pR = get3DPointForPixelAndDepthFromRC(rcam, Vec2(float(x), py + 1.0f), dR);
+        const Vec3 pU = get3DPointForPixelAndDepthFromRC(rcam, Vec2(float(x - 1), py), dU);
+        const Vec3 pB = get3DPointForPixelAndDepthFromRC(rcam, Vec2(float(x + 1), py), dB);
+
+        Vec3 cg;
+        float n = 0.0f;
+        if(dL > 0.0f) { cg = cg + pL; n++; }
+        if(dR > 0.0f) { cg = cg + pR; n++; }
+        if(dU > 0.0f) { cg = cg + pU; n++; }
+        if(dB > 0.0f) { cg = cg + pB; n++; }
+
+        if(n > 1.0f)
+        {
+            cg = cg / n;
+            Vec3 vcn = rcam.C - p0;
+            normalize(vcn);
+            const Vec3 pS = closestPointToLine3D(cg, p0, vcn);
+            out.x = size(rcam.C - pS) - d0;
+        }
+
+        float e = 0.0f;
+        n = 0.0f;
+        if(dL > 0.0f && dR > 0.0f)
+        {
+            e = std::max(e, 180.0f - angleBetwABandAC(p0, pL, pR));
+            n++;
+        }
+        if(dU > 0.0f && dB > 0.0f)
+        {
+            e = std::max(e, 180.0f - angleBetwABandAC(p0, pU, pB));
+            n++;
+        }
+        if(n > 0.0f)
+            out.y = e;
+
+        return out;
+    };
+
+    const auto clampStep = [](float step, float maxStep) {
+        return step < 0.0f ? -std::min(std::fabs(step), maxStep) : std::min(std::fabs(step), maxStep);
+    };
+
+    for(int iter = 0; iter < nIters; ++iter)
+    {
+        for(int i = 0; i < w * h; ++i)
+            optDepthMap[i] = optDepthSimMap[i].depth;
+
+        #pragma omp parallel for schedule(dynamic)
+        for(int y = 0; y < h; ++y)
+        {
+            for(int x = 0; x < w; ++x)
+            {
+                const int jO = (y + yFrom) * w + x;
+                const DepthSim& midDepthPixSize = midDepthPixSizeMap[jO];
+                const DepthSim& fusedDepthSim = fusedDepthSimMap[jO];
+                DepthSim& optDepthSim = optDepthSimMap[y * w + x];
+
+                if(iter == 0)
+                    optDepthSim = DepthSim(midDepthPixSize.depth, fusedDepthSim.sim);
+
+                const float depthOpt = optDepthSim.depth;
+                if(depthOpt <= 0.0f)
+                    continue;
+
+                const Vec2 depthSmoothStepEnergy = getCellSmoothStepEnergy(x, y);
+                const float maxStep = midDepthPixSize.sim / 10.0f;
+                const float depthSmoothStep = clampStep(depthSmoothStepEnergy.x, maxStep);
+                const float depthPhotoStep = clampStep(fusedDepthSim.depth - depthOpt, maxStep);
+                const float depthVisStep = midDepthPixSize.depth - depthOpt;
+
+                const float depthSmoothVal = depthSmoothStepEnergy.y;
+                const float depthPhotoStepVal = fusedDepthSim.sim;
+
+                const float varianceGray = rImg.at(x, y + yFrom).w;
+                const float varianceGrayAndleWeight = sigmoid2(5.0f, 30.0f, 40.0f, 20.0f, varianceGray);
+                const float simWeight = sigmoid(0.0f, 1.0f, 0.7f, -0.7f, depthPhotoStepVal);
+                const float photoWeight = sigmoid(0.0f, 1.0f, 30.0f, varianceGrayAndleWeight, depthSmoothVal);
+                const float smoothWeight = 1.0f - photoWeight;
+                const float visWeight =
+                    1.0f - sigmoid(0.0f, 1.0f, 10.0f, 17.0f, std::fabs(depthVisStep / midDepthPixSize.sim));
+
+                const float depthOptStep =
+                    visWeight * depthVisStep +
+                    (1.0f - visWeight) * (photoWeight * simWeight * depthPhotoStep + smoothWeight * depthSmoothStep);
+
+                optDepthSim.depth = depthOpt + depthOptStep;
+                optDepthSim.sim = (1.0f - visWeight) * photoWeight * simWeight * depthPhotoStepVal +
+                                  (1.0f - visWeight) * smoothWeight * (depthSmoothVal / 20.0f);
+            }
+        }
+    }
+
+    for(int i = 0; i < w * h; ++i)
+        (*oDepthSimMap)[yFrom * w + i] = optDepthSimMap[i];
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+bool PlaneSweepingCpu::getSilhoueteMap(StaticVectorBool* oMap, int scale, int step, const rgb maskColor, int rc)
+{
+    if(_verbose)
+        ALICEVISION_LOG_DEBUG("getSilhoueteeMap: rc: " << rc);
+
+    const int w = mp->getWidth(rc) / scale;
+    const int h = mp->getHeight(rc) / scale;
+
+    long t1 = clock();
+
+    const ImageLevel& rImg = _cams[addCam(rc, scale)].levels[scale - 1];
+    const Rgba maskColorLab = rgb2lab(float(maskColor.r) / 255.0f, float(maskColor.g) / 255.0f,
+                                      float(maskColor.b) / 255.0f);
+
+    const int ws = w / step;
+    const int hs = h / step;
+
+    #pragma omp parallel for
+    for(int y = 0; y < hs; ++y)
+    {
+        for(int x = 0; x < ws; ++x)
+        {
+            const Rgba& col = rImg.at(x * step, y * step);
+            (*oMap)[y * ws + x] = (maskColorLab.x == col.x) && (maskColorLab.y == col.y) && (maskColorLab.z == col.z);
+        }
+    }
+
+    if(_verbose)
+        mvsUtils::printfElapsedTime(t1);
+
+    return true;
+}
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,85 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/Rgb.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mvsData/Voxel.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/depthMap/DepthSimMap.hpp>
+#include <aliceVision/depthMap/PlaneSweeping.hpp>
+#include <aliceVision/depthMap/cpu/commonStructures.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @brief Multi-threaded CPU implementation of the plane sweeping backend.
+ *
+ * Follows the computations of PlaneSweepingCuda kernel by kernel, with OpenMP
+ * parallel loops over pixels instead of CUDA blocks. The weighted NCC of a patch
+ * and the SGM aggregation over the depths of a slice are SIMD loops.
+ * It is used when no CUDA device is available or when the CPU backend is explicitly requested.
+ */
+class PlaneSweepingCpu : public PlaneSweeping
+{
+public:
+    /// Number of Lab images (with all their scales) kept in memory
+    int _nImgsInMemAtTime;
+    int varianceWSH;
+
+    PlaneSweepingCpu(mvsUtils::ImagesCache& ic, mvsUtils::MultiViewParams* _mp, int scales);
+    ~PlaneSweepingCpu(void) override;
+
+    /**
+     * @brief Load the camera in the image cache if needed.
+     * @return the id of the cache slot
+     */
+    int addCam(int rc, int scale);
+
+    bool refineRcTcDepthMap(bool useTcOrRcPixSize, int nStepsToRefine, StaticVector<float>* simMap,
+                            StaticVector<float>* rcDepthMap, int rc, int tc, int scale, int wsh, float gammaC,
+                            float gammaP, float epipShift, int xFrom, int wPart) override;
+
+    float sweepPixelsToVolume(int nDepthsToSearch, StaticVector<unsigned char>* volume, int volDimX, int volDimY,
+                              int volDimZ, int volStepXY, int volLUX, int volLUY, int volLUZ,
+                              const std::vector<float>* depths, int rc, int wsh, float gammaC, float gammaP,
+                              StaticVector<Voxel>* pixels, int scale, int step, StaticVector<int>* tcams,
+                              float epipShift) override;
+    bool SGMoptimizeSimVolume(int rc, StaticVector<unsigned char>* volume, int volDimX, int volDimY, int volDimZ,
+                              int volStepXY, int volLUX, int volLUY, int scale, unsigned char P1, unsigned char P2) override;
+    Point3d getDeviceMemoryInfo() override;
+
+    bool fuseDepthSimMapsGaussianKernelVoting(int w, int h, StaticVector<DepthSim>* oDepthSimMap,
+                                              const StaticVector<StaticVector<DepthSim>*>* dataMaps, int nSamplesHalf,
+                                              int nDepthsToRefine, float sigma) override;
+    bool optimizeDepthSimMapGradientDescent(StaticVector<DepthSim>* oDepthSimMap,
+                                            StaticVector<StaticVector<DepthSim>*>* dataMaps, int rc, int nSamplesHalf,
+                                            int nDepthsToRefine, float sigma, int nIters, int yFrom, int hPart) override;
+    bool getSilhoueteMap(StaticVectorBool* oMap, int scale, int step, const rgb maskColor, int rc) override;
+
+private:
+    struct CachedCamera
+    {
+        int rc = -1;
+        long time = 0;
+        /// Lab images, one per scale
+        std::vector<cpu::ImageLevel> levels;
+    };
+
+    std::vector<CachedCamera> _cams;
+    long _camsClock = 0;
+
+    void fillCamera(cpu::CameraParams& cam, int c, int scale) const;
+    void fillCameraData(CachedCamera& cam, int c);
+};
+
+} // namespace depthMap
+} // namespace aliceVision
@@ -0,0 +1,314 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+namespace cpu {
+
+/*********************************************************************************
+ * small vector types, mirroring the CUDA float2/float3/float4 arithmetic
+ *********************************************************************************/
+
+struct Vec2
+{
+    float x = 0.0f;
+    float y = 0.0f;
+
+    Vec2() = default;
+    Vec2(float _x, float _y) : x(_x), y(_y) {}
+
+    inline Vec2 operator+(const Vec2& v) const { return Vec2(x + v.x, y + v.y); }
+    inline Vec2 operator-(const Vec2& v) const { return Vec2(x - v.x, y - v.y); }
+    inline Vec2 operator*(float d) const { return Vec2(x * d, y * d); }
+};
+
+struct Vec3
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    Vec3() = default;
+    Vec3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+
+    inline Vec3 operator+(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+    inline Vec3 operator-(const Vec3& v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+    inline Vec3 operator*(float d) const { return Vec3(x * d, y * d, z * d); }
+    inline Vec3 operator/(float d) const { return Vec3(x / d, y / d, z / d); }
+};
+
+struct Vec4
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float w = 0.0f;
+
+    Vec4() = default;
+    Vec4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+
+    inline Vec4 operator+(const Vec4& v) const { return Vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
+    inline Vec4 operator*(float d) const { return Vec4(x * d, y * d, z * d, w * d); }
+};
+
+inline float dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float size(const Vec2& a) { return std::sqrt(dot(a, a)); }
+inline float size(const Vec3& a) { return std::sqrt(dot(a, a)); }
+
+inline void normalize(Vec2& a)
+{
+    const float d = size(a);
+    a.x /= d;
+    a.y /= d;
+}
+
+inline void normalize(Vec3& a)
+{
+    const float d = size(a);
+    a.x /= d;
+    a.y /= d;
+    a.z /= d;
+}
+
+inline Vec3 cross(const Vec3& a, const Vec3& b)
+{
+    return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+/**
+ * @brief Euclidean distance between the first three channels (Lab) of two colors.
+ */
+inline float euclidean3(const Vec4& a, const Vec4& b)
+{
+    return std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+}
+
+/*********************************************************************************
+ * matrices are stored column-major, as in the CUDA cameraStruct
+ *********************************************************************************/
+
+inline Vec3 M3x3mulV2(const float* M3x3, const Vec2& V)
+{
+    return Vec3(M3x3[0] * V.x + M3x3[3] * V.y + M3x3[6],
+                M3x3[1] * V.x + M3x3[4] * V.y + M3x3[7],
+                M3x3[2] * V.x + M3x3[5] * V.y + M3x3[8]);
+}
+
+inline Vec3 M3x3mulV3(const float* M3x3, const Vec3& V)
+{
+    return Vec3(M3x3[0] * V.x + M3x3[3] * V.y + M3x3[6] * V.z,
+                M3x3[1] * V.x + M3x3[4] * V.y + M3x3[7] * V.z,
+                M3x3[2] * V.x + M3x3[5] * V.y + M3x3[8] * V.z);
+}
+
+inline Vec3 M3x4mulV3(const float* M3x4, const Vec3& V)
+{
+    return Vec3(M3x4[0] * V.x + M3x4[3] * V.y + M3x4[6] * V.z + M3x4[9],
+                M3x4[1] * V.x + M3x4[4] * V.y + M3x4[7] * V.z + M3x4[10],
+                M3x4[2] * V.x + M3x4[5] * V.y + M3x4[8] * V.z + M3x4[11]);
+}
+
+inline Vec2 project3DPoint(const float* M3x4, const Vec3& V)
+{
+    const Vec3 p = M3x4mulV3(M3x4, V);
+    return Vec2(p.x / p.z, p.y / p.z);
+}
+
+inline Vec3 linePlaneIntersect(const Vec3& linePoint, const Vec3& lineVect, const Vec3& planePoint,
+                               const Vec3& planeNormal)
+{
+    const float k = (dot(planePoint, planeNormal) - dot(planeNormal, linePoint)) / dot(planeNormal, lineVect);
+    return linePoint + lineVect * k;
+}
+
+inline Vec3 closestPointToLine3D(const Vec3& point, const Vec3& linePoint, const Vec3& lineVectNormalized)
+{
+    return linePoint + lineVectNormalized * dot(lineVectNormalized, point - linePoint);
+}
+
+inline float pointLineDistance3D(const Vec3& point, const Vec3& linePoint, const Vec3& lineVectNormalized)
+{
+    return size(cross(lineVectNormalized, linePoint - point));
+}
+
+inline float angleBetwABandAC(const Vec3& A, const Vec3& B, const Vec3& C)
+{
+    Vec3 V1 = B - A;
+    Vec3 V2 = C - A;
+    normalize(V1);
+    normalize(V2);
+
+    float a = std::acos(dot(V1, V2));
+    a = std::isinf(a) ? 0.0f : a;
+
+    return std::fabs(a) / (3.14159265358979f / 180.0f);
+}
+
+/**
+ * @brief Shortest segment between the lines p1p2 and p3p4 (Paul Bourke).
+ * @param[out] k position of the solution on p1p2: p1 + k * (p2 - p1)
+ */
+inline void lineLineIntersect(float& k, const Vec3& p1, const Vec3& p2, const Vec3& p3, const Vec3& p4)
+{
+    const Vec3 p13 = p1 - p3;
+    const Vec3 p43 = p4 - p3;
+    const Vec3 p21 = p2 - p1;
+
+    const float d1343 = dot(p13, p43);
+    const float d4321 = dot(p43, p21);
+    const float d1321 = dot(p13, p21);
+    const float d4343 = dot(p43, p43);
+    const float d2121 = dot(p21, p21);
+
+    const float denom = d2121 * d4343 - d4321 * d4321;
+    const float numer = d1343 * d4321 - d1321 * d4343;
+
+    k = numer / denom;
+}
+
+inline float sigmoid(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((xval - sigMid) / sigwidth))));
+}
+
+inline float sigmoid2(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((sigMid - xval) / sigwidth))));
+}
+
+/*********************************************************************************
+ * camera and image storage
+ *********************************************************************************/
+
+struct CameraParams
+{
+    float P[12], iP[9], R[9], iR[9], K[9], iK[9];
+    Vec3 C;
+    Vec3 XVect;
+    Vec3 YVect;
+    Vec3 ZVect;
+};
+
+/**
+ * @brief Lab color in x, y, z and the gradient magnitude of L in w, all in [0, 255].
+ */
+struct Rgba
+{
+    unsigned char x = 0;
+    unsigned char y = 0;
+    unsigned char z = 0;
+    unsigned char w = 0;
+};
+
+/**
+ * @brief One pyramid level of an image, sampled like a CUDA texture
+ *        with linear filtering and clamped addressing.
+ */
+struct ImageLevel
+{
+    int width = 0;
+    int height = 0;
+    std::vector<Rgba> data;
+
+    inline const Rgba& at(int x, int y) const
+    {
+        x = std::min(std::max(x, 0), width - 1);
+        y = std::min(std::max(y, 0), height - 1);
+        return data[y * width + x];
+    }
+
+    /**
+     * @brief Bilinear sample, (x + 0.5, y + 0.5) returns exactly the value of pixel (x, y).
+     */
+    inline Vec4 sample(float u, float v) const
+    {
+        // clamp before the float to int conversion, the result is the same border texel
+        const float xb = std::isfinite(u) ? std::min(std::max(u - 0.5f, -1.0f), float(width)) : -1.0f;
+        const float yb = std::isfinite(v) ? std::min(std::max(v - 0.5f, -1.0f), float(height)) : -1.0f;
+        const float x0f = std::floor(xb);
+        const float y0f = std::floor(yb);
+        const float a = xb - x0f;
+        const float b = yb - y0f;
+        const int x0 = static_cast<int>(x0f);
+        const int y0 = static_cast<int>(y0f);
+
+        const Rgba& c00 = at(x0, y0);
+        const Rgba& c10 = at(x0 + 1, y0);
+        const Rgba& c01 = at(x0, y0 + 1);
+        const Rgba& c11 = at(x0 + 1, y0 + 1);
+
+        const float w00 = (1.0f - a) * (1.0f - b);
+        const float w10 = a * (1.0f - b);
+        const float w01 = (1.0f - a) * b;
+        const float w11 = a * b;
+
+        return Vec4(w00 * c00.x + w10 * c10.x + w01 * c01.x + w11 * c11.x,
+                    w00 * c00.y + w10 * c10.y + w01 * c01.y + w11 * c11.y,
+                    w00 * c00.z + w10 * c10.z + w01 * c01.z + w11 * c11.z,
+                    w00 * c00.w + w10 * c10.w + w01 * c01.w + w11 * c11.w);
+    }
+};
+
+/*********************************************************************************
+ * patch similarity
+ *********************************************************************************/
+
+struct Patch
+{
+    Vec3 p; //< 3D point
+    Vec3 n; //< normal
+    Vec3 x; //< x axis
+    Vec3 y; //< y axis, orthogonal to the epipolar plane
+    float d = 0.0f; //< pixel size
+};
+
+struct SimStat
+{
+    float xsum = 0.0f;
+    float ysum = 0.0f;
+    float xxsum = 0.0f;
+    float yysum = 0.0f;
+    float xysum = 0.0f;
+    float wsum = 0.0f;
+    float sim = 1.0f;
+
+    inline void update(float gx, float gy, float w)
+    {
+        wsum += w;
+        xsum += w * gx;
+        ysum += w * gy;
+        xxsum += w * gx * gx;
+        yysum += w * gy * gy;
+        xysum += w * gx * gy;
+    }
+
+    /**
+     * @brief Compute the weighted Normalized Cross-Correlation.
+     * @return similarity value in range (-1, 0) or 1 if infinity
+     */
+    inline void computeWSim()
+    {
+        const float varianceXW = (xxsum - xsum * xsum / wsum) / wsum;
+        const float varianceYW = (yysum - ysum * ysum / wsum) / wsum;
+        const float varianceXYW = (xysum - xsum * ysum / wsum) / wsum;
+
+        sim = varianceXYW / std::sqrt(varianceXW * varianceYW);
+        sim = std::isinf(sim) ? 1.0f : 0.0f - sim;
+        // fmin/fmax return the non-NaN operand, as the CUDA fminf/fmaxf
+        sim = std::fmax(std::fmin(sim, 1.0f), -1.0f);
+    }
+};
+
+} // namespace cpu
+} // namespace depthMap
+} // namespace aliceVision
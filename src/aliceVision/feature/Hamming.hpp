@@ -8,8 +8,10 @@
 #pragma once
 
 #include "metric.hpp"
+#include "distanceKernels.hpp"
 
 #include <bitset>
+#include <type_traits>
 
 #ifdef _MSC_VER
 typedef unsigned __int32 uint32_t;
@@ -26,7 +28,8 @@ typedef unsigned __int64 uint64_t;
 // Brief:
 // Hamming distance count the number of bits in common between descriptors
 //  by using a XOR operation + a count.
-// For maximal performance SSE4 must be enable for builtin popcount activation.
+// On unsigned char arrays, the count uses the runtime dispatched SIMD kernels (see distanceKernels.hpp).
+// Otherwise, for maximal performance SSE4 must be enable for builtin popcount activation.
 
 namespace aliceVision {
 namespace feature {
@@ -111,6 +114,12 @@ struct Hamming
   template <typename Iterator1, typename Iterator2>
   inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
   {
+    if(std::is_same<T, unsigned char>::value)
+    {
+      return getDistanceKernels().hamming(reinterpret_cast<const unsigned char*>(&a[0]),
+                                          reinterpret_cast<const unsigned char*>(&b[0]), size);
+    }
+
     ResultType result = 0;
 // Windows & generic platforms:
 
@@ -0,0 +1,166 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "PointFeature.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace feature {
+
+namespace {
+
+/// Magic string at the beginning of a binary features file
+const char binaryFeatsMagic[8] = {'A', 'V', 'F', 'E', 'A', 'T', 'B', '\0'};
+
+/// Current version of the binary features file format
+const std::uint32_t binaryFeatsVersion = 1;
+
+/**
+ * @brief Header of a binary features file.
+ * It is followed (at dataOffset bytes from the file beginning) by featureCount
+ * packed records of floatsPerFeature floats: x, y, scale, orientation.
+ * Values are stored in the host byte order (little-endian on all supported platforms).
+ */
+struct BinaryFeatsHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t floatsPerFeature;
+  std::uint64_t featureCount;
+  std::uint64_t dataOffset;
+};
+
+static_assert(sizeof(BinaryFeatsHeader) == 32, "Unexpected binary features header size.");
+
+// the binary records are directly copied into the PointFeature storage
+static_assert(sizeof(PointFeature) == 4 * sizeof(float), "PointFeature is expected to be stored as 4 packed floats.");
+
+} // namespace
+
+std::string EFeatureFileFormat_enumToString(EFeatureFileFormat format)
+{
+  switch(format)
+  {
+    case EFeatureFileFormat::TEXT:   return "text";
+    case EFeatureFileFormat::BINARY: return "binary";
+  }
+  throw std::out_of_range("Invalid EFeatureFileFormat enum: " + std::to_string(int(format)));
+}
+
+EFeatureFileFormat EFeatureFileFormat_stringToEnum(const std::string& format)
+{
+  std::string value = format;
+  std::transform(value.begin(), value.end(), value.begin(), ::tolower); // tolower
+
+  if(value == "text")   return EFeatureFileFormat::TEXT;
+  if(value == "binary") return EFeatureFileFormat::BINARY;
+
+  throw std::out_of_range("Invalid features file format: " + format);
+}
+
+std::ostream& operator<<(std::ostream& os, EFeatureFileFormat format)
+{
+  return os << EFeatureFileFormat_enumToString(format);
+}
+
+std::istream& operator>>(std::istream& in, EFeatureFileFormat& format)
+{
+  std::string token;
+  in >> token;
+  format = EFeatureFileFormat_stringToEnum(token);
+  return in;
+}
+
+bool isBinaryFeatsFile(const std::string& sfileNameFeats)
+{
+  std::ifstream fileIn(sfileNameFeats, std::ios::in | std::ios::binary);
+
+  if(!fileIn.is_open())
+    return false;
+
+  char magic[sizeof(binaryFeatsMagic)];
+  fileIn.read(magic, sizeof(magic));
+
+  return fileIn.gcount() == sizeof(magic) &&
+         std::memcmp(magic, binaryFeatsMagic, sizeof(magic)) == 0;
+}
+
+void loadFeatsFromBinFile(const std::string& sfileNameFeats, std::vector<PointFeature>& vec_feat)
+{
+  namespace bip = boost::interprocess;
+
+  vec_feat.clear();
+
+  bip::mapped_region region;
+  try
+  {
+    const bip::file_mapping mapping(sfileNameFeats.c_str(), bip::read_only);
+    region = bip::mapped_region(mapping, bip::read_only);
+  }
+  catch(const bip::interprocess_exception& e)
+  {
+    throw std::runtime_error("Can't load features binary file, can't open '" + sfileNameFeats + "' (" + e.what() + ") !");
+  }
+
+  const char* data = static_cast<const char*>(region.get_address());
+  const std::size_t fileSize = region.get_size();
+
+  if(fileSize < sizeof(BinaryFeatsHeader))
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' is incorrect !");
+
+  BinaryFeatsHeader header;
+  std::memcpy(&header, data, sizeof(header));
+
+  if(std::memcmp(header.magic, binaryFeatsMagic, sizeof(binaryFeatsMagic)) != 0)
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' is not a binary features file !");
+
+  if(header.version > binaryFeatsVersion)
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' has an unsupported version (" + std::to_string(header.version) + ") !");
+
+  if(header.floatsPerFeature != 4 ||
+     header.dataOffset < sizeof(BinaryFeatsHeader) ||
+     header.dataOffset > fileSize ||
+     header.featureCount > (fileSize - header.dataOffset) / sizeof(PointFeature))
+    throw std::runtime_error("Can't load features binary file, '" + sfileNameFeats + "' is incorrect !");
+
+  vec_feat.resize(header.featureCount);
+  if(!vec_feat.empty())
+    std::memcpy(static_cast<void*>(vec_feat.data()), data + header.dataOffset, header.featureCount * sizeof(PointFeature));
+}
+
+void saveFeatsToBinFile(const std::string& sfileNameFeats, const std::vector<PointFeature>& vec_feat)
+{
+  std::ofstream file(sfileNameFeats, std::ios::out | std::ios::binary);
+
+  if(!file.is_open())
+    throw std::runtime_error("Can't save features binary file, can't open '" + sfileNameFeats + "' !");
+
+  BinaryFeatsHeader header;
+  std::memcpy(header.magic, binaryFeatsMagic, sizeof(binaryFeatsMagic));
+  header.version = binaryFeatsVersion;
+  header.floatsPerFeature = 4;
+  header.featureCount = vec_feat.size();
+  header.dataOffset = sizeof(BinaryFeatsHeader);
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if(!vec_feat.empty())
+    file.write(reinterpret_cast<const char*>(vec_feat.data()), vec_feat.size() * sizeof(PointFeature));
+
+  if(!file.good())
+    throw std::runtime_error("Can't save features binary file, '" + sfileNameFeats + "' is incorrect !");
+
+  file.close();
+}
+
+} // namespace feature
+} // namespace aliceVision
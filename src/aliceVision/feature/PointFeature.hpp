@@ -11,6 +11,7 @@
 #include <iostream>
 #include <iterator>
 #include <fstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -94,9 +95,49 @@ inline std::istream& operator>>(std::istream& in, PointFeature& obj)
   return in >> obj._coords(0) >> obj._coords(1) >> obj._scale >> obj._orientation;
 }
 
-/// Read feats from file
+/**
+ * @brief Features file formats.
+ * The text format stores one "x y scale orientation" line per feature.
+ * The binary format stores a versioned header followed by packed (x, y, scale, orientation) floats,
+ * which can be memory-mapped and copied in one block instead of being parsed.
+ */
+enum class EFeatureFileFormat : unsigned char
+{
+  TEXT = 0,
+  BINARY
+};
+
+std::string EFeatureFileFormat_enumToString(EFeatureFileFormat format);
+EFeatureFileFormat EFeatureFileFormat_stringToEnum(const std::string& format);
+
+std::ostream& operator<<(std::ostream& os, EFeatureFileFormat format);
+std::istream& operator>>(std::istream& in, EFeatureFileFormat& format);
+
+/**
+ * @brief Check if the given features file uses the binary format.
+ * @param[in] sfileNameFeats The features file path (usually .feat)
+ * @return true if the file starts with the binary features header
+ */
+bool isBinaryFeatsFile(const std::string& sfileNameFeats);
+
+/**
+ * @brief Read point features from a binary features file.
+ * The file is memory-mapped read-only and the packed records are copied in a single block.
+ * @param[in] sfileNameFeats The features file path (usually .feat)
+ * @param[out] vec_feat The loaded features
+ */
+void loadFeatsFromBinFile(const std::string& sfileNameFeats, std::vector<PointFeature>& vec_feat);
+
+/**
+ * @brief Write point features to a binary features file.
+ * @param[in] sfileNameFeats The features file path (usually .feat)
+ * @param[in] vec_feat The features to save
+ */
+void saveFeatsToBinFile(const std::string& sfileNameFeats, const std::vector<PointFeature>& vec_feat);
+
+/// Read feats from text file
 template<typename FeaturesT >
-inline void loadFeatsFromFile(
+inline void loadFeatsFromTextFile(
   const std::string & sfileNameFeats,
   FeaturesT & vec_feat)
 {
@@ -116,11 +157,11 @@ inline void loadFeatsFromFile(
   fileIn.close();
 }
 
-/// Write feats to file
+/// Write feats to text file
 template<typename FeaturesT >
-inline void saveFeatsToFile(
+inline void saveFeatsToTextFile(
   const std::string & sfileNameFeats,
-  FeaturesT & vec_feat)
+  const FeaturesT & vec_feat)
 {
   std::ofstream file(sfileNameFeats.c_str());
 
@@ -135,6 +176,47 @@ inline void saveFeatsToFile(
   file.close();
 }
 
+/// Read feats from file
+template<typename FeaturesT >
+inline void loadFeatsFromFile(
+  const std::string & sfileNameFeats,
+  FeaturesT & vec_feat)
+{
+  loadFeatsFromTextFile(sfileNameFeats, vec_feat);
+}
+
+/// Write feats to file
+template<typename FeaturesT >
+inline void saveFeatsToFile(
+  const std::string & sfileNameFeats,
+  const FeaturesT & vec_feat)
+{
+  saveFeatsToTextFile(sfileNameFeats, vec_feat);
+}
+
+/// Read point feats from file, the file format (binary or text) is detected from the file header
+inline void loadFeatsFromFile(
+  const std::string & sfileNameFeats,
+  std::vector<PointFeature> & vec_feat)
+{
+  if(isBinaryFeatsFile(sfileNameFeats))
+    loadFeatsFromBinFile(sfileNameFeats, vec_feat);
+  else
+    loadFeatsFromTextFile(sfileNameFeats, vec_feat);
+}
+
+/// Write point feats to file in the given file format
+inline void saveFeatsToFile(
+  const std::string & sfileNameFeats,
+  const std::vector<PointFeature> & vec_feat,
+  EFeatureFileFormat fileFormat = EFeatureFileFormat::BINARY)
+{
+  if(fileFormat == EFeatureFileFormat::BINARY)
+    saveFeatsToBinFile(sfileNameFeats, vec_feat);
+  else
+    saveFeatsToTextFile(sfileNameFeats, vec_feat);
+}
+
 /// Export point feature based vector to a matrix [(x,y)'T, (x,y)'T]
 template< typename FeaturesT, typename MatT >
 void PointsToMat(
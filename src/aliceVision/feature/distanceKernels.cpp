@@ -0,0 +1,119 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "distanceKernels.hpp"
+#include "distanceKernelsSimd.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace aliceVision {
+namespace feature {
+namespace scalar {
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  unsigned int result = 0;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+float l2Float(const float* a, const float* b, std::size_t size)
+{
+  float result = 0.f;
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances)
+{
+  for(std::size_t j = 0; j < count; ++j)
+    distances[j] = l2Float(a, b + j * stride, size);
+}
+
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  unsigned int result = 0;
+  std::size_t i = 0;
+  for(; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    std::uint64_t va, vb;
+    std::memcpy(&va, a + i, sizeof(va));
+    std::memcpy(&vb, b + i, sizeof(vb));
+    std::uint64_t n = va ^ vb;
+    // popcount_3() from http://en.wikipedia.org/wiki/Hamming_weight
+    n -= ((n >> 1) & 0x5555555555555555ULL);
+    n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+    result += static_cast<unsigned int>((((n + (n >> 4)) & 0x0f0f0f0f0f0f0f0fULL) * 0x0101010101010101ULL) >> 56);
+  }
+  for(; i < size; ++i)
+  {
+    unsigned int n = a[i] ^ b[i];
+    for(; n; n &= n - 1)
+      ++result;
+  }
+  return result;
+}
+
+} // namespace scalar
+
+DistanceKernels getDistanceKernels(system::ESimdLevel simdLevel)
+{
+  DistanceKernels kernels;
+  kernels.simdLevel = system::ESimdLevel::NONE;
+  kernels.l2Uchar = &scalar::l2Uchar;
+  kernels.l2Float = &scalar::l2Float;
+  kernels.l2FloatOneToMany = &scalar::l2FloatOneToMany;
+  kernels.hamming = &scalar::hamming;
+
+#ifdef ALICEVISION_FEATURE_SIMD_KERNELS
+  switch(simdLevel)
+  {
+    case system::ESimdLevel::AVX512:
+      kernels.simdLevel = system::ESimdLevel::AVX512;
+      kernels.l2Uchar = &avx512::l2Uchar;
+      kernels.l2Float = &avx512::l2Float;
+      kernels.l2FloatOneToMany = &avx512::l2FloatOneToMany;
+      kernels.hamming = &avx512::hamming;
+      break;
+    case system::ESimdLevel::AVX2:
+      kernels.simdLevel = system::ESimdLevel::AVX2;
+      kernels.l2Uchar = &avx2::l2Uchar;
+      kernels.l2Float = &avx2::l2Float;
+      kernels.l2FloatOneToMany = &avx2::l2FloatOneToMany;
+      kernels.hamming = &avx2::hamming;
+      break;
+    case system::ESimdLevel::SSE4:
+      kernels.simdLevel = system::ESimdLevel::SSE4;
+      kernels.l2Uchar = &sse4::l2Uchar;
+      kernels.l2Float = &sse4::l2Float;
+      kernels.l2FloatOneToMany = &sse4::l2FloatOneToMany;
+      kernels.hamming = &sse4::hamming;
+      break;
+    case system::ESimdLevel::NONE:
+      break;
+  }
+#endif
+
+  return kernels;
+}
+
+const DistanceKernels& getDistanceKernels()
+{
+  static const DistanceKernels kernels = getDistanceKernels(system::getSimdLevel());
+  return kernels;
+}
+
+}  // namespace feature
+}  // namespace aliceVision
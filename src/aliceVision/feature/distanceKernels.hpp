@@ -0,0 +1,63 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/cpu.hpp>
+
+#include <cstddef>
+
+namespace aliceVision {
+namespace feature {
+
+/// Squared L2 distance between two unsigned char arrays of \p size elements
+typedef unsigned int (*L2UcharKernel)(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+/// Squared L2 distance between two float arrays of \p size elements
+typedef float (*L2FloatKernel)(const float* a, const float* b, std::size_t size);
+
+/**
+ * Squared L2 distances between the float array \p a and \p count float arrays of \p size elements,
+ * stored every \p stride elements from \p b, written to \p distances
+ */
+typedef void (*L2FloatOneToManyKernel)(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances);
+
+/// Hamming distance between two binary arrays of \p size bytes
+typedef unsigned int (*HammingKernel)(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+/**
+ * @brief Set of descriptor distance kernels compiled for a given SIMD instruction set level.
+ *
+ * The unsigned char L2 and the Hamming kernels give exactly the same results at every level.
+ * The float L2 kernels only differ by the summation order.
+ * The one-to-many float L2 kernel computes each distance like the float L2 kernel of the same level.
+ */
+struct DistanceKernels
+{
+  system::ESimdLevel simdLevel = system::ESimdLevel::NONE;
+  L2UcharKernel l2Uchar = nullptr;
+  L2FloatKernel l2Float = nullptr;
+  L2FloatOneToManyKernel l2FloatOneToMany = nullptr;
+  HammingKernel hamming = nullptr;
+};
+
+/**
+ * @brief Get the distance kernels for a given SIMD level.
+ * If the SIMD kernels are not available in this build (ALICEVISION_FEATURE_SIMD_KERNELS off), the scalar kernels are used.
+ * @param[in] simdLevel the requested SIMD level (it should be supported by the CPU)
+ * @return the distance kernels
+ */
+DistanceKernels getDistanceKernels(system::ESimdLevel simdLevel);
+
+/**
+ * @brief Get the distance kernels for the current CPU.
+ * The kernels are selected once, on the first call, from system::getSimdLevel().
+ * @return the distance kernels
+ */
+const DistanceKernels& getDistanceKernels();
+
+}  // namespace feature
+}  // namespace aliceVision
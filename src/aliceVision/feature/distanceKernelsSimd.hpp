@@ -0,0 +1,45 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+// Declarations of the SIMD distance kernels.
+// Each instruction set is implemented in its own translation unit, compiled with the matching
+// compiler flags. This header must stay free of any inline code from other headers, so that
+// no instruction from a higher instruction set can leak into code shared with other units.
+
+#include <cstddef>
+
+namespace aliceVision {
+namespace feature {
+namespace sse4 {
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size);
+float l2Float(const float* a, const float* b, std::size_t size);
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances);
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+} // namespace sse4
+
+namespace avx2 {
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size);
+float l2Float(const float* a, const float* b, std::size_t size);
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances);
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+} // namespace avx2
+
+namespace avx512 {
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size);
+float l2Float(const float* a, const float* b, std::size_t size);
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances);
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size);
+
+} // namespace avx512
+}  // namespace feature
+}  // namespace aliceVision
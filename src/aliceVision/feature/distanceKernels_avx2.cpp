@@ -0,0 +1,164 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// This file is compiled with AVX2 enabled.
+// Only call its functions if system::getSimdLevel() >= ESimdLevel::AVX2.
+
+#include "distanceKernelsSimd.hpp"
+
+#include <immintrin.h>
+
+namespace aliceVision {
+namespace feature {
+namespace avx2 {
+
+namespace {
+
+inline int horizontalSum(__m256i v)
+{
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(s);
+}
+
+inline float horizontalSum(__m256 v)
+{
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(s);
+}
+
+/// Number of bits set in each byte, using a nibble lookup table (W. Mula)
+inline __m256i popcountBytes(__m256i v)
+{
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i lowMask = _mm256_set1_epi8(0x0f);
+  const __m256i low = _mm256_and_si256(v, lowMask);
+  const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+  return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+}
+
+} // namespace
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m256i acc = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m128i aLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i aHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16));
+    const __m128i bLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    const __m128i bHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16));
+    // widen to 16 bits: differences are in [-255, 255]
+    const __m256i dLow = _mm256_sub_epi16(_mm256_cvtepu8_epi16(aLow), _mm256_cvtepu8_epi16(bLow));
+    const __m256i dHigh = _mm256_sub_epi16(_mm256_cvtepu8_epi16(aHigh), _mm256_cvtepu8_epi16(bHigh));
+    // squares summed by pairs into 32 bits
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(dLow, dLow));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(dHigh, dHigh));
+  }
+  unsigned int result = static_cast<unsigned int>(horizontalSum(acc));
+  for(; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+float l2Float(const float* a, const float* b, std::size_t size)
+{
+  __m256 acc = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 8 <= size; i += 8)
+  {
+    const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+    acc = _mm256_add_ps(acc, _mm256_mul_ps(diff, diff));
+  }
+  float result = horizontalSum(acc);
+  for(; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances)
+{
+  std::size_t j = 0;
+  // four arrays at a time, so that each element of a is loaded once for four distances
+  for(; j + 4 <= count; j += 4)
+  {
+    const float* b0 = b + j * stride;
+    const float* b1 = b0 + stride;
+    const float* b2 = b1 + stride;
+    const float* b3 = b2 + stride;
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+      const __m256 va = _mm256_loadu_ps(a + i);
+      const __m256 d0 = _mm256_sub_ps(va, _mm256_loadu_ps(b0 + i));
+      const __m256 d1 = _mm256_sub_ps(va, _mm256_loadu_ps(b1 + i));
+      const __m256 d2 = _mm256_sub_ps(va, _mm256_loadu_ps(b2 + i));
+      const __m256 d3 = _mm256_sub_ps(va, _mm256_loadu_ps(b3 + i));
+      acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(d0, d0));
+      acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(d1, d1));
+      acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(d2, d2));
+      acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(d3, d3));
+    }
+    float r0 = horizontalSum(acc0);
+    float r1 = horizontalSum(acc1);
+    float r2 = horizontalSum(acc2);
+    float r3 = horizontalSum(acc3);
+    for(; i < size; ++i)
+    {
+      const float d0 = a[i] - b0[i];
+      const float d1 = a[i] - b1[i];
+      const float d2 = a[i] - b2[i];
+      const float d3 = a[i] - b3[i];
+      r0 += d0 * d0;
+      r1 += d1 * d1;
+      r2 += d2 * d2;
+      r3 += d3 * d3;
+    }
+    distances[j] = r0;
+    distances[j + 1] = r1;
+    distances[j + 2] = r2;
+    distances[j + 3] = r3;
+  }
+  for(; j < count; ++j)
+    distances[j] = l2Float(a, b + j * stride, size);
+}
+
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m256i acc = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for(; i + 32 <= size; i += 32)
+  {
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    // sum the bytes counts into four 64 bits counters
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(popcountBytes(_mm256_xor_si256(va, vb)), _mm256_setzero_si256()));
+  }
+  // the 64 bits counters are small enough to be summed as 32 bits values
+  unsigned int result = static_cast<unsigned int>(horizontalSum(acc));
+  for(; i < size; ++i)
+    result += static_cast<unsigned int>(_mm_popcnt_u32(a[i] ^ b[i]));
+  return result;
+}
+
+} // namespace avx2
+}  // namespace feature
+}  // namespace aliceVision
@@ -0,0 +1,150 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// This file is compiled with AVX-512 F and BW enabled.
+// Only call its functions if system::getSimdLevel() >= ESimdLevel::AVX512.
+
+#include "distanceKernelsSimd.hpp"
+
+#include <immintrin.h>
+
+namespace aliceVision {
+namespace feature {
+namespace avx512 {
+
+namespace {
+
+/// Number of bits set in each byte, using a nibble lookup table (W. Mula)
+inline __m512i popcountBytes(__m512i v)
+{
+  const __m512i lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+  const __m512i lowMask = _mm512_set1_epi8(0x0f);
+  const __m512i low = _mm512_and_si512(v, lowMask);
+  const __m512i high = _mm512_and_si512(_mm512_srli_epi16(v, 4), lowMask);
+  return _mm512_add_epi8(_mm512_shuffle_epi8(lookup, low), _mm512_shuffle_epi8(lookup, high));
+}
+
+} // namespace
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m512i acc = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for(; i + 64 <= size; i += 64)
+  {
+    const __m256i aLow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i aHigh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32));
+    const __m256i bLow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    const __m256i bHigh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32));
+    // widen to 16 bits: differences are in [-255, 255]
+    const __m512i dLow = _mm512_sub_epi16(_mm512_cvtepu8_epi16(aLow), _mm512_cvtepu8_epi16(bLow));
+    const __m512i dHigh = _mm512_sub_epi16(_mm512_cvtepu8_epi16(aHigh), _mm512_cvtepu8_epi16(bHigh));
+    // squares summed by pairs into 32 bits
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(dLow, dLow));
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(dHigh, dHigh));
+  }
+  unsigned int result = static_cast<unsigned int>(_mm512_reduce_add_epi32(acc));
+  for(; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+float l2Float(const float* a, const float* b, std::size_t size)
+{
+  __m512 acc = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+    acc = _mm512_add_ps(acc, _mm512_mul_ps(diff, diff));
+  }
+  float result = _mm512_reduce_add_ps(acc);
+  for(; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances)
+{
+  std::size_t j = 0;
+  // four arrays at a time, so that each element of a is loaded once for four distances
+  for(; j + 4 <= count; j += 4)
+  {
+    const float* b0 = b + j * stride;
+    const float* b1 = b0 + stride;
+    const float* b2 = b1 + stride;
+    const float* b3 = b2 + stride;
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+    std::size_t i = 0;
+    for(; i + 16 <= size; i += 16)
+    {
+      const __m512 va = _mm512_loadu_ps(a + i);
+      const __m512 d0 = _mm512_sub_ps(va, _mm512_loadu_ps(b0 + i));
+      const __m512 d1 = _mm512_sub_ps(va, _mm512_loadu_ps(b1 + i));
+      const __m512 d2 = _mm512_sub_ps(va, _mm512_loadu_ps(b2 + i));
+      const __m512 d3 = _mm512_sub_ps(va, _mm512_loadu_ps(b3 + i));
+      acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(d0, d0));
+      acc1 = _mm512_add_ps(acc1, _mm512_mul_ps(d1, d1));
+      acc2 = _mm512_add_ps(acc2, _mm512_mul_ps(d2, d2));
+      acc3 = _mm512_add_ps(acc3, _mm512_mul_ps(d3, d3));
+    }
+    float r0 = _mm512_reduce_add_ps(acc0);
+    float r1 = _mm512_reduce_add_ps(acc1);
+    float r2 = _mm512_reduce_add_ps(acc2);
+    float r3 = _mm512_reduce_add_ps(acc3);
+    for(; i < size; ++i)
+    {
+      const float d0 = a[i] - b0[i];
+      const float d1 = a[i] - b1[i];
+      const float d2 = a[i] - b2[i];
+      const float d3 = a[i] - b3[i];
+      r0 += d0 * d0;
+      r1 += d1 * d1;
+      r2 += d2 * d2;
+      r3 += d3 * d3;
+    }
+    distances[j] = r0;
+    distances[j + 1] = r1;
+    distances[j + 2] = r2;
+    distances[j + 3] = r3;
+  }
+  for(; j < count; ++j)
+    distances[j] = l2Float(a, b + j * stride, size);
+}
+
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m512i acc = _mm512_setzero_si512();
+  std::size_t i = 0;
+  for(; i + 64 <= size; i += 64)
+  {
+    const __m512i va = _mm512_loadu_si512(a + i);
+    const __m512i vb = _mm512_loadu_si512(b + i);
+    // sum the bytes counts into eight 64 bits counters
+    acc = _mm512_add_epi64(acc, _mm512_sad_epu8(popcountBytes(_mm512_xor_si512(va, vb)), _mm512_setzero_si512()));
+  }
+  unsigned int result = static_cast<unsigned int>(_mm512_reduce_add_epi64(acc));
+  for(; i < size; ++i)
+  {
+    unsigned int n = a[i] ^ b[i];
+    for(; n; n &= n - 1)
+      ++result;
+  }
+  return result;
+}
+
+} // namespace avx512
+}  // namespace feature
+}  // namespace aliceVision
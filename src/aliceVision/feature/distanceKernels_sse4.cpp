@@ -0,0 +1,160 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// This file is compiled with SSE4.1 and POPCNT enabled.
+// Only call its functions if system::getSimdLevel() >= ESimdLevel::SSE4.
+
+#include "distanceKernelsSimd.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <nmmintrin.h>
+#include <smmintrin.h>
+
+namespace aliceVision {
+namespace feature {
+namespace sse4 {
+
+namespace {
+
+inline int horizontalSum(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+inline float horizontalSum(__m128 v)
+{
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+  return _mm_cvtss_f32(v);
+}
+
+inline unsigned int popcount64(std::uint64_t v)
+{
+#if defined(__x86_64__) || defined(_M_X64)
+  return static_cast<unsigned int>(_mm_popcnt_u64(v));
+#else
+  return static_cast<unsigned int>(_mm_popcnt_u32(static_cast<std::uint32_t>(v)) +
+                                   _mm_popcnt_u32(static_cast<std::uint32_t>(v >> 32)));
+#endif
+}
+
+} // namespace
+
+unsigned int l2Uchar(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  __m128i acc = _mm_setzero_si128();
+  std::size_t i = 0;
+  for(; i + 16 <= size; i += 16)
+  {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    // widen to 16 bits: differences are in [-255, 255]
+    const __m128i dLow = _mm_sub_epi16(_mm_cvtepu8_epi16(va), _mm_cvtepu8_epi16(vb));
+    const __m128i dHigh = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(va, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(vb, 8)));
+    // squares summed by pairs into 32 bits
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(dLow, dLow));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(dHigh, dHigh));
+  }
+  unsigned int result = static_cast<unsigned int>(horizontalSum(acc));
+  for(; i < size; ++i)
+  {
+    const int diff = int(a[i]) - int(b[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+float l2Float(const float* a, const float* b, std::size_t size)
+{
+  __m128 acc = _mm_setzero_ps();
+  std::size_t i = 0;
+  for(; i + 4 <= size; i += 4)
+  {
+    const __m128 diff = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+    acc = _mm_add_ps(acc, _mm_mul_ps(diff, diff));
+  }
+  float result = horizontalSum(acc);
+  for(; i < size; ++i)
+  {
+    const float diff = a[i] - b[i];
+    result += diff * diff;
+  }
+  return result;
+}
+
+void l2FloatOneToMany(const float* a, const float* b, std::size_t count, std::size_t stride, std::size_t size, float* distances)
+{
+  std::size_t j = 0;
+  // four arrays at a time, so that each element of a is loaded once for four distances
+  for(; j + 4 <= count; j += 4)
+  {
+    const float* b0 = b + j * stride;
+    const float* b1 = b0 + stride;
+    const float* b2 = b1 + stride;
+    const float* b3 = b2 + stride;
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+    std::size_t i = 0;
+    for(; i + 4 <= size; i += 4)
+    {
+      const __m128 va = _mm_loadu_ps(a + i);
+      const __m128 d0 = _mm_sub_ps(va, _mm_loadu_ps(b0 + i));
+      const __m128 d1 = _mm_sub_ps(va, _mm_loadu_ps(b1 + i));
+      const __m128 d2 = _mm_sub_ps(va, _mm_loadu_ps(b2 + i));
+      const __m128 d3 = _mm_sub_ps(va, _mm_loadu_ps(b3 + i));
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(d2, d2));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(d3, d3));
+    }
+    float r0 = horizontalSum(acc0);
+    float r1 = horizontalSum(acc1);
+    float r2 = horizontalSum(acc2);
+    float r3 = horizontalSum(acc3);
+    for(; i < size; ++i)
+    {
+      const float d0 = a[i] - b0[i];
+      const float d1 = a[i] - b1[i];
+      const float d2 = a[i] - b2[i];
+      const float d3 = a[i] - b3[i];
+      r0 += d0 * d0;
+      r1 += d1 * d1;
+      r2 += d2 * d2;
+      r3 += d3 * d3;
+    }
+    distances[j] = r0;
+    distances[j + 1] = r1;
+    distances[j + 2] = r2;
+    distances[j + 3] = r3;
+  }
+  for(; j < count; ++j)
+    distances[j] = l2Float(a, b + j * stride, size);
+}
+
+unsigned int hamming(const unsigned char* a, const unsigned char* b, std::size_t size)
+{
+  unsigned int result = 0;
+  std::size_t i = 0;
+  for(; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+  {
+    std::uint64_t va, vb;
+    std::memcpy(&va, a + i, sizeof(va));
+    std::memcpy(&vb, b + i, sizeof(vb));
+    result += popcount64(va ^ vb);
+  }
+  for(; i < size; ++i)
+    result += static_cast<unsigned int>(_mm_popcnt_u32(a[i] ^ b[i]));
+  return result;
+}
+
+} // namespace sse4
+}  // namespace feature
+}  // namespace aliceVision
@@ -56,7 +56,8 @@ BOOST_AUTO_TEST_CASE(featureIO_ASCII) {
   }
 
   //Save them to a file
-  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeats.feat", vec_feats));
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeats.feat", vec_feats, EFeatureFileFormat::TEXT));
+  BOOST_CHECK(!isBinaryFeatsFile("tempFeats.feat"));
 
   //Read the saved data and compare to input (to check write/read IO)
   Feats_T vec_feats_read;
@@ -71,6 +72,39 @@ BOOST_AUTO_TEST_CASE(featureIO_ASCII) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(featureIO_BINARY) {
+  Feats_T vec_feats;
+  for(int i = 0; i < CARD; ++i)  {
+    vec_feats.push_back(Feature_T(i, i*2, i*3, i*4));
+  }
+
+  //Save them to a file
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeatsBin.feat", vec_feats, EFeatureFileFormat::BINARY));
+  BOOST_CHECK(isBinaryFeatsFile("tempFeatsBin.feat"));
+
+  //Read the saved data and compare to input (to check write/read IO)
+  Feats_T vec_feats_read;
+  BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeatsBin.feat", vec_feats_read));
+  BOOST_CHECK_EQUAL(CARD, vec_feats_read.size());
+
+  for(int i = 0; i < CARD; ++i) {
+    BOOST_CHECK_EQUAL(vec_feats[i], vec_feats_read[i]);
+  }
+
+  //Empty features set
+  BOOST_CHECK_NO_THROW(saveFeatsToFile("tempFeatsBin.feat", Feats_T(), EFeatureFileFormat::BINARY));
+  BOOST_CHECK_NO_THROW(loadFeatsFromFile("tempFeatsBin.feat", vec_feats_read));
+  BOOST_CHECK(vec_feats_read.empty());
+
+  //Truncated file
+  {
+    std::ofstream file("tempFeatsTruncated.feat", std::ios::out | std::ios::binary);
+    file.write("AVFEATB", 8);
+  }
+  BOOST_CHECK(isBinaryFeatsFile("tempFeatsTruncated.feat"));
+  BOOST_CHECK_THROW(loadFeatsFromFile("tempFeatsTruncated.feat", vec_feats_read), std::exception);
+}
+
 //--
 //-- Descriptors interface test
 //--
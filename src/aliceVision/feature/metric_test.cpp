@@ -8,7 +8,9 @@
 #include <aliceVision/feature/metric.hpp>
 
 #include <iostream>
+#include <random>
 #include <string>
+#include <vector>
 
 #define BOOST_TEST_MODULE matchingMetric
 
@@ -135,3 +137,53 @@ BOOST_AUTO_TEST_CASE(Metric_HAMMING_BITSET_RAW_MEMORY_32BITS)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(Metric_DistanceKernels)
+{
+  std::mt19937 randomNumberGenerator(1234);
+  std::uniform_int_distribution<int> ucharDistribution(0, 255);
+  std::uniform_real_distribution<float> floatDistribution(0.f, 1.f);
+
+  const DistanceKernels scalarKernels = getDistanceKernels(system::ESimdLevel::NONE);
+  const system::ESimdLevel cpuSimdLevel = system::getSimdLevel();
+
+  // check every SIMD level supported by the CPU against the scalar kernels
+  for(int level = 0; level <= static_cast<int>(cpuSimdLevel); ++level)
+  {
+    const DistanceKernels kernels = getDistanceKernels(static_cast<system::ESimdLevel>(level));
+    BOOST_TEST_MESSAGE("Check distance kernels: " << system::ESimdLevel_enumToString(kernels.simdLevel));
+
+    // cover the vectorized loops and the tails of every instruction set
+    for(std::size_t size : {1, 7, 8, 15, 16, 31, 32, 33, 61, 64, 100, 128, 129, 256})
+    {
+      std::vector<unsigned char> ucharA(size), ucharB(size);
+      std::vector<float> floatA(size), floatB(size);
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        ucharA[i] = static_cast<unsigned char>(ucharDistribution(randomNumberGenerator));
+        ucharB[i] = static_cast<unsigned char>(ucharDistribution(randomNumberGenerator));
+        floatA[i] = floatDistribution(randomNumberGenerator);
+        floatB[i] = floatDistribution(randomNumberGenerator);
+      }
+      // extreme values
+      ucharA[0] = 255;
+      ucharB[0] = 0;
+
+      BOOST_CHECK_EQUAL(scalarKernels.l2Uchar(ucharA.data(), ucharB.data(), size), kernels.l2Uchar(ucharA.data(), ucharB.data(), size));
+      BOOST_CHECK_EQUAL(scalarKernels.hamming(ucharA.data(), ucharB.data(), size), kernels.hamming(ucharA.data(), ucharB.data(), size));
+      BOOST_CHECK_EQUAL(0, kernels.hamming(ucharA.data(), ucharA.data(), size));
+      BOOST_CHECK_CLOSE(scalarKernels.l2Float(floatA.data(), floatB.data(), size), kernels.l2Float(floatA.data(), floatB.data(), size), 1e-3);
+
+      // one-to-many: 6 arrays, to cover the blocks of 4 and the remaining arrays
+      const std::size_t count = 6;
+      const std::size_t stride = size + 3;
+      std::vector<float> floatMany(count * stride);
+      for(float& value : floatMany)
+        value = floatDistribution(randomNumberGenerator);
+      std::vector<float> distances(count);
+      kernels.l2FloatOneToMany(floatA.data(), floatMany.data(), count, stride, size, distances.data());
+      for(std::size_t j = 0; j < count; ++j)
+        BOOST_CHECK_CLOSE(kernels.l2Float(floatA.data(), floatMany.data() + j * stride, size), distances[j], 1e-4);
+    }
+  }
+}
@@ -10,6 +10,7 @@
 #include "DelaunayGraphCut.hpp"
 // #include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 #include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
@@ -19,6 +20,7 @@
 #include <aliceVision/mvsUtils/fileIO.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 
 #include "nanoflann.hpp"
@@ -28,6 +30,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <bitset>
+#include <fstream>
+#include <numeric>
 #include <random>
 #include <stdexcept>
 
@@ -267,6 +272,470 @@ void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vecto
     verticesAttrPrepare.swap(verticesAttrTmp);
 }
 
+/**
+ * @brief Select the best depth map point of each tile of step x step pixels of a camera.
+ * The pixel size of the discarded tiles is set to -1.
+ * @param[in] offset The index of the first tile of the camera in the output vectors
+ * @return false if the depth map is empty
+ */
+bool loadDepthMapTilesPoints(mvsUtils::MultiViewParams* mp, int c, int step, const Point3d voxel[8], const FuseParams& params, std::size_t offset,
+                             std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare)
+{
+    std::vector<float> depthMap;
+    std::vector<float> simMap;
+    std::vector<unsigned char> numOfModalsMap;
+    int width, height;
+    {
+        const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
+        imageIO::readImage(depthMapFilepath, width, height, depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
+        if(depthMap.empty())
+        {
+            ALICEVISION_LOG_WARNING("Empty depth map: " << depthMapFilepath);
+            return false;
+        }
+        int wTmp, hTmp;
+        const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
+        // If we have a simMap in input use it,
+        // else init with a constant value.
+        if(boost::filesystem::exists(simMapFilepath))
+        {
+            imageIO::readImage(simMapFilepath, wTmp, hTmp, simMap, imageIO::EImageColorSpace::NO_CONVERSION);
+            if(wTmp != width || hTmp != height)
+                throw std::runtime_error("Wrong sim map dimensions: " + simMapFilepath);
+            {
+                std::vector<float> simMapTmp(simMap.size());
+                imageAlgo::convolveImage(width, height, simMap, simMapTmp, "gaussian",
+                                         params.simGaussianSizeInit, params.simGaussianSizeInit);
+                simMap.swap(simMapTmp);
+            }
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("simMap file can't be found.");
+            simMap.resize(width * height, -1);
+        }
+
+        const std::string nmodMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::nmodMap, 0);
+        // If we have an nModMap in input (from depthmapfilter) use it,
+        // else init with a constant value.
+        if(boost::filesystem::exists(nmodMapFilepath))
+        {
+            imageIO::readImage(nmodMapFilepath, wTmp, hTmp, numOfModalsMap,
+                               imageIO::EImageColorSpace::NO_CONVERSION);
+            if(wTmp != width || hTmp != height)
+                throw std::runtime_error("Wrong nmod map dimensions: " + nmodMapFilepath);
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("nModMap file can't be found.");
+            numOfModalsMap.resize(width*height, 1);
+        }
+    }
+
+    int syMax = std::ceil(height/step);
+    int sxMax = std::ceil(width/step);
+    #pragma omp parallel for
+    for(int sy = 0; sy < syMax; ++sy)
+    {
+        for(int sx = 0; sx < sxMax; ++sx)
+        {
+            const std::size_t index = offset + sy * sxMax + sx;
+            float bestDepth = std::numeric_limits<float>::max();
+            float bestScore = 0;
+            float bestSimScore = 0;
+            int bestX = 0;
+            int bestY = 0;
+            for(int y = sy * step, ymax = std::min((sy+1) * step, height);
+                y < ymax; ++y)
+            {
+                for(int x = sx * step, xmax = std::min((sx+1) * step, width);
+                    x < xmax; ++x)
+                {
+                    const std::size_t index = y * width + x;
+                    const float depth = depthMap[index];
+                    if(depth <= 0.0f)
+                        continue;
+
+                    int numOfModals = 0;
+                    const int scoreKernelSize = 1;
+                    for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
+                    {
+                        for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
+                        {
+                            if(depthMap[ly * width + lx] > 0.0f)
+                            {
+                                numOfModals += 10 + int(numOfModalsMap[ly * width + lx]);
+                            }
+                        }
+                    }
+                    float sim = simMap[index];
+                    sim = sim < 0.0f ?  0.0f : sim; // clamp values < 0
+                    // remap similarity values from [-1;+1] to [+1;+simScale]
+                    // interpretation is [goodSimilarity;badSimilarity]
+                    const float simScore = 1.0f + sim * params.simFactor;
+
+                    const float score = numOfModals + (1.0f / simScore);
+                    if(score > bestScore)
+                    {
+                        bestDepth = depth;
+                        bestScore = score;
+                        bestSimScore = simScore;
+                        bestX = x;
+                        bestY = y;
+                    }
+                }
+            }
+            if(bestScore < 3*13)
+            {
+                // discard the point
+                pixSizePrepare[index] = -1.0;
+            }
+            else
+            {
+                Point3d p = mp->CArr[c] + (mp->iCamArr[c] * Point2d((float)bestX, (float)bestY)).normalize() * bestDepth;
+                
+                // TODO: isPointInHexahedron: here or in the previous loop per pixel to not loose point?
+                if(voxel == nullptr || mvsUtils::isPointInHexahedron(p, voxel)) 
+                {
+                    verticesCoordsPrepare[index] = p;
+                    simScorePrepare[index] = bestSimScore;
+                    pixSizePrepare[index] = mp->getCamPixelSize(p, c);
+                }
+                else
+                {
+                    // discard the point
+                    // verticesCoordsPrepare[index] = p;
+                    pixSizePrepare[index] = -1.0;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/// depth map point written in the temporary files of the streaming fusion
+struct StreamedPoint
+{
+    /// index of the point in the in-memory fusion
+    std::uint64_t index;
+    Point3d coords;
+    double pixSize;
+    float simScore;
+    /// the point is only loaded to filter the points of a neighboring slab
+    std::uint32_t isHalo;
+};
+
+/// estimated memory per point to filter a slab: points, scores, indexes and kd-tree
+static const std::size_t streamingBytesPerPoint = 2 * sizeof(StreamedPoint);
+
+/**
+ * @brief Read the points of a streaming fusion file by chunks
+ * @param[in] filepath The file written with StreamedPoint records
+ * @param[in] callback Function called on each point
+ */
+template<class Callback>
+void readStreamedPoints(const std::string& filepath, Callback callback)
+{
+    std::ifstream stream(filepath, std::ios::binary);
+    if(!stream.is_open())
+        throw std::runtime_error("Unable to open the fusion temporary file: " + filepath);
+
+    std::vector<StreamedPoint> chunk(1 << 16);
+    while(stream)
+    {
+        stream.read(reinterpret_cast<char*>(chunk.data()), chunk.size() * sizeof(StreamedPoint));
+        const std::size_t nbPoints = std::size_t(stream.gcount()) / sizeof(StreamedPoint);
+        for(std::size_t i = 0; i < nbPoints; ++i)
+            callback(chunk[i]);
+    }
+}
+
+/// maximum number of slabs files written at the same time
+static const std::size_t maxOpenSlabsFiles = 256;
+
+/// remove the temporary folder of the streaming fusion when leaving the scope, also on exceptions
+struct StreamingFolderCleaner
+{
+    explicit StreamingFolderCleaner(const bfs::path& folder)
+        : folder(folder)
+    {}
+
+    ~StreamingFolderCleaner()
+    {
+        boost::system::error_code error;
+        bfs::remove_all(folder, error);
+        if(error)
+            ALICEVISION_LOG_WARNING("Unable to remove the fusion temporary folder " << folder << ": " << error.message());
+    }
+
+    const bfs::path folder;
+};
+
+/// deterministic hash of a point index (splitmix64 finalizer), to sample the points whatever their order
+inline std::uint64_t hashStreamedPointIndex(std::uint64_t index)
+{
+    index = (index ^ (index >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    index = (index ^ (index >> 27)) * 0x94d049bb133111ebULL;
+    return index ^ (index >> 31);
+}
+
+void filterDepthMapsPointsStreaming(int nbCams, const std::vector<int>& startIndex, std::size_t realMaxVertices,
+                                    const LoadDepthMapPointsFunction& loadPoints, const FuseParams& params,
+                                    std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare,
+                                    std::vector<float>& simScorePrepare)
+{
+    const std::size_t maxMemory = std::size_t(params.streamingMaxMemory) * 1024 * 1024;
+    const bfs::path folder = (params.streamingFolder.empty() ? bfs::temp_directory_path() : bfs::path(params.streamingFolder)) /
+                             bfs::unique_path("fuseCut_%%%%%%%%");
+    bfs::create_directories(folder);
+    const StreamingFolderCleaner folderCleaner(folder);
+    const std::string pointsFilepath = (folder / "points.bin").string();
+    const std::string keptPointsFilepath = (folder / "keptPoints.bin").string();
+
+    ALICEVISION_LOG_INFO("Streaming fusion: temporary files in " << folder << ", max memory: " << params.streamingMaxMemory << " MB.");
+
+    // stream the points of each depth map into a single file
+    std::size_t nbPoints = 0;
+    Point3d bboxMin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d bboxMax(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    // sample of the points to estimate the slabs bounds, selected by a hash of their index
+    // so that the bounds do not depend on the order in which the threads write the depth maps
+    const std::size_t maxSampleSize = 100000;
+    const std::uint64_t sampleStep = std::max(std::size_t(1), realMaxVertices / maxSampleSize);
+    std::vector<Point3d> sample;
+    {
+        std::ofstream pointsFile(pointsFilepath, std::ios::binary);
+        if(!pointsFile.is_open())
+            throw std::runtime_error("Unable to create the fusion temporary file: " + pointsFilepath);
+
+        omp_set_nested(1);
+        #pragma omp parallel for num_threads(3)
+        for(int c = 0; c < nbCams; c++)
+        {
+            const std::size_t nbTiles = ((c + 1 < startIndex.size()) ? std::size_t(startIndex[c + 1]) : realMaxVertices) - startIndex[c];
+            std::vector<Point3d> coords(nbTiles);
+            std::vector<double> pixSize(nbTiles);
+            std::vector<float> simScore(nbTiles);
+            if(!loadPoints(c, coords, pixSize, simScore))
+                continue;
+
+            std::vector<StreamedPoint> points;
+            for(std::size_t i = 0; i < nbTiles; ++i)
+            {
+                if(pixSize[i] != -1.0)
+                    points.push_back({startIndex[c] + i, coords[i], pixSize[i], simScore[i], 0});
+            }
+
+            #pragma omp critical(streamingFusionPointsFile)
+            {
+                pointsFile.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(StreamedPoint));
+                for(const StreamedPoint& point : points)
+                {
+                    for(int k = 0; k < 3; ++k)
+                    {
+                        bboxMin.m[k] = std::min(bboxMin.m[k], point.coords.m[k]);
+                        bboxMax.m[k] = std::max(bboxMax.m[k], point.coords.m[k]);
+                    }
+                    ++nbPoints;
+                    if(hashStreamedPointIndex(point.index) % sampleStep == 0)
+                        sample.push_back(point.coords);
+                }
+            }
+        }
+        omp_set_nested(0);
+
+        if(!pointsFile)
+            throw std::runtime_error("Unable to write the fusion temporary file: " + pointsFilepath);
+    }
+
+    // the discarded tiles of the in-memory fusion stay at the origin with a null score in the kd-tree
+    // and remove the valid points around the origin, keep the same behavior
+    const bool hasDiscardedTiles = (nbPoints < realMaxVertices);
+
+    // slabs along the longest axis, with the same number of sampled points
+    int axis = 0;
+    for(int k = 1; k < 3; ++k)
+    {
+        if(bboxMax.m[k] - bboxMin.m[k] > bboxMax.m[axis] - bboxMin.m[axis])
+            axis = k;
+    }
+    const std::size_t nbSlabs = std::max(std::size_t(1), (nbPoints * streamingBytesPerPoint + maxMemory - 1) / maxMemory);
+    std::vector<double> sampleValues;
+    sampleValues.reserve(sample.size());
+    for(const Point3d& p : sample)
+        sampleValues.push_back(p.m[axis]);
+    std::sort(sampleValues.begin(), sampleValues.end());
+    std::vector<double> slabsBounds; // upper bounds of the slabs, except the last one
+    for(std::size_t s = 1; s < nbSlabs && !sampleValues.empty(); ++s)
+        slabsBounds.push_back(sampleValues[s * sampleValues.size() / nbSlabs]);
+
+    const auto getSlab = [&](const Point3d& p) {
+        return std::size_t(std::upper_bound(slabsBounds.begin(), slabsBounds.end(), p.m[axis]) - slabsBounds.begin());
+    };
+    const auto getFilteringRadius = [&](const StreamedPoint& point) {
+        return std::sqrt(params.pixSizeMarginInitCoef * point.simScore) * point.pixSize;
+    };
+
+    // largest filtering radius per slab
+    std::vector<double> slabsRadius(slabsBounds.size() + 1, 0.0);
+    readStreamedPoints(pointsFilepath, [&](const StreamedPoint& point) {
+        double& radius = slabsRadius[getSlab(point.coords)];
+        radius = std::max(radius, getFilteringRadius(point));
+    });
+    const double maxRadius = *std::max_element(slabsRadius.begin(), slabsRadius.end());
+
+    // dispatch the points into the slabs files, with the halos of the neighboring slabs,
+    // by passes on at most maxOpenSlabsFiles slabs
+    std::vector<std::string> slabsFilepaths(slabsRadius.size());
+    std::vector<std::size_t> slabsNbPoints(slabsRadius.size(), 0);
+    for(std::size_t firstSlab = 0; firstSlab < slabsFilepaths.size(); firstSlab += maxOpenSlabsFiles)
+    {
+        const std::size_t endSlab = std::min(slabsFilepaths.size(), firstSlab + maxOpenSlabsFiles);
+        std::vector<std::ofstream> slabsFiles(endSlab - firstSlab);
+        for(std::size_t s = firstSlab; s < endSlab; ++s)
+        {
+            slabsFilepaths[s] = (folder / ("slab_" + std::to_string(s) + ".bin")).string();
+            slabsFiles[s - firstSlab].open(slabsFilepaths[s], std::ios::binary);
+            if(!slabsFiles[s - firstSlab].is_open())
+                throw std::runtime_error("Unable to create the fusion temporary file: " + slabsFilepaths[s]);
+        }
+        const auto writePoint = [&](std::size_t s, const StreamedPoint& point) {
+            if(s < firstSlab || s >= endSlab)
+                return;
+            slabsFiles[s - firstSlab].write(reinterpret_cast<const char*>(&point), sizeof(StreamedPoint));
+            ++slabsNbPoints[s];
+        };
+
+        readStreamedPoints(pointsFilepath, [&](const StreamedPoint& point) {
+            const double v = point.coords.m[axis];
+            const std::size_t slab = getSlab(point.coords);
+            writePoint(slab, point);
+
+            StreamedPoint haloPoint = point;
+            haloPoint.isHalo = 1;
+            // previous slabs, with the upper bound slabsBounds[s]
+            for(std::size_t s = slab; s > 0 && v - slabsBounds[s - 1] <= maxRadius; --s)
+            {
+                if(v - slabsBounds[s - 1] <= slabsRadius[s - 1])
+                    writePoint(s - 1, haloPoint);
+            }
+            // next slabs, with the lower bound slabsBounds[s - 1]
+            for(std::size_t s = slab + 1; s < slabsRadius.size() && slabsBounds[s - 1] - v <= maxRadius; ++s)
+            {
+                if(slabsBounds[s - 1] - v <= slabsRadius[s])
+                    writePoint(s, haloPoint);
+            }
+        });
+
+        for(std::size_t s = firstSlab; s < endSlab; ++s)
+        {
+            if(!slabsFiles[s - firstSlab])
+                throw std::runtime_error("Unable to write the fusion temporary file: " + slabsFilepaths[s]);
+        }
+    }
+    bfs::remove(pointsFilepath);
+
+    ALICEVISION_LOG_INFO("Streaming fusion: " << nbPoints << " points dispatched in " << slabsFilepaths.size() << " slabs.");
+
+    // the halos do not shrink with the slabs, they may exceed the memory limit with large filtering radiuses
+    const std::size_t maxSlabNbPoints = *std::max_element(slabsNbPoints.begin(), slabsNbPoints.end());
+    if(maxSlabNbPoints * streamingBytesPerPoint > maxMemory)
+    {
+        ALICEVISION_LOG_WARNING("Streaming fusion: the largest slab has " << maxSlabNbPoints << " points with its halo, it needs about "
+                                << (maxSlabNbPoints * streamingBytesPerPoint) / (1024 * 1024) << " MB to be filtered, over the max memory of "
+                                << params.streamingMaxMemory << " MB (largest filtering radius: " << maxRadius << ").");
+    }
+
+    // filter each slab and keep its own points in a single file,
+    // the kept points are flagged in a bitmap of the in-memory indexes to restore their order
+    std::vector<std::uint64_t> keptBitmap((realMaxVertices + 63) / 64, 0);
+    std::size_t nbKeptPoints = 0;
+    {
+        std::ofstream keptPointsFile(keptPointsFilepath, std::ios::binary);
+        if(!keptPointsFile.is_open())
+            throw std::runtime_error("Unable to create the fusion temporary file: " + keptPointsFilepath);
+
+        for(std::size_t s = 0; s < slabsFilepaths.size(); ++s)
+        {
+            std::vector<StreamedPoint> points;
+            points.reserve(slabsNbPoints[s]);
+            readStreamedPoints(slabsFilepaths[s], [&](const StreamedPoint& point) { points.push_back(point); });
+            bfs::remove(slabsFilepaths[s]);
+            if(points.empty())
+                continue;
+
+            std::sort(points.begin(), points.end(), [](const StreamedPoint& a, const StreamedPoint& b) { return a.index < b.index; });
+            std::vector<Point3d> slabCoords(points.size());
+            std::vector<double> slabPixSize(points.size());
+            std::vector<float> slabSimScore(points.size());
+            for(std::size_t i = 0; i < points.size(); ++i)
+            {
+                slabCoords[i] = points[i].coords;
+                slabPixSize[i] = points[i].pixSize;
+                slabSimScore[i] = points[i].simScore;
+            }
+
+            ALICEVISION_LOG_INFO("Filter slab " << s + 1 << "/" << slabsFilepaths.size() << ".");
+            filterByPixSize(slabCoords, slabPixSize, params.pixSizeMarginInitCoef, slabSimScore);
+
+            for(std::size_t i = 0; i < points.size(); ++i)
+            {
+                if(points[i].isHalo || slabPixSize[i] == -1.0)
+                    continue;
+                if(hasDiscardedTiles && slabCoords[i].size2() < params.pixSizeMarginInitCoef * slabSimScore[i] * slabPixSize[i] * slabPixSize[i])
+                    continue;
+                keptBitmap[points[i].index / 64] |= std::uint64_t(1) << (points[i].index % 64);
+                keptPointsFile.write(reinterpret_cast<const char*>(&points[i]), sizeof(StreamedPoint));
+                ++nbKeptPoints;
+            }
+        }
+
+        if(!keptPointsFile)
+            throw std::runtime_error("Unable to write the fusion temporary file: " + keptPointsFilepath);
+    }
+
+    // rank of the first index of each bitmap word among the kept points
+    std::vector<std::uint64_t> keptRanks(keptBitmap.size());
+    {
+        std::uint64_t rank = 0;
+        for(std::size_t w = 0; w < keptBitmap.size(); ++w)
+        {
+            keptRanks[w] = rank;
+            rank += std::bitset<64>(keptBitmap[w]).count();
+        }
+    }
+
+    // write each kept point at its rank, in the same order as the in-memory fusion
+    verticesCoordsPrepare.assign(nbKeptPoints, Point3d());
+    pixSizePrepare.assign(nbKeptPoints, 0.0);
+    simScorePrepare.assign(nbKeptPoints, 0.0f);
+    readStreamedPoints(keptPointsFilepath, [&](const StreamedPoint& point) {
+        const std::size_t w = point.index / 64;
+        const std::uint64_t lowerBits = keptBitmap[w] & ((std::uint64_t(1) << (point.index % 64)) - 1);
+        const std::size_t rank = keptRanks[w] + std::bitset<64>(lowerBits).count();
+        verticesCoordsPrepare[rank] = point.coords;
+        pixSizePrepare[rank] = point.pixSize;
+        simScorePrepare[rank] = point.simScore;
+    });
+
+    ALICEVISION_LOG_INFO((realMaxVertices - verticesCoordsPrepare.size()) << " invalid points removed.");
+}
+
+/**
+ * @brief Load the depth maps points and filter them by pixel size with a bounded memory (see filterDepthMapsPointsStreaming).
+ */
+void loadAndFilterDepthMapsPointsStreaming(const StaticVector<int>& cams, const Point3d voxel[8], const FuseParams& params,
+                                           mvsUtils::MultiViewParams* mp, int step, const std::vector<int>& startIndex,
+                                           std::size_t realMaxVertices, std::vector<Point3d>& verticesCoordsPrepare,
+                                           std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare)
+{
+    const LoadDepthMapPointsFunction loadPoints = [&](int c, std::vector<Point3d>& coords, std::vector<double>& pixSize, std::vector<float>& simScore) {
+        return loadDepthMapTilesPoints(mp, c, step, voxel, params, 0, coords, pixSize, simScore);
+    };
+    filterDepthMapsPointsStreaming(cams.size(), startIndex, realMaxVertices, loadPoints, params,
+                                   verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+}
+
 void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare,
                                     std::vector<GC_vertexInfo>& verticesAttrPrepare, mvsUtils::MultiViewParams* mp, float simFactor, float voteMarginFactor, float contributeMarginFactor, float simGaussianSize)
 {
@@ -1067,9 +1536,9 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
         startIndex[i] = realMaxVertices;
         realMaxVertices += std::ceil(imgParams.width / step) * std::ceil(imgParams.height / step);
     }
-    std::vector<Point3d> verticesCoordsPrepare(realMaxVertices);
-    std::vector<double> pixSizePrepare(realMaxVertices);
-    std::vector<float> simScorePrepare(realMaxVertices);
+    std::vector<Point3d> verticesCoordsPrepare;
+    std::vector<double> pixSizePrepare;
+    std::vector<float> simScorePrepare;
 
     // counter for points filtered based on the number of observations (minVis)
     int minVisCounter = 0;
@@ -1081,149 +1550,33 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     ALICEVISION_LOG_INFO("realMaxVertices: " << realMaxVertices);
     ALICEVISION_LOG_INFO("minVis: " << params.minVis);
 
-    ALICEVISION_LOG_INFO("Load depth maps and add points.");
+    if(params.streamingMaxMemory > 0)
+    {
+        ALICEVISION_LOG_INFO("Load depth maps and filter points with the streaming fusion.");
+        loadAndFilterDepthMapsPointsStreaming(cams, voxel, params, mp, step, startIndex, realMaxVertices,
+                                              verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+    }
+    else
     {
+        verticesCoordsPrepare.resize(realMaxVertices);
+        pixSizePrepare.resize(realMaxVertices);
+        simScorePrepare.resize(realMaxVertices);
+
+        ALICEVISION_LOG_INFO("Load depth maps and add points.");
         omp_set_nested(1);
         #pragma omp parallel for num_threads(3)
         for(int c = 0; c < cams.size(); c++)
         {
-            std::vector<float> depthMap;
-            std::vector<float> simMap;
-            std::vector<unsigned char> numOfModalsMap;
-            int width, height;
-            {
-                const std::string depthMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::depthMap, 0);
-                imageIO::readImage(depthMapFilepath, width, height, depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
-                if(depthMap.empty())
-                {
-                    ALICEVISION_LOG_WARNING("Empty depth map: " << depthMapFilepath);
-                    continue;
-                }
-                int wTmp, hTmp;
-                const std::string simMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::simMap, 0);
-                // If we have a simMap in input use it,
-                // else init with a constant value.
-                if(boost::filesystem::exists(simMapFilepath))
-                {
-                    imageIO::readImage(simMapFilepath, wTmp, hTmp, simMap, imageIO::EImageColorSpace::NO_CONVERSION);
-                    if(wTmp != width || hTmp != height)
-                        throw std::runtime_error("Wrong sim map dimensions: " + simMapFilepath);
-                    {
-                        std::vector<float> simMapTmp(simMap.size());
-                        imageAlgo::convolveImage(width, height, simMap, simMapTmp, "gaussian",
-                    params.simGaussianSizeInit, params.simGaussianSizeInit); simMap.swap(simMapTmp);
-                    }
-                }
-                else
-                {
-                    ALICEVISION_LOG_WARNING("simMap file can't be found.");
-                    simMap.resize(width * height, -1);
-                }
-
-                const std::string nmodMapFilepath = getFileNameFromIndex(mp, c, mvsUtils::EFileType::nmodMap, 0);
-                // If we have an nModMap in input (from depthmapfilter) use it,
-                // else init with a constant value.
-                if(boost::filesystem::exists(nmodMapFilepath))
-                {
-                    imageIO::readImage(nmodMapFilepath, wTmp, hTmp, numOfModalsMap,
-                                       imageIO::EImageColorSpace::NO_CONVERSION);
-                    if(wTmp != width || hTmp != height)
-                        throw std::runtime_error("Wrong nmod map dimensions: " + nmodMapFilepath);
-                }
-                else
-                {
-                    ALICEVISION_LOG_WARNING("nModMap file can't be found.");
-                    numOfModalsMap.resize(width*height, 1);
-                }
-            }
-
-            int syMax = std::ceil(height/step);
-            int sxMax = std::ceil(width/step);
-            #pragma omp parallel for
-            for(int sy = 0; sy < syMax; ++sy)
-            {
-                for(int sx = 0; sx < sxMax; ++sx)
-                {
-                    int index = startIndex[c] + sy * sxMax + sx;
-                    float bestDepth = std::numeric_limits<float>::max();
-                    float bestScore = 0;
-                    float bestSimScore = 0;
-                    int bestX = 0;
-                    int bestY = 0;
-                    for(int y = sy * step, ymax = std::min((sy+1) * step, height);
-                        y < ymax; ++y)
-                    {
-                        for(int x = sx * step, xmax = std::min((sx+1) * step, width);
-                            x < xmax; ++x)
-                        {
-                            const std::size_t index = y * width + x;
-                            const float depth = depthMap[index];
-                            if(depth <= 0.0f)
-                                continue;
-
-                            int numOfModals = 0;
-                            const int scoreKernelSize = 1;
-                            for(int ly = std::max(y-scoreKernelSize, 0), lyMax = std::min(y+scoreKernelSize, height-1); ly < lyMax; ++ly)
-                            {
-                                for(int lx = std::max(x-scoreKernelSize, 0), lxMax = std::min(x+scoreKernelSize, width-1); lx < lxMax; ++lx)
-                                {
-                                    if(depthMap[ly * width + lx] > 0.0f)
-                                    {
-                                        numOfModals += 10 + int(numOfModalsMap[ly * width + lx]);
-                                    }
-                                }
-                            }
-                            float sim = simMap[index];
-                            sim = sim < 0.0f ?  0.0f : sim; // clamp values < 0
-                            // remap similarity values from [-1;+1] to [+1;+simScale]
-                            // interpretation is [goodSimilarity;badSimilarity]
-                            const float simScore = 1.0f + sim * params.simFactor;
-
-                            const float score = numOfModals + (1.0f / simScore);
-                            if(score > bestScore)
-                            {
-                                bestDepth = depth;
-                                bestScore = score;
-                                bestSimScore = simScore;
-                                bestX = x;
-                                bestY = y;
-                            }
-                        }
-                    }
-                    if(bestScore < 3*13)
-                    {
-                        // discard the point
-                        pixSizePrepare[index] = -1.0;
-                    }
-                    else
-                    {
-                        Point3d p = mp->CArr[c] + (mp->iCamArr[c] * Point2d((float)bestX, (float)bestY)).normalize() * bestDepth;
-                        
-                        // TODO: isPointInHexahedron: here or in the previous loop per pixel to not loose point?
-                        if(voxel == nullptr || mvsUtils::isPointInHexahedron(p, voxel)) 
-                        {
-                            verticesCoordsPrepare[index] = p;
-                            simScorePrepare[index] = bestSimScore;
-                            pixSizePrepare[index] = mp->getCamPixelSize(p, c);
-                        }
-                        else
-                        {
-                            // discard the point
-                            // verticesCoordsPrepare[index] = p;
-                            pixSizePrepare[index] = -1.0;
-                        }
-                    }
-                }
-            }
+            loadDepthMapTilesPoints(mp, c, step, voxel, params, startIndex[c], verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
         }
         omp_set_nested(0);
-    }
 
-    ALICEVISION_LOG_INFO("Filter initial 3D points by pixel size to remove duplicates.");
+        ALICEVISION_LOG_INFO("Filter initial 3D points by pixel size to remove duplicates.");
 
-    filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
-    // remove points if pixSize == -1
-    removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+        filterByPixSize(verticesCoordsPrepare, pixSizePrepare, params.pixSizeMarginInitCoef, simScorePrepare);
+        // remove points if pixSize == -1
+        removeInvalidPoints(verticesCoordsPrepare, pixSizePrepare, simScorePrepare);
+    }
 
     ALICEVISION_LOG_INFO("3D points loaded and filtered to " << verticesCoordsPrepare.size() << " points.");
 
@@ -1843,6 +2196,7 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
 {
     ALICEVISION_LOG_INFO("Computing s-t graph weights.");
     long t1 = clock();
+    system::Timer timer;
 
     // loop over all cells ... initialize
     for(GC_cellInfo& c: _cellsAttr)
@@ -1858,9 +2212,19 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
         }
     }
 
-    // choose random order to prevent waiting
-    const unsigned int seed = (unsigned int)mp->userParams.get<unsigned int>("delaunaycut.seed", 0);
-    const std::vector<int> verticesRandIds = mvsUtils::createRandomArrayOfIntegers(_verticesAttr.size(), seed);
+    // sort the vertices by starting cell, so the rays of a batch walk through a local part of the tetrahedralization
+    const int batchSize = std::max(1, mp->userParams.get<int>("delaunaycut.fillGraphBatchSize", 256));
+    std::vector<std::pair<CellIndex, VertexIndex>> sortedVertices;
+    sortedVertices.reserve(_verticesAttr.size());
+    for(VertexIndex vi = 0; vi < _verticesAttr.size(); ++vi)
+    {
+        if(!_verticesAttr[vi].isReal())
+            continue;
+        const std::vector<CellIndex>& neighboringCells = getNeighboringCellsByVertexIndex(vi);
+        sortedVertices.emplace_back(neighboringCells.empty() ? GEO::NO_CELL : neighboringCells.front(), vi);
+    }
+    std::sort(sortedVertices.begin(), sortedVertices.end());
+    const double sortTime = timer.elapsed();
 
     int64_t totalStepsFront = 0;
     int64_t totalRayFront = 0;
@@ -1875,66 +2239,88 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
     GeometriesCount totalGeometriesIntersectedFrontCount;
     GeometriesCount totalGeometriesIntersectedBehindCount;
 
-    boost::progress_display progressBar(std::min(size_t(100), verticesRandIds.size()), std::cout, "fillGraphPartPtRc\n");
-    size_t progressStep = verticesRandIds.size() / 100;
-    progressStep = std::max(size_t(1), progressStep);
-#pragma omp parallel for reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalIsRealNrc)
-    for(int i = 0; i < verticesRandIds.size(); i++)
+    // cumulated time of all the threads
+    double traversalThreadsTime = 0.0;
+    double mergeThreadsTime = 0.0;
+
+    const int nbBatches = (int(sortedVertices.size()) + batchSize - 1) / batchSize;
+    boost::progress_display progressBar(std::min(size_t(100), size_t(nbBatches)), std::cout, "fillGraphPartPtRc\n");
+    const int progressStep = std::max(1, nbBatches / 100);
+    timer.reset();
+#pragma omp parallel reduction(+:totalStepsFront,totalRayFront,totalStepsBehind,totalRayBehind,totalCamHaveVisibilityOnVertex,totalOfVertex,totalIsRealNrc,traversalThreadsTime,mergeThreadsTime)
     {
-        if(i % progressStep == 0)
+        CellVotes cellVotes;
+        GeometriesCount threadGeometriesIntersectedFrontCount;
+        GeometriesCount threadGeometriesIntersectedBehindCount;
+
+#pragma omp for schedule(dynamic)
+        for(int b = 0; b < nbBatches; b++)
         {
+            if(b % progressStep == 0)
+            {
 #pragma omp critical
-            ++progressBar;
-        }
+                ++progressBar;
+            }
 
-        const int vertexIndex = verticesRandIds[i];
-        const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+            system::Timer batchTimer;
+            const int batchEnd = std::min(int(sortedVertices.size()), (b + 1) * batchSize);
+            for(int i = b * batchSize; i < batchEnd; i++)
+            {
+                const VertexIndex vertexIndex = sortedVertices[i].second;
+                const GC_vertexInfo& v = _verticesAttr[vertexIndex];
 
-        if(v.isReal())
-        {
-            ++totalIsRealNrc;
-            // "weight" is called alpha(p) in the paper
-            const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
+                ++totalIsRealNrc;
+                // "weight" is called alpha(p) in the paper
+                const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
 
-            for(int c = 0; c < v.cams.size(); c++)
-            {
-                assert(v.cams[c] >= 0);
-                assert(v.cams[c] < mp->ncams);
-
-                int stepsFront = 0;
-                int stepsBehind = 0;
-                GeometriesCount geometriesIntersectedFrontCount;
-                GeometriesCount geometriesIntersectedBehindCount;
-                fillGraphPartPtRc(stepsFront, stepsBehind, geometriesIntersectedFrontCount,
-                                  geometriesIntersectedBehindCount, vertexIndex, v.cams[c], weight, fullWeight,
-                                  nPixelSizeBehind,
-                                  fillOut, distFcnHeight);
-
-                totalStepsFront += stepsFront;
-                totalRayFront += 1;
-                totalStepsBehind += stepsBehind;
-                totalRayBehind += 1;
+                for(int c = 0; c < v.cams.size(); c++)
+                {
+                    assert(v.cams[c] >= 0);
+                    assert(v.cams[c] < mp->ncams);
+
+                    int stepsFront = 0;
+                    int stepsBehind = 0;
+                    GeometriesCount geometriesIntersectedFrontCount;
+                    GeometriesCount geometriesIntersectedBehindCount;
+                    fillGraphPartPtRc(stepsFront, stepsBehind, geometriesIntersectedFrontCount,
+                                      geometriesIntersectedBehindCount, cellVotes, vertexIndex, v.cams[c], weight, fullWeight,
+                                      nPixelSizeBehind,
+                                      fillOut, distFcnHeight);
+
+                    totalStepsFront += stepsFront;
+                    totalRayFront += 1;
+                    totalStepsBehind += stepsBehind;
+                    totalRayBehind += 1;
+
+                    threadGeometriesIntersectedFrontCount += geometriesIntersectedFrontCount;
+                    threadGeometriesIntersectedBehindCount += geometriesIntersectedBehindCount;
+                } // for c
+
+                totalCamHaveVisibilityOnVertex += v.cams.size();
+                totalOfVertex += 1;
+            }
+            traversalThreadsTime += batchTimer.elapsed();
 
-#pragma OMP_ATOMIC_UPDATE
-                totalGeometriesIntersectedFrontCount.facets += geometriesIntersectedFrontCount.facets;
-#pragma OMP_ATOMIC_UPDATE
-                totalGeometriesIntersectedFrontCount.vertices += geometriesIntersectedFrontCount.vertices;
-#pragma OMP_ATOMIC_UPDATE
-                totalGeometriesIntersectedFrontCount.edges += geometriesIntersectedFrontCount.edges;
-#pragma OMP_ATOMIC_UPDATE
-                totalGeometriesIntersectedBehindCount.facets += geometriesIntersectedBehindCount.facets;
-#pragma OMP_ATOMIC_UPDATE
-                totalGeometriesIntersectedBehindCount.vertices += geometriesIntersectedBehindCount.vertices;
-#pragma OMP_ATOMIC_UPDATE
-                totalGeometriesIntersectedBehindCount.edges += geometriesIntersectedBehindCount.edges;
-            } // for c
+            batchTimer.reset();
+            mergeCellVotes(cellVotes);
+            mergeThreadsTime += batchTimer.elapsed();
+        }
 
-            totalCamHaveVisibilityOnVertex += v.cams.size();
-            totalOfVertex += 1;
+#pragma omp critical
+        {
+            totalGeometriesIntersectedFrontCount += threadGeometriesIntersectedFrontCount;
+            totalGeometriesIntersectedBehindCount += threadGeometriesIntersectedBehindCount;
         }
     }
+    const double raysTime = timer.elapsed();
 
-    ALICEVISION_LOG_DEBUG("_verticesAttr.size(): " << _verticesAttr.size() << "(" << verticesRandIds.size() << ")");
+    ALICEVISION_LOG_INFO("s-t graph weights computation time:" << std::endl
+                         << "\t- sort " << sortedVertices.size() << " vertices by starting cell: " << sortTime << " s" << std::endl
+                         << "\t- " << nbBatches << " batches of rays: " << raysTime << " s" << std::endl
+                         << "\t  - rays traversal (all threads): " << traversalThreadsTime << " s" << std::endl
+                         << "\t  - votes merging (all threads): " << mergeThreadsTime << " s");
+
+    ALICEVISION_LOG_DEBUG("_verticesAttr.size(): " << _verticesAttr.size() << "(" << sortedVertices.size() << ")");
     ALICEVISION_LOG_DEBUG("totalIsRealNrc: " << totalIsRealNrc);
     ALICEVISION_LOG_DEBUG("totalStepsFront//totalRayFront = " << totalStepsFront << " // " << totalRayFront);
     ALICEVISION_LOG_DEBUG("totalStepsBehind//totalRayBehind = " << totalStepsBehind << " // " << totalRayBehind);
@@ -1950,9 +2336,59 @@ void DelaunayGraphCut::fillGraph(double nPixelSizeBehind, bool labatutWeights, b
     mvsUtils::printfElapsedTime(t1, "s-t graph weights computed : ");
 }
 
+void DelaunayGraphCut::mergeCellVotes(CellVotes& cellVotes)
+{
+    std::vector<CellVotes::Vote>& votes = cellVotes.votes;
+    std::sort(votes.begin(), votes.end(), [](const CellVotes::Vote& a, const CellVotes::Vote& b) {
+        return (a.cellIndex < b.cellIndex) || (a.cellIndex == b.cellIndex && a.field < b.field);
+    });
+
+    std::size_t i = 0;
+    while(i < votes.size())
+    {
+        const CellIndex cellIndex = votes[i].cellIndex;
+        const std::uint8_t field = votes[i].field;
+
+        // combine the votes on the same cell attribute
+        float value = 0.0f;
+        for(; i < votes.size() && votes[i].cellIndex == cellIndex && votes[i].field == field; ++i)
+            value = (field == CellVotes::cellSWeight) ? votes[i].value : value + votes[i].value;
+
+        GC_cellInfo& c = _cellsAttr[cellIndex];
+        switch(field)
+        {
+            case CellVotes::emptinessScore:
+#pragma OMP_ATOMIC_UPDATE
+                c.emptinessScore += value;
+                break;
+            case CellVotes::fullnessScore:
+#pragma OMP_ATOMIC_UPDATE
+                c.fullnessScore += value;
+                break;
+            case CellVotes::on:
+#pragma OMP_ATOMIC_UPDATE
+                c.on += value;
+                break;
+            case CellVotes::cellTWeight:
+#pragma OMP_ATOMIC_UPDATE
+                c.cellTWeight += value;
+                break;
+            case CellVotes::cellSWeight:
+#pragma OMP_ATOMIC_WRITE
+                c.cellSWeight = value;
+                break;
+            default:
+#pragma OMP_ATOMIC_UPDATE
+                c.gEdgeVisWeight[field - CellVotes::gEdgeVisWeight] += value;
+                break;
+        }
+    }
+    votes.clear();
+}
+
 void DelaunayGraphCut::fillGraphPartPtRc(
     int& outTotalStepsFront, int& outTotalStepsBehind, GeometriesCount& outFrontCount, GeometriesCount& outBehindCount,
-    int vertexIndex, int cam, float weight, float fullWeight, double nPixelSizeBehind,
+    CellVotes& outVotes, int vertexIndex, int cam, float weight, float fullWeight, double nPixelSizeBehind,
                                        bool fillOut, float distFcnHeight)  // nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
 {
     const int maxint = 1000000; // std::numeric_limits<int>::std::max()
@@ -2030,15 +2466,11 @@ void DelaunayGraphCut::fillGraphPartPtRc(
             if (geometry.type == EGeometryType::Facet)
             {
                 ++outFrontCount.facets;
-                {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[geometry.facet.cellIndex].emptinessScore += weight;
-                }
+                outVotes.add(geometry.facet.cellIndex, CellVotes::emptinessScore, weight);
 
                 {
                     const float dist = distFcn(maxDist, (originPt - lastIntersectPt).size(), distFcnHeight);
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[geometry.facet.cellIndex].gEdgeVisWeight[geometry.facet.localVertexIndex] += weight * dist;
+                    outVotes.addEdgeVis(geometry.facet.cellIndex, geometry.facet.localVertexIndex, weight * dist);
                 }
 
                 // Take the mirror facet to iterate over the next cell
@@ -2065,8 +2497,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // These geometries do not have a cellIndex, so we use the previousGeometry to retrieve the cell between the previous geometry and the current one.
                 if (previousGeometry.type == EGeometryType::Facet)
                 {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[previousGeometry.facet.cellIndex].emptinessScore += weight;
+                    outVotes.add(previousGeometry.facet.cellIndex, CellVotes::emptinessScore, weight);
                 }
 
                 if (geometry.type == EGeometryType::Vertex)
@@ -2094,8 +2525,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
             if (lastIntersectedFacet.cellIndex != GEO::NO_CELL &&
                 (mp->CArr[cam] - intersectPt).size() < 0.2 * pointCamDistance)
             {
-    #pragma OMP_ATOMIC_WRITE
-                _cellsAttr[lastIntersectedFacet.cellIndex].cellSWeight = (float)maxint;
+                outVotes.add(lastIntersectedFacet.cellIndex, CellVotes::cellSWeight, (float)maxint);
             }
         }
 
@@ -2107,8 +2537,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // lastGeoIsVertex is supposed to be positive in almost all cases.
                 // If we do not reach the camera, we still vote on the last tetrehedra.
                 // Possible reaisons: the camera is not part of the vertices or we encounter a numerical error in intersectNextGeom
-#pragma OMP_ATOMIC_WRITE
-                _cellsAttr[lastIntersectedFacet.cellIndex].cellSWeight = (float)maxint;
+                outVotes.add(lastIntersectedFacet.cellIndex, CellVotes::cellSWeight, (float)maxint);
             }
             // else
             // {
@@ -2181,15 +2610,11 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // Vote for the first cell found (only once)
                 if (firstIteration)
                 {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[geometry.facet.cellIndex].on += fWeight;
+                    outVotes.add(geometry.facet.cellIndex, CellVotes::on, fWeight);
                     firstIteration = false;
                 }
 
-                {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[geometry.facet.cellIndex].fullnessScore += fWeight;
-                }
+                outVotes.add(geometry.facet.cellIndex, CellVotes::fullnessScore, fWeight);
 
                 // Take the mirror facet to iterate over the next cell
                 const Facet mFacet = mirrorFacet(geometry.facet);
@@ -2203,9 +2628,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
 
                 {
                     const float dist = distFcn(maxDist, (originPt - lastIntersectPt).size(), distFcnHeight);
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[geometry.facet.cellIndex].gEdgeVisWeight[geometry.facet.localVertexIndex] +=
-                        fWeight * dist;
+                    outVotes.addEdgeVis(geometry.facet.cellIndex, geometry.facet.localVertexIndex, fWeight * dist);
                 }
                 if(previousGeometry.type == EGeometryType::Facet && outBehindCount.facets > 1000)
                 {
@@ -2233,8 +2656,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
 
                     for (const CellIndex& ci : neighboringCells)
                     {
-#pragma OMP_ATOMIC_UPDATE
-                        _cellsAttr[neighboringCells[0]].on += fWeight;
+                        outVotes.add(neighboringCells[0], CellVotes::on, fWeight);
                     }
                     firstIteration = false;
                 }
@@ -2243,8 +2665,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
                 // These geometries do not have a cellIndex, so we use the previousGeometry to retrieve the cell between the previous geometry and the current one.
                 if (previousGeometry.type == EGeometryType::Facet)
                 {
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[previousGeometry.facet.cellIndex].fullnessScore += fWeight;
+                    outVotes.add(previousGeometry.facet.cellIndex, CellVotes::fullnessScore, fWeight);
                 }
 
                 if (geometry.type == EGeometryType::Vertex)
@@ -2272,8 +2693,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(
         // Vote for the last intersected facet (farthest from the camera)
         if (lastIntersectedFacet.cellIndex != GEO::NO_CELL)
         {
-#pragma OMP_ATOMIC_UPDATE
-            _cellsAttr[lastIntersectedFacet.cellIndex].cellTWeight += fWeight;
+            outVotes.add(lastIntersectedFacet.cellIndex, CellVotes::cellTWeight, fWeight);
         }
     }
 }
@@ -3135,14 +3555,28 @@ void DelaunayGraphCut::addToInfiniteSw(float sW)
 
 void DelaunayGraphCut::maxflow()
 {
-    long t_maxflow = clock();
-
     ALICEVISION_LOG_INFO("Maxflow: start allocation.");
     const std::size_t nbCells = _cellsAttr.size();
     ALICEVISION_LOG_INFO("Number of cells: " << nbCells);
 
     // MaxFlow_CSR maxFlowGraph(nbCells);
-    MaxFlow_AdjList maxFlowGraph(nbCells);
+    if(mp->userParams.get<bool>("delaunaycut.maxflowPushRelabel", false))
+    {
+        MaxFlow_PushRelabel maxFlowGraph(nbCells);
+        maxflow(maxFlowGraph);
+    }
+    else
+    {
+        MaxFlow_AdjList maxFlowGraph(nbCells);
+        maxflow(maxFlowGraph);
+    }
+}
+
+template<class MaxFlowT>
+void DelaunayGraphCut::maxflow(MaxFlowT& maxFlowGraph)
+{
+    long t_maxflow = clock();
+    const std::size_t nbCells = _cellsAttr.size();
 
     ALICEVISION_LOG_INFO("Maxflow: add nodes.");
     // fill s-t edges
@@ -3204,6 +3638,10 @@ void DelaunayGraphCut::maxflow()
         }
     }
 
+    const std::string graphFilepath = mp->userParams.get<std::string>("delaunaycut.maxflowGraphFilepath", "");
+    if(!graphFilepath.empty())
+        maxFlowGraph.saveGraph(graphFilepath);
+
     ALICEVISION_LOG_INFO("Maxflow: clear cells info.");
     std::vector<GC_cellInfo>().swap(_cellsAttr); // force clear to free some RAM before maxflow
 
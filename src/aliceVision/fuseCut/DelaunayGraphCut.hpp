@@ -21,8 +21,12 @@
 #include <geogram/mesh/mesh.h>
 #include <geogram/basic/geometry_nd.h>
 
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 namespace aliceVision {
 
@@ -58,6 +62,12 @@ struct FuseParams
     // Weight for helper points from mask. Do not create helper points if zero.
     float maskHelperPointsWeight = 0.0;
     int maskBorderSize = 1;
+    /// Max memory (in MB) to load and filter the depth maps points through temporary files on disk.
+    /// It only bounds the loading and the filtering by pixel size: the filtered points and the next stages
+    /// (the visibilities reload the depth maps) stay in memory. The points are loaded and filtered in memory if zero.
+    int streamingMaxMemory = 0;
+    /// Folder for the temporary files of the streaming fusion (system temporary folder if empty)
+    std::string streamingFolder;
 };
 
 
@@ -204,6 +214,42 @@ public:
         }
     };
 
+    /**
+     * @brief Thread-local accumulator of the cells weights voted by a batch of rays in fillGraph.
+     * The votes are merged into the cells attributes at the end of the batch (see mergeCellVotes),
+     * so the rays are traversed without atomic operations on the shared cells attributes.
+     */
+    struct CellVotes
+    {
+        enum EField : std::uint8_t
+        {
+            emptinessScore = 0,
+            fullnessScore,
+            on,
+            cellTWeight,
+            cellSWeight, //< set to the vote value instead of summed
+            gEdgeVisWeight //< + localVertexIndex
+        };
+
+        struct Vote
+        {
+            CellIndex cellIndex;
+            std::uint8_t field;
+            float value;
+        };
+
+        std::vector<Vote> votes;
+
+        inline void add(CellIndex cellIndex, EField field, float value)
+        {
+            votes.push_back({cellIndex, std::uint8_t(field), value});
+        }
+        inline void addEdgeVis(CellIndex cellIndex, VertexIndex localVertexIndex, float value)
+        {
+            votes.push_back({cellIndex, std::uint8_t(gEdgeVisWeight + localVertexIndex), value});
+        }
+    };
+
     mvsUtils::MultiViewParams* mp;
 
     GEO::Delaunay_var _tetrahedralization;
@@ -500,11 +546,24 @@ public:
 
     float weightFcn(float nrc, bool labatutWeights, int ncams);
 
+    /**
+     * @brief Compute the cells weights by casting the rays between each vertex and its cameras.
+     *
+     * The rays are sorted by starting cell and traversed in parallel by batches (see "delaunaycut.fillGraphBatchSize"):
+     * each thread votes in its own CellVotes, merged into the cells attributes at the end of the batch.
+     */
     void fillGraph(double nPixelSizeBehind, bool labatutWeights, bool fillOut, float distFcnHeight,
                            float fullWeight);
-    void fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, GeometriesCount& outFrontCount, GeometriesCount& outBehindCount, int vertexIndex, int cam, float weight,
+    void fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, GeometriesCount& outFrontCount, GeometriesCount& outBehindCount,
+                           CellVotes& outVotes, int vertexIndex, int cam, float weight,
                            float fullWeight, double nPixelSizeBehind, bool fillOut, float distFcnHeight);
 
+    /**
+     * @brief Add the votes of a batch of rays to the cells attributes and clear them.
+     * The votes are sorted by cell to combine the votes on the same cell before the atomic updates.
+     */
+    void mergeCellVotes(CellVotes& cellVotes);
+
     /**
      * @brief Estimate the cells property "on" based on the analysis of the visibility of neigbouring cells.
      *
@@ -516,8 +575,16 @@ public:
 
     void addToInfiniteSw(float sW);
 
+    /**
+     * @brief Compute the full/empty status of the cells with a graph cut.
+     * @note The maxflow solver is selected by the "delaunaycut.maxflowPushRelabel" parameter
+     *       and the graph is saved if "delaunaycut.maxflowGraphFilepath" is set.
+     */
     void maxflow();
 
+    template<class MaxFlowT>
+    void maxflow(MaxFlowT& maxFlowGraph);
+
     void voteFullEmptyScore(const StaticVector<int>& cams, const std::string& folderName);
 
     void createDensePointCloud(const Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData* sfmData, const FuseParams* depthMapsFuseParams);
@@ -570,6 +637,43 @@ public:
 };
 
 
+/**
+ * @brief Remove the points with another point of smaller pixel size in their volume (pixSizePrepare set to -1)
+ */
+void filterByPixSize(const std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, double pixSizeMarginCoef, std::vector<float>& simScorePrepare);
+
+/**
+ * @brief Remove invalid points based on invalid pixSize
+ */
+void removeInvalidPoints(std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare, std::vector<float>& simScorePrepare);
+
+/**
+ * @brief Load the tile points of the depth map of index c, with a pixel size of -1 for the discarded tiles.
+ * It is called concurrently on different depth maps.
+ */
+using LoadDepthMapPointsFunction = std::function<bool(int c, std::vector<Point3d>& coords, std::vector<double>& pixSize, std::vector<float>& simScore)>;
+
+/**
+ * @brief Load the depth maps points and filter them by pixel size with a bounded memory.
+ *
+ * The depth maps are streamed into a temporary file, then the points are dispatched into slabs along the longest
+ * axis of their bounding box, sized to fit in params.streamingMaxMemory. Each slab also gets the points of its
+ * neighbors within the largest filtering radius of its points (halo) and is filtered independently.
+ * The result is filterByPixSize + removeInvalidPoints on all the points, in the same order, except near the slabs
+ * borders: the filtering of a halo point depends on its own neighbors, which may be outside the halo.
+ * A warning is logged when a slab with its halo exceeds the memory limit.
+ *
+ * @param[in] nbCams The number of depth maps
+ * @param[in] startIndex The index of the first tile of each depth map in the in-memory fusion
+ * @param[in] realMaxVertices The total number of tiles
+ * @param[in] loadPoints Loads the tiles points of a depth map
+ * @param[in] params The fusion parameters
+ */
+void filterDepthMapsPointsStreaming(int nbCams, const std::vector<int>& startIndex, std::size_t realMaxVertices,
+                                    const LoadDepthMapPointsFunction& loadPoints, const FuseParams& params,
+                                    std::vector<Point3d>& verticesCoordsPrepare, std::vector<double>& pixSizePrepare,
+                                    std::vector<float>& simScorePrepare);
+
 std::ostream& operator<<(std::ostream& stream, const DelaunayGraphCut::EGeometryType type);
 std::ostream& operator<<(std::ostream& stream, const DelaunayGraphCut::Facet& facet);
 std::ostream& operator<<(std::ostream& stream, const DelaunayGraphCut::Edge& edge);
@@ -7,11 +7,14 @@
 #include <aliceVision/sfm/sfm.hpp>
 #include <aliceVision/multiview/NViewDataSet.hpp>
 #include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/filesystem.hpp>
 
 #include <boost/math/constants/constants.hpp>
 
+#include <algorithm>
+#include <random>
 #include <string>
 
 #define BOOST_TEST_MODULE fuseCut
@@ -204,3 +207,140 @@ SfMData generateSfm(const NViewDatasetConfigurator& config, const size_t size, c
 
     return sfm_data;
 }
+
+/**
+ * @brief Synthetic depth maps: the tiles points of each depth map sample the same wavy surface
+ * with a camera dependent jitter, and some tiles are discarded.
+ */
+void generateDepthMapsPoints(int nbCams, int nbTilesPerSide, std::vector<int>& startIndex, std::size_t& realMaxVertices,
+                             std::vector<std::vector<Point3d>>& coords, std::vector<std::vector<double>>& pixSize,
+                             std::vector<std::vector<float>>& simScore)
+{
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    const std::size_t nbTiles = nbTilesPerSide * nbTilesPerSide;
+    realMaxVertices = 0;
+    startIndex.resize(nbCams);
+    coords.assign(nbCams, std::vector<Point3d>(nbTiles));
+    pixSize.assign(nbCams, std::vector<double>(nbTiles, -1.0));
+    simScore.assign(nbCams, std::vector<float>(nbTiles, 0.0f));
+    for(int c = 0; c < nbCams; ++c)
+    {
+        startIndex[c] = realMaxVertices;
+        realMaxVertices += nbTiles;
+        for(std::size_t i = 0; i < nbTiles; ++i)
+        {
+            if(uniform(generator) < 0.1)
+                continue; // discarded tile
+            const double x = 1.0 + 10.0 * ((i % nbTilesPerSide) + uniform(generator)) / nbTilesPerSide;
+            const double y = 1.0 + 10.0 * ((i / nbTilesPerSide) + uniform(generator)) / nbTilesPerSide;
+            coords[c][i] = Point3d(x, y, 0.2 * std::sin(x) * std::cos(y) + 0.01 * uniform(generator));
+            pixSize[c][i] = 0.02 * (1.0 + uniform(generator));
+            simScore[c][i] = 1.0f + 2.0f * float(uniform(generator));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_streamingFusion)
+{
+    const int nbCams = 6;
+    std::vector<int> startIndex;
+    std::size_t realMaxVertices;
+    std::vector<std::vector<Point3d>> camsCoords;
+    std::vector<std::vector<double>> camsPixSize;
+    std::vector<std::vector<float>> camsSimScore;
+    generateDepthMapsPoints(nbCams, 70, startIndex, realMaxVertices, camsCoords, camsPixSize, camsSimScore);
+
+    // the filtering by pixel size depends on the evaluation order of the points, use a single thread
+    const int nbThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+
+    // in-memory fusion
+    std::vector<Point3d> coords(realMaxVertices);
+    std::vector<double> pixSize(realMaxVertices);
+    std::vector<float> simScore(realMaxVertices);
+    for(int c = 0; c < nbCams; ++c)
+    {
+        std::copy(camsCoords[c].begin(), camsCoords[c].end(), coords.begin() + startIndex[c]);
+        std::copy(camsPixSize[c].begin(), camsPixSize[c].end(), pixSize.begin() + startIndex[c]);
+        std::copy(camsSimScore[c].begin(), camsSimScore[c].end(), simScore.begin() + startIndex[c]);
+    }
+    FuseParams params;
+    filterByPixSize(coords, pixSize, params.pixSizeMarginInitCoef, simScore);
+    removeInvalidPoints(coords, pixSize, simScore);
+
+    const LoadDepthMapPointsFunction loadPoints = [&](int c, std::vector<Point3d>& tilesCoords, std::vector<double>& tilesPixSize, std::vector<float>& tilesSimScore) {
+        tilesCoords = camsCoords[c];
+        tilesPixSize = camsPixSize[c];
+        tilesSimScore = camsSimScore[c];
+        return true;
+    };
+
+    // a single slab gives the same points in the same order
+    {
+        params.streamingMaxMemory = 1024;
+        std::vector<Point3d> streamedCoords;
+        std::vector<double> streamedPixSize;
+        std::vector<float> streamedSimScore;
+        filterDepthMapsPointsStreaming(nbCams, startIndex, realMaxVertices, loadPoints, params, streamedCoords, streamedPixSize, streamedSimScore);
+
+        BOOST_REQUIRE_EQUAL(streamedCoords.size(), coords.size());
+        for(std::size_t i = 0; i < coords.size(); ++i)
+        {
+            BOOST_CHECK(std::equal(streamedCoords[i].m, streamedCoords[i].m + 3, coords[i].m));
+            BOOST_CHECK_EQUAL(streamedPixSize[i], pixSize[i]);
+            BOOST_CHECK_EQUAL(streamedSimScore[i], simScore[i]);
+        }
+    }
+
+    // several slabs only differ near the slabs borders
+    {
+        params.streamingMaxMemory = 1;
+        std::vector<Point3d> streamedCoords;
+        std::vector<double> streamedPixSize;
+        std::vector<float> streamedSimScore;
+        filterDepthMapsPointsStreaming(nbCams, startIndex, realMaxVertices, loadPoints, params, streamedCoords, streamedPixSize, streamedSimScore);
+
+        // count the points found in only one of the results
+        std::size_t nbDifferentPoints = 0;
+        std::size_t i = 0;
+        std::size_t j = 0;
+        const auto isLower = [](const Point3d& a, const Point3d& b) { return std::lexicographical_compare(a.m, a.m + 3, b.m, b.m + 3); };
+        std::vector<Point3d> sortedCoords = coords;
+        std::vector<Point3d> sortedStreamedCoords = streamedCoords;
+        std::sort(sortedCoords.begin(), sortedCoords.end(), isLower);
+        std::sort(sortedStreamedCoords.begin(), sortedStreamedCoords.end(), isLower);
+        while(i < sortedCoords.size() || j < sortedStreamedCoords.size())
+        {
+            if(j == sortedStreamedCoords.size() || (i < sortedCoords.size() && isLower(sortedCoords[i], sortedStreamedCoords[j])))
+            {
+                ++nbDifferentPoints;
+                ++i;
+            }
+            else if(i == sortedCoords.size() || isLower(sortedStreamedCoords[j], sortedCoords[i]))
+            {
+                ++nbDifferentPoints;
+                ++j;
+            }
+            else
+            {
+                ++i;
+                ++j;
+            }
+        }
+        BOOST_TEST_MESSAGE("Streaming fusion: " << nbDifferentPoints << " different points on " << coords.size() << " points.");
+        BOOST_CHECK_LT(nbDifferentPoints, coords.size() / 100);
+
+        // the slabs do not depend on the loading order of the depth maps, a second run gives the same points
+        std::vector<Point3d> secondCoords;
+        std::vector<double> secondPixSize;
+        std::vector<float> secondSimScore;
+        filterDepthMapsPointsStreaming(nbCams, startIndex, realMaxVertices, loadPoints, params, secondCoords, secondPixSize, secondSimScore);
+        BOOST_REQUIRE_EQUAL(secondCoords.size(), streamedCoords.size());
+        for(std::size_t k = 0; k < streamedCoords.size(); ++k)
+            BOOST_CHECK(std::equal(secondCoords[k].m, secondCoords[k].m + 3, streamedCoords[k].m));
+    }
+
+    omp_set_num_threads(nbThreads);
+}
@@ -5,6 +5,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "MaxFlow_AdjList.hpp"
+#include "MaxFlow_PushRelabel.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -46,6 +52,59 @@ void MaxFlow_AdjList::printStats() const
     }
 }
 
+void MaxFlow_AdjList::saveGraph(const std::string& filepath) const
+{
+    const std::size_t numNodes = getNbNodes();
+    std::vector<ValueType> terminalScores(numNodes, 0.0f);
+
+    // each edge is stored with its reverse edge, once from the lowest node
+    struct SavedEdge
+    {
+        std::uint32_t n1;
+        std::uint32_t n2;
+        ValueType capacity;
+        ValueType reverseCapacity;
+    };
+    std::vector<SavedEdge> edges;
+
+    VertexIterator vi, vi_end;
+    for(boost::tie(vi, vi_end) = vertices(_graph); vi != vi_end; ++vi)
+    {
+        const NodeType n1 = NodeType(*vi);
+        for(const auto& edge : boost::make_iterator_range(boost::out_edges(*vi, _graph)))
+        {
+            const NodeType n2 = NodeType(boost::target(edge, _graph));
+            if(n1 == _S)
+                terminalScores[n2] += _graph[edge].capacity;
+            else if(n2 == _T)
+                terminalScores[n1] -= _graph[edge].capacity;
+            else if(n1 != _T && n2 != _S && n1 < n2)
+                edges.push_back({std::uint32_t(n1), std::uint32_t(n2), _graph[edge].capacity, _graph[_graph[edge].reverse].capacity});
+        }
+    }
+
+    std::ofstream stream(filepath, std::ios::binary);
+    if(!stream.is_open())
+        throw std::runtime_error("Unable to create the maxflow graph file: " + filepath);
+
+    const std::uint32_t magic = MaxFlow_PushRelabel::graphFileMagic;
+    const std::uint32_t version = MaxFlow_PushRelabel::graphFileVersion;
+    const std::uint64_t numSavedNodes = numNodes;
+    const std::uint64_t numEdges = edges.size();
+
+    stream.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    stream.write(reinterpret_cast<const char*>(&numSavedNodes), sizeof(numSavedNodes));
+    stream.write(reinterpret_cast<const char*>(&numEdges), sizeof(numEdges));
+    stream.write(reinterpret_cast<const char*>(terminalScores.data()), terminalScores.size() * sizeof(ValueType));
+    stream.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(SavedEdge));
+
+    if(!stream)
+        throw std::runtime_error("Unable to write the maxflow graph file: " + filepath);
+
+    ALICEVISION_LOG_INFO("Maxflow graph saved: " << filepath << " (" << numSavedNodes << " nodes, " << numEdges << " edges).");
+}
+
 void MaxFlow_AdjList::printColorStats() const
 {
   std::map<int, int> histColor;
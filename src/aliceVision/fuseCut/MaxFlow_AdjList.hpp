@@ -15,6 +15,7 @@
 #include <boost/graph/boykov_kolmogorov_max_flow.hpp>
 
 #include <iostream>
+#include <string>
 
 namespace aliceVision {
 namespace fuseCut {
@@ -110,6 +111,13 @@ public:
     void printStats() const;
     void printColorStats() const;
 
+    /**
+     * @brief Save the added nodes and edges in the binary format of MaxFlow_PushRelabel::saveGraph,
+     *        to benchmark the maxflow solvers on real graphs
+     * @param[in] filepath The output file path
+     */
+    void saveGraph(const std::string& filepath) const;
+
     inline ValueType compute()
     {
         printStats();
@@ -147,6 +155,11 @@ public:
         return (_color[n] == boost::white_color);
     }
 
+    inline std::size_t getNbNodes() const
+    {
+        return std::size_t(_S);
+    }
+
 protected:
     Graph _graph;
     std::vector<boost::default_color_type> _color;
@@ -0,0 +1,362 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MaxFlow_PushRelabel.hpp"
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace {
+
+/// append the nodes collected by each thread
+inline void appendNodes(std::vector<MaxFlow_PushRelabel::NodeType>& nodes, const std::vector<MaxFlow_PushRelabel::NodeType>& threadNodes)
+{
+    #pragma omp critical(MaxFlow_PushRelabel_appendNodes)
+    nodes.insert(nodes.end(), threadNodes.begin(), threadNodes.end());
+}
+
+} // namespace
+
+void MaxFlow_PushRelabel::buildGraph()
+{
+    const std::size_t nbEdges = 2 * _inputEdges.size();
+    if(nbEdges > std::numeric_limits<EdgeIndex>::max())
+        throw std::runtime_error("MaxFlow_PushRelabel: too many edges (" + std::to_string(nbEdges) + ").");
+
+    // count the edges of each node
+    _rowOffsets.assign(_numNodes + 1, 0);
+    for(const InputEdge& edge : _inputEdges)
+    {
+        ++_rowOffsets[edge.n1 + 1];
+        ++_rowOffsets[edge.n2 + 1];
+    }
+    for(std::size_t n = 0; n < _numNodes; ++n)
+        _rowOffsets[n + 1] += _rowOffsets[n];
+
+    // fill the rows, an edge and its reverse edge are added together
+    _edgeTargets.resize(nbEdges);
+    _reverseEdges.resize(nbEdges);
+    _residuals.resize(nbEdges);
+    {
+        std::vector<EdgeIndex> rowCursors(_rowOffsets.begin(), _rowOffsets.end() - 1);
+        for(const InputEdge& edge : _inputEdges)
+        {
+            const EdgeIndex e = rowCursors[edge.n1]++;
+            const EdgeIndex reverseEdge = rowCursors[edge.n2]++;
+
+            _edgeTargets[e] = edge.n2;
+            _residuals[e] = edge.capacity;
+            _reverseEdges[e] = reverseEdge;
+
+            _edgeTargets[reverseEdge] = edge.n1;
+            _residuals[reverseEdge] = edge.reverseCapacity;
+            _reverseEdges[reverseEdge] = e;
+        }
+    }
+    std::vector<InputEdge>().swap(_inputEdges);
+
+    // source and sink edges: the source edges are saturated by the initial preflow
+    _sinkResiduals.resize(_numNodes);
+    _excess.resize(_numNodes);
+    for(std::size_t n = 0; n < _numNodes; ++n)
+    {
+        const ValueType score = _terminalScores[n];
+        _excess[n] = (score > 0) ? score : 0.0f;
+        _sinkResiduals[n] = (score > 0) ? 0.0f : -score;
+    }
+    std::vector<ValueType>().swap(_terminalScores);
+
+    ALICEVISION_LOG_INFO("# vertices: " << _numNodes + 2);
+    ALICEVISION_LOG_INFO("# edges: " << nbEdges + 2 * _numNodes);
+}
+
+std::size_t MaxFlow_PushRelabel::globalRelabel()
+{
+    const NodeType infiniteLabel = NodeType(_numNodes + 2);
+    const std::ptrdiff_t numNodes = static_cast<std::ptrdiff_t>(_numNodes);
+
+    std::vector<NodeType> frontier;
+
+    #pragma omp parallel
+    {
+        std::vector<NodeType> threadFrontier;
+        #pragma omp for
+        for(std::ptrdiff_t n = 0; n < numNodes; ++n)
+        {
+            if(_sinkResiduals[n] > 0)
+            {
+                _labels[n] = 1;
+                threadFrontier.push_back(NodeType(n));
+            }
+            else
+            {
+                _labels[n] = infiniteLabel;
+            }
+        }
+        appendNodes(frontier, threadFrontier);
+    }
+
+    // breadth-first search from the sink on the reverse residual edges
+    std::size_t nbReachingNodes = frontier.size();
+    std::vector<NodeType> candidates;
+    for(NodeType label = 2; !frontier.empty(); ++label)
+    {
+        candidates.clear();
+
+        // the labels are only read in the parallel section
+        #pragma omp parallel
+        {
+            std::vector<NodeType> threadCandidates;
+            #pragma omp for schedule(dynamic, 256) nowait
+            for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(frontier.size()); ++i)
+            {
+                const NodeType v = frontier[i];
+                for(EdgeIndex e = _rowOffsets[v]; e < _rowOffsets[v + 1]; ++e)
+                {
+                    const NodeType w = _edgeTargets[e];
+                    if(_labels[w] == infiniteLabel && _residuals[_reverseEdges[e]] > 0)
+                        threadCandidates.push_back(w);
+                }
+            }
+            appendNodes(candidates, threadCandidates);
+        }
+
+        frontier.clear();
+        for(const NodeType w : candidates)
+        {
+            if(_labels[w] != infiniteLabel)
+                continue;
+            _labels[w] = label;
+            frontier.push_back(w);
+        }
+        nbReachingNodes += frontier.size();
+    }
+    return nbReachingNodes;
+}
+
+MaxFlow_PushRelabel::ValueType MaxFlow_PushRelabel::compute()
+{
+    ALICEVISION_LOG_INFO("Compute push_relabel_max_flow on " << omp_get_max_threads() << " thread(s).");
+    system::Timer timer;
+
+    buildGraph();
+
+    const NodeType infiniteLabel = NodeType(_numNodes + 2);
+    const std::size_t nbEdges = _edgeTargets.size();
+
+    _labels.resize(_numNodes);
+    std::vector<std::atomic<ValueType>>(_numNodes).swap(_receivedExcess);
+    #pragma omp parallel for
+    for(std::ptrdiff_t n = 0; n < static_cast<std::ptrdiff_t>(_numNodes); ++n)
+        _receivedExcess[n].store(0.0f, std::memory_order_relaxed);
+
+    std::vector<char> isQueued(_numNodes, 0);
+
+    globalRelabel();
+    std::size_t nbGlobalRelabels = 1;
+
+    std::vector<NodeType> active;
+    for(std::size_t n = 0; n < _numNodes; ++n)
+    {
+        if(_excess[n] > 0 && _labels[n] < infiniteLabel)
+            active.push_back(NodeType(n));
+    }
+
+    // global relabeling frequency of the sequential implementations: alpha * n + m relabeling work
+    const std::size_t globalRelabelWork = 6 * _numNodes + nbEdges;
+    std::size_t relabelWork = 0;
+
+    double sinkFlow = 0.0;
+    std::size_t nbRounds = 0;
+    std::size_t nbPushes = 0;
+    std::size_t nbRelabels = 0;
+
+    std::vector<NodeType> receivers;
+    std::vector<NodeType> toRelabel;
+    std::vector<NodeType> newLabels;
+    std::vector<NodeType> nextActive;
+
+    while(!active.empty())
+    {
+        ++nbRounds;
+        receivers.clear();
+        toRelabel.clear();
+
+        // push the excess of the active nodes on the admissible edges (label of the target + 1 == label of the node)
+        #pragma omp parallel reduction(+:sinkFlow, nbPushes)
+        {
+            std::vector<NodeType> threadReceivers;
+            std::vector<NodeType> threadToRelabel;
+
+            #pragma omp for schedule(dynamic, 256) nowait
+            for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(active.size()); ++i)
+            {
+                const NodeType v = active[i];
+                const NodeType label = _labels[v];
+                ValueType excess = _excess[v];
+
+                if(label == 1 && _sinkResiduals[v] > 0)
+                {
+                    const ValueType delta = std::min(excess, _sinkResiduals[v]);
+                    _sinkResiduals[v] -= delta;
+                    excess -= delta;
+                    sinkFlow += delta;
+                    ++nbPushes;
+                }
+
+                for(EdgeIndex e = _rowOffsets[v]; e < _rowOffsets[v + 1] && excess > 0; ++e)
+                {
+                    const NodeType w = _edgeTargets[e];
+                    // the reverse edge of an admissible edge is not admissible: only this thread accesses the residuals
+                    if(_labels[w] + 1 != label || _residuals[e] <= 0)
+                        continue;
+
+                    const ValueType delta = std::min(excess, _residuals[e]);
+                    _residuals[e] -= delta;
+                    _residuals[_reverseEdges[e]] += delta;
+                    excess -= delta;
+                    ++nbPushes;
+
+                    ValueType previous = _receivedExcess[w].load(std::memory_order_relaxed);
+                    while(!_receivedExcess[w].compare_exchange_weak(previous, previous + delta, std::memory_order_relaxed))
+                    {}
+                    if(previous == 0)
+                        threadReceivers.push_back(w);
+                }
+
+                _excess[v] = excess;
+                if(excess > 0)
+                    threadToRelabel.push_back(v);
+            }
+            appendNodes(receivers, threadReceivers);
+            appendNodes(toRelabel, threadToRelabel);
+        }
+        nbRelabels += toRelabel.size();
+
+        // add the received excess
+        #pragma omp parallel for
+        for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(receivers.size()); ++i)
+        {
+            const NodeType w = receivers[i];
+            _excess[w] += _receivedExcess[w].load(std::memory_order_relaxed);
+            _receivedExcess[w].store(0.0f, std::memory_order_relaxed);
+        }
+
+        // relabel the nodes with remaining excess, from the labels of this round
+        newLabels.resize(toRelabel.size());
+        #pragma omp parallel for reduction(+:relabelWork)
+        for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(toRelabel.size()); ++i)
+        {
+            const NodeType v = toRelabel[i];
+            NodeType newLabel = (_sinkResiduals[v] > 0) ? 1 : infiniteLabel;
+            for(EdgeIndex e = _rowOffsets[v]; e < _rowOffsets[v + 1]; ++e)
+            {
+                if(_residuals[e] > 0)
+                    newLabel = std::min(newLabel, NodeType(_labels[_edgeTargets[e]] + 1));
+            }
+            newLabels[i] = std::min(newLabel, infiniteLabel);
+            relabelWork += 12 + _rowOffsets[v + 1] - _rowOffsets[v];
+        }
+
+        // next active nodes: the relabeled nodes and the nodes that received excess
+        nextActive.clear();
+        #pragma omp parallel
+        {
+            std::vector<NodeType> threadActive;
+
+            #pragma omp for
+            for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(toRelabel.size()); ++i)
+            {
+                const NodeType v = toRelabel[i];
+                _labels[v] = newLabels[i];
+                isQueued[v] = 1;
+                if(newLabels[i] < infiniteLabel)
+                    threadActive.push_back(v);
+            }
+
+            #pragma omp for nowait
+            for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(receivers.size()); ++i)
+            {
+                const NodeType w = receivers[i];
+                if(!isQueued[w] && _labels[w] < infiniteLabel)
+                    threadActive.push_back(w);
+            }
+            appendNodes(nextActive, threadActive);
+        }
+        for(const NodeType v : toRelabel)
+            isQueued[v] = 0;
+
+        if(relabelWork > globalRelabelWork)
+        {
+            globalRelabel();
+            ++nbGlobalRelabels;
+            relabelWork = 0;
+            nextActive.erase(std::remove_if(nextActive.begin(), nextActive.end(), [&](NodeType v){ return _labels[v] >= infiniteLabel; }),
+                             nextActive.end());
+        }
+        active.swap(nextActive);
+    }
+
+    // minimum cut: the nodes that can reach the sink in the residual graph
+    const std::size_t nbTargetNodes = globalRelabel();
+    _isTarget.resize(_numNodes);
+    for(std::size_t n = 0; n < _numNodes; ++n)
+        _isTarget[n] = (_labels[n] < infiniteLabel);
+
+    ALICEVISION_LOG_INFO("push_relabel_max_flow: done in " << timer.elapsed() << " s." << std::endl
+                         << "\t- # rounds: " << nbRounds << std::endl
+                         << "\t- # pushes: " << nbPushes << std::endl
+                         << "\t- # relabels: " << nbRelabels << std::endl
+                         << "\t- # global relabels: " << nbGlobalRelabels << std::endl
+                         << "\t- # target nodes: " << nbTargetNodes << " / " << _numNodes);
+
+    // release the graph
+    std::vector<EdgeIndex>().swap(_rowOffsets);
+    std::vector<NodeType>().swap(_edgeTargets);
+    std::vector<EdgeIndex>().swap(_reverseEdges);
+    std::vector<ValueType>().swap(_residuals);
+    std::vector<ValueType>().swap(_sinkResiduals);
+    std::vector<NodeType>().swap(_labels);
+    std::vector<ValueType>().swap(_excess);
+    std::vector<std::atomic<ValueType>>().swap(_receivedExcess);
+
+    return ValueType(sinkFlow);
+}
+
+void MaxFlow_PushRelabel::saveGraph(const std::string& filepath) const
+{
+    static_assert(sizeof(InputEdge) == 2 * sizeof(std::uint32_t) + 2 * sizeof(float), "Unexpected maxflow edge layout.");
+
+    std::ofstream stream(filepath, std::ios::binary);
+    if(!stream.is_open())
+        throw std::runtime_error("Unable to create the maxflow graph file: " + filepath);
+
+    const std::uint32_t magic = graphFileMagic;
+    const std::uint32_t version = graphFileVersion;
+    const std::uint64_t numNodes = _numNodes;
+    const std::uint64_t numEdges = _inputEdges.size();
+
+    stream.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    stream.write(reinterpret_cast<const char*>(&numNodes), sizeof(numNodes));
+    stream.write(reinterpret_cast<const char*>(&numEdges), sizeof(numEdges));
+    stream.write(reinterpret_cast<const char*>(_terminalScores.data()), _terminalScores.size() * sizeof(ValueType));
+    stream.write(reinterpret_cast<const char*>(_inputEdges.data()), _inputEdges.size() * sizeof(InputEdge));
+
+    if(!stream)
+        throw std::runtime_error("Unable to write the maxflow graph file: " + filepath);
+
+    ALICEVISION_LOG_INFO("Maxflow graph saved: " << filepath << " (" << numNodes << " nodes, " << numEdges << " edges).");
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,193 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Multi-threaded maxflow computation based on a synchronous parallel push-relabel algorithm.
+ *
+ * The graph is stored in a compressed sparse row representation built from the added edges:
+ * as each edge is added with its reverse edge, the reverse edge indices are known while
+ * filling the rows, without any search or temporary map.
+ * The source and sink edges are not stored in the rows, but as an initial excess and
+ * a sink residual capacity per node.
+ *
+ * Each round of the algorithm pushes the excess of all the active nodes in parallel
+ * using the labels of the previous round, then relabels them in parallel.
+ * With these fixed labels, an edge and its reverse edge cannot be both admissible,
+ * so each residual capacity is only modified by a single thread.
+ * The labels are regularly set to the exact distances to the sink (global relabeling).
+ *
+ * Only the first phase of the algorithm is computed (maximum preflow), it is enough for the minimum cut:
+ * the target nodes are the nodes that can reach the sink in the residual graph.
+ * It is the same cut as MaxFlow_AdjList and MaxFlow_CSR (sink tree of boykov_kolmogorov_max_flow).
+ */
+class MaxFlow_PushRelabel
+{
+public:
+    using NodeType = unsigned int;
+    using ValueType = float;
+    using EdgeIndex = unsigned int;
+
+    /// saved graph file header, see saveGraph
+    static constexpr std::uint32_t graphFileMagic = 0x4D465047; // "GPFM"
+    static constexpr std::uint32_t graphFileVersion = 1;
+
+    explicit MaxFlow_PushRelabel(size_t numNodes)
+        : _numNodes(numNodes)
+        , _terminalScores(numNodes, 0.0f)
+    {
+        ALICEVISION_LOG_INFO("MaxFlow constructor.");
+        _inputEdges.reserve(numNodes * 9);
+    }
+
+    inline void addNode(NodeType n, ValueType source, ValueType sink)
+    {
+        assert(source >= 0 && sink >= 0);
+        _terminalScores[n] = source - sink;
+    }
+
+    inline void addEdge(NodeType n1, NodeType n2, ValueType capacity, ValueType reverseCapacity)
+    {
+        assert(capacity >= 0 && reverseCapacity >= 0);
+        _inputEdges.push_back({n1, n2, capacity, reverseCapacity});
+    }
+
+    /**
+     * @brief Compute the maximum flow between the source and the sink
+     * @note The added edges are released when the compressed sparse row graph is built.
+     * @return the flow value
+     */
+    ValueType compute();
+
+    /// is empty
+    inline bool isSource(NodeType n) const
+    {
+        return !_isTarget[n];
+    }
+    /// is full
+    inline bool isTarget(NodeType n) const
+    {
+        return _isTarget[n];
+    }
+
+    inline std::size_t getNbNodes() const
+    {
+        return _numNodes;
+    }
+
+    /**
+     * @brief Save the added nodes and edges in a binary file, to benchmark the maxflow solvers on real graphs
+     * @note Must be called before compute.
+     * @param[in] filepath The output file path
+     */
+    void saveGraph(const std::string& filepath) const;
+
+private:
+
+    /// edge added with its reverse edge
+    struct InputEdge
+    {
+        NodeType n1;
+        NodeType n2;
+        ValueType capacity;
+        ValueType reverseCapacity;
+    };
+
+    /// build the compressed sparse row graph and release the added edges
+    void buildGraph();
+
+    /**
+     * @brief Set the label of each node to its distance to the sink in the residual graph
+     * @return the number of nodes that can reach the sink
+     */
+    std::size_t globalRelabel();
+
+    std::size_t _numNodes;
+    /// source weight - sink weight of each node
+    std::vector<ValueType> _terminalScores;
+    std::vector<InputEdge> _inputEdges;
+
+    // compressed sparse row graph
+    std::vector<EdgeIndex> _rowOffsets;
+    std::vector<NodeType> _edgeTargets;
+    std::vector<EdgeIndex> _reverseEdges;
+    std::vector<ValueType> _residuals;
+    std::vector<ValueType> _sinkResiduals;
+
+    // push-relabel state
+    std::vector<NodeType> _labels;
+    std::vector<ValueType> _excess;
+    std::vector<std::atomic<ValueType>> _receivedExcess;
+
+    std::vector<bool> _isTarget;
+};
+
+/**
+ * @brief Load a graph saved by MaxFlow_PushRelabel::saveGraph or MaxFlow_AdjList::saveGraph in a maxflow solver
+ * @param[in] filepath The input file path
+ * @return the maxflow solver (MaxFlow_AdjList, MaxFlow_CSR or MaxFlow_PushRelabel) with the graph nodes and edges
+ */
+template<class MaxFlowT>
+std::unique_ptr<MaxFlowT> loadMaxFlowGraph(const std::string& filepath)
+{
+    std::ifstream stream(filepath, std::ios::binary);
+    if(!stream.is_open())
+        throw std::runtime_error("Unable to open the maxflow graph file: " + filepath);
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t numNodes = 0;
+    std::uint64_t numEdges = 0;
+    stream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+    stream.read(reinterpret_cast<char*>(&numNodes), sizeof(numNodes));
+    stream.read(reinterpret_cast<char*>(&numEdges), sizeof(numEdges));
+
+    if(!stream || magic != MaxFlow_PushRelabel::graphFileMagic || version != MaxFlow_PushRelabel::graphFileVersion)
+        throw std::runtime_error("Invalid maxflow graph file: " + filepath);
+
+    std::unique_ptr<MaxFlowT> maxFlow(new MaxFlowT(numNodes));
+
+    std::vector<float> scores(numNodes);
+    stream.read(reinterpret_cast<char*>(scores.data()), numNodes * sizeof(float));
+    for(std::uint64_t n = 0; n < numNodes; ++n)
+    {
+        const float score = scores[n];
+        maxFlow->addNode(typename MaxFlowT::NodeType(n), (score > 0) ? score : 0.0f, (score > 0) ? 0.0f : -score);
+    }
+
+    for(std::uint64_t e = 0; e < numEdges; ++e)
+    {
+        std::uint32_t nodes[2];
+        float capacities[2];
+        stream.read(reinterpret_cast<char*>(nodes), sizeof(nodes));
+        stream.read(reinterpret_cast<char*>(capacities), sizeof(capacities));
+        maxFlow->addEdge(typename MaxFlowT::NodeType(nodes[0]), typename MaxFlowT::NodeType(nodes[1]), capacities[0], capacities[1]);
+    }
+
+    if(!stream)
+        throw std::runtime_error("Truncated maxflow graph file: " + filepath);
+
+    return maxFlow;
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,125 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#define BOOST_TEST_MODULE fuseCutMaxFlow
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace fs = boost::filesystem;
+
+/**
+ * @brief Add the same random graph in two maxflow solvers
+ * @param[in] seed The random generator seed
+ * @param[in] numNodes The number of nodes
+ * @param[in] integerCapacities Use integer capacities to get exact flow values
+ */
+template<class MaxFlowA, class MaxFlowB>
+void addRandomGraph(int seed, int numNodes, bool integerCapacities, MaxFlowA& a, MaxFlowB& b)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> nodeDistribution(0, numNodes - 1);
+    std::uniform_real_distribution<float> weightDistribution(0.0f, 10.0f);
+    std::uniform_int_distribution<int> integerDistribution(0, 20);
+
+    auto randomWeight = [&]() {
+        return integerCapacities ? float(integerDistribution(generator)) : weightDistribution(generator);
+    };
+
+    for(int n = 0; n < numNodes; ++n)
+    {
+        const float source = randomWeight();
+        const float sink = randomWeight();
+        a.addNode(n, source, sink);
+        b.addNode(n, source, sink);
+    }
+    for(int e = 0; e < 4 * numNodes; ++e)
+    {
+        const int n1 = nodeDistribution(generator);
+        const int n2 = nodeDistribution(generator);
+        if(n1 == n2)
+            continue;
+        const float capacity = randomWeight();
+        const float reverseCapacity = randomWeight();
+        a.addEdge(n1, n2, capacity, reverseCapacity);
+        b.addEdge(n1, n2, capacity, reverseCapacity);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_pushRelabel)
+{
+    for(int seed = 0; seed < 50; ++seed)
+    {
+        const int numNodes = 50 + seed * 41;
+        const bool integerCapacities = (seed % 2 == 1);
+
+        MaxFlow_PushRelabel pushRelabel(numNodes);
+        MaxFlow_AdjList boykovKolmogorov(numNodes);
+        addRandomGraph(seed, numNodes, integerCapacities, pushRelabel, boykovKolmogorov);
+
+        const float pushRelabelFlow = pushRelabel.compute();
+        const float boykovKolmogorovFlow = boykovKolmogorov.compute();
+        BOOST_CHECK_SMALL(pushRelabelFlow - boykovKolmogorovFlow, 1e-3f * std::max(1.0f, boykovKolmogorovFlow));
+
+        int nbDifferentNodes = 0;
+        for(int n = 0; n < numNodes; ++n)
+        {
+            if(pushRelabel.isTarget(n) != boykovKolmogorov.isTarget(n))
+                ++nbDifferentNodes;
+        }
+        BOOST_CHECK_EQUAL(nbDifferentNodes, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_saveLoadGraph)
+{
+    const int numNodes = 500;
+    const fs::path filepath = fs::temp_directory_path() / fs::unique_path("maxflow_%%%%%%%%.bin");
+
+    MaxFlow_PushRelabel pushRelabel(numNodes);
+    MaxFlow_AdjList boykovKolmogorov(numNodes);
+    addRandomGraph(7, numNodes, true, pushRelabel, boykovKolmogorov);
+
+    pushRelabel.saveGraph(filepath.string());
+    std::unique_ptr<MaxFlow_AdjList> loadedGraph = loadMaxFlowGraph<MaxFlow_AdjList>(filepath.string());
+    fs::remove(filepath);
+
+    BOOST_CHECK_EQUAL(loadedGraph->compute(), boykovKolmogorov.compute());
+    for(int n = 0; n < numNodes; ++n)
+        BOOST_CHECK_EQUAL(loadedGraph->isTarget(n), boykovKolmogorov.isTarget(n));
+
+    BOOST_CHECK_THROW(loadMaxFlowGraph<MaxFlow_AdjList>(filepath.string()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fuseCut_maxFlow_saveAdjListGraph)
+{
+    const int numNodes = 500;
+    const fs::path filepath = fs::temp_directory_path() / fs::unique_path("maxflow_%%%%%%%%.bin");
+
+    MaxFlow_PushRelabel pushRelabel(numNodes);
+    MaxFlow_AdjList boykovKolmogorov(numNodes);
+    addRandomGraph(11, numNodes, true, pushRelabel, boykovKolmogorov);
+
+    // the graph saved by the default meshing solver gives the same cut in the push-relabel solver
+    boykovKolmogorov.saveGraph(filepath.string());
+    std::unique_ptr<MaxFlow_PushRelabel> loadedGraph = loadMaxFlowGraph<MaxFlow_PushRelabel>(filepath.string());
+    fs::remove(filepath);
+
+    BOOST_CHECK_EQUAL(loadedGraph->compute(), pushRelabel.compute());
+    for(int n = 0; n < numNodes; ++n)
+        BOOST_CHECK_EQUAL(loadedGraph->isTarget(n), pushRelabel.isTarget(n));
+}
@@ -28,6 +28,7 @@ void CacheManager::wipe() {
   deleteIndexFiles();
 
   _mru.clear();
+  _pinCounts.clear();
   
   _incoreBlockUsageCount = 0;
   _nextStartBlockId = 0;
@@ -253,12 +254,26 @@ bool CacheManager::acquireObject(std::unique_ptr<unsigned char> & data, size_t o
     _mru.relocate(_mru.begin(), p.first);
   }
 
-  while (_incoreBlockUsageCount > _incoreBlockUsageMax && _mru.size() > 1) {
-    
-    MRUItem item = _mru.back();
+  /*
+  Remove the least recently used objects until the memory usage is acceptable.
+  The first item (the acquired object) and the pinned objects are kept in core.
+  */
+  MRUType::iterator itmru = _mru.end();
+  while (_incoreBlockUsageCount > _incoreBlockUsageMax && itmru != _mru.begin()) {
+
+    --itmru;
+    if (itmru == _mru.begin()) {
+      break;
+    }
+
+    if (_pinCounts.find(itmru->objectId) != _pinCounts.end()) {
+      continue;
+    }
+
+    MRUItem item = *itmru;
 
     /*Remove item from mru*/
-    _mru.pop_back();
+    itmru = _mru.erase(itmru);
 
     /*Update memory usage*/
     _incoreBlockUsageCount -= item.objectSize;
@@ -269,6 +284,30 @@ bool CacheManager::acquireObject(std::unique_ptr<unsigned char> & data, size_t o
   return true;
 }
 
+bool CacheManager::pinObject(std::unique_ptr<unsigned char> & data, size_t objectId) {
+
+  if (!acquireObject(data, objectId)) {
+    return false;
+  }
+
+  _pinCounts[objectId]++;
+
+  return true;
+}
+
+void CacheManager::unpinObject(size_t objectId) {
+
+  std::unordered_map<size_t, size_t>::iterator itfind = _pinCounts.find(objectId);
+  if (itfind == _pinCounts.end()) {
+    return;
+  }
+
+  itfind->second--;
+  if (itfind->second == 0) {
+    _pinCounts.erase(itfind);
+  }
+}
+
 bool CacheManager::saveObject(std::unique_ptr<unsigned char> && data, size_t objectId) {
   
   MemoryMap::iterator itfind = _memoryMap.find(objectId);
@@ -323,6 +362,24 @@ bool CachedTile::acquire() {
   return true;
 }
 
+bool CachedTile::pin() {
+
+  std::shared_ptr<TileCacheManager> manager = _manager.lock();
+  if (!manager) {
+    return false;
+  }
+
+  return manager->pin(_uid);
+}
+
+void CachedTile::unpin() {
+
+  std::shared_ptr<TileCacheManager> manager = _manager.lock();
+  if (manager) {
+    manager->unpin(_uid);
+  }
+}
+
 TileCacheManager::TileCacheManager(const std::string & pathStorage, size_t tileWidth, size_t tileHeight, size_t maxTilesPerIndex) :
 CacheManager(pathStorage, tileWidth * tileHeight, maxTilesPerIndex),
 _tileWidth(tileWidth), _tileHeight(tileHeight)
@@ -366,6 +423,7 @@ std::shared_ptr<TileCacheManager> TileCacheManager::create(const std::string & p
 
 std::shared_ptr<CachedTile> TileCacheManager::requireNewCachedTile(size_t width, size_t height, size_t blockCount) {
 
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
 
   CachedTile::smart_pointer ret;
   size_t uid;
@@ -386,6 +444,10 @@ std::shared_ptr<CachedTile> TileCacheManager::requireNewCachedTile(size_t width,
 
 void TileCacheManager::notifyDestroy(size_t tileId) {
   
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+  _pinCounts.erase(tileId);
+
   /* Remove weak pointer */
   _objectMap.erase(tileId);
 
@@ -408,6 +470,26 @@ void TileCacheManager::notifyDestroy(size_t tileId) {
 
 bool TileCacheManager::acquire(size_t tileId) {
 
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+  return acquireTile(tileId, false);
+}
+
+bool TileCacheManager::pin(size_t tileId) {
+
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+  return acquireTile(tileId, true);
+}
+
+void TileCacheManager::unpin(size_t tileId) {
+
+  std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+  CacheManager::unpinObject(tileId);
+}
+
+bool TileCacheManager::acquireTile(size_t tileId, bool pinned) {
 
   MapCachedTile::iterator itfind = _objectMap.find(tileId);
   if (itfind == _objectMap.end()) {
@@ -419,14 +501,21 @@ bool TileCacheManager::acquire(size_t tileId) {
     return false;
   }
   
-  /*Acquire the object*/
-  std::unique_ptr<unsigned char> content = tile->getData();
-  if (!CacheManager::acquireObject(content, tileId)) {
+  /*
+  Acquire the object.
+  The content is only filled if the object was out of core,
+  the data of an in core tile is never moved as other threads may use it.
+  */
+  std::unique_ptr<unsigned char> content;
+  const bool acquired = pinned ? CacheManager::pinObject(content, tileId) : CacheManager::acquireObject(content, tileId);
+  if (!acquired) {
     return false;
   }
 
   /*Update tile data*/
-  tile->setData(std::move(content));
+  if (content) {
+    tile->setData(std::move(content));
+  }
 
 
   return true;
@@ -9,6 +9,7 @@
 
 #include "aliceVision/numeric/numeric.hpp"
 #include <memory>
+#include <mutex>
 
 #include <unordered_map>
 #include <boost/multi_index_container.hpp>
@@ -86,6 +87,27 @@ public:
   */
   bool acquire();
 
+  /**
+   * Acquire the data of this tile and keep it in core until unpin() is called.
+   * A tile may be pinned several times (from several threads), it stays in core
+   * until all the pins are released.
+   * @return false if the process failed to grab data.
+   */
+  bool pin();
+
+  /**
+   * Release a pin previously obtained with pin()
+   */
+  void unpin();
+
+  /**
+   * Get the mutex associated to this tile content.
+   * Used by the algorithms which modify the same tile from several threads.
+   */
+  std::mutex & getMutex() {
+    return _mutex;
+  }
+
   /**
    * Update data with a new buffer
    * Move the data parameter to the _data property.
@@ -119,6 +141,7 @@ public:
 private:
   std::unique_ptr<unsigned char> _data = nullptr;
   std::weak_ptr<TileCacheManager> _manager;
+  std::mutex _mutex;
 
   size_t _uid;
   size_t _tileWidth;
@@ -128,8 +151,44 @@ private:
   size_t _depth;
 };
 
+/**
+ * Keep a cached tile in core for the lifetime of this object.
+ * The data pointer stays valid whatever the other threads acquire in the meantime.
+ */
+class PinnedTile {
+public:
+  PinnedTile() = delete;
+  PinnedTile(const PinnedTile &) = delete;
+  PinnedTile & operator=(const PinnedTile &) = delete;
+
+  explicit PinnedTile(const CachedTile::smart_pointer & tile) 
+  : _tile(tile) {
+    _pinned = (_tile && _tile->pin());
+  }
+
+  ~PinnedTile() {
+    if (_pinned) {
+      _tile->unpin();
+    }
+  }
+
+  bool isValid() const {
+    return _pinned;
+  }
+
+  template <class T>
+  T * getData() const {
+    return reinterpret_cast<T *>(_tile->getDataPointer());
+  }
+
+private:
+  CachedTile::smart_pointer _tile;
+  bool _pinned{false};
+};
+
 /*
 An abstract concept of cache management for generic objects
+Pinned objects are never removed from the core memory, even if the maximal memory size is exceeded.
 */
 class CacheManager {
 public:
@@ -214,6 +273,20 @@ public:
    */
   bool acquireObject(std::unique_ptr<unsigned char> & data, size_t objectId);
 
+  /**
+   * Acquire a given object and keep it in core until unpinObject() is called
+   * @param data the result data acquired
+   * @param objectId the object index to pin
+   * @return true if the object was pinned
+   */
+  bool pinObject(std::unique_ptr<unsigned char> & data, size_t objectId);
+
+  /**
+   * Release a pin on a given object
+   * @param objectId the object index to unpin
+   */
+  void unpinObject(size_t objectId);
+
   /**
    * Get the number of managed blocks
    * @return a block count
@@ -252,11 +325,13 @@ protected:
 
   MRUType _mru;
   MemoryMap _memoryMap;
+  std::unordered_map<size_t, size_t> _pinCounts;
 };
 
 /**
  * A cache manager specialized for image tiles
  * All tiles in this image have a size multiple of a given base tile size.
+ * The tiles may be acquired, pinned and released from several threads.
  */
 class TileCacheManager : public CacheManager, public std::enable_shared_from_this<TileCacheManager> {
 public:
@@ -291,6 +366,19 @@ public:
    */
   bool acquire(size_t tileId);
 
+  /**
+   * Acquire a given tile and keep it in core until unpin() is called
+   * @param tileId the tile index to pin
+   * @return true if the tile was pinned
+   */
+  bool pin(size_t tileId);
+
+  /**
+   * Release a pin on a given tile
+   * @param tileId the tile index to unpin
+   */
+  void unpin(size_t tileId);
+
   /**
    * Acquire a given tile
    * @param width the requested tile size (less or equal to the base tile size)
@@ -327,12 +415,17 @@ protected:
 
   virtual void onRemovedFromMRU(size_t objectId);
 
+  bool acquireTile(size_t tileId, bool pinned);
+
 protected:
 
   size_t _tileWidth;
   size_t _tileHeight;
 
   MapCachedTile _objectMap;
+
+  // recursive as a tile may be destroyed (and notify the manager) while the manager is working
+  std::recursive_mutex _mutex;
 };
 
 }
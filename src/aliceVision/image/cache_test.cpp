@@ -0,0 +1,113 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/cache.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+#define BOOST_TEST_MODULE ImageCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace bfs = boost::filesystem;
+
+static void fillTile(const CachedTile::smart_pointer & tile, float value)
+{
+  PinnedTile pinned(tile);
+  BOOST_REQUIRE(pinned.isValid());
+
+  float * data = pinned.getData<float>();
+  std::fill(data, data + tile->getTileWidth() * tile->getTileHeight(), value);
+}
+
+static bool checkTile(const CachedTile::smart_pointer & tile, float value)
+{
+  PinnedTile pinned(tile);
+  if (!pinned.isValid())
+  {
+    return false;
+  }
+
+  const float * data = pinned.getData<float>();
+  for (std::size_t i = 0; i < tile->getTileWidth() * tile->getTileHeight(); ++i)
+  {
+    if (data[i] != value)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(TileCache_outOfCore)
+{
+  const bfs::path cacheFolder = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directories(cacheFolder);
+
+  {
+    TileCacheManager::shared_ptr manager = TileCacheManager::create(cacheFolder.string(), 16, 16, 64);
+    BOOST_REQUIRE(manager);
+
+    // only two float tiles in core
+    manager->setMaxMemory(2 * 16 * 16 * sizeof(float));
+
+    std::vector<CachedTile::smart_pointer> tiles;
+    for (int i = 0; i < 8; ++i)
+    {
+      tiles.push_back(manager->requireNewCachedTile<float>(16, 16));
+      fillTile(tiles.back(), float(i));
+    }
+
+    // the first tiles were moved out of core and must be reloaded from disk
+    for (int i = 0; i < 8; ++i)
+    {
+      BOOST_CHECK(checkTile(tiles[i], float(i)));
+    }
+  }
+
+  bfs::remove_all(cacheFolder);
+}
+
+BOOST_AUTO_TEST_CASE(TileCache_pinnedTilesStayInCore)
+{
+  const bfs::path cacheFolder = bfs::temp_directory_path() / bfs::unique_path();
+  bfs::create_directories(cacheFolder);
+
+  {
+    TileCacheManager::shared_ptr manager = TileCacheManager::create(cacheFolder.string(), 16, 16, 64);
+    BOOST_REQUIRE(manager);
+
+    manager->setMaxMemory(2 * 16 * 16 * sizeof(float));
+
+    CachedTile::smart_pointer pinnedTile = manager->requireNewCachedTile<float>(16, 16);
+    fillTile(pinnedTile, 42.0f);
+
+    PinnedTile pinned(pinnedTile);
+    BOOST_REQUIRE(pinned.isValid());
+    const float * data = pinned.getData<float>();
+
+    // acquiring many other tiles must not move the pinned one out of core
+    std::vector<CachedTile::smart_pointer> tiles;
+    for (int i = 0; i < 8; ++i)
+    {
+      tiles.push_back(manager->requireNewCachedTile<float>(16, 16));
+      fillTile(tiles.back(), float(i));
+    }
+
+    BOOST_CHECK(pinnedTile->getDataPointer() != nullptr);
+    BOOST_CHECK_EQUAL(reinterpret_cast<const float *>(pinnedTile->getDataPointer()), data);
+    BOOST_CHECK_EQUAL(data[0], 42.0f);
+    BOOST_CHECK_EQUAL(data[16 * 16 - 1], 42.0f);
+  }
+
+  bfs::remove_all(cacheFolder);
+}
@@ -18,7 +18,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
@@ -242,16 +244,11 @@ void getBufferFromImage(Image<RGBColor>& image, oiio::ImageBuf& buffer)
   getBufferFromImage(image, oiio::TypeDesc::UINT8, 3, buffer);
 }
 
-template<typename T>
-void readImage(const std::string& path,
-               oiio::TypeDesc format,
-               int nchannels,
-               Image<T>& image,
-               const ImageReadOptions & imageReadOptions)
+/**
+ * @brief Get the configuration of the image input plugins for the given read options
+ */
+oiio::ImageSpec getReadConfigSpec(const ImageReadOptions& imageReadOptions)
 {
-  // check requested channels number
-  assert(nchannels == 1 || nchannels >= 3);
-
   oiio::ImageSpec configSpec;
 
   // libRAW configuration
@@ -267,13 +264,162 @@ void readImage(const std::string& path,
   configSpec.attribute("raw:ColorSpace", "Linear"); // use linear colorspace with sRGB primaries
 #endif
 
-  oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+  return configSpec;
+}
 
-  inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+/**
+ * @brief Get the region to read from an image file, in pixel coordinates of its data window
+ */
+oiio::ROI getReadRegion(const std::string& path, const oiio::ImageSpec& spec, const ImageReadOptions& imageReadOptions)
+{
+  oiio::ROI roi(spec.x, spec.x + spec.width, spec.y, spec.y + spec.height);
+  if(imageReadOptions.subROI.defined())
+  {
+    roi.xbegin = std::max(roi.xbegin, spec.x + imageReadOptions.subROI.xbegin);
+    roi.xend = std::min(roi.xend, spec.x + imageReadOptions.subROI.xend);
+    roi.ybegin = std::max(roi.ybegin, spec.y + imageReadOptions.subROI.ybegin);
+    roi.yend = std::min(roi.yend, spec.y + imageReadOptions.subROI.yend);
+    if(roi.width() <= 0 || roi.height() <= 0)
+      throw std::runtime_error("The requested region is outside of image file '" + path + "'.");
+  }
+  return roi;
+}
+
+/**
+ * @brief Read a region of a resolution level of an opened image file, tile by tile or scanline by scanline
+ * @param[in] in The opened image file, positioned on the resolution level
+ * @param[in] path The image path (for error messages)
+ * @param[in] miplevel The resolution level
+ * @param[in] roi The region to read, in pixel coordinates of the resolution level
+ * @param[out] buffer The float buffer of the region, with all the channels of the file
+ */
+void readInputRegion(oiio::ImageInput& in, const std::string& path, int miplevel, const oiio::ROI& roi, oiio::ImageBuf& buffer)
+{
+  const oiio::ImageSpec& spec = in.spec();
+  const int nchannels = spec.nchannels;
+
+  oiio::ImageSpec regionSpec(roi.width(), roi.height(), nchannels, oiio::TypeDesc::FLOAT);
+  regionSpec.extra_attribs = spec.extra_attribs; // keep the file metadata (color space)
+  buffer.reset(regionSpec);
+
+  float* regionData = static_cast<float*>(buffer.localpixels());
+  const std::size_t regionRowSize = std::size_t(roi.width()) * nchannels;
+
+  // rows of the region are read by blocks: one row of tiles or a few scanlines, always on the whole width
+  const bool isTiled = (spec.tile_width > 0 && spec.tile_height > 0);
+  const int blockHeight = isTiled ? spec.tile_height : 64;
+
+  // tiles reads must be aligned on the tiles grid (or end on the image border)
+  int xbegin = spec.x;
+  int xend = spec.x + spec.width;
+  int ybegin = roi.ybegin;
+  if(isTiled)
+  {
+    xbegin = spec.x + ((roi.xbegin - spec.x) / spec.tile_width) * spec.tile_width;
+    xend = std::min(xend, spec.x + ((roi.xend - spec.x + spec.tile_width - 1) / spec.tile_width) * spec.tile_width);
+    ybegin = spec.y + ((roi.ybegin - spec.y) / spec.tile_height) * spec.tile_height;
+  }
+  const std::size_t blockRowSize = std::size_t(xend - xbegin) * nchannels;
+  std::vector<float> block(blockRowSize * blockHeight);
 
-  if(!inBuf.initialized())
+  for(int y = ybegin; y < roi.yend; y += blockHeight)
+  {
+    const int yend = std::min(y + blockHeight, spec.y + spec.height);
+    const bool success = isTiled ?
+      in.read_tiles(0, miplevel, xbegin, xend, y, yend, spec.z, spec.z + std::max(1, spec.depth), 0, nchannels, oiio::TypeDesc::FLOAT, block.data()) :
+      in.read_scanlines(0, miplevel, y, yend, spec.z, 0, nchannels, oiio::TypeDesc::FLOAT, block.data());
+    if(!success)
+      throw std::runtime_error("Can't read pixels of image file '" + path + "': " + in.geterror());
+
+    for(int row = std::max(y, roi.ybegin); row < std::min(yend, roi.yend); ++row)
+    {
+      const float* blockRow = block.data() + (row - y) * blockRowSize + std::size_t(roi.xbegin - xbegin) * nchannels;
+      std::copy(blockRow, blockRow + regionRowSize, regionData + (row - roi.ybegin) * regionRowSize);
+    }
+  }
+}
+
+/**
+ * @brief Read the float buffer of an image file, limited to the requested region and resolution
+ */
+void readInputBuffer(const std::string& path, const ImageReadOptions& imageReadOptions, oiio::ImageBuf& inBuf)
+{
+  const oiio::ImageSpec configSpec = getReadConfigSpec(imageReadOptions);
+
+  if(!imageReadOptions.subROI.defined() && imageReadOptions.downscale <= 1)
+  {
+    oiio::ImageBuf fileBuf(path, 0, 0, NULL, &configSpec);
+
+    fileBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+
+    if(!fileBuf.initialized())
+      throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+    inBuf.swap(fileBuf);
+    return;
+  }
+
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+
+  if(!in)
     throw std::runtime_error("Cannot find/open image file '" + path + "'.");
 
+  const oiio::ImageSpec fullSpec = in->spec();
+
+  // requested region in pixel coordinates of the full resolution image
+  const oiio::ROI roi = getReadRegion(path, fullSpec, imageReadOptions);
+
+  const int downscale = std::max(1, imageReadOptions.downscale);
+  const int outWidth = std::max(1, roi.width() / downscale);
+  const int outHeight = std::max(1, roi.height() / downscale);
+
+  // finest resolution level at least as large as the requested output
+  int miplevel = 0;
+  while(in->seek_subimage(0, miplevel + 1) &&
+        in->spec().width * downscale >= fullSpec.width &&
+        in->spec().height * downscale >= fullSpec.height)
+  {
+    ++miplevel;
+  }
+  if(!in->seek_subimage(0, miplevel))
+    throw std::runtime_error("Can't read image file '" + path + "': " + in->geterror());
+
+  // requested region in pixel coordinates of the resolution level
+  const oiio::ImageSpec& levelSpec = in->spec();
+  const double scaleX = levelSpec.width / double(fullSpec.width);
+  const double scaleY = levelSpec.height / double(fullSpec.height);
+  oiio::ROI levelROI;
+  levelROI.xbegin = levelSpec.x + int(std::floor((roi.xbegin - fullSpec.x) * scaleX));
+  levelROI.xend = levelSpec.x + std::min(levelSpec.width, int(std::ceil((roi.xend - fullSpec.x) * scaleX)));
+  levelROI.ybegin = levelSpec.y + int(std::floor((roi.ybegin - fullSpec.y) * scaleY));
+  levelROI.yend = levelSpec.y + std::min(levelSpec.height, int(std::ceil((roi.yend - fullSpec.y) * scaleY)));
+
+  ALICEVISION_LOG_TRACE("Read region [" << roi.xbegin << ", " << roi.xend << "]x[" << roi.ybegin << ", " << roi.yend << "] of image " << path
+                        << " (resolution level " << miplevel << ", output size " << outWidth << "x" << outHeight << ").");
+
+  readInputRegion(*in, path, miplevel, levelROI, inBuf);
+  in->close();
+
+  if(inBuf.spec().width != outWidth || inBuf.spec().height != outHeight)
+  {
+    oiio::ImageBuf resizedBuf;
+    oiio::ImageBufAlgo::resize(resizedBuf, inBuf, "", 0, oiio::ROI(0, outWidth, 0, outHeight, 0, 1, 0, inBuf.spec().nchannels));
+    resizedBuf.specmod().extra_attribs = inBuf.spec().extra_attribs;
+    inBuf.swap(resizedBuf);
+  }
+}
+
+/**
+ * @brief Convert the float buffer read from an image file into the requested color space and channels
+ */
+template<typename T>
+void convertInputBuffer(const std::string& path,
+                        oiio::TypeDesc format,
+                        int nchannels,
+                        const ImageReadOptions& imageReadOptions,
+                        oiio::ImageBuf& inBuf,
+                        Image<T>& image)
+{
   // check picture channels number
   if(inBuf.spec().nchannels != 1 && inBuf.spec().nchannels < 3)
     throw std::runtime_error("Can't load channels of image file '" + path + "'.");
@@ -356,6 +502,64 @@ void readImage(const std::string& path,
   }
 }
 
+template<typename T>
+void readImage(const std::string& path,
+               oiio::TypeDesc format,
+               int nchannels,
+               Image<T>& image,
+               const ImageReadOptions & imageReadOptions)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+
+  oiio::ImageBuf inBuf;
+  readInputBuffer(path, imageReadOptions, inBuf);
+
+  convertInputBuffer(path, format, nchannels, imageReadOptions, inBuf, image);
+}
+
+template<typename T>
+void readImageStrips(const std::string& path,
+                     oiio::TypeDesc format,
+                     int nchannels,
+                     int stripHeight,
+                     const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<T>&, int)>& processStrip)
+{
+  // check requested channels number
+  assert(nchannels == 1 || nchannels >= 3);
+
+  if(imageReadOptions.downscale > 1)
+    throw std::runtime_error("Downscale is not supported when reading image file '" + path + "' by strips.");
+
+  const oiio::ImageSpec configSpec = getReadConfigSpec(imageReadOptions);
+  std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+
+  if(!in)
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  const oiio::ImageSpec& spec = in->spec();
+
+  const oiio::ROI roi = getReadRegion(path, spec, imageReadOptions);
+
+  // strips are aligned on the tiles rows to read each tile once
+  if(spec.tile_height > 0)
+    stripHeight = std::max(1, stripHeight / spec.tile_height) * spec.tile_height;
+  stripHeight = std::max(1, stripHeight);
+
+  oiio::ImageBuf inBuf;
+  Image<T> strip;
+  for(int y = roi.ybegin; y < roi.yend; y += stripHeight)
+  {
+    const oiio::ROI stripROI(roi.xbegin, roi.xend, y, std::min(y + stripHeight, roi.yend));
+    readInputRegion(*in, path, 0, stripROI, inBuf);
+    convertInputBuffer(path, format, nchannels, imageReadOptions, inBuf, strip);
+    processStrip(strip, y - roi.ybegin);
+  }
+
+  in->close();
+}
+
 template<typename T>
 void readImageNoFloat(const std::string& path,
                oiio::TypeDesc format,
@@ -553,6 +757,24 @@ void readImage(const std::string& path, Image<unsigned char>& image, const Image
   readImage(path, oiio::TypeDesc::UINT8, 1, image, imageReadOptions);
 }
 
+void readImageStrips(const std::string& path, int stripHeight, const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<float>&, int)>& processStrip)
+{
+  readImageStrips(path, oiio::TypeDesc::FLOAT, 1, stripHeight, imageReadOptions, processStrip);
+}
+
+void readImageStrips(const std::string& path, int stripHeight, const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<RGBAfColor>&, int)>& processStrip)
+{
+  readImageStrips(path, oiio::TypeDesc::FLOAT, 4, stripHeight, imageReadOptions, processStrip);
+}
+
+void readImageStrips(const std::string& path, int stripHeight, const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<RGBfColor>&, int)>& processStrip)
+{
+  readImageStrips(path, oiio::TypeDesc::FLOAT, 3, stripHeight, imageReadOptions, processStrip);
+}
+
 void readImageDirect(const std::string& path, Image<unsigned char>& image)
 {
   readImageNoFloat(path, oiio::TypeDesc::UINT8, image);
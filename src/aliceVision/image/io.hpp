@@ -14,6 +14,7 @@
 #include <OpenImageIO/paramlist.h>
 #include <OpenImageIO/imagebuf.h>
 
+#include <functional>
 #include <string>
 
 namespace oiio = OIIO;
@@ -58,7 +59,12 @@ struct ImageReadOptions
 
   //ROI for this image.
   //If the image contains an roi, this is the roi INSIDE the roi.
+  //Only the tiles or scanlines covering this region are read from the file.
   oiio::ROI subROI;
+
+  //Downscale factor applied while reading (the output size is the region size divided by this factor).
+  //The finest reduced-resolution level of the file (MIP-mapped EXR or TIFF) which is large enough is read and resized.
+  int downscale = 1;
 };
 
 
@@ -188,6 +194,20 @@ void readImage(const std::string& path, Image<RGBAColor>& image, const ImageRead
 void readImage(const std::string& path, Image<RGBfColor>& image, const ImageReadOptions & imageReadOptions);
 void readImage(const std::string& path, Image<RGBColor>& image, const ImageReadOptions & imageReadOptions);
 
+/**
+ * @brief read an image with a given path by horizontal strips, without loading the whole image in memory
+ * @param[in] path The given path to the image
+ * @param[in] stripHeight The number of rows of each strip
+ * @param[in] imageReadOptions The read options, the subROI limits the strips (the downscale is not supported)
+ * @param[in] processStrip Function called on each strip, in order, with the strip image and its first row in the read region
+ */
+void readImageStrips(const std::string& path, int stripHeight, const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<float>&, int)>& processStrip);
+void readImageStrips(const std::string& path, int stripHeight, const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<RGBAfColor>&, int)>& processStrip);
+void readImageStrips(const std::string& path, int stripHeight, const ImageReadOptions& imageReadOptions,
+                     const std::function<void(const Image<RGBfColor>&, int)>& processStrip);
+
 /**
  * @brief read an image with a given path and buffer without any processing such as color conversion
  * @param[in] path The given path to the image
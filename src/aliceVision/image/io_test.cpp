@@ -13,8 +13,12 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
 
+#include <OpenImageIO/imageio.h>
+
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -258,3 +262,133 @@ BOOST_AUTO_TEST_CASE(read_write_from_grayscale_to_rgb) {
     remove(filename.c_str());
   }
 }
+
+BOOST_AUTO_TEST_CASE(read_write_region) {
+  const int width = 37;
+  const int height = 23;
+  Image<float> image(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      image(y, x) = float((x + y * width) % 64) / 4.0f; // exact in half float
+
+  for(const std::string extension : {"tiff", "exr"})
+  {
+    const std::string filename = "test_write_region." + extension;
+    BOOST_CHECK_NO_THROW(writeImage(filename, image, image::EImageColorSpace::NO_CONVERSION));
+
+    // region of interest
+    ImageReadOptions regionOptions(image::EImageColorSpace::NO_CONVERSION);
+    regionOptions.subROI = oiio::ROI(5, 30, 3, 20);
+    Image<float> region;
+    BOOST_CHECK_NO_THROW(readImage(filename, region, regionOptions));
+    BOOST_CHECK_EQUAL(region.Width(), 25);
+    BOOST_CHECK_EQUAL(region.Height(), 17);
+    for(int y = 0; y < region.Height(); ++y)
+      for(int x = 0; x < region.Width(); ++x)
+        BOOST_CHECK_EQUAL(region(y, x), image(y + 3, x + 5));
+
+    // strips of the region
+    int nbRows = 0;
+    BOOST_CHECK_NO_THROW(readImageStrips(filename, 4, regionOptions,
+      std::function<void(const Image<float>&, int)>([&](const Image<float>& strip, int y0) {
+        BOOST_CHECK_EQUAL(strip.Width(), 25);
+        BOOST_CHECK_EQUAL(y0, nbRows);
+        for(int y = 0; y < strip.Height(); ++y)
+          for(int x = 0; x < strip.Width(); ++x)
+            BOOST_CHECK_EQUAL(strip(y, x), region(y0 + y, x));
+        nbRows += strip.Height();
+      })));
+    BOOST_CHECK_EQUAL(nbRows, region.Height());
+
+    // reduced resolution
+    ImageReadOptions downscaleOptions(image::EImageColorSpace::NO_CONVERSION);
+    downscaleOptions.downscale = 2;
+    Image<float> downscaled;
+    BOOST_CHECK_NO_THROW(readImage(filename, downscaled, downscaleOptions));
+    BOOST_CHECK_EQUAL(downscaled.Width(), width / 2);
+    BOOST_CHECK_EQUAL(downscaled.Height(), height / 2);
+
+    remove(filename.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_write_region_tiled_mipmap) {
+  // tiled and MIP-mapped EXR, the tile size does not divide the image size
+  const int width = 38;
+  const int height = 24;
+  const int tileSize = 7;
+  const auto levelValue = [](int level, int x, int y) { return float((x + 3 * y + 17 * level) % 64) / 4.0f; };
+
+  std::vector<Image<float>> levels;
+  for(int w = width, h = height; ; w = std::max(1, w / 2), h = std::max(1, h / 2))
+  {
+    Image<float> level(w, h);
+    for(int y = 0; y < h; ++y)
+      for(int x = 0; x < w; ++x)
+        level(y, x) = levelValue(int(levels.size()), x, y);
+    levels.push_back(level);
+    if(w == 1 && h == 1)
+      break;
+  }
+
+  const std::string filename = "test_write_region_tiled.exr";
+  {
+    std::unique_ptr<oiio::ImageOutput> out(oiio::ImageOutput::create(filename));
+    BOOST_REQUIRE(out);
+    BOOST_REQUIRE(out->supports("tiles") && out->supports("mipmap"));
+    for(std::size_t l = 0; l < levels.size(); ++l)
+    {
+      oiio::ImageSpec spec(levels[l].Width(), levels[l].Height(), 1, oiio::TypeDesc::FLOAT);
+      spec.tile_width = tileSize;
+      spec.tile_height = tileSize;
+      BOOST_REQUIRE(out->open(filename, spec, (l == 0) ? oiio::ImageOutput::Create : oiio::ImageOutput::AppendMIPLevel));
+      BOOST_REQUIRE(out->write_image(oiio::TypeDesc::FLOAT, levels[l].data()));
+    }
+    out->close();
+  }
+
+  Image<float> full;
+  BOOST_CHECK_NO_THROW(readImage(filename, full, image::EImageColorSpace::NO_CONVERSION));
+  BOOST_REQUIRE_EQUAL(full.Width(), width);
+  BOOST_REQUIRE_EQUAL(full.Height(), height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      BOOST_CHECK_EQUAL(full(y, x), levels[0](y, x));
+
+  // regions not aligned on the tiles grid, inside a tile and across several tiles
+  for(const oiio::ROI& roi : {oiio::ROI(8, 13, 9, 12), oiio::ROI(3, 37, 5, 22)})
+  {
+    ImageReadOptions regionOptions(image::EImageColorSpace::NO_CONVERSION);
+    regionOptions.subROI = roi;
+    Image<float> region;
+    BOOST_CHECK_NO_THROW(readImage(filename, region, regionOptions));
+    BOOST_REQUIRE_EQUAL(region.Width(), roi.width());
+    BOOST_REQUIRE_EQUAL(region.Height(), roi.height());
+    for(int y = 0; y < region.Height(); ++y)
+      for(int x = 0; x < region.Width(); ++x)
+        BOOST_CHECK_EQUAL(region(y, x), full(y + roi.ybegin, x + roi.xbegin));
+  }
+
+  // the first MIP level is read without resampling
+  ImageReadOptions downscaleOptions(image::EImageColorSpace::NO_CONVERSION);
+  downscaleOptions.downscale = 2;
+  Image<float> downscaled;
+  BOOST_CHECK_NO_THROW(readImage(filename, downscaled, downscaleOptions));
+  BOOST_REQUIRE_EQUAL(downscaled.Width(), levels[1].Width());
+  BOOST_REQUIRE_EQUAL(downscaled.Height(), levels[1].Height());
+  for(int y = 0; y < downscaled.Height(); ++y)
+    for(int x = 0; x < downscaled.Width(); ++x)
+      BOOST_CHECK_EQUAL(downscaled(y, x), levels[1](y, x));
+
+  // unaligned region of the first MIP level
+  downscaleOptions.subROI = oiio::ROI(4, 36, 2, 22);
+  Image<float> downscaledRegion;
+  BOOST_CHECK_NO_THROW(readImage(filename, downscaledRegion, downscaleOptions));
+  BOOST_REQUIRE_EQUAL(downscaledRegion.Width(), 16);
+  BOOST_REQUIRE_EQUAL(downscaledRegion.Height(), 10);
+  for(int y = 0; y < downscaledRegion.Height(); ++y)
+    for(int x = 0; x < downscaledRegion.Width(); ++x)
+      BOOST_CHECK_EQUAL(downscaledRegion(y, x), downscaled(y + 1, x + 2));
+
+  remove(filename.c_str());
+}
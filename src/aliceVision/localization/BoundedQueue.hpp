@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <assert.h>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief This class implements a blocking queue with a given fixed size, used to pass
+ * elements between threads. Unlike BoundedBuffer, no element is ever dropped: pushing
+ * into a full queue waits until an element is popped.
+ * Once the queue is closed, the remaining elements can still be popped.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+
+  /**
+   * @brief Build a bounded queue of the given size.
+   * @param[in] maxSize The maximum number of elements in the queue.
+   */
+  explicit BoundedQueue(std::size_t maxSize) : _maxSize(maxSize)
+  {
+    assert(_maxSize > 0);
+  }
+
+  /**
+   * @brief Add an element at the end of the queue, wait while the queue is full.
+   * @param[in] element The element to add.
+   * @return false if the queue is closed, the element is not added.
+   */
+  bool push(T element)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]() { return _closed || _queue.size() < _maxSize; });
+    if(_closed)
+      return false;
+    _queue.push_back(std::move(element));
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the first element of the queue, wait while the queue is empty.
+   * @param[out] element The removed element.
+   * @return false if the queue is closed and empty.
+   */
+  bool pop(T& element)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]() { return _closed || !_queue.empty(); });
+    if(_queue.empty())
+      return false;
+    element = std::move(_queue.front());
+    _queue.pop_front();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Close the queue: the next pushes fail and the waiting threads are woken up.
+   */
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _closed = true;
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+  }
+
+private:
+  std::deque<T> _queue;
+  /// The fixed maximum size for the queue
+  std::size_t _maxSize;
+  bool _closed = false;
+
+  std::mutex _mutex;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+};
+
+}
+}
@@ -0,0 +1,92 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "BoundedQueue.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE BoundedQueue
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision::localization;
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_fifo)
+{
+  BoundedQueue<int> queue(3);
+  for(int i = 0; i < 3; ++i)
+    BOOST_CHECK(queue.push(i));
+
+  int element = -1;
+  for(int i = 0; i < 3; ++i)
+  {
+    BOOST_CHECK(queue.pop(element));
+    BOOST_CHECK_EQUAL(element, i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_close)
+{
+  BoundedQueue<int> queue(2);
+  BOOST_CHECK(queue.push(1));
+  queue.close();
+
+  // no element can be added once the queue is closed
+  BOOST_CHECK(!queue.push(2));
+
+  // the remaining elements can still be popped
+  int element = -1;
+  BOOST_CHECK(queue.pop(element));
+  BOOST_CHECK_EQUAL(element, 1);
+  BOOST_CHECK(!queue.pop(element));
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_producersConsumers)
+{
+  const int nbProducers = 4;
+  const int nbConsumers = 4;
+  const int nbElementsPerProducer = 10000;
+
+  BoundedQueue<int> queue(2);
+  std::atomic<int> nbPoppedElements(0);
+  std::atomic<long long> sumPoppedElements(0);
+
+  std::vector<std::thread> consumers;
+  for(int i = 0; i < nbConsumers; ++i)
+  {
+    consumers.emplace_back([&]()
+    {
+      int element;
+      while(queue.pop(element))
+      {
+        ++nbPoppedElements;
+        sumPoppedElements += element;
+      }
+    });
+  }
+
+  std::vector<std::thread> producers;
+  for(int i = 0; i < nbProducers; ++i)
+  {
+    producers.emplace_back([&]()
+    {
+      for(int element = 0; element < nbElementsPerProducer; ++element)
+        queue.push(element);
+    });
+  }
+
+  for(std::thread& producer : producers)
+    producer.join();
+  queue.close();
+  for(std::thread& consumer : consumers)
+    consumer.join();
+
+  const long long sumPerProducer = static_cast<long long>(nbElementsPerProducer) * (nbElementsPerProducer - 1) / 2;
+  BOOST_CHECK_EQUAL(nbPoppedElements.load(), nbProducers * nbElementsPerProducer);
+  BOOST_CHECK_EQUAL(sumPoppedElements.load(), nbProducers * sumPerProducer);
+}
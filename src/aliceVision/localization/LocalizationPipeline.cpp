@@ -0,0 +1,416 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LocalizationPipeline.hpp"
+#include "BoundedQueue.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace aliceVision {
+namespace localization {
+
+namespace {
+
+/// A frame going through the stages of the pipeline with its scheduling data
+struct PipelineFrame : public LocalizationPipelineFrame
+{
+  std::chrono::steady_clock::time_point startTime;
+  /// set when a stage has thrown, the next stages skip the frame
+  bool failed = false;
+};
+
+using FramePtr = std::unique_ptr<PipelineFrame>;
+using FrameQueue = BoundedQueue<FramePtr>;
+using StageFunction = std::function<void(PipelineFrame& frame, int worker)>;
+
+double elapsedMs(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void processFrame(PipelineFrame& frame, ELocalizationStage stage, int worker, const StageFunction& process)
+{
+  const auto start = std::chrono::steady_clock::now();
+  if(!frame.failed)
+  {
+    try
+    {
+      process(frame, worker);
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Localization of frame " << frame.result.frameId << " failed during the "
+                            << ELocalizationStage_enumToString(stage) << " stage: " << e.what());
+      frame.failed = true;
+    }
+  }
+  frame.result.stageDurations[static_cast<int>(stage)] = elapsedMs(start);
+}
+
+/**
+ * @brief Start the threads of a stage processing the frames in any order.
+ * The output queue is closed once the last worker is done.
+ */
+void startStage(std::vector<std::thread>& threads, int nbWorkers, ELocalizationStage stage,
+                FrameQueue& input, FrameQueue& output, const StageFunction& process)
+{
+  auto nbRunningWorkers = std::make_shared<std::atomic<int>>(nbWorkers);
+  for(int worker = 0; worker < nbWorkers; ++worker)
+  {
+    threads.emplace_back([&input, &output, stage, worker, process, nbRunningWorkers]()
+    {
+      FramePtr frame;
+      while(input.pop(frame))
+      {
+        processFrame(*frame, stage, worker, process);
+        output.push(std::move(frame));
+      }
+      if(--(*nbRunningWorkers) == 0)
+        output.close();
+    });
+  }
+}
+
+/**
+ * @brief Call process on each frame in the frame order.
+ * The frame ids are consecutive from 0, the frames received in advance wait in a map.
+ */
+void forEachFrameInOrder(FrameQueue& input, const std::function<void(FramePtr& frame)>& process)
+{
+  std::map<std::size_t, FramePtr> pendingFrames;
+  std::size_t nextFrameId = 0;
+  FramePtr frame;
+  while(input.pop(frame))
+  {
+    const std::size_t frameId = frame->result.frameId;
+    pendingFrames.emplace(frameId, std::move(frame));
+    auto it = pendingFrames.begin();
+    while(it != pendingFrames.end() && it->first == nextFrameId)
+    {
+      process(it->second);
+      it = pendingFrames.erase(it);
+      ++nextFrameId;
+    }
+  }
+  assert(pendingFrames.empty());
+}
+
+/**
+ * @brief Start the thread of a stage processing the frames in their order.
+ */
+void startOrderedStage(std::vector<std::thread>& threads, ELocalizationStage stage,
+                       FrameQueue& input, FrameQueue& output, const StageFunction& process)
+{
+  threads.emplace_back([&input, &output, stage, process]()
+  {
+    forEachFrameInOrder(input, [&](FramePtr& frame)
+    {
+      processFrame(*frame, stage, 0, process);
+      output.push(std::move(frame));
+    });
+    output.close();
+  });
+}
+
+/**
+ * @brief The stages of the localization of a frame with a VoctreeLocalizer.
+ */
+class VoctreeLocalizationStages : public ILocalizationStages
+{
+public:
+  VoctreeLocalizationStages(VoctreeLocalizer& localizer, const VoctreeLocalizer::Parameters& param)
+    : _localizer(localizer)
+    , _param(param)
+    , _useAllResults(param._algorithm == VoctreeLocalizer::Algorithm::AllResults)
+  {}
+
+  int prepare(int nbThreads) override
+  {
+    // one set of image describers per extraction thread
+    _imageDescribers.resize(1);
+    _imageDescribers.front() = _localizer.createImageDescribers();
+
+    // the CUDA describers share a single static extractor (popSIFT) which is reset by setConfigurationPreset,
+    // so the extraction of the frames is serialized on a single thread when one of them uses CUDA
+    const bool useCuda = std::any_of(_imageDescribers.front().begin(), _imageDescribers.front().end(),
+                                     [](const std::unique_ptr<feature::ImageDescriber>& imageDescriber) { return imageDescriber->useCuda(); });
+    const int nbExtractionThreads = useCuda ? 1 : nbThreads;
+    if(useCuda && nbThreads > 1)
+      ALICEVISION_LOG_INFO("The feature extraction uses CUDA, the extraction stage of the localization pipeline runs on a single thread.");
+
+    _imageDescribers.resize(nbExtractionThreads);
+    for(int worker = 1; worker < nbExtractionThreads; ++worker)
+      _imageDescribers[worker] = _localizer.createImageDescribers();
+
+    return nbExtractionThreads;
+  }
+
+  bool isResectionOrdered() const override
+  {
+    // the frame buffer matching needs the previous frames to be localized
+    return _useAllResults && (_param._nbFrameBufferMatching > 0);
+  }
+
+  void extract(LocalizationPipelineFrame& frame, int worker) override
+  {
+    _localizer.extractRegions(_imageDescribers[worker], frame.imageGrey, &_param, frame.queryRegions, frame.result.imagePath);
+    frame.imageSize = std::make_pair(frame.imageGrey.Width(), frame.imageGrey.Height());
+    frame.imageGrey = image::Image<float>();
+  }
+
+  void query(LocalizationPipelineFrame& frame) override
+  {
+    // FirstBest queries the database and matches the images in the same loop
+    if(!_useAllResults)
+      return;
+    const std::size_t numResults = (_param._numResults == 0) ? _localizer._database.size() : _param._numResults;
+    frame.hasQuery = _localizer.queryDatabase(frame.queryRegions, numResults, frame.matchedImages);
+  }
+
+  void match(LocalizationPipelineFrame& frame) override
+  {
+    if(!_useAllResults)
+    {
+      // FirstBest stops at the first image giving a successful resection, it is done in this stage
+      frame.result.isLocalized = _localizer.localizeFirstBestResult(frame.queryRegions, frame.imageSize, _param,
+                                                                    frame.randomNumberGenerator, frame.result.hasIntrinsics,
+                                                                    frame.result.queryIntrinsics, frame.result.localizationResult,
+                                                                    frame.result.imagePath);
+      return;
+    }
+    if(!frame.hasQuery)
+      return;
+    frame.matchers.reset(new matching::RegionsDatabaseMatcherPerDesc(frame.randomNumberGenerator, _localizer._matcherType, frame.queryRegions));
+    frame.hasAssociations = _localizer.getDatabaseAssociations(*frame.matchers, frame.imageSize, _param,
+                                                               frame.randomNumberGenerator, frame.result.hasIntrinsics,
+                                                               frame.result.queryIntrinsics, frame.matchedImages,
+                                                               frame.occurences, frame.result.imagePath);
+  }
+
+  void resect(LocalizationPipelineFrame& frame) override
+  {
+    if(_useAllResults)
+    {
+      sfm::ImageLocalizerMatchData resectionData;
+      if(frame.hasAssociations)
+      {
+        if(_param._nbFrameBufferMatching > 0)
+          _localizer.getAssociationsFromBuffer(*frame.matchers, frame.imageSize, _param, frame.result.hasIntrinsics,
+                                               frame.result.queryIntrinsics, frame.occurences, frame.randomNumberGenerator);
+        _localizer.getAssociatedPoints(frame.queryRegions, frame.occurences, resectionData.pt2D, resectionData.pt3D, resectionData.vec_descType);
+      }
+      frame.result.isLocalized = _localizer.localizeFromAssociations(frame.queryRegions, frame.imageSize, _param,
+                                                                     frame.randomNumberGenerator, frame.result.hasIntrinsics,
+                                                                     frame.result.queryIntrinsics, frame.occurences, resectionData,
+                                                                     frame.matchedImages, frame.result.localizationResult,
+                                                                     frame.result.imagePath);
+    }
+    // release the memory of the frame before it waits for its emission
+    frame.matchers.reset();
+    frame.queryRegions.clear();
+    frame.occurences.clear();
+  }
+
+private:
+  VoctreeLocalizer& _localizer;
+  const VoctreeLocalizer::Parameters& _param;
+  const bool _useAllResults;
+  std::vector<std::vector<std::unique_ptr<feature::ImageDescriber>>> _imageDescribers;
+};
+
+} // namespace
+
+std::string ELocalizationStage_enumToString(ELocalizationStage stage)
+{
+  switch(stage)
+  {
+    case ELocalizationStage::DECODING:   return "decoding";
+    case ELocalizationStage::EXTRACTION: return "extraction";
+    case ELocalizationStage::QUERY:      return "query";
+    case ELocalizationStage::MATCHING:   return "matching";
+    case ELocalizationStage::RESECTION:  return "resection";
+  }
+  throw std::out_of_range("Invalid ELocalizationStage enum: " + std::to_string(int(stage)));
+}
+
+void LocalizationPipeline::DurationStatistics::add(double duration)
+{
+  ++count;
+  sum += duration;
+  max = std::max(max, duration);
+}
+
+LocalizationPipeline::LocalizationPipeline(VoctreeLocalizer& localizer,
+                                           const VoctreeLocalizer::Parameters& param,
+                                           int nbThreads,
+                                           std::size_t queueSize)
+  : LocalizationPipeline(std::unique_ptr<ILocalizationStages>(new VoctreeLocalizationStages(localizer, param)), nbThreads, queueSize)
+{
+  if(param._algorithm != VoctreeLocalizer::Algorithm::FirstBest &&
+     param._algorithm != VoctreeLocalizer::Algorithm::AllResults)
+    throw std::invalid_argument("The localization pipeline only supports the FirstBest and AllResults algorithms");
+}
+
+LocalizationPipeline::LocalizationPipeline(std::unique_ptr<ILocalizationStages> stages,
+                                           int nbThreads,
+                                           std::size_t queueSize)
+  : _stages(std::move(stages))
+  , _nbThreads(nbThreads > 0 ? nbThreads : std::max(1, static_cast<int>(std::thread::hardware_concurrency())))
+  , _queueSize(std::max(std::size_t(1), queueSize))
+{
+  assert(_stages);
+}
+
+std::size_t LocalizationPipeline::run(const ReadFrameFunction& readFrame,
+                                      const LocalizedFrameCallback& callback,
+                                      std::uint32_t randomSeed)
+{
+  const bool orderedResection = _stages->isResectionOrdered();
+  // the frames waiting in the ordered stages are bounded by the number of frames in the pipeline
+  const std::size_t maxFramesInPipeline = 4 * (_nbThreads + _queueSize);
+
+  _stageStatistics.fill(DurationStatistics());
+  _latencyStatistics = DurationStatistics();
+  const auto runStart = std::chrono::steady_clock::now();
+
+  const int nbExtractionThreads = _stages->prepare(_nbThreads);
+
+  const StageFunction extract = [this](PipelineFrame& frame, int worker) { _stages->extract(frame, worker); };
+  const StageFunction query = [this](PipelineFrame& frame, int) { _stages->query(frame); };
+  const StageFunction match = [this](PipelineFrame& frame, int) { _stages->match(frame); };
+  const StageFunction resect = [this](PipelineFrame& frame, int) { _stages->resect(frame); };
+
+  FrameQueue decodedFrames(_queueSize);
+  FrameQueue extractedFrames(_queueSize);
+  FrameQueue queriedFrames(_queueSize);
+  FrameQueue matchedFrames(_queueSize);
+  FrameQueue localizedFrames(_queueSize);
+
+  std::mutex framesInPipelineMutex;
+  std::condition_variable framesInPipelineCond;
+  std::size_t nbFramesInPipeline = 0;
+
+  std::vector<std::thread> threads;
+  startStage(threads, nbExtractionThreads, ELocalizationStage::EXTRACTION, decodedFrames, extractedFrames, extract);
+  startStage(threads, _nbThreads, ELocalizationStage::QUERY, extractedFrames, queriedFrames, query);
+  startStage(threads, _nbThreads, ELocalizationStage::MATCHING, queriedFrames, matchedFrames, match);
+  if(orderedResection)
+    startOrderedStage(threads, ELocalizationStage::RESECTION, matchedFrames, localizedFrames, resect);
+  else
+    startStage(threads, _nbThreads, ELocalizationStage::RESECTION, matchedFrames, localizedFrames, resect);
+
+  // emit the localized frames in order
+  std::exception_ptr callbackError;
+  threads.emplace_back([&]()
+  {
+    forEachFrameInOrder(localizedFrames, [&](FramePtr& frame)
+    {
+      frame->result.latency = elapsedMs(frame->startTime);
+      for(int stage = 0; stage < nbLocalizationStages; ++stage)
+        _stageStatistics[stage].add(frame->result.stageDurations[stage]);
+      _latencyStatistics.add(frame->result.latency);
+
+      // after an error of the callback, the frames are only drained
+      if(!callbackError)
+      {
+        try
+        {
+          callback(frame->result);
+        }
+        catch(...)
+        {
+          callbackError = std::current_exception();
+        }
+      }
+      frame.reset();
+
+      std::lock_guard<std::mutex> lock(framesInPipelineMutex);
+      --nbFramesInPipeline;
+      framesInPipelineCond.notify_one();
+    });
+  });
+
+  // decode the frames in the calling thread
+  std::size_t nbFrames = 0;
+  std::exception_ptr readError;
+  try
+  {
+    while(true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(framesInPipelineMutex);
+        framesInPipelineCond.wait(lock, [&]() { return nbFramesInPipeline < maxFramesInPipeline; });
+      }
+
+      FramePtr frame(new PipelineFrame());
+      frame->startTime = std::chrono::steady_clock::now();
+      if(!readFrame(frame->imageGrey, frame->result.queryIntrinsics, frame->result.imagePath, frame->result.hasIntrinsics))
+        break;
+      frame->result.stageDurations[static_cast<int>(ELocalizationStage::DECODING)] = elapsedMs(frame->startTime);
+      frame->result.frameId = nbFrames;
+      frame->randomNumberGenerator.seed(randomSeed + static_cast<std::uint32_t>(nbFrames));
+      ++nbFrames;
+
+      {
+        std::lock_guard<std::mutex> lock(framesInPipelineMutex);
+        ++nbFramesInPipeline;
+      }
+      decodedFrames.push(std::move(frame));
+    }
+  }
+  catch(...)
+  {
+    readError = std::current_exception();
+  }
+
+  decodedFrames.close();
+  for(std::thread& thread : threads)
+    thread.join();
+
+  _runDuration = elapsedMs(runStart);
+
+  if(readError)
+    std::rethrow_exception(readError);
+  if(callbackError)
+    std::rethrow_exception(callbackError);
+
+  return nbFrames;
+}
+
+void LocalizationPipeline::logStatistics() const
+{
+  std::ostringstream stageStatistics;
+  for(int stage = 0; stage < nbLocalizationStages; ++stage)
+  {
+    stageStatistics << "\t- " << ELocalizationStage_enumToString(static_cast<ELocalizationStage>(stage)) << ": "
+                    << _stageStatistics[stage].mean() << " ms (max " << _stageStatistics[stage].max << " ms)\n";
+  }
+
+  const double framesPerSecond = (_runDuration > 0.0) ? 1000.0 * _latencyStatistics.count / _runDuration : 0.0;
+
+  ALICEVISION_LOG_INFO("Localization pipeline statistics (" << _nbThreads << " threads per stage):\n"
+                       "\t- frames: " << _latencyStatistics.count << " in " << _runDuration / 1000.0 << " s (" << framesPerSecond << " fps)\n"
+                       "Mean processing time per stage:\n"
+                       << stageStatistics.str() <<
+                       "Latency: " << _latencyStatistics.mean() << " ms (max " << _latencyStatistics.max << " ms)");
+}
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,220 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/matching/RegionsMatcher.hpp>
+#include <aliceVision/voctree/Database.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Stages of the localization pipeline.
+ */
+enum class ELocalizationStage : int
+{
+  DECODING = 0,
+  EXTRACTION,
+  QUERY,
+  MATCHING,
+  RESECTION
+};
+
+/// Number of stages of the localization pipeline
+const int nbLocalizationStages = 5;
+
+std::string ELocalizationStage_enumToString(ELocalizationStage stage);
+
+/**
+ * @brief A frame localized by the LocalizationPipeline.
+ */
+struct LocalizedFrame
+{
+  /// index of the frame in the sequence
+  std::size_t frameId = 0;
+  /// complete path to the frame image
+  std::string imagePath;
+  /// whether the intrinsics of the frame are known
+  bool hasIntrinsics = false;
+  /// intrinsics of the frame, refined or estimated by the localization
+  camera::PinholeRadialK3 queryIntrinsics;
+  /// the localization result containing the pose and the associations
+  LocalizationResult localizationResult;
+  /// whether the frame has been successfully localized
+  bool isLocalized = false;
+  /// processing time of each stage in ms, indexed by ELocalizationStage
+  std::array<double, nbLocalizationStages> stageDurations{};
+  /// time in ms between the beginning of the decoding of the frame and its emission
+  double latency = 0.0;
+};
+
+/**
+ * @brief A frame going through the stages of the LocalizationPipeline.
+ */
+struct LocalizationPipelineFrame
+{
+  /// the output of the pipeline for this frame
+  LocalizedFrame result;
+  /// the decoded image, released after the extraction
+  image::Image<float> imageGrey;
+  /// the size of the image
+  std::pair<std::size_t, std::size_t> imageSize;
+  /// the random generator of the frame, seeded from its id
+  std::mt19937 randomNumberGenerator;
+
+  feature::MapRegionsPerDesc queryRegions;
+  /// whether the query image has features of the vocabulary tree describer type
+  bool hasQuery = false;
+  std::vector<voctree::DocMatch> matchedImages;
+  std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> matchers;
+  OccurenceMap occurences;
+  /// whether the 2D-3D associations have been collected
+  bool hasAssociations = false;
+};
+
+/**
+ * @brief The processing of the frames by the stages of the LocalizationPipeline.
+ * The extraction, query and matching stages may process several frames concurrently,
+ * the resection stage also does unless isResectionOrdered() is true.
+ */
+class ILocalizationStages
+{
+public:
+  virtual ~ILocalizationStages() = default;
+
+  /**
+   * @brief Prepare a run of the pipeline.
+   * @param[in] nbThreads The number of threads of each stage.
+   * @return the number of threads of the extraction stage
+   */
+  virtual int prepare(int nbThreads) = 0;
+
+  /**
+   * @brief Whether the resection stage must process the frames one by one in their order.
+   */
+  virtual bool isResectionOrdered() const = 0;
+
+  /**
+   * @brief Extract the features of a frame.
+   * @param[in,out] frame The frame.
+   * @param[in] worker The index of the extraction thread, lower than the value returned by prepare().
+   */
+  virtual void extract(LocalizationPipelineFrame& frame, int worker) = 0;
+
+  virtual void query(LocalizationPipelineFrame& frame) = 0;
+  virtual void match(LocalizationPipelineFrame& frame) = 0;
+  virtual void resect(LocalizationPipelineFrame& frame) = 0;
+};
+
+/**
+ * @brief Localize the frames of a sequence with a VoctreeLocalizer.
+ *
+ * The decoding, the feature extraction, the database query, the matching and the resection
+ * run as concurrent stages connected by bounded queues, and several frames are processed
+ * in parallel by each stage. When the frame buffer matching is enabled, each frame is matched
+ * with the previously localized ones, so the resection stage processes the frames in their order.
+ * The localized frames are always emitted in their order.
+ * With the AllResults algorithm and the default frame buffer matching, the resection stage
+ * therefore runs on a single thread.
+ * When one of the image describers uses CUDA, the extraction stage runs on a single thread
+ * as the GPU extractor is shared.
+ */
+class LocalizationPipeline
+{
+public:
+  /**
+   * @brief Read the next frame of the sequence.
+   * @param[out] imageGrey The greyscale image of the frame.
+   * @param[out] queryIntrinsics The intrinsics of the frame, if they are known.
+   * @param[out] imagePath The complete path to the frame image.
+   * @param[out] hasIntrinsics Whether the intrinsics of the frame are known.
+   * @return false at the end of the sequence
+   */
+  using ReadFrameFunction = std::function<bool(image::Image<float>& imageGrey,
+                                               camera::PinholeRadialK3& queryIntrinsics,
+                                               std::string& imagePath,
+                                               bool& hasIntrinsics)>;
+
+  using LocalizedFrameCallback = std::function<void(LocalizedFrame& frame)>;
+
+  /**
+   * @brief Build a localization pipeline.
+   * @param[in] localizer The initialized localizer.
+   * @param[in] param The parameters for the localization, only the FirstBest and AllResults algorithms are supported.
+   * @param[in] nbThreads The number of threads of each stage (0 to use the number of cores).
+   * @param[in] queueSize The maximum number of frames waiting between two stages.
+   */
+  LocalizationPipeline(VoctreeLocalizer& localizer,
+                       const VoctreeLocalizer::Parameters& param,
+                       int nbThreads = 0,
+                       std::size_t queueSize = 2);
+
+  /**
+   * @brief Build a localization pipeline running the given stages.
+   * @param[in] stages The processing of each stage.
+   * @param[in] nbThreads The number of threads of each stage (0 to use the number of cores).
+   * @param[in] queueSize The maximum number of frames waiting between two stages.
+   */
+  explicit LocalizationPipeline(std::unique_ptr<ILocalizationStages> stages,
+                                int nbThreads = 0,
+                                std::size_t queueSize = 2);
+
+  /**
+   * @brief Localize all the frames of a sequence.
+   * @param[in] readFrame Reads the frames, it is only called from the calling thread.
+   * @param[in] callback Called on each localized frame in the frame order, from a single thread.
+   * @param[in] randomSeed The random generator of each frame is seeded with randomSeed + frameId,
+   * so that the results do not depend on the scheduling of the frames.
+   * @return the number of frames of the sequence
+   */
+  std::size_t run(const ReadFrameFunction& readFrame,
+                  const LocalizedFrameCallback& callback,
+                  std::uint32_t randomSeed);
+
+  /**
+   * @brief Log the mean and the maximum processing time of each stage and the latency
+   * of the frames of the last run.
+   */
+  void logStatistics() const;
+
+private:
+  struct DurationStatistics
+  {
+    std::size_t count = 0;
+    double sum = 0.0;
+    double max = 0.0;
+
+    void add(double duration);
+    double mean() const { return count == 0 ? 0.0 : sum / count; }
+  };
+
+  std::unique_ptr<ILocalizationStages> _stages;
+  int _nbThreads;
+  std::size_t _queueSize;
+
+  std::array<DurationStatistics, nbLocalizationStages> _stageStatistics;
+  DurationStatistics _latencyStatistics;
+  /// duration of the last run in ms
+  double _runDuration = 0.0;
+};
+
+} // namespace localization
+} // namespace aliceVision
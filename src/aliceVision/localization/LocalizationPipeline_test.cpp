@@ -0,0 +1,232 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LocalizationPipeline.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE LocalizationPipeline
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::localization;
+
+namespace {
+
+const std::size_t nbFrames = 40;
+const std::uint32_t randomSeed = 42;
+
+/**
+ * @brief Mocked stages: each stage waits for a frame dependent time, so that the frames
+ * overtake each other, and the pose of a frame is built from draws of its random generator
+ * in the matching and the resection stages, the resection also uses the previous localized frame
+ * like the frame buffer matching.
+ * The Boost.Test checks are not thread safe, the errors of the scheduling are recorded
+ * and checked after the run.
+ */
+class MockLocalizationStages : public ILocalizationStages
+{
+public:
+  explicit MockLocalizationStages(bool orderedResection, std::size_t failingFrameId = nbFrames)
+    : _orderedResection(orderedResection)
+    , _failingFrameId(failingFrameId)
+  {}
+
+  int prepare(int nbThreads) override
+  {
+    _nbExtractionThreads = nbThreads;
+    return nbThreads;
+  }
+
+  bool isResectionOrdered() const override { return _orderedResection; }
+
+  void extract(LocalizationPipelineFrame& frame, int worker) override
+  {
+    if(worker < 0 || worker >= _nbExtractionThreads)
+      invalidWorker = true;
+    wait(frame);
+    frame.imageSize = std::make_pair(frame.imageGrey.Width(), frame.imageGrey.Height());
+    frame.imageGrey = image::Image<float>();
+  }
+
+  void query(LocalizationPipelineFrame& frame) override
+  {
+    wait(frame);
+    if(frame.result.frameId == _failingFrameId)
+      throw std::runtime_error("query failure");
+    frame.hasQuery = true;
+  }
+
+  void match(LocalizationPipelineFrame& frame) override
+  {
+    wait(frame);
+    frame.hasAssociations = frame.hasQuery;
+    frame.result.imagePath += "_" + std::to_string(frame.randomNumberGenerator());
+  }
+
+  void resect(LocalizationPipelineFrame& frame) override
+  {
+    wait(frame);
+    const std::size_t frameId = frame.result.frameId;
+
+    double previousCenter = 0.0;
+    if(_orderedResection)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      // all the previous frames must have been resected
+      if(_resectedCenters.size() != frameId)
+        outOfOrderResection = true;
+      if(frameId > 0 && !_resectedCenters.empty())
+        previousCenter = _resectedCenters.back();
+    }
+
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    const double center = distribution(frame.randomNumberGenerator) + previousCenter;
+    const geometry::Pose3 pose(Mat3::Identity(), Vec3(center, double(frame.imageSize.first), double(frameId)));
+    frame.result.localizationResult = LocalizationResult(sfm::ImageLocalizerMatchData(), {}, pose,
+                                                         frame.result.queryIntrinsics, frame.matchedImages);
+    frame.result.isLocalized = frame.hasAssociations;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _resectedCenters.push_back(center);
+  }
+
+  std::atomic<bool> invalidWorker{false};
+  std::atomic<bool> outOfOrderResection{false};
+
+private:
+  static void wait(const LocalizationPipelineFrame& frame)
+  {
+    std::this_thread::sleep_for(std::chrono::microseconds(100 * ((frame.result.frameId * 7) % 5)));
+  }
+
+  const bool _orderedResection;
+  const std::size_t _failingFrameId;
+  int _nbExtractionThreads = 0;
+  std::mutex _mutex;
+  std::vector<double> _resectedCenters;
+};
+
+/// Run the mocked stages on each frame one by one, as the sequential localization
+std::vector<LocalizedFrame> localizeSequentially(bool orderedResection, std::size_t failingFrameId = nbFrames)
+{
+  MockLocalizationStages stages(orderedResection, failingFrameId);
+  stages.prepare(1);
+
+  std::vector<LocalizedFrame> frames;
+  for(std::size_t frameId = 0; frameId < nbFrames; ++frameId)
+  {
+    LocalizationPipelineFrame frame;
+    frame.result.frameId = frameId;
+    frame.result.imagePath = "frame" + std::to_string(frameId);
+    frame.imageGrey.resize(8 + frameId, 4);
+    frame.randomNumberGenerator.seed(randomSeed + static_cast<std::uint32_t>(frameId));
+    try
+    {
+      stages.extract(frame, 0);
+      stages.query(frame);
+      stages.match(frame);
+      stages.resect(frame);
+    }
+    catch(const std::exception&)
+    {
+      // the pipeline skips the next stages of a failing frame
+      frame.result.isLocalized = false;
+    }
+    frames.push_back(frame.result);
+  }
+  return frames;
+}
+
+std::vector<LocalizedFrame> localizeWithPipeline(bool orderedResection, int nbThreads, std::size_t failingFrameId = nbFrames)
+{
+  MockLocalizationStages* stages = new MockLocalizationStages(orderedResection, failingFrameId);
+  LocalizationPipeline pipeline(std::unique_ptr<ILocalizationStages>(stages), nbThreads);
+
+  std::size_t frameId = 0;
+  const auto readFrame = [&](image::Image<float>& imageGrey, camera::PinholeRadialK3&, std::string& imagePath, bool& hasIntrinsics)
+  {
+    if(frameId == nbFrames)
+      return false;
+    imageGrey.resize(8 + frameId, 4);
+    imagePath = "frame" + std::to_string(frameId);
+    hasIntrinsics = false;
+    ++frameId;
+    return true;
+  };
+
+  std::vector<LocalizedFrame> frames;
+  const std::size_t nbReadFrames = pipeline.run(readFrame, [&](LocalizedFrame& frame) { frames.push_back(frame); }, randomSeed);
+  BOOST_CHECK_EQUAL(nbReadFrames, nbFrames);
+  BOOST_CHECK(!stages->invalidWorker);
+  BOOST_CHECK(!stages->outOfOrderResection);
+  return frames;
+}
+
+void checkSameFrames(const std::vector<LocalizedFrame>& frames, const std::vector<LocalizedFrame>& expectedFrames)
+{
+  BOOST_REQUIRE_EQUAL(frames.size(), expectedFrames.size());
+  for(std::size_t i = 0; i < frames.size(); ++i)
+  {
+    // the frames are emitted in their order
+    BOOST_CHECK_EQUAL(frames[i].frameId, i);
+    BOOST_CHECK_EQUAL(frames[i].imagePath, expectedFrames[i].imagePath);
+    BOOST_CHECK_EQUAL(frames[i].isLocalized, expectedFrames[i].isLocalized);
+    if(frames[i].isLocalized && expectedFrames[i].isLocalized)
+    {
+      // the same per-frame seeds give the same poses
+      BOOST_CHECK_EQUAL(frames[i].localizationResult.getPose().center(), expectedFrames[i].localizationResult.getPose().center());
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LocalizationPipeline_unorderedResection)
+{
+  const std::vector<LocalizedFrame> expectedFrames = localizeSequentially(false);
+  for(int nbThreads : {1, 2, 4})
+    checkSameFrames(localizeWithPipeline(false, nbThreads), expectedFrames);
+}
+
+BOOST_AUTO_TEST_CASE(LocalizationPipeline_orderedResection)
+{
+  // the mocked resection checks that the frames are resected in their order
+  const std::vector<LocalizedFrame> expectedFrames = localizeSequentially(true);
+  for(int nbThreads : {1, 2, 4})
+    checkSameFrames(localizeWithPipeline(true, nbThreads), expectedFrames);
+}
+
+BOOST_AUTO_TEST_CASE(LocalizationPipeline_failingFrame)
+{
+  const std::size_t failingFrameId = 5;
+  const std::vector<LocalizedFrame> frames = localizeWithPipeline(false, 2, failingFrameId);
+  BOOST_REQUIRE_EQUAL(frames.size(), nbFrames);
+  for(std::size_t i = 0; i < frames.size(); ++i)
+    BOOST_CHECK_EQUAL(frames[i].isLocalized, i != failingFrameId);
+}
+
+BOOST_AUTO_TEST_CASE(LocalizationPipeline_callbackError)
+{
+  LocalizationPipeline pipeline(std::unique_ptr<ILocalizationStages>(new MockLocalizationStages(true)), 2);
+
+  std::size_t frameId = 0;
+  const auto readFrame = [&](image::Image<float>& imageGrey, camera::PinholeRadialK3&, std::string&, bool&)
+  {
+    imageGrey.resize(8, 4);
+    return frameId++ < nbFrames;
+  };
+
+  // the error of the callback is rethrown once the pipeline is stopped
+  BOOST_CHECK_THROW(pipeline.run(readFrame, [](LocalizedFrame&) { throw std::runtime_error("callback failure"); }, randomSeed),
+                    std::runtime_error);
+}
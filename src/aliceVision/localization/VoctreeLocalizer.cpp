@@ -196,12 +196,43 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                                 const std::string& imagePath /* = std::string() */)
 {
   // A. extract descriptors and features from image
-  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
   feature::MapRegionsPerDesc queryRegionsPerDesc;
+  extractRegions(_imageDescribers, imageGrey, param, queryRegionsPerDesc, imagePath);
 
-  image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
+  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
 
+  return localize(queryRegionsPerDesc,
+                  queryImageSize, 
+                  param,
+                  randomNumberGenerator,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  localizationResult,
+                  imagePath);
+}
+
+std::vector<std::unique_ptr<feature::ImageDescriber>> VoctreeLocalizer::createImageDescribers() const
+{
+  std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
+  imageDescribers.reserve(_imageDescribers.size());
   for(const auto& imageDescriber : _imageDescribers)
+  {
+    imageDescribers.push_back(feature::createImageDescriber(imageDescriber->getDescriberType()));
+  }
+  return imageDescribers;
+}
+
+void VoctreeLocalizer::extractRegions(const std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers,
+                                      const image::Image<float>& imageGrey,
+                                      const LocalizerParameters *param,
+                                      feature::MapRegionsPerDesc& queryRegionsPerDesc,
+                                      const std::string& imagePath) const
+{
+  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
+
+  image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
+
+  for(const auto& imageDescriber : imageDescribers)
   {
     const auto descType = imageDescriber->getDescriberType();
     auto & queryRegions = queryRegionsPerDesc[descType];
@@ -234,7 +265,7 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
   {
     feature::MapFeaturesPerDesc extractedFeatures;
 
-    for(const auto& imageDescriber : _imageDescribers)
+    for(const auto& imageDescriber : imageDescribers)
     {
       const auto descType = imageDescriber->getDescriberType();
       extractedFeatures[descType] = queryRegionsPerDesc.at(descType)->GetRegionsPositions();
@@ -246,15 +277,6 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                      extractedFeatures,
                      param->_visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
   }
-
-  return localize(queryRegionsPerDesc,
-                  queryImageSize, 
-                  param,
-                  randomNumberGenerator,
-                  useInputIntrinsics,
-                  queryIntrinsics,
-                  localizationResult,
-                  imagePath);
 }
 
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sfm_data,
@@ -642,6 +664,31 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                      matchedImages,
                      imagePath);
 
+  return localizeFromAssociations(queryRegions,
+                                  queryImageSize,
+                                  param,
+                                  randomNumberGenerator,
+                                  useInputIntrinsics,
+                                  queryIntrinsics,
+                                  occurences,
+                                  resectionData,
+                                  matchedImages,
+                                  localizationResult,
+                                  imagePath);
+}
+
+bool VoctreeLocalizer::localizeFromAssociations(const feature::MapRegionsPerDesc &queryRegions,
+                                                const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                                const Parameters &param,
+                                                std::mt19937 & randomNumberGenerator,
+                                                bool useInputIntrinsics,
+                                                camera::PinholeRadialK3 &queryIntrinsics,
+                                                const OccurenceMap &occurences,
+                                                sfm::ImageLocalizerMatchData &resectionData,
+                                                const std::vector<voctree::DocMatch>& matchedImages,
+                                                LocalizationResult &localizationResult,
+                                                const std::string& imagePath)
+{
   const std::size_t numCollectedPts = occurences.size();
   std::vector<IndMatch3D2D> associationIDs;
   associationIDs.reserve(numCollectedPts);
@@ -767,18 +814,50 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   assert(out_descTypes.size() == 0);
 
   // A. Find the (visually) similar images in the database 
+  if(!queryDatabase(queryRegions, (param._numResults==0) ? (_database.size()) : (param._numResults), out_matchedImages))
+    return;
+
+  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+  matching::RegionsDatabaseMatcherPerDesc matchers(randomNumberGenerator, _matcherType, queryRegions);
+
+  // B. and C. match the similar images and recover the 2D-3D associations
+  if(!getDatabaseAssociations(matchers,
+                              imageSize,
+                              param,
+                              randomNumberGenerator,
+                              useInputIntrinsics,
+                              queryIntrinsics,
+                              out_matchedImages,
+                              out_occurences,
+                              imagePath))
+    return;
+
+  if(param._nbFrameBufferMatching > 0)
+  {
+    ALICEVISION_LOG_DEBUG("[matching]\tUsing frameBuffer matching: matching with the past " 
+            << param._nbFrameBufferMatching << " frames" );
+    getAssociationsFromBuffer(matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences, randomNumberGenerator);
+  }
+
+  getAssociatedPoints(queryRegions, out_occurences, out_pt2D, out_pt3D, out_descTypes);
+}
+
+bool VoctreeLocalizer::queryDatabase(const feature::MapRegionsPerDesc & queryRegions,
+                                     std::size_t numResults,
+                                     std::vector<voctree::DocMatch>& out_matchedImages) const
+{
   // pass the descriptors through the vocabulary tree to get the visual words
   // associated to each feature
   ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
   if(queryRegions.count(_voctreeDescType) == 0)
   {
     ALICEVISION_LOG_WARNING("[database]\t No feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
-    return;
+    return false;
   }
   voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
   
   // Request closest images from voctree
-  _database.find(requestImageWords, (param._numResults==0) ? (_database.size()) : (param._numResults) , out_matchedImages);
+  _database.find(requestImageWords, numResults, out_matchedImages);
 
 //  // Debugging log
 //  // for each similar image found print score and number of features
@@ -793,16 +872,26 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
 //            << " features with 3D points");
 //  }
 
-  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
-  matching::RegionsDatabaseMatcherPerDesc matchers(randomNumberGenerator, _matcherType, queryRegions);
+  return true;
+}
+
+bool VoctreeLocalizer::getDatabaseAssociations(matching::RegionsDatabaseMatcherPerDesc & matchers,
+                                               const std::pair<std::size_t, std::size_t> &imageSize,
+                                               const Parameters &param,
+                                               std::mt19937 & randomNumberGenerator,
+                                               bool useInputIntrinsics,
+                                               const camera::PinholeRadialK3 &queryIntrinsics,
+                                               const std::vector<voctree::DocMatch>& matchedImages,
+                                               OccurenceMap & out_occurences,
+                                               const std::string& imagePath) const
+{
+  const feature::MapRegionsPerDesc& queryRegions = matchers.getDatabaseRegionsPerDesc();
 
-  std::map< std::pair<IndexT, IndexT>, std::size_t > repeated;
-  
   // B. for each found similar image, try to find the correspondences between the 
   // query image adn the similar image
   // stop when param._maxResults successful matches have been found
   std::size_t goodMatches = 0;
-  for(const voctree::DocMatch& matchedImage : out_matchedImages)
+  for(const voctree::DocMatch& matchedImage : matchedImages)
   {
     // minimum number of points that allows a reliable 3D reconstruction
     const size_t minNum3DPoints = 5;
@@ -831,7 +920,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     {
       //@fixme maybe better to throw something here
       ALICEVISION_CERR("Only Pinhole cameras are supported!");
-      return;
+      return false;
     }
     const camera::Pinhole *matchedIntrinsics = (const camera::Pinhole*)(matchedIntrinsicsBase);
 
@@ -934,15 +1023,16 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
       break;
     }
   }
-  
-  if(param._nbFrameBufferMatching > 0)
-  {
-    ALICEVISION_LOG_DEBUG("[matching]\tUsing frameBuffer matching: matching with the past " 
-            << param._nbFrameBufferMatching << " frames" );
-    getAssociationsFromBuffer(matchers, imageSize, param, useInputIntrinsics, queryIntrinsics, out_occurences, randomNumberGenerator);
-  }
-  
-  const std::size_t numCollectedPts = out_occurences.size();
+  return true;
+}
+
+void VoctreeLocalizer::getAssociatedPoints(const feature::MapRegionsPerDesc & queryRegions,
+                                           const OccurenceMap & occurences,
+                                           Mat &out_pt2D,
+                                           Mat &out_pt3D,
+                                           std::vector<feature::EImageDescriberType>& out_descTypes) const
+{
+  const std::size_t numCollectedPts = occurences.size();
   
   {
     // just debugging statistics, this block can be safely removed
@@ -950,7 +1040,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     for(std::size_t value = 1; value < numCollectedPts; ++value)
     {
       std::size_t counter = 0;
-      for(const auto &idx : out_occurences)
+      for(const auto &idx : occurences)
       {
         if(idx.second == value)
         {
@@ -970,10 +1060,10 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   out_pt3D = Mat3X(3, numCollectedPts);
   
 
-  out_descTypes.resize(out_occurences.size());
+  out_descTypes.resize(occurences.size());
 
   std::size_t index = 0;
-  for(const auto &idx : out_occurences)
+  for(const auto &idx : occurences)
   {
      // recopy all the points in the matching structure
     const IndexT pt2D_id = idx.first.featId;
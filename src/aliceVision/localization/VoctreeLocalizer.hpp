@@ -154,6 +154,27 @@ public:
                 const std::string& imagePath = std::string()) override;
   
   
+  /**
+   * @brief Create a new set of image describers of the matching describer types.
+   * Each thread extracting the features of query images in parallel needs its own set.
+   * @return the image describers, in the order of the matching describer types
+   */
+  std::vector<std::unique_ptr<feature::ImageDescriber>> createImageDescribers() const;
+
+  /**
+   * @brief Extract the features of a query image.
+   * @param[in] imageDescribers The image describers to use, see createImageDescribers().
+   * @param[in] imageGrey The input greyscale image.
+   * @param[in] param The parameters for the localization.
+   * @param[out] queryRegions The features of the query image for each describer type.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   */
+  void extractRegions(const std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers,
+                      const image::Image<float>& imageGrey,
+                      const LocalizerParameters *param,
+                      feature::MapRegionsPerDesc& queryRegions,
+                      const std::string& imagePath = std::string()) const;
+
   bool localizeRig(const std::vector<image::Image<float>> & vec_imageGrey,
                    const LocalizerParameters *param,
                    std::mt19937 & randomNumberGenerator,
@@ -277,6 +298,102 @@ public:
                           std::vector<voctree::DocMatch>& out_matchedImages,
                           const std::string& imagePath = std::string()) const;
 
+  /**
+   * @brief Retrieve the images of the database which are the most similar to the query image.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] numResults The maximum number of images to retrieve
+   * @param[out] out_matchedImages The retrieved images, sorted by score
+   * @return false if the query image has no feature of the vocabulary tree describer type
+   */
+  bool queryDatabase(const feature::MapRegionsPerDesc & queryRegions,
+                     std::size_t numResults,
+                     std::vector<voctree::DocMatch>& out_matchedImages) const;
+
+  /**
+   * @brief Match the query image with the retrieved database images and collect the 2D-3D associations,
+   * until \p param._maxResults images are successfully matched.
+   *
+   * @param[in] matchers The matchers built on the query image features
+   * @param[in] imageSize The size of the query image
+   * @param[in] param The parameters for the localization
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in] queryIntrinsics Intrinsic parameters of the query camera
+   * @param[in] matchedImages The images retrieved by queryDatabase()
+   * @param[in,out] out_occurences The number of occurrences of each 2D-3D association
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes
+   * @return false if a matched image does not have pinhole intrinsics
+   */
+  bool getDatabaseAssociations(matching::RegionsDatabaseMatcherPerDesc & matchers,
+                               const std::pair<std::size_t, std::size_t> &imageSize,
+                               const Parameters &param,
+                               std::mt19937 & randomNumberGenerator,
+                               bool useInputIntrinsics,
+                               const camera::PinholeRadialK3 &queryIntrinsics,
+                               const std::vector<voctree::DocMatch>& matchedImages,
+                               OccurenceMap & out_occurences,
+                               const std::string& imagePath = std::string()) const;
+
+  /**
+   * @brief Collect the 2D-3D associations with the last localized frames of the frame buffer.
+   * The frame buffer is updated by localizeFromAssociations(), so the frames of a sequence
+   * must go through both methods in their order.
+   */
+  void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
+                                 const std::pair<std::size_t, std::size_t> & imageSize,
+                                 const Parameters &param,
+                                 bool useInputIntrinsics,
+                                 const camera::PinholeRadialK3 &queryIntrinsics,
+                                 OccurenceMap &out_occurences,
+                                 std::mt19937 & randomNumberGenerator,
+                                 const std::string& imagePath = std::string()) const;
+
+  /**
+   * @brief Get the 2D and 3D points of the 2D-3D associations.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] occurences The 2D-3D associations
+   * @param[out] out_pt2D output matrix of 2D points
+   * @param[out] out_pt3D output matrix of 3D points
+   * @param[out] out_descTypes output vector of describerType
+   */
+  void getAssociatedPoints(const feature::MapRegionsPerDesc & queryRegions,
+                           const OccurenceMap & occurences,
+                           Mat &out_pt2D,
+                           Mat &out_pt3D,
+                           std::vector<feature::EImageDescriberType>& out_descTypes) const;
+
+  /**
+   * @brief Estimate and refine the pose of the query image from the collected 2D-3D associations,
+   * then add the frame to the frame buffer. It is the last step of localizeAllResults().
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the query image
+   * @param[in] param The parameters for the localization
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, they are used if the
+   * flag useInputIntrinsics is set to true, otherwise they are estimated from the correspondences.
+   * @param[in] occurences The 2D-3D associations
+   * @param[in,out] resectionData The 2D and 3D points of the associations, see getAssociatedPoints()
+   * @param[in] matchedImages The images retrieved by queryDatabase()
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool localizeFromAssociations(const feature::MapRegionsPerDesc & queryRegions,
+                                const std::pair<std::size_t, std::size_t> & imageSize,
+                                const Parameters &param,
+                                std::mt19937 & randomNumberGenerator,
+                                bool useInputIntrinsics,
+                                camera::PinholeRadialK3 &queryIntrinsics,
+                                const OccurenceMap &occurences,
+                                sfm::ImageLocalizerMatchData &resectionData,
+                                const std::vector<voctree::DocMatch>& matchedImages,
+                                LocalizationResult &localizationResult,
+                                const std::string& imagePath = std::string());
+
 private:
   /**
    * @brief Load the vocabulary tree.
@@ -325,15 +442,6 @@ private:
                       matching::MatchesPerDescType & out_featureMatches,
                       robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC) const;
   
-  void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
-                                 const std::pair<std::size_t, std::size_t> & imageSize,
-                                 const Parameters &param,
-                                 bool useInputIntrinsics,
-                                 const camera::PinholeRadialK3 &queryIntrinsics,
-                                 OccurenceMap &out_occurences,
-                                 std::mt19937 & randomNumberGenerator,
-                                 const std::string& imagePath = std::string()) const;
-  
   /**
    * @brief Load all the Descriptors who have contributed to the reconstruction.
    * deprecated.. now inside initDatabase
@@ -14,6 +14,8 @@
 
 #include <aliceVision/config.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <iostream>
 
@@ -117,13 +119,19 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
       return false;
     }
 
+    pvec_distances->resize(nbQuery * NN);
+    pvec_indices->resize(nbQuery * NN);
+
+    if (NN <= maxTiledNeighbours)
+    {
+      searchNeighboursTiled(query, nbQuery, pvec_indices, pvec_distances, NN);
+      return true;
+    }
+
     //matrix representation of the input data;
     Eigen::Map<BaseMat> mat_query((Scalar*)query, nbQuery, (*memMapping).cols());
     Metric metric;
 
-    pvec_distances->resize(nbQuery * NN);
-    pvec_indices->resize(nbQuery * NN);
-
     #pragma omp parallel for schedule(dynamic)
     for (int queryIndex=0; queryIndex < nbQuery; ++queryIndex) 
     {
@@ -153,6 +161,85 @@ class ArrayMatcher_bruteForce  : public ArrayMatcher<Scalar, Metric>
   };
 
 private:
+  /// Maximal number of neighbours searched with the tiled search
+  static const std::size_t maxTiledNeighbours = 16;
+  /// Number of query descriptors processed together by a thread
+  static const int queryTileSize = 32;
+  /// Size in bytes of the database tile shared by all the queries of a tile (kept in L2 cache)
+  static const std::size_t databaseTileBytes = 128 * 1024;
+
+  /**
+   * Search the N nearest neighbours with a cache-tiled all-pairs distance computation.
+   *
+   * The queries are split in tiles processed in parallel. Each query tile is compared
+   * to the database tile by tile, so that both tiles stay in cache, while a running
+   * sorted list of the N best neighbours is kept per query.
+   * Neighbours with the same distance are ordered by database index.
+   */
+  void searchNeighboursTiled(const Scalar * query, int nbQuery,
+                             IndMatches * pvec_indices,
+                             std::vector<DistanceType> * pvec_distances,
+                             size_t NN) const
+  {
+    const int nbDatabase = static_cast<int>((*memMapping).rows());
+    const int dimension = static_cast<int>((*memMapping).cols());
+    const Scalar * database = (*memMapping).data();
+    const int databaseTileSize = std::max(1, static_cast<int>(databaseTileBytes / (dimension * sizeof(Scalar))));
+    const int nbQueryTiles = (nbQuery + queryTileSize - 1) / queryTileSize;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int queryTile = 0; queryTile < nbQueryTiles; ++queryTile)
+    {
+      Metric metric;
+      const int queryBegin = queryTile * queryTileSize;
+      const int queryEnd = std::min(queryBegin + queryTileSize, nbQuery);
+
+      // running sorted N best neighbours of each query of the tile
+      std::vector<DistanceType> bestDistances(queryTileSize * NN, std::numeric_limits<DistanceType>::max());
+      std::vector<int> bestIndices(queryTileSize * NN, -1);
+
+      for (int databaseBegin = 0; databaseBegin < nbDatabase; databaseBegin += databaseTileSize)
+      {
+        const int databaseEnd = std::min(databaseBegin + databaseTileSize, nbDatabase);
+
+        for (int queryIndex = queryBegin; queryIndex < queryEnd; ++queryIndex)
+        {
+          const Scalar * queryPtr = query + static_cast<std::size_t>(queryIndex) * dimension;
+          DistanceType * distances = &bestDistances[(queryIndex - queryBegin) * NN];
+          int * indices = &bestIndices[(queryIndex - queryBegin) * NN];
+          const Scalar * rowPtr = database + static_cast<std::size_t>(databaseBegin) * dimension;
+
+          for (int i = databaseBegin; i < databaseEnd; ++i, rowPtr += dimension)
+          {
+            const DistanceType distance = metric(queryPtr, rowPtr, dimension);
+            if (!(distance < distances[NN - 1]))
+              continue;
+
+            // insert in the sorted list (after the neighbours with the same distance)
+            std::size_t k = NN - 1;
+            for (; k > 0 && distance < distances[k - 1]; --k)
+            {
+              distances[k] = distances[k - 1];
+              indices[k] = indices[k - 1];
+            }
+            distances[k] = distance;
+            indices[k] = i;
+          }
+        }
+      }
+
+      for (int queryIndex = queryBegin; queryIndex < queryEnd; ++queryIndex)
+      {
+        for (std::size_t k = 0; k < NN; ++k)
+        {
+          const std::size_t tileOffset = (queryIndex - queryBegin) * NN + k;
+          (*pvec_distances)[queryIndex * NN + k] = bestDistances[tileOffset];
+          (*pvec_indices)[queryIndex * NN + k] = IndMatch(queryIndex, bestIndices[tileOffset]);
+        }
+      }
+    }
+  }
+
   typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
   /// Use a memory mapping in order to avoid memory re-allocation
   std::unique_ptr< Eigen::Map<BaseMat> > memMapping;
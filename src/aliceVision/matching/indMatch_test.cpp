@@ -10,6 +10,8 @@
 
 #include <boost/filesystem/operations.hpp>
 
+#include <fstream>
+
 #define BOOST_TEST_MODULE IndMatch
 
 #include <boost/test/unit_test.hpp>
@@ -108,6 +110,95 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
   boost::filesystem::remove_all(testFolder);
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_IO_Binary)
+{
+  const std::string testFolder = "matchingBinaryTest";
+  boost::filesystem::create_directory(testFolder);
+  {
+    std::set<IndexT> viewsKeys = {0, 1, 2};
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{10,1000},{2,7},{300000,5}};
+    matches[std::make_pair(1,2)][EImageDescriberType::SIFT] = {{4,4}};
+    matches[std::make_pair(2,3)][EImageDescriberType::SIFT] = {{5,6}};
+
+    BOOST_CHECK(Save(matches, testFolder, "bin", false));
+
+    // Load all pairs
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(LoadMatchFile(loadedMatches, (fs::path(testFolder) / "matches.bin").string()));
+    BOOST_CHECK_EQUAL(matches.size(), loadedMatches.size());
+    for(const auto& pairMatches: matches)
+    {
+      BOOST_CHECK_EQUAL(1, loadedMatches.count(pairMatches.first));
+      for(const auto& descMatches: pairMatches.second)
+      {
+        const IndMatches& loaded = loadedMatches.at(pairMatches.first).at(descMatches.first);
+        BOOST_CHECK(descMatches.second == loaded);
+      }
+    }
+
+    // Load only the pairs of the selected views
+    loadedMatches.clear();
+    BOOST_CHECK(LoadMatchFile(loadedMatches, (fs::path(testFolder) / "matches.bin").string(), viewsKeys));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(0, loadedMatches.count(std::make_pair(2,3)));
+
+    loadedMatches.clear();
+    BOOST_CHECK(Load(loadedMatches, viewsKeys, {testFolder}, {EImageDescriberType::UNKNOWN}));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(3, loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN).size());
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    std::set<IndexT> viewsKeys = {0, 1, 2};
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    matches[std::make_pair(1,2)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}, {2,2}};
+    matches[std::make_pair(1,3)][EImageDescriberType::UNKNOWN] = {{5,5}};
+
+    // One file per image, only the pairs of the selected views are loaded
+    BOOST_CHECK(Save(matches, testFolder, "bin", true));
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK_EQUAL(2, LoadMatchFilePerImage(loadedMatches, viewsKeys, testFolder, "matches.bin"));
+    BOOST_CHECK_EQUAL(2, loadedMatches.size());
+    BOOST_CHECK_EQUAL(0, loadedMatches.count(std::make_pair(1,3)));
+    BOOST_CHECK(matches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN) == loadedMatches.at(std::make_pair(1,2)).at(EImageDescriberType::UNKNOWN));
+  }
+  boost::filesystem::remove_all(testFolder);
+  boost::filesystem::create_directory(testFolder);
+  {
+    PairwiseMatches matches;
+    matches[std::make_pair(0,1)][EImageDescriberType::UNKNOWN] = {{0,0},{1,1}};
+    BOOST_CHECK(Save(matches, testFolder, "bin", false));
+    const std::string filepath = (fs::path(testFolder) / "matches.bin").string();
+
+    // A corrupted pairs count larger than the file is rejected before reading the index
+    {
+      std::fstream stream(filepath, std::ios::in | std::ios::out | std::ios::binary);
+      stream.seekp(16);
+      const char pairCount[8] = {'\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\xFF', '\x0F'};
+      stream.write(pairCount, sizeof(pairCount));
+    }
+    PairwiseMatches loadedMatches;
+    BOOST_CHECK(!LoadMatchFile(loadedMatches, filepath));
+    BOOST_CHECK_EQUAL(0, loadedMatches.size());
+
+    // A pair block beyond the end of the file is rejected
+    BOOST_CHECK(Save(matches, testFolder, "bin", false));
+    {
+      std::fstream stream(filepath, std::ios::in | std::ios::out | std::ios::binary);
+      stream.seekp(24 + 16);
+      const char pairSize[8] = {'\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x01', '\x00'};
+      stream.write(pairSize, sizeof(pairSize));
+    }
+    BOOST_CHECK(!LoadMatchFile(loadedMatches, filepath));
+    BOOST_CHECK_EQUAL(0, loadedMatches.size());
+  }
+  boost::filesystem::remove_all(testFolder);
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
   std::vector<IndMatch> vec_indMatch;
@@ -13,6 +13,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <fstream>
 #include <iterator>
@@ -24,7 +26,241 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace matching {
 
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
+namespace {
+
+/**
+ * Binary match file layout (all integers are little-endian):
+ *
+ *   header: magic "AVMATCHB" | uint32 version | uint32 reserved | uint64 pairCount
+ *   index:  pairCount x { uint32 I | uint32 J | uint64 offset | uint64 size }, sorted by (I, J)
+ *   data:   one block per pair, at the offset given by the index:
+ *             varint nbDescType
+ *             nbDescType x { varint descTypeLength | descType string | varint nbMatches |
+ *                            nbMatches x { zigzag varint delta(_i) | zigzag varint delta(_j) } }
+ *
+ * Feature indices are delta encoded with the previous match of the same block,
+ * so sorted matches are stored in one or two bytes per index.
+ * The index allows to read only the pairs of interest without parsing the whole file.
+ */
+const char binaryMatchesMagic[8] = {'A', 'V', 'M', 'A', 'T', 'C', 'H', 'B'};
+const std::uint32_t binaryMatchesVersion = 1;
+const std::size_t binaryMatchesHeaderSize = 8 + 4 + 4 + 8;
+const std::size_t binaryMatchesIndexEntrySize = 4 + 4 + 8 + 8;
+
+struct BinaryMatchesIndexEntry
+{
+  Pair pair;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+template<typename T>
+void writeLittleEndian(std::vector<unsigned char>& buffer, T value)
+{
+  for(std::size_t i = 0; i < sizeof(T); ++i)
+    buffer.push_back(static_cast<unsigned char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF));
+}
+
+template<typename T>
+T readLittleEndian(const unsigned char* data)
+{
+  std::uint64_t value = 0;
+  for(std::size_t i = 0; i < sizeof(T); ++i)
+    value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+  return static_cast<T>(value);
+}
+
+void writeVarint(std::vector<unsigned char>& buffer, std::uint64_t value)
+{
+  while(value >= 0x80)
+  {
+    buffer.push_back(static_cast<unsigned char>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<unsigned char>(value));
+}
+
+bool readVarint(const unsigned char*& data, const unsigned char* end, std::uint64_t& value)
+{
+  value = 0;
+  for(int shift = 0; shift < 64 && data != end; shift += 7)
+  {
+    const unsigned char byte = *data++;
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+inline std::uint64_t zigzagEncode(std::int64_t value)
+{
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t zigzagDecode(std::uint64_t value)
+{
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * @brief Encode the matches of one image pair into \p buffer.
+ */
+void encodeBinaryPairMatches(std::vector<unsigned char>& buffer, const MatchesPerDescType& matchesPerDesc)
+{
+  writeVarint(buffer, matchesPerDesc.size());
+  for(const auto& m: matchesPerDesc)
+  {
+    const std::string descTypeStr = feature::EImageDescriberType_enumToString(m.first);
+    writeVarint(buffer, descTypeStr.size());
+    buffer.insert(buffer.end(), descTypeStr.begin(), descTypeStr.end());
+    writeVarint(buffer, m.second.size());
+
+    std::int64_t previousI = 0;
+    std::int64_t previousJ = 0;
+    for(const IndMatch& match: m.second)
+    {
+      writeVarint(buffer, zigzagEncode(static_cast<std::int64_t>(match._i) - previousI));
+      writeVarint(buffer, zigzagEncode(static_cast<std::int64_t>(match._j) - previousJ));
+      previousI = match._i;
+      previousJ = match._j;
+    }
+  }
+}
+
+/**
+ * @brief Decode the matches of one image pair from a data block.
+ * @return false if the block is corrupted
+ */
+bool decodeBinaryPairMatches(const unsigned char* data, const unsigned char* end, MatchesPerDescType& matchesPerDesc)
+{
+  std::uint64_t nbDescType = 0;
+  if(!readVarint(data, end, nbDescType))
+    return false;
+
+  for(std::uint64_t d = 0; d < nbDescType; ++d)
+  {
+    std::uint64_t descTypeLength = 0;
+    if(!readVarint(data, end, descTypeLength) || descTypeLength > static_cast<std::uint64_t>(end - data))
+      return false;
+    const std::string descTypeStr(reinterpret_cast<const char*>(data), descTypeLength);
+    data += descTypeLength;
+
+    std::uint64_t nbMatches = 0;
+    // each match uses at least two bytes
+    if(!readVarint(data, end, nbMatches) || nbMatches > static_cast<std::uint64_t>(end - data) / 2)
+      return false;
+
+    std::vector<IndMatch> matchesPerDescType(nbMatches);
+    std::int64_t previousI = 0;
+    std::int64_t previousJ = 0;
+    for(IndMatch& match: matchesPerDescType)
+    {
+      std::uint64_t deltaI = 0;
+      std::uint64_t deltaJ = 0;
+      if(!readVarint(data, end, deltaI) || !readVarint(data, end, deltaJ))
+        return false;
+      previousI += zigzagDecode(deltaI);
+      previousJ += zigzagDecode(deltaJ);
+      match._i = static_cast<IndexT>(previousI);
+      match._j = static_cast<IndexT>(previousJ);
+    }
+    matchesPerDesc[feature::EImageDescriberType_stringToEnum(descTypeStr)] = std::move(matchesPerDescType);
+  }
+  return true;
+}
+
+/**
+ * @brief Read the header and the pairs index of a binary match file.
+ * @return false if the file is not a valid binary match file
+ */
+bool readBinaryMatchesIndex(std::ifstream& stream, std::vector<BinaryMatchesIndexEntry>& index)
+{
+  unsigned char header[binaryMatchesHeaderSize];
+  if(!stream.read(reinterpret_cast<char*>(header), binaryMatchesHeaderSize))
+    return false;
+
+  if(std::memcmp(header, binaryMatchesMagic, sizeof(binaryMatchesMagic)) != 0)
+    return false;
+
+  const std::uint32_t version = readLittleEndian<std::uint32_t>(header + 8);
+  if(version > binaryMatchesVersion)
+  {
+    ALICEVISION_LOG_WARNING("Unsupported binary matching file version: " << version);
+    return false;
+  }
+
+  const std::uint64_t pairCount = readLittleEndian<std::uint64_t>(header + 16);
+
+  // check the pairs count and the data blocks against the file size before any allocation
+  stream.seekg(0, std::ios::end);
+  const std::streamoff fileSize = stream.tellg();
+  stream.seekg(binaryMatchesHeaderSize);
+  if(fileSize < 0 || !stream)
+    return false;
+  const std::uint64_t dataSize = static_cast<std::uint64_t>(fileSize) - binaryMatchesHeaderSize;
+  if(pairCount > dataSize / binaryMatchesIndexEntrySize)
+    return false;
+
+  std::vector<unsigned char> indexData(pairCount * binaryMatchesIndexEntrySize);
+  if(!stream.read(reinterpret_cast<char*>(indexData.data()), indexData.size()))
+    return false;
+
+  index.resize(pairCount);
+  for(std::size_t p = 0; p < pairCount; ++p)
+  {
+    const unsigned char* entryData = indexData.data() + p * binaryMatchesIndexEntrySize;
+    BinaryMatchesIndexEntry& entry = index[p];
+    entry.pair.first = readLittleEndian<std::uint32_t>(entryData);
+    entry.pair.second = readLittleEndian<std::uint32_t>(entryData + 4);
+    entry.offset = readLittleEndian<std::uint64_t>(entryData + 8);
+    entry.size = readLittleEndian<std::uint64_t>(entryData + 16);
+    if(entry.offset > static_cast<std::uint64_t>(fileSize) || entry.size > static_cast<std::uint64_t>(fileSize) - entry.offset)
+      return false;
+  }
+  return true;
+}
+
+bool loadBinaryMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>* viewsKeysFilter)
+{
+  std::ifstream stream(filepath.c_str(), std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+    return false;
+
+  std::vector<BinaryMatchesIndexEntry> index;
+  if(!readBinaryMatchesIndex(stream, index))
+  {
+    ALICEVISION_LOG_WARNING("Invalid binary matching file: " << filepath);
+    return false;
+  }
+
+  std::vector<unsigned char> pairData;
+  for(const BinaryMatchesIndexEntry& entry: index)
+  {
+    if(viewsKeysFilter != nullptr &&
+       (viewsKeysFilter->find(entry.pair.first) == viewsKeysFilter->end() ||
+        viewsKeysFilter->find(entry.pair.second) == viewsKeysFilter->end()))
+      continue;
+
+    pairData.resize(entry.size);
+    stream.seekg(entry.offset);
+    if(!stream.read(reinterpret_cast<char*>(pairData.data()), pairData.size()))
+    {
+      ALICEVISION_LOG_WARNING("Invalid binary matching file: " << filepath << " (cannot read pair " << entry.pair.first << "-" << entry.pair.second << ")");
+      return false;
+    }
+
+    MatchesPerDescType& matchesPerDesc = matches[entry.pair];
+    if(!decodeBinaryPairMatches(pairData.data(), pairData.data() + pairData.size(), matchesPerDesc))
+    {
+      ALICEVISION_LOG_WARNING("Invalid binary matching file: " << filepath << " (corrupted pair " << entry.pair.first << "-" << entry.pair.second << ")");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool loadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>* viewsKeysFilter)
 {
   const std::string ext = fs::extension(filepath);
 
@@ -51,6 +287,9 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
     std::size_t nbDescType = 0;
     while(stream >> I >> J >> nbDescType)
     {
+      const bool keepPair = viewsKeysFilter == nullptr ||
+                            (viewsKeysFilter->find(I) != viewsKeysFilter->end() &&
+                             viewsKeysFilter->find(J) != viewsKeysFilter->end());
       for(std::size_t i = 0; i < nbDescType; ++i)
       {
         std::string descTypeStr;
@@ -65,12 +304,17 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
         {
           stream >> matchesPerDesc[i];
         }
-        matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
+        if(keepPair)
+          matches[std::make_pair(I,J)][descType] = std::move(matchesPerDesc);
       }
     }
     stream.close();
     return true;
   }
+  else if(ext == ".bin")
+  {
+    return loadBinaryMatchFile(matches, filepath, viewsKeysFilter);
+  }
   else
   {
     ALICEVISION_LOG_WARNING("Unknown matching file format: " << ext);
@@ -78,6 +322,18 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
   return false;
 }
 
+} // namespace
+
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
+{
+  return loadMatchFile(matches, filepath, nullptr);
+}
+
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter)
+{
+  return loadMatchFile(matches, filepath, &viewsKeysFilter);
+}
+
 void filterMatchesByViews(PairwiseMatches& matches, const std::set<IndexT>& viewsKeys)
 {
   matching::PairwiseMatches filteredMatches;
@@ -145,7 +401,7 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
     const IndexT idView = *it;
     const std::string matchFilename = std::to_string(idView) + "." + extension;
     PairwiseMatches fileMatches;
-    if(!LoadMatchFile(fileMatches, (fs::path(folder) / matchFilename).string() ))
+    if(!LoadMatchFile(fileMatches, (fs::path(folder) / matchFilename).string(), viewsKeys))
     {
       #pragma omp critical
       {
@@ -167,21 +423,30 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
 }
 
 /**
- * Load and add pair-wise matches to \p matches from all files in \p folder matching \p pattern.
+ * Load and add pair-wise matches to \p matches from all files in \p folder matching one of the \p patterns.
  * @param[out] matches PairwiseMatches to add loaded matches to
  * @param[in] folder Folder to load matches files from
- * @param[in] pattern Pattern that files must respect to be loaded
+ * @param[in] patterns Patterns that files must respect to be loaded (one of them)
+ * @param[in] viewsKeysFilter Restrict the matches to these views
  */
-std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& folder, const std::string& pattern)
+std::size_t loadMatchesFromFolder(PairwiseMatches& matches,
+                                  const std::string& folder,
+                                  const std::vector<std::string>& patterns,
+                                  const std::set<IndexT>& viewsKeysFilter)
 {
   std::size_t nbLoadedMatchFiles = 0;
   std::vector<std::string> matchFiles;
-  // list all matches files in 'folder' matching (i.e containing) 'pattern'
+  // list all matches files in 'folder' matching (i.e containing) one of the 'patterns'
   for(const auto& entry : boost::make_iterator_range(fs::directory_iterator(folder), {}))
   {
-    if(entry.path().string().find(pattern) != std::string::npos)
+    const std::string filepath = entry.path().string();
+    for(const std::string& pattern : patterns)
     {
-      matchFiles.push_back(entry.path().string());
+      if(filepath.find(pattern) != std::string::npos)
+      {
+        matchFiles.push_back(filepath);
+        break;
+      }
     }
   }
 
@@ -191,7 +456,9 @@ std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& f
     const std::string& matchFile = matchFiles[i];
     PairwiseMatches fileMatches;
     ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
-    if(!LoadMatchFile(fileMatches, matchFile))
+    const bool loaded = viewsKeysFilter.empty() ? LoadMatchFile(fileMatches, matchFile)
+                                                : LoadMatchFile(fileMatches, matchFile, viewsKeysFilter);
+    if(!loaded)
     {
       ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
       continue;
@@ -230,7 +497,7 @@ bool Load(PairwiseMatches& matches,
           int minNbMatches)
 {
   std::size_t nbLoadedMatchFiles = 0;
-  const std::string pattern = "matches.txt";
+  const std::vector<std::string> patterns = {"matches.txt", "matches.bin"};
 
   // build up a set with normalized paths to remove duplicates
   std::set<std::string> foldersSet;
@@ -244,7 +511,7 @@ bool Load(PairwiseMatches& matches,
 
   for(const auto& folder : foldersSet)
   {
-    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, pattern);
+    nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, patterns, viewsKeysFilter);
   }
 
   if(!nbLoadedMatchFiles)
@@ -315,6 +582,58 @@ private:
     fs::rename(tmpPath, filepath);
   }
 
+  void saveBin(
+    const std::string& filepath,
+    const PairwiseMatches::const_iterator& matchBegin,
+    const PairwiseMatches::const_iterator& matchEnd)
+  {
+    const fs::path bPath = fs::path(filepath);
+    const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+
+    // encode all pairs, then compute their absolute offsets
+    std::vector<BinaryMatchesIndexEntry> index;
+    std::vector<unsigned char> data;
+    for(PairwiseMatches::const_iterator match = matchBegin;
+      match != matchEnd;
+      ++match)
+    {
+      BinaryMatchesIndexEntry entry;
+      entry.pair = match->first;
+      entry.offset = data.size();
+      encodeBinaryPairMatches(data, match->second);
+      entry.size = data.size() - entry.offset;
+      index.push_back(entry);
+    }
+
+    const std::uint64_t dataOffset = binaryMatchesHeaderSize + index.size() * binaryMatchesIndexEntrySize;
+
+    std::vector<unsigned char> header;
+    header.reserve(dataOffset);
+    header.insert(header.end(), binaryMatchesMagic, binaryMatchesMagic + sizeof(binaryMatchesMagic));
+    writeLittleEndian<std::uint32_t>(header, binaryMatchesVersion);
+    writeLittleEndian<std::uint32_t>(header, 0);
+    writeLittleEndian<std::uint64_t>(header, index.size());
+    for(const BinaryMatchesIndexEntry& entry: index)
+    {
+      writeLittleEndian<std::uint32_t>(header, entry.pair.first);
+      writeLittleEndian<std::uint32_t>(header, entry.pair.second);
+      writeLittleEndian<std::uint64_t>(header, dataOffset + entry.offset);
+      writeLittleEndian<std::uint64_t>(header, entry.size);
+    }
+
+    // write temporary file
+    {
+      std::ofstream stream(tmpPath.c_str(), std::ios::out | std::ios::binary);
+      stream.write(reinterpret_cast<const char*>(header.data()), header.size());
+      stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+      if(!stream.good())
+        throw std::runtime_error("Unable to write binary matching file: " + tmpPath);
+    }
+
+    // rename temporary file
+    fs::rename(tmpPath, filepath);
+  }
+
 public:
   MatchExporter(
     const PairwiseMatches& matches,
@@ -334,6 +653,8 @@ public:
 
     if(m_ext == ".txt")
       saveTxt(filepath, m_matches.begin(), m_matches.end());
+    else if(m_ext == ".bin")
+      saveBin(filepath, m_matches.begin(), m_matches.end());
     else
       throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
   }
@@ -359,6 +680,8 @@ public:
       
       if(m_ext == ".txt")
         saveTxt(filepath, matchBegin, match);
+      else if(m_ext == ".bin")
+        saveBin(filepath, matchBegin, match);
       else
         throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
 
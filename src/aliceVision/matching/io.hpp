@@ -19,14 +19,27 @@ namespace matching {
  * @brief Load a match file.
  *
  * @param[out] matches container for the output matches
- * @param[in] filepath the match file to load
+ * @param[in] filepath the match file to load (txt or bin file format)
  */
 bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath);
 
+/**
+ * @brief Load a match file, restricted to some views.
+ *
+ * With the bin file format, only the pairs whose both views are in \p viewsKeysFilter are read,
+ * the other pairs are skipped using the file index.
+ * With the txt file format, the whole file is loaded.
+ *
+ * @param[out] matches container for the output matches
+ * @param[in] filepath the match file to load (txt or bin file format)
+ * @param[in] viewsKeysFilter the list of views to keep
+ */
+bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath, const std::set<IndexT>& viewsKeysFilter);
+
 /**
  * @brief Load the match file for each image.
  * @param[out] matches container for the output matches.
- * @param[in] viewsKeys the list of views whose match files need to be loaded.
+ * @param[in] viewsKeys the list of views whose match files need to be loaded, only the pairs between these views are kept.
  * @param[in] folder the folder where to look for all the files.
  * @param[in] extension the extension of the match file.
  * @return the number of match file actually loaded (if a file cannot be loaded it is discarded)
@@ -78,6 +91,7 @@ void filterTopMatches(PairwiseMatches& allMatches, int maxNum, int minNum);
  * @param[in] matches: container for the output matches
  * @param[in] folder: folder containing the match files
  * @param[in] extension: txt or bin file format
+ *            (bin: compact binary format with a per-pair index, see io.cpp)
  * @param[in] matchFilePerImage: do we store a global match file
  *            or one match file per image
  * @param[in] prefix: optional prefix for the output file(s)
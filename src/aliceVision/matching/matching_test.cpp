@@ -9,7 +9,9 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include <algorithm>
 #include <iostream>
+#include <random>
 
 #define BOOST_TEST_MODULE matching
 
@@ -92,6 +94,57 @@ BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForce_Simple_Dim4)
   BOOST_CHECK_SMALL(static_cast<double>(fDistance), 1e-8); //distance
 }
 
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForce_Tiled_NN)
+{
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> distribution(0, 255);
+
+  // several query and database tiles, with duplicated descriptors to create equal distances
+  const int dimension = 128;
+  const int nbDatabase = 3000;
+  const int nbQuery = 100;
+  std::vector<unsigned char> database(nbDatabase * dimension);
+  std::vector<unsigned char> query(nbQuery * dimension);
+  for(auto& v : database)
+    v = static_cast<unsigned char>(distribution(gen));
+  for(auto& v : query)
+    v = static_cast<unsigned char>(distribution(gen));
+  std::copy(database.begin(), database.begin() + 10 * dimension, database.end() - 10 * dimension);
+
+  typedef feature::L2_Vectorized<unsigned char> MetricT;
+  ArrayMatcher_bruteForce<unsigned char, MetricT> matcher;
+  BOOST_CHECK( matcher.Build(gen, database.data(), nbDatabase, dimension) );
+
+  const size_t NN = 2;
+  IndMatches vec_nIndice;
+  vector<float> vec_fDistance;
+  BOOST_CHECK( matcher.SearchNeighbours(query.data(), nbQuery, &vec_nIndice, &vec_fDistance, NN) );
+  BOOST_CHECK_EQUAL( nbQuery * NN, vec_nIndice.size());
+
+  // compare to an exhaustive search (equal distances are ordered by database index)
+  MetricT metric;
+  for(int q = 0; q < nbQuery; ++q)
+  {
+    std::vector<std::pair<float, int>> distances(nbDatabase);
+    for(int i = 0; i < nbDatabase; ++i)
+      distances[i] = std::make_pair(metric(&query[q * dimension], &database[i * dimension], dimension), i);
+    std::partial_sort(distances.begin(), distances.begin() + NN, distances.end());
+
+    for(size_t k = 0; k < NN; ++k)
+    {
+      BOOST_CHECK_EQUAL(distances[k].first, vec_fDistance[q * NN + k]);
+      BOOST_CHECK_EQUAL(IndMatch(q, distances[k].second), vec_nIndice[q * NN + k]);
+    }
+  }
+
+  // a query equal to duplicated descriptors
+  BOOST_CHECK( matcher.SearchNeighbours(&database[3 * dimension], 1, &vec_nIndice, &vec_fDistance, NN) );
+  BOOST_CHECK_EQUAL(IndMatch(0, 3), vec_nIndice[0]);
+  BOOST_CHECK_EQUAL(IndMatch(0, nbDatabase - 10 + 3), vec_nIndice[1]);
+  BOOST_CHECK_EQUAL(0.f, vec_fDistance[0]);
+  BOOST_CHECK_EQUAL(0.f, vec_fDistance[1]);
+}
+
 BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_kdtreeFlann_Simple__NN)
 {
   std::random_device rd;
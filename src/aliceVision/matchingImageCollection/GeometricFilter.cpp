@@ -0,0 +1,91 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "GeometricFilter.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+std::vector<PairwiseMatches::const_iterator> getGeometricFilterSchedule(const PairwiseMatches& putativeMatches)
+{
+  std::vector<std::pair<std::size_t, PairwiseMatches::const_iterator>> sizedPairs;
+  sizedPairs.reserve(putativeMatches.size());
+  for(PairwiseMatches::const_iterator iter = putativeMatches.begin(); iter != putativeMatches.end(); ++iter)
+    sizedPairs.emplace_back(iter->second.getNbAllMatches(), iter);
+
+  // largest pairs first, pairs of the same size in the map order
+  std::stable_sort(sizedPairs.begin(), sizedPairs.end(),
+                   [](const std::pair<std::size_t, PairwiseMatches::const_iterator>& a,
+                      const std::pair<std::size_t, PairwiseMatches::const_iterator>& b)
+                   {
+                     return a.first > b.first;
+                   });
+
+  std::vector<PairwiseMatches::const_iterator> schedule;
+  schedule.reserve(sizedPairs.size());
+  for(const auto& sizedPair : sizedPairs)
+    schedule.push_back(sizedPair.second);
+  return schedule;
+}
+
+void GeometricFilterStats::log(std::size_t nbSlowestPairs) const
+{
+  if(pairs.empty())
+  {
+    ALICEVISION_LOG_INFO("Geometric filtering: no image pair.");
+    return;
+  }
+
+  std::vector<GeometricFilterPairStats> sortedPairs = pairs;
+  std::sort(sortedPairs.begin(), sortedPairs.end(),
+            [](const GeometricFilterPairStats& a, const GeometricFilterPairStats& b)
+            {
+              return a.time > b.time;
+            });
+
+  double sumTime = 0.0;
+  std::size_t nbPutativeMatches = 0;
+  std::size_t nbGeometricMatches = 0;
+  for(const GeometricFilterPairStats& pairStats : sortedPairs)
+  {
+    sumTime += pairStats.time;
+    nbPutativeMatches += pairStats.nbPutativeMatches;
+    nbGeometricMatches += pairStats.nbGeometricMatches;
+  }
+
+  const std::size_t nbPairs = sortedPairs.size();
+  const double efficiency = (time > 0.0) ? sumTime / (time * nbThreads) : 1.0;
+
+  std::stringstream ss;
+  ss << "Geometric filtering statistics:" << std::endl
+     << "\t- # pairs: " << nbPairs << std::endl
+     << "\t- # putative matches: " << nbPutativeMatches << std::endl
+     << "\t- # geometric matches: " << nbGeometricMatches << std::endl
+     << "\t- elapsed time: " << time << " s on " << nbThreads << " thread(s)" << std::endl
+     << "\t- sum of pair times: " << sumTime << " s (thread efficiency: " << efficiency * 100.0 << "%)" << std::endl
+     << "\t- pair time: mean " << sumTime / nbPairs * 1000.0 << " ms"
+     << ", median " << sortedPairs[nbPairs / 2].time * 1000.0 << " ms"
+     << ", 99th percentile " << sortedPairs[nbPairs / 100].time * 1000.0 << " ms"
+     << ", max " << sortedPairs.front().time * 1000.0 << " ms" << std::endl
+     << "\t- slowest pairs:";
+
+  for(std::size_t i = 0; i < std::min(nbSlowestPairs, nbPairs); ++i)
+  {
+    const GeometricFilterPairStats& pairStats = sortedPairs[i];
+    ss << std::endl << "\t\t- (" << pairStats.pair.first << ", " << pairStats.pair.second << "): "
+       << pairStats.time * 1000.0 << " ms, "
+       << pairStats.nbGeometricMatches << "/" << pairStats.nbPutativeMatches << " matches";
+  }
+
+  ALICEVISION_LOG_INFO(ss.str());
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
@@ -12,9 +12,13 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/progress.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <random>
 #include <vector>
 #include <map>
 
@@ -23,11 +27,54 @@ namespace matchingImageCollection {
 
 using namespace aliceVision::matching;
 
+/**
+ * @brief Filtering statistics of one image pair.
+ */
+struct GeometricFilterPairStats
+{
+  Pair pair;
+  std::size_t nbPutativeMatches = 0;
+  std::size_t nbGeometricMatches = 0;
+  /// estimation time (seconds)
+  double time = 0.0;
+};
+
+/**
+ * @brief Filtering statistics of robustModelEstimation.
+ */
+struct GeometricFilterStats
+{
+  /// statistics of each pair, in scheduling order
+  std::vector<GeometricFilterPairStats> pairs;
+  /// total elapsed time (seconds)
+  double time = 0.0;
+  int nbThreads = 1;
+
+  /**
+   * @brief Log the timing distribution of the pairs and the slowest pairs.
+   */
+  void log(std::size_t nbSlowestPairs = 10) const;
+};
+
+/**
+ * @brief Get the order in which the pairs are filtered: by decreasing number of putative matches,
+ *        so that the most expensive pairs do not end up alone at the end of the parallel loop.
+ * @param[in] putativeMatches
+ * @return iterators on the putative matches, in scheduling order
+ */
+std::vector<PairwiseMatches::const_iterator> getGeometricFilterSchedule(const PairwiseMatches& putativeMatches);
+
 /**
  * @brief Perform robust model estimation (with optional guided_matching)
  * or all the pairs and regions correspondences contained in the putativeMatches set.
  * Allow to keep only geometrically coherent matches.
  * It discards pairs that do not lead to a valid robust model estimation.
+ * The largest pairs are filtered first and each thread reuses its own estimation buffers.
+ * The random number generator of each pair is seeded from the pair,
+ * so the result does not depend on the number of threads.
+ * When the functor evaluates the hypotheses of the robust estimation by batches
+ * (see GeometricFilterMatrix::setACRansacBatchSize), the pairs are filtered one by one
+ * and the threads evaluate the hypotheses of each pair, which suits a few large pairs.
  * @param[out] geometricMatches
  * @param[in] sfmData
  * @param[in] regionsPerView
@@ -36,6 +83,7 @@ using namespace aliceVision::matching;
  * @param[in] guidedMatching
  * @param[in] distanceRatio
  * @param[in] randomNumberGenerator
+ * @param[out] stats timing statistics, optional
  */
 template<typename GeometryFunctor>
 void robustModelEstimation(
@@ -46,28 +94,45 @@ void robustModelEstimation(
   const PairwiseMatches& putativeMatches,
   std::mt19937 & randomNumberGenerator,
   const bool guidedMatching = false,
-  const double distanceRatio = 0.6
+  const double distanceRatio = 0.6,
+  GeometricFilterStats* stats = nullptr
   )
 {
   out_geometricMatches.clear();
 
+  const auto start = std::chrono::steady_clock::now();
+  const std::vector<PairwiseMatches::const_iterator> schedule = getGeometricFilterSchedule(putativeMatches);
+  std::vector<GeometricFilterPairStats> pairsStats(schedule.size());
+  std::vector<GeometricFilterWorkspace> workspaces(omp_get_max_threads());
+  const std::uint32_t seed = static_cast<std::uint32_t>(randomNumberGenerator());
+
   boost::progress_display progressBar(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
   
-#pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < (int)putativeMatches.size(); ++i)
+  // the threads are used by the batched robust estimation of each pair instead
+  const bool parallelPairs = (functor.m_acRansacBatchSize <= 1);
+
+#pragma omp parallel for schedule(dynamic) if(parallelPairs)
+  for (int i = 0; i < (int)schedule.size(); ++i)
   {
-    PairwiseMatches::const_iterator iter = putativeMatches.begin();
-    std::advance(iter, i);
+    PairwiseMatches::const_iterator iter = schedule[i];
 
     const Pair currentPair = iter->first;
     const MatchesPerDescType& putativeMatchesPerType = iter->second;
     const Pair& imagePair = iter->first;
 
+    const auto pairStart = std::chrono::steady_clock::now();
+    GeometricFilterPairStats& pairStats = pairsStats[i];
+    pairStats.pair = currentPair;
+    pairStats.nbPutativeMatches = putativeMatchesPerType.getNbAllMatches();
+
     // apply the geometric filter (robust model estimation)
     {
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, randomNumberGenerator, inliers);
+      geometricFilter.setWorkspace(&workspaces[omp_get_thread_num()]);
+      std::seed_seq pairSeed{seed, static_cast<std::uint32_t>(imagePair.first), static_cast<std::uint32_t>(imagePair.second)};
+      std::mt19937 pairRandomNumberGenerator(pairSeed);
+      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, pairRandomNumberGenerator, inliers);
       if(state.hasStrongSupport)
       {
         if(guidedMatching)
@@ -78,6 +143,8 @@ void robustModelEstimation(
           std::swap(inliers, guidedGeometricInliers);
         }
 
+        pairStats.nbGeometricMatches = inliers.getNbAllMatches();
+
 #pragma omp critical
         {
           out_geometricMatches.emplace(currentPair, std::move(inliers));
@@ -86,11 +153,20 @@ void robustModelEstimation(
       }
     }
 
+    pairStats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - pairStart).count();
+
 #pragma omp critical
     {
       ++progressBar;
     }
   }
+
+  if(stats != nullptr)
+  {
+    stats->pairs = std::move(pairsStats);
+    stats->time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats->nbThreads = omp_get_max_threads();
+  }
 }
 
 } // namespace matchingImageCollection
@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+
+#include <algorithm>
+#include <vector>
+
 namespace aliceVision {
 
 
@@ -25,6 +30,17 @@ class SfMData;
 
 namespace matchingImageCollection {
 
+/**
+ * @brief Buffers of the geometric filters, reused from one image pair to the next
+ *        by the thread that owns them.
+ */
+struct GeometricFilterWorkspace
+{
+  /// buffers of the a contrario robust estimation
+  robustEstimation::ACRansacWorkspace acRansac;
+  /// indices of the inliers of the estimated model
+  std::vector<std::size_t> inliers;
+};
 
 struct GeometricFilterMatrix
 {
@@ -54,10 +70,35 @@ struct GeometricFilterMatrix
     matching::MatchesPerDescType & matches
   ) = 0;
 
+  /**
+   * @brief Use the buffers of the given workspace for the next estimations.
+   * @param[in] workspace not owned, nullptr to allocate the buffers for each estimation
+   */
+  void setWorkspace(GeometricFilterWorkspace* workspace)
+  {
+    m_workspace = workspace;
+  }
+
+  robustEstimation::ACRansacWorkspace* getACRansacWorkspace() const
+  {
+    return (m_workspace != nullptr) ? &m_workspace->acRansac : nullptr;
+  }
+
+  /**
+   * @brief Set the number of hypotheses of the a contrario robust estimation evaluated in parallel.
+   *        The estimated model does not depend on it (see robustEstimation::ACRANSACParallel).
+   * @param[in] batchSize 1 for the sequential estimation
+   */
+  void setACRansacBatchSize(std::size_t batchSize)
+  {
+    m_acRansacBatchSize = std::max<std::size_t>(batchSize, 1);
+  }
 
   double m_dPrecision;  //upper_bound precision used for robust estimation
   double m_dPrecision_robust;
   std::size_t m_stIteration; //maximal number of iteration for robust estimation
+  GeometricFilterWorkspace* m_workspace = nullptr; //buffers reused between estimations, optional
+  std::size_t m_acRansacBatchSize = 1; //number of hypotheses of the robust estimation evaluated in parallel
 };
 
 
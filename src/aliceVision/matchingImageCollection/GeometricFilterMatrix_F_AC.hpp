@@ -108,7 +108,8 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
                                              regionI, regionJ,
                                              descTypes, xI, xJ);
 
-    std::vector<std::size_t> inliers;
+    std::vector<std::size_t> localInliers;
+    std::vector<std::size_t>& inliers = (m_workspace != nullptr) ? m_workspace->inliers : localInliers;
     const camera::EquiDistant * cam_I_equidistant = dynamic_cast<const camera::EquiDistant *>(camI);
     const camera::EquiDistant * cam_J_equidistant = dynamic_cast<const camera::EquiDistant *>(camJ);
     std::pair<bool, std::size_t> estimationPair;
@@ -232,7 +233,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
       const double upper_bound_precision = Square(m_dPrecision);
 
       robustEstimation::Mat3Model model;
-      const std::pair<double, double> ACRansacOut = ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision);
+      const std::pair<double, double> ACRansacOut = ACRANSACParallel(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision, m_acRansacBatchSize, getACRansacWorkspace());
 
       m_F = model.getMatrix();
 
@@ -280,7 +281,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     const double upperBoundPrecision = Square(m_dPrecision);
 
     ModelT_ model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSACParallel(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacBatchSize, getACRansacWorkspace());
     m_F = model.getMatrix();
 
     if(out_inliers.empty())
@@ -76,9 +76,10 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
     // robustly estimate the Homography matrix with A Contrario ransac
     const double upperBoundPrecision = Square(m_dPrecision);
 
-    std::vector<std::size_t> inliers;
+    std::vector<std::size_t> localInliers;
+    std::vector<std::size_t>& inliers = (m_workspace != nullptr) ? m_workspace->inliers : localInliers;
     robustEstimation::Mat3Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSACParallel(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacBatchSize, getACRansacWorkspace());
     m_H = model.getMatrix();
 
     if (inliers.empty())
@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE matchingImageCollectionGeometricFilter
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+
+/// Keep a random subset of the matches, drawn with the random number generator of the pair
+struct RandomFilter : public GeometricFilterMatrix
+{
+  RandomFilter()
+    : GeometricFilterMatrix(1.0, 1.0, 1)
+  {}
+
+  template<class Regions_or_Features_ProviderT>
+  EstimationStatus geometricEstimation(const sfmData::SfMData* sfmData,
+                                       const Regions_or_Features_ProviderT& regionsPerView,
+                                       const Pair& pairIndex,
+                                       const matching::MatchesPerDescType& putativeMatchesPerType,
+                                       std::mt19937& randomNumberGenerator,
+                                       matching::MatchesPerDescType& out_geometricInliersPerType)
+  {
+    // the workspace is set by the scheduler
+    if(m_workspace == nullptr)
+      return EstimationStatus(false, false);
+
+    std::bernoulli_distribution keepDistribution(0.5);
+    for(const auto& matches : putativeMatchesPerType)
+    {
+      for(const matching::IndMatch& match : matches.second)
+      {
+        if(keepDistribution(randomNumberGenerator))
+          out_geometricInliersPerType[matches.first].push_back(match);
+      }
+    }
+    return EstimationStatus(true, !out_geometricInliersPerType.empty());
+  }
+
+  bool Geometry_guided_matching(const sfmData::SfMData* sfmData,
+                                const feature::RegionsPerView& regionsPerView,
+                                const Pair imageIdsPair,
+                                const double dDistanceRatio,
+                                matching::MatchesPerDescType& matches) override
+  {
+    return false;
+  }
+};
+
+matching::PairwiseMatches makePutativeMatches(std::size_t nbPairs)
+{
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> sizeDistribution(0, 200);
+
+  matching::PairwiseMatches putativeMatches;
+  for(std::size_t i = 0; i < nbPairs; ++i)
+  {
+    matching::IndMatches& matches = putativeMatches[Pair(i, i + 1)][descType];
+    const int nbMatches = sizeDistribution(generator);
+    for(int m = 0; m < nbMatches; ++m)
+      matches.emplace_back(m, m);
+  }
+  return putativeMatches;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(GeometricFilter_schedule)
+{
+  const matching::PairwiseMatches putativeMatches = makePutativeMatches(100);
+  const std::vector<matching::PairwiseMatches::const_iterator> schedule = getGeometricFilterSchedule(putativeMatches);
+
+  BOOST_REQUIRE_EQUAL(schedule.size(), putativeMatches.size());
+
+  PairSet scheduledPairs;
+  for(std::size_t i = 0; i < schedule.size(); ++i)
+  {
+    scheduledPairs.insert(schedule[i]->first);
+    if(i > 0)
+    {
+      // by decreasing size, then in the map order
+      const int previousSize = schedule[i - 1]->second.getNbAllMatches();
+      const int size = schedule[i]->second.getNbAllMatches();
+      BOOST_CHECK(previousSize >= size);
+      if(previousSize == size)
+        BOOST_CHECK(schedule[i - 1]->first < schedule[i]->first);
+    }
+  }
+  BOOST_CHECK_EQUAL(scheduledPairs.size(), putativeMatches.size());
+}
+
+BOOST_AUTO_TEST_CASE(GeometricFilter_robustModelEstimation)
+{
+  const matching::PairwiseMatches putativeMatches = makePutativeMatches(200);
+  const feature::RegionsPerView regionsPerView;
+  const int nbThreads = omp_get_max_threads();
+
+  // same result with any number of threads, with the pairs filtered in parallel or one by one
+  std::vector<matching::PairwiseMatches> geometricMatchesPerRun;
+  for(const std::pair<int, std::size_t>& run : {std::make_pair(1, 1), std::make_pair(4, 1), std::make_pair(4, 8)})
+  {
+    omp_set_num_threads(run.first);
+
+    RandomFilter filter;
+    filter.setACRansacBatchSize(run.second);
+
+    std::mt19937 randomNumberGenerator(42);
+    matching::PairwiseMatches geometricMatches;
+    GeometricFilterStats stats;
+    robustModelEstimation(geometricMatches, nullptr, regionsPerView, filter, putativeMatches,
+                          randomNumberGenerator, false, 0.6, &stats);
+
+    BOOST_CHECK_EQUAL(stats.pairs.size(), putativeMatches.size());
+    for(const GeometricFilterPairStats& pairStats : stats.pairs)
+    {
+      const auto it = geometricMatches.find(pairStats.pair);
+      const std::size_t nbGeometricMatches = (it == geometricMatches.end()) ? 0 : it->second.getNbAllMatches();
+      BOOST_CHECK_EQUAL(pairStats.nbPutativeMatches, putativeMatches.at(pairStats.pair).getNbAllMatches());
+      BOOST_CHECK_EQUAL(pairStats.nbGeometricMatches, nbGeometricMatches);
+      BOOST_CHECK(pairStats.time >= 0.0);
+    }
+    stats.log();
+
+    geometricMatchesPerRun.push_back(std::move(geometricMatches));
+  }
+  omp_set_num_threads(nbThreads);
+
+  BOOST_CHECK(!geometricMatchesPerRun.front().empty());
+  for(std::size_t i = 1; i < geometricMatchesPerRun.size(); ++i)
+    BOOST_CHECK(geometricMatchesPerRun.front() == geometricMatchesPerRun.at(i));
+}
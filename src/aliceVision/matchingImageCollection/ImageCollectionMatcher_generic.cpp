@@ -11,10 +11,15 @@
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
+#include <aliceVision/matchingImageCollection/RegionsMatcherCache.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
+#include <cstdint>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -22,11 +27,12 @@ using namespace aliceVision::matching;
 using namespace aliceVision::feature;
 
 ImageCollectionMatcher_generic::ImageCollectionMatcher_generic(
-  float distRatio, bool crossMatching, EMatcherType matcherType)
+  float distRatio, bool crossMatching, EMatcherType matcherType, std::size_t matcherCacheMaxMemorySize)
   : IImageCollectionMatcher()
   , _f_dist_ratio(distRatio)
   , _useCrossMatching(crossMatching)
   , _matcherType(matcherType)
+  , _matcherCacheMaxMemorySize(matcherCacheMaxMemorySize)
 {
 }
 
@@ -40,93 +46,120 @@ void ImageCollectionMatcher_generic::Match(
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
   ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
 #endif
-  const bool b_multithreaded_pair_search = (_matcherType == CASCADE_HASHING_L2);
-  // -> set to true for CASCADE_HASHING_L2, since OpenMP instructions are not used in this matcher
+  const std::size_t nbThreads = static_cast<std::size_t>(omp_get_max_threads());
 
   boost::progress_display my_progress_bar( pairs.size() );
 
-  // Sort pairs according the first index to minimize the MatcherT build operations
-  typedef std::map<size_t, std::vector<size_t> > Map_vectorT;
+  // Sort pairs according the first index and discard the pairs without regions to match
+  typedef std::map<IndexT, std::vector<IndexT> > Map_vectorT;
   Map_vectorT map_Pairs;
-  for (PairSet::const_iterator iter = pairs.begin(); iter != pairs.end(); ++iter)
-  {
-    map_Pairs[iter->first].push_back(iter->second);
-  }
-
-  // Perform matching between all the pairs
-  for (Map_vectorT::const_iterator iter = map_Pairs.begin();
-    iter != map_Pairs.end(); ++iter)
+  for (const Pair& pair : pairs)
   {
-    const size_t I = iter->first;
-    const std::vector<size_t> & indexToCompare = iter->second;
-
-    const feature::Regions & regionsI = regionsPerView.getRegions(I, descType);
-    if (regionsI.RegionCount() == 0)
+    const feature::Regions & regionsI = regionsPerView.getRegions(pair.first, descType);
+    const feature::Regions & regionsJ = regionsPerView.getRegions(pair.second, descType);
+    if (regionsI.RegionCount() == 0
+        || regionsJ.RegionCount() == 0
+        || regionsI.Type_id() != regionsJ.Type_id())
     {
-      my_progress_bar += indexToCompare.size();
+      ++my_progress_bar;
       continue;
     }
+    map_Pairs[pair.first].push_back(pair.second);
+  }
 
-    // Initialize the matching interface
-    matching::RegionsDatabaseMatcher matcher(randomNumberGenerator, _matcherType, regionsI);
+  // Schedule the pairs: the views are processed by windows of one view per thread
+  // and the pairs of the views of a window are interleaved.
+  // So the matchers of a window are built in parallel and only a few matchers are in use at the same time.
+  PairVec scheduledPairs;
+  scheduledPairs.reserve(pairs.size());
+  for (Map_vectorT::const_iterator windowBegin = map_Pairs.begin(); windowBegin != map_Pairs.end();)
+  {
+    Map_vectorT::const_iterator windowEnd = windowBegin;
+    for (std::size_t i = 0; i < nbThreads && windowEnd != map_Pairs.end(); ++i)
+      ++windowEnd;
 
-    #pragma omp parallel for schedule(dynamic) if(b_multithreaded_pair_search)
-    for (int j = 0; j < (int)indexToCompare.size(); ++j)
+    for (std::size_t k = 0; ; ++k)
     {
-      const size_t J = indexToCompare[j];
-
-      const feature::Regions &regionsJ = regionsPerView.getRegions(J, descType);
-      if (regionsJ.RegionCount() == 0
-          || regionsI.Type_id() != regionsJ.Type_id())
+      bool added = false;
+      for (Map_vectorT::const_iterator iter = windowBegin; iter != windowEnd; ++iter)
       {
-        #pragma omp critical
-        ++my_progress_bar;
-        continue;
+        if (k < iter->second.size())
+        {
+          scheduledPairs.emplace_back(iter->first, iter->second[k]);
+          added = true;
+        }
       }
+      if (!added)
+        break;
+    }
+    windowBegin = windowEnd;
+  }
 
-      IndMatches vec_putatives_matches;
-      matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
+  // The matchers are shared between the pairs and the threads
+  RegionsMatcherCache matcherCache(regionsPerView, descType, _matcherType, _matcherCacheMaxMemorySize,
+                                   static_cast<std::uint32_t>(randomNumberGenerator()));
 
-      if (_useCrossMatching)
-      {
-        // Initialize the matching interface
-        matching::RegionsDatabaseMatcher matcherCross(randomNumberGenerator, _matcherType, regionsJ);  
+  // The matchers parallelize the search of the neighbours internally (except CASCADE_HASHING_L2),
+  // so the pairs are only processed in parallel if there are enough pairs to use all the threads.
+  const bool b_multithreaded_pair_search = (_matcherType == CASCADE_HASHING_L2) || (scheduledPairs.size() >= nbThreads);
 
-        IndMatches vec_putatives_matches_cross;
-        matcherCross.Match(_f_dist_ratio, regionsI, vec_putatives_matches_cross);
+  // Perform matching between all the pairs
+  #pragma omp parallel for schedule(dynamic) if(b_multithreaded_pair_search)
+  for (int p = 0; p < (int)scheduledPairs.size(); ++p)
+  {
+    const IndexT I = scheduledPairs[p].first;
+    const IndexT J = scheduledPairs[p].second;
 
-        //Create a dictionnary of matches indexed by their pair of indexes
-        std::map<std::pair<int, int>, IndMatch> check_matches;
-        for (IndMatch & m : vec_putatives_matches_cross)
-        {
-          std::pair<int, int> key = std::make_pair(m._i, m._j);
-          check_matches[key] = m;
-        }
+    const feature::Regions & regionsI = regionsPerView.getRegions(I, descType);
+    const feature::Regions & regionsJ = regionsPerView.getRegions(J, descType);
 
-        IndMatches vec_putatives_matches_checked;
-        for (IndMatch & m : vec_putatives_matches)
-        {
-          //Check with reversed key (images are swapped)
-          std::pair<int, int> key = std::make_pair(m._j, m._i);
-          if (check_matches.find(key) != check_matches.end())
-          {
-            vec_putatives_matches_checked.push_back(m);
-          }
-        }
+    IndMatches vec_putatives_matches;
+    matcherCache.get(I)->Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
+
+    if (_useCrossMatching)
+    {
+      IndMatches vec_putatives_matches_cross;
+      matcherCache.get(J)->Match(_f_dist_ratio, regionsI, vec_putatives_matches_cross);
 
-        std::swap(vec_putatives_matches, vec_putatives_matches_checked);
+      // Sorted list of the cross matches with reversed indexes (images are swapped)
+      for (IndMatch & m : vec_putatives_matches_cross)
+      {
+        std::swap(m._i, m._j);
       }
+      std::sort(vec_putatives_matches_cross.begin(), vec_putatives_matches_cross.end());
 
-      #pragma omp critical
+      IndMatches vec_putatives_matches_checked;
+      for (const IndMatch & m : vec_putatives_matches)
       {
-        ++my_progress_bar;
-        if (!vec_putatives_matches.empty())
+        if (std::binary_search(vec_putatives_matches_cross.begin(), vec_putatives_matches_cross.end(), m))
         {
-          map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putatives_matches));
+          vec_putatives_matches_checked.push_back(m);
         }
       }
+
+      std::swap(vec_putatives_matches, vec_putatives_matches_checked);
+    }
+
+    #pragma omp critical
+    {
+      ++my_progress_bar;
+      if (!vec_putatives_matches.empty())
+      {
+        map_PutativesMatches[std::make_pair(I,J)].emplace(descType, std::move(vec_putatives_matches));
+      }
     }
   }
+
+  // Without the cache, a matcher was built for each first view and, with cross matching, for each pair
+  const RegionsMatcherCache::Stats stats = matcherCache.getStats();
+  const std::size_t nbUncachedBuilds = map_Pairs.size() + (_useCrossMatching ? scheduledPairs.size() : 0);
+
+  ALICEVISION_LOG_INFO("Matcher cache (" << EImageDescriberType_enumToString(descType) << "): "
+                       << "\n\t- # pairs: " << scheduledPairs.size()
+                       << "\n\t- # matcher builds: " << stats.nbBuilds
+                       << "\n\t- # matcher builds saved: " << static_cast<long long>(nbUncachedBuilds) - static_cast<long long>(stats.nbBuilds)
+                       << "\n\t- # matchers released: " << stats.nbEvictions
+                       << "\n\t- peak memory size: " << stats.peakMemorySize / (1024 * 1024) << " MB");
 }
 
 } // namespace aliceVision
@@ -9,6 +9,8 @@
 
 #include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
 
+#include <cstddef>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -18,6 +20,9 @@ namespace matchingImageCollection {
  * Spurious correspondences are discarded by using the
  * a threshold over the distance ratio of the 2 nearest neighbours.
  *
+ * The matchers built on the regions of each view are kept in a memory bounded cache shared
+ * by the threads, and the pairs are processed in parallel.
+ *
  * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
  */
 class ImageCollectionMatcher_generic : public IImageCollectionMatcher
@@ -26,7 +31,8 @@ class ImageCollectionMatcher_generic : public IImageCollectionMatcher
   ImageCollectionMatcher_generic(
     float dist_ratio,
     bool crossMatching,
-    matching::EMatcherType matcherType
+    matching::EMatcherType matcherType,
+    std::size_t matcherCacheMaxMemorySize = std::size_t(2048) * 1024 * 1024
   );
 
   /// Find corresponding points between some pair of view Ids
@@ -45,6 +51,8 @@ class ImageCollectionMatcher_generic : public IImageCollectionMatcher
   bool _useCrossMatching;
   // Matcher Type
   matching::EMatcherType _matcherType;
+  // Maximum estimated memory size of the cached matchers (in bytes)
+  std::size_t _matcherCacheMaxMemorySize;
 };
 
 } // namespace aliceVision
@@ -0,0 +1,126 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsMatcherCache.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <random>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+RegionsMatcherCache::RegionsMatcherCache(const feature::RegionsPerView& regionsPerView,
+                                         feature::EImageDescriberType descType,
+                                         matching::EMatcherType matcherType,
+                                         std::size_t maxMemorySize,
+                                         std::uint32_t seed)
+  : _regionsPerView(regionsPerView)
+  , _descType(descType)
+  , _matcherType(matcherType)
+  , _maxMemorySize(maxMemorySize)
+  , _seed(seed)
+{}
+
+std::shared_ptr<const matching::RegionsDatabaseMatcher> RegionsMatcherCache::get(IndexT viewId)
+{
+  std::promise<MatcherPtr> promise;
+  std::shared_future<MatcherPtr> matcher;
+  bool build = false;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_stats.nbRequests;
+
+    auto it = _entries.find(viewId);
+    if(it != _entries.end())
+    {
+      // move the view at the front of the LRU list
+      _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+      matcher = it->second.matcher;
+    }
+    else
+    {
+      Entry& entry = _entries[viewId];
+      entry.matcher = promise.get_future().share();
+      _lru.push_front(viewId);
+      entry.lruIt = _lru.begin();
+      matcher = entry.matcher;
+      build = true;
+      ++_stats.nbBuilds;
+    }
+  }
+
+  if(!build)
+    return matcher.get(); // wait if the matcher is being built by another thread
+
+  // build the matcher outside of the lock
+  const feature::Regions& regions = _regionsPerView.getRegions(viewId, _descType);
+  try
+  {
+    std::seed_seq seedSequence{_seed, static_cast<std::uint32_t>(viewId)};
+    std::mt19937 randomNumberGenerator(seedSequence);
+    promise.set_value(std::make_shared<const matching::RegionsDatabaseMatcher>(randomNumberGenerator, _matcherType, regions));
+  }
+  catch(...)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _entries.find(viewId);
+      _lru.erase(it->second.lruIt);
+      _entries.erase(it);
+    }
+    promise.set_exception(std::current_exception());
+    return matcher.get(); // rethrow
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _entries.at(viewId);
+    entry.ready = true;
+    entry.memorySize = estimateMemorySize(regions);
+    _memorySize += entry.memorySize;
+    _stats.peakMemorySize = std::max(_stats.peakMemorySize, _memorySize);
+    evict(viewId);
+  }
+
+  return matcher.get();
+}
+
+RegionsMatcherCache::Stats RegionsMatcherCache::getStats() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _stats;
+}
+
+std::size_t RegionsMatcherCache::estimateMemorySize(const feature::Regions& regions)
+{
+  return regions.RegionCount() * regions.DescriptorLength() * sizeof(float);
+}
+
+void RegionsMatcherCache::evict(IndexT protectedViewId)
+{
+  auto lruIt = _lru.end();
+  while(_memorySize > _maxMemorySize && lruIt != _lru.begin())
+  {
+    --lruIt;
+    const IndexT viewId = *lruIt;
+
+    auto it = _entries.find(viewId);
+
+    // matchers being built are not released
+    if(viewId == protectedViewId || !it->second.ready)
+      continue;
+
+    _memorySize -= it->second.memorySize;
+    lruIt = _lru.erase(lruIt);
+    _entries.erase(it);
+    ++_stats.nbEvictions;
+  }
+}
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
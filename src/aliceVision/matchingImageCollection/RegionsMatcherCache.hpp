@@ -0,0 +1,120 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/matching/matcherType.hpp>
+#include <aliceVision/matching/RegionsMatcher.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief Memory bounded cache of the matchers built on the regions of each view.
+ *
+ * The cache can be shared by several threads: each matcher is built only once by the
+ * first thread that requests it, the other threads wait for it.
+ * When the estimated memory size of the cached matchers exceeds the maximum size,
+ * the least recently used matchers are released. A released matcher stays alive
+ * as long as a thread is still using it.
+ *
+ * Each matcher is built with its own random number generator, seeded from the cache seed
+ * and the view id, so the results do not depend on the order of the requests.
+ */
+class RegionsMatcherCache
+{
+public:
+  /// Usage statistics of the cache
+  struct Stats
+  {
+    /// number of matcher requests
+    std::size_t nbRequests = 0;
+    /// number of matcher builds
+    std::size_t nbBuilds = 0;
+    /// number of matchers released to stay under the maximum size
+    std::size_t nbEvictions = 0;
+    /// peak estimated memory size of the cached matchers, before the evictions (in bytes)
+    std::size_t peakMemorySize = 0;
+  };
+
+  /**
+   * @brief RegionsMatcherCache constructor
+   * @param[in] regionsPerView the regions of all the views (must outlive the cache)
+   * @param[in] descType the describer type of the regions to match
+   * @param[in] matcherType the type of matcher to build
+   * @param[in] maxMemorySize the maximum estimated memory size of the cached matchers (in bytes)
+   * @param[in] seed the seed of the random number generators used to build the matchers
+   */
+  RegionsMatcherCache(const feature::RegionsPerView& regionsPerView,
+                      feature::EImageDescriberType descType,
+                      matching::EMatcherType matcherType,
+                      std::size_t maxMemorySize,
+                      std::uint32_t seed);
+
+  /**
+   * @brief Get the matcher using the regions of the given view as database.
+   * The matcher is built if it is not in the cache.
+   * @param[in] viewId the view id
+   * @return the matcher
+   */
+  std::shared_ptr<const matching::RegionsDatabaseMatcher> get(IndexT viewId);
+
+  /**
+   * @brief Get the usage statistics of the cache
+   * @return the statistics
+   */
+  Stats getStats() const;
+
+  /**
+   * @brief Estimate the memory size of a matcher.
+   * It is an approximation based on the number of regions and the descriptor length:
+   * the matchers indexing the regions store one or several values per descriptor component.
+   * @param[in] regions the database regions of the matcher
+   * @return the estimated memory size (in bytes)
+   */
+  static std::size_t estimateMemorySize(const feature::Regions& regions);
+
+private:
+  typedef std::shared_ptr<const matching::RegionsDatabaseMatcher> MatcherPtr;
+
+  struct Entry
+  {
+    std::shared_future<MatcherPtr> matcher;
+    std::size_t memorySize = 0;
+    bool ready = false;
+    std::list<IndexT>::iterator lruIt;
+  };
+
+  /// Release the least recently used ready matchers until the cache fits in the maximum size
+  void evict(IndexT protectedViewId);
+
+  const feature::RegionsPerView& _regionsPerView;
+  const feature::EImageDescriberType _descType;
+  const matching::EMatcherType _matcherType;
+  const std::size_t _maxMemorySize;
+  const std::uint32_t _seed;
+
+  mutable std::mutex _mutex;
+  std::map<IndexT, Entry> _entries;
+  /// view ids from the most recently used to the least recently used
+  std::list<IndexT> _lru;
+  std::size_t _memorySize = 0;
+  Stats _stats;
+};
+
+} // namespace matchingImageCollection
+} // namespace aliceVision
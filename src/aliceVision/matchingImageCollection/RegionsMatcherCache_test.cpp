@@ -0,0 +1,159 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matchingImageCollection/RegionsMatcherCache.hpp>
+#include <aliceVision/matchingImageCollection/ImageCollectionMatcher_generic.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+#define BOOST_TEST_MODULE matchingImageCollectionRegionsMatcherCache
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+const feature::EImageDescriberType descType = feature::EImageDescriberType::SIFT;
+
+/// Fill a RegionsPerView with noisy copies of the same random SIFT regions
+void fillRandomRegions(feature::RegionsPerView& regionsPerView, std::size_t nbViews, std::size_t nbRegions)
+{
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> descDistribution(0, 255);
+  std::uniform_int_distribution<int> noiseDistribution(-10, 10);
+  std::uniform_real_distribution<float> posDistribution(0.f, 1000.f);
+
+  std::vector<feature::SIFT_Regions::DescriptorT> descriptors(nbRegions);
+  for(feature::SIFT_Regions::DescriptorT& desc : descriptors)
+    for(std::size_t k = 0; k < desc.size(); ++k)
+      desc[k] = static_cast<unsigned char>(descDistribution(generator));
+
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    std::unique_ptr<feature::SIFT_Regions> regions(new feature::SIFT_Regions());
+    for(const feature::SIFT_Regions::DescriptorT& desc : descriptors)
+    {
+      regions->Features().emplace_back(posDistribution(generator), posDistribution(generator), 1.f, 0.f);
+      feature::SIFT_Regions::DescriptorT noisyDesc;
+      for(std::size_t k = 0; k < desc.size(); ++k)
+        noisyDesc[k] = static_cast<unsigned char>(std::min(255, std::max(0, desc[k] + noiseDistribution(generator))));
+      regions->Descriptors().push_back(noisyDesc);
+    }
+    regionsPerView.getData()[viewId][descType] = std::move(regions);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(RegionsMatcherCache_buildOnce)
+{
+  feature::RegionsPerView regionsPerView;
+  fillRandomRegions(regionsPerView, 4, 100);
+
+  RegionsMatcherCache cache(regionsPerView, descType, matching::BRUTE_FORCE_L2, std::numeric_limits<std::size_t>::max(), 0);
+
+  std::vector<std::shared_ptr<const matching::RegionsDatabaseMatcher>> matchers(4 * 16);
+
+  #pragma omp parallel for
+  for(int i = 0; i < (int)matchers.size(); ++i)
+    matchers[i] = cache.get(i % 4);
+
+  for(std::size_t i = 0; i < matchers.size(); ++i)
+  {
+    BOOST_CHECK(matchers[i] == matchers[i % 4]);
+    BOOST_CHECK(&matchers[i]->getDatabaseRegions() == &regionsPerView.getRegions(i % 4, descType));
+  }
+
+  const RegionsMatcherCache::Stats stats = cache.getStats();
+  BOOST_CHECK_EQUAL(stats.nbRequests, matchers.size());
+  BOOST_CHECK_EQUAL(stats.nbBuilds, 4);
+  BOOST_CHECK_EQUAL(stats.nbEvictions, 0);
+  BOOST_CHECK_EQUAL(stats.peakMemorySize, 4 * RegionsMatcherCache::estimateMemorySize(regionsPerView.getRegions(0, descType)));
+}
+
+BOOST_AUTO_TEST_CASE(RegionsMatcherCache_eviction)
+{
+  feature::RegionsPerView regionsPerView;
+  fillRandomRegions(regionsPerView, 4, 100);
+
+  // room for 2 matchers
+  const std::size_t matcherSize = RegionsMatcherCache::estimateMemorySize(regionsPerView.getRegions(0, descType));
+  RegionsMatcherCache cache(regionsPerView, descType, matching::BRUTE_FORCE_L2, 2 * matcherSize, 0);
+
+  std::shared_ptr<const matching::RegionsDatabaseMatcher> matcher0 = cache.get(0);
+  cache.get(1);
+  BOOST_CHECK(cache.get(0) == matcher0);
+  cache.get(2); // view 1 is released
+  BOOST_CHECK(cache.get(0) == matcher0);
+  cache.get(1); // view 2 is released
+
+  RegionsMatcherCache::Stats stats = cache.getStats();
+  BOOST_CHECK_EQUAL(stats.nbBuilds, 4);
+  BOOST_CHECK_EQUAL(stats.nbEvictions, 2);
+  BOOST_CHECK_EQUAL(stats.peakMemorySize, 3 * matcherSize); // before the eviction
+
+  cache.get(3); // view 0 is released, but the matcher stays valid
+  BOOST_CHECK(cache.get(0) != matcher0);
+  BOOST_CHECK(&matcher0->getDatabaseRegions() == &regionsPerView.getRegions(0, descType));
+
+  stats = cache.getStats();
+  BOOST_CHECK_EQUAL(stats.nbBuilds, 6);
+  BOOST_CHECK_EQUAL(stats.peakMemorySize, 3 * matcherSize);
+}
+
+BOOST_AUTO_TEST_CASE(ImageCollectionMatcher_generic_crossMatching)
+{
+  feature::RegionsPerView regionsPerView;
+  fillRandomRegions(regionsPerView, 6, 200);
+
+  PairSet pairs;
+  for(IndexT i = 0; i < 6; ++i)
+    for(IndexT j = i + 1; j < 6; ++j)
+      pairs.emplace(i, j);
+
+  // the cache is large enough for all the matchers or for a single matcher
+  for(std::size_t cacheSize : {std::numeric_limits<std::size_t>::max(), std::size_t(1)})
+  {
+    ImageCollectionMatcher_generic imageCollectionMatcher(0.8f, true, matching::BRUTE_FORCE_L2, cacheSize);
+    std::mt19937 randomNumberGenerator(0);
+    matching::PairwiseMatches pairwiseMatches;
+    imageCollectionMatcher.Match(randomNumberGenerator, regionsPerView, pairs, descType, pairwiseMatches);
+
+    // compare to a symmetric matching without cache
+    std::size_t nbPairs = 0;
+    for(const Pair& pair : pairs)
+    {
+      const feature::Regions& regionsI = regionsPerView.getRegions(pair.first, descType);
+      const feature::Regions& regionsJ = regionsPerView.getRegions(pair.second, descType);
+
+      matching::IndMatches matches, crossMatches, expectedMatches;
+      matching::DistanceRatioMatch(randomNumberGenerator, 0.8f, matching::BRUTE_FORCE_L2, regionsI, regionsJ, matches);
+      matching::DistanceRatioMatch(randomNumberGenerator, 0.8f, matching::BRUTE_FORCE_L2, regionsJ, regionsI, crossMatches);
+
+      for(const matching::IndMatch& m : matches)
+      {
+        if(std::find(crossMatches.begin(), crossMatches.end(), matching::IndMatch(m._j, m._i)) != crossMatches.end())
+          expectedMatches.push_back(m);
+      }
+
+      if(expectedMatches.empty())
+      {
+        BOOST_CHECK(pairwiseMatches.count(pair) == 0);
+        continue;
+      }
+
+      ++nbPairs;
+      BOOST_REQUIRE(pairwiseMatches.count(pair) == 1);
+      BOOST_CHECK(pairwiseMatches.at(pair).at(descType) == expectedMatches);
+    }
+    BOOST_CHECK_EQUAL(pairwiseMatches.size(), nbPairs);
+  }
+}
@@ -10,6 +10,7 @@
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -26,7 +27,10 @@
 
 #include <boost/algorithm/string/case_conv.hpp> 
 
+#include <deque>
+#include <future>
 #include <map>
+#include <memory>
 #include <set>
 
 // Debug mode: save atlases decomposition in frequency bands and
@@ -301,6 +305,12 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     ALICEVISION_LOG_INFO("Total amount of an atlas pyramid in memory: " << atlasPyramidMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Processing " << nbAtlas << " atlases by chunks of " << nbAtlasMax);
 
+    // the atlas pyramids are moved to the background writes, only the temporary buffers of the hole filling
+    // and downscaling (about twice an atlas) are needed on top of them for each texture written in parallel
+    const int writeMem = availableMem - nbAtlasMax * int(atlasPyramidMaxMemSize);
+    const std::size_t nbParallelWrites = clamp(writeMem / std::max(1, 2 * int(atlasContribMemSize)), 1, omp_get_max_threads());
+    ALICEVISION_LOG_INFO("Writing up to " << nbParallelWrites << " texture files in parallel.");
+
     //generateTexture for the maximum number of atlases, and iterate
     const std::div_t divresult = div(nbAtlas, nbAtlasMax);
     std::vector<size_t> atlasIDs;
@@ -317,18 +327,19 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
             atlasIDs.push_back(atlasID);
         }
         ALICEVISION_LOG_INFO("Generating texture for atlases " << n*nbAtlasMax + 1 << " to " << n*nbAtlasMax+imax );
-        generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType);
+        generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType, nbParallelWrites);
     }
+
+    imageCache.logStats();
 }
 
 void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
-                                const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache, const bfs::path& outPath, imageIO::EImageFileType textureFileType)
+                                const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache, const bfs::path& outPath, imageIO::EImageFileType textureFileType,
+                                std::size_t nbParallelWrites)
 {
     if(atlasIDs.size() > _atlases.size())
         throw std::runtime_error("Invalid atlas IDs ");
 
-    unsigned int textureSize = texParams.textureSide * texParams.textureSide;
-
     // We select the best cameras for each triangle and store it per camera for each output texture files.
     // Triangles contributions are stored per frequency bands for multi-band blending.
     using AtlasIndex = size_t;
@@ -469,6 +480,40 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
     for(std::size_t atlasID: atlasIDs)
         accuPyramids[atlasID].init(texParams.nbBand, texParams.textureSide, texParams.textureSide);
 
+    // last contributing camera of each texture file, to write it as soon as it is complete
+    std::vector<std::vector<AtlasIndex>> atlasesPerLastCamera(contributionsPerCamera.size());
+    std::vector<AtlasIndex> atlasesWithoutContribution;
+    for(std::size_t atlasID: atlasIDs)
+    {
+        int lastCamId = -1;
+        for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
+        {
+            if(contributionsPerCamera[camId].count(atlasID))
+                lastCamId = camId;
+        }
+        if(lastCamId < 0)
+            atlasesWithoutContribution.push_back(atlasID);
+        else
+            atlasesPerLastCamera[lastCamId].push_back(atlasID);
+    }
+
+    // the texture files are computed and written in the background, while the next cameras are processed
+    std::deque<std::future<void>> pendingTextures;
+    const auto writeTextureAsync = [&](AtlasIndex atlasID) {
+        if(pendingTextures.size() >= nbParallelWrites)
+        {
+            pendingTextures.front().get();
+            pendingTextures.pop_front();
+        }
+        std::shared_ptr<AccuPyramid> accuPyramid = std::make_shared<AccuPyramid>(std::move(accuPyramids.at(atlasID)));
+        accuPyramids.erase(atlasID);
+        pendingTextures.push_back(std::async(std::launch::async, [this, accuPyramid, atlasID, &outPath, textureFileType]() {
+            finalizeTexture(*accuPyramid, atlasID, outPath, textureFileType);
+        }));
+    };
+    for(AtlasIndex atlasID : atlasesWithoutContribution)
+        writeTextureAsync(atlasID);
+
     //for each camera, for each texture, iterate over triangles and fill the accuPyramids map
     for(int camId = 0; camId < contributionsPerCamera.size(); ++camId)
     {
@@ -485,14 +530,36 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
         mvsUtils::ImagesCache::ImgSharedPtr imgPtr = imageCache.getImg_sync(camId);
         const Image& camImg = *imgPtr;
 
+        // load the next used camera image in the background while this one is processed
+        for(int nextCamId = camId + 1; nextCamId < contributionsPerCamera.size(); ++nextCamId)
+        {
+            if(!contributionsPerCamera[nextCamId].empty())
+            {
+                imageCache.prefetch(nextCamId);
+                break;
+            }
+        }
+
         // Calculate laplacianPyramid
         std::vector<Image> pyramidL; //laplacian pyramid
         camImg.laplacianPyramid(pyramidL, texParams.nbBand, texParams.multiBandDownscale);
 
-        // for each output texture file
+        // the output texture files are filled in parallel, each one by a group of threads
+        std::vector<const std::pair<const AtlasIndex, std::vector<ScorePerTriangle>>*> contributions;
         for(const auto& c : cameraContributions)
+            contributions.push_back(&c);
+        const int nbThreads = omp_get_max_threads();
+        const int nbAtlasThreads = std::min(int(contributions.size()), nbThreads);
+        const int nbTriangleThreads = std::max(1, nbThreads / nbAtlasThreads);
+
+        omp_set_nested(1);
+        // for each output texture file
+        #pragma omp parallel for schedule(dynamic) num_threads(nbAtlasThreads)
+        for(int ci = 0; ci < contributions.size(); ++ci)
         {
+            const auto& c = *contributions[ci];
             AtlasIndex atlasID = c.first;
+            AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
             ALICEVISION_LOG_INFO("  - Texture file: " << atlasID + 1);
             //for each frequency band
             for(int band = 0; band < c.second.size(); ++band)
@@ -501,7 +568,7 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                 ALICEVISION_LOG_INFO("      - band " << band + 1 << ": " << trianglesId.size() << " triangles.");
 
                 // for each triangle
-                #pragma omp parallel for
+                #pragma omp parallel for num_threads(nbTriangleThreads)
                 for(int ti = 0; ti < trianglesId.size(); ++ti)
                 {
                     const unsigned int triangleId = std::get<0>(trianglesId[ti]);
@@ -578,7 +645,6 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 
                            // Fill the accumulated pyramid for this pixel
                            // each frequency band also contributes to lower frequencies (higher band indexes)
-                           AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
                            for(std::size_t bandContrib = band; bandContrib < pyramidL.size(); ++bandContrib)
                            {
                                int downscaleCoef = std::pow(texParams.multiBandDownscale, bandContrib);
@@ -593,102 +659,110 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                 }
             }
         }
+        omp_set_nested(0);
+
+        // write the texture files without remaining contribution
+        for(AtlasIndex atlasID : atlasesPerLastCamera[camId])
+            writeTextureAsync(atlasID);
     }
 
+    for(std::future<void>& pendingTexture : pendingTextures)
+        pendingTexture.get();
+}
+
+void Texturing::finalizeTexture(AccuPyramid& accuPyramid, const std::size_t atlasID, const bfs::path& outPath,
+                                imageIO::EImageFileType textureFileType)
+{
     //calculate atlas texture in the first level of the pyramid (avoid creating a new buffer)
     //debug mode : write all the frequencies levels for each texture
-    for(std::size_t atlasID : atlasIDs)
-    {
-        AccuPyramid& accuPyramid = accuPyramids.at(atlasID);
-        AccuImage& atlasTexture = accuPyramid.pyramid[0];
-        ALICEVISION_LOG_INFO("Create texture " << atlasID + 1);
+    AccuImage& atlasTexture = accuPyramid.pyramid[0];
+    ALICEVISION_LOG_INFO("Create texture " << atlasID + 1);
 
 #if TEXTURING_MBB_DEBUG
+    {
+        // write the number of contribution per atlas frequency bands
+        if(!texParams.useScore)
         {
-            // write the number of contribution per atlas frequency bands
-            if(!texParams.useScore)
+            for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
             {
-                for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
+                AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
 
-                    //write the number of contributions for each texture
-                    std::vector<float> imgContrib(textureSize);
+                //write the number of contributions for each texture
+                std::vector<float> imgContrib(texParams.textureSide * texParams.textureSide);
 
-                    for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+                for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+                {
+                    unsigned int yoffset = yp * texParams.textureSide;
+                    for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
                     {
-                        unsigned int yoffset = yp * texParams.textureSide;
-                        for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
-                        {
-                            unsigned int xyoffset = yoffset + xp;
-                            imgContrib[xyoffset] = atlasLevelTexture.imgCount[xyoffset];
-                        }
+                        unsigned int xyoffset = yoffset + xp;
+                        imgContrib[xyoffset] = atlasLevelTexture.imgCount[xyoffset];
                     }
+                }
 
-                    const std::string textureName = "contrib_" + std::to_string(1001 + atlasID) + std::string("_") + std::to_string(level) + std::string(".") + EImageFileType_enumToString(textureFileType); // starts at '1001' for UDIM compatibility
-                    bfs::path texturePath = outPath / textureName;
+                const std::string textureName = "contrib_" + std::to_string(1001 + atlasID) + std::string("_") + std::to_string(level) + std::string(".") + EImageFileType_enumToString(textureFileType); // starts at '1001' for UDIM compatibility
+                bfs::path texturePath = outPath / textureName;
 
-                    using namespace imageIO;
-                    OutputFileColorSpace colorspace(EImageColorSpace::SRGB, EImageColorSpace::AUTO);
-                    if(texParams.convertLAB)
-                        colorspace.from = EImageColorSpace::LAB;
-                    writeImage(texturePath.string(), texParams.textureSide, texParams.textureSide, imgContrib, EImageQuality::OPTIMIZED, colorspace);
-                }
+                using namespace imageIO;
+                OutputFileColorSpace colorspace(EImageColorSpace::SRGB, EImageColorSpace::AUTO);
+                if(texParams.convertLAB)
+                    colorspace.from = EImageColorSpace::LAB;
+                writeImage(texturePath.string(), texParams.textureSide, texParams.textureSide, imgContrib, EImageQuality::OPTIMIZED, colorspace);
             }
         }
+    }
 #endif
 
-        ALICEVISION_LOG_INFO("  - Computing final (average) color.");
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+    ALICEVISION_LOG_INFO("  - Computing final (average) color.");
+    for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+    {
+        unsigned int yoffset = yp * texParams.textureSide;
+        for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
         {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
-            {
-                unsigned int xyoffset = yoffset + xp;
+            unsigned int xyoffset = yoffset + xp;
 
-                // If the imgCount is valid on the first band, it will be valid on all the other bands
-                if(atlasTexture.imgCount[xyoffset] == 0)
-                    continue;
+            // If the imgCount is valid on the first band, it will be valid on all the other bands
+            if(atlasTexture.imgCount[xyoffset] == 0)
+                continue;
 
-                atlasTexture.img[xyoffset] /= atlasTexture.imgCount[xyoffset];
-                atlasTexture.imgCount[xyoffset] = 1;
+            atlasTexture.img[xyoffset] /= atlasTexture.imgCount[xyoffset];
+            atlasTexture.imgCount[xyoffset] = 1;
 
-                for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasLevelTexture.img[xyoffset] /= atlasLevelTexture.imgCount[xyoffset];
-                }
+            for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
+            {
+                AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
+                atlasLevelTexture.img[xyoffset] /= atlasLevelTexture.imgCount[xyoffset];
             }
         }
+    }
 
 #if TEXTURING_MBB_DEBUG
+    {
+        //write each frequency band, for each texture
+        for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
         {
-            //write each frequency band, for each texture
-            for(std::size_t level = 0; level < accuPyramid.pyramid.size(); ++level)
-            {
-                AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                writeTexture(atlasLevelTexture, atlasID, outPath, textureFileType, level);
-            }
-
+            AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
+            writeTexture(atlasLevelTexture, atlasID, outPath, textureFileType, level);
         }
+
+    }
 #endif
 
-        // Fuse frequency bands into the first buffer, calculate final texture
-        for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+    // Fuse frequency bands into the first buffer, calculate final texture
+    for(unsigned int yp = 0; yp < texParams.textureSide; ++yp)
+    {
+        unsigned int yoffset = yp * texParams.textureSide;
+        for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
         {
-            unsigned int yoffset = yp * texParams.textureSide;
-            for(unsigned int xp = 0; xp < texParams.textureSide; ++xp)
+            unsigned int xyoffset = yoffset + xp;
+            for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
             {
-                unsigned int xyoffset = yoffset + xp;
-                for(std::size_t level = 1; level < accuPyramid.pyramid.size(); ++level)
-                {
-                    AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
-                    atlasTexture.img[xyoffset] += atlasLevelTexture.img[xyoffset];
-                }
+                AccuImage& atlasLevelTexture =  accuPyramid.pyramid[level];
+                atlasTexture.img[xyoffset] += atlasLevelTexture.img[xyoffset];
             }
         }
-        writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
     }
+    writeTexture(atlasTexture, atlasID, outPath, textureFileType, -1);
 }
 
 void Texturing::writeTexture(AccuImage& atlasTexture, const std::size_t atlasID, const boost::filesystem::path &outPath,
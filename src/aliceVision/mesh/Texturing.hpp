@@ -181,10 +181,22 @@ public:
     void generateTextures(const mvsUtils::MultiViewParams& mp,
                           const bfs::path &outPath, imageIO::EImageFileType textureFileType = imageIO::EImageFileType::PNG);
 
-    /// Generate texture files for the given sub-set of texture atlases
+    /**
+     * @brief Generate texture files for the given sub-set of texture atlases
+     *
+     * The atlases contributions of each camera are accumulated in parallel, while the next camera image is loaded.
+     * Each texture file is written in the background as soon as its last contributing camera has been processed.
+     *
+     * @param[in] nbParallelWrites Max number of texture files computed and written in the background at the same time
+     */
     void generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
                          const std::vector<size_t>& atlasIDs, mvsUtils::ImagesCache& imageCache,
-                         const bfs::path &outPath, imageIO::EImageFileType textureFileType = imageIO::EImageFileType::PNG);
+                         const bfs::path &outPath, imageIO::EImageFileType textureFileType = imageIO::EImageFileType::PNG,
+                         std::size_t nbParallelWrites = 1);
+
+    /// Fuse the frequency bands of the accumulated pyramid and write the texture file of the given texture atlas
+    void finalizeTexture(AccuPyramid& accuPyramid, const std::size_t atlasID, const bfs::path& outPath,
+                         imageIO::EImageFileType textureFileType);
 
     ///Fill holes and write texture files for the given texture atlas
     void writeTexture(AccuImage& atlasTexture, const std::size_t atlasID, const bfs::path& outPath,
@@ -205,7 +205,8 @@ void readImage(const std::string& path,
                int& width,
                int& height,
                std::vector<T>& buffer,
-               EImageColorSpace toColorSpace)
+               EImageColorSpace toColorSpace,
+               int downscale = 1)
 {
     ALICEVISION_LOG_DEBUG("[IO] Read Image: " << path);
 
@@ -225,9 +226,27 @@ void readImage(const std::string& path,
     configSpec.attribute("raw:ColorSpace", "Linear");   // want linear colorspace with sRGB primaries
 #endif
 
-    oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
+    // when downscaled, read the finest reduced-resolution level of the file (if any) which is large enough
+    int miplevel = 0;
+    int outWidth = 0;
+    int outHeight = 0;
+    if(downscale > 1)
+    {
+        std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::open(path, &configSpec));
+
+        if(!in)
+            throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+        outWidth = in->spec().width / downscale;
+        outHeight = in->spec().height / downscale;
+        while(in->seek_subimage(0, miplevel + 1) && in->spec().width >= outWidth && in->spec().height >= outHeight)
+            ++miplevel;
+        in->close();
+    }
 
-    inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+    oiio::ImageBuf inBuf(path, 0, miplevel, NULL, &configSpec);
+
+    inBuf.read(0, miplevel, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
 
     if(!inBuf.initialized())
         throw std::runtime_error("Cannot find/open image file '" + path + "'.");
@@ -300,10 +319,17 @@ void readImage(const std::string& path,
         inBuf.copy(requestedBuf);
     }
 
-    width = inSpec.width;
-    height = inSpec.height;
+    if(downscale > 1 && (inBuf.spec().width != outWidth || inBuf.spec().height != outHeight))
+    {
+        oiio::ImageBuf resizedBuf;
+        oiio::ImageBufAlgo::resize(resizedBuf, inBuf, "", 0, oiio::ROI(0, outWidth, 0, outHeight, 0, 1, 0, inBuf.spec().nchannels));
+        inBuf.swap(resizedBuf);
+    }
+
+    width = inBuf.spec().width;
+    height = inBuf.spec().height;
 
-    buffer.resize(inSpec.width * inSpec.height);
+    buffer.resize(width * height);
 
     {
         oiio::ROI exportROI = inBuf.roi();
@@ -339,10 +365,10 @@ void readImage(const std::string& path, int& width, int& height, std::vector<Col
     readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, buffer, toColorSpace);
 }
 
-void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace)
+void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace, int downscale)
 {
     int width, height;
-    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace);
+    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace, downscale);
     image.setWidth(width);
     image.setHeight(height);
 }
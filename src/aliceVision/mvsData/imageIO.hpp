@@ -193,7 +193,16 @@ void readImage(const std::string& path, int& width, int& height, std::vector<uns
 void readImage(const std::string& path, int& width, int& height, std::vector<rgb>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<float>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<Color>& buffer, EImageColorSpace toColorSpace);
-void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace);
+
+/**
+ * @brief read an image with a given path, downscaled while reading
+ * @param[in] path The given path to the image
+ * @param[out] image The output image (of size the image size divided by the downscale factor)
+ * @param[in] toColorSpace The output color space
+ * @param[in] downscale The downscale factor, the finest reduced-resolution level of the file (MIP-mapped EXR or TIFF)
+ *            which is large enough is read and resized
+ */
+void readImage(const std::string& path, Image& image, EImageColorSpace toColorSpace, int downscale = 1);
 
 /**
  * @brief write an image with a given path and buffer
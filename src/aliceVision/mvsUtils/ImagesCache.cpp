@@ -8,6 +8,8 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <future>
 
 namespace aliceVision {
@@ -47,93 +49,325 @@ ImagesCache::ImagesCache(const MultiViewParams* mp, imageIO::EImageColorSpace co
     initIC( imagesNames );
 }
 
+ImagesCache::~ImagesCache()
+{
+    stopLoaders();
+}
+
 void ImagesCache::initIC( std::vector<std::string>& imagesNames )
 {
-    float oneimagemb = (sizeof(Color) * _mp->getMaxImageWidth() * _mp->getMaxImageHeight()) / 1024.f / 1024.f;
-    float maxmbCPU = (float)_mp->userParams.get<int>("images_cache.maxmbCPU", 5000);
-    int npreload = std::max((int)(maxmbCPU / oneimagemb), 5); // image cache has a minimum size of 5
-    npreload = std::min(_mp->ncams, npreload);
+    const std::size_t oneImageBytes = maxImageBytes();
+    const float maxmbCPU = (float)_mp->userParams.get<int>("images_cache.maxmbCPU", 5000);
+    std::size_t maxBytes = static_cast<std::size_t>(maxmbCPU * 1024.f * 1024.f);
+    maxBytes = std::max(maxBytes, 5 * oneImageBytes); // image cache has a minimum size of 5 images
+    maxBytes = std::min(maxBytes, _mp->ncams * oneImageBytes);
 
     for(int rc = 0; rc < _mp->ncams; rc++)
     {
         _imagesNames.push_back(imagesNames[rc]);
     }
 
-    _camIdMapId.resize( _mp->ncams, -1 );
-    setCacheSize(npreload);
+    _entries.resize(_mp->ncams);
+    _nbLoaders = _mp->userParams.get<int>("images_cache.nbLoaders", 2);
+    setCacheBudget(maxBytes);
+}
 
-    {
-        // Cannot resize the vector<mutex> directly, as mutex class is not move-constructible.
-        // imagesMutexes.resize(mp->ncams); // cannot compile
-        // So, we do the same with a new vector and swap.
-        std::vector<std::mutex> imagesMutexesTmp(_mp->ncams);
-        _imagesMutexes.swap(imagesMutexesTmp);
-    }
+std::size_t ImagesCache::maxImageBytes() const
+{
+    return sizeof(Color) * static_cast<std::size_t>(_mp->getMaxImageWidth()) * static_cast<std::size_t>(_mp->getMaxImageHeight());
+}
 
+void ImagesCache::setCacheSize(int nbPreload)
+{
+    setCacheBudget(std::max(nbPreload, 1) * maxImageBytes());
+}
 
+void ImagesCache::setCacheBudget(std::size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxBytes = maxBytes;
+    makeRoom(0);
+    ALICEVISION_LOG_DEBUG("Image cache budget: " << (_maxBytes / (1024 * 1024)) << " MB.");
 }
 
-void ImagesCache::setCacheSize(int nbPreload)
+void ImagesCache::setNbLoaders(int nbLoaders)
 {
-    _N_PRELOADED_IMAGES = nbPreload;
-    _imgs.resize(_N_PRELOADED_IMAGES);
-    _mapIdCamId.resize( _N_PRELOADED_IMAGES, -1 );
-    _mapIdClock.resize( _N_PRELOADED_IMAGES, clock() );
+    stopLoaders();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _nbLoaders = std::max(nbLoaders, 0);
 }
 
-void ImagesCache::refreshData(int camId)
+bool ImagesCache::makeRoom(std::size_t bytes, bool prefetching)
 {
-    // printf("camId %i\n",camId);
-    // test if the image is in the memory
-    if(_camIdMapId[camId] == -1)
+    while(_usedBytes + bytes > _maxBytes)
     {
-        // remove the oldest one
-        int mapId = _mapIdClock.minValId();
-        int oldCamId = _mapIdCamId[mapId];
-        if(oldCamId>=0)
-            _camIdMapId[oldCamId] = -1;
-            // TODO: oldCamId should be protected if already used
-
-        // replace with new new
-        _camIdMapId[camId] = mapId;
-        _mapIdCamId[mapId] = camId;
-        _mapIdClock[mapId] = clock();
-
-        // reload data from files
-        long t1 = clock();
-        if (_imgs[mapId] == nullptr)
+        // least recently used image which is not referenced outside of the cache
+        int lruCamId = -1;
+        for(int camId = 0; camId < static_cast<int>(_entries.size()); ++camId)
         {
-            const int maxWidth = _mp->getMaxImageWidth();
-            const int maxHeight = _mp->getMaxImageHeight();
-            _imgs[mapId] = std::make_shared<Image>(maxWidth, maxHeight);
+            const CacheEntry& e = _entries[camId];
+            if(e.state == EState::LOADED && e.img.use_count() == 1 && !(prefetching && e.current) &&
+               (lruCamId == -1 || e.lastUse < _entries[lruCamId].lastUse))
+                lruCamId = camId;
         }
 
-        const std::string imagePath = _imagesNames.at(camId);
-        loadImage(imagePath, _mp, camId, *(_imgs[mapId]), _colorspace, _correctEV);
+        // all the images in memory are in use, exceed the budget
+        if(lruCamId == -1)
+            return false;
+
+        CacheEntry& e = _entries[lruCamId];
+        _usedBytes -= e.bytes;
+        if(static_cast<int>(_recycledImgs.size()) <= _nbLoaders)
+            _recycledImgs.push_back(e.img);
+        e.img.reset();
+        e.bytes = 0;
+        e.state = EState::NOT_LOADED;
+        ++_stats.evictions;
+
+        ALICEVISION_LOG_DEBUG("Remove " << _imagesNames.at(lruCamId) << " from image cache.");
+    }
+    return true;
+}
+
+bool ImagesCache::loadEntry(std::unique_lock<std::mutex>& lock, int camId, bool prefetching)
+{
+    CacheEntry& e = _entries[camId];
+
+    // reserve the maximum image size until the real size is known
+    const std::size_t reservedBytes = maxImageBytes();
+    if(!makeRoom(reservedBytes, prefetching) && prefetching)
+    {
+        // the image will be loaded on request
+        e.state = EState::NOT_LOADED;
+        return false;
+    }
+    e.state = EState::LOADING;
+    _usedBytes += reservedBytes;
 
+    ImgSharedPtr img;
+    if(!_recycledImgs.empty())
+    {
+        img = _recycledImgs.back();
+        _recycledImgs.pop_back();
+    }
+
+    lock.unlock();
+
+    // reload data from files
+    const std::string& imagePath = _imagesNames.at(camId);
+    try
+    {
+        long t1 = clock();
+        if(img == nullptr)
+            img = std::make_shared<Image>();
+        loadImage(imagePath, _mp, camId, *img, _colorspace, _correctEV);
         ALICEVISION_LOG_DEBUG("Add " << imagePath << " to image cache. " << formatElapsedTime(t1));
     }
+    catch(...)
+    {
+        lock.lock();
+        _usedBytes -= reservedBytes;
+        e.state = EState::NOT_LOADED;
+        _loadedCond.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    e.img = img;
+    e.bytes = sizeof(Color) * static_cast<std::size_t>(img->width()) * static_cast<std::size_t>(img->height());
+    _usedBytes = _usedBytes - reservedBytes + e.bytes;
+    e.lastUse = ++_clock;
+    e.state = EState::LOADED;
+    _loadedCond.notify_all();
+    return true;
+}
+
+ImagesCache::ImgSharedPtr ImagesCache::getImg_sync(int camId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    CacheEntry& e = _entries[camId];
+
+    if(e.state == EState::LOADED)
+    {
+        ++_stats.hits;
+        ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache.");
+    }
     else
     {
-      ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+        const auto t1 = std::chrono::steady_clock::now();
+        bool counted = false;
+
+        while(e.state != EState::LOADED)
+        {
+            if(e.state == EState::LOADING)
+            {
+                // loaded by another thread (prefetch or concurrent request)
+                if(!counted)
+                    ++_stats.waits;
+                counted = true;
+                _loadedCond.wait(lock);
+            }
+            else
+            {
+                if(!counted)
+                    ++_stats.misses;
+                counted = true;
+                if(e.state == EState::QUEUED)
+                    _prefetchQueue.erase(std::find(_prefetchQueue.begin(), _prefetchQueue.end(), camId));
+                loadEntry(lock, camId);
+            }
+        }
+        _stats.waitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
     }
+
+    e.lastUse = ++_clock;
+    return e.img;
+}
+
+void ImagesCache::refreshData(int camId)
+{
+    getImg_sync(camId);
 }
+
 void ImagesCache::refreshData_sync(int camId)
 {
-  std::lock_guard<std::mutex> lock(_imagesMutexes[camId]);
-  refreshData(camId);
+    getImg_sync(camId);
 }
 
 std::future<void> ImagesCache::refreshData_async(int camId)
 {
-    return std::async(&ImagesCache::refreshData_sync, this, camId);
+    return std::async(std::launch::async, &ImagesCache::refreshData_sync, this, camId);
+}
+
+void ImagesCache::prefetch(int camId)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if(_nbLoaders <= 0)
+        return;
+
+    CacheEntry& e = _entries[camId];
+    if(e.state == EState::LOADED)
+    {
+        // keep it in memory until it is used
+        e.lastUse = ++_clock;
+        return;
+    }
+    if(e.state != EState::NOT_LOADED)
+        return;
+
+    e.state = EState::QUEUED;
+    _prefetchQueue.push_back(camId);
+
+    if(_loaders.empty())
+        startLoaders();
+    _queueCond.notify_one();
+}
+
+void ImagesCache::prefetch(const std::vector<int>& camIds)
+{
+    for(const int camId : camIds)
+        prefetch(camId);
+}
+
+void ImagesCache::setCurrentCams(const std::vector<int>& camIds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(CacheEntry& e : _entries)
+        e.current = false;
+    for(const int camId : camIds)
+        _entries[camId].current = true;
+}
+
+void ImagesCache::startLoaders()
+{
+    for(int i = 0; i < _nbLoaders; ++i)
+        _loaders.emplace_back(&ImagesCache::loaderLoop, this);
+}
+
+void ImagesCache::stopLoaders()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopLoaders = true;
+        for(const int camId : _prefetchQueue)
+            _entries[camId].state = EState::NOT_LOADED;
+        _prefetchQueue.clear();
+    }
+    _queueCond.notify_all();
+
+    for(std::thread& loader : _loaders)
+        loader.join();
+    _loaders.clear();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopLoaders = false;
+}
+
+void ImagesCache::loaderLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while(true)
+    {
+        _queueCond.wait(lock, [this]{ return _stopLoaders || !_prefetchQueue.empty(); });
+        if(_stopLoaders)
+            return;
+
+        const int camId = _prefetchQueue.front();
+        _prefetchQueue.pop_front();
+
+        if(_entries[camId].state != EState::QUEUED)
+            continue;
+
+        try
+        {
+            if(loadEntry(lock, camId, true))
+            {
+                ++_stats.prefetched;
+            }
+            else
+            {
+                ++_stats.skippedPrefetches;
+                ALICEVISION_LOG_DEBUG("Skip the prefetch of " << _imagesNames.at(camId) << ", the image cache is full.");
+            }
+        }
+        catch(const std::exception& e)
+        {
+            // the image will be loaded again on request, which will report the error
+            ALICEVISION_LOG_WARNING("Cannot prefetch " << _imagesNames.at(camId) << ": " << e.what());
+        }
+    }
+}
+
+ImagesCache::Stats ImagesCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void ImagesCache::logStats() const
+{
+    const Stats stats = getStats();
+    ALICEVISION_LOG_INFO("Image cache statistics:\n"
+                         "\t- hits: " << stats.hits << "\n"
+                         "\t- misses: " << stats.misses << "\n"
+                         "\t- waits for prefetched images: " << stats.waits << "\n"
+                         "\t- prefetched images: " << stats.prefetched << "\n"
+                         "\t- skipped prefetches: " << stats.skippedPrefetches << "\n"
+                         "\t- evictions: " << stats.evictions << "\n"
+                         "\t- time waiting for images: " << stats.waitTime << " s");
 }
 
 Color ImagesCache::getPixelValueInterpolated(const Point2d* pix, int camId)
 {
-    // get the image index in the memory
-    const int i = _camIdMapId[camId];
-    const ImgSharedPtr& img = _imgs[i];
+    // the image is expected in memory, only load it if it has been evicted
+    ImgSharedPtr img;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        img = _entries[camId].img;
+    }
+    if(img == nullptr)
+        img = getImg_sync(camId);
     
     const int xp = static_cast<int>(pix->x);
     const int yp = static_cast<int>(pix->y);
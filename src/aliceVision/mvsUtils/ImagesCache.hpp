@@ -14,12 +14,25 @@
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/Image.hpp>
 
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
 #include <future>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace aliceVision {
 namespace mvsUtils {
 
+/**
+ * @brief Thread-safe cache of the input images, bounded by a memory budget in bytes.
+ *
+ * Images are evicted in least recently used order. An image handed out by getImg_sync
+ * stays valid as long as the caller keeps its shared pointer, even if the cache evicts it.
+ * A pool of loader threads can prefetch the images that will be needed next,
+ * so that disk reads overlap with the computation.
+ */
 class ImagesCache
 {
 public:
@@ -34,44 +47,137 @@ public:
 
     typedef std::shared_ptr<Image> ImgSharedPtr;
 
+    struct Stats
+    {
+        /// requests served from memory
+        std::size_t hits = 0;
+        /// requests that had to read the image from disk
+        std::size_t misses = 0;
+        /// requests that waited for an image being loaded by another thread
+        std::size_t waits = 0;
+        /// images loaded by the prefetch threads
+        std::size_t prefetched = 0;
+        /// prefetches dropped as the budget is used by the images of the current cameras
+        std::size_t skippedPrefetches = 0;
+        /// images evicted from the cache
+        std::size_t evictions = 0;
+        /// total time spent by the requesting threads on disk reads and waits (seconds)
+        double waitTime = 0.0;
+    };
+
 private:
     ImagesCache(const ImagesCache&) = delete;
 
-    const MultiViewParams* _mp;
+    enum class EState
+    {
+        NOT_LOADED,
+        QUEUED,
+        LOADING,
+        LOADED
+    };
 
-    int _N_PRELOADED_IMAGES;
-    std::vector<ImgSharedPtr> _imgs;
+    struct CacheEntry
+    {
+        ImgSharedPtr img;
+        std::size_t bytes = 0;
+        long lastUse = 0;
+        EState state = EState::NOT_LOADED;
+        /// used by the current computation, never evicted by a prefetch
+        bool current = false;
+    };
 
-    std::vector<int> _camIdMapId;
-    std::vector<int> _mapIdCamId;
-    StaticVector<long> _mapIdClock;
+    const MultiViewParams* _mp;
 
-    std::vector<std::mutex> _imagesMutexes;
+    /// one entry per camera
+    std::vector<CacheEntry> _entries;
     std::vector<std::string> _imagesNames;
 
+    std::size_t _maxBytes = 0;
+    std::size_t _usedBytes = 0;
+    long _clock = 0;
+
+    /// image buffers of evicted images, reused to avoid reallocations
+    std::vector<ImgSharedPtr> _recycledImgs;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _loadedCond;
+    std::condition_variable _queueCond;
+
+    std::deque<int> _prefetchQueue;
+    std::vector<std::thread> _loaders;
+    int _nbLoaders = 0;
+    bool _stopLoaders = false;
+
+    Stats _stats;
+
     imageIO::EImageColorSpace _colorspace{imageIO::EImageColorSpace::AUTO};
     ECorrectEV _correctEV{ECorrectEV::NO_CORRECTION};
 
+    std::size_t maxImageBytes() const;
+
+    /**
+     * @brief Evict least recently used images until bytes can be added within the budget (lock held)
+     * @param[in] prefetching Do not evict the images of the current cameras
+     * @return false if the budget is still exceeded
+     */
+    bool makeRoom(std::size_t bytes, bool prefetching = false);
+
+    /**
+     * @brief Load the image of camId from disk (lock held on entry and exit, released during the read)
+     * @param[in] prefetching Give up rather than exceed the budget or evict the images of the current cameras
+     * @return false if a prefetch has been given up
+     */
+    bool loadEntry(std::unique_lock<std::mutex>& lock, int camId, bool prefetching = false);
+
+    void startLoaders();
+    void stopLoaders();
+    void loaderLoop();
+
 public:
     ImagesCache( const MultiViewParams* mp, imageIO::EImageColorSpace colorspace, ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
     ImagesCache( const MultiViewParams* mp, imageIO::EImageColorSpace colorspace, std::vector<std::string>& imagesNames, ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
     void initIC( std::vector<std::string>& imagesNames );
+
+    /**
+     * @brief Set the memory budget as a number of images of the maximum size.
+     */
     void setCacheSize(int nbPreload);
+
+    /**
+     * @brief Set the memory budget in bytes.
+     */
+    void setCacheBudget(std::size_t maxBytes);
+
+    /**
+     * @brief Set the number of threads used to prefetch images (0 disables the prefetching).
+     */
+    void setNbLoaders(int nbLoaders);
+
     void setCorrectEV(const ECorrectEV correctEV) { _correctEV = correctEV; }
-    ~ImagesCache() = default;
+    ~ImagesCache();
 
-    inline ImgSharedPtr getImg_sync( int camId )
-    {
-        refreshData_sync(camId);
-        const int imageId = _camIdMapId[camId];
-        return _imgs[imageId];
-    }
+    ImgSharedPtr getImg_sync( int camId );
 
     void refreshData(int camId);
     void refreshData_sync(int camId);
 
     std::future<void> refreshData_async(int camId);
 
+    /**
+     * @brief Queue the images for loading in the background, without waiting for them.
+     */
+    void prefetch(int camId);
+    void prefetch(const std::vector<int>& camIds);
+
+    /**
+     * @brief Set the cameras whose images are used by the current computation.
+     * The prefetched images never evict them, even if they are not referenced between two getImg_sync.
+     */
+    void setCurrentCams(const std::vector<int>& camIds);
+
+    Stats getStats() const;
+    void logStats() const;
+
     Color getPixelValueInterpolated(const Point2d* pix, int camId);
 };
 
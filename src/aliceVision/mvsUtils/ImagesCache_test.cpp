@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/mvsData/Color.hpp>
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE mvsUtils
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+const int width = 32;
+const int height = 16;
+const int nbCameras = 6;
+const std::size_t imageBytes = sizeof(Color) * width * height;
+
+/**
+ * @brief Cameras with small images written in a temporary folder, each image filled with its camera index.
+ */
+class ImagesScene
+{
+public:
+    ImagesScene()
+        : _folder(bfs::temp_directory_path() / bfs::unique_path())
+    {
+        bfs::create_directories(_folder);
+
+        _sfmData.intrinsics.emplace(0, std::make_shared<camera::Pinhole>(width, height, 30.0, 30.0,
+                                                                           width / 2.0, height / 2.0));
+        for(IndexT viewId = 0; viewId < nbCameras; ++viewId)
+        {
+            const std::string imagePath = (_folder / (std::to_string(viewId) + ".exr")).string();
+            const std::vector<Color> image(width * height, Color(float(viewId), 0.f, 0.f));
+            imageIO::OutputFileColorSpace colorspace(imageIO::EImageColorSpace::NO_CONVERSION);
+            imageIO::writeImage(imagePath, width, height, image, imageIO::EImageQuality::LOSSLESS, colorspace);
+
+            _sfmData.views.emplace(viewId, std::make_shared<sfmData::View>(imagePath, viewId, 0, viewId, width, height));
+            _sfmData.setPose(*_sfmData.views.at(viewId), sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(viewId, 0.0, 0.0))));
+        }
+        _mp.reset(new mvsUtils::MultiViewParams(_sfmData));
+    }
+
+    ~ImagesScene()
+    {
+        bfs::remove_all(_folder);
+    }
+
+    const mvsUtils::MultiViewParams* mp() const { return _mp.get(); }
+
+private:
+    const bfs::path _folder;
+    sfmData::SfMData _sfmData;
+    std::unique_ptr<mvsUtils::MultiViewParams> _mp;
+};
+
+/// Wait for the loader threads to handle the given number of prefetches
+mvsUtils::ImagesCache::Stats waitPrefetches(const mvsUtils::ImagesCache& ic, std::size_t nbPrefetches)
+{
+    mvsUtils::ImagesCache::Stats stats = ic.getStats();
+    for(int i = 0; i < 1000 && stats.prefetched + stats.skippedPrefetches < nbPrefetches; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        stats = ic.getStats();
+    }
+    return stats;
+}
+
+/// Check that the image of a camera is still in the cache
+bool isCached(mvsUtils::ImagesCache& ic, int camId)
+{
+    const std::size_t hits = ic.getStats().hits;
+    const mvsUtils::ImagesCache::ImgSharedPtr img = ic.getImg_sync(camId);
+    BOOST_CHECK_EQUAL(img->at(0, 0).r, float(camId));
+    return ic.getStats().hits == hits + 1;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(mvsUtils_imagesCache_budgetAndEviction)
+{
+    const ImagesScene scene;
+    mvsUtils::ImagesCache ic(scene.mp(), imageIO::EImageColorSpace::NO_CONVERSION);
+    ic.setNbLoaders(0);
+    ic.setCacheBudget(3 * imageBytes);
+
+    for(int camId = 0; camId < 3; ++camId)
+        ic.getImg_sync(camId);
+    BOOST_CHECK_EQUAL(ic.getStats().misses, 3);
+    BOOST_CHECK_EQUAL(ic.getStats().evictions, 0);
+
+    // the least recently used image is evicted: 1, as 0 has just been used
+    BOOST_CHECK(isCached(ic, 0));
+    ic.getImg_sync(3);
+    BOOST_CHECK_EQUAL(ic.getStats().evictions, 1);
+    BOOST_CHECK(isCached(ic, 2));
+    BOOST_CHECK(isCached(ic, 0));
+    BOOST_CHECK(isCached(ic, 3));
+    BOOST_CHECK(!isCached(ic, 1));
+    BOOST_CHECK_EQUAL(ic.getStats().evictions, 2);
+
+    {
+        // the referenced images are never evicted, the budget is exceeded
+        std::vector<mvsUtils::ImagesCache::ImgSharedPtr> imgs;
+        for(int camId : {0, 1, 3})
+            imgs.push_back(ic.getImg_sync(camId));
+        ic.getImg_sync(4);
+        BOOST_CHECK(isCached(ic, 0));
+        BOOST_CHECK(isCached(ic, 1));
+        BOOST_CHECK(isCached(ic, 3));
+    }
+
+    // once released, the next load evicts back to the budget: 4 and 0 are evicted to load 5
+    const std::size_t evictions = ic.getStats().evictions;
+    ic.getImg_sync(5);
+    BOOST_CHECK_EQUAL(ic.getStats().evictions, evictions + 2);
+    BOOST_CHECK(isCached(ic, 3));
+    BOOST_CHECK(isCached(ic, 5));
+
+    // a lower budget evicts immediately
+    ic.setCacheBudget(imageBytes);
+    BOOST_CHECK_EQUAL(ic.getStats().evictions, evictions + 4);
+    BOOST_CHECK(isCached(ic, 5));
+}
+
+BOOST_AUTO_TEST_CASE(mvsUtils_imagesCache_prefetchKeepsCurrentCams)
+{
+    const ImagesScene scene;
+    mvsUtils::ImagesCache ic(scene.mp(), imageIO::EImageColorSpace::NO_CONVERSION);
+    ic.setNbLoaders(1);
+    ic.setCacheBudget(3 * imageBytes);
+
+    // the images of the current cameras are not referenced between two requests
+    for(int camId = 0; camId < 3; ++camId)
+        ic.getImg_sync(camId);
+    ic.setCurrentCams({0, 1, 2});
+
+    // the cache is full of the current images, the prefetch is given up
+    ic.prefetch(3);
+    mvsUtils::ImagesCache::Stats stats = waitPrefetches(ic, 1);
+    BOOST_CHECK_EQUAL(stats.skippedPrefetches, 1);
+    BOOST_CHECK_EQUAL(stats.prefetched, 0);
+    BOOST_CHECK_EQUAL(stats.evictions, 0);
+    for(int camId = 0; camId < 3; ++camId)
+        BOOST_CHECK(isCached(ic, camId));
+
+    // only the image which is not used anymore is evicted by the prefetch
+    ic.setCurrentCams({0, 2});
+    ic.prefetch(3);
+    stats = waitPrefetches(ic, 2);
+    BOOST_CHECK_EQUAL(stats.prefetched, 1);
+    BOOST_CHECK_EQUAL(stats.evictions, 1);
+    BOOST_CHECK(isCached(ic, 3));
+    BOOST_CHECK(isCached(ic, 0));
+    BOOST_CHECK(isCached(ic, 2));
+
+    // the image evicted by the prefetch is loaded again on request
+    BOOST_CHECK(!isCached(ic, 1));
+}
@@ -326,28 +326,36 @@ Matrix3x4 load3x4MatrixFromFile(FILE* fi)
 void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Image& img, imageIO::EImageColorSpace colorspace, ImagesCache::ECorrectEV correctEV)
 {
     // check image size
-    auto checkImageSize = [&path, &mp, camId, &img](){
-        if((mp->getOriginalWidth(camId) != img.width()) || (mp->getOriginalHeight(camId) != img.height()))
+    {
+        int width, height, nchannels;
+        imageIO::readImageSpec(path, width, height, nchannels);
+
+        if((mp->getOriginalWidth(camId) != width) || (mp->getOriginalHeight(camId) != height))
         {
             std::stringstream s;
             s << "Bad image dimension for camera : " << camId << "\n";
             s << "\t- image path : " << path << "\n";
             s << "\t- expected dimension : " << mp->getOriginalWidth(camId) << "x" << mp->getOriginalHeight(camId) << "\n";
-            s << "\t- real dimension : " << img.width() << "x" << img.height() << "\n";
+            s << "\t- real dimension : " << width << "x" << height << "\n";
             throw std::runtime_error(s.str());
         }
-    };
+    }
+
+    // scale choosed by the user and apply during the process
+    // the image is downscaled while reading, to use the reduced-resolution levels of the file if any
+    const int processScale = mp->getProcessDownscale();
+
+    if(processScale > 1)
+        ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp->getViewId(camId) << ".");
 
     if(correctEV == ImagesCache::ECorrectEV::NO_CORRECTION)
     {
-        imageIO::readImage(path, img, colorspace);
-        checkImageSize();
+        imageIO::readImage(path, img, colorspace, processScale);
     }
     // if exposure correction, apply it in linear colorspace and then convert colorspace
     else
     {
-        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR);
-        checkImageSize();
+        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR, processScale);
 
         oiio::ParamValueList metadata;
         imageIO::readImageMetadata(path, metadata);
@@ -369,17 +377,6 @@ void loadImage(const std::string& path, const MultiViewParams* mp, int camId, Im
             imageAlgo::colorconvert(img, imageIO::EImageColorSpace::LINEAR, colorspace);
         }
     }
-
-    // scale choosed by the user and apply during the process
-    const int processScale = mp->getProcessDownscale();
-
-    if(processScale > 1)
-    {
-        ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp->getViewId(camId) << ".");
-        Image bmpr;
-        imageAlgo::resizeImage(processScale, img, bmpr);
-        img.swap(bmpr);
-    }
 }
 
 bool DeleteDirectory(const std::string& sPath)
@@ -37,14 +37,13 @@ bool CachedImage<image::RGBAfColor>::writeImage(const std::string& path, const i
         for(int j = 0; j < row.size(); j++)
         {
 
-            if(!row[j]->acquire())
+            image::PinnedTile pinned(row[j]);
+            if(!pinned.isValid())
             {
                 return false;
             }
 
-            unsigned char* ptr = row[j]->getDataPointer();
-
-            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::FLOAT, ptr);
+            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::FLOAT, pinned.getData<unsigned char>());
         }
     }
 
@@ -86,14 +85,13 @@ bool CachedImage<image::RGBfColor>::writeImage(const std::string& path, const im
         for(int j = 0; j < row.size(); j++)
         {
 
-            if(!row[j]->acquire())
+            image::PinnedTile pinned(row[j]);
+            if(!pinned.isValid())
             {
                 return false;
             }
 
-            unsigned char* ptr = row[j]->getDataPointer();
-
-            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::FLOAT, ptr);
+            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::FLOAT, pinned.getData<unsigned char>());
         }
     }
 
@@ -129,14 +127,13 @@ bool CachedImage<IndexT>::writeImage(const std::string& path, const image::EStor
         for(int j = 0; j < row.size(); j++)
         {
 
-            if(!row[j]->acquire())
+            image::PinnedTile pinned(row[j]);
+            if(!pinned.isValid())
             {
                 return false;
             }
 
-            unsigned char* ptr = row[j]->getDataPointer();
-
-            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::UINT32, ptr);
+            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::UINT32, pinned.getData<unsigned char>());
         }
     }
 
@@ -172,14 +169,13 @@ bool CachedImage<float>::writeImage(const std::string& path, const image::EStora
         for(int j = 0; j < row.size(); j++)
         {
 
-            if(!row[j]->acquire())
+            image::PinnedTile pinned(row[j]);
+            if(!pinned.isValid())
             {
                 return false;
             }
 
-            unsigned char* ptr = row[j]->getDataPointer();
-
-            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::FLOAT, ptr);
+            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::FLOAT, pinned.getData<unsigned char>());
         }
     }
 
@@ -215,14 +211,13 @@ bool CachedImage<unsigned char>::writeImage(const std::string& path, const image
         for(int j = 0; j < row.size(); j++)
         {
 
-            if(!row[j]->acquire())
+            image::PinnedTile pinned(row[j]);
+            if(!pinned.isValid())
             {
                 return false;
             }
 
-            unsigned char* ptr = row[j]->getDataPointer();
-
-            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::UINT8, ptr);
+            out->write_tile(j * _tileSize, i * _tileSize, 0, oiio::TypeDesc::UINT8, pinned.getData<unsigned char>());
         }
     }
 
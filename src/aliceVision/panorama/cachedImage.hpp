@@ -93,12 +93,13 @@ public:
                     continue;
                 }
 
-                if(!ptr->acquire())
+                image::PinnedTile pinned(ptr);
+                if(!pinned.isValid())
                 {
                     continue;
                 }
 
-                T* data = (T*)ptr->getDataPointer();
+                T* data = pinned.getData<T>();
 
                 std::transform(data, data + ptr->getTileWidth() * ptr->getTileHeight(), data, f);
             }
@@ -135,18 +136,20 @@ public:
                     continue;
                 }
 
-                if(!ptr->acquire())
+                image::PinnedTile pinned(ptr);
+                if(!pinned.isValid())
                 {
                     continue;
                 }
 
-                if(!ptrOther->acquire())
+                image::PinnedTile pinnedOther(ptrOther);
+                if(!pinnedOther.isValid())
                 {
                     continue;
                 }
 
-                T* data = (T*)ptr->getDataPointer();
-                T2* dataOther = (T2*)ptrOther->getDataPointer();
+                T* data = pinned.getData<T>();
+                T2* dataOther = pinnedOther.getData<T2>();
 
                 std::transform(data, data + ptr->getTileWidth() * ptr->getTileHeight(), dataOther, data, f);
             }
@@ -181,18 +184,20 @@ public:
                     continue;
                 }
 
-                if (!ptr->acquire())
+                image::PinnedTile pinned(ptr);
+                if (!pinned.isValid())
                 {
                     continue;
                 }
 
-                if (!ptrSource->acquire())
+                image::PinnedTile pinnedSource(ptrSource);
+                if (!pinnedSource.isValid())
                 {
                     continue;
                 }
 
-                T * data = (T*)ptr->getDataPointer();
-                T * dataSource = (T*)ptrSource->getDataPointer();
+                T * data = pinned.getData<T>();
+                T * dataSource = pinnedSource.getData<T>();
                 
                 std::memcpy(data, dataSource, _tileSize * _tileSize * sizeof(T));
             }
@@ -271,12 +276,13 @@ public:
                     continue;
                 }
 
-                if(!ptr->acquire())
+                image::PinnedTile pinned(ptr);
+                if(!pinned.isValid())
                 {
                     continue;
                 }
 
-                T* data = (T*)ptr->getDataPointer();
+                T* data = pinned.getData<T>();
 
                 for(int y = 0; y < _tileSize; y++)
                 {
@@ -364,12 +370,13 @@ public:
                     continue;
                 }
 
-                if(!ptr->acquire())
+                image::PinnedTile pinned(ptr);
+                if(!pinned.isValid())
                 {
                     continue;
                 }
 
-                T* data = (T*)ptr->getDataPointer();
+                T* data = pinned.getData<T>();
 
                 for(int y = 0; y < _tileSize; y++)
                 {
@@ -396,13 +403,14 @@ public:
             return false;
         }
 
-        if(!tile->acquire())
+        image::PinnedTile pinned(tile);
+        if(!pinned.isValid())
         {
             return false;
         }
 
         ret.resize(tile->getTileWidth(), tile->getTileHeight());
-        T * data = (T*)tile->getDataPointer();
+        T * data = pinned.getData<T>();
         for (int i = 0; i < tile->getTileHeight(); i++)
         {
             for (int j = 0; j < tile->getTileWidth(); j++)
@@ -432,12 +440,13 @@ public:
             return false;
         }
 
-        if(!tile->acquire())
+        image::PinnedTile pinned(tile);
+        if(!pinned.isValid())
         {
             return false;
         }
 
-        T * data = (T*)tile->getDataPointer();
+        T * data = pinned.getData<T>();
         for (int i = 0; i < tile->getTileHeight(); i++)
         {
             for (int j = 0; j < tile->getTileWidth(); j++)
@@ -10,8 +10,9 @@ namespace aliceVision
 class LaplacianCompositer : public Compositer
 {
 public:
-    LaplacianCompositer(size_t outputWidth, size_t outputHeight, size_t scale)
+    LaplacianCompositer(image::TileCacheManager::shared_ptr & cacheManager, size_t outputWidth, size_t outputHeight, size_t scale)
         : Compositer(outputWidth, outputHeight)
+        , _cacheManager(cacheManager)
         , _pyramidPanorama(outputWidth, outputHeight, scale + 1)
         , _bands(scale + 1)
     {
@@ -32,7 +33,7 @@ public:
         if (_outputRoi.getRight() >= _panoramaWidth) return false;
         if (_outputRoi.getBottom() >= _panoramaHeight) return false;
 
-        return _pyramidPanorama.initialize();
+        return _pyramidPanorama.initialize(_cacheManager);
     }
 
     virtual int getBorderSize() const 
@@ -134,6 +135,7 @@ public:
 
 protected:
     const int _gaussianFilterRadius = 2;
+    image::TileCacheManager::shared_ptr _cacheManager;
     LaplacianPyramid _pyramidPanorama;
     size_t _bands;
 };
@@ -4,23 +4,30 @@
 #include "gaussian.hpp"
 #include "compositer.hpp"
 
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <mutex>
+
 namespace aliceVision
 {
 
+// Radius of the gaussian filter used to upscale a level when rebuilding a band
+const int rebuildBandRadius = 2;
+
 LaplacianPyramid::LaplacianPyramid(size_t base_width, size_t base_height, size_t max_levels) :
 _baseWidth(base_width),
 _baseHeight(base_height),
 _maxLevels(max_levels)
 {
-    omp_init_lock(&_merge_lock);
+    omp_init_lock(&_inputInfosLock);
 }
 
 LaplacianPyramid::~LaplacianPyramid()
 {
-    omp_destroy_lock(&_merge_lock);
+    omp_destroy_lock(&_inputInfosLock);
 }
 
-bool LaplacianPyramid::initialize() 
+bool LaplacianPyramid::initialize(image::TileCacheManager::shared_ptr & cacheManager) 
 {
     size_t width = _baseWidth;
     size_t height = _baseHeight;
@@ -31,8 +38,28 @@ bool LaplacianPyramid::initialize()
     /*Prepare pyramid*/
     for(int lvl = 0; lvl < _maxLevels; lvl++)
     {
-        image::Image<image::RGBfColor> color(width, height, true, image::RGBfColor(0.0f, 0.0f, 0.0f));
-        image::Image<float> weights(width, height, true, 0.0f);
+        CachedImage<image::RGBfColor> color;
+        CachedImage<float> weights;
+
+        if (!color.createImage(cacheManager, width, height))
+        {
+            return false;
+        }
+
+        if (!weights.createImage(cacheManager, width, height))
+        {
+            return false;
+        }
+
+        if (!color.fill(image::RGBfColor(0.0f, 0.0f, 0.0f)))
+        {
+            return false;
+        }
+
+        if (!weights.fill(0.0f))
+        {
+            return false;
+        }
 
         _levels.push_back(color);
         _weights.push_back(weights);
@@ -200,11 +227,7 @@ bool LaplacianPyramid::apply(aliceVision::image::Image<image::RGBfColor>& source
         }
 
         //Merge this view with previous ones
-        omp_set_lock(&_merge_lock);
-        bool res = merge(currentColor, currentWeights, l, offsetX, offsetY);
-        omp_unset_lock(&_merge_lock);
-
-        if (!res)
+        if (!merge(currentColor, currentWeights, l, offsetX, offsetY))
         {
             return false;
         }
@@ -229,9 +252,9 @@ bool LaplacianPyramid::apply(aliceVision::image::Image<image::RGBfColor>& source
     iinfo.mask = currentMask;
     iinfo.weights = currentWeights;
 
-    omp_set_lock(&_merge_lock);
+    omp_set_lock(&_inputInfosLock);
     _inputInfos.push_back(iinfo);
-    omp_unset_lock(&_merge_lock);
+    omp_unset_lock(&_inputInfosLock);
     
 
     return true;
@@ -241,132 +264,316 @@ bool LaplacianPyramid::merge(const aliceVision::image::Image<image::RGBfColor>&
                              const aliceVision::image::Image<float>& oweight, 
                              size_t level, int offsetX, int offsetY)
 {
-    image::Image<image::RGBfColor> & img = _levels[level];
-    image::Image<float> & weight = _weights[level];
-
-    for(int i = 0; i < oimg.Height(); i++)
-    {   
-        int y = i + offsetY;
-        if (y < 0 || y >= img.Height()) continue;
-
-        for(int j = 0; j < oimg.Width(); j++)
-        {  
-            int x = j + offsetX;
-            if (x < 0 || x >= img.Width()) continue;
-
-            img(y, x).r() += oimg(i, j).r() * oweight(i, j);
-            img(y, x).g() += oimg(i, j).g() * oweight(i, j);
-            img(y, x).b() += oimg(i, j).b() * oweight(i, j);
-            weight(y, x) += oweight(i, j);
-        }
+    CachedImage<image::RGBfColor> & img = _levels[level];
+    CachedImage<float> & weight = _weights[level];
+
+    // Part of the level covered by the input
+    const int top = std::max(0, offsetY);
+    const int left = std::max(0, offsetX);
+    const int bottom = std::min(img.getHeight(), offsetY + int(oimg.Height()));
+    const int right = std::min(img.getWidth(), offsetX + int(oimg.Width()));
+    if (top >= bottom || left >= right)
+    {
+        return true;
     }
 
+    const int tileSize = img.getTileSize();
+    std::vector<CachedImage<image::RGBfColor>::RowType> & colorTiles = img.getTiles();
+    std::vector<CachedImage<float>::RowType> & weightTiles = weight.getTiles();
+
+    for (int ty = top / tileSize; ty <= (bottom - 1) / tileSize; ty++)
+    {
+        const int tileTop = ty * tileSize;
+        const int ystart = std::max(top, tileTop);
+        const int yend = std::min(bottom, tileTop + tileSize);
+
+        for (int tx = left / tileSize; tx <= (right - 1) / tileSize; tx++)
+        {
+            const int tileLeft = tx * tileSize;
+            const int xstart = std::max(left, tileLeft);
+            const int xend = std::min(right, tileLeft + tileSize);
+
+            image::CachedTile::smart_pointer colorTile = colorTiles[ty][tx];
+            image::CachedTile::smart_pointer weightTile = weightTiles[ty][tx];
+            if (!colorTile || !weightTile)
+            {
+                return false;
+            }
+
+            // The weights tile is only modified along with the color tile at the same position,
+            // so the color tile lock protects both of them
+            std::lock_guard<std::mutex> lock(colorTile->getMutex());
+
+            image::PinnedTile pinnedColor(colorTile);
+            image::PinnedTile pinnedWeight(weightTile);
+            if (!pinnedColor.isValid() || !pinnedWeight.isValid())
+            {
+                return false;
+            }
+
+            image::RGBfColor * colorData = pinnedColor.getData<image::RGBfColor>();
+            float * weightData = pinnedWeight.getData<float>();
+
+            for (int y = ystart; y < yend; y++)
+            {
+                const int i = y - offsetY;
+                const int tileRow = (y - tileTop) * tileSize;
+
+                for (int x = xstart; x < xend; x++)
+                {
+                    const int j = x - offsetX;
+                    const int pos = tileRow + x - tileLeft;
+                    const float w = oweight(i, j);
+
+                    colorData[pos].r() += oimg(i, j).r() * w;
+                    colorData[pos].g() += oimg(i, j).g() * w;
+                    colorData[pos].b() += oimg(i, j).b() * w;
+                    weightData[pos] += w;
+                }
+            }
+        }
+    }
 
     return true;
 }
 
-bool LaplacianPyramid::rebuild(image::Image<image::RGBAfColor>& output, const BoundingBox & roi)
+bool LaplacianPyramid::normalize(size_t level)
 {
-    for (InputInfo & iinfo : _inputInfos)
+    std::vector<CachedImage<image::RGBfColor>::RowType> & colorTiles = _levels[level].getTiles();
+    std::vector<CachedImage<float>::RowType> & weightTiles = _weights[level].getTiles();
+
+    if (colorTiles.empty())
     {
-        if (!merge(iinfo.color, iinfo.weights, _levels.size() - 1, iinfo.offsetX, iinfo.offsetY))
-        {
-            return false;
-        }
+        return true;
     }
 
-    // We first want to compute the final pixels mean
-    for(int l = 0; l < _levels.size(); l++)
+    const int countRows = colorTiles.size();
+    const int countCols = colorTiles[0].size();
+    const int tileSize = _levels[level].getTileSize();
+
+    bool success = true;
+
+    #pragma omp parallel for
+    for (int id = 0; id < countRows * countCols; id++)
     {
-        image::Image<image::RGBfColor> & level = _levels[l];
-        image::Image<float> & weight = _weights[l];
+        image::PinnedTile pinnedColor(colorTiles[id / countCols][id % countCols]);
+        image::PinnedTile pinnedWeight(weightTiles[id / countCols][id % countCols]);
+        if (!pinnedColor.isValid() || !pinnedWeight.isValid())
+        {
+            success = false;
+            continue;
+        }
 
-        for (int i = 0; i < level.Height(); i++) 
+        image::RGBfColor * colorData = pinnedColor.getData<image::RGBfColor>();
+        const float * weightData = pinnedWeight.getData<float>();
+
+        for (int pos = 0; pos < tileSize * tileSize; pos++)
         {
-            for (int j = 0; j < level.Width(); j++)
+            const float w = weightData[pos];
+
+            if (w < 1e-6) 
             {
-                float w = weight(i, j);
-                image::RGBfColor c = level(i, j);
+                colorData[pos] = image::RGBfColor(0.0f, 0.0f, 0.0f);
+                continue;
+            }
 
-                if (w < 1e-6) 
-                {
-                   level(i, j) = image::RGBfColor(0.0f, 0.0f, 0.0f);
-                   continue;
-                }
+            colorData[pos].r() /= w;
+            colorData[pos].g() /= w;
+            colorData[pos].b() /= w;
+        }
+    }
 
-                image::RGBfColor r;
+    return success;
+}
 
-                r.r() = c.r() / w;
-                r.g() = c.g() / w;
-                r.b() = c.b() / w;
+bool LaplacianPyramid::rebuildBand(size_t level, int bandTop, int bandHeight)
+{
+    CachedImage<image::RGBfColor> & currentLevel = _levels[level];
+    CachedImage<image::RGBfColor> & halfLevel = _levels[level + 1];
+
+    const int width = currentLevel.getWidth();
+    const int halfWidth = halfLevel.getWidth();
+
+    // The band is enlarged by the gaussian filter radius to get the same result as on the full level.
+    // The band top is a multiple of the tile size, so the enlarged top is even and the upscale is aligned.
+    const int radius = rebuildBandRadius;
+    const int top = std::max(0, bandTop - radius);
+    const int bottom = std::min(currentLevel.getHeight(), bandTop + bandHeight + radius);
+    const int halfTop = top / 2;
+    const int halfBottom = std::min(halfLevel.getHeight(), (bottom + 1) / 2);
+
+    aliceVision::image::Image<image::RGBfColor> halfBuf(halfWidth, halfBottom - halfTop);
+    if (!halfLevel.extract(halfBuf, BoundingBox(0, 0, halfWidth, halfBottom - halfTop), BoundingBox(0, halfTop, halfWidth, halfBottom - halfTop)))
+    {
+        return false;
+    }
 
-                level(i, j) = r;
-            }
+    aliceVision::image::Image<image::RGBfColor> buf(width, bottom - top, true, image::RGBfColor(0.0f, 0.0f, 0.0f));
+    aliceVision::image::Image<image::RGBfColor> buf2(width, bottom - top);
+
+    if (!upscale(buf, halfBuf)) 
+    {
+        return false;
+    }
+
+    if (!convolveGaussian5x5<image::RGBfColor>(buf2, buf, false)) 
+    {
+        return false;
+    }
+
+    const BoundingBox bandBb(0, 0, width, bandHeight);
+    const BoundingBox levelBb(0, bandTop, width, bandHeight);
+
+    aliceVision::image::Image<image::RGBfColor> band(width, bandHeight);
+    if (!currentLevel.extract(band, bandBb, levelBb))
+    {
+        return false;
+    }
+
+    for(int y = 0; y < bandHeight; y++)
+    {
+        const int by = y + bandTop - top;
+
+        for(int x = 0; x < width; x++)
+        {
+            band(y, x) += buf2(by, x) * 4.0f;
         }
     }
 
-    removeNegativeValues(_levels[_levels.size() - 1]);
+    removeNegativeValues(band);
 
-    for(int l = _levels.size() - 2; l >= 0; l--)
+    return currentLevel.assign(band, bandBb, levelBb);
+}
+
+std::size_t LaplacianPyramid::getBandMemorySize(std::size_t baseWidth, std::size_t tileSize)
+{
+    const std::size_t halfWidth = (baseWidth + 1) / 2;
+    const std::size_t enlargedHeight = tileSize + 2 * rebuildBandRadius;
+    const std::size_t halfHeight = (enlargedHeight + 1) / 2 + 1;
+
+    // rebuildBand: the half level band, the upscaled and filtered buffers and the band itself
+    const std::size_t rebuildSize = (halfWidth * halfHeight + 2 * baseWidth * enlargedHeight + baseWidth * tileSize) * sizeof(image::RGBfColor);
+
+    // rebuild: the color and weight bands of the output
+    const std::size_t outputSize = baseWidth * tileSize * (sizeof(image::RGBfColor) + sizeof(float));
+
+    return std::max(rebuildSize, outputSize);
+}
+
+bool LaplacianPyramid::rebuild(image::Image<image::RGBAfColor>& output, const BoundingBox & roi)
+{
+    for (InputInfo & iinfo : _inputInfos)
     {
-        int halfLevel = l + 1;
-        int currentLevel = l;
+        if (!merge(iinfo.color, iinfo.weights, _levels.size() - 1, iinfo.offsetX, iinfo.offsetY))
+        {
+            return false;
+        }
+    }
 
-        aliceVision::image::Image<image::RGBfColor> buf(_levels[currentLevel].Width(), _levels[currentLevel].Height());
-        aliceVision::image::Image<image::RGBfColor> buf2(_levels[currentLevel].Width(), _levels[currentLevel].Height());
+    // We first want to compute the final pixels mean
+    for(int l = 0; l < _levels.size(); l++)
+    {
+        if (!normalize(l))
+        {
+            return false;
+        }
+    }
 
-        if (!upscale(buf, _levels[halfLevel])) 
+    // The last level is the smallest one
+    {
+        CachedImage<image::RGBfColor> & lastLevel = _levels.back();
+        const BoundingBox lastBb(0, 0, lastLevel.getWidth(), lastLevel.getHeight());
+
+        image::Image<image::RGBfColor> last(lastLevel.getWidth(), lastLevel.getHeight());
+        if (!lastLevel.extract(last, lastBb, lastBb))
         {
             return false;
         }
 
-        if (!convolveGaussian5x5<image::RGBfColor>(buf2, buf, false)) 
+        removeNegativeValues(last);
+
+        if (!lastLevel.assign(last, lastBb, lastBb))
         {
             return false;
         }
+    }
 
-        for(int y = 0; y < buf2.Height(); y++)
+    // Each level is rebuilt by bands of tiles rows, in parallel.
+    // A band only modifies its own tiles and reads the previous (smaller) level.
+    for(int l = _levels.size() - 2; l >= 0; l--)
+    {
+        const int height = _levels[l].getHeight();
+        const int tileSize = _levels[l].getTileSize();
+        const int countBands = (height + tileSize - 1) / tileSize;
+
+        bool success = true;
+
+        #pragma omp parallel for
+        for (int band = 0; band < countBands; band++)
         {
-            for(int x = 0; x < buf2.Width(); x++)
+            const int bandTop = band * tileSize;
+            const int bandHeight = std::min(tileSize, height - bandTop);
+
+            if (!rebuildBand(l, bandTop, bandHeight))
             {
-                buf2(y, x) *= 4.0f;
+                success = false;
             }
         }
-        
-        if (!addition(_levels[currentLevel], _levels[currentLevel], buf2))
+
+        if (!success)
         {
             return false;
         }
-
-        removeNegativeValues(_levels[currentLevel]);
     }
     
-    image::Image<image::RGBfColor> & level = _levels[0];
-    image::Image<float> & weight = _weights[0];
-    for(int i = 0; i < roi.height; i++)
+    CachedImage<image::RGBfColor> & level = _levels[0];
+    CachedImage<float> & weight = _weights[0];
+    const int tileSize = level.getTileSize();
+    const int countBands = (roi.height + tileSize - 1) / tileSize;
+
+    bool success = true;
+
+    #pragma omp parallel for
+    for (int band = 0; band < countBands; band++)
     {
-        int y = i + roi.top;
+        const int bandTop = band * tileSize;
+        const int bandHeight = std::min(tileSize, roi.height - bandTop);
 
-        for(int j = 0; j < roi.width; j++)
-        {
-            int x = j + roi.left;
+        const BoundingBox bandBb(0, 0, roi.width, bandHeight);
+        const BoundingBox levelBb(roi.left, roi.top + bandTop, roi.width, bandHeight);
 
-            output(i, j).r() = level(y, x).r();
-            output(i, j).g() = level(y, x).g();
-            output(i, j).b() = level(y, x).b();
+        image::Image<image::RGBfColor> bandColor(roi.width, bandHeight);
+        image::Image<float> bandWeight(roi.width, bandHeight);
 
-            if (weight(y, x) < 1e-6)
-            {
-                output(i, j).a() = 0.0f;
-            }
-            else
+        if (!level.extract(bandColor, bandBb, levelBb) || !weight.extract(bandWeight, bandBb, levelBb))
+        {
+            success = false;
+            continue;
+        }
+
+        for(int i = 0; i < bandHeight; i++)
+        {
+            for(int j = 0; j < roi.width; j++)
             {
-                output(i, j).a() = 1.0f;
+                image::RGBAfColor & out = output(bandTop + i, j);
+
+                out.r() = bandColor(i, j).r();
+                out.g() = bandColor(i, j).g();
+                out.b() = bandColor(i, j).b();
+
+                if (bandWeight(i, j) < 1e-6)
+                {
+                    out.a() = 0.0f;
+                }
+                else
+                {
+                    out.a() = 1.0f;
+                }
             }
         }
     }
 
-    return true;
+    return success;
 }
 
 } // namespace aliceVision
@@ -1,12 +1,19 @@
 #pragma once
 
 #include "imageOps.hpp"
+#include "cachedImage.hpp"
 
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/image/cache.hpp>
 
 namespace aliceVision
 {
 
+/**
+ * Laplacian pyramid of the panorama.
+ * The levels are stored in tiles managed by a TileCacheManager, they are moved out of core when the memory limit is reached.
+ * Inputs may be applied from several threads, the levels tiles are locked one by one when merging.
+ */
 class LaplacianPyramid
 {
 public:
@@ -24,7 +31,7 @@ public:
 
     virtual ~LaplacianPyramid();
 
-    bool initialize();
+    bool initialize(image::TileCacheManager::shared_ptr & cacheManager);
     
     bool apply(aliceVision::image::Image<image::RGBfColor>& source,
                aliceVision::image::Image<float>& mask, 
@@ -37,14 +44,27 @@ public:
 
     bool rebuild(image::Image<image::RGBAfColor>& output, const BoundingBox & roi);
 
+    /**
+     * @brief Memory used by one thread of the rebuild for its band buffers, which are not stored in the tiles cache.
+     * @param baseWidth the width of the pyramid first level
+     * @param tileSize the size of the cache tiles, which is the height of a band
+     * @return the size in bytes
+     */
+    static std::size_t getBandMemorySize(std::size_t baseWidth, std::size_t tileSize);
+
+private:
+    bool normalize(size_t level);
+
+    bool rebuildBand(size_t level, int bandTop, int bandHeight);
+
 private:
     int _baseWidth;
     int _baseHeight;
     int _maxLevels;
-    omp_lock_t _merge_lock;
+    omp_lock_t _inputInfosLock;
 
-    std::vector<image::Image<image::RGBfColor>> _levels;
-    std::vector<image::Image<float>> _weights;
+    std::vector<CachedImage<image::RGBfColor>> _levels;
+    std::vector<CachedImage<float>> _weights;
     std::vector<InputInfo> _inputInfos;
 };
 
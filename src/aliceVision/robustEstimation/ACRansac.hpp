@@ -11,9 +11,12 @@
 
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <limits>
@@ -131,23 +134,207 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
 
 
 /**
- * @brief ACRANSAC routine (ErrorThreshold, NFA)
+ * @brief Buffers used to evaluate the NFA of the residuals of a model.
+ */
+struct NFABuckets
+{
+  std::vector<ErrorIndex> kept;      // residuals below the threshold, in input order
+  std::vector<ErrorIndex> bucketed;  // residuals grouped by increasing error buckets
+  std::vector<std::size_t> begin;    // first position of each bucket in bucketed (+ end)
+  std::vector<std::size_t> pos;      // insertion position of each bucket
+  std::vector<double> minError;      // smallest error of each bucket
+  std::vector<char> sorted;          // is the bucket sorted
+};
+
+/**
+ * @brief Find best NFA and its index wrt square error threshold, without sorting all the residuals.
  *
- * @param[in] kernel model and metric object
+ * Gives the same result as sorting the residuals and calling bestNFA.
+ * The residuals are bucketed by error with a counting sort on their bit pattern.
+ * A lower bound of the NFA is computed for each bucket and only the buckets
+ * that can improve on nfaToBeat and on the best NFA found so far are sorted and evaluated.
+ *
+ * @param[in] residuals square errors, indexed by data
+ * @param[in] nfaToBeat only NFA strictly lower than this value are searched
+ * @param[in,out] buckets reusable buffers
+ * @param[out] inliers if a NFA lower than nfaToBeat is found, the best.second data with the lowest errors, by increasing error
+ * @param[out] errorMax if a NFA lower than nfaToBeat is found, the error of the last inlier
+ * @return (NFA, number of inliers), NFA is infinity if no NFA lower than nfaToBeat exists
+ */
+inline ErrorIndex bestNFABucketed(int startIndex,
+                                  double logalpha0,
+                                  const std::vector<double>& residuals,
+                                  double loge0,
+                                  double maxThreshold,
+                                  const std::vector<float>& logc_n,
+                                  const std::vector<float>& logc_k,
+                                  double multError,
+                                  double nfaToBeat,
+                                  NFABuckets& buckets,
+                                  std::vector<std::size_t>& inliers,
+                                  double& errorMax)
+{
+  ErrorIndex bestIndex(std::numeric_limits<double>::infinity(), startIndex);
+
+  // the positive doubles are ordered as their bit patterns
+  const auto errorKey = [](double e) -> std::uint64_t
+  {
+    if(!(e > 0.0))
+      return 0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &e, sizeof(bits));
+    return bits;
+  };
+
+  std::vector<ErrorIndex>& kept = buckets.kept;
+  kept.clear();
+  double eMin = std::numeric_limits<double>::infinity();
+  double eMax = -std::numeric_limits<double>::infinity();
+  for(std::size_t i = 0; i < residuals.size(); ++i)
+  {
+    const double e = residuals[i];
+    if(e <= maxThreshold)
+    {
+      kept.emplace_back(e, i);
+      eMin = std::min(eMin, e);
+      eMax = std::max(eMax, e);
+    }
+  }
+
+  const std::size_t n = kept.size();
+  if(n <= static_cast<std::size_t>(startIndex))
+    return bestIndex;
+
+  // bucket the errors, at most 16 residuals per bucket on average
+  const std::size_t maxNbBuckets = std::max<std::size_t>(1, std::min<std::size_t>(n / 16, 4096));
+  const std::uint64_t keyMin = errorKey(eMin);
+  const std::uint64_t keyRange = errorKey(eMax) - keyMin;
+  int shift = 0;
+  while(shift < 64 && (keyRange >> shift) >= maxNbBuckets)
+    ++shift;
+  const std::size_t nbBuckets = static_cast<std::size_t>(keyRange >> shift) + 1;
+  const auto bucketOf = [&](double e) { return static_cast<std::size_t>((errorKey(e) - keyMin) >> shift); };
+
+  std::vector<std::size_t>& begin = buckets.begin;
+  begin.assign(nbBuckets + 1, 0);
+  buckets.minError.assign(nbBuckets, std::numeric_limits<double>::infinity());
+  buckets.sorted.assign(nbBuckets, 0);
+  for(const ErrorIndex& ei : kept)
+  {
+    const std::size_t b = bucketOf(ei.first);
+    ++begin[b + 1];
+    buckets.minError[b] = std::min(buckets.minError[b], ei.first);
+  }
+  std::partial_sum(begin.begin(), begin.end(), begin.begin());
+
+  std::vector<ErrorIndex>& e = buckets.bucketed;
+  e.resize(n);
+  std::vector<std::size_t>& pos = buckets.pos;
+  pos.assign(begin.begin(), begin.end() - 1);
+  for(const ErrorIndex& ei : kept)
+    e[pos[bucketOf(ei.first)]++] = ei;
+
+  for(std::size_t b = 0; b < nbBuckets; ++b)
+  {
+    const std::size_t kFirst = std::max(begin[b] + 1, static_cast<std::size_t>(startIndex) + 1);
+    const std::size_t kLast = begin[b + 1];
+    if(kFirst > kLast)
+      continue;
+
+    // lower bound of the NFA in the bucket: logalpha increases with the error
+    const double logalphaMin = logalpha0 +
+      multError * log10(buckets.minError[b] + std::numeric_limits<float>::epsilon());
+    double bound = std::numeric_limits<double>::infinity();
+    for(std::size_t k = kFirst; k <= kLast; ++k)
+      bound = std::min(bound, loge0 + logalphaMin * (double) (k - startIndex) + logc_n[k] + logc_k[k]);
+
+    if(bound >= std::min(nfaToBeat, bestIndex.first))
+      continue;
+
+    std::sort(e.begin() + begin[b], e.begin() + begin[b + 1]);
+    buckets.sorted[b] = 1;
+
+    for(std::size_t k = kFirst; k <= kLast; ++k)
+    {
+      const double logalpha = logalpha0 +
+        multError * log10(e[k - 1].first + std::numeric_limits<float>::epsilon());
+      ErrorIndex index(loge0 +
+                       logalpha * (double) (k - startIndex) +
+                       logc_n[k] +
+                       logc_k[k], k);
+
+      if(index.first < bestIndex.first)
+        bestIndex = index;
+    }
+  }
+
+  if(!(bestIndex.first < nfaToBeat))
+    return ErrorIndex(std::numeric_limits<double>::infinity(), startIndex);
+
+  // the inliers are the best.second lowest errors, sort the skipped buckets before the best one
+  inliers.resize(bestIndex.second);
+  for(std::size_t b = 0; b < nbBuckets && begin[b] < bestIndex.second; ++b)
+  {
+    if(!buckets.sorted[b])
+      std::sort(e.begin() + begin[b], e.begin() + begin[b + 1]);
+  }
+  for(std::size_t i = 0; i < bestIndex.second; ++i)
+    inliers[i] = e[i].second;
+  errorMax = e[bestIndex.second - 1].first;
+
+  return bestIndex;
+}
+
+/**
+ * @brief Buffers of ACRANSACParallel that do not depend on the model type.
+ *
+ * Keeping a workspace alive between estimations (e.g. one per thread when filtering
+ * many image pairs) avoids reallocating them for each estimation.
+ */
+struct ACRansacWorkspace
+{
+  struct ThreadBuffers
+  {
+    std::vector<double> residuals;
+    NFABuckets buckets;
+  };
+
+  std::vector<std::size_t> index;               // possible sampling indices
+  std::vector<float> log10;                     // lookup table of log10 in [0,n]
+  std::vector<float> logc_n, logc_k;            // tabulated logcombi
+  std::vector<ThreadBuffers> threadBuffers;     // residuals buffers, one per thread
+  std::vector<std::vector<std::size_t>> inliers; // inliers of each model of a batch
+};
+
+/**
+ * @brief ACRANSAC routine (ErrorThreshold, NFA), evaluating the hypotheses by batches.
+ *
+ * The samples of a batch are drawn sequentially from the random number generator,
+ * then the models are fitted and evaluated in parallel and the results are merged
+ * in the sampling order. The hypotheses drawn after the end of the estimation or after
+ * a switch to the focused sampling are discarded and the random number generator is
+ * rewound to their state, so the result and the final state of the random number generator
+ * are the ones of the sequential ACRANSAC, whatever the batch size and the number of threads.
+ *
+ * @param[in] kernel model and metric object, fit and errors must be thread-safe
  * @param[out] vec_inliers points that fit the estimated model
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] batchSize number of hypotheses evaluated in parallel
+ * @param[in,out] workspace buffers reused between estimations, optional
  *
  * @return (errorMax, minNFA)
  */
 template<typename Kernel>
-std::pair<double, double> ACRANSAC(const Kernel& kernel,
-                                   std::mt19937 &randomNumberGenerator,
-                                   std::vector<size_t>& vec_inliers,
-                                   std::size_t nIter = 1024,
-                                   typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+std::pair<double, double> ACRANSACParallel(const Kernel& kernel,
+                                           std::mt19937 &randomNumberGenerator,
+                                           std::vector<size_t>& vec_inliers,
+                                           std::size_t nIter = 1024,
+                                           typename Kernel::ModelT* model = nullptr,
+                                           double precision = std::numeric_limits<double>::infinity(),
+                                           std::size_t batchSize = 32,
+                                           ACRansacWorkspace* workspace = nullptr)
 {
   vec_inliers.clear();
 
@@ -156,21 +343,29 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
   if (nData <= (std::size_t)sizeSample)
     return std::make_pair(0.0,0.0);
 
+  batchSize = std::max<std::size_t>(batchSize, 1);
+
   const double maxThreshold = (precision==std::numeric_limits<double>::infinity()) ?
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
-  std::vector<double> vec_residuals_(nData);
+  ACRansacWorkspace localWorkspace;
+  ACRansacWorkspace& ws = (workspace != nullptr) ? *workspace : localWorkspace;
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
-  std::vector<size_t> vec_index(nData);
+  std::vector<size_t>& vec_index = ws.index;
+  vec_index.resize(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
 
   // Precompute log combi
   const double loge0 = log10((double)kernel.getMaximumNbModels() * (nData-sizeSample));
-  std::vector<float> vec_logc_n, vec_logc_k;
-  makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
+  const std::vector<float>& vec_logc_n = ws.logc_n;
+  const std::vector<float>& vec_logc_k = ws.logc_k;
+  ws.log10.resize(nData + 1);
+  for (std::size_t k = 0; k <= nData; ++k)
+    ws.log10[k] = log10((float)k);
+  makelogcombi_n(nData, ws.logc_n, ws.log10);
+  makelogcombi_k(sizeSample, nData, ws.logc_k, ws.log10);
 
   // Output parameters
   double minNFA = std::numeric_limits<double>::infinity();
@@ -182,102 +377,180 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
 
+  // Evaluation of one model of a hypothesis, its inliers are stored in the workspace
+  struct ModelEvaluation
+  {
+    unsigned int nInlier = 0;
+    ErrorIndex best{std::numeric_limits<double>::infinity(), 0};
+    double errorMax = 0.0;
+  };
+
+  struct Hypothesis
+  {
+    std::vector<std::size_t> sample;
+    std::vector<typename Kernel::ModelT> models; // Up to max_models solutions
+    std::vector<ModelEvaluation> evaluations;
+    std::mt19937 randomNumberGeneratorState; // state before drawing the sample
+  };
+
+  const std::size_t maxNbModels = kernel.getMaximumNbModels();
+
+  std::vector<Hypothesis> batch(batchSize);
+  const int nbThreads = static_cast<int>(std::min<std::size_t>(omp_get_max_threads(), batchSize));
+  if(ws.threadBuffers.size() < static_cast<std::size_t>(nbThreads))
+    ws.threadBuffers.resize(nbThreads);
+  for(int t = 0; t < nbThreads; ++t)
+    ws.threadBuffers[t].residuals.resize(nData);
+  if(ws.inliers.size() < batchSize * maxNbModels)
+    ws.inliers.resize(batchSize * maxNbModels);
+
   // Main estimation loop.
-  for(std::size_t iter = 0; iter < nIter; ++iter)
+  bool stop = false;
+  for(std::size_t batchStart = 0; batchStart < nIter && !stop;)
   {
-    std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
-    if (bACRansacMode)
-      uniformSample(randomNumberGenerator, sizeSample, vec_index, vec_sample); // Get random sample
-    else
-      uniformSample(randomNumberGenerator, sizeSample, nData, vec_sample); // Get random sample
-
-    std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
-    kernel.fit(vec_sample, vec_models);
-
-    // Evaluate models
-    bool better = false;
-    for (std::size_t k = 0; k < vec_models.size(); ++k)
+    const std::size_t nbHypotheses = std::min(batchSize, nIter - batchStart);
+    const bool batchACRansacMode = bACRansacMode;
+    const double batchMinNFA = minNFA;
+
+    // Draw the samples in order, for reproducibility
+    for(std::size_t h = 0; h < nbHypotheses; ++h)
     {
-      // Residuals computation and ordering
-      kernel.errors(vec_models[k], vec_residuals_);
+      std::vector<std::size_t>& vec_sample = batch[h].sample;
+      vec_sample.resize(sizeSample); // Sample indices
+      if(nbHypotheses > 1)
+        batch[h].randomNumberGeneratorState = randomNumberGenerator;
+      if (batchACRansacMode)
+        uniformSample(randomNumberGenerator, sizeSample, vec_index, vec_sample); // Get random sample
+      else
+        uniformSample(randomNumberGenerator, sizeSample, nData, vec_sample); // Get random sample
+    }
 
-      if (!bACRansacMode)
-      {
-        unsigned int nInlier = 0;
-        for (std::size_t i = 0; i < nData; ++i)
-        {
-          if (vec_residuals_[i] <= maxThreshold)
-            ++nInlier;
-        }
-        if (nInlier > 2.5 * sizeSample) // does the model is meaningful
-          bACRansacMode = true;
-      }
-      if (bACRansacMode)
+    // Fit and evaluate the models
+    #pragma omp parallel for schedule(dynamic) num_threads(nbThreads) if(nbHypotheses > 1)
+    for(int h = 0; h < (int)nbHypotheses; ++h)
+    {
+      Hypothesis& hypothesis = batch[h];
+      ACRansacWorkspace::ThreadBuffers& buffers = ws.threadBuffers[omp_get_thread_num()];
+
+      hypothesis.models.clear();
+      kernel.fit(hypothesis.sample, hypothesis.models);
+      hypothesis.evaluations.resize(hypothesis.models.size());
+
+      for (std::size_t k = 0; k < hypothesis.models.size(); ++k)
       {
-        for (size_t i = 0; i < nData; ++i)
+        ModelEvaluation& evaluation = hypothesis.evaluations[k];
+
+        // Residuals computation
+        kernel.errors(hypothesis.models[k], buffers.residuals);
+
+        if (!batchACRansacMode)
         {
-          const double error = vec_residuals_[i];
-          vec_residuals[i] = ErrorIndex(error, i);
+          evaluation.nInlier = 0;
+          for (std::size_t i = 0; i < nData; ++i)
+          {
+            if (buffers.residuals[i] <= maxThreshold)
+              ++evaluation.nInlier;
+          }
         }
-        std::sort(vec_residuals.begin(), vec_residuals.end());
 
         // Most meaningful discrimination inliers/outliers
-        const ErrorIndex best = bestNFA(
+        evaluation.best = bestNFABucketed(
           sizeSample,
           kernel.logalpha0(),
-          vec_residuals,
+          buffers.residuals,
           loge0,
           maxThreshold,
           vec_logc_n,
           vec_logc_k,
-          kernel.multError());
+          kernel.multError(),
+          batchMinNFA,
+          buffers.buckets,
+          ws.inliers[h * maxNbModels + k],
+          evaluation.errorMax);
+      }
+    }
+
+    // Discard the hypotheses of the batch from the given one, as if they were not drawn
+    const auto discardHypotheses = [&](std::size_t firstDiscarded)
+    {
+      if(firstDiscarded < nbHypotheses)
+        randomNumberGenerator = batch[firstDiscarded].randomNumberGeneratorState;
+    };
+
+    // Merge the results in the sampling order
+    std::size_t nextBatchStart = batchStart + nbHypotheses;
+    for(std::size_t h = 0; h < nbHypotheses; ++h)
+    {
+      const std::size_t iter = batchStart + h;
+      if(iter >= nIter)
+      {
+        discardHypotheses(h);
+        stop = true;
+        break;
+      }
+
+      const Hypothesis& hypothesis = batch[h];
+      bool better = false;
+      for (std::size_t k = 0; k < hypothesis.models.size(); ++k)
+      {
+        const ModelEvaluation& evaluation = hypothesis.evaluations[k];
+
+        if (!bACRansacMode && evaluation.nInlier > 2.5 * sizeSample) // does the model is meaningful
+          bACRansacMode = true;
 
-        if (best.first < minNFA /*&& vec_residuals[best.second-1].first < errorMax*/)
+        if (bACRansacMode && evaluation.best.first < minNFA)
         {
           // A better model was found
           better = true;
-          minNFA = best.first;
-          vec_inliers.resize(best.second);
-          for (size_t i=0; i<best.second; ++i)
-            vec_inliers[i] = vec_residuals[i].second;
-          errorMax = vec_residuals[best.second-1].first; // Error threshold
-          if(model) *model = vec_models[k];
+          minNFA = evaluation.best.first;
+          vec_inliers = ws.inliers[h * maxNbModels + k];
+          errorMax = evaluation.errorMax; // Error threshold
+          if(model) *model = hypothesis.models[k];
 
           ALICEVISION_LOG_TRACE("  nfa=" << minNFA
-            << " inliers=" << best.second << "/" << nData
+            << " inliers=" << evaluation.best.second << "/" << nData
             << " precisionNormalized=" << errorMax
             << " precision=" << kernel.unormalizeError(errorMax)
             << " (iter=" << iter
-            << ",sample=" << vec_sample
+            << ",sample=" << hypothesis.sample
             << ")");
         }
-      } //if(bACRansacMode)
-    } //for(size_t k...
-    
-    // Early exit test -> no meaningful model found after nIterReserve*2 iterations
-    if (!bACRansacMode && iter > nIterReserve*2)
-      break;
-
-    // ACRANSAC optimization: draw samples among best set of inliers so far
-    if (bACRansacMode && ((better && minNFA<0) || (iter+1==nIter && nIterReserve)))
-    {
-      if (vec_inliers.empty())
+      }
+
+      // Early exit test -> no meaningful model found after nIterReserve*2 iterations
+      if (!bACRansacMode && iter > nIterReserve*2)
       {
-        // No model found at all so far
-        ++nIter; // Continue to look for any model, even not meaningful
-        --nIterReserve;
+        discardHypotheses(h + 1);
+        stop = true;
+        break;
       }
-      else
+
+      // ACRANSAC optimization: draw samples among best set of inliers so far
+      if (bACRansacMode && ((better && minNFA<0) || (iter+1==nIter && nIterReserve)))
       {
-        // ACRANSAC optimization: draw samples among best set of inliers so far
-        vec_index = vec_inliers;
-        if(nIterReserve)
+        if (vec_inliers.empty())
+        {
+          // No model found at all so far
+          ++nIter; // Continue to look for any model, even not meaningful
+          --nIterReserve;
+        }
+        else
         {
-          nIter = iter + 1 + nIterReserve;
-          nIterReserve = 0;
+          // ACRANSAC optimization: draw samples among best set of inliers so far
+          vec_index = vec_inliers;
+          if(nIterReserve)
+          {
+            nIter = iter + 1 + nIterReserve;
+            nIterReserve = 0;
+          }
+          // the next hypotheses of the batch were not drawn among these inliers, draw them again
+          discardHypotheses(h + 1);
+          nextBatchStart = iter + 1;
+          break;
         }
       }
     }
+    batchStart = nextBatchStart;
   }
 
   if(minNFA >= 0)
@@ -293,5 +566,29 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
   return std::make_pair(errorMax, minNFA);
 }
 
+/**
+ * @brief ACRANSAC routine (ErrorThreshold, NFA)
+ *
+ * @param[in] kernel model and metric object
+ * @param[out] vec_inliers points that fit the estimated model
+ * @param[in] nIter maximum number of consecutive iterations
+ * @param[out] model returned model if found
+ * @param[in] precision upper bound of the precision (squared error)
+ * @param[in,out] workspace buffers reused between estimations, optional
+ *
+ * @return (errorMax, minNFA)
+ */
+template<typename Kernel>
+std::pair<double, double> ACRANSAC(const Kernel& kernel,
+                                   std::mt19937 &randomNumberGenerator,
+                                   std::vector<size_t>& vec_inliers,
+                                   std::size_t nIter = 1024,
+                                   typename Kernel::ModelT* model = nullptr,
+                                   double precision = std::numeric_limits<double>::infinity(),
+                                   ACRansacWorkspace* workspace = nullptr)
+{
+  return ACRANSACParallel(kernel, randomNumberGenerator, vec_inliers, nIter, model, precision, 1, workspace);
+}
+
 } // namespace robustEstimation
 } // namespace aliceVision
@@ -271,3 +271,155 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
 
   }
 }
+
+// check that the bucketed NFA evaluation gives the same result as the full sort
+BOOST_AUTO_TEST_CASE(ACRansac_BestNFABucketed)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> errorDistribution(0.0, 100.0);
+  std::uniform_int_distribution<int> duplicateDistribution(0, 9);
+
+  const int sizeSample = 2;
+  const double logalpha0 = log10(2.0 / 100.0);
+
+  for(std::size_t nData : {3, 10, 100, 1000, 5000})
+  {
+    std::vector<float> logc_n, logc_k;
+    makelogcombi(sizeSample, nData, logc_k, logc_n);
+    const double loge0 = log10(1.0 * (nData - sizeSample));
+
+    for(int trial = 0; trial < 20; ++trial)
+    {
+      // a cluster of small errors and equal values
+      std::vector<double> residuals(nData);
+      for(std::size_t i = 0; i < nData; ++i)
+      {
+        residuals[i] = errorDistribution(gen);
+        if(i < nData / 3)
+          residuals[i] *= 1e-4;
+        if(duplicateDistribution(gen) == 0)
+          residuals[i] = residuals[i / 2];
+      }
+
+      for(double maxThreshold : {std::numeric_limits<double>::infinity(), 10.0})
+      {
+        std::vector<ErrorIndex> sorted(nData);
+        for(std::size_t i = 0; i < nData; ++i)
+          sorted[i] = ErrorIndex(residuals[i], i);
+        std::sort(sorted.begin(), sorted.end());
+        const ErrorIndex expected = bestNFA(sizeSample, logalpha0, sorted, loge0, maxThreshold, logc_n, logc_k, 0.5);
+
+        NFABuckets buckets;
+        std::vector<std::size_t> inliers;
+        double errorMax = 0.0;
+        const ErrorIndex best = bestNFABucketed(sizeSample, logalpha0, residuals, loge0, maxThreshold, logc_n, logc_k, 0.5,
+                                                std::numeric_limits<double>::infinity(), buckets, inliers, errorMax);
+
+        BOOST_CHECK_EQUAL(expected.first, best.first);
+        BOOST_CHECK_EQUAL(expected.second, best.second);
+        if(best.first != std::numeric_limits<double>::infinity())
+        {
+          BOOST_REQUIRE_EQUAL(best.second, inliers.size());
+          for(std::size_t i = 0; i < inliers.size(); ++i)
+            BOOST_CHECK_EQUAL(sorted[i].second, inliers[i]);
+          BOOST_CHECK_EQUAL(sorted[best.second - 1].first, errorMax);
+        }
+
+        // nothing better than the best NFA
+        const ErrorIndex none = bestNFABucketed(sizeSample, logalpha0, residuals, loge0, maxThreshold, logc_n, logc_k, 0.5,
+                                                expected.first, buckets, inliers, errorMax);
+        BOOST_CHECK_EQUAL(std::numeric_limits<double>::infinity(), none.first);
+      }
+    }
+  }
+}
+
+// check that the parallel ACRANSAC finds the model and only depends on the seed
+BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACParallel)
+{
+  const int S = 100;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+  std::mt19937 gen;
+
+  const std::size_t numPoints = 1000;
+  Mat2X points(2, numPoints);
+  std::vector<std::size_t> vec_inliersGT;
+  generateLine(numPoints, 0.4, 0.5, GTModel, gen, points, vec_inliersGT);
+
+  LineKernel lineKernel(points, S, S);
+
+  for(std::size_t batchSize : {4, 32})
+  {
+    std::vector<std::size_t> inliers;
+    robustEstimation::MatrixModel<Vec2> model;
+    std::mt19937 randomNumberGenerator(7);
+    const std::pair<double, double> ret = ACRANSACParallel(lineKernel, randomNumberGenerator, inliers, 1000, &model,
+                                                           std::numeric_limits<double>::infinity(), batchSize);
+
+    BOOST_CHECK(ret.second < 0.0);
+    BOOST_CHECK(inliers.size() <= vec_inliersGT.size());
+    BOOST_CHECK(inliers.size() > 0.9 * vec_inliersGT.size());
+    BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 0.05);
+
+    // same seed, single thread
+    const int nbThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    std::vector<std::size_t> inliersCheck;
+    robustEstimation::MatrixModel<Vec2> modelCheck;
+    std::mt19937 randomNumberGeneratorCheck(7);
+    const std::pair<double, double> retCheck = ACRANSACParallel(lineKernel, randomNumberGeneratorCheck, inliersCheck, 1000, &modelCheck,
+                                                                std::numeric_limits<double>::infinity(), batchSize);
+    omp_set_num_threads(nbThreads);
+
+    BOOST_CHECK_EQUAL(ret.first, retCheck.first);
+    BOOST_CHECK_EQUAL(ret.second, retCheck.second);
+    BOOST_CHECK(inliers == inliersCheck);
+    BOOST_CHECK(model.getMatrix() == modelCheck.getMatrix());
+  }
+}
+
+// check that the batched ACRANSAC gives the result of the sequential ACRANSAC with the same seed
+BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACParallel_sameAsSequential)
+{
+  const int S = 100;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+
+  // the outlier ratios go up to a dataset without any meaningful model (early exit)
+  for(double outlierRatio : {0.2, 0.6, 0.95})
+  {
+    std::mt19937 gen(5);
+    const std::size_t numPoints = 300;
+    Mat2X points(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, 0.5, GTModel, gen, points, vec_inliersGT);
+
+    LineKernel lineKernel(points, S, S);
+
+    // with an upper bound of the precision, the estimation starts without the a contrario mode
+    for(double precision : {std::numeric_limits<double>::infinity(), 2.0})
+    {
+      std::vector<std::size_t> inliersSeq;
+      robustEstimation::MatrixModel<Vec2> modelSeq;
+      std::mt19937 randomNumberGeneratorSeq(11);
+      const std::pair<double, double> retSeq = ACRANSAC(lineKernel, randomNumberGeneratorSeq, inliersSeq, 500, &modelSeq, precision);
+
+      for(std::size_t batchSize : {2, 7, 32, 1000})
+      {
+        std::vector<std::size_t> inliersBatch;
+        robustEstimation::MatrixModel<Vec2> modelBatch;
+        std::mt19937 randomNumberGeneratorBatch(11);
+        const std::pair<double, double> retBatch = ACRANSACParallel(lineKernel, randomNumberGeneratorBatch, inliersBatch, 500,
+                                                                    &modelBatch, precision, batchSize);
+
+        BOOST_CHECK_EQUAL(retSeq.first, retBatch.first);
+        BOOST_CHECK_EQUAL(retSeq.second, retBatch.second);
+        BOOST_CHECK(inliersSeq == inliersBatch);
+        BOOST_CHECK(modelSeq.getMatrix() == modelBatch.getMatrix());
+        // the discarded hypotheses of the last batch are given back to the random number generator
+        BOOST_CHECK(randomNumberGeneratorSeq == randomNumberGeneratorBatch);
+      }
+    }
+  }
+}
@@ -18,6 +18,8 @@
 
 #include <ceres/rotation.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 
 
@@ -170,6 +172,11 @@ class IntrinsicsParameterization : public ceres::LocalParameterization {
     return _localSize; 
   }
 
+  void setFocalRatio(double focalRatio)
+  {
+    _focalRatio = focalRatio;
+  }
+
  private:
   size_t _distortionSize;
   size_t _globalSize;
@@ -181,6 +188,32 @@ class IntrinsicsParameterization : public ceres::LocalParameterization {
   bool _lockDistortion;
 };
 
+/// minimum number of reconstructed views to refine the optical center
+const std::size_t minImagesForOpticalCenter = 3;
+
+/**
+ * @brief Count the number of reconstructed views per intrinsic
+ * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+ * @return the number of reconstructed views of each intrinsic referenced by a view
+ */
+std::map<IndexT, std::size_t> getIntrinsicsUsage(const sfmData::SfMData& sfmData)
+{
+  std::map<IndexT, std::size_t> intrinsicsUsage;
+
+  for(const auto& viewPair: sfmData.getViews())
+  {
+    const sfmData::View& view = *(viewPair.second);
+
+    if(intrinsicsUsage.find(view.getIntrinsicId()) == intrinsicsUsage.end())
+      intrinsicsUsage[view.getIntrinsicId()] = 0;
+
+    if(sfmData.isPoseAndIntrinsicDefined(&view))
+      ++intrinsicsUsage.at(view.getIntrinsicId());
+  }
+
+  return intrinsicsUsage;
+}
+
 /**
  * @brief Create the appropriate cost functor according the provided input camera intrinsic model
  * @param[in] intrinsicPtr The intrinsic pointer
@@ -416,6 +449,7 @@ void BundleAdjustmentCeres::Statistics::show() const
 
   ALICEVISION_LOG_INFO("Bundle Adjustment Statistics:\n"
                         << ss.str()
+                        << "\t- problem creation / update duration: " << problemTime << " s\n"
                         << "\t- adjustment duration: " << time << " s\n"
                         << "\t- poses:\n"
                         << "\t    - # refined:  " << states[EParameter::POSE][EParameterState::REFINED]  << "\n"
@@ -430,6 +464,8 @@ void BundleAdjustmentCeres::Statistics::show() const
                         << "\t    - # constant: " << states[EParameter::INTRINSIC][EParameterState::CONSTANT] << "\n"
                         << "\t    - # ignored:  " << states[EParameter::INTRINSIC][EParameterState::IGNORED]  << "\n"
                         << "\t- # residual blocks: " << nbResidualBlocks << "\n"
+                        << "\t    - # added:   " << nbAddedResidualBlocks << "\n"
+                        << "\t    - # removed: " << nbRemovedResidualBlocks << "\n"
                         << "\t- # successful iterations: " << nbSuccessfullIterations   << "\n"
                         << "\t- # unsuccessful iterations: " << nbUnsuccessfullIterations << "\n"
                         << "\t- initial RMSE: " << RMSEinitial << "\n"
@@ -476,7 +512,12 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
     poseBlock.at(5) = t(2);
 
     double* poseBlockPtr = poseBlock.data();
-    problem.AddParameterBlock(poseBlockPtr, 6);
+
+    if(!problem.HasParameterBlock(poseBlockPtr))
+    {
+      problem.AddParameterBlock(poseBlockPtr, 6);
+      _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
+    }
 
     // add pose parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(poseBlockPtr);
@@ -510,15 +551,33 @@ void BundleAdjustmentCeres::addExtrinsicsToProblem(const sfmData::SfMData& sfmDa
     }
 
     // subset parametrization
-    if(!constantExtrinsic.empty())
+    // note: the refine options do not change during the problem lifetime, an existing parametrization is kept.
+    if(!constantExtrinsic.empty() && problem.GetParameterization(poseBlockPtr) == nullptr)
     {
       ceres::SubsetParameterization* subsetParameterization = new ceres::SubsetParameterization(6, constantExtrinsic);
       problem.SetParameterization(poseBlockPtr, subsetParameterization);
     }
 
+    problem.SetParameterBlockVariable(poseBlockPtr);
     _statistics.addState(EParameter::POSE, EParameterState::REFINED);
   };
 
+  // remove the poses no longer in the scene or set as Ignored in the Local strategy
+  for(auto poseBlockIt = _posesBlocks.begin(); poseBlockIt != _posesBlocks.end();)
+  {
+    const IndexT poseId = poseBlockIt->first;
+
+    if(sfmData.getPoses().count(poseId) == 0 || getPoseState(poseId) == EParameterState::IGNORED)
+    {
+      removeParameterBlock(poseBlockIt->second.data(), problem);
+      poseBlockIt = _posesBlocks.erase(poseBlockIt);
+    }
+    else
+    {
+      ++poseBlockIt;
+    }
+  }
+
   // setup poses data
   for(const auto& posePair : sfmData.getPoses())
   {
@@ -566,18 +625,27 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
   const bool refineIntrinsics = refineIntrinsicsDistortion || refineIntrinsicsFocalLength || refineIntrinsicsOpticalCenter;
   const bool fixFocalRatio = true;
 
-  std::map<IndexT, std::size_t> intrinsicsUsage;
-
   // count the number of reconstructed views per intrinsic
-  for(const auto& viewPair: sfmData.getViews())
-  {
-    const sfmData::View& view = *(viewPair.second);
+  const std::map<IndexT, std::size_t> intrinsicsUsage = getIntrinsicsUsage(sfmData);
 
-    if(intrinsicsUsage.find(view.getIntrinsicId()) == intrinsicsUsage.end())
-      intrinsicsUsage[view.getIntrinsicId()] = 0;
+  // remove the intrinsics no longer in the scene, not used by any reconstructed view or set as Ignored in the Local strategy
+  for(auto intrinsicBlockIt = _intrinsicsBlocks.begin(); intrinsicBlockIt != _intrinsicsBlocks.end();)
+  {
+    const IndexT intrinsicId = intrinsicBlockIt->first;
+    const auto usageIt = intrinsicsUsage.find(intrinsicId);
 
-    if(sfmData.isPoseAndIntrinsicDefined(&view))
-      ++intrinsicsUsage.at(view.getIntrinsicId());
+    if(sfmData.getIntrinsics().count(intrinsicId) == 0 ||
+       usageIt == intrinsicsUsage.end() || usageIt->second <= 0 ||
+       getIntrinsicState(intrinsicId) == EParameterState::IGNORED)
+    {
+      removeParameterBlock(intrinsicBlockIt->second.data(), problem);
+      _intrinsicsSetups.erase(intrinsicId);
+      intrinsicBlockIt = _intrinsicsBlocks.erase(intrinsicBlockIt);
+    }
+    else
+    {
+      ++intrinsicBlockIt;
+    }
   }
 
   for(const auto& intrinsicPair: sfmData.getIntrinsics())
@@ -599,12 +667,24 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
 
     assert(isValid(intrinsicPtr->getType()));
 
+    const bool isNewBlock = (_intrinsicsBlocks.find(intrinsicId) == _intrinsicsBlocks.end());
     std::vector<double>& intrinsicBlock = _intrinsicsBlocks[intrinsicId];
-    intrinsicBlock = intrinsicPtr->getParams();
 
-    double* intrinsicBlockPtr = intrinsicBlock.data();
+    if(isNewBlock)
+    {
+      intrinsicBlock = intrinsicPtr->getParams();
+      problem.AddParameterBlock(intrinsicBlock.data(), intrinsicBlock.size());
+      _linearSolverOrdering.AddElementToGroup(intrinsicBlock.data(), 2);
+    }
+    else
+    {
+      // update the values in place, the block memory is used by the problem
+      const std::vector<double> params = intrinsicPtr->getParams();
+      assert(params.size() == intrinsicBlock.size());
+      std::copy(params.begin(), params.end(), intrinsicBlock.begin());
+    }
 
-    problem.AddParameterBlock(intrinsicBlockPtr, intrinsicBlock.size());
+    double* intrinsicBlockPtr = intrinsicBlock.data();
 
     // add intrinsic parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(intrinsicBlockPtr);
@@ -655,8 +735,6 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
       lockFocal = true;
     }
 
-    const std::size_t minImagesForOpticalCenter = 3;
-
     // optical center
     if(refineIntrinsicsOpticalCenter && (usageCount > minImagesForOpticalCenter))
     {
@@ -684,21 +762,101 @@ void BundleAdjustmentCeres::addIntrinsicsToProblem(const sfmData::SfMData& sfmDa
       lockDistortion = true;
     }
 
-    
-    IntrinsicsParameterization * subsetParameterization = new IntrinsicsParameterization(intrinsicBlock.size(), focalRatio, lockFocal, lockRatio, lockCenter, lockDistortion);
-    problem.SetParameterization(intrinsicBlockPtr, subsetParameterization);
+    IntrinsicBlockSetup& intrinsicSetup = _intrinsicsSetups[intrinsicId];
 
+    if(intrinsicSetup.parameterization == nullptr)
+    {
+      IntrinsicsParameterization * subsetParameterization = new IntrinsicsParameterization(intrinsicBlock.size(), focalRatio, lockFocal, lockRatio, lockCenter, lockDistortion);
+      problem.SetParameterization(intrinsicBlockPtr, subsetParameterization);
+
+      intrinsicSetup.lockFocal = lockFocal;
+      intrinsicSetup.lockCenter = lockCenter;
+      intrinsicSetup.lockDistortion = lockDistortion;
+      intrinsicSetup.parameterization = subsetParameterization;
+    }
+    else
+    {
+      // a parameterization cannot be replaced, the problem is created again if the locked parameters change (see isProblemReusable)
+      assert(intrinsicSetup.lockFocal == lockFocal);
+      assert(intrinsicSetup.lockCenter == lockCenter);
+      assert(intrinsicSetup.lockDistortion == lockDistortion);
+      static_cast<IntrinsicsParameterization*>(intrinsicSetup.parameterization)->setFocalRatio(focalRatio);
+    }
+
+    problem.SetParameterBlockVariable(intrinsicBlockPtr);
     _statistics.addState(EParameter::INTRINSIC, EParameterState::REFINED);
   }
 }
 
+void BundleAdjustmentCeres::removeOutdatedLandmarksFromProblem(const sfmData::SfMData& sfmData, ceres::Problem& problem)
+{
+  for(auto landmarkBlockIt = _landmarksBlocks.begin(); landmarkBlockIt != _landmarksBlocks.end();)
+  {
+    const IndexT landmarkId = landmarkBlockIt->first;
+    const auto landmarkIt = sfmData.getLandmarks().find(landmarkId);
+    std::map<IndexT, ObservationResidual>& residuals = _landmarksResiduals[landmarkId];
+
+    // remove the landmarks no longer in the scene or set as Ignored in the Local strategy
+    if(landmarkIt == sfmData.getLandmarks().end() || getLandmarkState(landmarkId) == EParameterState::IGNORED)
+    {
+      for(const auto& residualPair : residuals)
+        problem.RemoveResidualBlock(residualPair.second.residualBlockId);
+
+      _statistics.nbRemovedResidualBlocks += residuals.size();
+      _landmarksResiduals.erase(landmarkId);
+      removeParameterBlock(landmarkBlockIt->second.data(), problem);
+      landmarkBlockIt = _landmarksBlocks.erase(landmarkBlockIt);
+      continue;
+    }
+
+    // remove the observations no longer in the landmark, moved or seen from a removed or ignored camera
+    const sfmData::Observations& observations = landmarkIt->second.observations;
+
+    for(auto residualIt = residuals.begin(); residualIt != residuals.end();)
+    {
+      const IndexT viewId = residualIt->first;
+      const auto observationIt = observations.find(viewId);
+      bool isOutdated = (observationIt == observations.end()) || !(observationIt->second == residualIt->second.observation);
+
+      if(!isOutdated)
+      {
+        const sfmData::View& view = sfmData.getView(viewId);
+        isOutdated = !sfmData.isPoseAndIntrinsicDefined(&view) ||
+                     getPoseState(view.getPoseId()) == EParameterState::IGNORED ||
+                     getIntrinsicState(view.getIntrinsicId()) == EParameterState::IGNORED;
+      }
+
+      if(isOutdated)
+      {
+        problem.RemoveResidualBlock(residualIt->second.residualBlockId);
+        ++_statistics.nbRemovedResidualBlocks;
+        residualIt = residuals.erase(residualIt);
+      }
+      else
+      {
+        ++residualIt;
+      }
+    }
+
+    ++landmarkBlockIt;
+  }
+}
+
+void BundleAdjustmentCeres::removeParameterBlock(double* parameterBlock, ceres::Problem& problem)
+{
+  if(problem.HasParameterBlock(parameterBlock))
+    problem.RemoveParameterBlock(parameterBlock);
+
+  _linearSolverOrdering.Remove(parameterBlock);
+}
+
 void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
 {
   const bool refineStructure = refineOptions & REFINE_STRUCTURE;
 
   // set a LossFunction to be less penalized by false measurements.
   // note: set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
+  ceres::LossFunction* lossFunction = _lossFunction.get();
 
   // build the residual blocks corresponding to the track observations
   for(const auto& landmarkPair: sfmData.getLandmarks())
@@ -714,76 +872,97 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       continue;
     }
 
+    const bool isNewBlock = (_landmarksBlocks.find(landmarkId) == _landmarksBlocks.end());
     std::array<double,3>& landmarkBlock = _landmarksBlocks[landmarkId];
     for(std::size_t i = 0; i < 3; ++i)
       landmarkBlock.at(i) = landmark.X(Eigen::Index(i));
 
     double* landmarkBlockPtr = landmarkBlock.data();
 
-    // add landmark parameter to the all parameters blocks pointers list
-    _allParametersBlocks.push_back(landmarkBlockPtr);
-
-    // iterate over 2D observation associated to the 3D landmark
-    for(const auto& observationPair: landmark.observations)
+    if(isNewBlock)
     {
-      const sfmData::View& view = sfmData.getView(observationPair.first);
-      const sfmData::Observation& observation = observationPair.second;
-
-      // each residual block takes a point and a camera as input and outputs a 2
-      // dimensional residual. Internally, the cost function stores the observed
-      // image location and compares the reprojection against the observation.
+      problem.AddParameterBlock(landmarkBlockPtr, 3);
+      _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
+    }
 
-      assert(getPoseState(view.getPoseId()) != EParameterState::IGNORED);
-      assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
+    // add landmark parameter to the all parameters blocks pointers list
+    _allParametersBlocks.push_back(landmarkBlockPtr);
 
-      // needed parameters to create a residual block (K, pose)
-      double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
-      double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+    // the residual blocks already in the problem are up to date (see removeOutdatedLandmarksFromProblem)
+    std::map<IndexT, ObservationResidual>& residuals = _landmarksResiduals[landmarkId];
 
-      // apply a specific parameter ordering:
-      if(_ceresOptions.useParametersOrdering)
-      {
-        _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
-        _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
-        _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
-      }
-
-      if(view.isPartOfRig() && !view.isPoseIndependant())
+    // iterate over 2D observation associated to the 3D landmark without residual block
+    if(residuals.size() != landmark.observations.size())
+    {
+      for(const auto& observationPair: landmark.observations)
       {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
-
-        double* rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
-        _linearSolverOrdering.AddElementToGroup(rigBlockPtr, 1);
-
-        problem.AddResidualBlock(costFunction,
-            lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            rigBlockPtr, // subpose of the cameras rig
-            landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
+        const IndexT viewId = observationPair.first;
+
+        const auto residualIt = residuals.lower_bound(viewId);
+        if(residualIt != residuals.end() && residualIt->first == viewId)
+          continue;
+
+        const sfmData::View& view = sfmData.getView(viewId);
+
+        // the cost function keeps a reference to the observation, store a copy next to the residual block id
+        ObservationResidual& observationResidual = residuals.emplace_hint(residualIt, viewId, ObservationResidual())->second;
+        observationResidual.observation = observationPair.second;
+        const sfmData::Observation& observation = observationResidual.observation;
+
+        // each residual block takes a point and a camera as input and outputs a 2
+        // dimensional residual. Internally, the cost function stores the observed
+        // image location and compares the reprojection against the observation.
+
+        assert(getPoseState(view.getPoseId()) != EParameterState::IGNORED);
+        assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
+
+        // needed parameters to create a residual block (K, pose)
+        double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
+        double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+
+        if(view.isPartOfRig() && !view.isPoseIndependant())
+        {
+          ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+
+          double* rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
+
+          observationResidual.residualBlockId = problem.AddResidualBlock(costFunction,
+              lossFunction,
+              intrinsicBlockPtr,
+              poseBlockPtr,
+              rigBlockPtr, // subpose of the cameras rig
+              landmarkBlockPtr); // do we need to copy 3D point to avoid false motion, if failure ?
+        }
+        else
+        {
+          ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+
+          observationResidual.residualBlockId = problem.AddResidualBlock(costFunction,
+              lossFunction,
+              intrinsicBlockPtr,
+              poseBlockPtr,
+              landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
+        }
+
+        ++_statistics.nbAddedResidualBlocks;
       }
-      else
-      {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+    }
 
-        problem.AddResidualBlock(costFunction,
-            lossFunction,
-            intrinsicBlockPtr,
-            poseBlockPtr,
-            landmarkBlockPtr); //do we need to copy 3D point to avoid false motion, if failure ?
-      }
+    const bool isConstant = (!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT);
 
-      if(!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT)
-      {
-        // set the whole landmark parameter block as constant.
-        _statistics.addState(EParameter::LANDMARK, EParameterState::CONSTANT);
-        problem.SetParameterBlockConstant(landmarkBlockPtr);
-      }
-      else
-      {
-        _statistics.addState(EParameter::LANDMARK, EParameterState::REFINED);
-      }
+    if(isConstant)
+    {
+      // set the whole landmark parameter block as constant.
+      problem.SetParameterBlockConstant(landmarkBlockPtr);
+    }
+    else
+    {
+      problem.SetParameterBlockVariable(landmarkBlockPtr);
     }
+
+    // one state per observation
+    for(std::size_t i = 0; i < landmark.observations.size(); ++i)
+      _statistics.addState(EParameter::LANDMARK, isConstant ? EParameterState::CONSTANT : EParameterState::REFINED);
   }
 }
 
@@ -791,7 +970,7 @@ void BundleAdjustmentCeres::addConstraints2DToProblem(const sfmData::SfMData& sf
 {
   // set a LossFunction to be less penalized by false measurements.
   // note: set it to NULL if you don't want use a lossFunction.
-  ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
+  ceres::LossFunction* lossFunction = _lossFunction.get();
 
   for (const auto & constraint : sfmData.getConstraints2D()) {
     const sfmData::View& view_1 = sfmData.getView(constraint.ViewFirst);
@@ -846,10 +1025,25 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   // clear previously computed data
   resetProblem();
 
+  // add all the SfM data to the empty problem
+  updateProblem(sfmData, refineOptions, problem);
+}
+
+void BundleAdjustmentCeres::updateProblem(const sfmData::SfMData& sfmData,
+                                          ERefineOptions refineOptions,
+                                          ceres::Problem& problem)
+{
+  _statistics = Statistics();
+  _allParametersBlocks.clear();
+
   // ensure we are not using incompatible options
   // REFINEINTRINSICS_OPTICALCENTER_ALWAYS and REFINEINTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA cannot be used at the same time
   assert(!((refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) && (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA)));
 
+  // remove outdated SfM landmarks and observations from the Ceres problem
+  // note: must be done first, the residual blocks reference the poses and intrinsics blocks
+  removeOutdatedLandmarksFromProblem(sfmData, problem);
+
   // add SfM extrincics to the Ceres problem
   addExtrinsicsToProblem(sfmData, refineOptions, problem);
 
@@ -866,10 +1060,15 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   addRotationPriorsToProblem(sfmData, refineOptions, problem);
 }
 
- void BundleAdjustmentCeres::resetProblem()
+void BundleAdjustmentCeres::resetProblem()
 {
   _statistics = Statistics();
 
+  _problem.reset();
+  _landmarksResiduals.clear();
+  _intrinsicsSetups.clear();
+  _lossFunction = _ceresOptions.lossFunction;
+
   _allParametersBlocks.clear();
   _posesBlocks.clear();
   _intrinsicsBlocks.clear();
@@ -879,6 +1078,37 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   _linearSolverOrdering.Clear();
 }
 
+bool BundleAdjustmentCeres::isProblemReusable(const sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
+{
+  if(_problem == nullptr || refineOptions != _problemRefineOptions)
+    return false;
+
+  // rigs, 2D constraints and rotation priors are only added to a new problem
+  if(!sfmData.getRigs().empty() || !sfmData.getConstraints2D().empty() || !sfmData.getRotationPriors().empty())
+    return false;
+
+  // the parameterization of an intrinsic block cannot be replaced,
+  // with the same refine options only the optical center lock can change.
+  const bool refineIntrinsicsOpticalCenter = (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
+  const std::map<IndexT, std::size_t> intrinsicsUsage = getIntrinsicsUsage(sfmData);
+
+  for(const auto& intrinsicSetupPair : _intrinsicsSetups)
+  {
+    const auto usageIt = intrinsicsUsage.find(intrinsicSetupPair.first);
+
+    // the intrinsic block will be removed
+    if(usageIt == intrinsicsUsage.end())
+      continue;
+
+    const bool lockCenter = !(refineIntrinsicsOpticalCenter && (usageIt->second > minImagesForOpticalCenter));
+
+    if(lockCenter != intrinsicSetupPair.second.lockCenter)
+      return false;
+  }
+
+  return true;
+}
+
 void BundleAdjustmentCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
 {
   const bool refinePoses = (refineOptions & REFINE_ROTATION) || (refineOptions & REFINE_TRANSLATION);
@@ -984,11 +1214,38 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
 
 bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
-  // create problem
-  ceres::Problem::Options problemOptions;
-  problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
-  ceres::Problem problem(problemOptions);
-  createProblem(sfmData, refineOptions, problem);
+  const auto problemStart = std::chrono::steady_clock::now();
+
+  std::unique_ptr<ceres::Problem> localProblem;
+  ceres::Problem* problemPtr = nullptr;
+
+  if(_ceresOptions.incrementalProblem && isProblemReusable(sfmData, refineOptions))
+  {
+    // apply the changes of the scene to the problem of the previous call
+    updateProblem(sfmData, refineOptions, *_problem);
+    problemPtr = _problem.get();
+  }
+  else
+  {
+    // create problem
+    ceres::Problem::Options problemOptions;
+    problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    // residual blocks are removed from the incremental problem
+    problemOptions.enable_fast_removal = _ceresOptions.incrementalProblem;
+    localProblem.reset(new ceres::Problem(problemOptions));
+    createProblem(sfmData, refineOptions, *localProblem);
+    problemPtr = localProblem.get();
+
+    if(_ceresOptions.incrementalProblem)
+    {
+      // keep the problem for the next call
+      _problem = std::move(localProblem);
+      _problemRefineOptions = refineOptions;
+    }
+  }
+
+  ceres::Problem& problem = *problemPtr;
+  const double problemTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - problemStart).count();
 
   // configure a Bundle Adjustment engine and run it
   // make Ceres automatically detect the bundle structure.
@@ -1016,6 +1273,7 @@ bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions ref
 
   // store some statitics from the summary
   _statistics.time = summary.total_time_in_seconds;
+  _statistics.problemTime = problemTime;
   _statistics.nbSuccessfullIterations = summary.num_successful_steps;
   _statistics.nbUnsuccessfullIterations = summary.num_unsuccessful_steps;
   _statistics.nbResidualBlocks = summary.num_residuals;
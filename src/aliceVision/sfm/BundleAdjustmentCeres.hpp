@@ -11,10 +11,12 @@
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfmData/Landmark.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 
 #include <ceres/ceres.h>
 
+#include <map>
 #include <memory>
 
 
@@ -54,6 +56,8 @@ public:
     bool useParametersOrdering = true;
     bool summary = false;
     bool verbose = true;
+    /// keep the Ceres problem between the calls to adjust and only apply the changes of the SfMData to it
+    bool incrementalProblem = false;
   };
 
   /**
@@ -104,6 +108,12 @@ public:
     double RMSEfinal = 0.0;
     /// time spent to solve the BA (s)
     double time = 0.0;
+    /// time spent to create or update the Ceres problem (s)
+    double problemTime = 0.0;
+    /// number of residual blocks added to the Ceres problem (all of them if the problem has been created)
+    std::size_t nbAddedResidualBlocks = 0;
+    /// number of residual blocks removed from the Ceres problem
+    std::size_t nbRemovedResidualBlocks = 0;
     /// number of states per parameter
     std::map<EParameter, std::map<EParameterState, std::size_t>> parametersStates;
     /// The distribution of the cameras for each graph distance <distance, numOfCam>
@@ -119,6 +129,16 @@ public:
     : _ceresOptions(options)
   {}
 
+  /**
+   * @brief Set the Ceres options used by the next adjustments
+   * @note With the incremental problem, the residual blocks already in the problem keep their loss function
+   * @param[in] options The user Ceres options
+   */
+  inline void setCeresOptions(const BundleAdjustmentCeres::CeresOptions& options)
+  {
+    _ceresOptions = options;
+  }
+
   /**
    * @brief Create a jacobian CRSMatrix
    * @param[in] sfmData The input SfMData contains all the information about the reconstruction
@@ -131,6 +151,10 @@ public:
 
   /**
    * @brief Perform a Bundle Adjustment on the SfM scene with refinement of the requested parameters
+   * @note With CeresOptions::incrementalProblem, the Ceres problem of the previous call is updated
+   *       with the poses, intrinsics, landmarks and observations added to or removed from the SfMData
+   *       and with the new parameter states. It is created again if the refine options, the locked
+   *       intrinsics parameters change or if the scene contains rigs, 2D constraints or rotation priors.
    * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
    * @param[in] refineOptions The chosen refine flag
    * @return false if the bundle adjustment failed else true
@@ -172,6 +196,27 @@ private:
    */
   void resetProblem();
 
+  /**
+   * @brief Return true if the incremental problem can be updated for the given scene and refine options
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   */
+  bool isProblemReusable(const sfmData::SfMData& sfmData, ERefineOptions refineOptions) const;
+
+  /**
+   * @brief Remove from the problem the landmarks and observations that are no longer in the SfMData or that are ignored
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in,out] problem The Ceres bundle adjustement problem
+   */
+  void removeOutdatedLandmarksFromProblem(const sfmData::SfMData& sfmData, ceres::Problem& problem);
+
+  /**
+   * @brief Remove a parameter block from the problem and from the solver ordering
+   * @param[in] parameterBlock The parameter block pointer
+   * @param[in,out] problem The Ceres bundle adjustement problem
+   */
+  void removeParameterBlock(double* parameterBlock, ceres::Problem& problem);
+
   /**
    * @brief Set user Ceres options to the solver
    * @param[in,out] solverOptions The solver options structure
@@ -228,6 +273,17 @@ private:
    */
   void createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Update the Ceres bundle adjustement problem built by the previous calls:
+   *  - remove the parameters and residuals blocks no longer in the SfMData or ignored.
+   *  - add the new parameters and residuals blocks.
+   *  - update the values and the constant state of all the parameters blocks.
+   * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @param[in,out] problem The Ceres bundle adjustement problem
+   */
+  void updateProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
+
   /**
    * @brief Update The given SfMData with the solver solution
    * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction, notably the poses and sub-poses
@@ -297,9 +353,40 @@ private:
   HashMap<IndexT, HashMap<IndexT, std::array<double,6>>> _rigBlocks;
 
   /// hinted order for ceres to eliminate blocks when solving.
-  /// note: this ceres parameter is built internally and must be reset on each call to the solver.
+  /// note: this ceres parameter is built internally and must be reset on each new problem.
   ceres::ParameterBlockOrdering _linearSolverOrdering;
 
+  // incremental problem
+
+  /// residual block of a landmark observation
+  struct ObservationResidual
+  {
+    /// copy of the observation referenced by the cost function
+    sfmData::Observation observation;
+    ceres::ResidualBlockId residualBlockId;
+  };
+
+  /// locked parameters of an intrinsic block and its parameterization (owned by the problem)
+  struct IntrinsicBlockSetup
+  {
+    bool lockFocal = false;
+    bool lockCenter = false;
+    bool lockDistortion = false;
+    ceres::LocalParameterization* parameterization = nullptr;
+  };
+
+  /// Ceres problem kept between the calls to adjust (CeresOptions::incrementalProblem)
+  std::unique_ptr<ceres::Problem> _problem;
+  /// refine options of the problem
+  ERefineOptions _problemRefineOptions = REFINE_NONE;
+  /// loss function of the residual blocks of the problem
+  std::shared_ptr<ceres::LossFunction> _lossFunction;
+  /// residual blocks of each landmark per view id
+  /// note: node based to keep the observations referenced by the cost functions in place.
+  HashMap<IndexT, std::map<IndexT, ObservationResidual>> _landmarksResiduals;
+  /// setup of each intrinsic block
+  HashMap<IndexT, IntrinsicBlockSetup> _intrinsicsSetups;
+
 };
 
 } // namespace sfm
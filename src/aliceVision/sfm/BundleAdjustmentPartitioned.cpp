@@ -0,0 +1,609 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/BundleAdjustmentPartitioned.hpp>
+#include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <memory>
+
+
+namespace aliceVision {
+namespace sfm {
+
+using namespace aliceVision::sfmData;
+
+namespace {
+
+/// owner of a parameter shared by several clusters
+const std::size_t sharedOwner = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Copy a landmark to a sub-scene with a subset of its observations
+ * @param[in] landmarkId The landmark id
+ * @param[in] landmark The landmark of the whole scene
+ * @param[in] keepObservation Return true for the view ids of the observations to copy
+ * @param[in,out] subScene The sub-scene
+ */
+template<typename KeepObservationT>
+void copyLandmark(IndexT landmarkId, const Landmark& landmark, KeepObservationT keepObservation, SfMData& subScene)
+{
+  Landmark subLandmark(landmark.X, landmark.descType, Observations(), landmark.rgb);
+  for(const auto& observationPair : landmark.observations)
+  {
+    if(keepObservation(observationPair.first))
+      subLandmark.observations.emplace(observationPair.first, observationPair.second);
+  }
+  subScene.getLandmarks().emplace(landmarkId, std::move(subLandmark));
+}
+
+/**
+ * @brief Copy the views observing the landmarks of a sub-scene, with their pose and intrinsic
+ * @note The views are shared, the intrinsics are cloned to be adjusted independently.
+ * @param[in] sfmData The whole scene
+ * @param[in,out] subScene The sub-scene
+ */
+void copyObservingViews(const SfMData& sfmData, SfMData& subScene)
+{
+  for(const auto& landmarkPair : subScene.getLandmarks())
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      if(subScene.getViews().count(observationPair.first))
+        continue;
+
+      const std::shared_ptr<View>& view = sfmData.getViews().at(observationPair.first);
+      subScene.getViews().emplace(observationPair.first, view);
+      subScene.getPoses().emplace(view->getPoseId(), sfmData.getPoses().at(view->getPoseId()));
+
+      if(!subScene.getIntrinsics().count(view->getIntrinsicId()))
+      {
+        const camera::IntrinsicBase* intrinsic = sfmData.getIntrinsicPtr(view->getIntrinsicId());
+        subScene.getIntrinsics().emplace(view->getIntrinsicId(), std::shared_ptr<camera::IntrinsicBase>(intrinsic->clone()));
+      }
+    }
+  }
+}
+
+/**
+ * @brief Compute the cluster owning each pose and intrinsic
+ * @details A pose or an intrinsic used by views of several clusters is owned by \c sharedOwner.
+ * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+ * @param[in] clusterPerView The cluster index of each posed view
+ * @param[out] ownerPerPose The cluster owning each pose
+ * @param[out] ownerPerIntrinsic The cluster owning each intrinsic
+ */
+void computeOwners(const SfMData& sfmData,
+                   const std::map<IndexT, std::size_t>& clusterPerView,
+                   std::map<IndexT, std::size_t>& ownerPerPose,
+                   std::map<IndexT, std::size_t>& ownerPerIntrinsic)
+{
+  const auto setOwner = [](std::map<IndexT, std::size_t>& ownerPerId, IndexT id, std::size_t cluster)
+  {
+    const auto it = ownerPerId.emplace(id, cluster).first;
+    if(it->second != cluster)
+      it->second = sharedOwner;
+  };
+
+  for(const auto& viewCluster : clusterPerView)
+  {
+    const View& view = sfmData.getView(viewCluster.first);
+    setOwner(ownerPerPose, view.getPoseId(), viewCluster.second);
+    setOwner(ownerPerIntrinsic, view.getIntrinsicId(), viewCluster.second);
+  }
+}
+
+/// parameters of a cluster solution, merged in the whole scene after the parallel adjustment
+struct ClusterSolution
+{
+  bool success = false;
+  std::size_t nbResidualBlocks = 0;
+  std::map<IndexT, geometry::Pose3> poses;
+  std::map<IndexT, std::vector<double>> intrinsics;
+  /// landmark position and number of observations from the cluster views
+  std::map<IndexT, std::pair<Vec3, std::size_t>> landmarks;
+};
+
+} // namespace
+
+void BundleAdjustmentPartitioned::Statistics::show() const
+{
+  ALICEVISION_LOG_INFO("Partitioned Bundle Adjustment Statistics:\n"
+                        << "\t- # clusters: " << nbClusters << "\n"
+                        << "\t    - # views of the largest cluster: " << maxClusterSize << "\n"
+                        << "\t    - # failed clusters: " << nbFailedClusters << "\n"
+                        << "\t- separator:\n"
+                        << "\t    - # views: " << nbSeparatorViews << "\n"
+                        << "\t    - # landmarks: " << nbSeparatorLandmarks << "\n"
+                        << "\t    - # blocks: " << nbSeparatorBlocks << "\n"
+                        << "\t    - # views of the largest block: " << maxSeparatorBlockSize << "\n"
+                        << "\t- # residual blocks of the largest problem: " << maxNbResidualBlocks << "\n"
+                        << "\t- clusters adjustment duration: " << clustersTime << " s\n"
+                        << "\t- separator adjustment duration: " << separatorTime << " s\n"
+                        << "\t- initial RMSE: " << RMSEinitial << "\n"
+                        << "\t- final   RMSE: " << RMSEfinal);
+}
+
+BundleAdjustmentPartitioned::ViewsGraph BundleAdjustmentPartitioned::computeViewsGraph(const SfMData& sfmData, std::size_t minNbOfMatches)
+{
+  std::set<IndexT> viewIds;
+  track::TracksPerView tracksPerView;
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    if(sfmData.isPoseAndIntrinsicDefined(viewPair.second.get()))
+    {
+      viewIds.insert(viewPair.first);
+      tracksPerView[viewPair.first];
+    }
+  }
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      if(viewIds.count(observationPair.first))
+        tracksPerView[observationPair.first].push_back(landmarkPair.first);
+    }
+  }
+
+  // getNewEdges expects sorted track ids
+  for(auto& viewTracks : tracksPerView)
+    std::sort(viewTracks.second.begin(), viewTracks.second.end());
+
+  ViewsGraph viewsGraph;
+  for(const IndexT viewId : viewIds)
+    viewsGraph[viewId];
+
+  // same edges as the local strategy graph: the best edges of each view and all the edges with enough shared landmarks
+  const std::size_t minNbOfEdgesPerView = 10;
+  for(const Pair& edge : LocalBundleAdjustmentGraph::getNewEdges(sfmData, tracksPerView, viewIds, minNbOfMatches, minNbOfEdgesPerView))
+  {
+    if(!viewIds.count(edge.first) || !viewIds.count(edge.second))
+      continue;
+
+    viewsGraph[edge.first].insert(edge.second);
+    viewsGraph[edge.second].insert(edge.first);
+  }
+  return viewsGraph;
+}
+
+std::vector<std::set<IndexT>> BundleAdjustmentPartitioned::growClusters(const ViewsGraph& viewsGraph, std::size_t maxClusterSize)
+{
+  std::vector<std::set<IndexT>> clusters;
+  std::set<IndexT> assignedViews;
+
+  for(const auto& seedPair : viewsGraph)
+  {
+    if(assignedViews.count(seedPair.first))
+      continue;
+
+    std::set<IndexT> cluster;
+    std::deque<IndexT> queue(1, seedPair.first);
+
+    while(!queue.empty() && cluster.size() < std::max(maxClusterSize, std::size_t(1)))
+    {
+      const IndexT viewId = queue.front();
+      queue.pop_front();
+
+      if(!assignedViews.insert(viewId).second)
+        continue;
+
+      cluster.insert(viewId);
+      for(const IndexT neighborId : viewsGraph.at(viewId))
+      {
+        if(!assignedViews.count(neighborId))
+          queue.push_back(neighborId);
+      }
+    }
+    clusters.push_back(std::move(cluster));
+  }
+  return clusters;
+}
+
+std::vector<std::set<IndexT>> BundleAdjustmentPartitioned::computeClusters(const SfMData& sfmData,
+                                                                           std::size_t maxClusterSize,
+                                                                           std::size_t minNbOfMatches)
+{
+  return growClusters(computeViewsGraph(sfmData, minNbOfMatches), maxClusterSize);
+}
+
+bool BundleAdjustmentPartitioned::adjustClusters(SfMData& sfmData,
+                                                 ERefineOptions refineOptions,
+                                                 const std::vector<std::set<IndexT>>& clusters,
+                                                 const std::map<IndexT, std::size_t>& clusterPerView)
+{
+  const auto startTime = std::chrono::steady_clock::now();
+
+  std::map<IndexT, std::size_t> ownerPerPose;
+  std::map<IndexT, std::size_t> ownerPerIntrinsic;
+  computeOwners(sfmData, clusterPerView, ownerPerPose, ownerPerIntrinsic);
+
+  // landmarks observed by each cluster
+  std::vector<std::vector<IndexT>> landmarksPerCluster(clusters.size());
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    std::set<std::size_t> observingClusters;
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      const auto it = clusterPerView.find(observationPair.first);
+      if(it != clusterPerView.end())
+        observingClusters.insert(it->second);
+    }
+    for(const std::size_t cluster : observingClusters)
+      landmarksPerCluster[cluster].push_back(landmarkPair.first);
+  }
+
+  BundleAdjustmentCeres::CeresOptions clusterOptions = _options.ceresOptions;
+  clusterOptions.nbThreads = 1;
+  clusterOptions.summary = false;
+  clusterOptions.verbose = false;
+  clusterOptions.incrementalProblem = false;
+
+  const unsigned int nbThreads = (_options.nbThreads > 0) ? _options.nbThreads : omp_get_max_threads();
+  const SfMData& scene = sfmData;
+  std::vector<ClusterSolution> solutions(clusters.size());
+
+  // the scene is only read in the parallel section, each cluster is adjusted in its own sub-scene
+  #pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+  for(int c = 0; c < static_cast<int>(clusters.size()); ++c)
+  {
+    const std::size_t cluster = static_cast<std::size_t>(c);
+    const std::set<IndexT>& clusterViews = clusters.at(cluster);
+
+    // sub-scene: the landmarks observed by the cluster with all their observations from posed views
+    SfMData subScene;
+    for(const IndexT landmarkId : landmarksPerCluster.at(cluster))
+      copyLandmark(landmarkId, scene.getLandmarks().at(landmarkId), [&](IndexT viewId){ return clusterPerView.count(viewId) > 0; }, subScene);
+    copyObservingViews(scene, subScene);
+
+    // refine the cluster poses, the intrinsics only used by the cluster and the landmarks
+    std::shared_ptr<LocalBundleAdjustmentGraph> states = std::make_shared<LocalBundleAdjustmentGraph>(subScene);
+    states->setAllParametersToRefine(subScene);
+    for(const auto& posePair : subScene.getPoses())
+    {
+      if(ownerPerPose.at(posePair.first) != cluster)
+        states->setPoseState(posePair.first, EParameterState::CONSTANT);
+    }
+    for(const auto& intrinsicPair : subScene.getIntrinsics())
+    {
+      if(ownerPerIntrinsic.at(intrinsicPair.first) != cluster)
+        states->setIntrinsicState(intrinsicPair.first, EParameterState::CONSTANT);
+    }
+
+    BundleAdjustmentCeres clusterBA(clusterOptions);
+    clusterBA.useLocalStrategyGraph(states);
+
+    ClusterSolution& solution = solutions.at(cluster);
+    solution.success = clusterBA.adjust(subScene, refineOptions);
+    solution.nbResidualBlocks = clusterBA.getStatistics().nbResidualBlocks;
+
+    if(!solution.success)
+      continue;
+
+    for(const auto& posePair : subScene.getPoses())
+    {
+      if(ownerPerPose.at(posePair.first) == cluster)
+        solution.poses.emplace(posePair.first, posePair.second.getTransform());
+    }
+    for(const auto& intrinsicPair : subScene.getIntrinsics())
+    {
+      if(ownerPerIntrinsic.at(intrinsicPair.first) == cluster)
+        solution.intrinsics.emplace(intrinsicPair.first, intrinsicPair.second->getParams());
+    }
+    for(const auto& landmarkPair : subScene.getLandmarks())
+    {
+      const std::size_t nbClusterObservations = std::count_if(landmarkPair.second.observations.begin(), landmarkPair.second.observations.end(),
+                                                              [&](const Observations::value_type& observationPair){ return clusterViews.count(observationPair.first) > 0; });
+      solution.landmarks.emplace(landmarkPair.first, std::make_pair(landmarkPair.second.X, nbClusterObservations));
+    }
+  }
+
+  // merge the cluster solutions: the landmarks observed by several clusters are averaged
+  std::map<IndexT, std::pair<Vec3, std::size_t>> mergedLandmarks;
+  std::size_t nbSuccessfulClusters = 0;
+
+  for(std::size_t cluster = 0; cluster < solutions.size(); ++cluster)
+  {
+    ClusterSolution& solution = solutions.at(cluster);
+    _statistics.maxNbResidualBlocks = std::max(_statistics.maxNbResidualBlocks, solution.nbResidualBlocks);
+
+    if(!solution.success)
+    {
+      ALICEVISION_LOG_WARNING("Partitioned Bundle Adjustment: the adjustment of the cluster " << cluster << " (" << clusters.at(cluster).size() << " views) failed, its parameters are not updated.");
+      ++_statistics.nbFailedClusters;
+      continue;
+    }
+    ++nbSuccessfulClusters;
+
+    for(const auto& posePair : solution.poses)
+      sfmData.getPoses().at(posePair.first).setTransform(posePair.second);
+
+    for(const auto& intrinsicPair : solution.intrinsics)
+      sfmData.getIntrinsicPtr(intrinsicPair.first)->updateFromParams(intrinsicPair.second);
+
+    for(const auto& landmarkPair : solution.landmarks)
+    {
+      auto& merged = mergedLandmarks.emplace(landmarkPair.first, std::make_pair(Vec3(Vec3::Zero()), std::size_t(0))).first->second;
+      merged.first += landmarkPair.second.first * static_cast<double>(landmarkPair.second.second);
+      merged.second += landmarkPair.second.second;
+    }
+
+    // release the cluster parameters as soon as they are merged
+    solution = ClusterSolution();
+  }
+
+  for(const auto& landmarkPair : mergedLandmarks)
+  {
+    if(landmarkPair.second.second > 0)
+      sfmData.getLandmarks().at(landmarkPair.first).X = landmarkPair.second.first / static_cast<double>(landmarkPair.second.second);
+  }
+
+  _statistics.clustersTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  return (nbSuccessfulClusters > 0);
+}
+
+bool BundleAdjustmentPartitioned::adjustSeparatorBlock(SfMData& sfmData,
+                                                       ERefineOptions refineOptions,
+                                                       const std::set<IndexT>& blockViews,
+                                                       const std::vector<IndexT>& blockLandmarks,
+                                                       const std::set<IndexT>& separatorLandmarks)
+{
+  // sub-scene: the separator landmarks with all their observations from posed views,
+  // and the other landmarks of the block views with only the observations from block views
+  SfMData subScene;
+  for(const IndexT landmarkId : blockLandmarks)
+  {
+    const Landmark& landmark = sfmData.getLandmarks().at(landmarkId);
+    if(separatorLandmarks.count(landmarkId))
+      copyLandmark(landmarkId, landmark, [&](IndexT viewId){ return sfmData.isPoseAndIntrinsicDefined(viewId); }, subScene);
+    else
+      copyLandmark(landmarkId, landmark, [&](IndexT viewId){ return blockViews.count(viewId) > 0; }, subScene);
+  }
+  copyObservingViews(sfmData, subScene);
+
+  // refine the block poses, their intrinsics and the separator landmarks
+  std::set<IndexT> blockPoses;
+  std::set<IndexT> blockIntrinsics;
+  for(const IndexT viewId : blockViews)
+  {
+    const View& view = sfmData.getView(viewId);
+    blockPoses.insert(view.getPoseId());
+    blockIntrinsics.insert(view.getIntrinsicId());
+  }
+
+  std::shared_ptr<LocalBundleAdjustmentGraph> states = std::make_shared<LocalBundleAdjustmentGraph>(subScene);
+  states->setAllParametersToRefine(subScene);
+  for(const auto& viewPair : subScene.getViews())
+  {
+    if(!blockViews.count(viewPair.first))
+      blockPoses.erase(viewPair.second->getPoseId()); // pose shared with a constant view
+  }
+  for(const auto& posePair : subScene.getPoses())
+  {
+    if(!blockPoses.count(posePair.first))
+      states->setPoseState(posePair.first, EParameterState::CONSTANT);
+  }
+  for(const auto& intrinsicPair : subScene.getIntrinsics())
+  {
+    if(!blockIntrinsics.count(intrinsicPair.first))
+      states->setIntrinsicState(intrinsicPair.first, EParameterState::CONSTANT);
+  }
+  for(const auto& landmarkPair : subScene.getLandmarks())
+  {
+    if(!separatorLandmarks.count(landmarkPair.first))
+      states->setLandmarkState(landmarkPair.first, EParameterState::CONSTANT);
+  }
+
+  BundleAdjustmentCeres::CeresOptions separatorOptions = _options.ceresOptions;
+  separatorOptions.incrementalProblem = false;
+
+  BundleAdjustmentCeres separatorBA(separatorOptions);
+  separatorBA.useLocalStrategyGraph(states);
+
+  const bool success = separatorBA.adjust(subScene, refineOptions);
+  _statistics.maxNbResidualBlocks = std::max(_statistics.maxNbResidualBlocks, separatorBA.getStatistics().nbResidualBlocks);
+
+  if(success)
+  {
+    for(const IndexT poseId : blockPoses)
+      sfmData.getPoses().at(poseId).setTransform(subScene.getPoses().at(poseId).getTransform());
+
+    for(const IndexT intrinsicId : blockIntrinsics)
+      sfmData.getIntrinsicPtr(intrinsicId)->updateFromParams(subScene.getIntrinsicPtr(intrinsicId)->getParams());
+
+    for(const auto& landmarkPair : subScene.getLandmarks())
+    {
+      if(separatorLandmarks.count(landmarkPair.first))
+        sfmData.getLandmarks().at(landmarkPair.first).X = landmarkPair.second.X;
+    }
+  }
+  else
+  {
+    ALICEVISION_LOG_WARNING("Partitioned Bundle Adjustment: the adjustment of a separator block (" << blockViews.size() << " views, "
+                            << blockLandmarks.size() << " landmarks) failed, its parameters are not updated.");
+  }
+  return success;
+}
+
+bool BundleAdjustmentPartitioned::adjustSeparator(SfMData& sfmData,
+                                                  ERefineOptions refineOptions,
+                                                  const std::vector<std::set<IndexT>>& separatorBlocks,
+                                                  const std::set<IndexT>& separatorLandmarks)
+{
+  const auto startTime = std::chrono::steady_clock::now();
+
+  std::map<IndexT, std::size_t> blockPerView;
+  for(std::size_t block = 0; block < separatorBlocks.size(); ++block)
+  {
+    for(const IndexT viewId : separatorBlocks.at(block))
+      blockPerView[viewId] = block;
+  }
+
+  // landmarks observed by each block, and separator landmarks not observed by any separator view
+  std::vector<std::vector<IndexT>> landmarksPerBlock(separatorBlocks.size());
+  std::vector<IndexT> remainingLandmarks;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    std::set<std::size_t> observingBlocks;
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      const auto it = blockPerView.find(observationPair.first);
+      if(it != blockPerView.end())
+        observingBlocks.insert(it->second);
+    }
+    for(const std::size_t block : observingBlocks)
+      landmarksPerBlock[block].push_back(landmarkPair.first);
+
+    if(observingBlocks.empty() && separatorLandmarks.count(landmarkPair.first))
+      remainingLandmarks.push_back(landmarkPair.first);
+  }
+
+  // group the remaining landmarks so that each group is observed by at most the cluster size views
+  std::vector<std::vector<IndexT>> landmarkGroups;
+  std::set<IndexT> groupViews;
+  for(const IndexT landmarkId : remainingLandmarks)
+  {
+    std::set<IndexT> newViews;
+    for(const auto& observationPair : sfmData.getLandmarks().at(landmarkId).observations)
+    {
+      if(!groupViews.count(observationPair.first) && sfmData.isPoseAndIntrinsicDefined(observationPair.first))
+        newViews.insert(observationPair.first);
+    }
+    if(landmarkGroups.empty() || (!groupViews.empty() && groupViews.size() + newViews.size() > _options.maxClusterSize))
+    {
+      landmarkGroups.emplace_back();
+      groupViews.clear();
+    }
+    landmarkGroups.back().push_back(landmarkId);
+    groupViews.insert(newViews.begin(), newViews.end());
+  }
+  _statistics.nbSeparatorBlocks = separatorBlocks.size() + landmarkGroups.size();
+
+  // the blocks share intrinsics and landmarks, they are adjusted one after the other
+  bool success = true;
+  for(std::size_t block = 0; block < separatorBlocks.size(); ++block)
+    success &= adjustSeparatorBlock(sfmData, refineOptions, separatorBlocks.at(block), landmarksPerBlock.at(block), separatorLandmarks);
+
+  const std::set<IndexT> noViews;
+  for(const std::vector<IndexT>& landmarkGroup : landmarkGroups)
+    success &= adjustSeparatorBlock(sfmData, refineOptions, noViews, landmarkGroup, separatorLandmarks);
+
+  _statistics.separatorTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  return success;
+}
+
+bool BundleAdjustmentPartitioned::adjust(SfMData& sfmData, ERefineOptions refineOptions)
+{
+  _statistics = Statistics();
+
+  const ViewsGraph viewsGraph = computeViewsGraph(sfmData, _options.minNbOfMatches);
+  const bool hasGlobalConstraints = !sfmData.getRigs().empty() ||
+                                    !sfmData.getConstraints2D().empty() ||
+                                    !sfmData.getRotationPriors().empty();
+
+  // rigs and constraints link views of any cluster, the scene is adjusted with a single problem
+  if(hasGlobalConstraints || viewsGraph.size() <= _options.maxClusterSize)
+  {
+    BundleAdjustmentCeres BA(_options.ceresOptions);
+    const bool success = BA.adjust(sfmData, refineOptions);
+
+    _statistics.nbClusters = 1;
+    _statistics.maxClusterSize = viewsGraph.size();
+    _statistics.maxNbResidualBlocks = BA.getStatistics().nbResidualBlocks;
+    _statistics.clustersTime = BA.getStatistics().time;
+    _statistics.RMSEinitial = BA.getStatistics().RMSEinitial;
+    _statistics.RMSEfinal = BA.getStatistics().RMSEfinal;
+    return success;
+  }
+
+  const std::vector<std::set<IndexT>> clusters = growClusters(viewsGraph, _options.maxClusterSize);
+
+  std::map<IndexT, std::size_t> clusterPerView;
+  for(std::size_t cluster = 0; cluster < clusters.size(); ++cluster)
+  {
+    for(const IndexT viewId : clusters.at(cluster))
+      clusterPerView[viewId] = cluster;
+    _statistics.maxClusterSize = std::max(_statistics.maxClusterSize, clusters.at(cluster).size());
+  }
+  _statistics.nbClusters = clusters.size();
+
+  // separator views: linked to a view of another cluster
+  std::set<IndexT> separatorViews;
+  for(const auto& viewPair : viewsGraph)
+  {
+    const std::size_t cluster = clusterPerView.at(viewPair.first);
+    if(std::any_of(viewPair.second.begin(), viewPair.second.end(), [&](IndexT neighborId){ return clusterPerView.at(neighborId) != cluster; }))
+      separatorViews.insert(viewPair.first);
+  }
+
+  // separator landmarks: observed by several clusters
+  std::set<IndexT> separatorLandmarks;
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    std::size_t firstCluster = sharedOwner;
+    for(const auto& observationPair : landmarkPair.second.observations)
+    {
+      const auto it = clusterPerView.find(observationPair.first);
+      if(it == clusterPerView.end())
+        continue;
+      if(firstCluster == sharedOwner)
+        firstCluster = it->second;
+      else if(it->second != firstCluster)
+      {
+        separatorLandmarks.insert(landmarkPair.first);
+        break;
+      }
+    }
+  }
+
+  // separator blocks: connected separator views, of at most the cluster size
+  ViewsGraph separatorGraph;
+  for(const IndexT viewId : separatorViews)
+  {
+    std::set<IndexT>& neighbors = separatorGraph[viewId];
+    for(const IndexT neighborId : viewsGraph.at(viewId))
+    {
+      if(separatorViews.count(neighborId))
+        neighbors.insert(neighborId);
+    }
+  }
+  const std::vector<std::set<IndexT>> separatorBlocks = growClusters(separatorGraph, _options.maxClusterSize);
+  for(const std::set<IndexT>& block : separatorBlocks)
+    _statistics.maxSeparatorBlockSize = std::max(_statistics.maxSeparatorBlockSize, block.size());
+
+  _statistics.nbSeparatorViews = separatorViews.size();
+  _statistics.nbSeparatorLandmarks = separatorLandmarks.size();
+  _statistics.RMSEinitial = RMSE(sfmData);
+
+  ALICEVISION_LOG_INFO("Partitioned Bundle Adjustment: " << clusters.size() << " clusters of at most " << _statistics.maxClusterSize << " views, "
+                       << separatorViews.size() << " separator views in " << separatorBlocks.size() << " blocks and "
+                       << separatorLandmarks.size() << " separator landmarks.");
+
+  for(std::size_t round = 0; round < _options.nbRounds; ++round)
+  {
+    if(!adjustClusters(sfmData, refineOptions, clusters, clusterPerView))
+      return false;
+
+    if(!separatorViews.empty() || !separatorLandmarks.empty())
+      adjustSeparator(sfmData, refineOptions, separatorBlocks, separatorLandmarks);
+  }
+
+  // propagate the last separator update to the clusters
+  const bool success = adjustClusters(sfmData, refineOptions, clusters, clusterPerView);
+
+  _statistics.RMSEfinal = RMSE(sfmData);
+  return success;
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,215 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/sfm/BundleAdjustment.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+
+namespace aliceVision {
+
+namespace sfmData {
+class SfMData;
+} // namespace sfmData
+
+namespace sfm {
+
+/**
+ * @brief Bundle adjustment of very large scenes by partition of the camera graph.
+ *
+ * The posed views are split into clusters of connected views, using the edges of the
+ * LocalBundleAdjustmentGraph (views sharing enough landmarks). Then, for each round:
+ *  - the clusters are adjusted in parallel, each one in its own sub-scene: the poses of the cluster
+ *    and the landmarks it observes are refined, the views of the other clusters observing
+ *    these landmarks (the overlap) are constant.
+ *  - the clusters are merged: each pose comes from its cluster and the landmarks observed by
+ *    several clusters (the separator landmarks) are averaged.
+ *  - the global consistency is restored on the separator: the views linked to another cluster
+ *    (the separator views) and the separator landmarks are refined, the other views and landmarks
+ *    they depend on are constant. The separator views are split into blocks of connected views
+ *    of at most the cluster size, adjusted one after the other, and the separator landmarks
+ *    not observed by a separator view are adjusted by groups observed by at most as many views.
+ * A last cluster adjustment propagates the separator update to the clusters.
+ *
+ * The clusters are disjoint, so the size of each Ceres problem is bounded by the cluster size
+ * instead of the scene size.
+ */
+class BundleAdjustmentPartitioned : public BundleAdjustment
+{
+public:
+
+  struct Options
+  {
+    Options()
+    {
+      ceresOptions.setSparseBA();
+      ceresOptions.summary = false;
+      ceresOptions.verbose = false;
+    }
+
+    /// maximum number of views of a cluster
+    std::size_t maxClusterSize = 500;
+    /// minimum number of shared landmarks to link two views in the camera graph
+    std::size_t minNbOfMatches = 50;
+    /// number of cluster and separator adjustment rounds
+    std::size_t nbRounds = 2;
+    /// number of clusters adjusted in parallel (0: all the available threads)
+    unsigned int nbThreads = 0;
+    /// Ceres options of the separator problem (the clusters are adjusted with a single thread each)
+    BundleAdjustmentCeres::CeresOptions ceresOptions;
+  };
+
+  struct Statistics
+  {
+    /// number of clusters
+    std::size_t nbClusters = 0;
+    /// number of views of the largest cluster
+    std::size_t maxClusterSize = 0;
+    /// number of separator views
+    std::size_t nbSeparatorViews = 0;
+    /// number of separator landmarks
+    std::size_t nbSeparatorLandmarks = 0;
+    /// number of separator problems of a round
+    std::size_t nbSeparatorBlocks = 0;
+    /// number of refined views of the largest separator block
+    std::size_t maxSeparatorBlockSize = 0;
+    /// number of residual blocks of the largest Ceres problem
+    std::size_t maxNbResidualBlocks = 0;
+    /// number of cluster problems without usable solution
+    std::size_t nbFailedClusters = 0;
+    /// time spent to adjust the clusters (s)
+    double clustersTime = 0.0;
+    /// time spent to adjust the separator (s)
+    double separatorTime = 0.0;
+    /// RMSE of the whole scene before the adjustment
+    double RMSEinitial = 0.0;
+    /// RMSE of the whole scene after the adjustment
+    double RMSEfinal = 0.0;
+
+    /**
+     * @brief Log statistics about the partitioned bundle adjustment
+     */
+    void show() const;
+  };
+
+  /**
+   * @brief BundleAdjustmentPartitioned constructor
+   * @param[in] options The partition and Ceres options
+   */
+  explicit BundleAdjustmentPartitioned(const BundleAdjustmentPartitioned::Options& options = Options())
+    : _options(options)
+  {}
+
+  /**
+   * @brief Split the posed views of the scene into clusters of connected views
+   * @details Greedy region growing on the camera graph: a cluster starts from the first free view
+   *          and grows in breadth-first order until it reaches the maximum size.
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] maxClusterSize The maximum number of views of a cluster
+   * @param[in] minNbOfMatches The minimum number of shared landmarks to link two views
+   * @return the views of each cluster
+   */
+  static std::vector<std::set<IndexT>> computeClusters(const sfmData::SfMData& sfmData,
+                                                       std::size_t maxClusterSize,
+                                                       std::size_t minNbOfMatches);
+
+  /**
+   * @brief Perform a partitioned Bundle Adjustment on the SfM scene with refinement of the requested parameters
+   * @note Scenes with rigs, 2D constraints, rotation priors or not larger than a cluster are adjusted with a single problem.
+   * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @return false if the bundle adjustment failed else true
+   * @see BundleAdjustment::Adjust
+   */
+  bool adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions = REFINE_ALL) override;
+
+  /**
+   * @brief Get bundle adjustment statistics structure
+   * @return statistics structure const ref
+   */
+  inline const Statistics& getStatistics() const
+  {
+    return _statistics;
+  }
+
+private:
+
+  /// views linked to each view in the camera graph
+  using ViewsGraph = std::map<IndexT, std::set<IndexT>>;
+
+  /**
+   * @brief Build the camera graph of the posed views
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] minNbOfMatches The minimum number of shared landmarks to link two views
+   * @return the views linked to each posed view
+   */
+  static ViewsGraph computeViewsGraph(const sfmData::SfMData& sfmData, std::size_t minNbOfMatches);
+
+  /**
+   * @brief Split the camera graph into clusters by greedy region growing
+   * @param[in] viewsGraph The views linked to each posed view
+   * @param[in] maxClusterSize The maximum number of views of a cluster
+   * @return the views of each cluster
+   */
+  static std::vector<std::set<IndexT>> growClusters(const ViewsGraph& viewsGraph, std::size_t maxClusterSize);
+
+  /**
+   * @brief Adjust each cluster with the views of the other clusters constant, in parallel, and merge the solutions
+   * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @param[in] clusters The views of each cluster
+   * @param[in] clusterPerView The cluster index of each posed view
+   * @return false if no cluster has a usable solution
+   */
+  bool adjustClusters(sfmData::SfMData& sfmData,
+                      ERefineOptions refineOptions,
+                      const std::vector<std::set<IndexT>>& clusters,
+                      const std::map<IndexT, std::size_t>& clusterPerView);
+
+  /**
+   * @brief Adjust the separator views and landmarks with the rest of the scene constant,
+   *        one block of separator views after the other
+   * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @param[in] separatorBlocks The separator views (linked to a view of another cluster) of each block
+   * @param[in] separatorLandmarks The landmarks observed by several clusters
+   * @return false if the bundle adjustment of a block failed else true
+   */
+  bool adjustSeparator(sfmData::SfMData& sfmData,
+                       ERefineOptions refineOptions,
+                       const std::vector<std::set<IndexT>>& separatorBlocks,
+                       const std::set<IndexT>& separatorLandmarks);
+
+  /**
+   * @brief Adjust a block of the separator with the rest of the scene constant
+   * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+   * @param[in] refineOptions The chosen refine flag
+   * @param[in] blockViews The separator views of the block
+   * @param[in] blockLandmarks The landmarks observed by the block views and the separator landmarks of the block
+   * @param[in] separatorLandmarks The landmarks observed by several clusters
+   * @return false if the bundle adjustment failed else true
+   */
+  bool adjustSeparatorBlock(sfmData::SfMData& sfmData,
+                            ERefineOptions refineOptions,
+                            const std::set<IndexT>& blockViews,
+                            const std::vector<IndexT>& blockLandmarks,
+                            const std::set<IndexT>& separatorLandmarks);
+
+  /// user options
+  Options _options;
+  /// last adjustment statistics
+  Statistics _statistics;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -19,6 +19,97 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace sfm {
 
+namespace {
+
+/// get the sorted ids of the tracks visible in a view
+const track::TrackIdSet& getTracksInView(const track::TracksPerView& tracksPerView, IndexT viewId)
+{
+  return tracksPerView.at(viewId);
+}
+
+track::CompactTracks::TrackIdRange getTracksInView(const track::CompactTracks& tracks, IndexT viewId)
+{
+  return tracks.getTracksInView(viewId);
+}
+
+/// see LocalBundleAdjustmentGraph::getNewEdges
+template<class TracksPerViewT>
+std::vector<Pair> computeNewEdges(
+    const sfmData::SfMData& sfmData,
+    const TracksPerViewT& tracksPerView,
+    const std::set<IndexT>& newViewsId,
+    const std::size_t minNbOfMatches,
+    const std::size_t minNbOfEdgesPerView)
+{
+  std::vector<Pair> newEdges;
+  
+  // get landmarks id. of all the reconstructed 3D points (: landmarks)
+  // TODO: avoid copy and use boost::transform_iterator
+  std::set<IndexT> landmarkIds;
+  std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(),
+                 std::inserter(landmarkIds, landmarkIds.begin()),
+                 stl::RetrieveKey());
+  
+  for(IndexT viewId: newViewsId)
+  {
+    std::map<IndexT, std::size_t> sharedLandmarksPerView;
+
+    // get all the tracks of the new added view
+    const auto newViewTrackIds = getTracksInView(tracksPerView, viewId);
+    
+    // keep the reconstructed tracks (with an associated landmark)
+    std::vector<IndexT> newViewLandmarks; // all landmarks (already reconstructed) visible from the new view
+    
+    newViewLandmarks.reserve(newViewTrackIds.size());
+    std::set_intersection(newViewTrackIds.begin(), newViewTrackIds.end(),
+                          landmarkIds.begin(), landmarkIds.end(),
+                          std::back_inserter(newViewLandmarks));
+    
+    // retrieve the common track Ids
+    for(IndexT landmarkId: newViewLandmarks)
+    {
+      for(const auto& observations: sfmData.getLandmarks().at(landmarkId).observations)
+      {
+        if(observations.first == viewId)
+          continue; // do not compare an observation with itself
+        
+        // increment the number of common landmarks between the new view and the already
+        // reconstructed cameras (observations).
+        auto it = sharedLandmarksPerView.find(observations.first);
+        if(it == sharedLandmarksPerView.end())  // the first common landmark
+          sharedLandmarksPerView[observations.first] = 1;
+        else
+          ++it->second;
+      }
+    }
+
+    using ViewNbLandmarks = std::pair<IndexT, std::size_t>;
+
+    std::vector<ViewNbLandmarks> sharedLandmarksPerViewSorted;
+    sharedLandmarksPerViewSorted.reserve(sharedLandmarksPerView.size());
+    for(const auto& sharedLandmarkPair: sharedLandmarksPerView)
+      sharedLandmarksPerViewSorted.push_back(sharedLandmarkPair);
+
+    std::sort(sharedLandmarksPerViewSorted.begin(), sharedLandmarksPerViewSorted.end(), [](const ViewNbLandmarks& a, const ViewNbLandmarks& b){ return (a.second > b.second); });
+
+    std::size_t nbEdgesPerView = 0;
+    for(const ViewNbLandmarks& sharedLandmarkPair : sharedLandmarksPerViewSorted)
+    {
+      if(nbEdgesPerView >= minNbOfEdgesPerView &&
+         sharedLandmarkPair.second < minNbOfMatches)
+        break;
+
+      // edges format: pair<min_viewid, max_viewid>
+      newEdges.emplace_back(std::min(viewId, sharedLandmarkPair.first), std::max(viewId, sharedLandmarkPair.first));
+      ++nbEdgesPerView;
+    }
+  }
+  return newEdges;
+}
+
+} // namespace
+
+
 LocalBundleAdjustmentGraph::LocalBundleAdjustmentGraph(const sfmData::SfMData& sfmData)
 {
   for(const auto& it : sfmData.getIntrinsics())
@@ -234,6 +325,25 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
     const track::TracksPerView& map_tracksPerView,
     const std::set<IndexT>& newReconstructedViews,
     const std::size_t minNbOfMatches)
+{
+  addNewViews(sfmData, map_tracksPerView, newReconstructedViews, minNbOfMatches);
+}
+
+void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
+    const sfmData::SfMData& sfmData,
+    const track::CompactTracks& tracks,
+    const std::set<IndexT>& newReconstructedViews,
+    const std::size_t minNbOfMatches)
+{
+  addNewViews(sfmData, tracks, newReconstructedViews, minNbOfMatches);
+}
+
+template<class TracksPerViewT>
+void LocalBundleAdjustmentGraph::addNewViews(
+    const sfmData::SfMData& sfmData,
+    const TracksPerViewT& tracksPerView,
+    const std::set<IndexT>& newReconstructedViews,
+    const std::size_t minNbOfMatches)
 {
   // identify the views we need to add to the graph:
   // - this is the first Local BA: the graph is still empty, so add all the posed views of the scene
@@ -291,7 +401,7 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
     // each new view need to be connected to the graph
     // we create the 'minNbOfEdgesPerView' best edges and all the other with more than 'minNbOfMatches' shared landmarks
     const std::size_t minNbOfEdgesPerView = 10;
-    std::vector<Pair> newEdges = getNewEdges(sfmData, map_tracksPerView, addedViewsId, minNbOfMatches, minNbOfEdgesPerView);
+    std::vector<Pair> newEdges = getNewEdges(sfmData, tracksPerView, addedViewsId, minNbOfMatches, minNbOfEdgesPerView);
     numAddedEdges = newEdges.size();
 
     for(const Pair& edge: newEdges)
@@ -440,72 +550,18 @@ std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
     const std::size_t minNbOfMatches,
     const std::size_t minNbOfEdgesPerView)
 {
-  std::vector<Pair> newEdges;
-  
-  // get landmarks id. of all the reconstructed 3D points (: landmarks)
-  // TODO: avoid copy and use boost::transform_iterator
-  std::set<IndexT> landmarkIds;
-  std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(),
-                 std::inserter(landmarkIds, landmarkIds.begin()),
-                 stl::RetrieveKey());
-  
-  for(IndexT viewId: newViewsId)
-  {
-    std::map<IndexT, std::size_t> sharedLandmarksPerView;
-
-    // get all the tracks of the new added view
-    const aliceVision::track::TrackIdSet& newViewTrackIds = tracksPerView.at(viewId);
-    
-    // keep the reconstructed tracks (with an associated landmark)
-    std::vector<IndexT> newViewLandmarks; // all landmarks (already reconstructed) visible from the new view
-    
-    newViewLandmarks.reserve(newViewTrackIds.size());
-    std::set_intersection(newViewTrackIds.begin(), newViewTrackIds.end(),
-                          landmarkIds.begin(), landmarkIds.end(),
-                          std::back_inserter(newViewLandmarks));
-    
-    // retrieve the common track Ids
-    for(IndexT landmarkId: newViewLandmarks)
-    {
-      for(const auto& observations: sfmData.getLandmarks().at(landmarkId).observations)
-      {
-        if(observations.first == viewId)
-          continue; // do not compare an observation with itself
-        
-        // increment the number of common landmarks between the new view and the already
-        // reconstructed cameras (observations).
-        auto it = sharedLandmarksPerView.find(observations.first);
-        if(it == sharedLandmarksPerView.end())  // the first common landmark
-          sharedLandmarksPerView[observations.first] = 1;
-        else
-          ++it->second;
-      }
-    }
-
-    using ViewNbLandmarks = std::pair<IndexT, std::size_t>;
-
-    std::vector<ViewNbLandmarks> sharedLandmarksPerViewSorted;
-    sharedLandmarksPerViewSorted.reserve(sharedLandmarksPerView.size());
-    for(const auto& sharedLandmarkPair: sharedLandmarksPerView)
-      sharedLandmarksPerViewSorted.push_back(sharedLandmarkPair);
-
-    std::sort(sharedLandmarksPerViewSorted.begin(), sharedLandmarksPerViewSorted.end(), [](const ViewNbLandmarks& a, const ViewNbLandmarks& b){ return (a.second > b.second); });
-
-    std::size_t nbEdgesPerView = 0;
-    for(const ViewNbLandmarks& sharedLandmarkPair : sharedLandmarksPerViewSorted)
-    {
-      if(nbEdgesPerView >= minNbOfEdgesPerView &&
-         sharedLandmarkPair.second < minNbOfMatches)
-        break;
-
-      // edges format: pair<min_viewid, max_viewid>
-      newEdges.emplace_back(std::min(viewId, sharedLandmarkPair.first), std::max(viewId, sharedLandmarkPair.first));
-      ++nbEdgesPerView;
-    }
-  }
-  return newEdges;
+  return computeNewEdges(sfmData, tracksPerView, newViewsId, minNbOfMatches, minNbOfEdgesPerView);
 }
 
+std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
+    const sfmData::SfMData& sfmData,
+    const track::CompactTracks& tracks,
+    const std::set<IndexT>& newViewsId,
+    const std::size_t minNbOfMatches,
+    const std::size_t minNbOfEdgesPerView)
+{
+  return computeNewEdges(sfmData, tracks, newViewsId, minNbOfMatches, minNbOfEdgesPerView);
+}
 void LocalBundleAdjustmentGraph::checkFocalLengthsConsistency(const std::size_t windowSize, const double stdevPercentageLimit)
 {
   ALICEVISION_LOG_DEBUG("Checking, for each camera, if the focal length is stable...");
@@ -133,7 +133,37 @@ public:
    * @param[in] sfmData contains all the information about the reconstruction
    */
   void setAllParametersToRefine(const sfmData::SfMData& sfmData);
- 
+
+  /**
+   * @brief Set the BundleAdjustment::EParameterState of a specific pose.
+   * @param[in] poseId The given pose Id
+   * @param[in] state The given BundleAdjustment::EParameterState
+   */
+  inline void setPoseState(const IndexT poseId, BundleAdjustment::EParameterState state)
+  {
+    _statePerPoseId[poseId] = state;
+  }
+
+  /**
+   * @brief Set the BundleAdjustment::EParameterState of a specific intrinsic.
+   * @param[in] intrinsicId The given intrinsic Id
+   * @param[in] state The given BundleAdjustment::EParameterState
+   */
+  inline void setIntrinsicState(const IndexT intrinsicId, BundleAdjustment::EParameterState state)
+  {
+    _statePerIntrinsicId[intrinsicId] = state;
+  }
+
+  /**
+   * @brief Set the BundleAdjustment::EParameterState of a specific landmark.
+   * @param[in] landmarkId The given landmark Id
+   * @param[in] state The given BundleAdjustment::EParameterState
+   */
+  inline void setLandmarkState(const IndexT landmarkId, BundleAdjustment::EParameterState state)
+  {
+    _statePerLandmarkId[landmarkId] = state;
+  }
+
   /**
    * @brief Save all the intrinsics to the memory to retain the evolution of each focal length during the reconstruction.
    * @param[in] sfmData contains all the information about the reconstruction notably current focal lengths
@@ -167,6 +197,18 @@ public:
       const track::TracksPerView& map_tracksPerView, 
       const std::set<IndexT>& newImageIndex,
       const std::size_t kMinNbOfMatches = 50);
+
+  /**
+   * @brief Complete the graph with the newly resected views or all the posed views if the graph is empty.
+   * @param[in] sfmData contains all the information about the reconstruction
+   * @param[in] tracks All the tracks of the scene, with their reverse index giving the tracks for each view
+   * @param[in] newReconstructedViews The list of the newly resected views
+   * @param[in] kMinNbOfMatches The min. number of shared matches to create an edge between two views (nodes)
+   */
+  void updateGraphWithNewViews(const sfmData::SfMData& sfmData,
+      const track::CompactTracks& tracks,
+      const std::set<IndexT>& newImageIndex,
+      const std::size_t kMinNbOfMatches = 50);
   
   /**
    * @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected views.
@@ -218,7 +260,43 @@ public:
    */
   unsigned int countEdges() const;
 
+  /**
+   * @brief Count the number of shared landmarks between all the new views and each already resected cameras.
+   * @param[in] sfmData contains all the information about the reconstruction
+   * @param[in] map_tracksPerView A map giving the tracks for each view
+   * @param[in] newViewsId A set with the views index that we want to count matches with resected cameras.
+   * @return A map giving the number of matches for each images pair.
+   */
+  static std::vector<Pair> getNewEdges(const sfmData::SfMData& sfmData,
+      const track::TracksPerView& map_tracksPerView,
+      const std::set<IndexT>& newViewsId,
+      const std::size_t minNbOfMatches,
+      const std::size_t minNbOfEdgesPerView);
+
+  /**
+   * @brief Count the number of shared landmarks between all the new views and each already resected cameras.
+   * @param[in] sfmData contains all the information about the reconstruction
+   * @param[in] tracks All the tracks of the scene, with their reverse index giving the tracks for each view
+   * @param[in] newViewsId A set with the views index that we want to count matches with resected cameras.
+   * @return A map giving the number of matches for each images pair.
+   */
+  static std::vector<Pair> getNewEdges(const sfmData::SfMData& sfmData,
+      const track::CompactTracks& tracks,
+      const std::set<IndexT>& newViewsId,
+      const std::size_t minNbOfMatches,
+      const std::size_t minNbOfEdgesPerView);
+
 private:
+
+  /**
+   * @brief Complete the graph with the newly resected views, see updateGraphWithNewViews.
+   * @param[in] tracksPerView The tracks for each view, as a TracksPerView or a CompactTracks
+   */
+  template<class TracksPerViewT>
+  void addNewViews(const sfmData::SfMData& sfmData,
+      const TracksPerViewT& tracksPerView,
+      const std::set<IndexT>& newReconstructedViews,
+      const std::size_t minNbOfMatches);
   
   /**
    * @brief Return the distance between a specific pose and the new posed views.
@@ -267,19 +345,6 @@ private:
    */
   void checkFocalLengthsConsistency(const std::size_t windowSize, const double stdevPercentageLimit);
   
-  /**
-   * @brief Count the number of shared landmarks between all the new views and each already resected cameras.
-   * @param[in] sfmData contains all the information about the reconstruction
-   * @param[in] map_tracksPerView A map giving the tracks for each view
-   * @param[in] newViewsId A set with the views index that we want to count matches with resected cameras.
-   * @return A map giving the number of matches for each images pair.
-   */
-  static std::vector<Pair> getNewEdges(const sfmData::SfMData& sfmData,
-      const track::TracksPerView& map_tracksPerView,
-      const std::set<IndexT>& newViewsId,
-      const std::size_t minNbOfMatches,
-      const std::size_t minNbOfEdgesPerView);
-  
   /**
    * @brief Return the state of the focal length (constant or not) for a specific intrinsic.
    * @param intrinsicId To update the focal lengths states, use \c LocalBundleAdjustmentGraph::checkFocalLengthsConsistency()
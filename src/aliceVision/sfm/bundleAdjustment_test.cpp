@@ -242,6 +242,116 @@ BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_Camer
   BOOST_CHECK_LT(dResidual_after, dResidual_before);
 }
 
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_IncrementalProblem)
+{
+  const int nviews = 4;
+  const int npoints = 8;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene, without the last point
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+  sfmData.getLandmarks().erase(npoints - 1);
+
+  BundleAdjustmentCeres::CeresOptions options;
+  options.setDenseBA();
+  options.incrementalProblem = true;
+
+  BundleAdjustmentCeres incrementalBA(options);
+
+  // first adjustment: all the residual blocks are added to a new problem
+  BOOST_CHECK( incrementalBA.adjust(sfmData) );
+  BOOST_CHECK_EQUAL(incrementalBA.getStatistics().nbAddedResidualBlocks, nviews * (npoints - 1));
+  BOOST_CHECK_EQUAL(incrementalBA.getStatistics().nbRemovedResidualBlocks, 0);
+
+  // same adjusted scene, refined with a new problem
+  SfMData sfmData_newProblem = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+  const Landmark newLandmark = sfmData_newProblem.getLandmarks().at(npoints - 1);
+  sfmData_newProblem.getPoses() = sfmData.getPoses();
+  sfmData_newProblem.structure = sfmData.structure;
+  sfmData_newProblem.getIntrinsics().at(0)->updateFromParams(sfmData.getIntrinsics().at(0)->getParams());
+
+  // scene changes: a new point, a removed point and a removed observation
+  for(SfMData* scene : {&sfmData, &sfmData_newProblem})
+  {
+    scene->getLandmarks()[npoints - 1] = newLandmark;
+    scene->getLandmarks().erase(0);
+    scene->getLandmarks().at(1).observations.erase(3);
+  }
+
+  // second adjustment: only the changes are applied to the problem
+  BOOST_CHECK( incrementalBA.adjust(sfmData) );
+  BOOST_CHECK_EQUAL(incrementalBA.getStatistics().nbAddedResidualBlocks, nviews);
+  BOOST_CHECK_EQUAL(incrementalBA.getStatistics().nbRemovedResidualBlocks, nviews + 1);
+
+  options.incrementalProblem = false;
+  BundleAdjustmentCeres BA(options);
+  BOOST_CHECK( BA.adjust(sfmData_newProblem) );
+  BOOST_CHECK_EQUAL(BA.getStatistics().nbAddedResidualBlocks, nviews * (npoints - 1) - 1);
+
+  // same solution
+  for(const auto& posePair : sfmData.getPoses())
+  {
+    const Pose3& pose = posePair.second.getTransform();
+    const Pose3& pose_newProblem = sfmData_newProblem.getPoses().at(posePair.first).getTransform();
+    BOOST_CHECK_SMALL((pose.center() - pose_newProblem.center()).norm(), 1e-6);
+    BOOST_CHECK_SMALL((pose.rotation() - pose_newProblem.rotation()).norm(), 1e-6);
+  }
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+    BOOST_CHECK_SMALL((landmarkPair.second.X - sfmData_newProblem.getLandmarks().at(landmarkPair.first).X).norm(), 1e-6);
+
+  BOOST_CHECK_SMALL(RMSE(sfmData) - RMSE(sfmData_newProblem), 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_Partitioned)
+{
+  const int nviews = 12;
+  const int npoints = 20;
+  const std::size_t maxClusterSize = 4;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // all the points are visible by all the views: clusters of consecutive views
+  const std::vector<std::set<IndexT>> clusters = BundleAdjustmentPartitioned::computeClusters(sfmData, maxClusterSize, npoints);
+  BOOST_CHECK_EQUAL(clusters.size(), nviews / maxClusterSize);
+
+  std::set<IndexT> clusteredViews;
+  for(const std::set<IndexT>& cluster : clusters)
+  {
+    BOOST_CHECK_LE(cluster.size(), maxClusterSize);
+    clusteredViews.insert(cluster.begin(), cluster.end());
+  }
+  BOOST_CHECK_EQUAL(clusteredViews.size(), nviews);
+
+  const double dResidual_before = RMSE(sfmData);
+
+  BundleAdjustmentPartitioned::Options options;
+  options.maxClusterSize = maxClusterSize;
+  options.minNbOfMatches = npoints;
+  options.ceresOptions.setDenseBA();
+
+  BundleAdjustmentPartitioned BA(options);
+  BOOST_CHECK( BA.adjust(sfmData) );
+
+  const BundleAdjustmentPartitioned::Statistics& statistics = BA.getStatistics();
+  BOOST_CHECK_EQUAL(statistics.nbClusters, clusters.size());
+  BOOST_CHECK_EQUAL(statistics.maxClusterSize, maxClusterSize);
+  BOOST_CHECK_EQUAL(statistics.nbFailedClusters, 0);
+  BOOST_CHECK_EQUAL(statistics.nbSeparatorLandmarks, npoints);
+  // all the views are linked to another cluster, the separator is split like the views
+  BOOST_CHECK_EQUAL(statistics.nbSeparatorViews, nviews);
+  BOOST_CHECK_EQUAL(statistics.nbSeparatorBlocks, nviews / maxClusterSize);
+  BOOST_CHECK_LE(statistics.maxSeparatorBlockSize, maxClusterSize);
+
+  const double dResidual_after = RMSE(sfmData);
+  BOOST_CHECK_LT(dResidual_after, dResidual_before);
+  BOOST_CHECK_SMALL(statistics.RMSEfinal - dResidual_after, 1e-6);
+}
+
 /// Compute the Root Mean Square Error of the residuals
 double RMSE(const SfMData & sfm_data)
 {
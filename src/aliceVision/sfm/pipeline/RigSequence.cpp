@@ -24,13 +24,17 @@ IndexT getRigPoseId(IndexT rigId, IndexT frameId)
   return static_cast<IndexT>(rigPoseId);
 }
 
-double computeCameraScore(const SfMData& sfmData, const track::TracksPerView& tracksPerView, IndexT viewId)
+/**
+ * @brief Compute the pose score of a view, sum of inverse reprojection errors
+ * @param[in] tracksIds The sorted ids of the tracks used by the view
+ */
+template<class TrackIdsT>
+double computeCameraScore(const SfMData& sfmData, const TrackIdsT& tracksIds, IndexT viewId)
 {
   std::set<std::size_t> viewLandmarks;
   {
     // A. Compute 2D/3D matches
-    // A1. list tracks ids used by the view
-    const aliceVision::track::TrackIdSet& tracksIds = tracksPerView.at(static_cast<std::size_t>(viewId));
+    // A1. tracksIds lists the tracks ids used by the view
 
     // A2. intersects the track list with the reconstructed
     std::set<std::size_t> reconstructedTrackId;
@@ -76,6 +80,20 @@ double computeCameraScore(const SfMData& sfmData, const track::TracksPerView& tr
 
 
 void RigSequence::init(const track::TracksPerView& tracksPerView)
+{
+  initRigInfo([&](IndexT viewId) {
+    return computeCameraScore(_sfmData, tracksPerView.at(static_cast<std::size_t>(viewId)), viewId);
+  });
+}
+
+void RigSequence::init(const track::CompactTracks& tracks)
+{
+  initRigInfo([&](IndexT viewId) {
+    return computeCameraScore(_sfmData, tracks.getTracksInView(viewId), viewId);
+  });
+}
+
+void RigSequence::initRigInfo(const std::function<double(IndexT)>& computeViewScore)
 {
   for(const auto& viewPair : _sfmData.getViews())
   {
@@ -88,7 +106,7 @@ void RigSequence::init(const track::TracksPerView& tracksPerView)
       // compute pose score, sum of inverse reprojection errors
       if(_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
       {
-        score = computeCameraScore(_sfmData, tracksPerView, view.getViewId());
+        score = computeViewScore(view.getViewId());
 
         // add one to the number of poses for this rig relative sub-pose
         _rigInfoPerSubPose[view.getSubPoseId()].nbPose++;
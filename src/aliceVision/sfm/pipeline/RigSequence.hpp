@@ -9,6 +9,8 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 
+#include <functional>
+
 namespace aliceVision {
 namespace sfm {
 
@@ -28,6 +30,12 @@ public:
    */
   void init(const track::TracksPerView& tracksPerView);
 
+  /**
+   * @brief RigSequence initialization
+   * build internal structures from the tracks reverse index
+   */
+  void init(const track::CompactTracks& tracks);
+
   /**
    * @brief Calibrate new possible rigs or update independent poses to rig poses
    * @param[in,out] updatedViews add the updated view ids to the list
@@ -37,6 +45,12 @@ public:
 
 private:
 
+  /**
+   * @brief Build the internal structures
+   * @param[in] computeViewScore Computes the pose score of a reconstructed view
+   */
+  void initRigInfo(const std::function<double(IndexT)>& computeViewScore);
+
   void computeScores();
   void setupRelativePoses();
   void rigResection(std::set<IndexT>& updatedViews);
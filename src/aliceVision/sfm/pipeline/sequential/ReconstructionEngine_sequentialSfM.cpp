@@ -11,6 +11,7 @@
 #include <aliceVision/sfm/utils/statistics.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentPartitioned.hpp>
 #include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
 #include <aliceVision/sfm/sfmFilters.hpp>
 #include <aliceVision/sfm/sfmStatistics.hpp>
@@ -59,8 +60,7 @@ using namespace aliceVision::sfmData;
  * @brief Compute indexes of all features in a fixed size pyramid grid.
  * These precomputed values are useful to the next best view selection for incremental SfM.
  *
- * @param[in] tracksPerView: The list of TrackID per view
- * @param[in] map_tracks: All putative tracks
+ * @param[in] map_tracks: All putative tracks, with the list of TrackID per view
  * @param[in] views: All views
  * @param[in] featuresProvider: Input features and descriptors
  * @param[in] pyramidDepth: Depth of the pyramid.
@@ -68,8 +68,7 @@ using namespace aliceVision::sfmData;
  *             Precomputed list of pyramid cells ID for each track in each view.
  */
 void computeTracksPyramidPerView(
-    const track::TracksPerView& tracksPerView,
-    const track::TracksMap& map_tracks,
+    const track::CompactTracks& map_tracks,
     const Views& views,
     const feature::FeaturesPerView& featuresProvider,
     const std::size_t pyramidBase,
@@ -86,17 +85,16 @@ void computeTracksPyramidPerView(
     start += Square(widthPerLevel[level]);
   }
 
-  tracksPyramidPerView.reserve(tracksPerView.size());
-  for(const auto& viewTracks: tracksPerView)
+  tracksPyramidPerView.reserve(map_tracks.getViewIds().size());
+  for(const IndexT viewId: map_tracks.getViewIds())
   {
-    auto& trackPyramid = tracksPyramidPerView[viewTracks.first];
+    auto& trackPyramid = tracksPyramidPerView[viewId];
     // reserve 500 tracks in each view
     trackPyramid.reserve(500 * pyramidDepth);
   }
 
-  for(const auto& viewTracks: tracksPerView)
+  for(const IndexT viewId: map_tracks.getViewIds())
   {
-    const auto viewId = viewTracks.first;
     auto& tracksPyramidIndex = tracksPyramidPerView[viewId];
     const View& view = *views.at(viewId).get();
     std::vector<double> cellWidthPerLevel(pyramidDepth);
@@ -106,10 +104,9 @@ void computeTracksPyramidPerView(
       cellWidthPerLevel[level] = (double)view.getWidth() / (double)widthPerLevel[level];
       cellHeightPerLevel[level] = (double)view.getHeight() / (double)widthPerLevel[level];
     }
-    for(std::size_t i = 0; i < viewTracks.second.size(); ++i)
+    for(const std::size_t trackId: map_tracks.getTracksInView(viewId))
     {
-      const std::size_t trackId = viewTracks.second[i];
-      const track::Track& track = map_tracks.at(trackId);
+      const track::CompactTracks::TrackRef track = map_tracks.at(trackId);
       const std::size_t featIndex = track.featPerView.at(viewId);
       const auto& feature = featuresProvider.getFeatures(viewId, track.descType)[featIndex]; 
       
@@ -193,7 +190,7 @@ bool ReconstructionEngine_sequentialSfM::process()
       if(!reconstructedViews.empty())
       {
         // Add the reconstructed views to the LocalBA graph
-        _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, reconstructedViews, _params.kMinNbOfMatches);
+        _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracks, reconstructedViews, _params.kMinNbOfMatches);
         _localStrategyGraph->updateRigEdgesToTheGraph(_sfmData);
       }
     }
@@ -238,35 +235,25 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
     const aliceVision::matching::PairwiseMatches& matches = *_pairwiseMatches;
 
     ALICEVISION_LOG_DEBUG("Track building");
-    tracksBuilder.build(matches);
+    tracksBuilder.build(matches, _params.multithreadedTracksBuilding);
 
     ALICEVISION_LOG_DEBUG("Track filtering");
     tracksBuilder.filter(true,_params.filterTrackForks, _params.minInputTrackLength);
 
     ALICEVISION_LOG_DEBUG("Track export to internal structure");
-    // build tracks with STL compliant type
-    tracksBuilder.exportToSTL(_map_tracks);
-    ALICEVISION_LOG_DEBUG("Build tracks per view");
-
-    // Init tracksPerView to have an entry in the map for each view (even if there is no track at all)
-    for(const auto& viewIt: _sfmData.views)
-    {
-        // create an entry in the map
-        _map_tracksPerView[viewIt.first];
-    }
-    track::computeTracksPerView(_map_tracks, _map_tracksPerView);
+    // build tracks with a flat storage
+    tracksBuilder.exportToCompact(_map_tracks);
     ALICEVISION_LOG_DEBUG("Build tracks pyramid per view");
     computeTracksPyramidPerView(
-            _map_tracksPerView, _map_tracks, _sfmData.views, *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _map_featsPyramidPerView);
+            _map_tracks, _sfmData.views, *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _map_featsPyramidPerView);
 
     // display stats
     {
-      std::set<size_t> imagesId;
-      track::imageIdInTracks(_map_tracksPerView, imagesId);
-
       ALICEVISION_LOG_INFO("Fuse matches into tracks: " << std::endl
         << "\t- # tracks: " << tracksBuilder.nbTracks() << std::endl
-        << "\t- # images in tracks: " << imagesId.size());
+        << "\t- # observations: " << _map_tracks.nbObservations() << std::endl
+        << "\t- # images in tracks: " << _map_tracks.getViewIds().size() << std::endl
+        << "\t- tracks memory: " << _map_tracks.memoryUsage() / (1024 * 1024) << " MB");
 
       std::map<size_t, size_t> map_Occurence_TrackLength;
       track::tracksLength(_map_tracks, map_Occurence_TrackLength);
@@ -354,10 +341,10 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
   ALICEVISION_LOG_DEBUG("Find corresponding landmark id per track id");
 
   // find corresponding landmark id per track id
-  for(const auto& trackPair : _map_tracks)
+  for(std::size_t i = 0; i < _map_tracks.size(); ++i)
   {
-    const IndexT trackId = trackPair.first;
-    const Track& track = trackPair.second;
+    const CompactTracks::TrackRef track = _map_tracks.getTrackByIndex(i);
+    const IndexT trackId = track.trackId;
 
     for(const auto& featView : track.featPerView)
     {
@@ -636,7 +623,7 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
 
   // add the new reconstructed views to the graph
   if(_params.useLocalBundleAdjustment)
-    _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, newReconstructedViews, _params.kMinNbOfMatches);
+    _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracks, newReconstructedViews, _params.kMinNbOfMatches);
 
 
   if(enableLocalStrategy)
@@ -665,11 +652,29 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     }
   }
 
-  BundleAdjustmentCeres BA(options);
+  // keep the same bundle adjustment engine to update its problem with the changes of the scene
+  options.incrementalProblem = _params.useIncrementalBundleAdjustmentProblem;
+
+  if(_bundleAdjustment == nullptr)
+    _bundleAdjustment = std::make_shared<BundleAdjustmentCeres>(options);
+  else
+    _bundleAdjustment->setCeresOptions(options);
+
+  BundleAdjustmentCeres& BA = *_bundleAdjustment;
 
   // give the local strategy graph is local strategy is enable
-  if(enableLocalStrategy)
-    BA.useLocalStrategyGraph(_localStrategyGraph);
+  BA.useLocalStrategyGraph(enableLocalStrategy ? _localStrategyGraph : nullptr);
+
+  // adjust the whole scene by clusters if it is too large for a single problem
+  const bool enablePartitionedStrategy = !enableLocalStrategy &&
+                                         _params.partitionedBundleAdjustmentClusterSize > 0 &&
+                                         _sfmData.getPoses().size() > _params.partitionedBundleAdjustmentClusterSize;
+
+  BundleAdjustmentPartitioned::Options partitionedOptions;
+  partitionedOptions.maxClusterSize = _params.partitionedBundleAdjustmentClusterSize;
+  partitionedOptions.minNbOfMatches = _params.kMinNbOfMatches;
+  partitionedOptions.ceresOptions = options;
+  BundleAdjustmentPartitioned partitionedBA(partitionedOptions);
 
   // perform BA until all point are under the given precision
   do
@@ -677,7 +682,16 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     ALICEVISION_LOG_INFO("Start bundle adjustment iteration: " << iteration);
     auto chronoItStart = std::chrono::steady_clock::now();
 
+    // partitioned bundle adjustment iteration
+    if(enablePartitionedStrategy)
+    {
+      if(!partitionedBA.adjust(_sfmData, refineOptions))
+        return false; // not usable solution
+
+      partitionedBA.getStatistics().show();
+    }
     // bundle adjustment iteration
+    else
     {
       const bool success = BA.adjust(_sfmData, refineOptions);
 
@@ -848,7 +862,7 @@ void ReconstructionEngine_sequentialSfM::calibrateRigs(std::set<IndexT>& updated
   for(const std::pair<IndexT, Rig>& rigPair : _sfmData.getRigs())
   {
     RigSequence sequence(_sfmData, rigPair.first);
-    sequence.init(_map_tracksPerView);
+    sequence.init(_map_tracks);
     sequence.updateSfM(updatedViews);
   }
 }
@@ -880,7 +894,7 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(
     const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
 
     // Compute 2D - 3D possible content
-    const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
+    const track::CompactTracks::TrackIdRange set_tracksIds = _map_tracks.getTracksInView(viewId);
     if (set_tracksIds.empty())
       continue;
 
@@ -1079,25 +1093,21 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
 
   // b. get common features between the two views
   // use the track to have a more dense match correspondence set
-  aliceVision::track::TracksMap commonTracks;
-  track::getCommonTracksInImagesFast({I, J}, _map_tracks, _map_tracksPerView, commonTracks);
+  std::vector<track::CompactTracks::TrackRef> commonTracks;
+  track::getCommonTracksInImagesFast({I, J}, _map_tracks, commonTracks);
 
   // copy point to arrays
   const std::size_t n = commonTracks.size();
   Mat xI(2,n), xJ(2,n);
-  std::size_t cptIndex = 0;
-  for (aliceVision::track::TracksMap::const_iterator
-    iterT = commonTracks.begin(); iterT != commonTracks.end();
-    ++iterT, ++cptIndex)
+  for(std::size_t cptIndex = 0; cptIndex < n; ++cptIndex)
   {
-    assert(iterT->second.featPerView.size() == 2);
-    auto iter = iterT->second.featPerView.begin();
-    const std::size_t i = iter->second;
-    const std::size_t j = (++iter)->second;
+    const track::CompactTracks::TrackRef& track = commonTracks[cptIndex];
+    const std::size_t i = track.featPerView.at(I);
+    const std::size_t j = track.featPerView.at(J);
 
-    Vec2 feat = _featuresPerView->getFeatures(I, iterT->second.descType)[i].coords().cast<double>();
+    Vec2 feat = _featuresPerView->getFeatures(I, track.descType)[i].coords().cast<double>();
     xI.col(cptIndex) = camI->get_ud_pixel(feat);
-    feat = _featuresPerView->getFeatures(J, iterT->second.descType)[j].coords().cast<double>();
+    feat = _featuresPerView->getFeatures(J, track.descType)[j].coords().cast<double>();
     xJ.col(cptIndex) = camJ->get_ud_pixel(feat);
   }
   ALICEVISION_LOG_INFO(n << " matches in the image pair for the initial pose estimation.");
@@ -1271,27 +1281,24 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
     if (camI == nullptr || camJ == nullptr)
       continue;
 
-    aliceVision::track::TracksMap map_tracksCommon;
+    std::vector<track::CompactTracks::TrackRef> map_tracksCommon;
     const std::set<size_t> set_imageIndex= {I, J};
-    track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
+    track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, map_tracksCommon);
 
     // Copy points correspondences to arrays for relative pose estimation
     const size_t n = map_tracksCommon.size();
     ALICEVISION_LOG_DEBUG("Automatic initial pair choice test - I: " << I << ", J: " << J << ", common tracks: " << n);
     Mat xI(2,n), xJ(2,n);
-    size_t cptIndex = 0;
     std::vector<std::size_t> commonTracksIds(n);
-    for (aliceVision::track::TracksMap::const_iterator
-      iterT = map_tracksCommon.begin(); iterT != map_tracksCommon.end();
-      ++iterT, ++cptIndex)
+    for(size_t cptIndex = 0; cptIndex < n; ++cptIndex)
     {
-      auto iter = iterT->second.featPerView.begin();
-      const size_t i = iter->second;
-      const size_t j = (++iter)->second;
-      commonTracksIds[cptIndex] = iterT->first;
+      const track::CompactTracks::TrackRef& track = map_tracksCommon[cptIndex];
+      const size_t i = track.featPerView.at(I);
+      const size_t j = track.featPerView.at(J);
+      commonTracksIds[cptIndex] = track.trackId;
       
-      const auto& viewI = _featuresPerView->getFeatures(I, iterT->second.descType); 
-      const auto& viewJ = _featuresPerView->getFeatures(J, iterT->second.descType);
+      const auto& viewI = _featuresPerView->getFeatures(I, track.descType); 
+      const auto& viewJ = _featuresPerView->getFeatures(J, track.descType);
       
       Vec2 feat = viewI[i].coords().cast<double>();
       xI.col(cptIndex) = camI->get_ud_pixel(feat);
@@ -1418,7 +1425,7 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
 
   // A. Compute 2D/3D matches
   // A1. list tracks ids used by the view
-  const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
+  const track::CompactTracks::TrackIdRange set_tracksIds = _map_tracks.getTracksInView(viewId);
 
   // A2. intersects the track list with the reconstructed
   std::set<std::size_t> reconstructed_trackId;
@@ -1623,7 +1630,7 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
   allReconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
   
   std::set<IndexT> allTracksInNewViews;
-  track::getTracksInImagesFast(newReconstructedViews, _map_tracksPerView, allTracksInNewViews);
+  track::getTracksInImagesFast(newReconstructedViews, _map_tracks, allTracksInNewViews);
   
   std::set<IndexT>::iterator it;
 #pragma omp parallel private(it)
@@ -1634,17 +1641,15 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
       {
         const std::size_t trackId = *it;
         
-        const track::Track& track = _map_tracks.at(trackId);
-        
-        std::set<IndexT> allViewsSharingTheTrack;
-        std::transform(track.featPerView.begin(), track.featPerView.end(),
-                       std::inserter(allViewsSharingTheTrack, allViewsSharingTheTrack.begin()),
-                       stl::RetrieveKey());
+        const track::CompactTracks::TrackRef track = _map_tracks.at(trackId);
         
+        // observations are sorted by viewId, so they are walked without building a set of the track views
         std::set<IndexT> allReconstructedViewsSharingTheTrack;
-        std::set_intersection(allViewsSharingTheTrack.begin(), allViewsSharingTheTrack.end(),
-                              allReconstructedViews.begin(), allReconstructedViews.end(),
-                              std::inserter(allReconstructedViewsSharingTheTrack, allReconstructedViewsSharingTheTrack.begin()));
+        for(const auto& featView : track.featPerView)
+        {
+          if(allReconstructedViews.count(featView.first))
+            allReconstructedViewsSharingTheTrack.insert(allReconstructedViewsSharingTheTrack.end(), featView.first);
+        }
         
         if (allReconstructedViewsSharingTheTrack.size() >= _params.minNbObservationsForTriangulation)
         {
@@ -1676,7 +1681,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
   {
     const IndexT trackId = setTracksId.at(i);
     bool isValidTrack = true;
-    const track::Track& track = _map_tracks.at(trackId);
+    const track::CompactTracks::TrackRef track = _map_tracks.at(trackId);
     std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
     
     // The track needs to be seen by a min. number of views to be triangulated
@@ -1753,7 +1758,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
       Mat2X features(2, observations.size()); // undistorted 2D features (one per pose)
       std::vector<Mat34> Ps; // projective matrices (one per pose)
       {
-        const track::Track& track = _map_tracks.at(trackId);
+        const track::CompactTracks::TrackRef track = _map_tracks.at(trackId);
         
         int i = 0;
         for (const IndexT& viewId : observations)
@@ -1861,8 +1866,8 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
       
       // Find track correspondences between I and J
       const std::set<std::size_t> set_viewIndex = { I, J };
-      track::TracksMap map_tracksCommonIJ;
-      track::getCommonTracksInImagesFast(set_viewIndex, _map_tracks, _map_tracksPerView, map_tracksCommonIJ);
+      std::vector<track::CompactTracks::TrackRef> map_tracksCommonIJ;
+      track::getCommonTracksInImagesFast(set_viewIndex, _map_tracks, map_tracksCommonIJ);
 
       const View* viewI = scene.getViews().at(I).get();
       const View* viewJ = scene.getViews().at(J).get();
@@ -1886,10 +1891,9 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
       const Pose3 poseJ = scene.getPose(*viewJ).getTransform();
       
       std::size_t new_putative_track = 0, new_added_track = 0, extented_track = 0;
-      for (const std::pair<std::size_t, track::Track >& trackIt : map_tracksCommonIJ)
+      for (const track::CompactTracks::TrackRef& track : map_tracksCommonIJ)
       {
-        const std::size_t trackId = trackIt.first;
-        const track::Track & track = trackIt.second;
+        const std::size_t trackId = track.trackId;
 
         const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
         const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
@@ -26,6 +26,8 @@ namespace pt = boost::property_tree;
 namespace aliceVision {
 namespace sfm {
 
+class BundleAdjustmentCeres;
+
 /// Image score contains <ImageId, NbPutativeCommonPoint, score, isIntrinsicsReconstructed>
 typedef std::tuple<IndexT, std::size_t, std::size_t, bool> ViewConnectionScore;
 
@@ -43,6 +45,10 @@ public:
     int minPointsPerPose = 30;
     bool useLocalBundleAdjustment = false;
     int localBundelAdjustementGraphDistanceLimit = 1;
+    /// keep the bundle adjustment problem between the iterations and only apply the changes of the scene
+    bool useIncrementalBundleAdjustmentProblem = false;
+    /// adjust the scenes with more posed views by clusters of this size (0: disabled, see BundleAdjustmentPartitioned)
+    std::size_t partitionedBundleAdjustmentClusterSize = 0;
 
     bool useRigConstraint = true;
 
@@ -59,6 +65,8 @@ public:
     float minAngleInitialPair = 5.0f;
     float maxAngleInitialPair = 40.0f;
     bool filterTrackForks = true;
+    /// build the tracks with the concurrent union-find, the track ids differ from the sequential union-find
+    bool multithreadedTracksBuilding = false;
     robustEstimation::ERobustEstimator localizerEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
     double localizerEstimatorError = std::numeric_limits<double>::infinity();
     size_t localizerEstimatorMaxIterations = 4096;
@@ -355,10 +363,8 @@ private:
 
   // Temporary data
 
-  /// Putative landmark tracks (visibility per potential 3D point)
-  track::TracksMap _map_tracks;
-  /// Putative tracks per view
-  track::TracksPerView _map_tracksPerView;
+  /// Putative landmark tracks (visibility per potential 3D point), with the tracks per view
+  track::CompactTracks _map_tracks;
   /// Precomputed pyramid index for each trackId of each viewId.
   track::TracksPyramidPerView _map_featsPyramidPerView;
   /// Per camera confidence (A contrario estimated threshold error)
@@ -369,6 +375,11 @@ private:
   /// Contains all the data used by the Local BA approach
   std::shared_ptr<LocalBundleAdjustmentGraph> _localStrategyGraph;
 
+  // Bundle Adjustment data
+
+  /// Bundle adjustment engine, keeps its problem between the iterations (see Params::useIncrementalBundleAdjustmentProblem)
+  std::shared_ptr<BundleAdjustmentCeres> _bundleAdjustment;
+
   // Log
 
   /// sfm intermediate reconstruction files
@@ -0,0 +1,894 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "binaryIO.hpp"
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+/**
+ * Binary SfMData file layout (all integers are little-endian, doubles are stored as their IEEE 754 bits):
+ *
+ *   header: magic "AVSFMBIN" | uint32 version | uint32 sectionCount
+ *   table:  sectionCount x { uint32 type | uint32 reserved | uint64 offset | uint64 size }
+ *   data:   one block per section, at the offset given by the table
+ *
+ * Strings are stored as uint32 length | characters.
+ *
+ *   FOLDERS:              uint32 n | n x string featuresFolder | uint32 m | m x string matchesFolder
+ *   VIEWS:                uint64 n | n x { uint32 viewId, poseId, rigId, subPoseId, frameId, intrinsicId, resectionId |
+ *                                          uint8 isPoseIndependant | string path | uint64 width, height |
+ *                                          uint32 nbMetadata | nbMetadata x { string key | string value } }
+ *   INTRINSICS:           uint32 n | n x { uint32 intrinsicId | string type | uint32 width, height |
+ *                                          double sensorWidth, sensorHeight | string serialNumber |
+ *                                          string initializationMode | uint8 locked |
+ *                                          double initialScale, scaleX, scaleY, offsetX, offsetY |
+ *                                          uint32 nbDistortionParams | nbDistortionParams x double |
+ *                                          uint8 hasCircle | (hasCircle) double centerX, centerY, radius }
+ *   POSES:                uint64 n | n x { uint32 poseId | 9 x double rotation | 3 x double center | uint8 locked }
+ *   RIGS:                 uint32 n | n x { uint32 rigId | uint32 nbSubPoses |
+ *                                          nbSubPoses x { string status | 9 x double rotation | 3 x double center } }
+ *   LANDMARKS:            uint32 nbDescTypes | nbDescTypes x string descType |
+ *                         uint64 n | n x { uint32 landmarkId | uint8 descTypeIndex | 3 x double X | 3 x uint8 rgb }
+ *   OBSERVATIONS:         uint64 n | n x { uint32 nbObservations | nbObservations x uint32 viewId }
+ *                         (in the order of the LANDMARKS section)
+ *   OBSERVATION_FEATURES: uint64 n | n x { uint32 featureId | 2 x double x | double scale }
+ *                         (in the order of the OBSERVATIONS section)
+ *   CONTROL_POINTS:       uint64 n | n x { uint32 landmarkId | string descType | 3 x double X | 3 x uint8 rgb |
+ *                                          uint32 nbObservations | nbObservations x { uint32 viewId | uint32 featureId |
+ *                                                                                     2 x double x | double scale } }
+ *
+ * The observations and their features are stored apart from the landmarks,
+ * so a partial load does not have to parse the sections it does not need.
+ */
+const char binarySfMDataMagic[8] = {'A', 'V', 'S', 'F', 'M', 'B', 'I', 'N'};
+const std::uint32_t binarySfMDataVersion = 1;
+const std::size_t binarySfMDataHeaderSize = 8 + 4 + 4;
+const std::size_t binarySfMDataTableEntrySize = 4 + 4 + 8 + 8;
+
+/// size of the chunks used to stream the file
+const std::size_t binarySfMDataChunkSize = 4 * 1024 * 1024;
+
+enum class ESection : std::uint32_t
+{
+  FOLDERS = 1,
+  VIEWS = 2,
+  INTRINSICS = 3,
+  POSES = 4,
+  RIGS = 5,
+  LANDMARKS = 6,
+  OBSERVATIONS = 7,
+  OBSERVATION_FEATURES = 8,
+  CONTROL_POINTS = 9
+};
+
+struct SectionEntry
+{
+  ESection type;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+template<typename T>
+T decodeLittleEndian(const unsigned char* data)
+{
+  std::uint64_t value = 0;
+  for(std::size_t i = 0; i < sizeof(T); ++i)
+    value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+  return static_cast<T>(value);
+}
+
+/**
+ * @brief Buffered little-endian writer, the buffer is flushed to the stream by chunks.
+ */
+class BinaryWriter
+{
+public:
+  explicit BinaryWriter(std::ostream& stream)
+    : _stream(stream)
+    , _buffer(binarySfMDataChunkSize)
+  {}
+
+  std::uint64_t position() const { return _flushed + _size; }
+
+  void writeU8(std::uint8_t value) { writeLittleEndian(value); }
+  void writeU32(std::uint32_t value) { writeLittleEndian(value); }
+  void writeU64(std::uint64_t value) { writeLittleEndian(value); }
+
+  void writeDouble(double value)
+  {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeLittleEndian(bits);
+  }
+
+  void writeString(const std::string& value)
+  {
+    writeU32(static_cast<std::uint32_t>(value.size()));
+    writeBytes(value.data(), value.size());
+  }
+
+  template<typename Derived>
+  void writeMatrix(const Eigen::MatrixBase<Derived>& matrix)
+  {
+    for(int i = 0; i < matrix.size(); ++i)
+      writeDouble(matrix(i));
+  }
+
+  void writeBytes(const char* data, std::size_t size)
+  {
+    if(_size + size > _buffer.size())
+    {
+      flush();
+      if(size > _buffer.size())
+      {
+        _stream.write(data, size);
+        _flushed += size;
+        return;
+      }
+    }
+    std::memcpy(_buffer.data() + _size, data, size);
+    _size += size;
+  }
+
+  void flush()
+  {
+    _stream.write(reinterpret_cast<const char*>(_buffer.data()), _size);
+    _flushed += _size;
+    _size = 0;
+  }
+
+private:
+  template<typename T>
+  void writeLittleEndian(T value)
+  {
+    if(_size + sizeof(T) > _buffer.size())
+      flush();
+    for(std::size_t i = 0; i < sizeof(T); ++i)
+      _buffer[_size++] = static_cast<unsigned char>((static_cast<std::uint64_t>(value) >> (8 * i)) & 0xFF);
+  }
+
+  std::ostream& _stream;
+  std::vector<unsigned char> _buffer;
+  std::size_t _size = 0;
+  std::uint64_t _flushed = 0;
+};
+
+/**
+ * @brief Buffered little-endian reader of a section, the stream is read by chunks.
+ *        Throws std::runtime_error if the section is truncated.
+ */
+class BinaryReader
+{
+public:
+  BinaryReader(std::istream& stream, const SectionEntry& section)
+    : _stream(stream)
+    , _remaining(section.size)
+  {
+    _stream.clear();
+    _stream.seekg(section.offset);
+  }
+
+  std::uint8_t readU8() { return readLittleEndian<std::uint8_t>(); }
+  std::uint32_t readU32() { return readLittleEndian<std::uint32_t>(); }
+  std::uint64_t readU64() { return readLittleEndian<std::uint64_t>(); }
+
+  double readDouble()
+  {
+    const std::uint64_t bits = readLittleEndian<std::uint64_t>();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  std::string readString()
+  {
+    const std::uint32_t size = readU32();
+    std::string value(size, '\0');
+    readBytes(&value[0], size);
+    return value;
+  }
+
+  template<typename Derived>
+  void readMatrix(Eigen::MatrixBase<Derived>& matrix)
+  {
+    for(int i = 0; i < matrix.size(); ++i)
+      matrix(i) = readDouble();
+  }
+
+  void readBytes(char* data, std::size_t size)
+  {
+    while(size > 0)
+    {
+      if(_position == _buffer.size())
+        fill();
+      const std::size_t n = std::min(size, _buffer.size() - _position);
+      std::memcpy(data, _buffer.data() + _position, n);
+      _position += n;
+      data += n;
+      size -= n;
+    }
+  }
+
+private:
+  template<typename T>
+  T readLittleEndian()
+  {
+    if(_position + sizeof(T) > _buffer.size())
+    {
+      unsigned char bytes[sizeof(T)];
+      readBytes(reinterpret_cast<char*>(bytes), sizeof(T));
+      return decodeLittleEndian<T>(bytes);
+    }
+    const T value = decodeLittleEndian<T>(_buffer.data() + _position);
+    _position += sizeof(T);
+    return value;
+  }
+
+  void fill()
+  {
+    const std::size_t size = static_cast<std::size_t>(std::min<std::uint64_t>(_remaining, binarySfMDataChunkSize));
+    if(size == 0)
+      throw std::runtime_error("Unexpected end of section");
+    _buffer.resize(size);
+    if(!_stream.read(reinterpret_cast<char*>(_buffer.data()), size))
+      throw std::runtime_error("Unexpected end of file");
+    _remaining -= size;
+    _position = 0;
+  }
+
+  std::istream& _stream;
+  std::vector<unsigned char> _buffer;
+  std::size_t _position = 0;
+  std::uint64_t _remaining;
+};
+
+void writeView(BinaryWriter& writer, const sfmData::View& view)
+{
+  writer.writeU32(view.getViewId());
+  writer.writeU32(view.getPoseId());
+  writer.writeU32(view.getRigId());
+  writer.writeU32(view.getSubPoseId());
+  writer.writeU32(view.getFrameId());
+  writer.writeU32(view.getIntrinsicId());
+  writer.writeU32(view.getResectionId());
+  writer.writeU8(view.isPoseIndependant());
+  writer.writeString(view.getImagePath());
+  writer.writeU64(view.getWidth());
+  writer.writeU64(view.getHeight());
+
+  writer.writeU32(static_cast<std::uint32_t>(view.getMetadata().size()));
+  for(const auto& metadataPair : view.getMetadata())
+  {
+    writer.writeString(metadataPair.first);
+    writer.writeString(metadataPair.second);
+  }
+}
+
+void readView(BinaryReader& reader, sfmData::View& view)
+{
+  view.setViewId(reader.readU32());
+  view.setPoseId(reader.readU32());
+  const IndexT rigId = reader.readU32();
+  const IndexT subPoseId = reader.readU32();
+  if(rigId != UndefinedIndexT)
+    view.setRigAndSubPoseId(rigId, subPoseId);
+  view.setFrameId(reader.readU32());
+  view.setIntrinsicId(reader.readU32());
+  view.setResectionId(reader.readU32());
+  view.setIndependantPose(reader.readU8() != 0);
+  view.setImagePath(reader.readString());
+  view.setWidth(reader.readU64());
+  view.setHeight(reader.readU64());
+
+  const std::uint32_t nbMetadata = reader.readU32();
+  for(std::uint32_t i = 0; i < nbMetadata; ++i)
+  {
+    const std::string key = reader.readString();
+    view.addMetadata(key, reader.readString());
+  }
+}
+
+void writeIntrinsic(BinaryWriter& writer, IndexT intrinsicId, const camera::IntrinsicBase& intrinsic)
+{
+  writer.writeU32(intrinsicId);
+  writer.writeString(camera::EINTRINSIC_enumToString(intrinsic.getType()));
+  writer.writeU32(intrinsic.w());
+  writer.writeU32(intrinsic.h());
+  writer.writeDouble(intrinsic.sensorWidth());
+  writer.writeDouble(intrinsic.sensorHeight());
+  writer.writeString(intrinsic.serialNumber());
+  writer.writeString(camera::EIntrinsicInitMode_enumToString(intrinsic.getInitializationMode()));
+  writer.writeU8(intrinsic.isLocked());
+
+  const camera::IntrinsicsScaleOffset* intrinsicScaleOffset = dynamic_cast<const camera::IntrinsicsScaleOffset*>(&intrinsic);
+  if(intrinsicScaleOffset)
+  {
+    writer.writeDouble(intrinsicScaleOffset->initialScale());
+    writer.writeMatrix(intrinsicScaleOffset->getScale());
+    writer.writeMatrix(intrinsicScaleOffset->getOffset());
+  }
+  else
+  {
+    writer.writeDouble(-1.0);
+    writer.writeMatrix(Vec2::Zero());
+    writer.writeMatrix(Vec2::Zero());
+  }
+
+  const camera::IntrinsicsScaleOffsetDisto* intrinsicScaleOffsetDisto = dynamic_cast<const camera::IntrinsicsScaleOffsetDisto*>(&intrinsic);
+  if(intrinsicScaleOffsetDisto)
+  {
+    const std::vector<double> distortionParams = intrinsicScaleOffsetDisto->getDistortionParams();
+    writer.writeU32(static_cast<std::uint32_t>(distortionParams.size()));
+    for(double param : distortionParams)
+      writer.writeDouble(param);
+  }
+  else
+  {
+    writer.writeU32(0);
+  }
+
+  const camera::EquiDistant* intrinsicEquidistant = dynamic_cast<const camera::EquiDistant*>(&intrinsic);
+  writer.writeU8(intrinsicEquidistant != nullptr);
+  if(intrinsicEquidistant)
+  {
+    writer.writeDouble(intrinsicEquidistant->getCircleCenterX());
+    writer.writeDouble(intrinsicEquidistant->getCircleCenterY());
+    writer.writeDouble(intrinsicEquidistant->getCircleRadius());
+  }
+}
+
+void readIntrinsic(BinaryReader& reader, IndexT& intrinsicId, std::shared_ptr<camera::IntrinsicBase>& intrinsic)
+{
+  intrinsicId = reader.readU32();
+  const camera::EINTRINSIC intrinsicType = camera::EINTRINSIC_stringToEnum(reader.readString());
+  const unsigned int width = reader.readU32();
+  const unsigned int height = reader.readU32();
+  const double sensorWidth = reader.readDouble();
+  const double sensorHeight = reader.readDouble();
+  const std::string serialNumber = reader.readString();
+  const camera::EIntrinsicInitMode initializationMode = camera::EIntrinsicInitMode_stringToEnum(reader.readString());
+  const bool locked = reader.readU8() != 0;
+
+  const double initialScale = reader.readDouble();
+  Vec2 scale;
+  Vec2 offset;
+  reader.readMatrix(scale);
+  reader.readMatrix(offset);
+
+  std::vector<double> distortionParams(reader.readU32());
+  for(double& param : distortionParams)
+    param = reader.readDouble();
+
+  intrinsic = camera::createIntrinsic(intrinsicType, width, height, scale(0), scale(1), offset(0), offset(1));
+
+  intrinsic->setSerialNumber(serialNumber);
+  intrinsic->setInitializationMode(initializationMode);
+  intrinsic->setSensorWidth(sensorWidth);
+  intrinsic->setSensorHeight(sensorHeight);
+
+  if(locked)
+    intrinsic->lock();
+  else
+    intrinsic->unlock();
+
+  std::shared_ptr<camera::IntrinsicsScaleOffset> intrinsicWithScale = std::dynamic_pointer_cast<camera::IntrinsicsScaleOffset>(intrinsic);
+  if(intrinsicWithScale != nullptr)
+  {
+    // the constructors may not use both scales
+    intrinsicWithScale->setScale(scale(0), scale(1));
+    intrinsicWithScale->setOffset(offset(0), offset(1));
+    intrinsicWithScale->setInitialScale(initialScale);
+  }
+
+  std::shared_ptr<camera::IntrinsicsScaleOffsetDisto> intrinsicWithDistoEnabled = std::dynamic_pointer_cast<camera::IntrinsicsScaleOffsetDisto>(intrinsic);
+  if(intrinsicWithDistoEnabled != nullptr)
+  {
+    // ensure that we have the right number of params
+    distortionParams.resize(intrinsicWithDistoEnabled->getDistortionParams().size(), 0.0);
+    intrinsicWithDistoEnabled->setDistortionParams(distortionParams);
+  }
+
+  if(reader.readU8() != 0)
+  {
+    const double circleCenterX = reader.readDouble();
+    const double circleCenterY = reader.readDouble();
+    const double circleRadius = reader.readDouble();
+
+    std::shared_ptr<camera::EquiDistant> intrinsicEquiDistant = std::dynamic_pointer_cast<camera::EquiDistant>(intrinsic);
+    if(intrinsicEquiDistant != nullptr)
+    {
+      intrinsicEquiDistant->setCircleCenterX(circleCenterX);
+      intrinsicEquiDistant->setCircleCenterY(circleCenterY);
+      intrinsicEquiDistant->setCircleRadius(circleRadius);
+    }
+  }
+}
+
+void writePose3(BinaryWriter& writer, const geometry::Pose3& pose)
+{
+  writer.writeMatrix(pose.rotation());
+  writer.writeMatrix(pose.center());
+}
+
+geometry::Pose3 readPose3(BinaryReader& reader)
+{
+  Mat3 rotation;
+  Vec3 center;
+  reader.readMatrix(rotation);
+  reader.readMatrix(center);
+  return geometry::Pose3(rotation, center);
+}
+
+void writeLandmarkPoint(BinaryWriter& writer, const sfmData::Landmark& landmark)
+{
+  writer.writeMatrix(landmark.X);
+  for(int i = 0; i < 3; ++i)
+    writer.writeU8(landmark.rgb(i));
+}
+
+void readLandmarkPoint(BinaryReader& reader, sfmData::Landmark& landmark)
+{
+  reader.readMatrix(landmark.X);
+  for(int i = 0; i < 3; ++i)
+    landmark.rgb(i) = reader.readU8();
+}
+
+void writeObservationFeature(BinaryWriter& writer, const sfmData::Observation& observation)
+{
+  writer.writeU32(observation.id_feat);
+  writer.writeMatrix(observation.x);
+  writer.writeDouble(observation.scale);
+}
+
+void readObservationFeature(BinaryReader& reader, sfmData::Observation& observation)
+{
+  observation.id_feat = reader.readU32();
+  reader.readMatrix(observation.x);
+  observation.scale = reader.readDouble();
+}
+
+void writeSection(BinaryWriter& writer, ESection type, const sfmData::SfMData& sfmData)
+{
+  switch(type)
+  {
+    case ESection::FOLDERS:
+    {
+      writer.writeU32(static_cast<std::uint32_t>(sfmData.getRelativeFeaturesFolders().size()));
+      for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
+        writer.writeString(featuresFolder);
+      writer.writeU32(static_cast<std::uint32_t>(sfmData.getRelativeMatchesFolders().size()));
+      for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
+        writer.writeString(matchesFolder);
+      break;
+    }
+    case ESection::VIEWS:
+    {
+      writer.writeU64(sfmData.getViews().size());
+      for(const auto& viewPair : sfmData.getViews())
+        writeView(writer, *(viewPair.second));
+      break;
+    }
+    case ESection::INTRINSICS:
+    {
+      writer.writeU32(static_cast<std::uint32_t>(sfmData.getIntrinsics().size()));
+      for(const auto& intrinsicPair : sfmData.getIntrinsics())
+        writeIntrinsic(writer, intrinsicPair.first, *(intrinsicPair.second));
+      break;
+    }
+    case ESection::POSES:
+    {
+      writer.writeU64(sfmData.getPoses().size());
+      for(const auto& posePair : sfmData.getPoses())
+      {
+        writer.writeU32(posePair.first);
+        writePose3(writer, posePair.second.getTransform());
+        writer.writeU8(posePair.second.isLocked());
+      }
+      break;
+    }
+    case ESection::RIGS:
+    {
+      writer.writeU32(static_cast<std::uint32_t>(sfmData.getRigs().size()));
+      for(const auto& rigPair : sfmData.getRigs())
+      {
+        writer.writeU32(rigPair.first);
+        writer.writeU32(static_cast<std::uint32_t>(rigPair.second.getSubPoses().size()));
+        for(const sfmData::RigSubPose& rigSubPose : rigPair.second.getSubPoses())
+        {
+          writer.writeString(sfmData::ERigSubPoseStatus_enumToString(rigSubPose.status));
+          writePose3(writer, rigSubPose.pose);
+        }
+      }
+      break;
+    }
+    case ESection::LANDMARKS:
+    {
+      // the describer types are written once, each landmark refers to them by index
+      std::map<feature::EImageDescriberType, std::uint8_t> descTypeIndexes;
+      for(const auto& landmarkPair : sfmData.getLandmarks())
+        descTypeIndexes.emplace(landmarkPair.second.descType, 0);
+
+      writer.writeU32(static_cast<std::uint32_t>(descTypeIndexes.size()));
+      std::uint8_t descTypeIndex = 0;
+      for(auto& descTypePair : descTypeIndexes)
+      {
+        descTypePair.second = descTypeIndex++;
+        writer.writeString(feature::EImageDescriberType_enumToString(descTypePair.first));
+      }
+
+      writer.writeU64(sfmData.getLandmarks().size());
+      for(const auto& landmarkPair : sfmData.getLandmarks())
+      {
+        writer.writeU32(landmarkPair.first);
+        writer.writeU8(descTypeIndexes.at(landmarkPair.second.descType));
+        writeLandmarkPoint(writer, landmarkPair.second);
+      }
+      break;
+    }
+    case ESection::OBSERVATIONS:
+    {
+      writer.writeU64(sfmData.getLandmarks().size());
+      for(const auto& landmarkPair : sfmData.getLandmarks())
+      {
+        writer.writeU32(static_cast<std::uint32_t>(landmarkPair.second.observations.size()));
+        for(const auto& observationPair : landmarkPair.second.observations)
+          writer.writeU32(observationPair.first);
+      }
+      break;
+    }
+    case ESection::OBSERVATION_FEATURES:
+    {
+      std::uint64_t nbObservations = 0;
+      for(const auto& landmarkPair : sfmData.getLandmarks())
+        nbObservations += landmarkPair.second.observations.size();
+
+      writer.writeU64(nbObservations);
+      for(const auto& landmarkPair : sfmData.getLandmarks())
+        for(const auto& observationPair : landmarkPair.second.observations)
+          writeObservationFeature(writer, observationPair.second);
+      break;
+    }
+    case ESection::CONTROL_POINTS:
+    {
+      writer.writeU64(sfmData.getControlPoints().size());
+      for(const auto& controlPointPair : sfmData.getControlPoints())
+      {
+        const sfmData::Landmark& controlPoint = controlPointPair.second;
+        writer.writeU32(controlPointPair.first);
+        writer.writeString(feature::EImageDescriberType_enumToString(controlPoint.descType));
+        writeLandmarkPoint(writer, controlPoint);
+        writer.writeU32(static_cast<std::uint32_t>(controlPoint.observations.size()));
+        for(const auto& observationPair : controlPoint.observations)
+        {
+          writer.writeU32(observationPair.first);
+          writeObservationFeature(writer, observationPair.second);
+        }
+      }
+      break;
+    }
+  }
+}
+
+} // namespace
+
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // save flags
+  const bool saveViews = (partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  std::vector<SectionEntry> sections;
+  sections.push_back({ESection::FOLDERS, 0, 0});
+  if(saveViews)
+    sections.push_back({ESection::VIEWS, 0, 0});
+  if(saveIntrinsics)
+    sections.push_back({ESection::INTRINSICS, 0, 0});
+  if(saveExtrinsics)
+  {
+    sections.push_back({ESection::POSES, 0, 0});
+    sections.push_back({ESection::RIGS, 0, 0});
+  }
+  if(saveStructure)
+  {
+    sections.push_back({ESection::LANDMARKS, 0, 0});
+    if(saveObservations)
+      sections.push_back({ESection::OBSERVATIONS, 0, 0});
+    if(saveFeatures)
+      sections.push_back({ESection::OBSERVATION_FEATURES, 0, 0});
+  }
+  if(saveControlPoints)
+    sections.push_back({ESection::CONTROL_POINTS, 0, 0});
+
+  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the binary SfMData file: " << filename);
+    return false;
+  }
+
+  BinaryWriter writer(stream);
+
+  // header, the section table is filled once the sections are written
+  writer.writeBytes(binarySfMDataMagic, sizeof(binarySfMDataMagic));
+  writer.writeU32(binarySfMDataVersion);
+  writer.writeU32(static_cast<std::uint32_t>(sections.size()));
+  const std::uint64_t tableOffset = writer.position();
+  const std::vector<char> emptyTable(sections.size() * binarySfMDataTableEntrySize, 0);
+  writer.writeBytes(emptyTable.data(), emptyTable.size());
+
+  for(SectionEntry& section : sections)
+  {
+    section.offset = writer.position();
+    writeSection(writer, section.type, sfmData);
+    section.size = writer.position() - section.offset;
+  }
+  writer.flush();
+
+  stream.seekp(tableOffset);
+  for(const SectionEntry& section : sections)
+  {
+    writer.writeU32(static_cast<std::uint32_t>(section.type));
+    writer.writeU32(0);
+    writer.writeU64(section.offset);
+    writer.writeU64(section.size);
+  }
+  writer.flush();
+
+  if(!stream.good())
+  {
+    ALICEVISION_LOG_ERROR("Cannot write the binary SfMData file: " << filename);
+    return false;
+  }
+  return true;
+}
+
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // load flags
+  const bool loadViews = (partFlag & VIEWS) == VIEWS;
+  const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool loadControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+  if(!stream.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Cannot open the binary SfMData file: " << filename);
+    return false;
+  }
+
+  // header
+  unsigned char header[binarySfMDataHeaderSize];
+  if(!stream.read(reinterpret_cast<char*>(header), binarySfMDataHeaderSize) ||
+     std::memcmp(header, binarySfMDataMagic, sizeof(binarySfMDataMagic)) != 0)
+  {
+    ALICEVISION_LOG_ERROR("Invalid binary SfMData file: " << filename);
+    return false;
+  }
+
+  const std::uint32_t version = decodeLittleEndian<std::uint32_t>(header + 8);
+  const std::uint32_t sectionCount = decodeLittleEndian<std::uint32_t>(header + 12);
+
+  if(version > binarySfMDataVersion)
+  {
+    ALICEVISION_LOG_ERROR("Unsupported binary SfMData file version: " << version << " (" << filename << ")");
+    return false;
+  }
+
+  try
+  {
+
+    // section table, unknown sections are ignored
+    std::map<ESection, SectionEntry> sections;
+    BinaryReader tableReader(stream, {ESection::FOLDERS, binarySfMDataHeaderSize, sectionCount * binarySfMDataTableEntrySize});
+    for(std::uint32_t i = 0; i < sectionCount; ++i)
+    {
+      SectionEntry section;
+      section.type = static_cast<ESection>(tableReader.readU32());
+      tableReader.readU32();
+      section.offset = tableReader.readU64();
+      section.size = tableReader.readU64();
+      sections.emplace(section.type, section);
+    }
+
+    const auto hasSection = [&](ESection type) { return sections.count(type) > 0; };
+
+    // folders
+    if(hasSection(ESection::FOLDERS))
+    {
+      BinaryReader reader(stream, sections.at(ESection::FOLDERS));
+      const std::uint32_t nbFeaturesFolders = reader.readU32();
+      for(std::uint32_t i = 0; i < nbFeaturesFolders; ++i)
+        sfmData.addFeaturesFolder(reader.readString());
+      const std::uint32_t nbMatchesFolders = reader.readU32();
+      for(std::uint32_t i = 0; i < nbMatchesFolders; ++i)
+        sfmData.addMatchesFolder(reader.readString());
+    }
+
+    // intrinsics
+    if(loadIntrinsics && hasSection(ESection::INTRINSICS))
+    {
+      BinaryReader reader(stream, sections.at(ESection::INTRINSICS));
+      sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
+      const std::uint32_t nbIntrinsics = reader.readU32();
+      for(std::uint32_t i = 0; i < nbIntrinsics; ++i)
+      {
+        IndexT intrinsicId;
+        std::shared_ptr<camera::IntrinsicBase> intrinsic;
+        readIntrinsic(reader, intrinsicId, intrinsic);
+        intrinsics.emplace(intrinsicId, intrinsic);
+      }
+    }
+
+    // views
+    if(loadViews && hasSection(ESection::VIEWS))
+    {
+      BinaryReader reader(stream, sections.at(ESection::VIEWS));
+      sfmData::Views& views = sfmData.getViews();
+      const std::uint64_t nbViews = reader.readU64();
+      for(std::uint64_t i = 0; i < nbViews; ++i)
+      {
+        std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>();
+        readView(reader, *view);
+        views.emplace(view->getViewId(), view);
+      }
+    }
+
+    // extrinsics
+    if(loadExtrinsics)
+    {
+      // poses
+      if(hasSection(ESection::POSES))
+      {
+        BinaryReader reader(stream, sections.at(ESection::POSES));
+        sfmData::Poses& poses = sfmData.getPoses();
+        const std::uint64_t nbPoses = reader.readU64();
+        for(std::uint64_t i = 0; i < nbPoses; ++i)
+        {
+          const IndexT poseId = reader.readU32();
+          sfmData::CameraPose pose(readPose3(reader));
+          if(reader.readU8() != 0)
+            pose.lock();
+          poses.emplace(poseId, pose);
+        }
+      }
+
+      // rigs
+      if(hasSection(ESection::RIGS))
+      {
+        BinaryReader reader(stream, sections.at(ESection::RIGS));
+        sfmData::Rigs& rigs = sfmData.getRigs();
+        const std::uint32_t nbRigs = reader.readU32();
+        for(std::uint32_t i = 0; i < nbRigs; ++i)
+        {
+          const IndexT rigId = reader.readU32();
+          const std::uint32_t nbSubPoses = reader.readU32();
+          sfmData::Rig rig(nbSubPoses);
+          for(std::uint32_t subPoseId = 0; subPoseId < nbSubPoses; ++subPoseId)
+          {
+            sfmData::RigSubPose subPose;
+            subPose.status = sfmData::ERigSubPoseStatus_stringToEnum(reader.readString());
+            subPose.pose = readPose3(reader);
+            rig.setSubPose(subPoseId, subPose);
+          }
+          rigs.emplace(rigId, rig);
+        }
+      }
+    }
+
+    // structure
+    if(loadStructure && hasSection(ESection::LANDMARKS))
+    {
+      sfmData::Landmarks& structure = sfmData.getLandmarks();
+
+      // landmarks in the order of the file, to fill their observations
+      std::vector<sfmData::Landmark*> landmarks;
+      {
+        BinaryReader reader(stream, sections.at(ESection::LANDMARKS));
+
+        std::vector<feature::EImageDescriberType> descTypes(reader.readU32());
+        for(feature::EImageDescriberType& descType : descTypes)
+          descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+
+        const std::uint64_t nbLandmarks = reader.readU64();
+        landmarks.reserve(nbLandmarks);
+        for(std::uint64_t i = 0; i < nbLandmarks; ++i)
+        {
+          const IndexT landmarkId = reader.readU32();
+          sfmData::Landmark landmark;
+          landmark.descType = descTypes.at(reader.readU8());
+          readLandmarkPoint(reader, landmark);
+          landmarks.push_back(&(structure.emplace_hint(structure.end(), landmarkId, landmark)->second));
+        }
+      }
+
+      if(loadObservations && hasSection(ESection::OBSERVATIONS))
+      {
+        BinaryReader reader(stream, sections.at(ESection::OBSERVATIONS));
+        if(reader.readU64() != landmarks.size())
+          throw std::runtime_error("The number of landmarks of the observations section does not match");
+
+        for(sfmData::Landmark* landmark : landmarks)
+        {
+          const std::uint32_t nbObservations = reader.readU32();
+          landmark->observations.reserve(nbObservations);
+          for(std::uint32_t i = 0; i < nbObservations; ++i)
+            landmark->observations.emplace_hint(landmark->observations.end(), reader.readU32(), sfmData::Observation());
+        }
+
+        if(loadFeatures && hasSection(ESection::OBSERVATION_FEATURES))
+        {
+          BinaryReader featuresReader(stream, sections.at(ESection::OBSERVATION_FEATURES));
+          std::uint64_t nbObservations = 0;
+          for(const sfmData::Landmark* landmark : landmarks)
+            nbObservations += landmark->observations.size();
+          if(featuresReader.readU64() != nbObservations)
+            throw std::runtime_error("The number of observations of the features section does not match");
+
+          for(sfmData::Landmark* landmark : landmarks)
+            for(auto& observationPair : landmark->observations)
+              readObservationFeature(featuresReader, observationPair.second);
+        }
+      }
+    }
+
+    // control points
+    if(loadControlPoints && hasSection(ESection::CONTROL_POINTS))
+    {
+      BinaryReader reader(stream, sections.at(ESection::CONTROL_POINTS));
+      sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
+      const std::uint64_t nbControlPoints = reader.readU64();
+      for(std::uint64_t i = 0; i < nbControlPoints; ++i)
+      {
+        const IndexT landmarkId = reader.readU32();
+        sfmData::Landmark controlPoint;
+        controlPoint.descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+        readLandmarkPoint(reader, controlPoint);
+        const std::uint32_t nbObservations = reader.readU32();
+        for(std::uint32_t o = 0; o < nbObservations; ++o)
+        {
+          const IndexT viewId = reader.readU32();
+          sfmData::Observation observation;
+          readObservationFeature(reader, observation);
+          controlPoint.observations.emplace_hint(controlPoint.observations.end(), viewId, observation);
+        }
+        controlPoints.emplace(landmarkId, controlPoint);
+      }
+    }
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Invalid binary SfMData file: " << filename << " (" << e.what() << ")");
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -0,0 +1,44 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+/**
+ * @brief Save an SfMData in a binary file (.sfmb).
+ *
+ * The file is made of independent sections (folders, views, intrinsics, poses, rigs,
+ * landmarks, observations, observation features and control points) listed in a table
+ * at the beginning of the file. Values are stored in little-endian, doubles as their
+ * IEEE 754 bit pattern, so a save/load round trip is exact.
+ * The sections are written by chunks, without building the whole file in memory.
+ *
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @return true if completed
+ */
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+/**
+ * @brief Load a binary SfMData file (.sfmb).
+ *        Only the sections requested by the ESfMData flag are read,
+ *        the other ones are skipped without being parsed.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag
+ * @return true if completed
+ */
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -9,6 +9,7 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/sfmDataIO/binaryIO.hpp>
 #include <aliceVision/sfmDataIO/plyIO.hpp>
 #include <aliceVision/sfmDataIO/bafIO.hpp>
 #include <aliceVision/sfmDataIO/gtIO.hpp>
@@ -101,6 +102,10 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
   {
     status = loadJSON(sfmData, filename, partFlag);
   }
+  else if(extension == ".sfmb") // Binary File
+  {
+    status = loadBinary(sfmData, filename, partFlag);
+  }
   else if (extension == ".abc") // Alembic
   {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
@@ -141,6 +146,10 @@ bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData
   {
     status = saveJSON(sfmData, tmpPath, partFlag);
   }
+  else if(extension == ".sfmb") // Binary File
+  {
+    status = saveBinary(sfmData, tmpPath, partFlag);
+  }
   else if(extension == ".ply") // Polygon File
   {
     status = savePLY(sfmData, tmpPath, partFlag);
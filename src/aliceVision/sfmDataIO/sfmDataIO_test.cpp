@@ -5,12 +5,16 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Timer.hpp>
+#include <aliceVision/camera/camera.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 
 #include <boost/filesystem.hpp>
 
+#include <cstring>
+#include <random>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -178,6 +182,193 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_JSON) {
   }
 }
 
+// Create a SfM scene using most of the SfMData fields (rig, metadata, distortion, locked poses, control points)
+sfmData::SfMData createDetailedTestScene(std::size_t viewsCount, std::size_t landmarksCount, std::size_t observationsPerLandmark)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+
+  sfmData::SfMData sfmData;
+  sfmData.addFeaturesFolder("features");
+  sfmData.addMatchesFolder("matches");
+
+  sfmData.intrinsics[0] = createIntrinsic(EINTRINSIC::PINHOLE_CAMERA_RADIAL3, 1000, 800, 1200.123456789, 1201.987654321, 500.5, 399.25);
+  std::dynamic_pointer_cast<IntrinsicsScaleOffsetDisto>(sfmData.intrinsics[0])->setDistortionParams({0.1 / 3.0, -0.2 / 7.0, 1e-17});
+  sfmData.intrinsics[0]->setSerialNumber("serial");
+  sfmData.intrinsics[0]->lock();
+  sfmData.intrinsics[1] = createIntrinsic(EINTRINSIC::EQUIDISTANT_CAMERA, 1000, 1000, 300.0, 300.0, 500.0, 500.0);
+  std::dynamic_pointer_cast<EquiDistant>(sfmData.intrinsics[1])->setCircleRadius(480.5);
+
+  sfmData.getRigs()[0] = sfmData::Rig(2);
+  sfmData.getRigs()[0].setSubPose(1, sfmData::RigSubPose(Pose3(Mat3::Identity(), Vec3(0.1, 0.2, 1.0 / 3.0)), sfmData::ERigSubPoseStatus::CONSTANT));
+
+  for(IndexT i = 0; i < viewsCount; ++i)
+  {
+    std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>("dataset/" + std::to_string(i) + ".jpg", i, i % 2, i, 1000, 800);
+    view->addMetadata("Make", "Camera");
+    view->setFrameId(i / 2);
+    if(i < 2)
+      view->setRigAndSubPoseId(0, i);
+    sfmData.views[i] = view;
+
+    const Pose3 pose(Eigen::AngleAxisd(distribution(generator), Vec3::UnitZ()).toRotationMatrix(),
+                     Vec3(distribution(generator), distribution(generator), distribution(generator)));
+    sfmData.setPose(*view, sfmData::CameraPose(pose, i == 0));
+  }
+
+  for(IndexT i = 0; i < landmarksCount; ++i)
+  {
+    sfmData::Landmark& landmark = sfmData.structure[i];
+    landmark.X = Vec3(distribution(generator), distribution(generator), distribution(generator));
+    landmark.rgb = image::RGBColor(i % 256, (i / 256) % 256, 12);
+    landmark.descType = (i % 3) ? feature::EImageDescriberType::SIFT : feature::EImageDescriberType::AKAZE;
+    for(IndexT o = 0; o < observationsPerLandmark; ++o)
+      landmark.observations[(i + o * 7) % viewsCount] = sfmData::Observation(Vec2(distribution(generator), distribution(generator)), i * 10 + o, distribution(generator));
+  }
+
+  sfmData.control_points[0] = sfmData.structure[0];
+  sfmData.control_points[0].descType = feature::EImageDescriberType::UNKNOWN;
+
+  return sfmData;
+}
+
+bool bitwiseEqual(double a, double b)
+{
+  return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_BINARY)
+{
+  const std::string filename = "SAVE_LOAD.sfmb";
+  const sfmData::SfMData sfmData = createDetailedTestScene(10, 100, 3);
+  BOOST_CHECK( Save(sfmData, filename, ALL) );
+
+  // LOAD (exact round trip)
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ALL) );
+    BOOST_CHECK( sfmDataLoad == sfmData );
+    BOOST_CHECK( sfmDataLoad.getRelativeFeaturesFolders() == sfmData.getRelativeFeaturesFolders() );
+    BOOST_CHECK( sfmDataLoad.getRelativeMatchesFolders() == sfmData.getRelativeMatchesFolders() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.control_points.size(), sfmData.control_points.size() );
+
+    for(const auto& viewPair : sfmData.views)
+    {
+      const sfmData::View& view = *sfmDataLoad.views.at(viewPair.first);
+      BOOST_CHECK_EQUAL( view.getFrameId(), viewPair.second->getFrameId() );
+      BOOST_CHECK_EQUAL( view.getRigId(), viewPair.second->getRigId() );
+      BOOST_CHECK( view.getMetadata() == viewPair.second->getMetadata() );
+    }
+
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      const sfmData::CameraPose& pose = sfmDataLoad.getPoses().at(posePair.first);
+      BOOST_CHECK_EQUAL( pose.isLocked(), posePair.second.isLocked() );
+      for(int i = 0; i < 9; ++i)
+        BOOST_CHECK( bitwiseEqual(pose.getTransform().rotation()(i), posePair.second.getTransform().rotation()(i)) );
+      for(int i = 0; i < 3; ++i)
+        BOOST_CHECK( bitwiseEqual(pose.getTransform().center()(i), posePair.second.getTransform().center()(i)) );
+    }
+
+    for(const auto& intrinsicPair : sfmData.intrinsics)
+    {
+      const IntrinsicBase& intrinsic = *sfmDataLoad.intrinsics.at(intrinsicPair.first);
+      BOOST_CHECK( intrinsic.getType() == intrinsicPair.second->getType() );
+      BOOST_CHECK_EQUAL( intrinsic.isLocked(), intrinsicPair.second->isLocked() );
+      BOOST_CHECK_EQUAL( intrinsic.serialNumber(), intrinsicPair.second->serialNumber() );
+      const std::vector<double> params = intrinsic.getParams();
+      const std::vector<double> expectedParams = intrinsicPair.second->getParams();
+      BOOST_REQUIRE_EQUAL( params.size(), expectedParams.size() );
+      for(std::size_t i = 0; i < params.size(); ++i)
+        BOOST_CHECK( bitwiseEqual(params[i], expectedParams[i]) );
+    }
+    BOOST_CHECK_EQUAL( std::dynamic_pointer_cast<EquiDistant>(sfmDataLoad.intrinsics.at(1))->getCircleRadius(), 480.5 );
+
+    for(const auto& landmarkPair : sfmData.structure)
+    {
+      const sfmData::Landmark& landmark = sfmDataLoad.structure.at(landmarkPair.first);
+      BOOST_CHECK( landmark.descType == landmarkPair.second.descType );
+      BOOST_CHECK( landmark.rgb == landmarkPair.second.rgb );
+      for(int i = 0; i < 3; ++i)
+        BOOST_CHECK( bitwiseEqual(landmark.X(i), landmarkPair.second.X(i)) );
+      BOOST_REQUIRE_EQUAL( landmark.observations.size(), landmarkPair.second.observations.size() );
+      for(const auto& observationPair : landmarkPair.second.observations)
+      {
+        const sfmData::Observation& observation = landmark.observations.at(observationPair.first);
+        BOOST_CHECK_EQUAL( observation.id_feat, observationPair.second.id_feat );
+        BOOST_CHECK( bitwiseEqual(observation.x(0), observationPair.second.x(0)) );
+        BOOST_CHECK( bitwiseEqual(observation.x(1), observationPair.second.x(1)) );
+        BOOST_CHECK( bitwiseEqual(observation.scale, observationPair.second.scale) );
+      }
+    }
+  }
+
+  // LOAD (only a subpart: STRUCTURE without observations)
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, STRUCTURE) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.views.size(), 0 );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getPoses().size(), 0 );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+    BOOST_CHECK( sfmDataLoad.structure.at(0).observations.empty() );
+  }
+
+  // LOAD (subparts: STRUCTURE with observations but without features)
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ESfMData(STRUCTURE | OBSERVATIONS)) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(0).observations.size(), 3 );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.at(0).observations.begin()->second.id_feat, UndefinedIndexT );
+  }
+
+  // SAVE (only a subpart) and LOAD ALL
+  {
+    BOOST_CHECK( Save(sfmData, filename, ESfMData(VIEWS | INTRINSICS | EXTRINSICS)) );
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ALL) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.views.size(), sfmData.views.size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getPoses().size(), sfmData.getPoses().size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getRigs().size(), sfmData.getRigs().size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.intrinsics.size(), sfmData.intrinsics.size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), 0 );
+    BOOST_CHECK_EQUAL( sfmDataLoad.control_points.size(), 0 );
+  }
+
+  // LOAD (invalid file)
+  {
+    BOOST_CHECK( Save(sfmData, "SAVE_LOAD.json", ALL) );
+    fs::copy_file("SAVE_LOAD.json", "INVALID.sfmb", fs::copy_option::overwrite_if_exists);
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( !Load(sfmDataLoad, "INVALID.sfmb", ALL) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD_DETAILED)
+{
+  std::vector<std::string> ext_Type = {"sfm", "sfmb"};
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
+  ext_Type.push_back("abc");
+#endif
+
+  const sfmData::SfMData sfmData = createDetailedTestScene(10, 100, 3);
+
+  for(const std::string& ext : ext_Type)
+  {
+    const std::string filename = "SAVE_LOAD_DETAILED." + ext;
+    ALICEVISION_LOG_DEBUG("Testing:" << filename);
+
+    BOOST_CHECK( Save(sfmData, filename, ALL) );
+
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK( Load(sfmDataLoad, filename, ALL) );
+    BOOST_CHECK_EQUAL( sfmDataLoad.views.size(), sfmData.views.size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.getPoses().size(), sfmData.getPoses().size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.intrinsics.size(), sfmData.intrinsics.size() );
+    BOOST_CHECK_EQUAL( sfmDataLoad.structure.size(), sfmData.structure.size() );
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
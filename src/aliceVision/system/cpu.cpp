@@ -164,3 +164,90 @@ int get_total_cpus(void)
 
 #endif /* GET_TOTAL_CPUS_DEFINED */
 
+
+/* getSimdLevel() system specific code: uses the compiler builtins or cpuid to detect the instruction sets */
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ALICEVISION_SIMD_DETECTION_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ALICEVISION_SIMD_DETECTION_BUILTIN
+#endif
+
+namespace aliceVision {
+namespace system {
+
+std::string ESimdLevel_enumToString(ESimdLevel simdLevel)
+{
+  switch(simdLevel)
+  {
+    case ESimdLevel::NONE:   return "none";
+    case ESimdLevel::SSE4:   return "sse4";
+    case ESimdLevel::AVX2:   return "avx2";
+    case ESimdLevel::AVX512: return "avx512";
+  }
+  return "unknown";
+}
+
+namespace {
+
+ESimdLevel detectSimdLevel()
+{
+#if defined(ALICEVISION_SIMD_DETECTION_MSVC)
+  int info[4];
+  __cpuid(info, 0);
+  const int nbIds = info[0];
+  if(nbIds < 1)
+    return ESimdLevel::NONE;
+
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  const bool popcnt = (info[2] & (1 << 23)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+
+  if(!sse41 || !popcnt)
+    return ESimdLevel::NONE;
+  if(!osxsave || !avx || nbIds < 7)
+    return ESimdLevel::SSE4;
+
+  // check that the OS saves the XMM and YMM registers
+  const unsigned long long xcr0 = _xgetbv(0);
+  if((xcr0 & 0x6) != 0x6)
+    return ESimdLevel::SSE4;
+
+  __cpuidex(info, 7, 0);
+  const bool avx2 = (info[1] & (1 << 5)) != 0;
+  const bool avx512f = (info[1] & (1 << 16)) != 0;
+  const bool avx512bw = (info[1] & (1 << 30)) != 0;
+
+  if(!avx2)
+    return ESimdLevel::SSE4;
+  // check that the OS also saves the opmask and ZMM registers
+  if(avx512f && avx512bw && (xcr0 & 0xE6) == 0xE6)
+    return ESimdLevel::AVX512;
+  return ESimdLevel::AVX2;
+#elif defined(ALICEVISION_SIMD_DETECTION_BUILTIN)
+  __builtin_cpu_init();
+
+  if(!__builtin_cpu_supports("sse4.1") || !__builtin_cpu_supports("popcnt"))
+    return ESimdLevel::NONE;
+  if(!__builtin_cpu_supports("avx2"))
+    return ESimdLevel::SSE4;
+  if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    return ESimdLevel::AVX512;
+  return ESimdLevel::AVX2;
+#else
+  return ESimdLevel::NONE;
+#endif
+}
+
+} // namespace
+
+ESimdLevel getSimdLevel()
+{
+  static const ESimdLevel simdLevel = detectSimdLevel();
+  return simdLevel;
+}
+
+}
+}
@@ -6,9 +6,31 @@
 
 #pragma once
 
+#include <string>
+
 namespace aliceVision {
 namespace system {
 
+/**
+ * @brief SIMD instruction set levels used to select runtime dispatched kernels.
+ * Each level implies the previous ones.
+ */
+enum class ESimdLevel
+{
+  NONE = 0, //< scalar code only
+  SSE4,     //< SSE4.1 and POPCNT
+  AVX2,     //< AVX2
+  AVX512    //< AVX-512 Foundation and Byte/Word instructions
+};
+
+std::string ESimdLevel_enumToString(ESimdLevel simdLevel);
+
+/**
+ * @brief Returns the highest SIMD instruction set level supported by both the CPU and the OS.
+ * The detection is done once, on the first call.
+ */
+ESimdLevel getSimdLevel();
+
 /**
  * @brief Returns the CPU clock, as reported by the OS.
  *
@@ -0,0 +1,231 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CompactTracks.hpp"
+
+#include <aliceVision/stl/FlatSet.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+
+namespace aliceVision {
+namespace track {
+
+namespace {
+
+inline bool lessViewId(const CompactTracks::Observation& obs, IndexT viewId)
+{
+  return obs.first < viewId;
+}
+
+inline bool sameViewId(const CompactTracks::Observation& a, const CompactTracks::Observation& b)
+{
+  return a.first == b.first;
+}
+
+} // namespace
+
+CompactTracks::FeatureIdPerView::const_iterator CompactTracks::FeatureIdPerView::find(IndexT viewId) const
+{
+  const_iterator it = std::lower_bound(_begin, _end, viewId, lessViewId);
+  if(it != _end && it->first == viewId)
+    return it;
+  return _end;
+}
+
+IndexT CompactTracks::FeatureIdPerView::at(IndexT viewId) const
+{
+  const_iterator it = find(viewId);
+  if(it == _end)
+    throw std::out_of_range("No observation of the track in view " + std::to_string(viewId));
+  return it->second;
+}
+
+void CompactTracks::build(const TracksMap& tracks)
+{
+  clear();
+
+  std::size_t nbObservations = 0;
+  for(const auto& trackPair : tracks)
+    nbObservations += trackPair.second.featPerView.size();
+
+  reserve(tracks.size(), nbObservations);
+
+  // featPerView is already sorted by viewId, so the observations are copied as is
+  for(const auto& trackPair : tracks)
+  {
+    const Track& track = trackPair.second;
+
+    addTrackId(trackPair.first);
+    _descTypes.push_back(track.descType);
+    for(const auto& featView : track.featPerView)
+      _observations.emplace_back(static_cast<IndexT>(featView.first), static_cast<IndexT>(featView.second));
+    _trackOffsets.push_back(_observations.size());
+  }
+
+  finalize();
+}
+
+void CompactTracks::reserve(std::size_t nbTracks, std::size_t nbObservations)
+{
+  _descTypes.reserve(nbTracks);
+  _trackOffsets.reserve(nbTracks + 1);
+  _observations.reserve(nbObservations);
+}
+
+void CompactTracks::appendTrack(std::size_t trackId, feature::EImageDescriberType descType, std::vector<Observation>& observations)
+{
+  if(!empty() && trackId <= getTrackId(size() - 1))
+    throw std::invalid_argument("CompactTracks: track " + std::to_string(trackId) + " is not appended in increasing order.");
+
+  // keep one observation per view, as with Track::featPerView
+  std::stable_sort(observations.begin(), observations.end(),
+                   [](const Observation& a, const Observation& b) { return a.first < b.first; });
+  observations.erase(std::unique(observations.begin(), observations.end(), sameViewId), observations.end());
+
+  addTrackId(trackId);
+  _descTypes.push_back(descType);
+  _observations.insert(_observations.end(), observations.begin(), observations.end());
+  _trackOffsets.push_back(_observations.size());
+}
+
+void CompactTracks::addTrackId(std::size_t trackId)
+{
+  if(trackId > std::numeric_limits<IndexT>::max())
+    throw std::out_of_range("CompactTracks: track id " + std::to_string(trackId) + " does not fit in an IndexT.");
+
+  if(_denseTrackIds)
+  {
+    if(trackId == size())
+      return;
+    // first track with a gap: store all the ids from now on
+    _denseTrackIds = false;
+    _trackIds.resize(size());
+    std::iota(_trackIds.begin(), _trackIds.end(), 0);
+  }
+  _trackIds.push_back(static_cast<IndexT>(trackId));
+}
+
+void CompactTracks::finalize()
+{
+  _viewIds.clear();
+  _viewTracks.clear();
+  _viewOffsets.assign(1, 0);
+
+  // list the views
+  {
+    stl::flat_set<IndexT> viewIds;
+    for(const Observation& obs : _observations)
+      viewIds.insert(obs.first);
+    _viewIds.assign(viewIds.begin(), viewIds.end());
+  }
+
+  // count the tracks per view
+  std::vector<IndexT> viewIndexPerObservation(_observations.size());
+  _viewOffsets.assign(_viewIds.size() + 1, 0);
+  for(std::size_t i = 0; i < _observations.size(); ++i)
+  {
+    const IndexT viewIndex = std::lower_bound(_viewIds.begin(), _viewIds.end(), _observations[i].first) - _viewIds.begin();
+    viewIndexPerObservation[i] = viewIndex;
+    ++_viewOffsets[viewIndex + 1];
+  }
+  for(std::size_t i = 0; i < _viewIds.size(); ++i)
+    _viewOffsets[i + 1] += _viewOffsets[i];
+
+  // fill the track ids, tracks are visited by increasing id so each list is sorted
+  std::vector<std::size_t> cursor(_viewOffsets.begin(), _viewOffsets.end() - 1);
+  _viewTracks.resize(_observations.size());
+  for(std::size_t trackIndex = 0; trackIndex < size(); ++trackIndex)
+  {
+    const IndexT trackId = static_cast<IndexT>(getTrackId(trackIndex));
+    for(std::size_t i = _trackOffsets[trackIndex]; i < _trackOffsets[trackIndex + 1]; ++i)
+      _viewTracks[cursor[viewIndexPerObservation[i]]++] = trackId;
+  }
+}
+
+void CompactTracks::clear()
+{
+  _trackIds.clear();
+  _descTypes.clear();
+  _trackOffsets.assign(1, 0);
+  _observations.clear();
+  _denseTrackIds = true;
+  _viewIds.clear();
+  _viewOffsets.assign(1, 0);
+  _viewTracks.clear();
+}
+
+void CompactTracks::exportToSTL(TracksMap& tracks) const
+{
+  tracks.clear();
+  tracks.reserve(size());
+
+  for(std::size_t i = 0; i < size(); ++i)
+  {
+    const TrackRef trackRef = getTrackByIndex(i);
+    Track& track = tracks.emplace_hint(tracks.end(), trackRef.trackId, Track())->second;
+    track.descType = trackRef.descType;
+    track.featPerView.reserve(trackRef.featPerView.size());
+    for(const Observation& obs : trackRef.featPerView)
+      track.featPerView.emplace_hint(track.featPerView.end(), obs.first, obs.second);
+  }
+}
+
+std::size_t CompactTracks::findTrackIndex(std::size_t trackId) const
+{
+  if(_denseTrackIds)
+    return trackId < size() ? trackId : size();
+
+  const auto it = std::lower_bound(_trackIds.begin(), _trackIds.end(), trackId);
+  if(it != _trackIds.end() && *it == trackId)
+    return it - _trackIds.begin();
+  return size();
+}
+
+CompactTracks::TrackRef CompactTracks::at(std::size_t trackId) const
+{
+  const std::size_t index = findTrackIndex(trackId);
+  if(index == size())
+    throw std::out_of_range("Unknown track id " + std::to_string(trackId));
+  return getTrackByIndex(index);
+}
+
+CompactTracks::TrackIdRange CompactTracks::getTracksInView(IndexT viewId) const
+{
+  const auto it = std::lower_bound(_viewIds.begin(), _viewIds.end(), viewId);
+  if(it == _viewIds.end() || *it != viewId)
+    return {nullptr, nullptr};
+
+  const std::size_t viewIndex = it - _viewIds.begin();
+  const IndexT* data = _viewTracks.data();
+  return {data + _viewOffsets[viewIndex], data + _viewOffsets[viewIndex + 1]};
+}
+
+std::size_t CompactTracks::memoryUsage() const
+{
+  return _trackIds.capacity() * sizeof(IndexT) +
+         _descTypes.capacity() * sizeof(feature::EImageDescriberType) +
+         _trackOffsets.capacity() * sizeof(std::size_t) +
+         _observations.capacity() * sizeof(Observation) +
+         _viewIds.capacity() * sizeof(IndexT) +
+         _viewOffsets.capacity() * sizeof(std::size_t) +
+         _viewTracks.capacity() * sizeof(IndexT);
+}
+
+std::size_t memoryUsage(const TracksMap& tracks)
+{
+  std::size_t size = tracks.capacity() * sizeof(TracksMap::value_type);
+  for(const auto& trackPair : tracks)
+    size += trackPair.second.featPerView.capacity() * sizeof(Track::FeatureIdPerView::value_type);
+  return size;
+}
+
+} // namespace track
+} // namespace aliceVision
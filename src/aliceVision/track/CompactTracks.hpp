@@ -0,0 +1,243 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/track/Track.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace track {
+
+/**
+ * @brief Flat storage of all the tracks of a scene (compressed sparse row layout).
+ *
+ * The observations of all the tracks are stored in a single contiguous array,
+ * sorted by viewId inside each track. A second array of offsets gives the
+ * observations of each track. A reverse index {viewId => sorted trackIds} is
+ * built the same way.
+ *
+ * Compared to a TracksMap, there is no allocation per track and the tracks
+ * can be walked without pointer chasing, but the structure is read-only once built.
+ *
+ * Usage:
+ * @code{.cpp}
+ *  CompactTracks tracks;
+ *  tracksBuilder.exportToCompact(tracks);
+ *  const CompactTracks::TrackRef track = tracks.at(trackId);
+ *  const IndexT featId = track.featPerView.at(viewId);
+ * @endcode
+ */
+class CompactTracks
+{
+public:
+  /// An observation of a track: {ViewId, FeatureId}
+  using Observation = std::pair<IndexT, IndexT>;
+
+  /**
+   * @brief Read-only view on the observations of a track, sorted by viewId.
+   * It mimics the const interface of Track::FeatureIdPerView.
+   */
+  class FeatureIdPerView
+  {
+  public:
+    using value_type = Observation;
+    using const_iterator = const Observation*;
+
+    FeatureIdPerView(const Observation* begin, const Observation* end)
+      : _begin(begin)
+      , _end(end)
+    {}
+
+    const_iterator begin() const { return _begin; }
+    const_iterator end() const { return _end; }
+    std::size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+
+    /**
+     * @brief Find the observation of the given view
+     * @param[in] viewId the view id
+     * @return an iterator on the observation or end()
+     */
+    const_iterator find(IndexT viewId) const;
+
+    /**
+     * @brief Get the feature id of the given view
+     * @param[in] viewId the view id
+     * @return the feature id, throws std::out_of_range if the track is not visible in the view
+     */
+    IndexT at(IndexT viewId) const;
+
+    std::size_t count(IndexT viewId) const { return find(viewId) != _end ? 1 : 0; }
+
+  private:
+    const Observation* _begin;
+    const Observation* _end;
+  };
+
+  /**
+   * @brief Lightweight handle on a track of the storage.
+   * It has the same members as a Track so it can replace it in read-only code.
+   */
+  struct TrackRef
+  {
+    /// Track id
+    std::size_t trackId;
+    /// Descriptor type
+    feature::EImageDescriberType descType;
+    /// Collection of matched features between views: {ViewId, FeatureId}
+    FeatureIdPerView featPerView;
+  };
+
+  /**
+   * @brief Read-only view on the sorted ids of the tracks visible in a view.
+   */
+  struct TrackIdRange
+  {
+    const IndexT* first;
+    const IndexT* last;
+
+    const IndexT* begin() const { return first; }
+    const IndexT* end() const { return last; }
+    std::size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+  CompactTracks() = default;
+
+  explicit CompactTracks(const TracksMap& tracks)
+  {
+    build(tracks);
+  }
+
+  /**
+   * @brief Fill the storage from tracks stored as a map
+   * @param[in] tracks all tracks of the scene as a map {trackId, track}
+   */
+  void build(const TracksMap& tracks);
+
+  /**
+   * @brief Reserve the storage before appending tracks
+   * @param[in] nbTracks number of tracks
+   * @param[in] nbObservations total number of observations
+   */
+  void reserve(std::size_t nbTracks, std::size_t nbObservations);
+
+  /**
+   * @brief Append a track at the end of the storage.
+   *        Track ids must be added in strictly increasing order and fit in an IndexT.
+   *        The reverse index is invalid until finalize() is called.
+   * @param[in] trackId the track id
+   * @param[in] descType the descriptor type of the track
+   * @param[in,out] observations the track observations {viewId, featureId}, sorted in place by viewId
+   */
+  void appendTrack(std::size_t trackId, feature::EImageDescriberType descType, std::vector<Observation>& observations);
+
+  /**
+   * @brief Build the reverse index {viewId => trackIds} after the last appendTrack()
+   */
+  void finalize();
+
+  /**
+   * @brief Remove all the tracks
+   */
+  void clear();
+
+  /**
+   * @brief Export tracks as a map, for code that still needs a TracksMap
+   * @param[out] tracks all tracks of the scene as a map {trackId, track}
+   */
+  void exportToSTL(TracksMap& tracks) const;
+
+  /// @return the number of tracks
+  std::size_t size() const { return _descTypes.size(); }
+
+  bool empty() const { return _descTypes.empty(); }
+
+  /// @return the total number of observations
+  std::size_t nbObservations() const { return _observations.size(); }
+
+  /**
+   * @brief Get the track at the given position in the storage (0 <= index < size())
+   * @param[in] index position of the track, tracks are sorted by increasing id
+   */
+  TrackRef getTrackByIndex(std::size_t index) const
+  {
+    const Observation* data = _observations.data();
+    return {getTrackId(index), _descTypes[index],
+            FeatureIdPerView(data + _trackOffsets[index], data + _trackOffsets[index + 1])};
+  }
+
+  /**
+   * @brief Find a track from its id
+   * @param[in] trackId the track id
+   * @return the position of the track in the storage or size() if the track does not exist
+   */
+  std::size_t findTrackIndex(std::size_t trackId) const;
+
+  bool contains(std::size_t trackId) const { return findTrackIndex(trackId) != size(); }
+
+  /**
+   * @brief Get a track from its id
+   * @param[in] trackId the track id
+   * @return the track, throws std::out_of_range if the track does not exist
+   */
+  TrackRef at(std::size_t trackId) const;
+
+  /**
+   * @brief Get the ids of the tracks visible in a view
+   * @param[in] viewId the view id
+   * @return the sorted track ids (empty if the view has no track)
+   */
+  TrackIdRange getTracksInView(IndexT viewId) const;
+
+  /// @return the sorted ids of the views with at least one track
+  const std::vector<IndexT>& getViewIds() const { return _viewIds; }
+
+  /**
+   * @brief Memory used by the storage
+   * @return the size in bytes of the allocated buffers
+   */
+  std::size_t memoryUsage() const;
+
+private:
+  std::size_t getTrackId(std::size_t index) const { return _denseTrackIds ? index : _trackIds[index]; }
+
+  void addTrackId(std::size_t trackId);
+
+  /// Sorted track ids, empty while the track ids are 0..size()-1
+  std::vector<IndexT> _trackIds;
+  /// Descriptor type of each track
+  std::vector<feature::EImageDescriberType> _descTypes;
+  /// Observations of the track i are in [_trackOffsets[i], _trackOffsets[i+1])
+  std::vector<std::size_t> _trackOffsets{0};
+  /// Observations of all the tracks
+  std::vector<Observation> _observations;
+  /// true if the track ids are 0..size()-1, so they are not stored and findTrackIndex() is direct
+  bool _denseTrackIds = true;
+
+  /// Sorted view ids of the reverse index
+  std::vector<IndexT> _viewIds;
+  /// Track ids of the view i are in [_viewOffsets[i], _viewOffsets[i+1])
+  std::vector<std::size_t> _viewOffsets{0};
+  /// Track ids of all the views
+  std::vector<IndexT> _viewTracks;
+};
+
+/**
+ * @brief Estimate the memory used by tracks stored as a map.
+ *        Allocator overheads are not taken into account.
+ * @param[in] tracks all tracks of the scene as a map {trackId, track}
+ * @return the size in bytes of the allocated buffers
+ */
+std::size_t memoryUsage(const TracksMap& tracks);
+
+} // namespace track
+} // namespace aliceVision
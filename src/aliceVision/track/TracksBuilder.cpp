@@ -6,10 +6,17 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "TracksBuilder.hpp"
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <lemon/list_graph.h>
 #include <lemon/unionfind.h>
 
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
 
 namespace aliceVision {
 namespace track {
@@ -45,6 +52,255 @@ struct TracksBuilderData
   }
 };
 
+namespace {
+
+/// Matches between two views for a given describer type
+struct PairMatches
+{
+  std::size_t I;
+  std::size_t J;
+  feature::EImageDescriberType descType;
+  const IndMatches* matches;
+  /// offset of the features of I (resp. J) in the feature table
+  std::size_t offsetI = 0;
+  std::size_t offsetJ = 0;
+};
+
+/**
+ * @brief Concurrent union-find with atomic parent indexes.
+ *
+ * Unions link the root with the largest index below the other root (with a CAS),
+ * so the root of a set is always its smallest element and the final sets do not depend
+ * on the order of the unions. Parent indexes only decrease, so a stale parent read
+ * by a thread is still an ancestor and relaxed atomics are sufficient.
+ */
+class ConcurrentUnionFind
+{
+public:
+  explicit ConcurrentUnionFind(std::size_t size)
+    : _parents(size)
+  {
+    #pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(size); ++i)
+      _parents[i].store(static_cast<IndexT>(i), std::memory_order_relaxed);
+  }
+
+  IndexT find(IndexT i)
+  {
+    while(true)
+    {
+      IndexT parent = _parents[i].load(std::memory_order_relaxed);
+      if(parent == i)
+        return i;
+      const IndexT grandParent = _parents[parent].load(std::memory_order_relaxed);
+      // path halving, it does not matter if another thread has already updated the parent
+      if(parent != grandParent)
+        _parents[i].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+      i = grandParent;
+    }
+  }
+
+  void join(IndexT a, IndexT b)
+  {
+    while(true)
+    {
+      a = find(a);
+      b = find(b);
+      if(a == b)
+        return;
+      if(a < b)
+        std::swap(a, b);
+      // a may no longer be a root if another thread has linked it in the meantime
+      IndexT expected = a;
+      if(_parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+        return;
+    }
+  }
+
+private:
+  std::vector<std::atomic<IndexT>> _parents;
+};
+
+/**
+ * @brief Build the tracks with a concurrent union-find.
+ * The features are numbered in (viewId, keypointId) order like in the sequential build
+ * and the tracks are ordered by their smallest feature.
+ * @param[in] pairwiseMatches PairWise matches
+ * @param[out] d the tracks builder data
+ */
+void buildConcurrent(const PairwiseMatches& pairwiseMatches, TracksBuilderData& d)
+{
+  typedef std::pair<std::size_t, feature::EImageDescriberType> ViewDescKey;
+
+  // list the matches of each couple of images and describer type
+  std::vector<PairMatches> allPairMatches;
+  for(const auto& matchesPerDescIt: pairwiseMatches)
+  {
+    for(const auto& matchesIt: matchesPerDescIt.second)
+    {
+      PairMatches pairMatches;
+      pairMatches.I = matchesPerDescIt.first.first;
+      pairMatches.J = matchesPerDescIt.first.second;
+      pairMatches.descType = matchesIt.first;
+      pairMatches.matches = &matchesIt.second;
+      allPairMatches.push_back(pairMatches);
+    }
+  }
+  const std::ptrdiff_t nbPairMatches = static_cast<std::ptrdiff_t>(allPairMatches.size());
+
+  // find the maximum feature index of each image and describer type
+  std::vector<std::size_t> featureCountI(allPairMatches.size(), 0);
+  std::vector<std::size_t> featureCountJ(allPairMatches.size(), 0);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t p = 0; p < nbPairMatches; ++p)
+  {
+    for(const IndMatch& m: *allPairMatches[p].matches)
+    {
+      featureCountI[p] = std::max(featureCountI[p], static_cast<std::size_t>(m._i) + 1);
+      featureCountJ[p] = std::max(featureCountJ[p], static_cast<std::size_t>(m._j) + 1);
+    }
+  }
+
+  // feature table: one slot per possible feature of each (image, describer type), in (viewId, keypointId) order
+  std::map<ViewDescKey, std::size_t> tableOffsets;
+  for(std::size_t p = 0; p < allPairMatches.size(); ++p)
+  {
+    std::size_t& countI = tableOffsets[ViewDescKey(allPairMatches[p].I, allPairMatches[p].descType)];
+    countI = std::max(countI, featureCountI[p]);
+    std::size_t& countJ = tableOffsets[ViewDescKey(allPairMatches[p].J, allPairMatches[p].descType)];
+    countJ = std::max(countJ, featureCountJ[p]);
+  }
+
+  std::size_t tableSize = 0;
+  for(auto& tableOffsetIt: tableOffsets)
+  {
+    const std::size_t count = tableOffsetIt.second;
+    tableOffsetIt.second = tableSize;
+    tableSize += count;
+  }
+
+  for(PairMatches& pairMatches: allPairMatches)
+  {
+    pairMatches.offsetI = tableOffsets.at(ViewDescKey(pairMatches.I, pairMatches.descType));
+    pairMatches.offsetJ = tableOffsets.at(ViewDescKey(pairMatches.J, pairMatches.descType));
+  }
+
+  // mark the matched features
+  std::vector<std::atomic<IndexT>> featureToNode(tableSize);
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(tableSize); ++i)
+    featureToNode[i].store(0, std::memory_order_relaxed);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t p = 0; p < nbPairMatches; ++p)
+  {
+    const PairMatches& pairMatches = allPairMatches[p];
+    for(const IndMatch& m: *pairMatches.matches)
+    {
+      featureToNode[pairMatches.offsetI + m._i].store(1, std::memory_order_relaxed);
+      featureToNode[pairMatches.offsetJ + m._j].store(1, std::memory_order_relaxed);
+    }
+  }
+
+  // number the matched features (parallel prefix sum over blocks of the table)
+  const std::ptrdiff_t nbBlocks = std::max<std::ptrdiff_t>(1, std::min<std::ptrdiff_t>(omp_get_max_threads() * 4, tableSize));
+  const std::size_t blockSize = (tableSize + nbBlocks - 1) / nbBlocks;
+  std::vector<std::size_t> blockOffsets(nbBlocks + 1, 0);
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t b = 0; b < nbBlocks; ++b)
+  {
+    const std::size_t end = std::min(tableSize, (b + 1) * blockSize);
+    for(std::size_t i = b * blockSize; i < end; ++i)
+      blockOffsets[b + 1] += featureToNode[i].load(std::memory_order_relaxed);
+  }
+
+  for(std::ptrdiff_t b = 0; b < nbBlocks; ++b)
+    blockOffsets[b + 1] += blockOffsets[b];
+
+  const std::size_t nbNodes = blockOffsets.back();
+  if(nbNodes >= static_cast<std::size_t>(std::numeric_limits<int>::max()))
+    throw std::runtime_error("Too many features to build the tracks: " + std::to_string(nbNodes));
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t b = 0; b < nbBlocks; ++b)
+  {
+    IndexT nodeId = static_cast<IndexT>(blockOffsets[b]);
+    const std::size_t end = std::min(tableSize, (b + 1) * blockSize);
+    for(std::size_t i = b * blockSize; i < end; ++i)
+      featureToNode[i].store(featureToNode[i].load(std::memory_order_relaxed) ? nodeId++ : UndefinedIndexT, std::memory_order_relaxed);
+  }
+
+  // node to feature
+  const std::vector<std::pair<ViewDescKey, std::size_t>> tableOffsetsVec(tableOffsets.begin(), tableOffsets.end());
+  std::vector<IndexedFeaturePair> nodeToFeature(nbNodes);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(tableOffsetsVec.size()); ++k)
+  {
+    const ViewDescKey& key = tableOffsetsVec[k].first;
+    const std::size_t begin = tableOffsetsVec[k].second;
+    const std::size_t end = (k + 1 < static_cast<std::ptrdiff_t>(tableOffsetsVec.size())) ? tableOffsetsVec[k + 1].second : tableSize;
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      const IndexT nodeId = featureToNode[i].load(std::memory_order_relaxed);
+      if(nodeId != UndefinedIndexT)
+        nodeToFeature[nodeId] = IndexedFeaturePair(key.first, KeypointId(key.second, i - begin));
+    }
+  }
+
+  // make the union according the pair matches
+  ConcurrentUnionFind unionFind(nbNodes);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(std::ptrdiff_t p = 0; p < nbPairMatches; ++p)
+  {
+    const PairMatches& pairMatches = allPairMatches[p];
+    for(const IndMatch& m: *pairMatches.matches)
+    {
+      unionFind.join(featureToNode[pairMatches.offsetI + m._i].load(std::memory_order_relaxed),
+                     featureToNode[pairMatches.offsetJ + m._j].load(std::memory_order_relaxed));
+    }
+  }
+
+  std::vector<IndexT> roots(nbNodes);
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(nbNodes); ++i)
+    roots[i] = unionFind.find(static_cast<IndexT>(i));
+
+  // build the graph nodes and the UnionFind structure from the sets
+  std::vector<lemon::ListDigraph::Node> nodes(nbNodes);
+  d.graph.reserveNode(nbNodes);
+  d.map_nodeToIndex.reserve(nbNodes);
+
+  for(std::size_t i = 0; i < nbNodes; ++i)
+  {
+    nodes[i] = d.graph.addNode();
+    d.map_nodeToIndex.insert(std::make_pair(nodes[i], nodeToFeature[i]));
+  }
+
+  d.index.reset(new IndexMap(d.graph));
+  d.tracksUF.reset(new UnionFindObject(*d.index));
+
+  // the classes are iterated from the last inserted one, so they are inserted from the largest root
+  std::vector<int> rootClasses(nbNodes, -1);
+  for(std::ptrdiff_t i = static_cast<std::ptrdiff_t>(nbNodes) - 1; i >= 0; --i)
+  {
+    if(roots[i] == i)
+      rootClasses[i] = d.tracksUF->insert(nodes[i]);
+  }
+  for(std::size_t i = 0; i < nbNodes; ++i)
+  {
+    if(roots[i] != i)
+      d.tracksUF->insert(nodes[i], rootClasses[roots[i]]);
+  }
+}
+
+} // namespace
+
 TracksBuilder::TracksBuilder()
 {
     _d.reset(new TracksBuilderData());
@@ -52,8 +308,14 @@ TracksBuilder::TracksBuilder()
 
 TracksBuilder::~TracksBuilder() = default;
 
-void TracksBuilder::build(const PairwiseMatches& pairwiseMatches)
+void TracksBuilder::build(const PairwiseMatches& pairwiseMatches, bool multithreaded)
 {
+  if(multithreaded)
+  {
+    buildConcurrent(pairwiseMatches, *_d);
+    return;
+  }
+
   typedef std::set<IndexedFeaturePair> SetIndexedPair;
 
   // set of all features of all images: (imageIndex, featureIndex)
@@ -202,6 +464,39 @@ void TracksBuilder::exportToSTL(TracksMap& allTracks) const
   }
 }
 
+void TracksBuilder::exportToCompact(CompactTracks& allTracks) const
+{
+  allTracks.clear();
+
+  // count the remaining tracks and observations to allocate the storage once
+  std::size_t nbTracks = 0;
+  std::size_t nbObservations = 0;
+  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit, ++nbTracks)
+  {
+    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+      ++nbObservations;
+  }
+  allTracks.reserve(nbTracks, nbObservations);
+
+  std::vector<CompactTracks::Observation> observations;
+  std::size_t trackIndex = 0;
+  for(lemon::UnionFindEnum< IndexMap >::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit, ++trackIndex)
+  {
+    observations.clear();
+    // all descType inside the track will be the same
+    feature::EImageDescriberType descType = feature::EImageDescriberType::UNINITIALIZED;
+
+    for(lemon::UnionFindEnum< IndexMap >::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+    {
+      const IndexedFeaturePair & currentPair = _d->map_nodeToIndex.at(iit);
+      descType = currentPair.second.descType;
+      observations.emplace_back(currentPair.first, currentPair.second.featIndex);
+    }
+    allTracks.appendTrack(trackIndex, descType, observations);
+  }
+  allTracks.finalize();
+}
+
 std::size_t TracksBuilder::nbTracks() const
 {
     std::size_t cpt = 0;
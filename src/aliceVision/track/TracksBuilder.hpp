@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/CompactTracks.hpp>
 
 #include <memory>
 
@@ -51,8 +52,11 @@ public:
     /**
     * @brief Build tracks for a given series of pairWise matches
     * @param[in] pairwiseMatches PairWise matches
+    * @param[in] multithreaded use a concurrent union-find:
+    *            the tracks are the same as with the sequential union-find,
+    *            but they are ordered by their smallest (viewId, keypointId) observation
     */
-    void build(const PairwiseMatches& pairwiseMatches);
+    void build(const PairwiseMatches& pairwiseMatches, bool multithreaded = false);
 
     /**
     * @brief Remove bad tracks (too short or track with ids collision)
@@ -75,6 +79,12 @@ public:
     */
     void exportToSTL(TracksMap& allTracks) const;
 
+    /**
+    * @brief Export tracks to a flat storage, without allocation per track.
+    *        Track ids are the same as with exportToSTL.
+    */
+    void exportToCompact(CompactTracks& allTracks) const;
+
     /**
     * @brief Return the number of connected set in the UnionFind structure (tree forest)
     * @return number of connected set in the UnionFind structure
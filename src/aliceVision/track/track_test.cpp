@@ -5,10 +5,15 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "aliceVision/track/CompactTracks.hpp"
 #include "aliceVision/track/TracksBuilder.hpp"
 #include "aliceVision/track/tracksUtils.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
+#include "aliceVision/alicevision_omp.hpp"
 
+#include <algorithm>
+#include <map>
+#include <random>
 #include <vector>
 #include <utility>
 
@@ -180,6 +185,122 @@ BOOST_AUTO_TEST_CASE(Track_Conflict) {
   }
 }
 
+/**
+ * @brief Generate random pairwise matches from random ground truth tracks
+ *        with some outlier matches that merge tracks and create forks.
+ */
+PairwiseMatches generateRandomMatches(std::size_t nbViews, std::size_t nbPoints, double outlierRatio)
+{
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<std::size_t> viewDistribution(0, nbViews - 1);
+  std::uniform_int_distribution<std::size_t> trackLengthDistribution(2, 8);
+  std::bernoulli_distribution matchDistribution(0.5);
+  std::bernoulli_distribution outlierDistribution(outlierRatio);
+
+  std::vector<std::size_t> nbFeaturesPerView(nbViews, 0);
+  PairwiseMatches pairwiseMatches;
+
+  for(std::size_t p = 0; p < nbPoints; ++p)
+  {
+    // observations of the point: (viewId, featureId) with distinct views
+    std::vector<std::pair<std::size_t, std::size_t>> observations;
+    const std::size_t trackLength = trackLengthDistribution(generator);
+    for(std::size_t k = 0; k < trackLength; ++k)
+    {
+      const std::size_t viewId = viewDistribution(generator);
+      if(std::find_if(observations.begin(), observations.end(), [&](const std::pair<std::size_t, std::size_t>& o){ return o.first == viewId; }) == observations.end())
+        observations.emplace_back(viewId, nbFeaturesPerView[viewId]++);
+    }
+    std::sort(observations.begin(), observations.end());
+
+    for(std::size_t i = 0; i < observations.size(); ++i)
+    {
+      for(std::size_t j = i + 1; j < observations.size(); ++j)
+      {
+        if(!matchDistribution(generator))
+          continue;
+        IndMatches& matches = pairwiseMatches[std::make_pair(observations[i].first, observations[j].first)][EImageDescriberType::SIFT];
+        if(outlierDistribution(generator) && nbFeaturesPerView[observations[j].first] > 1)
+        {
+          // match with a random feature of the second view
+          std::uniform_int_distribution<std::size_t> featureDistribution(0, nbFeaturesPerView[observations[j].first] - 1);
+          matches.emplace_back(observations[i].second, featureDistribution(generator));
+        }
+        else
+          matches.emplace_back(observations[i].second, observations[j].second);
+      }
+    }
+  }
+  return pairwiseMatches;
+}
+
+BOOST_AUTO_TEST_CASE(Track_Concurrent_SameTracks)
+{
+  const PairwiseMatches pairwiseMatches = generateRandomMatches(30, 20000, 0.05);
+
+  TracksBuilder sequentialBuilder;
+  sequentialBuilder.build(pairwiseMatches);
+
+  TracksBuilder concurrentBuilder;
+  concurrentBuilder.build(pairwiseMatches, true);
+
+  BOOST_CHECK_EQUAL(sequentialBuilder.nbTracks(), concurrentBuilder.nbTracks());
+
+  // remove the forks to compare the exported tracks
+  sequentialBuilder.filter(true, 2);
+  concurrentBuilder.filter(true, 2);
+
+  TracksMap sequentialTracks;
+  TracksMap concurrentTracks;
+  sequentialBuilder.exportToSTL(sequentialTracks);
+  concurrentBuilder.exportToSTL(concurrentTracks);
+
+  BOOST_REQUIRE_EQUAL(sequentialTracks.size(), concurrentTracks.size());
+  BOOST_CHECK(sequentialTracks.size() > 1000);
+
+  std::vector<Track::FeatureIdPerView> sequentialTracksFeatures;
+  std::vector<Track::FeatureIdPerView> concurrentTracksFeatures;
+  for(const auto& trackIt: sequentialTracks)
+    sequentialTracksFeatures.push_back(trackIt.second.featPerView);
+  for(const auto& trackIt: concurrentTracks)
+  {
+    BOOST_CHECK(trackIt.second.descType == EImageDescriberType::SIFT);
+    concurrentTracksFeatures.push_back(trackIt.second.featPerView);
+  }
+
+  // the concurrent tracks are ordered by their smallest observation
+  BOOST_CHECK(std::is_sorted(concurrentTracksFeatures.begin(), concurrentTracksFeatures.end(),
+    [](const Track::FeatureIdPerView& a, const Track::FeatureIdPerView& b){ return *a.begin() < *b.begin(); }));
+
+  std::sort(sequentialTracksFeatures.begin(), sequentialTracksFeatures.end());
+  std::sort(concurrentTracksFeatures.begin(), concurrentTracksFeatures.end());
+  BOOST_CHECK(sequentialTracksFeatures == concurrentTracksFeatures);
+}
+
+BOOST_AUTO_TEST_CASE(Track_Concurrent_ThreadCounts)
+{
+  const PairwiseMatches pairwiseMatches = generateRandomMatches(30, 5000, 0.05);
+
+  const auto buildNbTracks = [&](bool multithreaded)
+  {
+    TracksBuilder tracksBuilder;
+    tracksBuilder.build(pairwiseMatches, multithreaded);
+    return tracksBuilder.nbTracks();
+  };
+
+  const std::size_t sequentialNbTracks = buildNbTracks(false);
+
+  const int maxThreads = omp_get_max_threads();
+  for(int nbThreads = 1; ; nbThreads = std::min(2 * nbThreads, maxThreads))
+  {
+    omp_set_num_threads(nbThreads);
+    BOOST_CHECK_EQUAL(buildNbTracks(true), sequentialNbTracks);
+    if(nbThreads == maxThreads)
+      break;
+  }
+  omp_set_num_threads(maxThreads);
+}
+
 BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
 {
   {
@@ -228,3 +349,137 @@ BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
     BOOST_CHECK_EQUAL(base.size(), set_visibleTracks.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(Track_Compact_SameTracks)
+{
+  const PairwiseMatches pairwiseMatches = generateRandomMatches(30, 20000, 0.05);
+
+  TracksBuilder tracksBuilder;
+  tracksBuilder.build(pairwiseMatches);
+  tracksBuilder.filter(true, 2);
+
+  TracksMap tracks;
+  tracksBuilder.exportToSTL(tracks);
+
+  CompactTracks compactTracks;
+  tracksBuilder.exportToCompact(compactTracks);
+
+  BOOST_REQUIRE_EQUAL(tracks.size(), compactTracks.size());
+  BOOST_CHECK(tracks.size() > 1000);
+
+  // same tracks with the same ids
+  for(const auto& trackIt: tracks)
+  {
+    const CompactTracks::TrackRef track = compactTracks.at(trackIt.first);
+    BOOST_CHECK_EQUAL(track.trackId, trackIt.first);
+    BOOST_CHECK(track.descType == trackIt.second.descType);
+    BOOST_REQUIRE_EQUAL(track.featPerView.size(), trackIt.second.featPerView.size());
+    BOOST_CHECK(std::equal(track.featPerView.begin(), track.featPerView.end(), trackIt.second.featPerView.begin(),
+      [](const CompactTracks::Observation& a, const std::pair<std::size_t, std::size_t>& b){ return a.first == b.first && a.second == b.second; }));
+    for(const auto& featView: trackIt.second.featPerView)
+      BOOST_CHECK_EQUAL(track.featPerView.at(featView.first), featView.second);
+  }
+  BOOST_CHECK(!compactTracks.contains(tracks.size()));
+  BOOST_CHECK_THROW(compactTracks.at(tracks.size()), std::out_of_range);
+
+  // round trip through the adapter
+  TracksMap exportedTracks;
+  compactTracks.exportToSTL(exportedTracks);
+  BOOST_REQUIRE_EQUAL(exportedTracks.size(), tracks.size());
+  for(const auto& trackIt: tracks)
+    BOOST_CHECK(exportedTracks.at(trackIt.first).featPerView == trackIt.second.featPerView);
+
+  // the reverse index is the same as the tracks per view
+  TracksPerView tracksPerView;
+  computeTracksPerView(tracks, tracksPerView);
+  BOOST_CHECK_EQUAL(tracksPerView.size(), compactTracks.getViewIds().size());
+  for(const auto& viewTracks: tracksPerView)
+  {
+    const CompactTracks::TrackIdRange compactViewTracks = compactTracks.getTracksInView(viewTracks.first);
+    BOOST_CHECK(std::equal(viewTracks.second.begin(), viewTracks.second.end(), compactViewTracks.begin(), compactViewTracks.end()));
+  }
+  BOOST_CHECK(compactTracks.getTracksInView(1000).empty());
+
+  // sparse track ids
+  TracksMap sparseTracks;
+  for(const auto& trackIt: tracks)
+  {
+    if(trackIt.first % 3 == 0)
+      sparseTracks[trackIt.first] = trackIt.second;
+  }
+  const CompactTracks sparseCompactTracks(sparseTracks);
+  BOOST_CHECK_EQUAL(sparseCompactTracks.size(), sparseTracks.size());
+  BOOST_CHECK(sparseCompactTracks.contains(3));
+  BOOST_CHECK(!sparseCompactTracks.contains(4));
+
+  std::map<std::size_t, std::size_t> sparseLength;
+  std::map<std::size_t, std::size_t> sparseCompactLength;
+  tracksLength(sparseTracks, sparseLength);
+  tracksLength(sparseCompactTracks, sparseCompactLength);
+  BOOST_CHECK(sparseLength == sparseCompactLength);
+
+  TracksMap commonTracks;
+  std::vector<CompactTracks::TrackRef> compactCommonTracks;
+  tracksPerView.clear();
+  computeTracksPerView(sparseTracks, tracksPerView);
+  for(const std::set<std::size_t>& imageIndexes : {std::set<std::size_t>{0, 1}, std::set<std::size_t>{0, 1, 2}})
+  {
+    getCommonTracksInImagesFast(imageIndexes, sparseTracks, tracksPerView, commonTracks);
+    getCommonTracksInImagesFast(imageIndexes, sparseCompactTracks, compactCommonTracks);
+    BOOST_CHECK(!commonTracks.empty());
+    BOOST_REQUIRE_EQUAL(commonTracks.size(), compactCommonTracks.size());
+
+    // the common tracks keep all their observations
+    auto compactTrackIt = compactCommonTracks.begin();
+    for(const auto& trackIt: commonTracks)
+    {
+      BOOST_CHECK_EQUAL(compactTrackIt->trackId, trackIt.first);
+      for(const auto& featView: trackIt.second.featPerView)
+        BOOST_CHECK_EQUAL(compactTrackIt->featPerView.at(featView.first), featView.second);
+      ++compactTrackIt;
+    }
+  }
+
+  std::set<aliceVision::IndexT> tracksInViews;
+  std::set<aliceVision::IndexT> compactTracksInViews;
+  getTracksInImagesFast({0, 1}, tracksPerView, tracksInViews);
+  getTracksInImagesFast({0, 1}, sparseCompactTracks, compactTracksInViews);
+  BOOST_CHECK(tracksInViews == compactTracksInViews);
+}
+
+BOOST_AUTO_TEST_CASE(Track_Compact_RandomTracks)
+{
+  const PairwiseMatches pairwiseMatches = generateRandomMatches(30, 5000, 0.05);
+
+  TracksBuilder tracksBuilder;
+  tracksBuilder.build(pairwiseMatches);
+  tracksBuilder.filter(true, 2);
+
+  TracksMap tracks;
+  CompactTracks compactTracks;
+  tracksBuilder.exportToSTL(tracks);
+  tracksBuilder.exportToCompact(compactTracks);
+
+  // The incremental SfM selects the tracks visible in the reconstructed views
+  // and then walks their observations in the other views (triangulation, resection).
+  // Both storages must give the same observations for this access pattern.
+  TracksPerView tracksPerView;
+  computeTracksPerView(tracks, tracksPerView);
+  const std::set<std::size_t> views = {0, 5, 15, 25};
+  std::set<aliceVision::IndexT> tracksInViews;
+  getTracksInImagesFast({10, 20}, tracksPerView, tracksInViews);
+  BOOST_CHECK(!tracksInViews.empty());
+
+  std::size_t nbObservations = 0;
+  std::size_t compactNbObservations = 0;
+  for(std::size_t trackId: tracksInViews)
+  {
+    for(const auto& featView: tracks.at(trackId).featPerView)
+      nbObservations += views.count(featView.first);
+    for(const auto& featView: compactTracks.at(trackId).featPerView)
+      compactNbObservations += views.count(featView.first);
+  }
+  BOOST_CHECK_EQUAL(nbObservations, compactNbObservations);
+
+  BOOST_CHECK(compactTracks.memoryUsage() < memoryUsage(tracks));
+}
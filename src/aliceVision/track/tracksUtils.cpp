@@ -7,6 +7,7 @@
 
 #include "tracksUtils.hpp"
 
+#include <algorithm>
 #include <iterator>
 
 
@@ -120,6 +121,34 @@ bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
   return !tracksOut.empty();
 }
 
+bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
+                                 const CompactTracks& tracksIn,
+                                 std::vector<CompactTracks::TrackRef>& tracksOut)
+{
+  assert(!imageIndexes.empty());
+  tracksOut.clear();
+
+  // intersect the sorted track ids of the images, starting from the first one
+  auto imageIt = imageIndexes.begin();
+  const CompactTracks::TrackIdRange firstTracks = tracksIn.getTracksInView(*imageIt);
+  std::vector<IndexT> commonTrackIds(firstTracks.begin(), firstTracks.end());
+  std::vector<IndexT> intersection;
+  for(++imageIt; imageIt != imageIndexes.end() && !commonTrackIds.empty(); ++imageIt)
+  {
+    const CompactTracks::TrackIdRange imageTracks = tracksIn.getTracksInView(*imageIt);
+    intersection.clear();
+    std::set_intersection(commonTrackIds.begin(), commonTrackIds.end(),
+                          imageTracks.begin(), imageTracks.end(),
+                          std::back_inserter(intersection));
+    std::swap(commonTrackIds, intersection);
+  }
+
+  tracksOut.reserve(commonTrackIds.size());
+  for(const IndexT trackId : commonTrackIds)
+    tracksOut.push_back(tracksIn.at(trackId));
+  return !tracksOut.empty();
+}
+
 void getTracksInImages(const std::set<std::size_t>& imagesId,
                        const TracksMap& tracks,
                        std::set<std::size_t>& tracksId)
@@ -146,6 +175,18 @@ void getTracksInImagesFast(const std::set<IndexT>& imagesId,
   }
 }
 
+void getTracksInImagesFast(const std::set<IndexT>& imagesId,
+                           const CompactTracks& tracks,
+                           std::set<IndexT>& tracksIds)
+{
+  tracksIds.clear();
+  for(const IndexT id : imagesId)
+  {
+    const CompactTracks::TrackIdRange imageTracks = tracks.getTracksInView(id);
+    tracksIds.insert(imageTracks.begin(), imageTracks.end());
+  }
+}
+
 void getTracksInImage(const std::size_t& imageIndex,
                              const TracksMap& tracks,
                              std::set<std::size_t>& tracksIds)
@@ -224,6 +265,28 @@ bool getFeatureIdInViewPerTrack(const TracksMap& allTracks,
   return !out_featId->empty();
 }
 
+bool getFeatureIdInViewPerTrack(const CompactTracks& allTracks,
+                                const std::set<std::size_t>& trackIds,
+                                IndexT viewId,
+                                std::vector<FeatureId>* out_featId)
+{
+  for(std::size_t trackId: trackIds)
+  {
+    const std::size_t trackIndex = allTracks.findTrackIndex(trackId);
+
+    // ignore it if the track doesn't exist
+    if(trackIndex == allTracks.size())
+      continue;
+
+    // try to find imageIndex
+    const CompactTracks::TrackRef track = allTracks.getTrackByIndex(trackIndex);
+    const auto iterSearch = track.featPerView.find(viewId);
+    if(iterSearch != track.featPerView.end())
+      out_featId->emplace_back(track.descType, iterSearch->second);
+  }
+  return !out_featId->empty();
+}
+
 void tracksToIndexedMatches(const TracksMap& tracks,
                                    const std::vector<IndexT>& filterIndex,
                                    std::vector<IndMatch>* out_index)
@@ -264,6 +327,13 @@ void tracksLength(const TracksMap& tracks,
   }
 }
 
+void tracksLength(const CompactTracks& tracks,
+                  std::map<std::size_t, std::size_t>& occurenceTrackLength)
+{
+  for(std::size_t i = 0; i < tracks.size(); ++i)
+    ++occurenceTrackLength[tracks.getTrackByIndex(i).featPerView.size()];
+}
+
 void imageIdInTracks(const TracksPerView& tracksPerView,
                             std::set<std::size_t>& imagesId)
 {
@@ -7,6 +7,7 @@
 
 #pragma once
 #include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/CompactTracks.hpp>
 
 
 namespace aliceVision {
@@ -43,6 +44,16 @@ bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
                                           const TracksMap& tracksIn,
                                           const TracksPerView& tracksPerView,
                                           TracksMap& tracksOut);
+
+/**
+ * @brief Find common tracks among images, without copying them.
+ * @param[in] imageIndexes: set of images we are looking for common tracks.
+ * @param[in] tracksIn: all tracks of the scene, with their reverse index.
+ * @param[out] tracksOut: the common tracks sorted by id, with all their observations.
+ */
+bool getCommonTracksInImagesFast(const std::set<std::size_t>& imageIndexes,
+                                 const CompactTracks& tracksIn,
+                                 std::vector<CompactTracks::TrackRef>& tracksOut);
   
 /**
  * @brief Find all the visible tracks from a set of images.
@@ -64,6 +75,16 @@ void getTracksInImagesFast(const std::set<IndexT>& imagesId,
                                   const TracksPerView& tracksPerView,
                                   std::set<IndexT>& tracksIds);
 
+/**
+ * @brief Find all the visible tracks from a set of images.
+ * @param[in] imagesId set of images we are looking for tracks.
+ * @param[in] tracks all tracks of the scene, with their reverse index.
+ * @param[out] tracksId the tracks in the images
+ */
+void getTracksInImagesFast(const std::set<IndexT>& imagesId,
+                           const CompactTracks& tracks,
+                           std::set<IndexT>& tracksIds);
+
 /**
  * @brief Find all the visible tracks from a single image.
  * @param[in] imageIndex of the image we are looking for tracks.
@@ -112,6 +133,19 @@ bool getFeatureIdInViewPerTrack(const TracksMap& allTracks,
                                        IndexT viewId,
                                        std::vector<FeatureId>* out_featId);
 
+/**
+ * @brief Get feature id (with associated describer type) in the specified view for each TrackId
+ * @param[in] allTracks all tracks of the scene
+ * @param[in] trackIds the tracks in the images
+ * @param[in] viewId: ImageId we are looking for features
+ * @param[out] out_featId the number of features in the image as a vector
+ * @return true if the vector of features Ids is not empty
+ */
+bool getFeatureIdInViewPerTrack(const CompactTracks& allTracks,
+                                const std::set<std::size_t>& trackIds,
+                                IndexT viewId,
+                                std::vector<FeatureId>* out_featId);
+
 
 struct FunctorMapFirstEqual : public std::unary_function <TracksMap , bool>
 {
@@ -150,6 +184,14 @@ void tracksToIndexedMatches(const TracksMap& tracks,
 void tracksLength(const TracksMap& tracks,
                          std::map<std::size_t, std::size_t>& occurenceTrackLength);
 
+/**
+ * @brief Return the occurrence of tracks length.
+ * @param[in] tracks all tracks of the scene
+ * @param[out] occurenceTrackLength : the occurence length of each trackId in the scene
+ */
+void tracksLength(const CompactTracks& tracks,
+                  std::map<std::size_t, std::size_t>& occurenceTrackLength);
+
 /**
  * @brief Return a set containing the image Id considered in the tracks container.
  * @param[in] tracksPerView the visible tracks as a map {viewID, vector<trackID>}
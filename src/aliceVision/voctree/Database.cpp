@@ -13,9 +13,17 @@
 #include <stdexcept>
 #include <boost/format.hpp>
 
+#include <algorithm>
+
 namespace aliceVision{
 namespace voctree{
 
+/// Order the matches from best to worst, the matches with the same score are ordered by document id.
+static bool isBetterMatch(const DocMatch& a, const DocMatch& b)
+{
+  return (a.score < b.score) || (a.score == b.score && a.id < b.id);
+}
+
 std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)	
 {
 	for( const auto &e : dv )
@@ -35,19 +43,30 @@ DocId Database::insert(DocId doc_id, const SparseHistogram& document)
   // Ensure that the new document to insert is not already there.
   assert(database_.find(doc_id) == database_.end());
 
+  const uint32_t docIndex = doc_norms_.size();
+  DocumentNorms norms{doc_id, 0, 0};
+
   // For each word, retrieve its inverted file and increment the count for doc_id.
   for(SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
   {
     Word word = it->first;
     InvertedFile& file = word_files_[word];
-    if(file.empty() || file.back().id != doc_id)
-      file.push_back(WordFrequency(doc_id, it->second.size()));
+    if(file.empty() || file.back().index != docIndex)
+      file.push_back(WordFrequency(docIndex, it->second.size()));
     else
       file.back().count += it->second.size();
+
+    norms.l1Norm += it->second.size();
+    norms.squaredL2Norm += it->second.size() * it->second.size();
   }
 
   database_[doc_id] = document;
 
+  doc_norms_.push_back(norms);
+  doc_indexes_[doc_id] = docIndex;
+  docs_by_l1_norm_.emplace(norms.l1Norm, doc_id);
+  docs_by_squared_l2_norm_.emplace(norms.squaredL2Norm, doc_id);
+
   return doc_id;
 }
 
@@ -109,6 +128,28 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
  * @param[in] distanceMethod the method used to compute distance between histograms.
  */
 void Database::find( const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
+{
+  if(distanceMethod == "classic" || distanceMethod == "L2" ||
+     distanceMethod == "commonPoints" || distanceMethod == "strongCommonPoints")
+  {
+    findInvertedFile(query, N, matches, distanceMethod);
+  }
+  else
+  {
+    findExhaustive(query, N, matches, distanceMethod);
+  }
+}
+
+/**
+ * @brief Find the top N matches in the database for the query document,
+ * computing the distance between the query and each document of the database.
+ *
+ * @param      query The query document, a normalized set of quantized words.
+ * @param      N        The number of matches to return.
+ * @param[out] matches  IDs and scores for the top N matching database documents.
+ * @param[in] distanceMethod the method used to compute distance between histograms.
+ */
+void Database::findExhaustive(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
 {
     matches.clear();
     matches.reserve(database_.size());
@@ -120,10 +161,136 @@ void Database::find( const SparseHistogram& query, std::size_t N, std::vector<Do
         matches.emplace_back(document.first, distance);
     }
     const std::size_t nMatches = std::min(N, matches.size());
-    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
+    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end(), isBetterMatch);
     matches.resize(nMatches);
 }
 
+/**
+ * @brief Find the top N matches in the database for the query document using the inverted files.
+ *
+ * The distances are rewritten as a sum over the common words of the query and the document:
+ * - classic: |q - d|_1 = |q|_1 + |d|_1 - 2 * sum(min(q_w, d_w))
+ * - L2: |q - d|_2^2 = |q|_2^2 + |d|_2^2 - 2 * sum(q_w * d_w)
+ * - commonPoints: -sum(min(q_w, d_w))
+ * - strongCommonPoints: -#{w, q_w = d_w = 1}
+ * The sums are accumulated by going through the inverted files of the query words. The distance
+ * of the other documents only depends on their norm, the best of them are taken in norm order.
+ *
+ * @param      query The query document, a normalized set of quantized words.
+ * @param      N        The number of matches to return.
+ * @param[out] matches  IDs and scores for the top N matching database documents.
+ * @param[in] distanceMethod the method used to compute distance between histograms.
+ */
+void Database::findInvertedFile(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
+{
+  matches.clear();
+  if(N == 0)
+    return;
+
+  const bool strongCommonPoints = (distanceMethod == "strongCommonPoints");
+  const bool commonPoints = strongCommonPoints || (distanceMethod == "commonPoints");
+  const bool l2 = (distanceMethod == "L2");
+
+  std::size_t queryL1Norm = 0;
+  std::size_t querySquaredL2Norm = 0;
+  for(const auto& word : query)
+  {
+    queryL1Norm += word.second.size();
+    querySquaredL2Norm += word.second.size() * word.second.size();
+  }
+
+  // accumulate the sums over the common words, only for the documents of the query words inverted files
+  std::vector<std::size_t> accumulators(doc_norms_.size(), 0);
+  std::vector<uint32_t> scoredDocs;
+
+  for(const auto& word : query)
+  {
+    if(word.first < 0 || word.first >= static_cast<Word>(word_files_.size()))
+      continue;
+
+    const std::size_t queryCount = word.second.size();
+    if(strongCommonPoints && queryCount != 1)
+      continue;
+
+    for(const WordFrequency& frequency : word_files_[word.first])
+    {
+      std::size_t value;
+      if(strongCommonPoints)
+      {
+        if(frequency.count != 1)
+          continue;
+        value = 1;
+      }
+      else if(l2)
+        value = queryCount * frequency.count;
+      else
+        value = std::min(queryCount, static_cast<std::size_t>(frequency.count));
+
+      if(accumulators[frequency.index] == 0)
+        scoredDocs.push_back(frequency.index);
+      accumulators[frequency.index] += value;
+    }
+  }
+
+  const auto distance = [&](const DocumentNorms& norms, std::size_t accumulator) -> float
+  {
+    if(commonPoints)
+      return -static_cast<float>(accumulator);
+    if(l2)
+      return std::sqrt(static_cast<float>(querySquaredL2Norm + norms.squaredL2Norm - 2 * accumulator));
+    return static_cast<float>(queryL1Norm + norms.l1Norm - 2 * accumulator);
+  };
+
+  matches.reserve(scoredDocs.size() + N);
+  for(const uint32_t index : scoredDocs)
+    matches.emplace_back(doc_norms_[index].id, distance(doc_norms_[index], accumulators[index]));
+
+  // Complete with the best documents without common words (or without common words of count 1
+  // for strongCommonPoints), visited by increasing distance.
+  std::size_t nbOthers = 0;
+  float worstOtherScore = 0.0f;
+  std::size_t worstOtherNorm = 0;
+  const auto addOther = [&](std::size_t index, std::size_t norm) -> bool
+  {
+    if(accumulators[index] != 0)
+      return true;
+
+    const float score = distance(doc_norms_[index], 0);
+    // different norms may give the same score (L2), these documents are kept to be ordered by id
+    if(nbOthers >= N && (score > worstOtherScore || norm == worstOtherNorm))
+      return false;
+
+    matches.emplace_back(doc_norms_[index].id, score);
+    worstOtherScore = score;
+    worstOtherNorm = norm;
+    ++nbOthers;
+    return true;
+  };
+
+  if(commonPoints)
+  {
+    // all the other documents have a null distance, doc_indexes_ is ordered by id
+    for(const auto& doc : doc_indexes_)
+    {
+      if(!addOther(doc.second, 0))
+        break;
+    }
+  }
+  else
+  {
+    const std::set<std::pair<std::size_t, DocId>>& docsByNorm = l2 ? docs_by_squared_l2_norm_ : docs_by_l1_norm_;
+    for(const auto& doc : docsByNorm)
+    {
+      if(!addOther(doc_indexes_.at(doc.second), doc.first))
+        break;
+    }
+  }
+
+  const std::size_t nMatches = std::min(N, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end(), isBetterMatch);
+  matches.resize(nMatches);
+}
+
 /**
  * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
  * training examples into the database.
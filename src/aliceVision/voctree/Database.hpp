@@ -10,6 +10,7 @@
 #include <aliceVision/types.hpp>
 
 #include <map>
+#include <set>
 #include <cstddef>
 #include <string>
 
@@ -87,6 +88,11 @@ public:
   /**
    * @brief Find the top N matches in the database for the query document.
    *
+   * The classic (L1), L2, commonPoints and strongCommonPoints distances are computed with the inverted files:
+   * only the documents sharing words with the query are scored. The other distances compare the query
+   * with each document of the database.
+   * Documents with the same score are ordered by id.
+   *
    * @param[in] document The query document, a set of quantized words.
    * @param[in] N        The number of matches to return.
    * @param[in] distanceMethod distance method (norm L1, etc.)
@@ -104,6 +110,17 @@ public:
    */
   void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
 
+  /**
+   * @brief Find the top N matches in the database for the query document,
+   * computing the distance between the query and each document of the database.
+   *
+   * @param[in] query The query document, a normalized set of quantized words.
+   * @param[int] N        The number of matches to return.
+   * @param[in] distanceMethod distance method (norm L1, etc.)
+   * @param[out] matches  IDs and scores for the top N matching database documents.
+   */
+  void findExhaustive(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
+
   /**
    * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
    * training examples into the database.
@@ -136,17 +153,27 @@ private:
 
   struct WordFrequency
   {
-    DocId id;
+    /// index of the document in doc_norms_
+    uint32_t index;
     uint32_t count;
 
     WordFrequency() = default;
-    WordFrequency(DocId _id, uint32_t _count)
-      : id(_id)
+    WordFrequency(uint32_t _index, uint32_t _count)
+      : index(_index)
       , count(_count)
     {}
   };
 
-  // Stored in increasing order by DocId
+  struct DocumentNorms
+  {
+    DocId id;
+    /// number of features of the document (L1 norm of its histogram)
+    std::size_t l1Norm;
+    /// squared L2 norm of the histogram
+    std::size_t squaredL2Norm;
+  };
+
+  // Stored in increasing order of insertion
   typedef std::vector<WordFrequency> InvertedFile;
 
   /// @todo Use sorted vector?
@@ -158,6 +185,18 @@ private:
   std::vector<float> word_weights_;
   SparseHistogramPerImage database_; // Precomputed for inserted documents
 
+  std::vector<DocumentNorms> doc_norms_; // In increasing order of insertion
+  std::map<DocId, std::size_t> doc_indexes_; // Index of each document in doc_norms_
+  // Documents ordered by norm (then id): the distance of the documents without common words with the query only depends on their norm
+  std::set<std::pair<std::size_t, DocId>> docs_by_l1_norm_;
+  std::set<std::pair<std::size_t, DocId>> docs_by_squared_l2_norm_;
+
+  /**
+   * @brief Find the top N matches in the database for the query document using the inverted files.
+   * The distance must be classic (L1), L2, commonPoints or strongCommonPoints.
+   */
+  void findInvertedFile(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const;
+
   /**
    * Normalize a document vector representing the histogram of visual words for a given image
    * @param[in/out] v the unnormalized histogram of visual words
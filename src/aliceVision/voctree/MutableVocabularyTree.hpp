@@ -35,11 +35,26 @@ public:
     this->setNodeCounts();
   }
 
+  /**
+   * @brief Load vocabulary from a file.
+   * The centers are always read in memory, even from a mappable file, so that they can be modified.
+   */
+  void load(const std::string& file) override
+  {
+    this->loadFile(file, false);
+  }
+
   uint32_t nodes() const
   {
     return this->word_start_ + this->num_words_;
   }
 
+  /// Update the data used by the batched quantization, once the centers are modified.
+  void updateCentersLayout()
+  {
+    this->computeCentersLayout();
+  }
+
   std::vector<Feature, FeatureAllocator>& centers()
   {
     return this->centers_;
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <random>
 #include <vector>
 #include <limits>
 #include <stdio.h>
@@ -32,14 +33,14 @@ struct InitRandom
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, std::mt19937& randomNumberGenerator, const int verbose = 0)
   {
     ALICEVISION_LOG_DEBUG("#\t\tRandom initialization");
     // Construct a random permutation of the features using a Fisher-Yates shuffle
     std::vector<Feature*> features_perm = features;
     for(size_t i = features.size(); i > 1; --i)
     {
-      size_t k = rand() % i;
+      size_t k = std::uniform_int_distribution<size_t>(0, i - 1)(randomNumberGenerator);
       std::swap(features_perm[i - 1], features_perm[k]);
     }
     // Take the first k permuted features as the initial centers
@@ -60,7 +61,7 @@ struct InitKmeanspp
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, std::mt19937& randomNumberGenerator, const int verbose = 0)
   {
     typedef typename Distance::result_type squared_distance_type;
 
@@ -83,10 +84,9 @@ struct InitKmeanspp
     std::vector<squared_distance_type> distsTemp(features.size(), std::numeric_limits<squared_distance_type>::max());
     std::vector<squared_distance_type> distsTempBest(features.size(), std::numeric_limits<squared_distance_type>::max());
     typename std::vector<squared_distance_type>::iterator dstiter;
-    typename std::vector<Feature*>::const_iterator featiter;
 
     // 1. Choose a random center
-    size_t randCenter = rand() % features.size();
+    size_t randCenter = std::uniform_int_distribution<size_t>(0, features.size() - 1)(randomNumberGenerator);
 
     // add it to the centers
     centers[0] = *features[ randCenter ];
@@ -94,12 +94,15 @@ struct InitKmeanspp
     if(verbose > 2) ALICEVISION_LOG_DEBUG("First center picked randomly " << randCenter << ": " << centers[0]);
 
     // compute the distances
-    for(dstiter = dists.begin(), featiter = features.begin(); dstiter != dists.end(); ++dstiter, ++featiter)
+    #pragma omp parallel for reduction(+:currSum)
+    for(ptrdiff_t it = 0; it < static_cast<ptrdiff_t>(features.size()); ++it)
     {
-      *dstiter = distance(*(*featiter), centers[0]);
-      currSum += *dstiter;
+      dists[it] = distance(*(features[it]), centers[0]);
+      currSum += dists[it];
     }
 
+    std::uniform_real_distribution<float> percDistribution(0.f, 1.f);
+
     // iterate k-1 times
     for(int i = 1; i < k; ++i)
     {
@@ -118,33 +121,22 @@ struct InitKmeanspp
         // 0 and this sum, then start compute the sum from the first element again
         // until the partial sum is greater than the number drawn: the
         // the previous element is what we are looking for
-        const float perc = (float)rand() / RAND_MAX;
+        const float perc = percDistribution(randomNumberGenerator);
         squared_distance_type partial = (squared_distance_type)(currSum * perc);
         // look for the element that cap the partial sum that has been
-        // drawn
-        dstiter = dists.begin();
-        while((partial > 0) && (dstiter != dists.end()))
+        // drawn (the elements with a null distance, already chosen, are never selected)
+        std::size_t featidx = features.size() - 1;
+        for(dstiter = dists.begin(); dstiter != dists.end(); ++dstiter)
         {
-          assert(dstiter != dists.end());
           // safeguard against unsigned types that do not allow negative numbers
-          if(partial > *dstiter)
-          {
-            partial -= *dstiter;
-          }
-          else
+          if(partial < *dstiter)
           {
-            partial = 0;
+            featidx = dstiter - dists.begin();
+            break;
           }
-          ++dstiter;
+          partial -= *dstiter;
         }
 
-        // get the index
-        std::size_t featidx;
-        if(dstiter == dists.end())
-          featidx = features.size() - 1;
-        else
-          featidx = dstiter - dists.begin();
-
         // 2. compute the distance of each feature from the current center
         squared_distance_type distSum = 0;
 
@@ -186,7 +178,7 @@ struct InitGiven
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, std::size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, std::size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, std::mt19937& randomNumberGenerator, const int verbose = 0)
   {
     // Do nothing!
   }
@@ -256,7 +248,11 @@ bool checkVectorElements(const std::vector<Feature, FeatureAllocator> &f, const
 /**
  * @brief Class for performing K-means clustering, optimized for a particular feature type and metric.
  *
- * The standard Lloyd's algorithm is used. By default, cluster centers are initialized randomly.
+ * The standard Lloyd's algorithm is used. By default, cluster centers are initialized with K-means++.
+ * Optionally, the sets of features larger than a given size are clustered with the mini-batch K-means:
+ *
+ *  Sculley, D. (2010). "Web-scale k-means clustering" Proceedings of the 19th
+ *  international conference on World Wide Web. pp. 1177–1178.
  */
 template<class Feature,
          class Distance = L2<Feature, Feature>,
@@ -265,7 +261,7 @@ class SimpleKmeans
 {
 public:
   typedef typename Distance::result_type squared_distance_type;
-  typedef boost::function<void(const std::vector<Feature*>&, std::size_t, std::vector<Feature, FeatureAllocator>&, Distance, const int verbose) > Initializer;
+  typedef boost::function<void(const std::vector<Feature*>&, std::size_t, std::vector<Feature, FeatureAllocator>&, Distance, std::mt19937&, const int verbose) > Initializer;
 
   /**
    * @brief Constructor
@@ -304,6 +300,23 @@ public:
     restarts_ = restarts;
   }
 
+  std::size_t getMiniBatchSize() const
+  {
+    return mini_batch_size_;
+  }
+
+  /**
+   * @brief Set the number of features drawn at each iteration of the mini-batch K-means.
+   *
+   * The sets of more than \p size features are clustered with getMaxIterations() mini-batches,
+   * and the initial centers are chosen among \p size random features.
+   * 0 (default) always uses Lloyd's algorithm on all the features.
+   */
+  void setMiniBatchSize(std::size_t size)
+  {
+    mini_batch_size_ = size;
+  }
+
   int getVerbose() const
   {
     return verbose_;
@@ -321,10 +334,12 @@ public:
    * @param      k          The number of clusters.
    * @param[out] centers    A set of k cluster centers.
    * @param[out] membership Cluster assignment for each feature
+   * @param[in,out] randomNumberGenerator The random generator used to choose the centers and the mini-batches
    */
   squared_distance_type cluster(const std::vector<Feature, FeatureAllocator>& features, std::size_t k,
                                 std::vector<Feature, FeatureAllocator>& centers,
-                                std::vector<unsigned int>& membership) const;
+                                std::vector<unsigned int>& membership,
+                                std::mt19937& randomNumberGenerator) const;
 
   /**
    * @brief Partition a set of features into k clusters.
@@ -336,16 +351,37 @@ public:
    * @param      k          The number of clusters.
    * @param[out] centers    A set of k cluster centers.
    * @param[out] membership Cluster assignment for each feature
+   * @param[in,out] randomNumberGenerator The random generator used to choose the centers and the mini-batches,
+   *                                      the clustering of several feature sets can run concurrently with their own generator
    */
   squared_distance_type clusterPointers(const std::vector<Feature*>& features, std::size_t k,
                                         std::vector<Feature, FeatureAllocator>& centers,
-                                        std::vector<unsigned int>& membership) const;
+                                        std::vector<unsigned int>& membership,
+                                        std::mt19937& randomNumberGenerator) const;
 
 private:
 
+  bool useMiniBatch(std::size_t nbFeatures) const
+  {
+    return mini_batch_size_ > 0 && nbFeatures > mini_batch_size_;
+  }
+
+  unsigned int findNearestCenter(const Feature& feature, std::size_t k,
+                                 const std::vector<Feature, FeatureAllocator>& centers) const;
+
+  squared_distance_type computeSse(const std::vector<Feature*>& features,
+                                   const std::vector<Feature, FeatureAllocator>& centers,
+                                   const std::vector<unsigned int>& membership) const;
+
   squared_distance_type clusterOnce(const std::vector<Feature*>& features, std::size_t k,
                                     std::vector<Feature, FeatureAllocator>& centers,
-                                    std::vector<unsigned int>& membership) const;
+                                    std::vector<unsigned int>& membership,
+                                    std::mt19937& randomNumberGenerator) const;
+
+  squared_distance_type clusterMiniBatch(const std::vector<Feature*>& features, std::size_t k,
+                                         std::vector<Feature, FeatureAllocator>& centers,
+                                         std::vector<unsigned int>& membership,
+                                         std::mt19937& randomNumberGenerator) const;
 
   Feature zero_;
   Distance distance_;
@@ -353,6 +389,7 @@ private:
   std::size_t max_iterations_;
   std::size_t restarts_;
   int verbose_;
+  std::size_t mini_batch_size_;
 };
 
 template < class Feature, class Distance, class FeatureAllocator >
@@ -363,7 +400,8 @@ distance_(d),
 choose_centers_(InitKmeanspp()),
 max_iterations_(100),
 verbose_(verbose),
-restarts_(1)
+restarts_(1),
+mini_batch_size_(0)
 {
 }
 
@@ -371,32 +409,49 @@ template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::cluster(const std::vector<Feature, FeatureAllocator>& features, size_t k,
                                                            std::vector<Feature, FeatureAllocator>& centers,
-                                                           std::vector<unsigned int>& membership) const
+                                                           std::vector<unsigned int>& membership,
+                                                           std::mt19937& randomNumberGenerator) const
 {
   std::vector<Feature*> feature_ptrs;
   feature_ptrs.reserve(features.size());
   BOOST_FOREACH(const Feature& f, features)
   feature_ptrs.push_back(const_cast<Feature*> (&f));
-  return clusterPointers(feature_ptrs, k, centers, membership);
+  return clusterPointers(feature_ptrs, k, centers, membership, randomNumberGenerator);
 }
 
 template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::vector<Feature*>& features, size_t k,
                                                                    std::vector<Feature, FeatureAllocator>& centers,
-                                                                   std::vector<unsigned int>& membership) const
+                                                                   std::vector<unsigned int>& membership,
+                                                                   std::mt19937& randomNumberGenerator) const
 {
   std::vector<Feature, FeatureAllocator> new_centers(centers);
   new_centers.resize(k);
   std::vector<unsigned int> new_membership(features.size());
 
+  // with the mini-batch K-means, the initial centers are chosen among a random sample of the features
+  std::vector<Feature*> seeding_features;
+  if(useMiniBatch(features.size()))
+    seeding_features.resize(mini_batch_size_);
+
   squared_distance_type least_sse = std::numeric_limits<squared_distance_type>::max();
   assert(restarts_ > 0);
   for(std::size_t starts = 0; starts < restarts_; ++starts)
   {
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Trial " << starts + 1 << "/" << restarts_);
-    choose_centers_(features, k, new_centers, distance_, verbose_);
-    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership);
+    if(seeding_features.empty())
+    {
+      choose_centers_(features, k, new_centers, distance_, randomNumberGenerator, verbose_);
+    }
+    else
+    {
+      std::uniform_int_distribution<std::size_t> featureDistribution(0, features.size() - 1);
+      for(Feature*& feature : seeding_features)
+        feature = features[featureDistribution(randomNumberGenerator)];
+      choose_centers_(seeding_features, k, new_centers, distance_, randomNumberGenerator, verbose_);
+    }
+    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership, randomNumberGenerator);
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("End of Trial " << starts + 1 << "/" << restarts_);
     if(sse < least_sse)
     {
@@ -411,14 +466,53 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::ve
   return least_sse;
 }
 
+template < class Feature, class Distance, class FeatureAllocator >
+unsigned int SimpleKmeans<Feature, Distance, FeatureAllocator>::findNearestCenter(const Feature& feature, std::size_t k,
+                                                                                  const std::vector<Feature, FeatureAllocator>& centers) const
+{
+  squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+  unsigned int nearest = 0;
+
+  // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
+  // cluster center
+  for(unsigned int j = 0; j < k; ++j)
+  {
+    squared_distance_type distance = distance_(feature, centers[j]);
+    if(distance < d_min)
+    {
+      d_min = distance;
+      nearest = j;
+    }
+  }
+  return nearest;
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::computeSse(const std::vector<Feature*>& features,
+                                                              const std::vector<Feature, FeatureAllocator>& centers,
+                                                              const std::vector<unsigned int>& membership) const
+{
+  /// @todo Kahan summation?
+  squared_distance_type sse = squared_distance_type(0);
+  assert(features.size() > 0);
+  #pragma omp parallel for reduction(+:sse)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+  {
+    sse += distance_(*features[i], centers[membership[i]]);
+  }
+  return sse;
+}
+
 template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector<Feature*>& features, std::size_t k,
                                                                std::vector<Feature, FeatureAllocator>& centers,
-                                                               std::vector<unsigned int>& membership) const
+                                                               std::vector<unsigned int>& membership,
+                                                               std::mt19937& randomNumberGenerator) const
 {
-  typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
-  typedef typename Distance::value_type feature_value_type;
+  if(useMiniBatch(features.size()))
+    return clusterMiniBatch(features, k, centers, membership, randomNumberGenerator);
 
   std::vector<std::size_t> new_center_counts(k);
   std::vector<Feature, FeatureAllocator> new_centers(k);
@@ -438,49 +532,39 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
 
 
     // Assign data objects to current centers
-    #pragma omp parallel for shared( new_centers, new_center_counts, features, centers, membership)
-    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+    // Each thread accumulates its own cluster centers and membership counts, merged at the end
+    #pragma omp parallel
     {
-      squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
-      unsigned int nearest = 0;
-      bool found = false;
-
-      // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
-      // cluster center
+      std::vector<Feature, FeatureAllocator> thread_centers(k, zero_);
+      std::vector<std::size_t> thread_center_counts(k, 0);
+      bool thread_is_stable = true;
 
-      // Find the nearest cluster center to feature i
-      for(unsigned int j = 0; j < k; ++j)
+      #pragma omp for
+      for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
       {
-        squared_distance_type distance = distance_(*features[i], centers[j]);
-        //		printf("\t\tdistance %f\n", (float)distance);
-        //		PrintFeat(*features[i] );
-        if(distance < d_min)
+        // Find the nearest cluster center to feature i
+        const unsigned int nearest = findNearestCenter(*features[i], k, centers);
+        // Assign feature i to the cluster it is nearest to
+        if(membership[i] != nearest)
         {
-          d_min = distance;
-          nearest = j;
-          found = true;
+          thread_is_stable = false;
+          membership[i] = nearest;
         }
-        //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
+        // Accumulate the cluster center and its membership count
+        thread_centers[nearest] += *features[i];
+        ++thread_center_counts[nearest];
       }
-      assert(found);
-      // Assign feature i to the cluster it is nearest to
-      if(membership[i] != nearest)
-      {
-        is_stable = false;
-        membership[i] = nearest;
-      }
-      // Accumulate the cluster center and its membership count
-      //	  printf("\t nearest %d\n", nearest);
-      //			checkElements(*features[i], "feat");
+
       #pragma omp critical
       {
-        new_centers[nearest] += *features[i];
-        //			checkElements(new_centers[nearest], "sum");
-        //	  printf("\t new_centers[nearest] += *features[i];\n");
-        ++new_center_counts[nearest];
-        //	  printf("\taccumulate\n");
+        for(std::size_t j = 0; j < k; ++j)
+        {
+          new_centers[j] += thread_centers[j];
+          new_center_counts[j] += thread_center_counts[j];
+        }
+        is_stable = is_stable && thread_is_stable;
       }
-    }//for
+    }
 
     if(is_stable) break;
 
@@ -509,7 +593,7 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
       {
         // Choose a new center randomly from the input features
         // @todo use a better strategy like taking splitting the largest cluster
-        unsigned int index = rand() % features.size();
+        unsigned int index = std::uniform_int_distribution<unsigned int>(0, features.size() - 1)(randomNumberGenerator);
         centers[i] = *features[index];
         ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
       }
@@ -520,14 +604,68 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector
   if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
 
   // Return the sum squared error
-  /// @todo Kahan summation?
-  squared_distance_type sse = squared_distance_type(0);
-  assert(features.size() > 0);
-  for(std::size_t i = 0; i < features.size(); ++i)
+  return computeSse(features, centers, membership);
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
+SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterMiniBatch(const std::vector<Feature*>& features, std::size_t k,
+                                                                    std::vector<Feature, FeatureAllocator>& centers,
+                                                                    std::vector<unsigned int>& membership,
+                                                                    std::mt19937& randomNumberGenerator) const
+{
+  typedef typename Distance::value_type feature_value_type;
+
+  std::vector<std::size_t> center_counts(k, 0);
+  std::vector<std::size_t> batch(mini_batch_size_);
+  std::vector<unsigned int> batch_membership(mini_batch_size_);
+  std::vector<Feature, FeatureAllocator> previous_centers(k);
+  std::uniform_int_distribution<std::size_t> featureDistribution(0, features.size() - 1);
+
+  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Mini-batch iterations");
+  for(std::size_t iter = 0; iter < max_iterations_; ++iter)
   {
-    sse += distance_(*features[i], centers[membership[i]]);
+    if(verbose_ > 0) ALICEVISION_LOG_DEBUG("*");
+    // Draw the mini-batch
+    for(std::size_t& index : batch)
+      index = featureDistribution(randomNumberGenerator);
+
+    // Assign the features of the mini-batch to the current centers
+    #pragma omp parallel for
+    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(batch.size()); ++j)
+    {
+      batch_membership[j] = findNearestCenter(*features[batch[j]], k, centers);
+    }
+
+    // Move each center towards its features, with a learning rate that decreases
+    // with the number of features assigned to the center so far
+    std::copy(centers.begin(), centers.begin() + k, previous_centers.begin());
+    for(std::size_t j = 0; j < batch.size(); ++j)
+    {
+      const unsigned int nearest = batch_membership[j];
+      const double eta = 1.0 / ++center_counts[nearest];
+      Feature step = *features[batch[j]];
+      step *= static_cast<feature_value_type>(eta);
+      centers[nearest] *= static_cast<feature_value_type>(1.0 - eta);
+      centers[nearest] += step;
+    }
+
+    squared_distance_type max_center_shift = 0;
+    for(std::size_t i = 0; i < k; ++i)
+      max_center_shift = std::max(max_center_shift, distance_(centers[i], previous_centers[i]));
+    if(max_center_shift <= 10e-10) break;
   }
-  return sse;
+  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
+
+  // Assign all the features to the final centers
+  #pragma omp parallel for
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+  {
+    membership[i] = findNearestCenter(*features[i], k, centers);
+  }
+
+  // Return the sum squared error
+  return computeSse(features, centers, membership);
 }
 
 }
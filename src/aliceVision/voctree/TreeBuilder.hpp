@@ -8,7 +8,11 @@
 
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
-#include <deque>
+
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <random>
+#include <vector>
 //#include <cstdio> //DEBUG
 
 namespace aliceVision {
@@ -41,6 +45,8 @@ public:
    * @brief Build a new vocabulary tree.
    *
    * The number of words in the resulting vocabulary is at most k ^ levels.
+   * The subtrees of a level are clustered in parallel, each with its own random generator
+   * seeded from the random seed and the index of its node, so the random draws do not depend on the scheduling of the subsets.
    *
    * @param training_features The set of training features to cluster.
    * @param k                 The branching factor, or max children of any node.
@@ -79,12 +85,24 @@ public:
     return verbose_;
   }
 
+  /// Set the seed of the random generators used to cluster the subtrees.
+  void setRandomSeed(std::uint32_t seed)
+  {
+    randomSeed_ = seed;
+  }
+
+  std::uint32_t getRandomSeed() const
+  {
+    return randomSeed_;
+  }
+
 protected:
   Tree tree_;
   Kmeans kmeans_;
   Feature zero_;
 private:
   unsigned char verbose_;
+  std::uint32_t randomSeed_ = std::mt19937::default_seed;
 };
 
 template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
@@ -105,34 +123,62 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
   tree_.centers().reserve(tree_.nodes());
   tree_.validCenters().reserve(tree_.nodes());
 
-  // We keep a queue of disjoint feature subsets to cluster.
+  // We keep the disjoint feature subsets to cluster at the current level, in the order of their nodes.
   // Feature* is used to avoid copying features.
-  std::deque< std::vector<Feature*> > subset_queue(1);
+  std::vector< std::vector<Feature*> > subsets(1);
 
   {
-    // At first the queue contains one "subset" containing all the features.
-    std::vector<Feature*> &feature_ptrs = subset_queue.front();
+    // At first there is one "subset" containing all the features.
+    std::vector<Feature*> &feature_ptrs = subsets.front();
     feature_ptrs.reserve(training_features.size());
     for(const Feature& f: training_features)
     {
       feature_ptrs.push_back(const_cast<Feature*> (&f));
     }
   }
-  FeatureVector centers; // always size k
+  // index of the node of the first subset of the current level, the root is the node 0
+  std::uint32_t firstNodeIndex = 0;
   for(uint32_t level = 0; level < levels; ++level)
   {
     if(verbose_) printf("# Level %u\n", level);
-    std::vector<unsigned int> membership;
+    const std::size_t nbSubsets = subsets.size();
+    std::vector<FeatureVector> subsetsCenters(nbSubsets);
+    std::vector< std::vector<unsigned int> > subsetsMembership(nbSubsets);
+
+    // The subtrees are independent: when there are enough subsets to keep all the threads busy,
+    // they are clustered in parallel, otherwise one by one with the parallel loops of the k-means.
+    const bool parallelSubsets = nbSubsets >= static_cast<std::size_t>(omp_get_max_threads());
 
-    for(std::size_t i = 0, ie = subset_queue.size(); i < ie; ++i)
+    #pragma omp parallel for schedule(dynamic) if(parallelSubsets)
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(nbSubsets); ++i)
     {
-      std::vector<Feature*> &subset = subset_queue.front();
-      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+      const std::vector<Feature*> &subset = subsets[i];
+      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", static_cast<std::size_t>(i + 1), nbSubsets, subset.size());
 
       // If the subset already has k or fewer elements, just use those as the centers.
       if(subset.size() <= k)
       {
         if(verbose_ > 2) printf("#\tno need to cluster %lu elements\n", subset.size());
+        continue;
+      }
+
+      // Cluster the current subset into k centers.
+      // The random generator only depends on the node, not on the thread clustering it.
+      if(verbose_ > 2) printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
+      std::seed_seq seedSequence{randomSeed_, firstNodeIndex + static_cast<std::uint32_t>(i)};
+      std::mt19937 randomNumberGenerator(seedSequence);
+      kmeans_.clusterPointers(subset, k, subsetsCenters[i], subsetsMembership[i], randomNumberGenerator);
+    }
+
+    // Add the centers of each subset to the tree and split it, in the order of the nodes
+    std::vector< std::vector<Feature*> > newSubsets;
+    newSubsets.reserve(nbSubsets * k);
+    for(std::size_t i = 0; i < nbSubsets; ++i)
+    {
+      std::vector<Feature*> &subset = subsets[i];
+
+      if(subset.size() <= k)
+      {
         for(std::size_t j = 0; j < subset.size(); ++j)
         {
           tree_.centers().push_back(*subset[j]);
@@ -142,34 +188,36 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
         tree_.centers().insert(tree_.centers().end(), k - subset.size(), zero_);
         tree_.validCenters().insert(tree_.validCenters().end(), k - subset.size(), 0);
 
-        // Push k empty subsets into the queue so all children get marked invalid.
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), k, std::vector<Feature*>());
+        // Push k empty subsets so all children get marked invalid.
+        newSubsets.insert(newSubsets.end(), k, std::vector<Feature*>());
       }
       else
       {
-        // Cluster the current subset into k centers.
-        if(verbose_ > 2) printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
-        kmeans_.clusterPointers(subset, k, centers, membership);
+        const FeatureVector &centers = subsetsCenters[i];
+        const std::vector<unsigned int> &membership = subsetsMembership[i];
         // Add the centers and mark them as valid.
         tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
         tree_.validCenters().insert(tree_.validCenters().end(), k, 1);
         // Partition the current subset into k new subsets based on the cluster assignments.
-        std::vector< std::vector<Feature*> > new_subsets(k);
+        const std::size_t firstNewSubset = newSubsets.size();
+        newSubsets.resize(firstNewSubset + k);
         assert(membership.size() >= subset.size());
         for(std::size_t j = 0; j < subset.size(); ++j)
         {
           assert(membership[j] < k);
-          assert(membership[j] < new_subsets.size());
-          new_subsets[ membership[j] ].push_back(subset[j]);
+          newSubsets[firstNewSubset + membership[j]].push_back(subset[j]);
         }
-        // Update the queue
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), new_subsets.begin(), new_subsets.end());
       }
+      // Release the memory of the subset as soon as possible
+      std::vector<Feature*>().swap(subset);
+      FeatureVector().swap(subsetsCenters[i]);
+      std::vector<unsigned int>().swap(subsetsMembership[i]);
     }
+    subsets.swap(newSubsets);
+    firstNodeIndex += static_cast<std::uint32_t>(nbSubsets);
     if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
   }
+  tree_.updateCentersLayout();
 }
 
 }
@@ -6,11 +6,151 @@
 
 #include "VocabularyTree.hpp"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace aliceVision {
 namespace voctree {
 
+namespace {
+
+/// Magic string at the beginning of a mappable vocabulary tree file
+const char mappableTreeMagic[8] = {'A', 'V', 'V', 'T', 'R', 'E', 'E', '\0'};
+
+/// Current version of the mappable vocabulary tree file format
+const std::uint32_t mappableTreeVersion = 1;
+
+/// Alignment of the centers in a mappable vocabulary tree file (page size of the supported platforms)
+const std::uint64_t mappableTreeAlignment = 4096;
+
+static_assert(sizeof(MappableTreeHeader) == 48, "Unexpected mappable vocabulary tree header size.");
+
+} // namespace
+
+std::string EVocabularyTreeFileFormat_enumToString(EVocabularyTreeFileFormat format)
+{
+  switch(format)
+  {
+    case EVocabularyTreeFileFormat::LEGACY:   return "legacy";
+    case EVocabularyTreeFileFormat::MAPPABLE: return "mappable";
+  }
+  throw std::out_of_range("Invalid EVocabularyTreeFileFormat enum: " + std::to_string(int(format)));
+}
+
+EVocabularyTreeFileFormat EVocabularyTreeFileFormat_stringToEnum(const std::string& format)
+{
+  std::string value = format;
+  std::transform(value.begin(), value.end(), value.begin(), ::tolower); // tolower
+
+  if(value == "legacy")   return EVocabularyTreeFileFormat::LEGACY;
+  if(value == "mappable") return EVocabularyTreeFileFormat::MAPPABLE;
+
+  throw std::out_of_range("Invalid vocabulary tree file format: " + format);
+}
+
+std::ostream& operator<<(std::ostream& os, EVocabularyTreeFileFormat format)
+{
+  return os << EVocabularyTreeFileFormat_enumToString(format);
+}
+
+std::istream& operator>>(std::istream& in, EVocabularyTreeFileFormat& format)
+{
+  std::string token;
+  in >> token;
+  format = EVocabularyTreeFileFormat_stringToEnum(token);
+  return in;
+}
+
+bool isMappableTreeFile(const std::string& file)
+{
+  std::ifstream fileIn(file, std::ios::in | std::ios::binary);
+
+  if(!fileIn.is_open())
+    return false;
+
+  char magic[sizeof(mappableTreeMagic)];
+  fileIn.read(magic, sizeof(magic));
+
+  return fileIn.gcount() == sizeof(magic) &&
+         std::memcmp(magic, mappableTreeMagic, sizeof(magic)) == 0;
+}
+
+std::shared_ptr<const char> mapTreeFile(const std::string& file, MappableTreeHeader& header)
+{
+  namespace bip = boost::interprocess;
+
+  std::shared_ptr<bip::mapped_region> region;
+  try
+  {
+    const bip::file_mapping mapping(file.c_str(), bip::read_only);
+    region = std::make_shared<bip::mapped_region>(mapping, bip::read_only);
+  }
+  catch(const bip::interprocess_exception& e)
+  {
+    throw std::runtime_error("Failed to load vocabulary tree file " + file + " (" + e.what() + ")");
+  }
+
+  const char* data = static_cast<const char*>(region->get_address());
+  const std::uint64_t fileSize = region->get_size();
+
+  if(fileSize < sizeof(MappableTreeHeader))
+    throw std::runtime_error("Failed to load vocabulary tree file " + file + ", the file is incorrect");
+
+  std::memcpy(&header, data, sizeof(header));
+
+  if(std::memcmp(header.magic, mappableTreeMagic, sizeof(mappableTreeMagic)) != 0)
+    throw std::runtime_error("Failed to load vocabulary tree file " + file + ", the file is not in the mappable format");
+
+  if(header.version > mappableTreeVersion)
+    throw std::runtime_error("Failed to load vocabulary tree file " + file + ", unsupported version (" + std::to_string(header.version) + ")");
+
+  if(header.featureSize == 0 ||
+     header.centersOffset < sizeof(MappableTreeHeader) ||
+     header.centersOffset > fileSize ||
+     header.nbCenters > (fileSize - header.centersOffset) / header.featureSize ||
+     header.validCentersOffset < header.centersOffset + header.nbCenters * header.featureSize ||
+     header.validCentersOffset > fileSize ||
+     header.nbCenters > fileSize - header.validCentersOffset)
+    throw std::runtime_error("Failed to load vocabulary tree file " + file + ", the file is incorrect");
+
+  // the returned pointer shares the ownership of the mapped region
+  return std::shared_ptr<const char>(region, data);
+}
+
+void writeMappableTreeFile(const std::string& file, std::uint32_t splits, std::uint32_t levels,
+                           const void* centers, std::size_t featureSize, std::size_t nbCenters,
+                           const std::uint8_t* validCenters)
+{
+  std::ofstream out(file, std::ios::out | std::ios::binary);
+
+  if(!out.is_open())
+    throw std::runtime_error("Failed to save vocabulary tree file " + file);
+
+  MappableTreeHeader header;
+  std::memcpy(header.magic, mappableTreeMagic, sizeof(mappableTreeMagic));
+  header.version = mappableTreeVersion;
+  header.splits = splits;
+  header.levels = levels;
+  header.featureSize = static_cast<std::uint32_t>(featureSize);
+  header.nbCenters = nbCenters;
+  header.centersOffset = mappableTreeAlignment;
+  header.validCentersOffset = header.centersOffset + nbCenters * featureSize;
+
+  const std::vector<char> padding(header.centersOffset - sizeof(header), 0);
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(padding.data(), padding.size());
+  out.write(static_cast<const char*>(centers), nbCenters * featureSize);
+  out.write(reinterpret_cast<const char*>(validCenters), nbCenters);
+
+  if(!out.good())
+    throw std::runtime_error("Failed to save vocabulary tree file " + file);
+}
+
 float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const std::string &distanceMethod, const std::vector<float>& word_weights)
 {
 
@@ -38,8 +178,10 @@ float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const
       }
       else
       {
-        const auto val = std::minmax(i1->second.size(), i2->second.size());
-        distance += static_cast<float>(val.second - val.first);
+        // std::minmax would return references to the temporary sizes
+        const std::size_t size1 = i1->second.size();
+        const std::size_t size2 = i2->second.size();
+        distance += static_cast<float>(std::max(size1, size2) - std::min(size1, size2));
         ++i1;
         ++i2;
       }
@@ -58,6 +200,49 @@ float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const
     }
   }
   
+  else if(distanceMethod == "L2")
+  {
+    // integer accumulation, to get exactly the same result as the inverted files
+    std::size_t squaredDistance{0};
+
+    while(i1 != i1e && i2 != i2e)
+    {
+      if(i2->first < i1->first)
+      {
+        squaredDistance += i2->second.size() * i2->second.size();
+        ++i2;
+      }
+      else if(i1->first < i2->first)
+      {
+        squaredDistance += i1->second.size() * i1->second.size();
+        ++i1;
+      }
+      else
+      {
+        const std::size_t size1 = i1->second.size();
+        const std::size_t size2 = i2->second.size();
+        const std::size_t difference = std::max(size1, size2) - std::min(size1, size2);
+        squaredDistance += difference * difference;
+        ++i1;
+        ++i2;
+      }
+    }
+
+    while(i1 != i1e)
+    {
+      squaredDistance += i1->second.size() * i1->second.size();
+      ++i1;
+    }
+
+    while(i2 != i2e)
+    {
+      squaredDistance += i2->second.size() * i2->second.size();
+      ++i2;
+    }
+
+    distance = std::sqrt(static_cast<float>(squaredDistance));
+  }
+  
   else if(distanceMethod == "commonPoints")
   {
     float score{0.f};
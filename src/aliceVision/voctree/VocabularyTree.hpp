@@ -10,6 +10,7 @@
 #include "distance.hpp"
 #include "DefaultAllocator.hpp"
 
+#include <aliceVision/feature/distanceKernels.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/regionsFactory.hpp>
 
@@ -17,10 +18,15 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <stdint.h>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <cassert>
 #include <limits>
+#include <numeric>
+#include <type_traits>
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
@@ -57,13 +63,80 @@ inline void computeSparseHistogram(const std::vector<Word>& document, SparseHist
   }
 }
 
+/**
+ * @brief Vocabulary tree file formats.
+ *
+ * The legacy format stores the centers right after a small header, they are read in memory.
+ * The mappable format stores them at a page-aligned offset, so that the file is memory-mapped read-only
+ * and its pages are shared between all the processes using the same vocabulary tree.
+ * The legacy format is written by default, the previous versions cannot read the mappable format.
+ */
+enum class EVocabularyTreeFileFormat : unsigned char
+{
+  LEGACY = 0,
+  MAPPABLE
+};
+
+std::string EVocabularyTreeFileFormat_enumToString(EVocabularyTreeFileFormat format);
+EVocabularyTreeFileFormat EVocabularyTreeFileFormat_stringToEnum(const std::string& format);
+
+std::ostream& operator<<(std::ostream& os, EVocabularyTreeFileFormat format);
+std::istream& operator>>(std::istream& in, EVocabularyTreeFileFormat& format);
+
+/**
+ * @brief Header of a mappable vocabulary tree file.
+ * It is followed by nbCenters centers of featureSize bytes at centersOffset (a multiple of the page size)
+ * and by one valid flag byte per center at validCentersOffset.
+ * Values are stored in the host byte order (little-endian on all supported platforms).
+ */
+struct MappableTreeHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t splits;
+  std::uint32_t levels;
+  std::uint32_t featureSize;
+  std::uint64_t nbCenters;
+  std::uint64_t centersOffset;
+  std::uint64_t validCentersOffset;
+};
+
+/**
+ * @brief Check if the given vocabulary tree file uses the mappable format.
+ * @param[in] file vocabulary tree file path
+ * @return true if the file starts with the mappable format header
+ */
+bool isMappableTreeFile(const std::string& file);
+
+/**
+ * @brief Memory-map a mappable vocabulary tree file read-only.
+ * @param[in] file vocabulary tree file path
+ * @param[out] header the checked header of the file
+ * @return the address of the file, which stays mapped as long as a copy of the pointer exists
+ */
+std::shared_ptr<const char> mapTreeFile(const std::string& file, MappableTreeHeader& header);
+
+/**
+ * @brief Write a mappable vocabulary tree file.
+ * @param[in] file vocabulary tree file path
+ * @param[in] splits branching factor of the tree
+ * @param[in] levels number of levels of the tree
+ * @param[in] centers raw data of the centers
+ * @param[in] featureSize size in bytes of a center
+ * @param[in] nbCenters number of centers
+ * @param[in] validCenters valid flag of each center
+ */
+void writeMappableTreeFile(const std::string& file, std::uint32_t splits, std::uint32_t levels,
+                           const void* centers, std::size_t featureSize, std::size_t nbCenters,
+                           const std::uint8_t* validCenters);
+
 class IVocabularyTree
 {
 public:
   virtual ~IVocabularyTree() = 0;
 
   /// Save vocabulary to a file.
-  virtual void save(const std::string& file) const = 0;
+  virtual void save(const std::string& file, EVocabularyTreeFileFormat format = EVocabularyTreeFileFormat::LEGACY) const = 0;
   /// Load vocabulary from a file.
   virtual void load(const std::string& file) = 0;
 
@@ -88,6 +161,20 @@ public:
 
 inline IVocabularyTree::~IVocabularyTree() {}
 
+/// Whether every value of type T is exactly represented by a float.
+template<typename T>
+struct IsExactFloat
+{
+  static const bool value = std::is_same<T, float>::value || (std::is_integral<T>::value && sizeof(T) <= 2);
+};
+
+/// Whether the Distance metric is the squared L2 distance.
+template<template<typename, typename> class Distance>
+struct IsL2Distance : std::false_type {};
+
+template<>
+struct IsL2Distance<L2> : std::true_type {};
+
 /**
  * @brief Optimized vocabulary tree quantizer, templated on feature type and distance metric
  * for maximum efficiency.
@@ -121,6 +208,20 @@ public:
   template<class DescriptorT>
   std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
+  /**
+   * @brief Quantizes an array of features into visual words.
+   *
+   * With the L2 distance, the features are pushed down the tree by blocks, node by node,
+   * using the SIMD float distance kernels on a contiguous copy of the centers.
+   * The words are the same as the ones of quantize(feature).
+   *
+   * @param[in] features pointer to the first feature
+   * @param[in] count number of features
+   * @return the visual word of each feature
+   */
+  template<class DescriptorT>
+  std::vector<Word> quantize(const DescriptorT* features, std::size_t count) const;
+
   /// Quantizes a set of features into sparse histogram of visual words.
   template<class DescriptorT>
   SparseHistogram quantizeToSparse(const std::vector<DescriptorT>& features) const;
@@ -142,14 +243,24 @@ public:
   void clear() override;
 
   /// Save vocabulary to a file.
-  void save(const std::string& file) const override;
-  /// Load vocabulary from a file.
+  void save(const std::string& file, EVocabularyTreeFileFormat format = EVocabularyTreeFileFormat::LEGACY) const override;
+  /**
+   * @brief Load vocabulary from a file.
+   * A file in the mappable format is memory-mapped instead of being read.
+   */
   void load(const std::string& file) override;
 
+  /// Whether the centers are memory-mapped from the vocabulary file.
+  bool isMapped() const
+  {
+    return mapped_file_ != nullptr;
+  }
+
   bool operator==(const VocabularyTree& other) const
   {
-    return (centers_ == other.centers_) &&
-        (valid_centers_ == other.valid_centers_) &&
+    return (nbCenters() == other.nbCenters()) &&
+        std::equal(centersData(), centersData() + nbCenters(), other.centersData()) &&
+        std::equal(validCentersData(), validCentersData() + nbCenters(), other.validCentersData()) &&
         (k_ == other.k_) &&
         (levels_ == other.levels_) &&
         (num_words_ == other.num_words_) &&
@@ -165,23 +276,72 @@ protected:
   uint32_t num_words_; // number of leaf nodes
   uint32_t word_start_; // number of non-leaf nodes, or offset to the first leaf node
 
+  /// Centers converted to float, each one padded to a multiple of a cache line (empty if not applicable)
+  std::vector<float, Eigen::aligned_allocator<float> > centers_layout_;
+  std::size_t centers_stride_; // number of floats between two centers in centers_layout_
+  std::size_t centers_dimension_; // number of values of a center
+
+  /// Mapped vocabulary file, the centers are not in centers_ and valid_centers_ if it is set
+  std::shared_ptr<const char> mapped_file_;
+  const Feature* mapped_centers_;
+  const uint8_t* mapped_valid_centers_;
+  std::size_t mapped_nb_centers_;
+
   bool initialized() const
   {
     return num_words_ != 0;
   }
 
+  std::size_t nbCenters() const
+  {
+    return mapped_file_ ? mapped_nb_centers_ : centers_.size();
+  }
+
+  const Feature* centersData() const
+  {
+    return mapped_file_ ? mapped_centers_ : centers_.data();
+  }
+
+  const uint8_t* validCentersData() const
+  {
+    return mapped_file_ ? mapped_valid_centers_ : valid_centers_.data();
+  }
+
+  /**
+   * @brief Get the float centers used by the batched quantization.
+   * @return the padded float centers, or nullptr if the batched quantization does not apply
+   */
+  const float* centersLayout() const;
+
   void setNodeCounts();
+
+  /**
+   * @brief Load vocabulary from a file in any format.
+   * @param[in] file vocabulary file path
+   * @param[in] mapFile memory-map a file in the mappable format, instead of reading the centers in memory
+   */
+  void loadFile(const std::string& file, bool mapFile);
+
+  /**
+   * @brief Build the float copy of the centers used by the batched quantization.
+   * It must be called each time the centers are modified.
+   * The copy is only built for the L2 distance and for centers exactly represented by floats.
+   * Float centers with a size multiple of a cache line are used in place, without copy.
+   */
+  void computeCentersLayout();
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 VocabularyTree<Feature, Distance, FeatureAllocator>::VocabularyTree()
-: k_(0), levels_(0), num_words_(0), word_start_(0)
+: k_(0), levels_(0), num_words_(0), word_start_(0), centers_stride_(0), centers_dimension_(0),
+  mapped_centers_(nullptr), mapped_valid_centers_(nullptr), mapped_nb_centers_(0)
 {
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 VocabularyTree<Feature, Distance, FeatureAllocator>::VocabularyTree(const std::string& file)
-: k_(0), levels_(0), num_words_(0), word_start_(0)
+: k_(0), levels_(0), num_words_(0), word_start_(0), centers_stride_(0), centers_dimension_(0),
+  mapped_centers_(nullptr), mapped_valid_centers_(nullptr), mapped_nb_centers_(0)
 {
   load(file);
 }
@@ -195,6 +355,8 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
   //	printf("asserting\n");
   assert(initialized());
   //	printf("initialized\n");
+  const Feature* centers = centersData();
+  const uint8_t* validCenters = validCentersData();
   int32_t index = -1; // virtual "root" index, which has no associated center.
   for(unsigned level = 0; level < levels_; ++level)
   {
@@ -205,9 +367,9 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
     distance_type best_distance = std::numeric_limits<distance_type>::max();
     for(int32_t child = first_child; child < first_child + (int32_t) splits(); ++child)
     {
-      if(!valid_centers_[child])
+      if(!validCenters[child])
         break; // Fewer than splits() children.
-      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers_[child]);
+      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers[child]);
       if(child_distance < best_distance)
       {
         best_child = child;
@@ -224,18 +386,134 @@ template<class Feature, template<typename, typename> class Distance, class Featu
 template<class DescriptorT>
 std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT>& features) const
 {
-  // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
-  std::vector<Word> imgVisualWords(features.size(), 0);
+  return quantize(features.data(), features.size());
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const DescriptorT* features, std::size_t count) const
+{
+  typedef typename Distance<Feature, DescriptorT>::result_type distance_type;
+
+  std::vector<Word> imgVisualWords(count, 0);
+
+  const float* layout = centersLayout();
+  const bool batched = IsExactFloat<typename DescriptorT::value_type>::value && layout != nullptr;
 
-  // quantize the features
-  #pragma omp parallel for
-  for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
+  if(!batched)
   {
-    // store the visual word associated to the feature in the temporary list
-    imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+    // quantize the features one by one
+    #pragma omp parallel for
+    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(count); ++j)
+    {
+      // store the visual word associated to the feature in the temporary list
+      imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+    }
+    return imgVisualWords;
+  }
+
+  assert(initialized());
+
+  const Feature* centers = centersData();
+  const uint8_t* validCenters = validCentersData();
+  const feature::L2FloatOneToManyKernel l2FloatOneToMany = feature::getDistanceKernels().l2FloatOneToMany;
+
+  // Bound of the relative error between the float distances and the reference distances,
+  // with a factor 2 of margin. A child can only be the closest one according to the reference
+  // distance if its float distance is below the best float distance times this factor.
+  const float relativeError = (centers_dimension_ + 4) * std::numeric_limits<float>::epsilon();
+  const float candidateFactor = (1.f + relativeError) / (1.f - relativeError);
+  const float candidateMargin = centers_dimension_ * std::numeric_limits<float>::min();
+
+  // number of features pushed down the tree together
+  const std::size_t quantizeBlockSize = 256;
+  const ptrdiff_t nbBlocks = static_cast<ptrdiff_t>((count + quantizeBlockSize - 1) / quantizeBlockSize);
+
+  #pragma omp parallel
+  {
+    std::vector<float, Eigen::aligned_allocator<float> > block(quantizeBlockSize * centers_stride_, 0.f);
+    std::vector<int32_t> nodes(quantizeBlockSize);
+    std::vector<int32_t> order(quantizeBlockSize);
+    std::vector<float> distances(k_);
+
+    #pragma omp for schedule(dynamic)
+    for(ptrdiff_t b = 0; b < nbBlocks; ++b)
+    {
+      const std::size_t first = b * quantizeBlockSize;
+      const std::size_t blockSize = std::min(quantizeBlockSize, count - first);
+
+      // copy the features with the layout of the centers, the padding stays at 0
+      for(std::size_t i = 0; i < blockSize; ++i)
+      {
+        const DescriptorT& feature = features[first + i];
+        float* dst = &block[i * centers_stride_];
+        for(std::size_t d = 0; d < centers_dimension_; ++d)
+          dst[d] = static_cast<float>(feature[d]);
+      }
+
+      std::fill(nodes.begin(), nodes.begin() + blockSize, -1); // virtual "root" index
+      std::iota(order.begin(), order.begin() + blockSize, 0);
+
+      for(unsigned level = 0; level < levels_; ++level)
+      {
+        // process the features node by node, so that the centers of a node are loaded once per level
+        if(level > 0)
+          std::sort(order.begin(), order.begin() + blockSize, [&nodes](int32_t a, int32_t b) { return nodes[a] < nodes[b]; });
+
+        for(std::size_t o = 0; o < blockSize; ++o)
+        {
+          const int32_t i = order[o];
+          const int32_t firstChild = (nodes[i] + 1) * splits();
+
+          int32_t nbChildren = 0;
+          while(nbChildren < (int32_t) splits() && validCenters[firstChild + nbChildren])
+            ++nbChildren; // Fewer than splits() children.
+
+          int32_t bestChild = 0;
+          if(nbChildren > 1)
+          {
+            l2FloatOneToMany(&block[i * centers_stride_], layout + firstChild * centers_stride_,
+                             nbChildren, centers_stride_, centers_stride_, distances.data());
+
+            for(int32_t c = 1; c < nbChildren; ++c)
+            {
+              if(distances[c] < distances[bestChild])
+                bestChild = c;
+            }
+
+            // the closest child is decided with the reference distance if several children are within the error bound
+            const float threshold = distances[bestChild] * candidateFactor + candidateMargin;
+            int32_t nbCandidates = 0;
+            for(int32_t c = 0; c < nbChildren; ++c)
+            {
+              if(distances[c] <= threshold)
+                ++nbCandidates;
+            }
+            if(nbCandidates > 1)
+            {
+              distance_type bestDistance = std::numeric_limits<distance_type>::max();
+              for(int32_t c = 0; c < nbChildren; ++c)
+              {
+                if(distances[c] > threshold)
+                  continue;
+                const distance_type childDistance = Distance<DescriptorT, Feature>()(features[first + i], centers[firstChild + c]);
+                if(childDistance < bestDistance)
+                {
+                  bestChild = c;
+                  bestDistance = childDistance;
+                }
+              }
+            }
+          }
+          nodes[i] = firstChild + bestChild;
+        }
+      }
+
+      for(std::size_t i = 0; i < blockSize; ++i)
+        imgVisualWords[first + i] = nodes[i] - word_start_;
+    }
   }
 
-  // add the vector to the documents
   return imgVisualWords;
 }
 
@@ -273,51 +551,100 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::clear()
   centers_.clear();
   valid_centers_.clear();
   k_ = levels_ = num_words_ = word_start_ = 0;
+  centers_layout_.clear();
+  centers_stride_ = centers_dimension_ = 0;
+  mapped_file_.reset();
+  mapped_centers_ = nullptr;
+  mapped_valid_centers_ = nullptr;
+  mapped_nb_centers_ = 0;
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
-void VocabularyTree<Feature, Distance, FeatureAllocator>::save(const std::string& file) const
+void VocabularyTree<Feature, Distance, FeatureAllocator>::save(const std::string& file, EVocabularyTreeFileFormat format) const
 {
   /// @todo Support serializing of non-"simple" feature classes
   /// @todo Some identifying name for the distance used
   assert(initialized());
 
+  if(format == EVocabularyTreeFileFormat::MAPPABLE)
+  {
+    writeMappableTreeFile(file, k_, levels_, centersData(), sizeof(Feature), nbCenters(), validCentersData());
+    return;
+  }
+
   std::ofstream out(file.c_str(), std::ios_base::binary);
   out.write((char*) (&k_), sizeof (uint32_t));
   out.write((char*) (&levels_), sizeof (uint32_t));
-  uint32_t size = centers_.size();
+  uint32_t size = nbCenters();
   out.write((char*) (&size), sizeof (uint32_t));
-  out.write((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
-  out.write((char*) (&valid_centers_[0]), valid_centers_.size());
+  out.write((const char*) centersData(), size * sizeof (Feature));
+  out.write((const char*) validCentersData(), size);
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string& file)
 {
-  clear();
+  loadFile(file, true);
+}
 
-  std::ifstream in;
-  in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::loadFile(const std::string& file, bool mapFile)
+{
+  clear();
 
-  uint32_t size;
-  try
+  if(isMappableTreeFile(file))
   {
-    in.open(file.c_str(), std::ios_base::binary);
-    in.read((char*) (&k_), sizeof (uint32_t));
-    in.read((char*) (&levels_), sizeof (uint32_t));
-    in.read((char*) (&size), sizeof (uint32_t));
-    centers_.resize(size);
-    valid_centers_.resize(size);
-    in.read((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
-    in.read((char*) (&valid_centers_[0]), valid_centers_.size());
+    MappableTreeHeader header;
+    std::shared_ptr<const char> data = mapTreeFile(file, header);
+
+    if(header.featureSize != sizeof(Feature))
+      throw std::runtime_error("Failed to load vocabulary tree file " + file + ", the size of the centers does not match the descriptor type");
+
+    const Feature* centers = reinterpret_cast<const Feature*>(data.get() + header.centersOffset);
+    const uint8_t* validCenters = reinterpret_cast<const uint8_t*>(data.get() + header.validCentersOffset);
+
+    k_ = header.splits;
+    levels_ = header.levels;
+
+    if(mapFile)
+    {
+      mapped_file_ = data;
+      mapped_centers_ = centers;
+      mapped_valid_centers_ = validCenters;
+      mapped_nb_centers_ = header.nbCenters;
+    }
+    else
+    {
+      centers_.assign(centers, centers + header.nbCenters);
+      valid_centers_.assign(validCenters, validCenters + header.nbCenters);
+    }
   }
-  catch(std::ifstream::failure& e)
+  else
   {
-    throw std::runtime_error("Failed to load vocabulary tree file" + file);
+    std::ifstream in;
+    in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+
+    uint32_t size;
+    try
+    {
+      in.open(file.c_str(), std::ios_base::binary);
+      in.read((char*) (&k_), sizeof (uint32_t));
+      in.read((char*) (&levels_), sizeof (uint32_t));
+      in.read((char*) (&size), sizeof (uint32_t));
+      centers_.resize(size);
+      valid_centers_.resize(size);
+      in.read((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
+      in.read((char*) (&valid_centers_[0]), valid_centers_.size());
+    }
+    catch(std::ifstream::failure& e)
+    {
+      throw std::runtime_error("Failed to load vocabulary tree file" + file);
+    }
   }
 
   setNodeCounts();
-  assert(size == num_words_ + word_start_);
+  assert(nbCenters() == num_words_ + word_start_);
+  computeCentersLayout();
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -332,6 +659,48 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::setNodeCounts()
   }
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::computeCentersLayout()
+{
+  centers_layout_.clear();
+  centers_stride_ = centers_dimension_ = 0;
+
+  if(!IsL2Distance<Distance>::value || !IsExactFloat<typename Feature::value_type>::value || nbCenters() == 0)
+    return;
+
+  const Feature* centers = centersData();
+  const std::size_t floatsPerCacheLine = 64 / sizeof(float);
+  centers_dimension_ = centers[0].size();
+  centers_stride_ = (centers_dimension_ + floatsPerCacheLine - 1) / floatsPerCacheLine * floatsPerCacheLine;
+
+  // the centers are already packed floats with the right stride
+  if(std::is_same<typename Feature::value_type, float>::value &&
+     centers_dimension_ == centers_stride_ &&
+     sizeof(Feature) == centers_stride_ * sizeof(float))
+    return;
+
+  centers_layout_.assign(nbCenters() * centers_stride_, 0.f);
+
+  for(std::size_t c = 0; c < nbCenters(); ++c)
+  {
+    float* dst = &centers_layout_[c * centers_stride_];
+    for(std::size_t d = 0; d < centers_dimension_; ++d)
+      dst[d] = static_cast<float>(centers[c][d]);
+  }
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+const float* VocabularyTree<Feature, Distance, FeatureAllocator>::centersLayout() const
+{
+  if(centers_stride_ == 0)
+    return nullptr;
+  if(centers_layout_.empty())
+    return reinterpret_cast<const float*>(centersData());
+  if(centers_layout_.size() != nbCenters() * centers_stride_)
+    return nullptr;
+  return centers_layout_.data();
+}
+
 /**
  * @brief compute the sparse distance between two histograms according to the chosen distance method.
  * 
@@ -11,6 +11,7 @@
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
+#include <functional>
 #include <string>
 
 namespace aliceVision {
@@ -52,6 +53,36 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                          std::vector<DescriptorT>& descriptors,
                          std::vector<std::size_t>& numFeatures);
 
+/**
+ * @brief Read the descriptor files of a sfmData one by one, without keeping all the descriptors in memory.
+ * @param[in] sfmData The input sfmData
+ * @param[in] featuresFolders The folder(s) containing the descriptor files (optional)
+ * @param[in] callback Function called with the view id and the descriptors of each descriptor file,
+ *            in the order of the view ids
+ * @return the total number of features read
+ */
+template<class DescriptorT, class FileDescriptorT>
+std::size_t forEachDescFile(const sfmData::SfMData& sfmData,
+                            const std::vector<std::string>& featuresFolders,
+                            const std::function<void(IndexT, const std::vector<DescriptorT>&)>& callback);
+
+/**
+ * @brief Read a uniform random sample of the descriptors of a sfmData.
+ * The descriptor files are streamed and only the sampled descriptors are kept in memory (reservoir sampling).
+ * @param[in] sfmData The input sfmData
+ * @param[in] featuresFolders The folder(s) containing the descriptor files (optional)
+ * @param[in] maxDescriptors The maximum number of descriptors to keep
+ * @param[out] descriptors The sampled descriptors
+ * @param[in] seed The seed of the random sampling
+ * @return the total number of features read
+ */
+template<class DescriptorT, class FileDescriptorT>
+std::size_t sampleDescFromFiles(const sfmData::SfMData& sfmData,
+                                const std::vector<std::string>& featuresFolders,
+                                std::size_t maxDescriptors,
+                                std::vector<DescriptorT>& descriptors,
+                                unsigned int seed = 0);
+
 } // namespace voctree
 } // namespace aliceVision
 
@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <random>
 
 namespace aliceVision {
 namespace voctree {
@@ -89,5 +90,66 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   return numDescriptors;
 }
 
+template<class DescriptorT, class FileDescriptorT>
+std::size_t forEachDescFile(const sfmData::SfMData& sfmData,
+                            const std::vector<std::string>& featuresFolders,
+                            const std::function<void(IndexT, const std::vector<DescriptorT>&)>& callback)
+{
+  std::map<IndexT, std::string> descriptorsFiles;
+  getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
+  std::size_t numDescriptors = 0;
+
+  ALICEVISION_LOG_DEBUG("Reading the descriptors file by file...");
+  boost::progress_display display(descriptorsFiles.size());
+
+  // the buffer is reused for all the files
+  std::vector<DescriptorT> descriptors;
+  for(const auto &currentFile : descriptorsFiles)
+  {
+    feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(currentFile.second, descriptors, false);
+    numDescriptors += descriptors.size();
+    callback(currentFile.first, descriptors);
+    ++display;
+  }
+  return numDescriptors;
+}
+
+template<class DescriptorT, class FileDescriptorT>
+std::size_t sampleDescFromFiles(const sfmData::SfMData& sfmData,
+                                const std::vector<std::string>& featuresFolders,
+                                std::size_t maxDescriptors,
+                                std::vector<DescriptorT>& descriptors,
+                                unsigned int seed)
+{
+  descriptors.clear();
+  descriptors.reserve(maxDescriptors);
+
+  std::mt19937_64 generator(seed);
+  std::size_t numDescriptors = 0;
+
+  forEachDescFile<DescriptorT, FileDescriptorT>(sfmData, featuresFolders,
+    [&](IndexT, const std::vector<DescriptorT>& fileDescriptors)
+    {
+      for(const DescriptorT& descriptor : fileDescriptors)
+      {
+        // keep the first descriptors, then replace a kept descriptor with a probability maxDescriptors / (numDescriptors + 1)
+        if(descriptors.size() < maxDescriptors)
+        {
+          descriptors.push_back(descriptor);
+        }
+        else
+        {
+          const std::size_t index = std::uniform_int_distribution<std::size_t>(0, numDescriptors)(generator);
+          if(index < maxDescriptors)
+            descriptors[index] = descriptor;
+        }
+        ++numDescriptors;
+      }
+    });
+
+  ALICEVISION_LOG_DEBUG("Sampled " << descriptors.size() << " descriptors out of " << numDescriptors);
+  return numDescriptors;
+}
+
 } // namespace voctree
 } // namespace aliceVision
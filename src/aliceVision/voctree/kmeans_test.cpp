@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <aliceVision/voctree/SimpleKmeans.hpp>
 
 #include <iostream>
@@ -45,8 +46,9 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
   }
 
   voctree::InitKmeanspp initializer;
+  std::mt19937 randomNumberGenerator(0);
 
-  initializer(featPtr, K, centers, voctree::L2<FeatureFloat, FeatureFloat>());
+  initializer(featPtr, K, centers, voctree::L2<FeatureFloat, FeatureFloat>(), randomNumberGenerator);
 
   // it's difficult to check the result as it is random, just check there are no weird things
   BOOST_CHECK(voctree::checkVectorElements(centers, "initializer1"));
@@ -66,7 +68,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
     }
   }
 
-  initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>());
+  initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>(), randomNumberGenerator);
 
   // it's difficult to check the result as it is random, just check there are no weird things
   BOOST_CHECK(voctree::checkVectorElements(centers, "initializer2"));
@@ -105,6 +107,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializerVarying)
     FeatureFloatVector centers;
 
     voctree::InitKmeanspp initializer;
+    std::mt19937 randomNumberGenerator(trial);
 
     features.reserve(FEATURENUMBER * K);
     featPtr.reserve(features.size());
@@ -120,7 +123,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializerVarying)
       }
     }
 
-    initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>());
+    initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>(), randomNumberGenerator);
 
     // it's difficult to check the result as it is random, just check there are no weird things
     BOOST_CHECK(voctree::checkVectorElements(centers, "initializer"));
@@ -155,6 +158,7 @@ BOOST_AUTO_TEST_CASE(kmeanSimple)
   voctree::SimpleKmeans<FeatureFloat> kmeans(FeatureFloat::Zero());
   kmeans.setVerbose(0);
   kmeans.setRestarts(5);
+  std::mt19937 randomNumberGenerator(0);
 
   for(std::size_t trial = 0; trial < 10; ++trial)
   {
@@ -178,7 +182,7 @@ BOOST_AUTO_TEST_CASE(kmeanSimple)
       centersGT.push_back((Eigen::MatrixXf::Constant(1, DIMENSION, STEP * i) - Eigen::MatrixXf::Constant(1, DIMENSION, STEP * (K - 1) / 2)) / ((STEP * (K - 1) / 2) * sqrt(DIMENSION)));
     }
 
-    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership);
+    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership, randomNumberGenerator);
 
 //    voctree::printFeatVector( centers );
 
@@ -239,6 +243,7 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
     voctree::SimpleKmeans<FeatureFloat> kmeans(FeatureFloat::Zero(DIMENSION));
     kmeans.setVerbose(0);
     kmeans.setRestarts(3);
+    std::mt19937 randomNumberGenerator(trial);
 
     features.reserve(FEATURENUMBER * K);
     membership.reserve(features.size());
@@ -257,7 +262,7 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
       centersGT.push_back((FeatureFloat::Constant(DIMENSION, STEP * i) - FeatureFloat::Constant(DIMENSION, STEP * (K - 1) / 2)) / ((STEP * (K - 1) / 2) * sqrt(DIMENSION)));
     }
 
-    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership);
+    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership, randomNumberGenerator);
 
 //    voctree::printFeatVector( features );
 //    voctree::printFeatVector(centers);
@@ -291,3 +296,65 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(kmeanBenchmark)
+{
+  using namespace aliceVision;
+  ALICEVISION_LOG_DEBUG("Benchmarking kmeans and mini-batch kmeans...");
+
+  const std::size_t DIMENSION = 128;
+  const std::size_t FEATURENUMBER = 20000;
+  const std::size_t K = 10;
+  const std::size_t STEP = 5 * K;
+
+  typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+  typedef voctree::SimpleKmeans<FeatureFloat>::squared_distance_type squared_distance_type;
+
+  FeatureFloatVector features;
+  features.reserve(FEATURENUMBER * K);
+  for(std::size_t i = 0; i < K; ++i)
+  {
+    // at each i iteration translate the cluster by STEP*i
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+    {
+      features.push_back((FeatureFloat::Random(1, DIMENSION) + Eigen::MatrixXf::Constant(1, DIMENSION, STEP * i) - Eigen::MatrixXf::Constant(1, DIMENSION, STEP * (K - 1) / 2)) / ((STEP * (K - 1) / 2) * sqrt(DIMENSION)));
+    }
+  }
+
+  voctree::SimpleKmeans<FeatureFloat> kmeans(FeatureFloat::Zero());
+  kmeans.setVerbose(0);
+  kmeans.setRestarts(1);
+
+  voctree::SimpleKmeans<FeatureFloat> miniBatchKmeans(FeatureFloat::Zero());
+  miniBatchKmeans.setVerbose(0);
+  miniBatchKmeans.setRestarts(1);
+  miniBatchKmeans.setMiniBatchSize(2000);
+  std::mt19937 randomNumberGenerator(0);
+
+  for(const voctree::SimpleKmeans<FeatureFloat>* clusterer : {&kmeans, &miniBatchKmeans})
+  {
+    FeatureFloatVector centers;
+    std::vector<unsigned int> membership;
+
+    system::Timer timer;
+    const squared_distance_type sse = clusterer->cluster(features, K, centers, membership, randomNumberGenerator);
+    ALICEVISION_LOG_INFO((clusterer->getMiniBatchSize() > 0 ? "Mini-batch kmeans" : "Kmeans") << " of "
+                         << features.size() << " features: " << timer.elapsedMs() << " ms, sse: " << sse);
+
+    // the clusters are far away from each other, every feature must be in the cluster of its group
+    std::vector<std::size_t> h(K, 0);
+    std::size_t nbMisassigned = 0;
+    for(std::size_t i = 0; i < membership.size(); ++i)
+    {
+      ++h[membership[i]];
+      if(membership[i] != membership[(i / FEATURENUMBER) * FEATURENUMBER])
+        ++nbMisassigned;
+    }
+    BOOST_CHECK_EQUAL(nbMisassigned, 0);
+    for(std::size_t i = 0; i < h.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(h[i], FEATURENUMBER);
+    }
+  }
+}
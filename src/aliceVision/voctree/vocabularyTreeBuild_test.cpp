@@ -5,12 +5,17 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/voctree/TreeBuilder.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <Eigen/Core>
 
 #include <iostream>
+#include <cstdio>
 #include <fstream>
+#include <iterator>
+#include <random>
 #include <vector>
 
 #define BOOST_TEST_MODULE voctreeBuilder
@@ -83,4 +88,171 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
     BOOST_CHECK_SMALL(distance(centerOrig[i],centerLoad[i]), kepsf);
   }
 //  voctree::printFeatVector( features ); 
+
+  // the batched quantization gives the same words as the quantization of each feature
+  const std::vector<voctree::Word> words = loadedtree.quantize(features.data(), features.size());
+  BOOST_CHECK_EQUAL(words.size(), features.size());
+  for(std::size_t i = 0; i < features.size(); ++i)
+    BOOST_CHECK_EQUAL(words[i], loadedtree.quantize(features[i]));
+}
+
+BOOST_AUTO_TEST_CASE(voctreeBuilder_batchedQuantization)
+{
+  using namespace aliceVision;
+
+  typedef feature::Descriptor<float, 128> DescriptorFloat;
+  typedef feature::Descriptor<unsigned char, 128> DescriptorUChar;
+
+  const std::size_t K = 10;
+  const std::size_t LEVELS = 3;
+
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<int> valueDistribution(0, 255);
+
+  // SIFT-like features, drawn around a few modes so that the tree is not degenerated
+  std::vector<DescriptorFloat> modes(30);
+  for(DescriptorFloat& mode : modes)
+    for(std::size_t d = 0; d < mode.size(); ++d)
+      mode[d] = static_cast<float>(valueDistribution(randomNumberGenerator));
+
+  std::normal_distribution<float> noiseDistribution(0.f, 20.f);
+  std::vector<DescriptorUChar> featuresUChar(3000);
+  std::vector<DescriptorFloat> features(featuresUChar.size());
+  for(std::size_t i = 0; i < featuresUChar.size(); ++i)
+  {
+    const DescriptorFloat& mode = modes[i % modes.size()];
+    for(std::size_t d = 0; d < mode.size(); ++d)
+    {
+      featuresUChar[i][d] = static_cast<unsigned char>(std::min(255.f, std::max(0.f, std::round(mode[d] + noiseDistribution(randomNumberGenerator)))));
+      features[i][d] = featuresUChar[i][d];
+    }
+  }
+
+  voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0.f));
+  builder.setVerbose(0);
+  builder.build(features, K, LEVELS);
+  const voctree::MutableVocabularyTree<DescriptorFloat>& tree = builder.tree();
+
+  // features exactly between two centers of the first level, the first center must be chosen
+  for(std::size_t c = 0; c + 1 < K; ++c)
+  {
+    DescriptorFloat middle;
+    for(std::size_t d = 0; d < middle.size(); ++d)
+      middle[d] = (tree.centers()[c][d] + tree.centers()[c + 1][d]) / 2.f;
+    features.push_back(middle);
+  }
+
+  const std::vector<voctree::Word> words = tree.quantize(features);
+  const std::vector<voctree::Word> wordsUChar = tree.quantize(featuresUChar);
+  BOOST_CHECK_EQUAL(words.size(), features.size());
+  BOOST_CHECK_EQUAL(wordsUChar.size(), featuresUChar.size());
+
+  for(std::size_t i = 0; i < features.size(); ++i)
+    BOOST_CHECK_EQUAL(words[i], tree.quantize(features[i]));
+  for(std::size_t i = 0; i < featuresUChar.size(); ++i)
+    BOOST_CHECK_EQUAL(wordsUChar[i], tree.quantize(featuresUChar[i]));
+}
+
+BOOST_AUTO_TEST_CASE(voctreeBuilder_fileFormats)
+{
+  using namespace aliceVision;
+
+  typedef feature::Descriptor<float, 128> DescriptorFloat;
+
+  const std::string legacyTreeName = "test_legacy.tree";
+  const std::string mappableTreeName = "test_mappable.tree";
+
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_real_distribution<float> valueDistribution(0.f, 255.f);
+
+  std::vector<DescriptorFloat> features(2000);
+  for(DescriptorFloat& feature : features)
+    for(std::size_t d = 0; d < feature.size(); ++d)
+      feature[d] = valueDistribution(randomNumberGenerator);
+
+  voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0.f));
+  builder.setVerbose(0);
+  builder.build(features, 8, 2);
+  const voctree::MutableVocabularyTree<DescriptorFloat>& tree = builder.tree();
+
+  tree.save(legacyTreeName, voctree::EVocabularyTreeFileFormat::LEGACY);
+  tree.save(mappableTreeName, voctree::EVocabularyTreeFileFormat::MAPPABLE);
+
+  BOOST_CHECK(!voctree::isMappableTreeFile(legacyTreeName));
+  BOOST_CHECK(voctree::isMappableTreeFile(mappableTreeName));
+
+  // the trees and the streams are released before removing their files (the mapped tree keeps its file open)
+  {
+    const voctree::VocabularyTree<DescriptorFloat> legacyTree(legacyTreeName);
+    const voctree::VocabularyTree<DescriptorFloat> mappedTree(mappableTreeName);
+    voctree::MutableVocabularyTree<DescriptorFloat> copiedTree;
+    copiedTree.load(mappableTreeName);
+
+    BOOST_CHECK(!legacyTree.isMapped());
+    BOOST_CHECK(mappedTree.isMapped());
+    BOOST_CHECK(!copiedTree.isMapped());
+
+    BOOST_CHECK(legacyTree == tree);
+    BOOST_CHECK(mappedTree == tree);
+    BOOST_CHECK(copiedTree == tree);
+
+    // the mapped tree gives the same words as the tree in memory
+    const std::vector<voctree::Word> words = tree.quantize(features);
+    const std::vector<voctree::Word> mappedWords = mappedTree.quantize(features);
+    BOOST_CHECK(words == legacyTree.quantize(features));
+    BOOST_CHECK(words == mappedWords);
+    for(std::size_t i = 0; i < features.size(); i += 100)
+      BOOST_CHECK_EQUAL(words[i], mappedTree.quantize(features[i]));
+
+    // a mapped tree saved back to the legacy format gives the original file
+    mappedTree.save(mappableTreeName + ".legacy", voctree::EVocabularyTreeFileFormat::LEGACY);
+    std::ifstream legacyFile(legacyTreeName, std::ios::binary);
+    std::ifstream resavedFile(mappableTreeName + ".legacy", std::ios::binary);
+    const std::string legacyContent((std::istreambuf_iterator<char>(legacyFile)), std::istreambuf_iterator<char>());
+    const std::string resavedContent((std::istreambuf_iterator<char>(resavedFile)), std::istreambuf_iterator<char>());
+    BOOST_CHECK(legacyContent == resavedContent);
+  }
+
+  std::remove(legacyTreeName.c_str());
+  std::remove(mappableTreeName.c_str());
+  std::remove((mappableTreeName + ".legacy").c_str());
+}
+
+BOOST_AUTO_TEST_CASE(voctreeBuilder_sameTreeWithThreads)
+{
+  using namespace aliceVision;
+
+  typedef feature::Descriptor<float, 128> DescriptorFloat;
+
+  // SIFT-like features with integer values: the sums of the k-means centers are exact whatever
+  // the order in which the threads accumulate them
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<int> valueDistribution(0, 255);
+
+  std::vector<DescriptorFloat> features(3000);
+  for(DescriptorFloat& feature : features)
+    for(std::size_t d = 0; d < feature.size(); ++d)
+      feature[d] = static_cast<float>(valueDistribution(randomNumberGenerator));
+
+  const auto buildTree = [&](int nbThreads, std::size_t miniBatchSize)
+  {
+    omp_set_num_threads(nbThreads);
+    voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0.f));
+    builder.setVerbose(0);
+    builder.setRandomSeed(7);
+    builder.kmeans().setRestarts(2);
+    builder.kmeans().setMiniBatchSize(miniBatchSize);
+    builder.build(features, 6, 3);
+    return builder.tree();
+  };
+
+  const int maxThreads = omp_get_max_threads();
+  for(std::size_t miniBatchSize : {0, 200})
+  {
+    // the subtrees are clustered in parallel with 4 threads, each with the random generator of its node
+    const voctree::MutableVocabularyTree<DescriptorFloat> sequentialTree = buildTree(1, miniBatchSize);
+    BOOST_CHECK(buildTree(4, miniBatchSize) == sequentialTree);
+    BOOST_CHECK(buildTree(1, miniBatchSize) == sequentialTree);
+  }
+  omp_set_num_threads(maxThreads);
 }
@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <random>
+#include <string>
 #include <vector>
 
 #define BOOST_TEST_MODULE vocabularyTree
@@ -58,3 +60,48 @@ BOOST_AUTO_TEST_CASE(database)
     BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
   }
 }
+
+BOOST_AUTO_TEST_CASE(database_invertedFile)
+{
+  const int nbDocuments = 300;
+  const int nbWords = 500;
+  const std::size_t N = 20;
+
+  std::mt19937 randomNumberGenerator(0);
+  // few features per document and a small vocabulary, to get documents without common words and many equal scores
+  std::uniform_int_distribution<int> wordDistribution(0, nbWords - 1);
+  std::uniform_int_distribution<int> sizeDistribution(0, 40);
+
+  Database db(nbWords);
+  std::vector<SparseHistogram> histograms;
+  for(int i = 0; i < nbDocuments; ++i)
+  {
+    std::vector<Word> document(sizeDistribution(randomNumberGenerator));
+    for(Word& word : document)
+      word = wordDistribution(randomNumberGenerator);
+
+    SparseHistogram histo;
+    computeSparseHistogram(document, histo);
+    // insert the documents in a non increasing order of ids
+    db.insert((i * 7) % nbDocuments, histo);
+    histograms.push_back(histo);
+  }
+  db.computeTfIdfWeights();
+
+  for(const std::string distanceMethod : {"classic", "L2", "commonPoints", "strongCommonPoints"})
+  {
+    for(std::size_t i = 0; i < histograms.size(); i += 10)
+    {
+      for(const std::size_t nbMatches : {std::size_t(1), N, db.size()})
+      {
+        std::vector<DocMatch> invertedFileMatches;
+        std::vector<DocMatch> exhaustiveMatches;
+        db.find(histograms[i], nbMatches, invertedFileMatches, distanceMethod);
+        db.findExhaustive(histograms[i], nbMatches, exhaustiveMatches, distanceMethod);
+
+        BOOST_CHECK_EQUAL(invertedFileMatches.size(), exhaustiveMatches.size());
+        BOOST_CHECK(invertedFileMatches == exhaustiveMatches);
+      }
+    }
+  }
+}
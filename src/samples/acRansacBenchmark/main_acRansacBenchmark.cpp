@@ -0,0 +1,205 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/multiview/RelativePoseKernel.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalKernel.hpp>
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+using KernelT = multiview::RelativePoseKernel<multiview::relativePose::Fundamental7PSolver,
+                                              multiview::relativePose::FundamentalEpipolarDistanceError,
+                                              multiview::UnnormalizerT,
+                                              robustEstimation::Mat3Model>;
+
+int main(int argc, char** argv)
+{
+  int nbPoints = 2000;
+  double outlierRatio = 0.5;
+  double noise = 0.5;
+  int nbIterations = 1024;
+  int nbRuns = 10;
+
+  po::options_description allParams("Compare the sequential ACRANSAC loop and the parallel ACRANSAC\n"
+                                    "on a synthetic fundamental matrix estimation.\n"
+                                    "AliceVision samples_acRansacBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbPoints", po::value<int>(&nbPoints)->default_value(nbPoints),
+      "Number of correspondences.")
+    ("outlierRatio", po::value<double>(&outlierRatio)->default_value(outlierRatio),
+      "Ratio of random correspondences.")
+    ("noise", po::value<double>(&noise)->default_value(noise),
+      "Standard deviation of the noise on the inliers (in pixels).")
+    ("nbIterations", po::value<int>(&nbIterations)->default_value(nbIterations),
+      "Maximum number of ACRANSAC iterations.")
+    ("nbRuns", po::value<int>(&nbRuns)->default_value(nbRuns),
+      "Number of estimations with different seeds.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(po::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  // two views of a synthetic scene, with noise and outliers
+  const NViewDataSet dataset = NRealisticCamerasRing(2, nbPoints);
+  const int width = 1000;
+  const int height = 1000;
+
+  std::mt19937 generator(0);
+  std::normal_distribution<double> noiseDistribution(0.0, noise);
+  std::uniform_real_distribution<double> xDistribution(0.0, width);
+  std::uniform_real_distribution<double> yDistribution(0.0, height);
+  std::bernoulli_distribution outlierDistribution(outlierRatio);
+
+  Mat xI = dataset._x[0];
+  Mat xJ = dataset._x[1];
+  for(Mat::Index i = 0; i < xI.cols(); ++i)
+  {
+    if(outlierDistribution(generator))
+    {
+      xJ.col(i) << xDistribution(generator), yDistribution(generator);
+      continue;
+    }
+    xI.col(i) += Vec2(noiseDistribution(generator), noiseDistribution(generator));
+    xJ.col(i) += Vec2(noiseDistribution(generator), noiseDistribution(generator));
+  }
+
+  const KernelT kernel(xI, width, height, xJ, width, height, true);
+
+  ALICEVISION_LOG_INFO(nbPoints << " correspondences, " << outlierRatio * 100.0 << "% outliers, "
+                       << nbIterations << " iterations, " << omp_get_max_threads() << " threads");
+
+  // NFA of the residuals: full sort (previous loop) vs bucketed evaluation
+  {
+    const std::size_t sizeSample = kernel.getMinimumNbRequiredSamples();
+    const std::size_t nData = kernel.nbSamples();
+    const double loge0 = log10((double)kernel.getMaximumNbModels() * (nData - sizeSample));
+    std::vector<float> logc_n, logc_k;
+    robustEstimation::makelogcombi(sizeSample, nData, logc_k, logc_n);
+
+    // residuals of the models of random samples
+    std::vector<std::vector<double>> residualsPerModel;
+    std::vector<std::size_t> sample(sizeSample);
+    while(residualsPerModel.size() < 200)
+    {
+      robustEstimation::uniformSample(generator, sizeSample, nData, sample);
+      std::vector<robustEstimation::Mat3Model> models;
+      kernel.fit(sample, models);
+      for(const auto& model : models)
+      {
+        residualsPerModel.emplace_back(nData);
+        kernel.errors(model, residualsPerModel.back());
+      }
+    }
+
+    std::vector<robustEstimation::ErrorIndex> sorted(nData);
+    double sortChecksum = 0.0;
+    system::Timer timer;
+    for(const std::vector<double>& residuals : residualsPerModel)
+    {
+      for(std::size_t i = 0; i < nData; ++i)
+        sorted[i] = robustEstimation::ErrorIndex(residuals[i], i);
+      std::sort(sorted.begin(), sorted.end());
+      const robustEstimation::ErrorIndex best = robustEstimation::bestNFA(sizeSample, kernel.logalpha0(), sorted, loge0,
+                                                                          std::numeric_limits<double>::infinity(),
+                                                                          logc_n, logc_k, kernel.multError());
+      sortChecksum += best.first + best.second;
+    }
+    const double sortTime = timer.elapsedMs();
+
+    robustEstimation::NFABuckets buckets;
+    std::vector<std::size_t> inliers;
+    double errorMax;
+    double bucketsChecksum = 0.0;
+    timer.reset();
+    for(const std::vector<double>& residuals : residualsPerModel)
+    {
+      const robustEstimation::ErrorIndex best = robustEstimation::bestNFABucketed(sizeSample, kernel.logalpha0(), residuals, loge0,
+                                                                                  std::numeric_limits<double>::infinity(),
+                                                                                  logc_n, logc_k, kernel.multError(),
+                                                                                  std::numeric_limits<double>::infinity(),
+                                                                                  buckets, inliers, errorMax);
+      bucketsChecksum += best.first + best.second;
+    }
+    const double bucketsTime = timer.elapsedMs();
+
+    ALICEVISION_LOG_INFO("NFA evaluation of " << residualsPerModel.size() << " models:" << std::endl
+      << "\t- sort + bestNFA: " << sortTime << " ms" << std::endl
+      << "\t- bestNFABucketed: " << bucketsTime << " ms (x" << sortTime / bucketsTime << ")" << std::endl
+      << "\t- same NFA: " << (sortChecksum == bucketsChecksum ? "yes" : "no"));
+  }
+
+  // full estimations, sequential (batch of 1 hypothesis) and parallel
+  for(const std::size_t batchSize : {1, 8, 32, 128})
+  {
+    double time = 0.0;
+    double meanNFA = 0.0;
+    double meanInliers = 0.0;
+    bool reproducible = true;
+
+    for(int run = 0; run < nbRuns; ++run)
+    {
+      std::mt19937 randomNumberGenerator(run);
+      std::vector<std::size_t> inliers;
+      robustEstimation::Mat3Model model;
+
+      system::Timer timer;
+      const std::pair<double, double> out = robustEstimation::ACRANSACParallel(kernel, randomNumberGenerator, inliers,
+                                                                               nbIterations, &model, Square(4.0), batchSize);
+      time += timer.elapsedMs();
+      meanNFA += out.second / nbRuns;
+      meanInliers += double(inliers.size()) / nbRuns;
+
+      // same seed, single thread
+      std::mt19937 randomNumberGeneratorCheck(run);
+      std::vector<std::size_t> inliersCheck;
+      const int nbThreads = omp_get_max_threads();
+      omp_set_num_threads(1);
+      robustEstimation::ACRANSACParallel(kernel, randomNumberGeneratorCheck, inliersCheck, nbIterations, nullptr, Square(4.0), batchSize);
+      omp_set_num_threads(nbThreads);
+      reproducible = reproducible && (inliers == inliersCheck);
+    }
+
+    ALICEVISION_LOG_INFO((batchSize == 1 ? "ACRANSAC (sequential)" : "ACRANSACParallel") << ", batch size " << batchSize << ":" << std::endl
+      << "\t- time: " << time / nbRuns << " ms per estimation" << std::endl
+      << "\t- mean NFA: " << meanNFA << std::endl
+      << "\t- mean #inliers: " << meanInliers << std::endl
+      << "\t- same result with 1 thread: " << (reproducible ? "yes" : "no"));
+  }
+
+  return EXIT_SUCCESS;
+}
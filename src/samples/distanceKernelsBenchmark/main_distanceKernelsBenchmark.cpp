@@ -0,0 +1,158 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/distanceKernels.hpp>
+#include <aliceVision/feature/metric.hpp>
+#include <aliceVision/matching/ArrayMatcher_bruteForce.hpp>
+#include <aliceVision/system/cpu.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Compute all the distances between two descriptor sets with a kernel.
+ * @return a checksum of the distances, to compare the kernels and avoid dead code elimination
+ */
+template <typename T, typename Kernel>
+double allPairsDistances(Kernel kernel, const std::vector<T>& query, const std::vector<T>& database, std::size_t dimension)
+{
+  const std::size_t nbQuery = query.size() / dimension;
+  const std::size_t nbDatabase = database.size() / dimension;
+  double checksum = 0.0;
+  for(std::size_t i = 0; i < nbQuery; ++i)
+    for(std::size_t j = 0; j < nbDatabase; ++j)
+      checksum += kernel(&query[i * dimension], &database[j * dimension], dimension);
+  return checksum;
+}
+
+int main(int argc, char** argv)
+{
+  int nbQuery = 2000;
+  int nbDatabase = 2000;
+  int dimension = 128;
+
+  po::options_description allParams("Compare the scalar and the SIMD descriptor distance kernels.\n"
+                                    "AliceVision samples_distanceKernelsBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbQuery", po::value<int>(&nbQuery)->default_value(nbQuery),
+      "Number of query descriptors.")
+    ("nbDatabase", po::value<int>(&nbDatabase)->default_value(nbDatabase),
+      "Number of database descriptors.")
+    ("dimension", po::value<int>(&dimension)->default_value(dimension),
+      "Descriptor dimension (in elements for L2, in bytes for Hamming).");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(po::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 randomNumberGenerator(0);
+  std::uniform_int_distribution<int> ucharDistribution(0, 255);
+  std::uniform_real_distribution<float> floatDistribution(0.f, 1.f);
+
+  std::vector<unsigned char> ucharQuery(nbQuery * dimension), ucharDatabase(nbDatabase * dimension);
+  std::vector<float> floatQuery(nbQuery * dimension), floatDatabase(nbDatabase * dimension);
+  for(std::size_t i = 0; i < ucharQuery.size(); ++i)
+  {
+    ucharQuery[i] = static_cast<unsigned char>(ucharDistribution(randomNumberGenerator));
+    floatQuery[i] = floatDistribution(randomNumberGenerator);
+  }
+  for(std::size_t i = 0; i < ucharDatabase.size(); ++i)
+  {
+    ucharDatabase[i] = static_cast<unsigned char>(ucharDistribution(randomNumberGenerator));
+    floatDatabase[i] = floatDistribution(randomNumberGenerator);
+  }
+
+  const system::ESimdLevel cpuSimdLevel = system::getSimdLevel();
+  ALICEVISION_LOG_INFO("CPU SIMD level: " << system::ESimdLevel_enumToString(cpuSimdLevel));
+  ALICEVISION_LOG_INFO(nbQuery << " x " << nbDatabase << " distances, dimension " << dimension);
+
+  double scalarTime[3] = {0.0, 0.0, 0.0};
+
+  for(int level = 0; level <= static_cast<int>(cpuSimdLevel); ++level)
+  {
+    const feature::DistanceKernels kernels = feature::getDistanceKernels(static_cast<system::ESimdLevel>(level));
+    if(level != 0 && kernels.simdLevel == system::ESimdLevel::NONE)
+      break; // SIMD kernels not available in this build
+
+    double times[3];
+    double checksums[3];
+    system::Timer timer;
+
+    checksums[0] = allPairsDistances(kernels.l2Uchar, ucharQuery, ucharDatabase, dimension);
+    times[0] = timer.elapsedMs();
+    timer.reset();
+    checksums[1] = allPairsDistances(kernels.l2Float, floatQuery, floatDatabase, dimension);
+    times[1] = timer.elapsedMs();
+    timer.reset();
+    checksums[2] = allPairsDistances(kernels.hamming, ucharQuery, ucharDatabase, dimension);
+    times[2] = timer.elapsedMs();
+
+    if(level == 0)
+      std::copy(times, times + 3, scalarTime);
+
+    ALICEVISION_LOG_INFO("Kernels: " << system::ESimdLevel_enumToString(kernels.simdLevel) << std::endl
+      << "\t- L2 uchar: " << times[0] << " ms (x" << scalarTime[0] / times[0] << ", checksum: " << checksums[0] << ")" << std::endl
+      << "\t- L2 float: " << times[1] << " ms (x" << scalarTime[1] / times[1] << ", checksum: " << checksums[1] << ")" << std::endl
+      << "\t- Hamming: " << times[2] << " ms (x" << scalarTime[2] / times[2] << ", checksum: " << checksums[2] << ")");
+  }
+
+  // brute force matching with the previous scalar metric and with the dispatched one
+  {
+    std::vector<matching::IndMatch> matchesSimple, matchesVectorized;
+    std::vector<float> distancesSimple, distancesVectorized;
+
+    system::Timer timer;
+    {
+      matching::ArrayMatcher_bruteForce<unsigned char, feature::L2_Simple<unsigned char>> matcher;
+      matcher.Build(randomNumberGenerator, ucharDatabase.data(), nbDatabase, dimension);
+      matcher.SearchNeighbours(ucharQuery.data(), nbQuery, &matchesSimple, &distancesSimple, 2);
+    }
+    const double simpleTime = timer.elapsedMs();
+    timer.reset();
+    {
+      matching::ArrayMatcher_bruteForce<unsigned char, feature::L2_Vectorized<unsigned char>> matcher;
+      matcher.Build(randomNumberGenerator, ucharDatabase.data(), nbDatabase, dimension);
+      matcher.SearchNeighbours(ucharQuery.data(), nbQuery, &matchesVectorized, &distancesVectorized, 2);
+    }
+    const double vectorizedTime = timer.elapsedMs();
+
+    ALICEVISION_LOG_INFO("Brute force matching (2-NN, uchar):" << std::endl
+      << "\t- L2_Simple: " << simpleTime << " ms" << std::endl
+      << "\t- L2_Vectorized: " << vectorizedTime << " ms (x" << simpleTime / vectorizedTime << ")" << std::endl
+      << "\t- same matches: " << (matchesSimple == matchesVectorized ? "yes" : "no"));
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/MaxFlow_PushRelabel.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace po = boost::program_options;
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> graphFilepaths;
+  std::vector<int> nbThreadsList;
+  bool skipBoykovKolmogorov = false;
+
+  po::options_description allParams("Compare the Boykov-Kolmogorov maxflow (MaxFlow_AdjList) and the parallel push-relabel maxflow\n"
+                                    "(MaxFlow_PushRelabel) on graphs saved by the meshing (see meshing --maxflowGraphFilepath).\n"
+                                    "AliceVision samples_maxflowBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("input,i", po::value<std::vector<std::string>>(&graphFilepaths)->multitoken()->required(),
+      "Saved maxflow graph files.")
+    ("nbThreads", po::value<std::vector<int>>(&nbThreadsList)->multitoken(),
+      "Numbers of threads to benchmark the push-relabel maxflow with (all the available threads by default).")
+    ("skipBoykovKolmogorov", po::value<bool>(&skipBoykovKolmogorov)->default_value(skipBoykovKolmogorov),
+      "Do not compute the Boykov-Kolmogorov maxflow, the cuts are not compared.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(po::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  const int maxNbThreads = omp_get_max_threads();
+  if(nbThreadsList.empty())
+    nbThreadsList.push_back(maxNbThreads);
+
+  for(const std::string& graphFilepath : graphFilepaths)
+  {
+    ALICEVISION_LOG_INFO("Maxflow graph: " << graphFilepath);
+
+    // the solvers are loaded one after the other to limit the memory peak on large graphs
+    std::vector<bool> boykovKolmogorovCut;
+    float boykovKolmogorovFlow = 0.0f;
+    double boykovKolmogorovTime = 0.0;
+    if(!skipBoykovKolmogorov)
+    {
+      std::unique_ptr<MaxFlow_AdjList> maxFlow = loadMaxFlowGraph<MaxFlow_AdjList>(graphFilepath);
+      const std::size_t nbNodes = maxFlow->getNbNodes();
+
+      system::Timer timer;
+      boykovKolmogorovFlow = maxFlow->compute();
+      boykovKolmogorovTime = timer.elapsedMs();
+
+      boykovKolmogorovCut.resize(nbNodes);
+      for(std::size_t n = 0; n < nbNodes; ++n)
+        boykovKolmogorovCut[n] = maxFlow->isTarget(n);
+
+      ALICEVISION_LOG_INFO("Boykov-Kolmogorov maxflow (sequential):" << std::endl
+        << "\t- #nodes: " << nbNodes << std::endl
+        << "\t- time: " << boykovKolmogorovTime << " ms" << std::endl
+        << "\t- flow: " << boykovKolmogorovFlow);
+    }
+
+    for(const int nbThreads : nbThreadsList)
+    {
+      std::unique_ptr<MaxFlow_PushRelabel> maxFlow = loadMaxFlowGraph<MaxFlow_PushRelabel>(graphFilepath);
+
+      omp_set_num_threads(nbThreads);
+      system::Timer timer;
+      const float flow = maxFlow->compute();
+      const double time = timer.elapsedMs();
+      omp_set_num_threads(maxNbThreads);
+
+      std::size_t nbDifferentNodes = 0;
+      for(std::size_t n = 0; n < boykovKolmogorovCut.size(); ++n)
+      {
+        if(maxFlow->isTarget(n) != boykovKolmogorovCut[n])
+          ++nbDifferentNodes;
+      }
+
+      ALICEVISION_LOG_INFO("Push-relabel maxflow, " << nbThreads << " threads:" << std::endl
+        << "\t- time: " << time << " ms"
+        << ((skipBoykovKolmogorov || time <= 0.0) ? "" : " (x" + std::to_string(boykovKolmogorovTime / time) + ")") << std::endl
+        << "\t- flow: " << flow << std::endl
+        << "\t- #nodes with a different side of the cut: "
+        << (skipBoykovKolmogorov ? std::string("-") : std::to_string(nbDifferentNodes)));
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/voctree/Database.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::voctree;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Generate a random document.
+ * The words follow a power law, as in real images some visual words are much more frequent than others.
+ */
+SparseHistogram generateDocument(std::mt19937& generator, int nbWords, int nbFeatures)
+{
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+  std::vector<Word> document(nbFeatures);
+  for(Word& word : document)
+    word = std::min(nbWords - 1, static_cast<int>(nbWords * std::pow(distribution(generator), 3.0)));
+
+  SparseHistogram histogram;
+  computeSparseHistogram(document, histogram);
+  return histogram;
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<int> nbDocumentsList = {10000, 50000, 100000};
+  int nbWords = 1000000;
+  int nbFeatures = 200;
+  int nbQueries = 100;
+  std::size_t nbMatches = 50;
+  std::string distanceMethod = "strongCommonPoints";
+  bool skipExhaustive = false;
+
+  po::options_description allParams("Compare the inverted files and the exhaustive scoring of the vocabulary tree database\n"
+                                    "on random documents.\n"
+                                    "AliceVision samples_voctreeBenchmark");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("nbDocuments", po::value<std::vector<int>>(&nbDocumentsList)->multitoken(),
+      "Numbers of documents in the database to benchmark (10000, 50000 and 100000 by default).")
+    ("nbWords", po::value<int>(&nbWords)->default_value(nbWords),
+      "Number of words of the vocabulary.")
+    ("nbFeatures", po::value<int>(&nbFeatures)->default_value(nbFeatures),
+      "Number of features per document.")
+    ("nbQueries", po::value<int>(&nbQueries)->default_value(nbQueries),
+      "Number of documents of the database used as queries.")
+    ("nbMatches", po::value<std::size_t>(&nbMatches)->default_value(nbMatches),
+      "Number of matches returned by each query.")
+    ("distanceMethod", po::value<std::string>(&distanceMethod)->default_value(distanceMethod),
+      "Distance method: classic, L2, commonPoints or strongCommonPoints.")
+    ("skipExhaustive", po::value<bool>(&skipExhaustive)->default_value(skipExhaustive),
+      "Do not compute the exhaustive scoring, the matches are not compared.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(po::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  for(const int nbDocuments : nbDocumentsList)
+  {
+    ALICEVISION_LOG_INFO("Database of " << nbDocuments << " documents.");
+
+    std::mt19937 generator(nbDocuments);
+    Database db(nbWords);
+    std::vector<SparseHistogram> queries;
+    for(int i = 0; i < nbDocuments; ++i)
+    {
+      const SparseHistogram histogram = generateDocument(generator, nbWords, nbFeatures);
+      if(i % std::max(1, nbDocuments / nbQueries) == 0 && queries.size() < nbQueries)
+        queries.push_back(histogram);
+      db.insert(i, histogram);
+    }
+    db.computeTfIdfWeights();
+
+    std::vector<DocMatches> invertedFileMatches(queries.size());
+    system::Timer timer;
+    for(std::size_t i = 0; i < queries.size(); ++i)
+      db.find(queries[i], nbMatches, invertedFileMatches[i], distanceMethod);
+    const double invertedFileTime = timer.elapsedMs();
+
+    ALICEVISION_LOG_INFO("Inverted files:" << std::endl
+      << "\t- time per query: " << invertedFileTime / queries.size() << " ms");
+
+    if(skipExhaustive)
+      continue;
+
+    std::size_t nbDifferentQueries = 0;
+    timer.reset();
+    for(std::size_t i = 0; i < queries.size(); ++i)
+    {
+      DocMatches exhaustiveMatches;
+      db.findExhaustive(queries[i], nbMatches, exhaustiveMatches, distanceMethod);
+      if(exhaustiveMatches != invertedFileMatches[i])
+        ++nbDifferentQueries;
+    }
+    const double exhaustiveTime = timer.elapsedMs();
+
+    ALICEVISION_LOG_INFO("Exhaustive:" << std::endl
+      << "\t- time per query: " << exhaustiveTime / queries.size() << " ms"
+      << ((invertedFileTime <= 0.0) ? "" : " (x" + std::to_string(exhaustiveTime / invertedFileTime) + " slower)") << std::endl
+      << "\t- #queries with different matches: " << nbDifferentQueries);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2021 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/VocabularyTree.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <memory>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+int aliceVision_main(int argc, char** argv)
+{
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string inputTree;
+  std::string outputTree;
+  std::string describerTypeName;
+  voctree::EVocabularyTreeFileFormat fileFormat = voctree::EVocabularyTreeFileFormat::MAPPABLE;
+
+  po::options_description allParams("This program is used to convert a vocabulary tree file between the legacy and the mappable formats\n"
+                                    "AliceVision convertVocabularyTree");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&inputTree)->required(),
+      "Input vocabulary tree file.")
+    ("output,o", po::value<std::string>(&outputTree)->required(),
+      "Output vocabulary tree file.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("describerType,d", po::value<std::string>(&describerTypeName)->default_value(describerTypeName),
+      "Describer type of the vocabulary tree. By default, it is deduced from the input file extension (e.g. vocabulary.SIFT.tree).")
+    ("fileFormat", po::value<voctree::EVocabularyTreeFileFormat>(&fileFormat)->default_value(fileFormat),
+      "Output vocabulary tree file format (legacy, mappable).");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal,  error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what() << std::endl);
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(!fs::exists(inputTree))
+  {
+    ALICEVISION_LOG_ERROR(inputTree << " does not exists");
+    return EXIT_FAILURE;
+  }
+
+  // the input tree may be memory-mapped, it can't be overwritten
+  if(fs::exists(outputTree) && fs::equivalent(inputTree, outputTree))
+  {
+    ALICEVISION_LOG_ERROR("The output vocabulary tree file must be different from the input one");
+    return EXIT_FAILURE;
+  }
+
+  std::unique_ptr<voctree::IVocabularyTree> tree;
+
+  try
+  {
+    // the input file format is detected from the file header
+    if(describerTypeName.empty())
+    {
+      feature::EImageDescriberType describerType;
+      voctree::load(tree, describerType, inputTree);
+    }
+    else
+    {
+      tree = voctree::createVoctreeForDescriberType(feature::EImageDescriberType_stringToEnum(describerTypeName));
+      tree->load(inputTree);
+    }
+
+    tree->save(outputTree, fileFormat);
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_ERROR("Cannot convert vocabulary tree file '" << inputTree << "': " << e.what());
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_LOG_INFO("Converted the vocabulary tree (" << tree->words() << " words) to the " << fileFormat << " format in '" << outputTree << "'");
+
+  return EXIT_SUCCESS;
+}
@@ -11,6 +11,7 @@
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
 #include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/LocalizationPipeline.hpp>
 #include <aliceVision/localization/optimization.hpp>
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
@@ -38,6 +39,7 @@
 #include <vector>
 #include <chrono>
 #include <memory>
+#include <numeric>
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
 #include <aliceVision/sfmDataIO/AlembicExporter.hpp>
@@ -46,7 +48,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -106,6 +108,8 @@ int aliceVision_main(int argc, char** argv)
   std::string weightsFilepath;
   /// Number of previous frame of the sequence to use for matching
   std::size_t nbFrameBufferMatching = 10;
+  /// number of threads of each stage of the localization pipeline
+  int nbThreads = 1;
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
@@ -197,6 +201,12 @@ int aliceVision_main(int argc, char** argv)
       ("nbFrameBufferMatching", po::value<std::size_t>(&nbFrameBufferMatching)->default_value(nbFrameBufferMatching),
           "[voctree] Number of previous frame of the sequence to use for matching "
           "(0 = Disable)")
+      ("nbThreads", po::value<int>(&nbThreads)->default_value(nbThreads),
+          "[voctree] Number of threads of each stage of the localization pipeline, "
+          "several frames are localized in parallel (1 = sequential localization, "
+          "0 = use all the cores). With the AllResults algorithm and nbFrameBufferMatching > 0 "
+          "(the defaults), the resection stage runs on a single thread as each frame is matched "
+          "with the previously localized ones.")
       ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
@@ -327,6 +337,7 @@ int aliceVision_main(int argc, char** argv)
   std::unique_ptr<localization::LocalizerParameters> param;
   
   std::unique_ptr<localization::ILocalizer> localizer;
+  localization::VoctreeLocalizer* voctreeLocalizer = nullptr;
   
   // initialize the localizer according to the chosen type of describer
 
@@ -351,6 +362,7 @@ int aliceVision_main(int argc, char** argv)
                                                    matchDescTypes);
 
     localizer.reset(tmpLoc);
+    voctreeLocalizer = tmpLoc;
     
     localization::VoctreeLocalizer::Parameters *tmpParam = new localization::VoctreeLocalizer::Parameters();
     param.reset(tmpParam);
@@ -414,47 +426,90 @@ int aliceVision_main(int argc, char** argv)
   bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::sum > > stats;
   
   std::vector<localization::LocalizationResult> vec_localizationResults;
-  
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+
+  // save the result of a localized frame, the frames must be given in their order
+  const auto saveFrame = [&](const localization::LocalizationResult& localizationResult,
+                             const camera::PinholeRadialK3& frameIntrinsics,
+                             const std::string& imgName)
   {
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
-    ALICEVISION_COUT("******************************");
-    localization::LocalizationResult localizationResult;
-    auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
-                       param.get(),
-                       generator,
-                       hasIntrinsics /*useInputIntrinsics*/,
-                       queryIntrinsics,
-                       localizationResult,
-                       currentImgName);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
-    
     vec_localizationResults.emplace_back(localizationResult);
 
     // save data
     if(localizationResult.isValid())
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.addCameraKeyframe(localizationResult.getPose(), &queryIntrinsics, currentImgName, frameCounter, frameCounter);
+      exporter.addCameraKeyframe(localizationResult.getPose(), &frameIntrinsics, imgName, frameCounter, frameCounter);
 #endif
       
       goodFrameCounter++;
-      goodFrameList.push_back(currentImgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
+      goodFrameList.push_back(imgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
     }
     else
     {
       ALICEVISION_CERR("Unable to localize frame " << frameCounter);
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.jumpKeyframe(currentImgName);
+      exporter.jumpKeyframe(imgName);
 #endif
     }
     ++frameCounter;
-    feed.goToNextFrame();
+  };
+
+  if(voctreeLocalizer != nullptr && nbThreads != 1)
+  {
+    localization::LocalizationPipeline pipeline(*voctreeLocalizer,
+                                                static_cast<const localization::VoctreeLocalizer::Parameters&>(*param),
+                                                nbThreads);
+
+    const auto readFrame = [&](image::Image<float>& frameGrey,
+                               camera::PinholeRadialK3& frameIntrinsics,
+                               std::string& imgName,
+                               bool& frameHasIntrinsics)
+    {
+      if(!feed.readImage(frameGrey, frameIntrinsics, imgName, frameHasIntrinsics))
+        return false;
+      feed.goToNextFrame();
+      return true;
+    };
+
+    pipeline.run(readFrame,
+                 [&](localization::LocalizedFrame& frame)
+                 {
+                   // processing time of the frame, as in the sequential path: the decoding and the queue waits are left out,
+                   // the latency is reported by the pipeline statistics
+                   const double localizationTime = std::accumulate(frame.stageDurations.begin() + int(localization::ELocalizationStage::EXTRACTION),
+                                                                   frame.stageDurations.end(), 0.0);
+                   ALICEVISION_COUT("FRAME " << myToString(frame.frameId, 4) << ": localization took " << localizationTime << " [ms]");
+                   stats(localizationTime);
+                   saveFrame(frame.localizationResult, frame.queryIntrinsics, frame.imagePath);
+                 },
+                 generator());
+
+    pipeline.logStatistics();
+  }
+  else
+  {
+    while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+    {
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
+      ALICEVISION_COUT("******************************");
+      localization::LocalizationResult localizationResult;
+      auto detect_start = std::chrono::steady_clock::now();
+      localizer->localize(imageGrey, 
+                         param.get(),
+                         generator,
+                         hasIntrinsics /*useInputIntrinsics*/,
+                         queryIntrinsics,
+                         localizationResult,
+                         currentImgName);
+      auto detect_end = std::chrono::steady_clock::now();
+      auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+      ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+      stats(detect_elapsed.count());
+
+      saveFrame(localizationResult, queryIntrinsics, currentImgName);
+      feed.goToNextFrame();
+    }
   }
 
   if(wantsJsonOutput)
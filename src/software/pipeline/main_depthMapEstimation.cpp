@@ -23,7 +23,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -72,6 +72,9 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // use the multi-threaded CPU implementation instead of CUDA
+    bool useCpu = false;
+
     po::options_description allParams("AliceVision depthMapEstimation\n"
                                       "Estimate depth map for each input image");
 
@@ -125,7 +128,9 @@ int aliceVision_main(int argc, char* argv[])
         ("exportIntermediateResults", po::value<bool>(&exportIntermediateResults)->default_value(exportIntermediateResults),
             "Export intermediate results from the SGM and Refine steps.")
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
-            "Number of GPUs to use (0 means use all GPUs).");
+            "Number of GPUs to use (0 means use all GPUs).")
+        ("useCpu", po::value<bool>(&useCpu)->default_value(useCpu),
+            "Use the multi-threaded CPU implementation instead of CUDA.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -167,14 +172,17 @@ int aliceVision_main(int argc, char* argv[])
     // set verbose level
     system::Logger::get()->setLogLevel(verboseLevel);
 
-    // print GPU Information
-    ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
-
-    // check if the gpu suppport CUDA compute capability 2.0
-    if(!gpu::gpuSupportCUDA(2,0))
+    if(!useCpu)
     {
-      ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
-      return EXIT_FAILURE;
+      // print GPU Information
+      ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+      // check if the gpu suppport CUDA compute capability 2.0
+      if(!gpu::gpuSupportCUDA(2,0))
+      {
+        ALICEVISION_LOG_WARNING("No CUDA-Enabled GPU (with at least compute capability 2.0), use the CPU implementation.");
+        useCpu = true;
+      }
     }
 
     // check if the scale is correct
@@ -220,6 +228,9 @@ int aliceVision_main(int argc, char* argv[])
     // intermediate results
     mp.userParams.put("depthMap.intermediateResults", exportIntermediateResults);
 
+    // backend
+    mp.userParams.put("depthMap.useCpu", useCpu);
+
     std::vector<int> cams;
     cams.reserve(mp.ncams);
     if(rangeSize == -1)
@@ -42,7 +42,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -112,12 +112,13 @@ int aliceVision_main(int argc, char **argv)
   bool guidedMatching = false;
   bool crossMatching = false;
   int maxIteration = 2048;
+  std::size_t acRansacBatchSize = 1;
   bool matchFilePerImage = false;
   size_t numMatchesToKeep = 0;
   bool useGridSort = true;
   bool exportDebugFiles = false;
   bool matchFromKnownCameraPoses = false;
-  const std::string fileExtension = "txt";
+  std::string fileExtension = "txt";
   int randomSeed = std::mt19937::default_seed;
 
   po::options_description allParams(
@@ -175,10 +176,16 @@ int aliceVision_main(int argc, char **argv)
       "Make sure that the matching process is symmetric (same matches for I->J than fo J->I).")
     ("matchFilePerImage", po::value<bool>(&matchFilePerImage)->default_value(matchFilePerImage),
       "Save matches in a separate file per image.")
+    ("matchFileFormat", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "Matches file format: txt (text) or bin (compact binary with a per-pair index).")
     ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
       "Distance ratio to discard non meaningful matches.")
     ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
       "Maximum number of iterations allowed in ransac step.")
+    ("acRansacBatchSize", po::value<std::size_t>(&acRansacBatchSize)->default_value(acRansacBatchSize),
+      "Number of hypotheses of the ACRansac geometric estimation evaluated in parallel. "
+      "Above 1, the image pairs are filtered one by one and the threads are used within each pair, "
+      "which is faster with a few image pairs with many matches. The result does not depend on it.")
     ("useGridSort", po::value<bool>(&useGridSort)->default_value(useGridSort),
       "Use matching grid sort.")
     ("exportDebugFiles", po::value<bool>(&exportDebugFiles)->default_value(exportDebugFiles),
@@ -457,6 +464,7 @@ int aliceVision_main(int argc, char **argv)
   timer.reset();
 
   matching::PairwiseMatches geometricMatches;
+  matchingImageCollection::GeometricFilterStats geometricFilterStats;
 
   ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
 
@@ -469,37 +477,49 @@ int aliceVision_main(int argc, char **argv)
 
     case EGeometricFilterType::FUNDAMENTAL_MATRIX:
     {
+      GeometricFilterMatrix_F_AC filter(geometricErrorMax, maxIteration, geometricEstimator);
+      filter.setACRansacBatchSize(acRansacBatchSize);
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
+        filter,
         mapPutativesMatches,
         randomNumberGenerator,
-        guidedMatching);
+        guidedMatching,
+        0.6,
+        &geometricFilterStats);
     }
     break;
 
   case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
   {
+    GeometricFilterMatrix_F_AC filter(geometricErrorMax, maxIteration, geometricEstimator, true);
+    filter.setACRansacBatchSize(acRansacBatchSize);
     matchingImageCollection::robustModelEstimation(geometricMatches,
       &sfmData,
       regionPerView,
-      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true),
+      filter,
       mapPutativesMatches,
       randomNumberGenerator,
-      guidedMatching);
+      guidedMatching,
+      0.6,
+      &geometricFilterStats);
   }
   break;
 
     case EGeometricFilterType::ESSENTIAL_MATRIX:
     {
+      GeometricFilterMatrix_E_AC filter(geometricErrorMax, maxIteration);
+      filter.setACRansacBatchSize(acRansacBatchSize);
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
+        filter,
         mapPutativesMatches,
         randomNumberGenerator,
-        guidedMatching);
+        guidedMatching,
+        0.6,
+        &geometricFilterStats);
 
       // perform an additional check to remove pairs with poor overlap
       std::vector<PairwiseMatches::key_type> toRemoveVec;
@@ -523,12 +543,15 @@ int aliceVision_main(int argc, char **argv)
     case EGeometricFilterType::HOMOGRAPHY_MATRIX:
     {
       const bool onlyGuidedMatching = true;
+      GeometricFilterMatrix_H_AC filter(geometricErrorMax, maxIteration);
+      filter.setACRansacBatchSize(acRansacBatchSize);
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
+        filter,
         mapPutativesMatches, randomNumberGenerator, guidedMatching,
-        onlyGuidedMatching ? -1.0 : 0.6);
+        onlyGuidedMatching ? -1.0 : 0.6,
+        &geometricFilterStats);
     }
     break;
 
@@ -540,11 +563,16 @@ int aliceVision_main(int argc, char **argv)
         GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
         mapPutativesMatches,
         randomNumberGenerator,
-        guidedMatching);
+        guidedMatching,
+        0.6,
+        &geometricFilterStats);
     }
     break;
   }
 
+  if(geometricFilterType != EGeometricFilterType::NO_FILTERING)
+    geometricFilterStats.log();
+
   ALICEVISION_LOG_INFO(std::to_string(geometricMatches.size()) + " geometric image pair matches:");
   for(const auto& matchGeo: geometricMatches)
     ALICEVISION_LOG_INFO("\t- image pair (" + std::to_string(matchGeo.first.first) + ", " + std::to_string(matchGeo.first.second) + ") contains " + std::to_string(matchGeo.second.getNbAllMatches()) + " geometric matches.");
@@ -27,7 +27,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -153,6 +153,14 @@ int aliceVision_main(int argc, char **argv)
     ("useLocalBA,l", po::value<bool>(&sfmParams.useLocalBundleAdjustment)->default_value(sfmParams.useLocalBundleAdjustment),
       "Enable/Disable the Local bundle adjustment strategy.\n"
       "It reduces the reconstruction time, especially for big datasets (500+ images).")
+    ("useIncrementalBAProblem", po::value<bool>(&sfmParams.useIncrementalBundleAdjustmentProblem)->default_value(sfmParams.useIncrementalBundleAdjustmentProblem),
+      "Keep the bundle adjustment problem between the iterations and only apply the changes of the scene (new cameras, points and observations, removed outliers).\n"
+      "It reduces the time spent to build the problem on big datasets. Experimental, disabled by default.")
+    ("partitionedBAClusterSize", po::value<std::size_t>(&sfmParams.partitionedBundleAdjustmentClusterSize)->default_value(sfmParams.partitionedBundleAdjustmentClusterSize),
+      "Maximum number of cameras of a cluster in the partitioned bundle adjustment (0 to disable).\n"
+      "Scenes with more cameras are adjusted by disjoint clusters in parallel, then by blocks of at most as many cameras on their separator "
+      "(the cameras linked to another cluster), it bounds the memory and time of each problem on very big datasets (10k+ images). "
+      "It is not used with the Local BA strategy.")
     ("localBAGraphDistance", po::value<int>(&sfmParams.localBundelAdjustementGraphDistanceLimit)->default_value(sfmParams.localBundelAdjustementGraphDistanceLimit),
       "Graph-distance limit setting the Active region in the Local Bundle Adjustment strategy.")
     ("localizerEstimator", po::value<robustEstimation::ERobustEstimator>(&sfmParams.localizerEstimator)->default_value(sfmParams.localizerEstimator),
@@ -166,6 +174,8 @@ int aliceVision_main(int argc, char **argv)
       "Matches folders previously added to the SfMData file will be ignored.")
     ("filterTrackForks", po::value<bool>(&sfmParams.filterTrackForks)->default_value(sfmParams.filterTrackForks),
       "Enable/Disable the track forks removal. A track contains a fork when incoherent matches leads to multiple features in the same image for a single track.\n")
+    ("multithreadedTracksBuilding", po::value<bool>(&sfmParams.multithreadedTracksBuilding)->default_value(sfmParams.multithreadedTracksBuilding),
+      "Build the tracks with a multithreaded union-find. The tracks are the same but their ids, and so the landmark ids, differ from the single-threaded union-find.\n")
     ("useRigConstraint", po::value<bool>(&sfmParams.useRigConstraint)->default_value(sfmParams.useRigConstraint),
       "Enable/Disable rig constraint.\n")
     ("lockScenePreviouslyReconstructed", po::value<bool>(&lockScenePreviouslyReconstructed)->default_value(lockScenePreviouslyReconstructed),
@@ -32,7 +32,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -284,6 +284,8 @@ int aliceVision_main(int argc, char* argv[])
     double fullWeight = 1.0;
     bool exportDebugTetrahedralization = false;
     int maxNbConnectedHelperPoints = 50;
+    bool maxflowPushRelabel = false;
+    std::string maxflowGraphFilepath;
 
     po::options_description allParams("AliceVision meshing");
 
@@ -364,6 +366,13 @@ int aliceVision_main(int argc, char* argv[])
             "Mask helper points weight. Zero to disable it.")
         ("maskBorderSize", po::value<int>(&fuseParams.maskBorderSize)->default_value(fuseParams.maskBorderSize),
             "How many pixels on mask borders? 1 by default.")
+        ("fuseStreamingMaxMemory", po::value<int>(&fuseParams.streamingMaxMemory)->default_value(fuseParams.streamingMaxMemory),
+            "Max memory (in MB) to load and filter the depth maps points through temporary files on disk. "
+            "It only bounds the loading and the filtering by pixel size: the filtered points and the next stages "
+            "(the visibilities reload the depth maps) stay in memory. A warning is logged if the filtering radius "
+            "of the points is too large for this limit. The points are loaded and filtered in memory if zero.")
+        ("fuseStreamingFolder", po::value<std::string>(&fuseParams.streamingFolder)->default_value(fuseParams.streamingFolder),
+            "Folder for the temporary files of the streaming fusion (system temporary folder if empty).")
         ("nPixelSizeBehind", po::value<double>(&nPixelSizeBehind)->default_value(nPixelSizeBehind),
             "Number of pixel size units to vote behind the vertex with FULL status.")
         ("fullWeight", po::value<double>(&fullWeight)->default_value(fullWeight),
@@ -380,6 +389,12 @@ int aliceVision_main(int argc, char* argv[])
             "Number of iterations to filter the status cells based on solid angle ratio.")
         ("maxNbConnectedHelperPoints", po::value<int>(&maxNbConnectedHelperPoints)->default_value(maxNbConnectedHelperPoints),
             "Maximum number of connected helper points before we remove them.")
+        ("maxflowPushRelabel", po::value<bool>(&maxflowPushRelabel)->default_value(maxflowPushRelabel),
+            "Use the multi-threaded push-relabel maxflow solver instead of the single-threaded Boykov-Kolmogorov solver. Both give the same cut.\n"
+            "Experimental: its speed has only been measured on synthetic graphs, compare the solvers with samples_maxflowBenchmark "
+            "on graphs saved with maxflowGraphFilepath before enabling it.")
+        ("maxflowGraphFilepath", po::value<std::string>(&maxflowGraphFilepath)->default_value(maxflowGraphFilepath),
+            "Save the maxflow graph in this binary file, to benchmark the maxflow solvers with samples_maxflowBenchmark.")
         ("exportDebugTetrahedralization", po::value<bool>(&exportDebugTetrahedralization)->default_value(exportDebugTetrahedralization),
             "Export debug cells score as tetrahedral mesh. WARNING: could create huge meshes, only use on very small datasets.")        
         ("seed", po::value<unsigned int>(&seed)->default_value(seed),
@@ -464,6 +479,8 @@ int aliceVision_main(int argc, char* argv[])
     mp.userParams.put("delaunaycut.nPixelSizeBehind", nPixelSizeBehind);
     mp.userParams.put("delaunaycut.fullWeight", fullWeight);
     mp.userParams.put("delaunaycut.voteFilteringForWeaklySupportedSurfaces", voteFilteringForWeaklySupportedSurfaces);
+    mp.userParams.put("delaunaycut.maxflowPushRelabel", maxflowPushRelabel);
+    mp.userParams.put("delaunaycut.maxflowGraphFilepath", maxflowGraphFilepath);
     mp.userParams.put("hallucinationsFiltering.invertTetrahedronBasedOnNeighborsNbIterations", invertTetrahedronBasedOnNeighborsNbIterations);
     mp.userParams.put("hallucinationsFiltering.minSolidAngleRatio", minSolidAngleRatio);
     mp.userParams.put("hallucinationsFiltering.nbSolidAngleFilteringIterations", nbSolidAngleFilteringIterations);
@@ -15,6 +15,7 @@
 
 // Image
 #include <aliceVision/image/all.hpp>
+#include <aliceVision/image/cache.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
 
 // System
@@ -36,7 +37,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -117,7 +118,7 @@ std::unique_ptr<PanoramaMap> buildMap(const sfmData::SfMData & sfmData, const st
     return ret;
 }
 
-bool processImage(const PanoramaMap & panoramaMap, const std::string & compositerType, const std::string & warpingFolder, const std::string & labelsFilePath, const std::string & outputFolder, const image::EStorageDataType & storageDataType, IndexT viewReference, const BoundingBox & referenceBoundingBox, bool showBorders, bool showSeams)
+bool processImage(const PanoramaMap & panoramaMap, image::TileCacheManager::shared_ptr & cacheManager, const std::string & compositerType, const std::string & warpingFolder, const std::string & labelsFilePath, const std::string & outputFolder, const image::EStorageDataType & storageDataType, IndexT viewReference, const BoundingBox & referenceBoundingBox, bool showBorders, bool showSeams)
 {
     // The laplacian pyramid must also contains some pixels outside of the bounding box to make sure 
     // there is a continuity between all the "views" of the panorama.
@@ -135,7 +136,7 @@ bool processImage(const PanoramaMap & panoramaMap, const std::string & composite
 
         //Enlarge the panorama boundingbox to allow consider neighboor pixels even at small scale
         panoramaBoundingBox = referenceBoundingBox.divide(panoramaMap.getScale()).dilate(panoramaMap.getBorderSize()).multiply(panoramaMap.getScale());
-        compositer = std::unique_ptr<Compositer>(new LaplacianCompositer(panoramaBoundingBox.width, panoramaBoundingBox.height, panoramaMap.getScale()));
+        compositer = std::unique_ptr<Compositer>(new LaplacianCompositer(cacheManager, panoramaBoundingBox.width, panoramaBoundingBox.height, panoramaMap.getScale()));
     }
     else if (compositerType == "alpha")
     {
@@ -383,11 +384,24 @@ bool processImage(const PanoramaMap & panoramaMap, const std::string & composite
             const BoundingBox & bbox = currentBoundingBoxes[indexIntersection];
             const BoundingBox & bboxIntersect = intersections[indexIntersection];
 
-            // Load image
+            BoundingBox cutBoundingBox;
+            cutBoundingBox.left = bboxIntersect.left - bbox.left;
+            cutBoundingBox.top = bboxIntersect.top - bbox.top;
+            cutBoundingBox.width = bboxIntersect.width;
+            cutBoundingBox.height = bboxIntersect.height;
+            if (cutBoundingBox.isEmpty())
+            {
+                continue;
+            }
+
+            // Load only the intersecting part of the image
             const std::string imagePath = (fs::path(warpingFolder) / (std::to_string(viewCurrent) + ".exr")).string();
             ALICEVISION_LOG_TRACE("Load image with path " << imagePath);
-            image::Image<image::RGBfColor> source;
-            image::readImage(imagePath, source, image::EImageColorSpace::NO_CONVERSION);
+            image::ImageReadOptions sourceOptions(image::EImageColorSpace::NO_CONVERSION);
+            sourceOptions.subROI = oiio::ROI(cutBoundingBox.left, cutBoundingBox.left + cutBoundingBox.width,
+                                             cutBoundingBox.top, cutBoundingBox.top + cutBoundingBox.height);
+            image::Image<image::RGBfColor> subsource;
+            image::readImage(imagePath, subsource, sourceOptions);
 
             // Load mask
             const std::string maskPath = (fs::path(warpingFolder) / (std::to_string(viewCurrent) + "_mask.exr")).string();
@@ -417,24 +431,11 @@ bool processImage(const PanoramaMap & panoramaMap, const std::string & composite
                 }
             }
 
-            BoundingBox cutBoundingBox;
-            cutBoundingBox.left = bboxIntersect.left - bbox.left;
-            cutBoundingBox.top = bboxIntersect.top - bbox.top;
-            cutBoundingBox.width = bboxIntersect.width;
-            cutBoundingBox.height = bboxIntersect.height;
-            if (cutBoundingBox.isEmpty())
-            {
-                continue;
-            }
 
-
-            image::Image<image::RGBfColor> subsource(cutBoundingBox.width, cutBoundingBox.height); 
             image::Image<unsigned char> submask(cutBoundingBox.width, cutBoundingBox.height);  
 
-            subsource = source.block(cutBoundingBox.top, cutBoundingBox.left, cutBoundingBox.height, cutBoundingBox.width);
             submask = mask.block(cutBoundingBox.top, cutBoundingBox.left, cutBoundingBox.height, cutBoundingBox.width);  
 
-            source = image::Image<image::RGBfColor>(); 
             mask = image::Image<unsigned char>(); 
 
             if (!compositer->append(subsource, submask, weights, referenceBoundingBox.left - panoramaBoundingBox.left + bboxIntersect.left - referenceBoundingBox.left , referenceBoundingBox.top - panoramaBoundingBox.top + bboxIntersect.top  - referenceBoundingBox.top))
@@ -555,6 +556,7 @@ int aliceVision_main(int argc, char** argv)
     int rangeIteration = -1;
 	int rangeSize = 1;
     int maxThreads = 1;
+    int maxCacheMemory = 0;
     bool showBorders = false;
     bool showSeams = false;
 
@@ -584,6 +586,7 @@ int aliceVision_main(int argc, char** argv)
         ("rangeIteration", po::value<int>(&rangeIteration)->default_value(rangeIteration), "Range chunk id.")
 		("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize), "Range size.")
         ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads), "max number of threads to use.")
+        ("maxCacheMemory", po::value<int>(&maxCacheMemory)->default_value(maxCacheMemory), "Max memory (in MB) used by the multiband pyramid, including its rebuild buffers, the remaining tiles are cached on disk in the output folder (0: half of the available memory).")
         ("labels,l", po::value<std::string>(&labelsFilepath)->required(), "Labels image from seams estimation.");
     allParams.add(optionalParams);
 
@@ -710,6 +713,42 @@ int aliceVision_main(int argc, char** argv)
     if(maxThreads > 0)
         omp_set_num_threads(std::min(omp_get_max_threads(), maxThreads));
 
+    // The multiband pyramid levels are stored by tiles, moved to disk when the memory limit is reached
+    image::TileCacheManager::shared_ptr cacheManager = image::TileCacheManager::create(outputFolder, 256, 256, 65536);
+    if (!cacheManager)
+    {
+        ALICEVISION_LOG_ERROR("Error creating the cache manager");
+        return EXIT_FAILURE;
+    }
+
+    std::size_t cacheMemory = std::size_t(maxCacheMemory) * 1024 * 1024;
+    if (cacheMemory == 0)
+    {
+        const system::MemoryInfo memoryInformation = system::getMemoryInfo();
+        cacheMemory = memoryInformation.availableRam / 2;
+    }
+
+    if (compositerType == "multiband")
+    {
+        // The pyramid rebuild works on full width bands allocated outside of the cache, remove them from the budget.
+        // The pyramid is at most the panorama width enlarged by the borders at the smallest scale.
+        const std::size_t pyramidMaxWidth = panoramaMap->getWidth() + (2 * panoramaMap->getBorderSize() + 2) * (std::size_t(1) << panoramaMap->getScale());
+        const std::size_t bandsMemory = std::size_t(omp_get_max_threads()) * LaplacianPyramid::getBandMemorySize(pyramidMaxWidth, cacheManager->getTileHeight());
+
+        if (bandsMemory < cacheMemory / 2)
+        {
+            cacheMemory -= bandsMemory;
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("The max cache memory is too small for the " << bandsMemory / (1024 * 1024) << " MB of the multiband rebuild buffers, it will be exceeded.");
+            cacheMemory /= 2;
+        }
+    }
+
+    ALICEVISION_LOG_INFO("Max memory used by the compositing cache: " << cacheMemory / (1024 * 1024) << " MB");
+    cacheManager->setMaxMemory(cacheMemory);
+
     //#pragma omp parallel for
     for (std::size_t posReference = 0; posReference < chunk.size(); posReference++)
     {
@@ -726,7 +765,7 @@ int aliceVision_main(int argc, char** argv)
             return EXIT_FAILURE;
         }
 
-        if (!processImage(*panoramaMap, compositerType, warpingFolder, labelsFilepath, outputFolder, storageDataType, viewReference, referenceBoundingBox, showBorders, showSeams)) 
+        if (!processImage(*panoramaMap, cacheManager, compositerType, warpingFolder, labelsFilepath, outputFolder, storageDataType, viewReference, referenceBoundingBox, showBorders, showSeams)) 
         {
             succeeded = false;
             continue;
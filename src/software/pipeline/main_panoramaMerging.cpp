@@ -139,27 +139,29 @@ int aliceVision_main(int argc, char** argv)
             first = false;
         }
 
-        // Load image
+        // Load image by strips, to never hold the whole composited image in memory
         ALICEVISION_LOG_TRACE("Load image with path " << imagePath);
-        image::Image<image::RGBAfColor> source;
-        image::readImage(imagePath, source, image::EImageColorSpace::NO_CONVERSION);
-
-        for (int i = 0; i < source.Height(); i++)
+        const std::function<void(const image::Image<image::RGBAfColor>&, int)> mergeStrip =
+          [&](const image::Image<image::RGBAfColor>& source, int top)
         {
-            for (int j = 0; j < source.Width(); j++)
+            for (int i = 0; i < source.Height(); i++)
             {
-                image::RGBAfColor pix = source(i, j);
+                for (int j = 0; j < source.Width(); j++)
+                {
+                    image::RGBAfColor pix = source(i, j);
 
-                if (pix.a() > 0.9) {
+                    if (pix.a() > 0.9) {
 
-                    int nx = offsetX + j;
-                    if (nx < 0) nx += panoramaWidth;
-                    if (nx >= panoramaWidth) nx -= panoramaWidth;
+                        int nx = offsetX + j;
+                        if (nx < 0) nx += panoramaWidth;
+                        if (nx >= panoramaWidth) nx -= panoramaWidth;
 
-                    panorama(offsetY + i, nx) = pix;
+                        panorama(offsetY + top + i, nx) = pix;
+                    }
                 }
             }
-        }
+        };
+        image::readImageStrips(imagePath, 256, image::ImageReadOptions(image::EImageColorSpace::NO_CONVERSION), mergeStrip);
     }
 
     oiio::ParamValueList targetMetadata;
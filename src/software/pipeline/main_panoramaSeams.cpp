@@ -68,8 +68,9 @@ bool computeWTALabels(image::Image<IndexT> & labels, const std::vector<std::shar
         const std::string weightsPath = (fs::path(inputPath) / (std::to_string(viewId) + "_weight.exr")).string();
         ALICEVISION_LOG_TRACE("Load weights with path " << weightsPath);
         image::Image<float> weights;
-        image::readImage(weightsPath, weights, image::EImageColorSpace::NO_CONVERSION);
-        image::downscaleImageInplace(weights, downscale);
+        image::ImageReadOptions weightsOptions(image::EImageColorSpace::NO_CONVERSION);
+        weightsOptions.downscale = downscale;
+        image::readImage(weightsPath, weights, weightsOptions);
 
         if (!seams.appendWithLoop(mask, weights, viewId, offsetX, offsetY)) 
         {
@@ -113,8 +114,9 @@ bool computeGCLabels(image::Image<IndexT>& labels, const std::vector<std::shared
         const std::string colorsPath = (fs::path(inputPath) / (std::to_string(viewId) + ".exr")).string();
         ALICEVISION_LOG_TRACE("Load colors with path " << colorsPath);
         image::Image<image::RGBfColor> colors;
-        image::readImage(colorsPath, colors, image::EImageColorSpace::NO_CONVERSION);
-        image::downscaleImageInplace(colors, downscale);
+        image::ImageReadOptions colorsOptions(image::EImageColorSpace::NO_CONVERSION);
+        colorsOptions.downscale = downscale;
+        image::readImage(colorsPath, colors, colorsOptions);
 
         // Get offset
         oiio::ParamValueList metadata = image::readImageMetadata(maskPath);
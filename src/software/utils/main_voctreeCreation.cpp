@@ -21,13 +21,14 @@
 
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <string>
 #include <chrono>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -54,7 +55,11 @@ int aliceVision_main(int argc, char** argv)
   std::uint32_t K = 10;
   std::uint32_t restart = 5;
   std::uint32_t LEVELS = 6;
+  std::size_t maxDescriptors = 0;
+  std::size_t miniBatchSize = 0;
+  int randomSeed = std::mt19937::default_seed;
   bool sanityCheck = true;
+  aliceVision::voctree::EVocabularyTreeFileFormat fileFormat = aliceVision::voctree::EVocabularyTreeFileFormat::LEGACY;
 
   po::options_description allParams("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree\n"
                                     "It takes as input either a list.txt file containing the a simple list of images (bundler format and older AliceVision version format)\n"
@@ -74,6 +79,17 @@ int aliceVision_main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
+    ("maxDescriptors", po::value<std::size_t>(&maxDescriptors)->default_value(maxDescriptors),
+      "Maximum number of descriptors used to build the tree, drawn uniformly from all the descriptor files. "
+      "The descriptor files are then read one by one to quantize the features. 0 to load all the descriptors in memory.")
+    ("miniBatchSize", po::value<std::size_t>(&miniBatchSize)->default_value(miniBatchSize),
+      "Number of descriptors drawn at each iteration of the mini-batch kmean, used for the clusters with more descriptors. "
+      "0 to always run the kmean on all the descriptors.")
+    ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+      "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
+    ("fileFormat", po::value<aliceVision::voctree::EVocabularyTreeFileFormat>(&fileFormat)->default_value(fileFormat),
+      "Vocabulary tree file format (legacy, mappable). The mappable format is memory-mapped when loaded, "
+      "but it cannot be read by the previous versions.")
     ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
 
   po::options_description logParams("Log parameters");
@@ -123,12 +139,19 @@ int aliceVision_main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
+  // resolve the random seed once, for the descriptors sampling and the tree building
+  const std::uint32_t resolvedRandomSeed = (randomSeed == -1) ? std::random_device()() : randomSeed;
+
   std::vector<DescriptorFloat> descriptors;
 
   std::vector<size_t> descRead;
   ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
   auto detect_start = std::chrono::steady_clock::now();
-  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+  size_t numTotDescriptors = 0;
+  if(maxDescriptors == 0)
+    numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+  else
+    numTotDescriptors = aliceVision::voctree::sampleDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, maxDescriptors, descriptors, resolvedRandomSeed);
   auto detect_end = std::chrono::steady_clock::now();
   auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   if(descriptors.size() == 0)
@@ -137,13 +160,15 @@ int aliceVision_main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+  ALICEVISION_COUT("Done! " << descriptors.size() << " descriptors kept for a total of " << numTotDescriptors << " features");
   ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
 
   // Create tree
   aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
   builder.setVerbose(tbVerbosity);
   builder.kmeans().setRestarts(restart);
+  builder.kmeans().setMiniBatchSize(miniBatchSize);
+  builder.setRandomSeed(resolvedRandomSeed);
   ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
   detect_start = std::chrono::steady_clock::now();
   builder.build(descriptors, K, LEVELS);
@@ -152,37 +177,43 @@ int aliceVision_main(int argc, char** argv)
   ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
   ALICEVISION_COUT(builder.tree().centers().size() << " centers");
   ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
-  builder.tree().save(treeName);
+  builder.tree().save(treeName, fileFormat);
 
   aliceVision::voctree::SparseHistogramPerImage allSparseHistograms;
   // temporary vector used to save all the visual word for each image before adding them to documents
   std::vector<aliceVision::voctree::Word> imgVisualWords;
   ALICEVISION_COUT("Quantizing the features");
-  size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
   detect_start = std::chrono::steady_clock::now();
-  // pass each feature through the vocabulary tree to get the associated visual word
-  // for each read images, recover the number of features in it from descRead and loop over the features
-  for(size_t i = 0; i < descRead.size(); ++i)
+  if(maxDescriptors == 0)
   {
-    // for each image:
-    // clear the temporary vector used to save all the visual word and allocate the proper size
-    imgVisualWords.clear();
-    // allocate as many visual words as the number of the features in the image
-    imgVisualWords.resize(descRead[i], 0);
-
-    #pragma omp parallel for
-    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+    size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
+    // pass each feature through the vocabulary tree to get the associated visual word
+    // for each read images, recover the number of features in it from descRead and loop over the features
+    for(size_t i = 0; i < descRead.size(); ++i)
     {
-      //	store the visual word associated to the feature in the temporary list
-      imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      // for each image:
+      // store the visual word associated to each feature of the image in the temporary list
+      imgVisualWords = builder.tree().quantize(descriptors.data() + offset, descRead[i]);
+      aliceVision::voctree::SparseHistogram histo;
+      aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
+      // add the vector to the documents
+      allSparseHistograms[i] = histo;
+
+      // update the offset
+      offset += descRead[i];
     }
-    aliceVision::voctree::SparseHistogram histo;
-    aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
-    // add the vector to the documents
-    allSparseHistograms[i] = histo;
-
-    // update the offset
-    offset += descRead[i];
+  }
+  else
+  {
+    // the tree was built from a sample of the descriptors: free it and read the descriptor files one by one
+    std::vector<DescriptorFloat>().swap(descriptors);
+    size_t i = 0;
+    aliceVision::voctree::forEachDescFile<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders,
+      [&](IndexT, const std::vector<DescriptorFloat>& imgDescriptors)
+      {
+        imgVisualWords = builder.tree().quantize(imgDescriptors);
+        aliceVision::voctree::computeSparseHistogram(imgVisualWords, allSparseHistograms[i++]);
+      });
   }
   detect_end = std::chrono::steady_clock::now();
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);